@@ -45,6 +45,8 @@
 
 #include "annotationmodel.h"
 
+#include "../Utils/minmaxpyramid.h"
+
 #include <fiff/fiff.h>
 
 #include <rtprocessing/helpers/filterkernel.h>
@@ -85,6 +87,7 @@ using namespace RTPROCESSINGLIB;
 
 FiffRawViewModel::FiffRawViewModel(QObject *pParent)
 : AbstractModel(pParent)
+, m_bBlocksOutdated(false)
 {
     qInfo() << "[FiffRawViewModel::FiffRawViewModel] Default constructor called !";
 }
@@ -107,6 +110,7 @@ FiffRawViewModel::FiffRawViewModel(const QString &sFilePath,
 , m_bEndOfFileReached(false)
 , m_blockLoadFutureWatcher()
 , m_bCurrentlyLoading(false)
+, m_bBlocksOutdated(false)
 , m_pRtFilter(FilterOverlapAdd::SPtr::create())
 , m_bPerformFiltering(false)
 , m_iDistanceTimerSpacer(1000)
@@ -120,9 +124,23 @@ FiffRawViewModel::FiffRawViewModel(const QString &sFilePath,
                 postBlockLoad(m_blockLoadFutureWatcher.future().result());
             });
 
+    // connect the min/max pyramid build: the pyramid is only used once it is complete
+    connect(&m_minMaxPyramidFutureWatcher, &QFutureWatcher<bool>::finished,
+            [this]() {
+                if(m_minMaxPyramidFutureWatcher.future().result()) {
+                    m_pMinMaxPyramid = m_pPendingMinMaxPyramid;
+                    emit dataChanged(createIndex(0,0), createIndex(rowCount(), columnCount()));
+                }
+                m_pPendingMinMaxPyramid.clear();
+            });
+
     if(byteLoadedData.isEmpty()) {
         m_file.setFileName(sFilePath);
         initFiffData(m_file);
+
+        if(m_bIsInit) {
+            startMinMaxPyramidBuild(sFilePath);
+        }
     } else {
         m_byteLoadedData = byteLoadedData;
         m_buffer.setData(m_byteLoadedData);
@@ -136,7 +154,11 @@ FiffRawViewModel::FiffRawViewModel(const QString &sFilePath,
 
 FiffRawViewModel::~FiffRawViewModel()
 {
-
+    // the background build must not outlive the model
+    if(m_pPendingMinMaxPyramid) {
+        m_pPendingMinMaxPyramid->cancel();
+    }
+    m_minMaxPyramidFutureWatcher.waitForFinished();
 }
 
 //=============================================================================================================
@@ -378,6 +400,18 @@ qint32 FiffRawViewModel::getUnit(qint32 index) const
 
 //=============================================================================================================
 
+void FiffRawViewModel::setDataColumnWidth(int iWidth)
+{
+    m_dDx = (double)iWidth / double(m_iVisibleWindowSize*m_iSamplesPerBlock);
+
+    if(m_bBlocksOutdated && minMaxPyramidLevel() < 0) {
+        reloadAllData();
+        updateEndStartFlags();
+    }
+}
+
+//=============================================================================================================
+
 void FiffRawViewModel::setBackgroundColor(const QColor& color)
 {
     m_colBackground = color;
@@ -396,10 +430,8 @@ void FiffRawViewModel::setWindowSize(int iNumSeconds,
     m_iVisibleWindowSize = iNumSeconds;
     m_iTotalBlockCount = m_iVisibleWindowSize + 2 * m_iPreloadBufferSize;
 
-    //reload data to accomodate new size
-    reloadAllData();
-
-    //Update m_dDx based on new size
+    //Update m_dDx based on new size, this reloads the data to accomodate the new size unless it is drawn from the min/max pyramid
+    m_bBlocksOutdated = true;
     setDataColumnWidth(iColWidth);
 
     endResetModel();
@@ -571,6 +603,23 @@ void FiffRawViewModel::updateHorizontalScrollPosition(qint32 newScrollPosition)
     // Convert scroll position to fiff sample space via m_dDx
     qint32 targetCursor = (newScrollPosition / m_dDx) + absoluteFirstSample() ;
 
+    if (minMaxPyramidLevel() >= 0) {
+        // the view draws from the min/max pyramid: only move the window, the blocks are loaded once they are needed again
+        qint32 iLastCursor = std::max(absoluteFirstSample(), absoluteLastSample() - m_iTotalBlockCount * m_iSamplesPerBlock + 1);
+        m_iFiffCursorBegin = std::min(iLastCursor, std::max(absoluteFirstSample(), targetCursor - m_iPreloadBufferSize * m_iSamplesPerBlock));
+        m_bBlocksOutdated = true;
+
+        updateEndStartFlags();
+
+        emit dataChanged(createIndex(0,0), createIndex(rowCount(), columnCount()));
+        return;
+    }
+
+    if (m_bBlocksOutdated) {
+        reloadAllData();
+        updateEndStartFlags();
+    }
+
     if (targetCursor < m_iFiffCursorBegin + (m_iPreloadBufferSize - 1) * m_iSamplesPerBlock
         && !m_bStartOfFileReached) {
         // Calculate the amount of data we need to load
@@ -962,6 +1011,8 @@ void FiffRawViewModel::reloadAllData()
         return;
     }
 
+    m_bBlocksOutdated = false;
+
     // append a matrix pair for each block
     for(int i = 0; i < m_iTotalBlockCount; ++i) {
         m_lData.push_back(QSharedPointer<QPair<MatrixXd, MatrixXd> >::create(qMakePair(matData.block(0, i*m_iSamplesPerBlock+iFilterDelay, matData.rows(), m_iSamplesPerBlock),
@@ -1007,3 +1058,32 @@ void FiffRawViewModel::setAnnotationModel(QSharedPointer<ANSHAREDLIB::Annotation
 {
     m_pAnnotationModel = pModel;
 }
+
+//=============================================================================================================
+
+QSharedPointer<MinMaxPyramid> FiffRawViewModel::getMinMaxPyramid() const
+{
+    return m_pMinMaxPyramid;
+}
+
+//=============================================================================================================
+
+int FiffRawViewModel::minMaxPyramidLevel() const
+{
+    // the pyramid holds the unfiltered data
+    if(!m_pMinMaxPyramid || m_bPerformFiltering || m_dDx <= 0.0) {
+        return -1;
+    }
+
+    return m_pMinMaxPyramid->levelForSamplesPerPixel(1.0 / m_dDx);
+}
+
+//=============================================================================================================
+
+void FiffRawViewModel::startMinMaxPyramidBuild(const QString& sFilePath)
+{
+    m_pPendingMinMaxPyramid = MinMaxPyramid::SPtr::create();
+
+    QFuture<bool> future = QtConcurrent::run(m_pPendingMinMaxPyramid.data(), &MinMaxPyramid::build, sFilePath);
+    m_minMaxPyramidFutureWatcher.setFuture(future);
+}
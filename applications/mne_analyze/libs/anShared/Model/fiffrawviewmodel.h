@@ -89,6 +89,7 @@ namespace ANSHAREDLIB {
 //=============================================================================================================
 
 class AnnotationModel;
+class MinMaxPyramid;
 
 //=============================================================================================================
 /**
@@ -274,10 +275,12 @@ public:
 
     //=========================================================================================================
     /**
-     * Updates m_dDx based on new size parameters
+     * Updates m_dDx based on new size parameters. Reloads the data blocks if they were skipped while drawing
+     * from the min/max pyramid and the new size needs them.
+     *
      * @param[in] iWidth    the width of the data column of the table view
      */
-    inline void setDataColumnWidth(int iWidth);
+    void setDataColumnWidth(int iWidth);
 
     //=========================================================================================================
     /**
@@ -504,6 +507,23 @@ public:
      */
     void setAnnotationModel(QSharedPointer<ANSHAREDLIB::AnnotationModel> pModel);
 
+    //=========================================================================================================
+    /**
+     * Returns the min/max pyramid of the raw data. It is built in the background after loading the file.
+     *
+     * @return shared pointer to the pyramid, null if it was not built (yet)
+     */
+    QSharedPointer<MinMaxPyramid> getMinMaxPyramid() const;
+
+    //=========================================================================================================
+    /**
+     * Returns the pyramid level which matches the current pixels per sample ratio. The view should draw from this
+     * level instead of the data blocks, which are not loaded while a level is used.
+     *
+     * @return the pyramid level, -1 if the data blocks should be drawn
+     */
+    int minMaxPyramidLevel() const;
+
 private:
     //=========================================================================================================
     /**
@@ -564,6 +584,14 @@ private:
      */
     void reloadAllData();
 
+    //=========================================================================================================
+    /**
+     * Starts building the min/max pyramid of the raw file in the background
+     *
+     * @param[in] sFilePath     The path of the raw fiff file.
+     */
+    void startMinMaxPyramidBuild(const QString& sFilePath);
+
     std::list<QSharedPointer<QPair<MatrixXd, MatrixXd> > > m_lData;             /**< Data */
     std::list<QSharedPointer<QPair<MatrixXd, MatrixXd> > > m_lNewData;          /**< Data that is to be appended or prepended */
     std::list<QSharedPointer<QPair<MatrixXd, MatrixXd> > > m_lFilteredData;     /**< Filtered data */
@@ -587,6 +615,12 @@ private:
     QFutureWatcher<int> m_blockLoadFutureWatcher;   /**< QFutureWatcher for watching process of reloading fiff data. */
     bool m_bCurrentlyLoading;                       /**< Flag to indicate whether or not a background operation is going on. */
     mutable QMutex m_dataMutex;                     /**< Using mutable is not a pretty solution */
+    bool m_bBlocksOutdated;                         /**< Flag to indicate that the data blocks were not loaded for the current window. */
+
+    // min/max pyramid
+    QSharedPointer<MinMaxPyramid> m_pMinMaxPyramid;         /**< The min/max pyramid, set once it was built. */
+    QSharedPointer<MinMaxPyramid> m_pPendingMinMaxPyramid;  /**< The min/max pyramid which is built in the background. */
+    QFutureWatcher<bool> m_minMaxPyramidFutureWatcher;      /**< QFutureWatcher for watching the build of the min/max pyramid. */
 
     // data stuff
     QFile m_file;
@@ -679,12 +713,6 @@ inline qint32 FiffRawViewModel::sampleWindowSize() const {
 
 //=============================================================================================================
 
-inline void FiffRawViewModel::setDataColumnWidth(int iWidth) {
-    m_dDx = (double)iWidth / double(m_iVisibleWindowSize*m_iSamplesPerBlock);
-}
-
-//=============================================================================================================
-
 inline double FiffRawViewModel::pixelDifference() const {
     return m_dDx;
 }
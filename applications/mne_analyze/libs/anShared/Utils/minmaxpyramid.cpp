@@ -0,0 +1,445 @@
+//=============================================================================================================
+/**
+ * @file     minmaxpyramid.cpp
+ * @author   MNE-CPP authors
+ * @since    0.1.8
+ * @date     October, 2026
+ *
+ * @section  LICENSE
+ *
+ * Copyright (C) 2026, MNE-CPP authors. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ * the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+ *       following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ *       the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+ *       to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * @brief    MinMaxPyramid class definition.
+ *
+ */
+
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "minmaxpyramid.h"
+
+#include <fiff/fiff_raw_data.h>
+
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QCryptographicHash>
+#include <QStandardPaths>
+#include <QSaveFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QDebug>
+#include <QFile>
+#include <QDir>
+
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace ANSHAREDLIB;
+using namespace FIFFLIB;
+using namespace Eigen;
+
+//=============================================================================================================
+// DEFINES
+//=============================================================================================================
+
+#define MINMAX_MIN_BASE_BIN_SIZE    64                                  /* Samples per bin on level 0 of short recordings */
+#define MINMAX_MAX_BASE_BYTES       (16 * 1024 * 1024)                  /* Upper bound for the minima and maxima of level 0 */
+#define MINMAX_LEVEL_FACTOR         4                                   /* Bins of a level combined into one bin of the next level */
+#define MINMAX_MIN_BINS             256                                 /* No coarser level is added once a level has this few bins */
+#define MINMAX_CHUNK_SIZE           16384                               /* Samples read from the file at once */
+
+#define MINMAX_CACHE_MAGIC          0x4d4e4d4d                          /* 'MNMM' */
+#define MINMAX_CACHE_VERSION        2
+#define MINMAX_CACHE_BYTE_ORDER     0x01020304
+#define MINMAX_CACHE_KEY_LEN        20                                  /* SHA-1 */
+
+//=============================================================================================================
+// DEFINE GLOBAL METHODS
+//=============================================================================================================
+
+namespace {
+
+typedef struct {
+    quint32 magic;
+    quint32 version;
+    quint32 byteOrder;
+    qint32  numChannels;
+    qint32  firstSample;
+    qint32  lastSample;
+    qint32  numLevels;
+    char    key[MINMAX_CACHE_KEY_LEN];          /* Identifies the file version and pyramid layout */
+    char    checksum[MINMAX_CACHE_KEY_LEN];     /* Covers the minima and maxima following the header */
+} MinMaxCacheHeader;
+
+}
+
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+MinMaxPyramid::MinMaxPyramid()
+: m_iNumChannels(0)
+, m_iFirstSample(0)
+, m_iLastSample(-1)
+, m_iBaseBinSize(MINMAX_MIN_BASE_BIN_SIZE)
+, m_iCancel(0)
+{
+}
+
+//=============================================================================================================
+
+bool MinMaxPyramid::build(const QString& sFilePath)
+{
+    if(readCache(sFilePath)) {
+        qInfo() << "[MinMaxPyramid::build] Read" << numLevels() << "levels from the cache of" << sFilePath;
+        return true;
+    }
+
+    if(!compute(sFilePath)) {
+        m_vecMinima.clear();
+        m_vecMaxima.clear();
+        return false;
+    }
+
+    if(!writeCache(sFilePath)) {
+        qWarning() << "[MinMaxPyramid::build] Could not write the cache of" << sFilePath;
+    }
+
+    qInfo() << "[MinMaxPyramid::build] Computed" << numLevels() << "levels for" << sFilePath;
+
+    return true;
+}
+
+//=============================================================================================================
+
+void MinMaxPyramid::cancel()
+{
+    m_iCancel.storeRelease(1);
+}
+
+//=============================================================================================================
+
+qint64 MinMaxPyramid::baseBinSize(int iNumChannels, qint64 iNumSamples)
+{
+    // Coarsen level 0 by whole levels until its minima and maxima fit into the memory budget
+    qint64 iBinSize = MINMAX_MIN_BASE_BIN_SIZE;
+
+    while(2 * static_cast<qint64>(sizeof(float)) * iNumChannels * ((iNumSamples + iBinSize - 1) / iBinSize) > MINMAX_MAX_BASE_BYTES) {
+        iBinSize *= MINMAX_LEVEL_FACTOR;
+    }
+
+    return iBinSize;
+}
+
+//=============================================================================================================
+
+qint64 MinMaxPyramid::binSize(int iLevel) const
+{
+    qint64 iBinSize = m_iBaseBinSize;
+
+    for(int i = 0; i < iLevel; ++i) {
+        iBinSize *= MINMAX_LEVEL_FACTOR;
+    }
+
+    return iBinSize;
+}
+
+//=============================================================================================================
+
+int MinMaxPyramid::levelForSamplesPerPixel(double dSamplesPerPixel) const
+{
+    int iLevel = -1;
+
+    for(int i = 0; i < numLevels(); ++i) {
+        if(binSize(i) > dSamplesPerPixel) {
+            break;
+        }
+
+        iLevel = i;
+    }
+
+    return iLevel;
+}
+
+//=============================================================================================================
+
+bool MinMaxPyramid::compute(const QString& sFilePath)
+{
+    m_vecMinima.clear();
+    m_vecMaxima.clear();
+
+    QFile file(sFilePath);
+    FiffRawData raw(file);
+
+    if(raw.isEmpty()) {
+        qWarning() << "[MinMaxPyramid::compute] Could not read raw data from" << sFilePath;
+        return false;
+    }
+
+    m_iNumChannels = raw.info.nchan;
+    m_iFirstSample = raw.first_samp;
+    m_iLastSample = raw.last_samp;
+    m_iBaseBinSize = baseBinSize(m_iNumChannels, static_cast<qint64>(m_iLastSample) - m_iFirstSample + 1);
+
+    const int iBaseBinSize = static_cast<int>(m_iBaseBinSize);
+    const int iChunkSize = (MINMAX_CHUNK_SIZE + iBaseBinSize - 1) / iBaseBinSize * iBaseBinSize;
+    const int iNumBins = static_cast<int>(numBins(0));
+
+    MatrixXfRowMajor matMinima(m_iNumChannels, iNumBins);
+    MatrixXfRowMajor matMaxima(m_iNumChannels, iNumBins);
+    MatrixXd matData, matTimes;
+
+    // Level 0, the chunks are a multiple of the bin size so that only the very last bin can be incomplete
+    for(int iChunkStart = m_iFirstSample; iChunkStart <= m_iLastSample; iChunkStart += iChunkSize) {
+        if(m_iCancel.loadAcquire()) {
+            return false;
+        }
+
+        int iChunkEnd = qMin(iChunkStart + iChunkSize - 1, m_iLastSample);
+
+        if(!raw.read_raw_segment(matData, matTimes, iChunkStart, iChunkEnd)) {
+            qWarning() << "[MinMaxPyramid::compute] Could not read samples" << iChunkStart << "to" << iChunkEnd;
+            return false;
+        }
+
+        int iBin = (iChunkStart - m_iFirstSample) / iBaseBinSize;
+
+        for(int iCol = 0; iCol < matData.cols(); iCol += iBaseBinSize, ++iBin) {
+            int iNumCols = qMin(iBaseBinSize, static_cast<int>(matData.cols()) - iCol);
+            matMinima.col(iBin) = matData.middleCols(iCol, iNumCols).rowwise().minCoeff().cast<float>();
+            matMaxima.col(iBin) = matData.middleCols(iCol, iNumCols).rowwise().maxCoeff().cast<float>();
+        }
+    }
+
+    m_vecMinima.append(matMinima);
+    m_vecMaxima.append(matMaxima);
+
+    // Coarser levels
+    while(matMinima.cols() > MINMAX_MIN_BINS) {
+        const int iNumCoarseBins = (matMinima.cols() + MINMAX_LEVEL_FACTOR - 1) / MINMAX_LEVEL_FACTOR;
+
+        MatrixXfRowMajor matCoarseMinima(m_iNumChannels, iNumCoarseBins);
+        MatrixXfRowMajor matCoarseMaxima(m_iNumChannels, iNumCoarseBins);
+
+        for(int iBin = 0; iBin < iNumCoarseBins; ++iBin) {
+            int iNumCols = qMin(MINMAX_LEVEL_FACTOR, static_cast<int>(matMinima.cols()) - iBin * MINMAX_LEVEL_FACTOR);
+            matCoarseMinima.col(iBin) = matMinima.middleCols(iBin * MINMAX_LEVEL_FACTOR, iNumCols).rowwise().minCoeff();
+            matCoarseMaxima.col(iBin) = matMaxima.middleCols(iBin * MINMAX_LEVEL_FACTOR, iNumCols).rowwise().maxCoeff();
+        }
+
+        matMinima = matCoarseMinima;
+        matMaxima = matCoarseMaxima;
+
+        m_vecMinima.append(matMinima);
+        m_vecMaxima.append(matMaxima);
+    }
+
+    return true;
+}
+
+//=============================================================================================================
+
+qint64 MinMaxPyramid::numBins(int iLevel) const
+{
+    return (static_cast<qint64>(m_iLastSample) - m_iFirstSample + binSize(iLevel)) / binSize(iLevel);
+}
+
+//=============================================================================================================
+
+int MinMaxPyramid::expectedNumLevels() const
+{
+    // A coarser level is added as long as the previous one has more than MINMAX_MIN_BINS bins
+    int iNumLevels = 1;
+
+    while(numBins(iNumLevels - 1) > MINMAX_MIN_BINS) {
+        ++iNumLevels;
+    }
+
+    return iNumLevels;
+}
+
+//=============================================================================================================
+
+QString MinMaxPyramid::cacheFileName(const QString& sFilePath)
+{
+    QByteArray pathHash = QCryptographicHash::hash(QFileInfo(sFilePath).absoluteFilePath().toUtf8(),
+                                                   QCryptographicHash::Sha1);
+
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation)
+            + QStringLiteral("/minmaxpyramid/")
+            + QString::fromLatin1(pathHash.toHex())
+            + QStringLiteral(".mmp");
+}
+
+//=============================================================================================================
+
+QByteArray MinMaxPyramid::cacheKey(const QString& sFilePath) const
+{
+    QFileInfo fileInfo(sFilePath);
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(QByteArray::number(fileInfo.size()));
+    hash.addData(QByteArray::number(fileInfo.lastModified().toMSecsSinceEpoch()));
+    hash.addData(QByteArray::number(MINMAX_MIN_BASE_BIN_SIZE));
+    hash.addData(QByteArray::number(MINMAX_MAX_BASE_BYTES));
+    hash.addData(QByteArray::number(MINMAX_LEVEL_FACTOR));
+    hash.addData(QByteArray::number(MINMAX_MIN_BINS));
+
+    return hash.result();
+}
+
+//=============================================================================================================
+
+bool MinMaxPyramid::readCache(const QString& sFilePath)
+{
+    QFile file(cacheFileName(sFilePath));
+
+    if(!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    MinMaxCacheHeader head;
+
+    if(file.read(reinterpret_cast<char*>(&head), sizeof(head)) != sizeof(head)
+       || head.magic != MINMAX_CACHE_MAGIC
+       || head.version != MINMAX_CACHE_VERSION
+       || head.byteOrder != MINMAX_CACHE_BYTE_ORDER
+       || cacheKey(sFilePath) != QByteArray(head.key, MINMAX_CACHE_KEY_LEN)
+       || head.numChannels <= 0
+       || head.numLevels <= 0
+       || head.lastSample < head.firstSample) {
+        return false;
+    }
+
+    m_iNumChannels = head.numChannels;
+    m_iFirstSample = head.firstSample;
+    m_iLastSample = head.lastSample;
+    m_iBaseBinSize = baseBinSize(m_iNumChannels, static_cast<qint64>(m_iLastSample) - m_iFirstSample + 1);
+    m_vecMinima.clear();
+    m_vecMaxima.clear();
+
+    // The layout follows from the samples, do not trust the level count of the header
+    if(head.numLevels != expectedNumLevels()) {
+        qWarning() << "[MinMaxPyramid::readCache] The cache" << file.fileName() << "has" << head.numLevels << "levels instead of" << expectedNumLevels();
+        return false;
+    }
+
+    // Check the size before allocating anything
+    qint64 iPayloadSize = 0;
+    for(int i = 0; i < head.numLevels; ++i) {
+        iPayloadSize += 2 * numBins(i) * m_iNumChannels * static_cast<qint64>(sizeof(float));
+    }
+
+    if(file.size() != static_cast<qint64>(sizeof(head)) + iPayloadSize) {
+        qWarning() << "[MinMaxPyramid::readCache] The cache" << file.fileName() << "is truncated.";
+        return false;
+    }
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+
+    for(int i = 0; i < head.numLevels; ++i) {
+        int iNumBins = static_cast<int>(numBins(i));
+        MatrixXfRowMajor matMinima(m_iNumChannels, iNumBins);
+        MatrixXfRowMajor matMaxima(m_iNumChannels, iNumBins);
+        qint64 iNumBytes = matMinima.size() * static_cast<qint64>(sizeof(float));
+
+        if(file.read(reinterpret_cast<char*>(matMinima.data()), iNumBytes) != iNumBytes
+           || file.read(reinterpret_cast<char*>(matMaxima.data()), iNumBytes) != iNumBytes) {
+            m_vecMinima.clear();
+            m_vecMaxima.clear();
+            return false;
+        }
+
+        hash.addData(reinterpret_cast<const char*>(matMinima.data()), iNumBytes);
+        hash.addData(reinterpret_cast<const char*>(matMaxima.data()), iNumBytes);
+
+        m_vecMinima.append(matMinima);
+        m_vecMaxima.append(matMaxima);
+    }
+
+    if(hash.result() != QByteArray(head.checksum, MINMAX_CACHE_KEY_LEN)) {
+        qWarning() << "[MinMaxPyramid::readCache] The cache" << file.fileName() << "is corrupted.";
+        m_vecMinima.clear();
+        m_vecMaxima.clear();
+        return false;
+    }
+
+    return true;
+}
+
+//=============================================================================================================
+
+bool MinMaxPyramid::writeCache(const QString& sFilePath) const
+{
+    QString sCacheFile = cacheFileName(sFilePath);
+
+    if(!QDir().mkpath(QFileInfo(sCacheFile).absolutePath())) {
+        return false;
+    }
+
+    MinMaxCacheHeader head;
+    memset(&head, 0, sizeof(head));
+    head.magic = MINMAX_CACHE_MAGIC;
+    head.version = MINMAX_CACHE_VERSION;
+    head.byteOrder = MINMAX_CACHE_BYTE_ORDER;
+    head.numChannels = m_iNumChannels;
+    head.firstSample = m_iFirstSample;
+    head.lastSample = m_iLastSample;
+    head.numLevels = numLevels();
+
+    QByteArray key = cacheKey(sFilePath);
+    memcpy(head.key, key.constData(), MINMAX_CACHE_KEY_LEN);
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    for(int i = 0; i < numLevels(); ++i) {
+        qint64 iNumBytes = m_vecMinima[i].size() * static_cast<qint64>(sizeof(float));
+        hash.addData(reinterpret_cast<const char*>(m_vecMinima[i].data()), iNumBytes);
+        hash.addData(reinterpret_cast<const char*>(m_vecMaxima[i].data()), iNumBytes);
+    }
+
+    QByteArray checksum = hash.result();
+    memcpy(head.checksum, checksum.constData(), MINMAX_CACHE_KEY_LEN);
+
+    QSaveFile file(sCacheFile);
+
+    if(!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+
+    file.write(reinterpret_cast<const char*>(&head), sizeof(head));
+
+    for(int i = 0; i < numLevels(); ++i) {
+        qint64 iNumBytes = m_vecMinima[i].size() * static_cast<qint64>(sizeof(float));
+        file.write(reinterpret_cast<const char*>(m_vecMinima[i].data()), iNumBytes);
+        file.write(reinterpret_cast<const char*>(m_vecMaxima[i].data()), iNumBytes);
+    }
+
+    return file.commit();
+}
@@ -0,0 +1,310 @@
+//=============================================================================================================
+/**
+ * @file     minmaxpyramid.h
+ * @author   MNE-CPP authors
+ * @since    0.1.8
+ * @date     October, 2026
+ *
+ * @section  LICENSE
+ *
+ * Copyright (C) 2026, MNE-CPP authors. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ * the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+ *       following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ *       the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+ *       to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * @brief     MinMaxPyramid class declaration.
+ *
+ */
+
+#ifndef ANSHAREDLIB_MINMAXPYRAMID_H
+#define ANSHAREDLIB_MINMAXPYRAMID_H
+
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "../anshared_global.h"
+
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QSharedPointer>
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QVector>
+#include <QString>
+
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+//=============================================================================================================
+// FORWARD DECLARATIONS
+//=============================================================================================================
+
+//=============================================================================================================
+// DEFINE NAMESPACE ANSHAREDLIB
+//=============================================================================================================
+
+namespace ANSHAREDLIB {
+
+//=============================================================================================================
+// ANSHAREDLIB FORWARD DECLARATIONS
+//=============================================================================================================
+
+//=============================================================================================================
+/**
+ * Level 0 of the pyramid holds the minimum and maximum of every channel for bins of at least MINMAX_MIN_BASE_BIN_SIZE
+ * samples, every further level combines MINMAX_LEVEL_FACTOR bins of the previous level. Long recordings with many
+ * channels start at a coarser bin size, so that level 0 stays within MINMAX_MAX_BASE_BYTES. Zoomed out views can
+ * therefore draw a whole raw file with a bounded number of points per pixel column instead of reading and painting
+ * every sample. The pyramid is built from the unfiltered raw data and is cached on disk.
+ *
+ * @brief Multiresolution min/max decimation of the channels of a raw fiff file.
+ */
+class ANSHAREDSHARED_EXPORT MinMaxPyramid
+{
+
+public:
+    typedef QSharedPointer<MinMaxPyramid> SPtr;              /**< Shared pointer type for MinMaxPyramid. */
+    typedef QSharedPointer<const MinMaxPyramid> ConstSPtr;   /**< Const shared pointer type for MinMaxPyramid. */
+
+    typedef Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> MatrixXfRowMajor;   /**< Channels x bins, stored channel by channel. */
+
+    //=========================================================================================================
+    /**
+     * Constructs an empty MinMaxPyramid.
+     */
+    MinMaxPyramid();
+
+    //=========================================================================================================
+    /**
+     * Reads the pyramid of a raw fiff file from the disk cache or computes it and writes it to the cache.
+     * This is meant to be run in a background thread. It reads the file through its own file handle.
+     *
+     * @param[in] sFilePath     The path of the raw fiff file.
+     *
+     * @return True if the pyramid was built, false if the file could not be read or the build was cancelled.
+     */
+    bool build(const QString& sFilePath);
+
+    //=========================================================================================================
+    /**
+     * Requests a running build to stop as soon as possible. Can be called from any thread.
+     */
+    void cancel();
+
+    //=========================================================================================================
+    /**
+     * Returns the number of levels.
+     *
+     * @return The number of levels, 0 if the pyramid was not built.
+     */
+    inline int numLevels() const;
+
+    //=========================================================================================================
+    /**
+     * Returns the number of samples combined in one bin of level 0 for a recording. Level 0 starts at the
+     * finest bin size and is coarsened by whole levels until its minima and maxima fit into the memory budget.
+     *
+     * @param[in] iNumChannels   The number of channels.
+     * @param[in] iNumSamples    The number of samples.
+     *
+     * @return The bin size of level 0 in samples.
+     */
+    static qint64 baseBinSize(int iNumChannels, qint64 iNumSamples);
+
+    //=========================================================================================================
+    /**
+     * Returns the number of samples combined in one bin of a level.
+     *
+     * @param[in] iLevel     The level.
+     *
+     * @return The bin size in samples.
+     */
+    qint64 binSize(int iLevel) const;
+
+    //=========================================================================================================
+    /**
+     * Returns the first sample of the file, which is the first sample of bin 0 on every level.
+     *
+     * @return The first sample.
+     */
+    inline int firstSample() const;
+
+    //=========================================================================================================
+    /**
+     * Returns the last sample of the file (inclusive).
+     *
+     * @return The last sample.
+     */
+    inline int lastSample() const;
+
+    //=========================================================================================================
+    /**
+     * Selects the coarsest level with at least one bin per pixel.
+     *
+     * @param[in] dSamplesPerPixel   The number of samples which are drawn into one pixel column.
+     *
+     * @return The level, -1 if the samples are too far apart for any level or the pyramid was not built.
+     */
+    int levelForSamplesPerPixel(double dSamplesPerPixel) const;
+
+    //=========================================================================================================
+    /**
+     * Returns the bin minima of a level.
+     *
+     * @param[in] iLevel     The level.
+     *
+     * @return The minima (channels x bins).
+     */
+    inline const MatrixXfRowMajor& minima(int iLevel) const;
+
+    //=========================================================================================================
+    /**
+     * Returns the bin maxima of a level.
+     *
+     * @param[in] iLevel     The level.
+     *
+     * @return The maxima (channels x bins).
+     */
+    inline const MatrixXfRowMajor& maxima(int iLevel) const;
+
+private:
+    //=========================================================================================================
+    /**
+     * Computes level 0 by reading the file in chunks and derives the coarser levels from it.
+     *
+     * @param[in] sFilePath     The path of the raw fiff file.
+     *
+     * @return True if succeeded, false if the file could not be read or the build was cancelled.
+     */
+    bool compute(const QString& sFilePath);
+
+    //=========================================================================================================
+    /**
+     * Returns the number of bins of a level for the current first and last sample.
+     *
+     * @param[in] iLevel     The level.
+     *
+     * @return The number of bins, the last one may be incomplete.
+     */
+    qint64 numBins(int iLevel) const;
+
+    //=========================================================================================================
+    /**
+     * Returns the number of levels compute() derives for the current first and last sample.
+     *
+     * @return The number of levels.
+     */
+    int expectedNumLevels() const;
+
+    //=========================================================================================================
+    /**
+     * Returns the disk cache file of a raw fiff file. The name is derived from the absolute file path, so that
+     * the cache is replaced when the file changes.
+     *
+     * @param[in] sFilePath     The path of the raw fiff file.
+     *
+     * @return The cache file path.
+     */
+    static QString cacheFileName(const QString& sFilePath);
+
+    //=========================================================================================================
+    /**
+     * Returns the key which identifies the file version and pyramid layout a cache was written for.
+     *
+     * @param[in] sFilePath     The path of the raw fiff file.
+     *
+     * @return The SHA-1 key.
+     */
+    QByteArray cacheKey(const QString& sFilePath) const;
+
+    //=========================================================================================================
+    /**
+     * Reads the pyramid from the disk cache.
+     *
+     * @param[in] sFilePath     The path of the raw fiff file.
+     *
+     * @return True if a valid cache was found, false otherwise.
+     */
+    bool readCache(const QString& sFilePath);
+
+    //=========================================================================================================
+    /**
+     * Writes the pyramid to the disk cache.
+     *
+     * @param[in] sFilePath     The path of the raw fiff file.
+     *
+     * @return True if succeeded, false otherwise.
+     */
+    bool writeCache(const QString& sFilePath) const;
+
+    int                         m_iNumChannels;     /**< The number of channels. */
+    int                         m_iFirstSample;     /**< The first sample of the file. */
+    int                         m_iLastSample;      /**< The last sample of the file (inclusive). */
+    qint64                      m_iBaseBinSize;     /**< The number of samples combined in one bin of level 0. */
+    QVector<MatrixXfRowMajor>   m_vecMinima;        /**< The bin minima of each level. */
+    QVector<MatrixXfRowMajor>   m_vecMaxima;        /**< The bin maxima of each level. */
+    QAtomicInt                  m_iCancel;          /**< Set to 1 to stop a running build. */
+};
+
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+inline int MinMaxPyramid::numLevels() const
+{
+    return m_vecMinima.size();
+}
+
+//=============================================================================================================
+
+inline int MinMaxPyramid::firstSample() const
+{
+    return m_iFirstSample;
+}
+
+//=============================================================================================================
+
+inline int MinMaxPyramid::lastSample() const
+{
+    return m_iLastSample;
+}
+
+//=============================================================================================================
+
+inline const MinMaxPyramid::MatrixXfRowMajor& MinMaxPyramid::minima(int iLevel) const
+{
+    return m_vecMinima[iLevel];
+}
+
+//=============================================================================================================
+
+inline const MinMaxPyramid::MatrixXfRowMajor& MinMaxPyramid::maxima(int iLevel) const
+{
+    return m_vecMaxima[iLevel];
+}
+
+} // namespace ANSHAREDLIB
+
+#endif // ANSHAREDLIB_MINMAXPYRAMID_H
@@ -95,7 +95,8 @@ SOURCES += \
     Model/annotationmodel.cpp \
     Model/averagingdatamodel.cpp \
     Model/mricoordmodel.cpp \
-    Model/covariancemodel.cpp
+    Model/covariancemodel.cpp \
+    Utils/minmaxpyramid.cpp
 
 HEADERS += \
     Model/dipolefitmodel.h \
@@ -112,6 +113,7 @@ HEADERS += \
     Management/statusbar.h \
     Utils/metatypes.h \
     Utils/types.h \
+    Utils/minmaxpyramid.h \
     Model/bemdatamodel.h \
     Model/fiffrawviewmodel.h \
     Model/annotationmodel.h \
@@ -43,6 +43,7 @@
 
 #include <anShared/Model/fiffrawviewmodel.h>
 #include <anShared/Model/annotationmodel.h>
+#include <anShared/Utils/minmaxpyramid.h>
 #include <anShared/Utils/metatypes.h>
 
 #include <disp/viewers/scalingview.h>
@@ -127,20 +128,31 @@ void FiffRawViewDelegate::paint(QPainter *painter,
             QVariant variant = index.model()->data(index,Qt::DisplayRole);
             ChannelData data = variant.value<ChannelData>();
 
-            if(data.size() > 0) {
-                //Plot data path
-                const FiffRawViewModel* pFiffRawModel = static_cast<const FiffRawViewModel*>(index.model());
+            const FiffRawViewModel* pFiffRawModel = static_cast<const FiffRawViewModel*>(index.model());
 
+            // Zoomed out views are drawn from the min/max pyramid, the data blocks are not loaded in that case
+            int iPyramidLevel = pFiffRawModel->minMaxPyramidLevel();
+
+            if(data.size() > 0 || iPyramidLevel >= 0) {
+                //Plot data path
                 int pos = pFiffRawModel->pixelDifference() * (pFiffRawModel->currentFirstSample() - pFiffRawModel->absoluteFirstSample());
 
                 QPainterPath path = QPainterPath(QPointF(option.rect.x()+pos, option.rect.y()));
 
                 //Plot data
-                createPlotPath(option,
-                               path,
-                               data,
-                               pFiffRawModel->pixelDifference(),
-                               index);
+                if(iPyramidLevel >= 0) {
+                    createMinMaxPlotPath(option,
+                                         path,
+                                         iPyramidLevel,
+                                         pFiffRawModel->pixelDifference(),
+                                         index);
+                } else {
+                    createPlotPath(option,
+                                   path,
+                                   data,
+                                   pFiffRawModel->pixelDifference(),
+                                   index);
+                }
 
                 painter->setRenderHint(QPainter::Antialiasing, true);
                 painter->save();
@@ -274,6 +286,49 @@ void FiffRawViewDelegate::createPlotPath(const QStyleOptionViewItem &option,
 
 //=============================================================================================================
 
+void FiffRawViewDelegate::createMinMaxPlotPath(const QStyleOptionViewItem &option,
+                                               QPainterPath& path,
+                                               int iLevel,
+                                               double dDx,
+                                               const QModelIndex &index) const
+{
+    const FiffRawViewModel* t_pModel = static_cast<const FiffRawViewModel*>(index.model());
+    QSharedPointer<MinMaxPyramid> pPyramid = t_pModel->getMinMaxPyramid();
+
+    if(!pPyramid || iLevel < 0 || iLevel >= pPyramid->numLevels()) {
+        return;
+    }
+
+    double dMaxValue = DISPLIB::getScalingValue(t_pModel->getScaling(), t_pModel->getKind(index.row()), t_pModel->getUnit(index.row()));
+    double dScaleY = option.rect.height()/(2*dMaxValue);
+    double x_base = path.currentPosition().x();
+    double y_base = path.currentPosition().y();
+
+    const MinMaxPyramid::MatrixXfRowMajor& matMinima = pPyramid->minima(iLevel);
+    const MinMaxPyramid::MatrixXfRowMajor& matMaxima = pPyramid->maxima(iLevel);
+    const qint64 iBinSize = pPyramid->binSize(iLevel);
+    const int iRow = index.row();
+
+    // Only draw the bins of the current window, the path starts at its first sample
+    int iFirstBin = qMax(0, static_cast<int>((t_pModel->currentFirstSample() - pPyramid->firstSample()) / iBinSize));
+    int iLastBin = qMin(static_cast<int>(matMinima.cols()) - 1, static_cast<int>((t_pModel->currentLastSample() - pPyramid->firstSample()) / iBinSize));
+
+    for(int iBin = iFirstBin; iBin <= iLastBin; ++iBin) {
+        double x = x_base + dDx * (pPyramid->firstSample() + iBin * iBinSize - t_pModel->currentFirstSample());
+
+        //Reverse direction -> plot the right way, the bins are connected by the line from one minimum to the next maximum
+        if(iBin == iFirstBin) {
+            path.moveTo(x, y_base - matMaxima(iRow, iBin) * dScaleY);
+        } else {
+            path.lineTo(x, y_base - matMaxima(iRow, iBin) * dScaleY);
+        }
+
+        path.lineTo(x, y_base - matMinima(iRow, iBin) * dScaleY);
+    }
+}
+
+//=============================================================================================================
+
 void FiffRawViewDelegate::setSignalColor(const QColor& signalColor)
 {
     m_penNormal.setColor(signalColor);
@@ -316,6 +371,8 @@ void FiffRawViewDelegate::createMarksPath(const QModelIndex &index,
                                           ANSHAREDLIB::ChannelData &data,
                                           QPainter* painter) const
 {
+    Q_UNUSED(data);
+
     const FiffRawViewModel* t_pModel = static_cast<const FiffRawViewModel*>(index.model());
     QSharedPointer<AnnotationModel> t_pAnnModel = t_pModel->getAnnotationModel();
 
@@ -332,7 +389,7 @@ void FiffRawViewDelegate::createMarksPath(const QModelIndex &index,
 
     for(int i = 0; i < t_pModel->getTimeListSize(); i++) {
         unsigned int uiTime = t_pModel->getTimeMarks(i);
-        if ((t_pModel->getTimeMarks(i) > iStart) && (uiTime < (iStart + data.size()))) {
+        if ((t_pModel->getTimeMarks(i) > iStart) && (uiTime <= static_cast<unsigned int>(t_pModel->currentLastSample()))) {
 //            int type = t_pAnnModel->data(t_pAnnModel->index(i,2)).toInt();
 //            painter->setPen(QPen(typeColor.value(type), Qt::black));
             int group = t_pAnnModel->currentGroup(i);
@@ -154,6 +154,23 @@ private:
                         double dDx,
                         const QModelIndex &index) const;
 
+    //=========================================================================================================
+    /**
+     * createMinMaxPlotPath creates the QPointer path for the data plot from a level of the min/max pyramid. Each
+     * bin is drawn as a vertical line from its maximum to its minimum.
+     *
+     * @param[in] option     Describes the parameters used to draw an item in a view widget
+     * @param[in,out] path   The QPointerPath to create for the data plot.
+     * @param[in] iLevel     The level of the min/max pyramid to draw from.
+     * @param[in] dDx        pixel difference to the next sample in pixels.
+     * @param[in] index      Used to locate data in a data model.
+     */
+    void createMinMaxPlotPath(const QStyleOptionViewItem &option,
+                              QPainterPath& path,
+                              int iLevel,
+                              double dDx,
+                              const QModelIndex &index) const;
+
     //=========================================================================================================
     /**
      * createTimeSpacersPath Creates the QPointer path for the vertical time spacers.
@@ -477,6 +477,7 @@ void Hpi::run()
     FiffCoordTrans transDevHeadRef = m_pFiffInfo->dev_head_t;
 
     HPIFit HPI = HPIFit(m_pFiffInfo);
+    HPI.setUseLevenbergMarquardt(true);
 
     double dErrorMax = 0.0;
     double dMeanErrorDist = 0.0;
@@ -546,6 +547,9 @@ void Hpi::run()
                            m_pFiffInfo);
                 m_mutex.unlock();
 
+                fitResult.vecNumIterations = HPI.getLastNumIterations();
+                fitResult.fFitDuration = HPI.getLastFitDuration();
+
                 //Check if the error meets distance requirement
                 if(fitResult.errorDistances.size() > 0) {
                     dMeanErrorDist = std::accumulate(fitResult.errorDistances.begin(), fitResult.errorDistances.end(), .0) / fitResult.errorDistances.size();
@@ -290,14 +290,10 @@ void NeuronalConnectivity::updateSource(SCMEASLIB::Measurement::SPtr pMeasuremen
                                                                            pRTSE->getValue()[i]->data.cols() - iZeroIdx));
         }
 
-        //Pop data from buffer
-        if(m_connectivitySettings.size() >= m_iNumberAverages) {
-            m_pRtConnectivity->restart();
-            m_connectivitySettings.removeFirst(m_connectivitySettings.size()-m_iNumberAverages);
-        }
-
+        // Only send the new trials. The worker keeps the window of the last m_iNumberAverages trials.
         m_timer.restart();
-        m_pRtConnectivity->append(m_connectivitySettings);
+        m_pRtConnectivity->appendIncremental(m_connectivitySettings, m_iNumberAverages);
+        m_connectivitySettings.clearAllData();
     }
 }
 
@@ -359,14 +355,10 @@ void NeuronalConnectivity::updateRTMSA(SCMEASLIB::Measurement::SPtr pMeasurement
                 m_connectivitySettings.append(data);
             }
 
-            //Pop data from buffer
-            if(m_connectivitySettings.size() > m_iNumberAverages) {
-                m_pRtConnectivity->restart();
-                m_connectivitySettings.removeFirst(m_connectivitySettings.size()-m_iNumberAverages);
-            }
-
+            // Only send the new trials. The worker keeps the window of the last m_iNumberAverages trials.
             m_timer.restart();
-            m_pRtConnectivity->append(m_connectivitySettings);
+            m_pRtConnectivity->appendIncremental(m_connectivitySettings, m_iNumberAverages);
+            m_connectivitySettings.clearAllData();
         }
     }
 }
@@ -442,14 +434,10 @@ void NeuronalConnectivity::updateRTEV(SCMEASLIB::Measurement::SPtr pMeasurement)
 
                     m_connectivitySettings.append(data);
 
-                    //Pop data from buffer
-                    if(m_connectivitySettings.size() > m_iNumberAverages) {
-                        m_pRtConnectivity->restart();
-                        m_connectivitySettings.removeFirst(m_connectivitySettings.size()-m_iNumberAverages);
-                    }
-
+                    // Only send the new trial. The worker keeps the window of the last m_iNumberAverages trials.
                     m_timer.restart();
-                    m_pRtConnectivity->append(m_connectivitySettings);
+                    m_pRtConnectivity->appendIncremental(m_connectivitySettings, m_iNumberAverages);
+                    m_connectivitySettings.clearAllData();
 
                     break;
                 }
@@ -544,8 +532,7 @@ void NeuronalConnectivity::run()
 void NeuronalConnectivity::onNewConnectivityResultAvailable(const QList<Network>& connectivityResults,
                                                             const ConnectivitySettings& connectivitySettings)
 {
-    m_connectivitySettings = connectivitySettings;
-    m_connectivitySettings.setConnectivityMethods(m_sConnectivityMethods);
+    Q_UNUSED(connectivitySettings)
 
     for(int i = 0; i < connectivityResults.size(); ++i) {
         m_pCircularBuffer->push(connectivityResults.at(i));
@@ -563,8 +550,8 @@ void NeuronalConnectivity::onMetricChanged(const QString& sMetric)
     m_sConnectivityMethods = QStringList() << sMetric;
     m_connectivitySettings.setConnectivityMethods(m_sConnectivityMethods);
     if(m_pRtConnectivity && this->isRunning()) {
-        m_pRtConnectivity->restart();
-        m_pRtConnectivity->append(m_connectivitySettings);
+        // The worker keeps the trials of the window and only recomputes their spectra for the new metric
+        m_pRtConnectivity->appendIncremental(m_connectivitySettings, m_iNumberAverages);
     }
 }
 
@@ -592,6 +579,10 @@ void NeuronalConnectivity::onTriggerTypeChanged(const QString& triggerType)
     if(triggerType != m_sAvrType) {
         m_connectivitySettings.clearAllData();
         m_sAvrType = triggerType;
+
+        if(m_pRtConnectivity) {
+            m_pRtConnectivity->restart();
+        }
     }
 }
 
@@ -572,7 +572,9 @@ void RtcMne::run()
     qint32 skip_count = 0;
     FiffEvoked evoked;
     MatrixXd matData;
-    MatrixXd matDataResized;
+    MatrixXf matDataResized;
+    MatrixXf matSol;
+    VectorXi vecVertices;
     qint32 j;
     int iTimePointSps = 0;
     int iNumberChannels = 0;
@@ -610,6 +612,10 @@ void RtcMne::run()
             // Set up the inverse according to the parameters.
             // Use 1 nave here because in case of evoked data as input the minimum norm will always be updated when the source estimate is calculated (see run method).
             pMinimumNorm->doInverseSetup(1,true);
+
+            const MNESourceSpace& sourceSpace = pMinimumNorm->getSourceSpace();
+            vecVertices.resize(sourceSpace[0].vertno.size() + sourceSpace[1].vertno.size());
+            vecVertices << sourceSpace[0].vertno, sourceSpace[1].vertno;
         }
 
         //Process data from raw data input
@@ -621,14 +627,18 @@ void RtcMne::run()
                     matDataResized.resize(iNumberChannels, matData.cols());
 
                     for(j = 0; j < iNumberChannels; ++j) {
-                        matDataResized.row(j) = matData.row(lChNamesFiffInfo.indexOf(lChNamesInvOp.at(j)));
+                        matDataResized.row(j) = matData.row(lChNamesFiffInfo.indexOf(lChNamesInvOp.at(j))).cast<float>();
                     }
 
                     //TODO: Add picking here. See evoked part as input.
-                    sourceEstimate = pMinimumNorm->calculateInverse(matDataResized,
-                                                                    0.0f,
-                                                                    tstep,
-                                                                    true);
+                    if(pMinimumNorm->applyInverse(matDataResized, matSol)) {
+                        sourceEstimate = MNESourceEstimate(matSol.cast<double>(),
+                                                           vecVertices,
+                                                           0.0f,
+                                                           tstep);
+                    } else {
+                        sourceEstimate.clear();
+                    }
 
                     if(!sourceEstimate.isEmpty()) {
                         if(iTimePointSps < sourceEstimate.data.cols() && iTimePointSps >= 0) {
@@ -0,0 +1,278 @@
+//=============================================================================================================
+/**
+ * @file     main.cpp
+ * @author   MNE-CPP authors
+ * @since    0.1.8
+ * @date     October, 2026
+ *
+ * @section  LICENSE
+ *
+ * Copyright (C) 2026, MNE-CPP authors. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ * the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+ *       following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ *       the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+ *       to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * @brief    Compares the number of forward evaluations and the time per fit of the simplex and the
+ *           Levenberg-Marquardt dipole fitting.
+ *
+ */
+
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <inverse/dipoleFit/dipole_fit_settings.h>
+#include <inverse/dipoleFit/dipole_fit.h>
+#include <inverse/dipoleFit/dipole_fit_data.h>
+#include <inverse/dipoleFit/guess_data.h>
+#include <inverse/c/mne_meas_data.h>
+#include <inverse/c/mne_meas_data_set.h>
+
+#include <utils/generics/applicationlogger.h>
+
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtCore/QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QScopedPointer>
+#include <QDebug>
+
+//=============================================================================================================
+// STL INCLUDES
+//=============================================================================================================
+
+#include <algorithm>
+#include <cmath>
+
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace INVERSELIB;
+using namespace UTILSLIB;
+
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+//=============================================================================================================
+/**
+ * Set up the forward model, read the evoked data and compute the guess fields, like DipoleFit::calculateFit does
+ * for evoked MEG data. The fitting interval of the settings is limited to the data.
+ *
+ * @param[in] settings   The dipole fit settings.
+ * @param[out] fitData   The dipole fit data.
+ * @param[out] measData  The evoked data.
+ * @param[out] guess     The guess locations and their fields.
+ *
+ * @return True if succeeded, false otherwise.
+ */
+bool setupFit(DipoleFitSettings& settings,
+              QScopedPointer<DipoleFitData>& fitData,
+              QScopedPointer<MneMeasData>& measData,
+              QScopedPointer<GuessData>& guess)
+{
+    fitData.reset(DipoleFitData::setup_dipole_fit_data(settings.mriname,
+                                                       settings.measname,
+                                                       settings.bemname.isEmpty() ? NULL : settings.bemname.toUtf8().data(),
+                                                       &settings.r0,
+                                                       NULL,
+                                                       settings.accurate,
+                                                       settings.badname,
+                                                       settings.noisename,
+                                                       settings.grad_std,
+                                                       settings.mag_std,
+                                                       settings.eeg_std,
+                                                       settings.mag_reg,
+                                                       settings.grad_reg,
+                                                       settings.eeg_reg,
+                                                       settings.diagnoise,
+                                                       settings.projnames,
+                                                       settings.include_meg,
+                                                       settings.include_eeg,
+                                                       settings.use_geometry_cache));
+    if(fitData.isNull()) {
+        return false;
+    }
+    fitData->fit_mag_dipoles = settings.fit_mag_dipoles;
+
+    measData.reset(MneMeasData::mne_read_meas_data(settings.measname,
+                                                   settings.setno,
+                                                   NULL,
+                                                   NULL,
+                                                   fitData->ch_names,
+                                                   fitData->nmeg+fitData->neeg));
+    if(measData.isNull()) {
+        return false;
+    }
+    if(settings.do_baseline) {
+        measData->adjust_baselines(settings.bmin,settings.bmax);
+    }
+
+    MneMeasDataSet* current = measData->current;
+    settings.tmin = std::max(settings.tmin, current->tmin + settings.integ/2.0f);
+    settings.tmax = std::min(settings.tmax, current->tmin + (current->np-1)*current->tstep - settings.integ/2.0f);
+    if(settings.tstep < 0) {
+        settings.tstep = current->tstep;
+    }
+
+    if(!settings.noisename.isEmpty() && DipoleFitData::scale_noise_cov(fitData.data(),current->nave) < 0) {
+        return false;
+    }
+
+    guess.reset(new GuessData(settings.guessname,
+                              settings.guess_surfname,
+                              settings.guess_mindist,
+                              settings.guess_exclude,
+                              settings.guess_grid,
+                              fitData.data(),
+                              settings.guess_cachename));
+
+    return true;
+}
+
+//=============================================================================================================
+/**
+ * Run the fit and report the evaluation counts and the timing. Only the fitting of the time points is timed,
+ * the setup is shared by all runs.
+ *
+ * @param[in] settings   The dipole fit settings.
+ * @param[in] fitData    The dipole fit data.
+ * @param[in] measData   The evoked data.
+ * @param[in] guess      The guess locations and their fields.
+ * @param[in] bFitLm     Whether to use the Levenberg-Marquardt fit instead of the simplex.
+ * @param[in] sName      Name of the run to be printed.
+ * @param[out] set       The fitted dipoles.
+ */
+void runFit(const DipoleFitSettings& settings,
+            DipoleFitData* fitData,
+            MneMeasData* measData,
+            GuessData* guess,
+            bool bFitLm,
+            const QString& sName,
+            ECDSet& set)
+{
+    QElapsedTimer timer;
+
+    fitData->fit_lm = bFitLm;
+
+    timer.start();
+    DipoleFit::fit_dipoles(settings.measname,measData,fitData,guess,settings.tmin,settings.tmax,settings.tstep,settings.integ,0,set);
+    qint64 iTime = timer.elapsed();
+
+    double dNeval = 0.0;
+    for(int i = 0; i < set.size(); ++i) {
+        dNeval += set[i].neval;
+    }
+
+    printf("\n%s: %d dipoles, %.1f evaluations per fit, total %lld ms, %.2f ms per fit\n",
+           sName.toUtf8().constData(),
+           set.size(),
+           set.size() > 0 ? dNeval/set.size() : 0.0,
+           iTime,
+           set.size() > 0 ? static_cast<double>(iTime)/set.size() : 0.0);
+}
+
+//=============================================================================================================
+/**
+ * The function main marks the entry point of the program.
+ * By default, main has the storage class extern.
+ *
+ * @param [in] argc (argument count) is an integer that indicates how many arguments were entered on the command line when the program was started.
+ * @param [in] argv (argument vector) is an array of pointers to arrays of character objects. The array objects are null-terminated strings, representing the arguments that were entered on the command line when the program was started.
+ * @return the value that was set to exit() (which is 0 if exit() is called via quit()).
+ */
+int main(int argc, char *argv[])
+{
+    qInstallMessageHandler(ApplicationLogger::customLogWriter);
+    QCoreApplication app(argc, argv);
+
+    // Command Line Parser
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Dipole Fit Performance Example");
+    parser.addHelpOption();
+    QCommandLineOption measOption("meas", "Path to the evoked <file>.", "file", QCoreApplication::applicationDirPath() + "/mne-cpp-test-data/MEG/sample/sample_audvis-ave.fif");
+    QCommandLineOption bemOption("bem", "Path to the BEM <file>. Leave empty to use a sphere model.", "file", QCoreApplication::applicationDirPath() + "/mne-cpp-test-data/subjects/sample/bem/sample-5120-bem.fif");
+    QCommandLineOption transOption("trans", "Path to the MRI <-> head transformation <file>.", "file", QCoreApplication::applicationDirPath() + "/mne-cpp-test-data/MEG/sample/all-trans.fif");
+    QCommandLineOption noiseOption("noise", "Path to the noise covariance <file>.", "file", QCoreApplication::applicationDirPath() + "/mne-cpp-test-data/MEG/sample/sample_audvis-cov.fif");
+    QCommandLineOption tminOption("tmin", "Start of the fitting interval in <ms>.", "ms", "0");
+    QCommandLineOption tmaxOption("tmax", "End of the fitting interval in <ms>.", "ms", "250");
+
+    parser.addOption(measOption);
+    parser.addOption(bemOption);
+    parser.addOption(transOption);
+    parser.addOption(noiseOption);
+    parser.addOption(tminOption);
+    parser.addOption(tmaxOption);
+    parser.process(app);
+
+    // Equivalent to: --meas <meas> --set 1 --noise <noise> --bem <bem> --mri <trans> --meg --tmin <tmin> --tmax <tmax>
+    // --mindist 0 --guessrad 100
+    DipoleFitSettings settings;
+    settings.measname = parser.value(measOption);
+    settings.is_raw = false;
+    settings.setno = 1;
+    settings.include_meg = true;
+    settings.include_eeg = false;
+    settings.tmin = parser.value(tminOption).toFloat()/1000.0f;
+    settings.tmax = parser.value(tmaxOption).toFloat()/1000.0f;
+    settings.bemname = parser.value(bemOption);
+    settings.mriname = parser.value(transOption);
+    settings.noisename = parser.value(noiseOption);
+    settings.projnames.append(settings.measname);
+    settings.bmin = 1000000.0f;
+    settings.bmax = 1000000.0f;
+    settings.guess_mindist = 0.0f;
+    settings.guess_rad = 0.1f;
+    settings.checkIntegrity();
+
+    QScopedPointer<DipoleFitData> fitData;
+    QScopedPointer<MneMeasData> measData;
+    QScopedPointer<GuessData> guess;
+    QElapsedTimer timer;
+
+    timer.start();
+    if(!setupFit(settings, fitData, measData, guess)) {
+        qCritical() << "Could not set up the dipole fit.";
+        return 1;
+    }
+    printf("\nSetup and guesses: %lld ms\n", timer.elapsed());
+
+    ECDSet setSimplex, setLm;
+
+    runFit(settings, fitData.data(), measData.data(), guess.data(), false, "Simplex", setSimplex);
+    runFit(settings, fitData.data(), measData.data(), guess.data(), true, "Levenberg-Marquardt", setLm);
+
+    // Compare the results
+    if(setSimplex.size() == setLm.size() && setLm.size() > 0) {
+        float fMaxDist = 0.0f;
+        float fMaxGoodDiff = 0.0f;
+        for(int i = 0; i < setLm.size(); ++i) {
+            fMaxDist = std::max(fMaxDist, (setLm[i].rd - setSimplex[i].rd).norm());
+            fMaxGoodDiff = std::max(fMaxGoodDiff, std::fabs(setLm[i].good - setSimplex[i].good));
+        }
+        printf("\nLargest difference in the dipole locations: %.2f mm, in the goodness of fit: %.2f %%\n",
+               1000*fMaxDist, 100*fMaxGoodDiff);
+    }
+
+    return 0;
+}
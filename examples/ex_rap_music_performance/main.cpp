@@ -0,0 +1,190 @@
+//=============================================================================================================
+/**
+ * @file     main.cpp
+ * @author   MNE-CPP authors
+ * @since    0.1.8
+ * @date     October, 2026
+ *
+ * @section  LICENSE
+ *
+ * Copyright (C) 2026, MNE-CPP authors. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ * the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+ *       following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ *       the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+ *       to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * @brief    Compares the time and the found dipole pairs of the exhaustive and the pruned RAP MUSIC pair search.
+ *
+ */
+
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <fs/annotationset.h>
+
+#include <fiff/fiff_evoked.h>
+
+#include <mne/mne.h>
+
+#include <inverse/rapMusic/rapmusic.h>
+
+#include <utils/generics/applicationlogger.h>
+
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtCore/QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QDebug>
+
+//=============================================================================================================
+// STL INCLUDES
+//=============================================================================================================
+
+#include <algorithm>
+
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace MNELIB;
+using namespace FSLIB;
+using namespace FIFFLIB;
+using namespace INVERSELIB;
+using namespace UTILSLIB;
+
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+//=============================================================================================================
+/**
+ * Run RAP MUSIC with the given search strategy and report the timing and the found dipole pairs.
+ *
+ * @param[in] rapMusic       The initialized RAP MUSIC object.
+ * @param[in] matData        The measurement.
+ * @param[in] sName          Name of the run to be printed.
+ * @param[out] dipoles       The found dipole pairs.
+ */
+void runRapMusic(RapMusic& rapMusic, const MatrixXd& matData, const QString& sName, QList< DipolePair<double> >& dipoles)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    rapMusic.calculateInverse(matData, dipoles);
+
+    qint64 iElapsed = timer.elapsed();
+
+    qInfo() << sName << "search:" << iElapsed << "ms";
+
+    for(int i = 0; i < dipoles.size(); ++i) {
+        qInfo() << "    Pair" << i+1 << ":" << dipoles[i].m_iIdx1 << "-" << dipoles[i].m_iIdx2
+                << "correlation" << dipoles[i].m_vCorrelation;
+    }
+}
+
+//=============================================================================================================
+/**
+ * The function main marks the entry point of the program.
+ * By default, main has the storage class extern.
+ *
+ * @param [in] argc (argument count) is an integer that indicates how many arguments were entered on the command line when the program was started.
+ * @param [in] argv (argument vector) is an array of pointers to arrays of character objects. The array objects are null-terminated strings, representing the arguments that were entered on the command line when the program was started.
+ * @return the value that was set to exit() (which is 0 if exit() is called via quit()).
+ */
+int main(int argc, char *argv[])
+{
+    qInstallMessageHandler(ApplicationLogger::customLogWriter);
+    QCoreApplication a(argc, argv);
+
+    // Command Line Parser
+    QCommandLineParser parser;
+    parser.setApplicationDescription("RAP MUSIC Pair Search Performance Example");
+    parser.addHelpOption();
+    QCommandLineOption fwdFileOption("fwd", "Path to the forward solution <file>.", "file", QCoreApplication::applicationDirPath() + "/MNE-sample-data/MEG/sample/sample_audvis-meg-eeg-oct-6-fwd.fif");
+    QCommandLineOption evokedFileOption("ave", "Path to the evoked/average <file>.", "file", QCoreApplication::applicationDirPath() + "/MNE-sample-data/MEG/sample/sample_audvis-ave.fif");
+    QCommandLineOption subjectDirectoryOption("subjDir", "Path to subject <directory>.", "directory", QCoreApplication::applicationDirPath() + "/MNE-sample-data/subjects");
+    QCommandLineOption subjectOption("subj", "Selected <subject>.", "subject", "sample");
+    QCommandLineOption annotOption("annotType", "Annotation type <type>.", "type", "aparc.a2009s");
+    QCommandLineOption clusterSizeOption("clusterSize", "Cluster <size> of the forward solution.", "size", "20");
+    QCommandLineOption numDipolePairsOption("numDip", "<number> of dipole pairs to localize.", "number", "2");
+    QCommandLineOption numCandidatesOption("candidates", "<number> of single point candidates of the pruned search.", "number", "200");
+    QCommandLineOption numTopPairsOption("topPairs", "<number> of candidate pairs which are scored exactly by the pruned search.", "number", "50");
+
+    parser.addOption(fwdFileOption);
+    parser.addOption(evokedFileOption);
+    parser.addOption(subjectDirectoryOption);
+    parser.addOption(subjectOption);
+    parser.addOption(annotOption);
+    parser.addOption(clusterSizeOption);
+    parser.addOption(numDipolePairsOption);
+    parser.addOption(numCandidatesOption);
+    parser.addOption(numTopPairsOption);
+    parser.process(a);
+
+    // Load data
+    QFile t_fileFwd(parser.value(fwdFileOption));
+    QFile t_fileEvoked(parser.value(evokedFileOption));
+
+    AnnotationSet t_annotationSet(parser.value(subjectOption), 2, parser.value(annotOption), parser.value(subjectDirectoryOption));
+
+    fiff_int_t setno = 1;
+    QPair<float, float> baseline(-1.0f, -1.0f);
+    FiffEvoked evoked(t_fileEvoked, setno, baseline);
+    if(evoked.isEmpty())
+        return 1;
+
+    MNEForwardSolution t_Fwd(t_fileFwd);
+    if(t_Fwd.isEmpty())
+        return 1;
+
+    FiffEvoked pickedEvoked = evoked.pick_channels(t_Fwd.info.ch_names);
+
+    // Cluster forward solution
+    MNEForwardSolution t_clusteredFwd = t_Fwd.cluster_forward_solution(t_annotationSet, parser.value(clusterSizeOption).toInt());
+
+    RapMusic t_rapMusic(t_clusteredFwd, false, parser.value(numDipolePairsOption).toInt());
+
+    qInfo() << "Number of grid points:" << t_clusteredFwd.sol->data.cols()/3;
+
+    // Exhaustive search
+    QList< DipolePair<double> > dipolesExhaustive;
+    t_rapMusic.setPairSearch(false);
+    runRapMusic(t_rapMusic, pickedEvoked.data, "Exhaustive", dipolesExhaustive);
+
+    // Pruned search
+    QList< DipolePair<double> > dipolesPruned;
+    t_rapMusic.setPairSearch(true,
+                             parser.value(numCandidatesOption).toInt(),
+                             parser.value(numTopPairsOption).toInt());
+    runRapMusic(t_rapMusic, pickedEvoked.data, "Pruned", dipolesPruned);
+
+    int iNumEqual = 0;
+    for(int i = 0; i < std::min(dipolesExhaustive.size(), dipolesPruned.size()); ++i) {
+        if(dipolesExhaustive[i].m_iIdx1 == dipolesPruned[i].m_iIdx1 && dipolesExhaustive[i].m_iIdx2 == dipolesPruned[i].m_iIdx2) {
+            ++iNumEqual;
+        }
+    }
+
+    qInfo() << "Equal dipole pairs:" << iNumEqual << "of" << dipolesExhaustive.size();
+
+    return 0;
+}
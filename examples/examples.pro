@@ -51,12 +51,14 @@ SUBDIRS += \
     ex_cancel_noise \
     ex_compute_forward \
     ex_coreg \
+    ex_dipole_fit_performance \
     ex_evoked_grad_amp \
     ex_fiff_io \
     ex_find_evoked \
     ex_inverse_mne \
     ex_make_inverse_operator \
     ex_make_layout \
+    ex_rap_music_performance \
     ex_read_bem \
     ex_read_epochs \
     ex_read_evoked \
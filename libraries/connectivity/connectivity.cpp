@@ -42,6 +42,7 @@
 
 #include "connectivitysettings.h"
 #include "network/network.h"
+#include "metrics/abstractmetric.h"
 #include "metrics/correlation.h"
 #include "metrics/crosscorrelation.h"
 #include "metrics/coherence.h"
@@ -52,6 +53,8 @@
 #include "metrics/unbiasedsquaredphaselagindex.h"
 #include "metrics/debiasedsquaredweightedphaselagindex.h"
 
+#include <utils/spectral.h>
+
 //=============================================================================================================
 // QT INCLUDES
 //=============================================================================================================
@@ -59,16 +62,21 @@
 #include <QDebug>
 #include <QFutureSynchronizer>
 #include <QtConcurrent>
+#include <QMutex>
 
 //=============================================================================================================
 // EIGEN INCLUDES
 //=============================================================================================================
 
+#include <unsupported/Eigen/FFT>
+
 //=============================================================================================================
 // USED NAMESPACES
 //=============================================================================================================
 
 using namespace CONNECTIVITYLIB;
+using namespace UTILSLIB;
+using namespace Eigen;
 
 //=============================================================================================================
 // DEFINE GLOBAL METHODS
@@ -91,11 +99,15 @@ QList<Network> Connectivity::calculate(ConnectivitySettings& connectivitySetting
     QElapsedTimer timer;
     timer.start();
 
+    bool bSpectralCacheIsActive = prepareSpectralCache(connectivitySettings);
+
     if(lMethods.contains("WPLI")) {
+        updateSpectralCacheStatistics(connectivitySettings, "WPLI");
         results.append(WeightedPhaseLagIndex::calculate(connectivitySettings));
     }
 
     if(lMethods.contains("USPLI")) {
+        updateSpectralCacheStatistics(connectivitySettings, "USPLI");
         results.append(UnbiasedSquaredPhaseLagIndex::calculate(connectivitySettings));
     }
 
@@ -104,31 +116,194 @@ QList<Network> Connectivity::calculate(ConnectivitySettings& connectivitySetting
     }
 
     if(lMethods.contains("XCOR")) {
+        updateSpectralCacheStatistics(connectivitySettings, "XCOR", false);
         results.append(CrossCorrelation::calculate(connectivitySettings));
     }
 
     if(lMethods.contains("PLI")) {
+        updateSpectralCacheStatistics(connectivitySettings, "PLI");
         results.append(PhaseLagIndex::calculate(connectivitySettings));
     }
 
     if(lMethods.contains("COH")) {
+        updateSpectralCacheStatistics(connectivitySettings, "COH");
         results.append(Coherence::calculate(connectivitySettings));
     }
 
     if(lMethods.contains("IMAGCOH")) {
+        updateSpectralCacheStatistics(connectivitySettings, "IMAGCOH");
         results.append(ImagCoherence::calculate(connectivitySettings));
     }
 
     if(lMethods.contains("PLV")) {
+        updateSpectralCacheStatistics(connectivitySettings, "PLV");
         results.append(PhaseLockingValue::calculate(connectivitySettings));
     }
 
     if(lMethods.contains("DSWPLI")) {
+        updateSpectralCacheStatistics(connectivitySettings, "DSWPLI");
         results.append(DebiasedSquaredWeightedPhaseLagIndex::calculate(connectivitySettings));
     }
 
+    if(bSpectralCacheIsActive) {
+        connectivitySettings.setSpectralCacheActive(false);
+
+        // Release the shared spectra and CSDs if they are not supposed to be stored
+        if(!AbstractMetric::m_bStorageModeIsActive && !connectivitySettings.isStorageModeActive()) {
+            connectivitySettings.clearIntermediateData();
+        }
+    }
+
     qWarning() << "Total" << timer.elapsed();
     qDebug() << "Connectivity::calculateMultiMethods - Calculated"<< lMethods <<"for" << connectivitySettings.size() << "trials in"<< timer.elapsed() << "msecs.";
 
     return results;
 }
+
+//=============================================================================================================
+
+bool Connectivity::prepareSpectralCache(ConnectivitySettings& connectivitySettings)
+{
+    ConnectivitySettings::SpectralCacheStatistics& stats = connectivitySettings.getSpectralCacheStatistics();
+    stats.bIsActive = false;
+    stats.iNumBytes = 0;
+    stats.iNumTrialsComputed = 0;
+    stats.mapSpectraHits.clear();
+    stats.mapCsdHits.clear();
+
+    if(connectivitySettings.isEmpty() || connectivitySettings.getSpectralCacheSize() <= 0) {
+        return false;
+    }
+
+    // Sharing only pays off if more than one spectral metric is requested
+    const QStringList& lMethods = connectivitySettings.getConnectivityMethods();
+    QStringList lSpectralMethods;
+    lSpectralMethods << "WPLI" << "USPLI" << "XCOR" << "PLI" << "COH" << "IMAGCOH" << "PLV" << "DSWPLI";
+
+    int iNumSpectralMethods = 0;
+    for(int i = 0; i < lSpectralMethods.size(); ++i) {
+        if(lMethods.contains(lSpectralMethods.at(i))) {
+            ++iNumSpectralMethods;
+        }
+    }
+
+    if(iNumSpectralMethods < 2) {
+        return false;
+    }
+
+    // Check if start and bin amount need to be reset to full spectrum
+    int iNfft = connectivitySettings.getFFTSize();
+    int iNFreqs = int(floor(iNfft / 2.0)) + 1;
+
+    if(AbstractMetric::m_iNumberBinStart == -1 ||
+       AbstractMetric::m_iNumberBinAmount == -1 ||
+       AbstractMetric::m_iNumberBinStart > iNFreqs ||
+       AbstractMetric::m_iNumberBinAmount > iNFreqs ||
+       AbstractMetric::m_iNumberBinAmount + AbstractMetric::m_iNumberBinStart > iNFreqs) {
+        qDebug() << "Connectivity::prepareSpectralCache - Resetting to full spectrum";
+        AbstractMetric::m_iNumberBinStart = 0;
+        AbstractMetric::m_iNumberBinAmount = iNFreqs;
+    }
+
+    int iSignalLength = connectivitySettings.at(0).matData.cols();
+    int iNRows = connectivitySettings.at(0).matData.rows();
+
+    // Generate tapers
+    QPair<MatrixXd, VectorXd> tapers = Spectral::generateTapers(iSignalLength, connectivitySettings.getWindowType());
+
+    // Estimate the memory of the tapered spectra, the packed CSDs and the CSD derived data the requested metrics keep per trial
+    qint64 iNumCsdValues = qint64(ConnectivitySettings::getNumberOfPairs(iNRows)) * AbstractMetric::m_iNumberBinAmount;
+    qint64 iNumDerivedValues = 0;
+    if(lMethods.contains("PLI") || lMethods.contains("USPLI")) {
+        iNumDerivedValues += iNumCsdValues;
+    }
+    if(lMethods.contains("WPLI") || lMethods.contains("DSWPLI")) {
+        iNumDerivedValues += iNumCsdValues;
+    }
+    if(lMethods.contains("DSWPLI")) {
+        iNumDerivedValues += iNumCsdValues;
+    }
+    if(lMethods.contains("PLV")) {
+        iNumDerivedValues += 2 * iNumCsdValues;
+    }
+
+    qint64 iNumBytesPerTrial = qint64(iNRows) * tapers.first.rows() * iNFreqs * qint64(sizeof(std::complex<double>))
+                               + iNumCsdValues * qint64(sizeof(std::complex<double>))
+                               + iNumDerivedValues * qint64(sizeof(double));
+    qint64 iNumBytes = iNumBytesPerTrial * connectivitySettings.size();
+
+    if(iNumBytes > connectivitySettings.getSpectralCacheSize()) {
+        qDebug() << "Connectivity::prepareSpectralCache - Estimated cache size of" << iNumBytes << "bytes exceeds the budget of" << connectivitySettings.getSpectralCacheSize() << "bytes. Computing spectra per metric.";
+        return false;
+    }
+
+    // The metrics must neither clear nor recompute the shared data while the request is running
+    if(!AbstractMetric::m_bStorageModeIsActive && !connectivitySettings.isStorageModeActive()) {
+        connectivitySettings.clearIntermediateData();
+    }
+
+    connectivitySettings.setSpectralCacheActive(true);
+
+    for(int i = 0; i < connectivitySettings.size(); ++i) {
+        if(connectivitySettings.at(i).matCsd.rows() != ConnectivitySettings::getNumberOfPairs(iNRows)) {
+            ++stats.iNumTrialsComputed;
+        }
+    }
+
+    #ifdef EIGEN_FFTW_DEFAULT
+        fftw_make_planner_thread_safe();
+    #endif
+
+    // Compute tapered spectra and CSD for each trial in parallel
+    QMutex mutex;
+
+    std::function<void(ConnectivitySettings::IntermediateTrialData&)> computeLambda = [&](ConnectivitySettings::IntermediateTrialData& inputData) {
+        AbstractMetric::computeSpectraAndCsd(inputData,
+                                             connectivitySettings.getIntermediateSumData().matCsdSum,
+                                             mutex,
+                                             iNRows,
+                                             iNFreqs,
+                                             iNfft,
+                                             tapers);
+    };
+
+    QFuture<void> result = QtConcurrent::map(connectivitySettings.getTrialData(),
+                                             computeLambda);
+    result.waitForFinished();
+
+    stats.bIsActive = true;
+    stats.iNumBytes = iNumBytes;
+
+    return true;
+}
+
+//=============================================================================================================
+
+void Connectivity::updateSpectralCacheStatistics(ConnectivitySettings& connectivitySettings,
+                                                 const QString& sMethod,
+                                                 bool bUsesCsd)
+{
+    if(connectivitySettings.isEmpty()) {
+        return;
+    }
+
+    int iNRows = connectivitySettings.at(0).matData.rows();
+    int iNumSpectraHits = 0;
+    int iNumCsdHits = 0;
+
+    for(int i = 0; i < connectivitySettings.size(); ++i) {
+        if(connectivitySettings.at(i).vecTapSpectra.size() == iNRows) {
+            ++iNumSpectraHits;
+        }
+        if(bUsesCsd && connectivitySettings.at(i).matCsd.rows() == ConnectivitySettings::getNumberOfPairs(iNRows)) {
+            ++iNumCsdHits;
+        }
+    }
+
+    ConnectivitySettings::SpectralCacheStatistics& stats = connectivitySettings.getSpectralCacheStatistics();
+    stats.mapSpectraHits[sMethod] = iNumSpectraHits;
+
+    if(bUsesCsd) {
+        stats.mapCsdHits[sMethod] = iNumCsdHits;
+    }
+}
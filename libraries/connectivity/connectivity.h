@@ -46,6 +46,7 @@
 //=============================================================================================================
 
 #include <QSharedPointer>
+#include <QString>
 
 //=============================================================================================================
 // EIGEN INCLUDES
@@ -98,6 +99,29 @@ public:
     static QList<Network> calculate(ConnectivitySettings& connectivitySettings);
 
 protected:
+    //=========================================================================================================
+    /**
+     * Computes the tapered spectra and CSDs of all trials once, so that they can be shared read-only by all
+     * requested spectral metrics. The cache is only used if more than one spectral metric is requested and if
+     * its estimated memory fits into the budget set via ConnectivitySettings::setSpectralCacheSize.
+     *
+     * @param[in] connectivitySettings   The input data and parameters.
+     *
+     * @return Returns true if the spectral cache is active for this request, false otherwise.
+     */
+    static bool prepareSpectralCache(ConnectivitySettings& connectivitySettings);
+
+    //=========================================================================================================
+    /**
+     * Counts the trials for which the tapered spectra and CSDs are available before a metric runs.
+     *
+     * @param[in] connectivitySettings   The input data and parameters.
+     * @param[in] sMethod                The name of the metric which is about to run.
+     * @param[in] bUsesCsd               Whether the metric uses the CSD or only the tapered spectra.
+     */
+    static void updateSpectralCacheStatistics(ConnectivitySettings& connectivitySettings,
+                                              const QString& sMethod,
+                                              bool bUsesCsd = true);
 };
 
 //=============================================================================================================
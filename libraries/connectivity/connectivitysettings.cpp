@@ -76,7 +76,14 @@ ConnectivitySettings::ConnectivitySettings()
 : m_fFreqResolution(1.0f)
 , m_fSFreq(1000.0f)
 , m_sWindowType("hanning")
+, m_iSpectralCacheSize(qint64(512) * 1024 * 1024)
+, m_bStorageModeIsActive(false)
+, m_bSpectralCacheIsActive(false)
 {
+    m_spectralCacheStatistics.bIsActive = false;
+    m_spectralCacheStatistics.iNumBytes = 0;
+    m_spectralCacheStatistics.iNumTrialsComputed = 0;
+
     m_iNfft = int(m_fSFreq/m_fFreqResolution);
     qRegisterMetaType<CONNECTIVITYLIB::ConnectivitySettings>("CONNECTIVITYLIB::ConnectivitySettings");
 }
@@ -96,20 +103,24 @@ void ConnectivitySettings::clearIntermediateData()
 {
     for (int i = 0; i < m_trialData.size(); ++i) {
         m_trialData[i].matPsd.resize(0,0);
-        m_trialData[i].vecPairCsd.clear();
         m_trialData[i].vecTapSpectra.clear();
-        m_trialData[i].vecPairCsdNormalized.clear();
-        m_trialData[i].vecPairCsdImagSign.clear();
-        m_trialData[i].vecPairCsdImagAbs.clear();
-        m_trialData[i].vecPairCsdImagSqrd.clear();
+        m_trialData[i].matCsd.resize(0,0);
+        m_trialData[i].matCsdNormalized.resize(0,0);
+        m_trialData[i].matCsdImagSign.resize(0,0);
+        m_trialData[i].matCsdImagAbs.resize(0,0);
+        m_trialData[i].matCsdImagSqrd.resize(0,0);
+        m_trialData[i].matCorr.resize(0,0);
+        m_trialData[i].matXCorr.resize(0,0);
     }
 
     m_intermediateSumData.matPsdSum.resize(0,0);
-    m_intermediateSumData.vecPairCsdSum.clear();
-    m_intermediateSumData.vecPairCsdNormalizedSum.clear();
-    m_intermediateSumData.vecPairCsdImagSignSum.clear();
-    m_intermediateSumData.vecPairCsdImagAbsSum.clear();
-    m_intermediateSumData.vecPairCsdImagSqrdSum.clear();
+    m_intermediateSumData.matCsdSum.resize(0,0);
+    m_intermediateSumData.matCsdNormalizedSum.resize(0,0);
+    m_intermediateSumData.matCsdImagSignSum.resize(0,0);
+    m_intermediateSumData.matCsdImagAbsSum.resize(0,0);
+    m_intermediateSumData.matCsdImagSqrdSum.resize(0,0);
+    m_intermediateSumData.matCorrSum.resize(0,0);
+    m_intermediateSumData.matXCorrSum.resize(0,0);
 }
 
 //*******************************************************************************************************
@@ -179,28 +190,7 @@ void ConnectivitySettings::removeFirst(int iAmount)
 
     // Substract influence of trials from overall summed up intermediate data and remove from data list
     for (int j = 0; j < iAmount; ++j) {
-        for (int i = 0; i < m_trialData.first().matData.rows(); ++i) {
-            if(i < m_intermediateSumData.vecPairCsdSum.size() && (m_intermediateSumData.vecPairCsdSum.size() == m_trialData.first().vecPairCsd.size())) {
-                m_intermediateSumData.vecPairCsdSum[i].second -= m_trialData.first().vecPairCsd.at(i).second;
-            }
-            if(i < m_intermediateSumData.vecPairCsdNormalizedSum.size() && (m_intermediateSumData.vecPairCsdNormalizedSum.size() == m_trialData.first().vecPairCsdNormalized.size())) {
-                m_intermediateSumData.vecPairCsdNormalizedSum[i].second -= m_trialData.first().vecPairCsdNormalized.at(i).second;
-            }
-            if(i < m_intermediateSumData.vecPairCsdImagSignSum.size() && (m_intermediateSumData.vecPairCsdImagSignSum.size() == m_trialData.first().vecPairCsdImagSign.size())) {
-                m_intermediateSumData.vecPairCsdImagSignSum[i].second -= m_trialData.first().vecPairCsdImagSign.at(i).second;
-            }
-            if(i < m_intermediateSumData.vecPairCsdImagAbsSum.size() && (m_intermediateSumData.vecPairCsdImagAbsSum.size() == m_trialData.first().vecPairCsdImagAbs.size())) {
-                m_intermediateSumData.vecPairCsdImagAbsSum[i].second -= m_trialData.first().vecPairCsdImagAbs.at(i).second;
-            }
-            if(i < m_intermediateSumData.vecPairCsdImagSqrdSum.size() && (m_intermediateSumData.vecPairCsdImagSqrdSum.size() == m_trialData.first().vecPairCsdImagSqrd.size())) {
-                m_intermediateSumData.vecPairCsdImagSqrdSum[i].second -= m_trialData.first().vecPairCsdImagSqrd.at(i).second;
-            }
-        }
-
-        if(m_intermediateSumData.matPsdSum.rows() == m_trialData.first().matPsd.rows() &&
-           m_intermediateSumData.matPsdSum.cols() == m_trialData.first().matPsd.cols() ) {
-            m_intermediateSumData.matPsdSum -= m_trialData.first().matPsd;
-        }
+        subtractFromSum(m_trialData.first());
 
         m_trialData.removeFirst();
     }
@@ -230,28 +220,7 @@ void ConnectivitySettings::removeLast(int iAmount)
 
     // Substract influence of trials from overall summed up intermediate data and remove from data list
     for (int j = 0; j < iAmount; ++j) {
-        for (int i = 0; i < m_trialData.last().matData.rows(); ++i) {
-            if(i < m_intermediateSumData.vecPairCsdSum.size() && (m_intermediateSumData.vecPairCsdSum.size() == m_trialData.last().vecPairCsd.size())) {
-                m_intermediateSumData.vecPairCsdSum[i].second -= m_trialData.last().vecPairCsd.at(i).second;
-            }
-            if(i < m_intermediateSumData.vecPairCsdNormalizedSum.size() && (m_intermediateSumData.vecPairCsdNormalizedSum.size() == m_trialData.last().vecPairCsdNormalized.size())) {
-                m_intermediateSumData.vecPairCsdNormalizedSum[i].second -= m_trialData.last().vecPairCsdNormalized.at(i).second;
-            }
-            if(i < m_intermediateSumData.vecPairCsdImagSignSum.size() && (m_intermediateSumData.vecPairCsdImagSignSum.size() == m_trialData.last().vecPairCsdImagSign.size())) {
-                m_intermediateSumData.vecPairCsdImagSignSum[i].second -= m_trialData.last().vecPairCsdImagSign.at(i).second;
-            }
-            if(i < m_intermediateSumData.vecPairCsdImagAbsSum.size() && (m_intermediateSumData.vecPairCsdImagAbsSum.size() == m_trialData.last().vecPairCsdImagAbs.size())) {
-                m_intermediateSumData.vecPairCsdImagAbsSum[i].second -= m_trialData.last().vecPairCsdImagAbs.at(i).second;
-            }
-            if(i < m_intermediateSumData.vecPairCsdImagSqrdSum.size() && (m_intermediateSumData.vecPairCsdImagSqrdSum.size() == m_trialData.last().vecPairCsdImagSqrd.size())) {
-                m_intermediateSumData.vecPairCsdImagSqrdSum[i].second -= m_trialData.last().vecPairCsdImagSqrd.at(i).second;
-            }
-        }
-
-        if(m_intermediateSumData.matPsdSum.rows() == m_trialData.last().matPsd.rows() &&
-           m_intermediateSumData.matPsdSum.cols() == m_trialData.last().matPsd.cols() ) {
-            m_intermediateSumData.matPsdSum -= m_trialData.last().matPsd;
-        }
+        subtractFromSum(m_trialData.last());
 
         m_trialData.removeLast();
     }
@@ -416,3 +385,90 @@ ConnectivitySettings::IntermediateSumData& ConnectivitySettings::getIntermediate
 {
     return m_intermediateSumData;
 }
+
+//*******************************************************************************************************
+
+void ConnectivitySettings::setSpectralCacheSize(qint64 iMaxBytes)
+{
+    m_iSpectralCacheSize = iMaxBytes;
+}
+
+//*******************************************************************************************************
+
+qint64 ConnectivitySettings::getSpectralCacheSize() const
+{
+    return m_iSpectralCacheSize;
+}
+
+//*******************************************************************************************************
+
+ConnectivitySettings::SpectralCacheStatistics& ConnectivitySettings::getSpectralCacheStatistics()
+{
+    return m_spectralCacheStatistics;
+}
+
+//*******************************************************************************************************
+
+void ConnectivitySettings::setStorageModeActive(bool bStorageModeIsActive)
+{
+    m_bStorageModeIsActive = bStorageModeIsActive;
+}
+
+//*******************************************************************************************************
+
+bool ConnectivitySettings::isStorageModeActive() const
+{
+    return m_bStorageModeIsActive;
+}
+
+//*******************************************************************************************************
+
+void ConnectivitySettings::setSpectralCacheActive(bool bSpectralCacheIsActive)
+{
+    m_bSpectralCacheIsActive = bSpectralCacheIsActive;
+}
+
+//*******************************************************************************************************
+
+bool ConnectivitySettings::isSpectralCacheActive() const
+{
+    return m_bSpectralCacheIsActive;
+}
+
+//*******************************************************************************************************
+
+void ConnectivitySettings::subtractFromSum(const IntermediateTrialData& trialData)
+{
+    if(m_intermediateSumData.matCsdSum.rows() == trialData.matCsd.rows() &&
+       m_intermediateSumData.matCsdSum.cols() == trialData.matCsd.cols()) {
+        m_intermediateSumData.matCsdSum -= trialData.matCsd;
+    }
+    if(m_intermediateSumData.matCsdNormalizedSum.rows() == trialData.matCsdNormalized.rows() &&
+       m_intermediateSumData.matCsdNormalizedSum.cols() == trialData.matCsdNormalized.cols()) {
+        m_intermediateSumData.matCsdNormalizedSum -= trialData.matCsdNormalized;
+    }
+    if(m_intermediateSumData.matCsdImagSignSum.rows() == trialData.matCsdImagSign.rows() &&
+       m_intermediateSumData.matCsdImagSignSum.cols() == trialData.matCsdImagSign.cols()) {
+        m_intermediateSumData.matCsdImagSignSum -= trialData.matCsdImagSign;
+    }
+    if(m_intermediateSumData.matCsdImagAbsSum.rows() == trialData.matCsdImagAbs.rows() &&
+       m_intermediateSumData.matCsdImagAbsSum.cols() == trialData.matCsdImagAbs.cols()) {
+        m_intermediateSumData.matCsdImagAbsSum -= trialData.matCsdImagAbs;
+    }
+    if(m_intermediateSumData.matCsdImagSqrdSum.rows() == trialData.matCsdImagSqrd.rows() &&
+       m_intermediateSumData.matCsdImagSqrdSum.cols() == trialData.matCsdImagSqrd.cols()) {
+        m_intermediateSumData.matCsdImagSqrdSum -= trialData.matCsdImagSqrd;
+    }
+    if(m_intermediateSumData.matPsdSum.rows() == trialData.matPsd.rows() &&
+       m_intermediateSumData.matPsdSum.cols() == trialData.matPsd.cols() ) {
+        m_intermediateSumData.matPsdSum -= trialData.matPsd;
+    }
+    if(m_intermediateSumData.matCorrSum.rows() == trialData.matCorr.rows() &&
+       m_intermediateSumData.matCorrSum.cols() == trialData.matCorr.cols()) {
+        m_intermediateSumData.matCorrSum -= trialData.matCorr;
+    }
+    if(m_intermediateSumData.matXCorrSum.rows() == trialData.matXCorr.rows() &&
+       m_intermediateSumData.matXCorrSum.cols() == trialData.matXCorr.cols()) {
+        m_intermediateSumData.matXCorrSum -= trialData.matXCorr;
+    }
+}
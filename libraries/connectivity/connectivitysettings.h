@@ -49,6 +49,7 @@
 #include <QSharedPointer>
 #include <QStringList>
 #include <QVector>
+#include <QMap>
 
 //=============================================================================================================
 // EIGEN INCLUDES
@@ -99,20 +100,32 @@ public:
         Eigen::MatrixXd     matData;
         Eigen::MatrixXd     matPsd;
         QVector<Eigen::MatrixXcd>               vecTapSpectra;
-        QVector<QPair<int,Eigen::MatrixXcd> >   vecPairCsd;
-        QVector<QPair<int,Eigen::MatrixXcd> >   vecPairCsdNormalized;
-        QVector<QPair<int,Eigen::MatrixXd> >    vecPairCsdImagSign;
-        QVector<QPair<int,Eigen::MatrixXd> >    vecPairCsdImagAbs;
-        QVector<QPair<int,Eigen::MatrixXd> >    vecPairCsdImagSqrd;
+        Eigen::MatrixXcd    matCsd;                 /**< The CSD packed as pairs x frequency bins. See getPairIndex for the pair order. */
+        Eigen::MatrixXcd    matCsdNormalized;
+        Eigen::MatrixXd     matCsdImagSign;
+        Eigen::MatrixXd     matCsdImagAbs;
+        Eigen::MatrixXd     matCsdImagSqrd;
+        Eigen::MatrixXd     matCorr;                /**< The correlation packed as pairs x 1. */
+        Eigen::MatrixXd     matXCorr;               /**< The maximum cross correlation packed as pairs x 1. */
     };
 
     struct IntermediateSumData {
         Eigen::MatrixXd     matPsdSum;
-        QVector<QPair<int,Eigen::MatrixXcd> >   vecPairCsdSum;
-        QVector<QPair<int,Eigen::MatrixXcd> >   vecPairCsdNormalizedSum;
-        QVector<QPair<int,Eigen::MatrixXd> >    vecPairCsdImagSignSum;
-        QVector<QPair<int,Eigen::MatrixXd> >    vecPairCsdImagAbsSum;
-        QVector<QPair<int,Eigen::MatrixXd> >    vecPairCsdImagSqrdSum;
+        Eigen::MatrixXcd    matCsdSum;
+        Eigen::MatrixXcd    matCsdNormalizedSum;
+        Eigen::MatrixXd     matCsdImagSignSum;
+        Eigen::MatrixXd     matCsdImagAbsSum;
+        Eigen::MatrixXd     matCsdImagSqrdSum;
+        Eigen::MatrixXd     matCorrSum;
+        Eigen::MatrixXd     matXCorrSum;
+    };
+
+    struct SpectralCacheStatistics {
+        bool                bIsActive;              /**< Whether the last request shared its tapered spectra and CSDs between the metrics. */
+        qint64              iNumBytes;              /**< The estimated memory held by the spectral cache during the last request. */
+        int                 iNumTrialsComputed;     /**< The number of trials whose tapered spectra and CSD were computed by the cache. */
+        QMap<QString,int>   mapSpectraHits;         /**< The number of trials per metric which reused cached tapered spectra. */
+        QMap<QString,int>   mapCsdHits;             /**< The number of trials per metric which reused a cached CSD. */
     };
 
     //=========================================================================================================
@@ -171,7 +184,76 @@ public:
 
     IntermediateSumData& getIntermediateSumData();
 
+    //=========================================================================================================
+    /**
+     * Returns the number of channel pairs (i,j) with i <= j, i.e. the number of rows of the packed CSD data.
+     *
+     * @param[in] iNRows    The number of channels.
+     *
+     * @return The number of packed channel pairs.
+     */
+    static inline int getNumberOfPairs(int iNRows);
+
+    //=========================================================================================================
+    /**
+     * Returns the row of the channel pair (i,j) with i <= j in the packed CSD data. The pairs are stored row-wise
+     * along the upper triangle, i.e. (0,0), (0,1), ..., (0,n-1), (1,1), (1,2), ...
+     *
+     * @param[in] i         The first channel.
+     * @param[in] j         The second channel. Must not be smaller than i.
+     * @param[in] iNRows    The number of channels.
+     *
+     * @return The row index of the channel pair.
+     */
+    static inline int getPairIndex(int i,
+                                   int j,
+                                   int iNRows);
+
+    //=========================================================================================================
+    /**
+     * Sets the memory budget of the spectral cache. If the tapered spectra and CSDs of all trials do not fit
+     * into the budget, every metric computes them on its own. A budget of zero disables the cache.
+     *
+     * @param[in] iMaxBytes     The maximum number of bytes the spectral cache may hold.
+     */
+    void setSpectralCacheSize(qint64 iMaxBytes);
+
+    qint64 getSpectralCacheSize() const;
+
+    SpectralCacheStatistics& getSpectralCacheStatistics();
+
+    //=========================================================================================================
+    /**
+     * Sets the storage mode of this request. In storage mode the metrics keep the intermediate data of every trial,
+     * so that trials can be added and removed without recomputing the others. The storage mode is also active if
+     * AbstractMetric::m_bStorageModeIsActive is set.
+     *
+     * @param[in] bStorageModeIsActive  Whether the intermediate data of the trials is kept.
+     */
+    void setStorageModeActive(bool bStorageModeIsActive);
+
+    bool isStorageModeActive() const;
+
+    //=========================================================================================================
+    /**
+     * Marks whether the tapered spectra and CSDs of the trials are currently shared between the metrics. This is
+     * set by Connectivity::calculate for the duration of the request.
+     *
+     * @param[in] bSpectralCacheIsActive    Whether the spectral cache is in use.
+     */
+    void setSpectralCacheActive(bool bSpectralCacheIsActive);
+
+    bool isSpectralCacheActive() const;
+
 protected:
+    //=========================================================================================================
+    /**
+     * Substracts the intermediate data of a trial from the intermediate sum data.
+     *
+     * @param[in] trialData     The trial which is about to be removed.
+     */
+    void subtractFromSum(const IntermediateTrialData& trialData);
+
     QStringList                     m_sConnectivityMethods;         /**< The connectivity methods. */
     QString                         m_sWindowType;                  /**< The window type used to compute tapered spectra. */
 
@@ -183,10 +265,31 @@ protected:
 
     IntermediateSumData             m_intermediateSumData;          /**< The intermediate sum data holds data calculated over all trials as a whole. */
     QList<IntermediateTrialData>    m_trialData;                    /**< The trial data holds the actual and intermediate data calcualted for each trial. */
+
+    qint64                          m_iSpectralCacheSize;           /**< The memory budget in bytes of the spectral cache shared between the metrics. */
+    SpectralCacheStatistics         m_spectralCacheStatistics;      /**< The reuse statistics of the spectral cache for the last request. */
+    bool                            m_bStorageModeIsActive;         /**< Whether the metrics keep the intermediate data of the trials of this request. */
+    bool                            m_bSpectralCacheIsActive;       /**< Whether the tapered spectra and CSDs are shared between the metrics of the running request. */
 };
 
 //=============================================================================================================
 // INLINE DEFINITIONS
+//=============================================================================================================
+
+inline int ConnectivitySettings::getNumberOfPairs(int iNRows)
+{
+    return iNRows * (iNRows + 1) / 2;
+}
+
+//=============================================================================================================
+
+inline int ConnectivitySettings::getPairIndex(int i,
+                                              int j,
+                                              int iNRows)
+{
+    return i * iNRows - i * (i - 1) / 2 + j - i;
+}
+
 //=============================================================================================================
 } // namespace CONNECTIVITYLIB
 
@@ -46,11 +46,14 @@
 // EIGEN INCLUDES
 //=============================================================================================================
 
+#include <unsupported/Eigen/FFT>
+
 //=============================================================================================================
 // USED NAMESPACES
 //=============================================================================================================
 
 using namespace CONNECTIVITYLIB;
+using namespace Eigen;
 
 //=============================================================================================================
 // DEFINE GLOBAL METHODS
@@ -68,3 +71,139 @@ AbstractMetric::AbstractMetric()
 {
 }
 
+//=============================================================================================================
+
+void AbstractMetric::computeTaperedSpectra(ConnectivitySettings::IntermediateTrialData& inputData,
+                                           int iNRows,
+                                           int iNFreqs,
+                                           int iNfft,
+                                           const QPair<MatrixXd, VectorXd>& tapers)
+{
+    if(inputData.vecTapSpectra.size() == iNRows) {
+        return;
+    }
+
+    inputData.vecTapSpectra.clear();
+
+    // This code was copied and changed modified Utils/Spectra since we do not want to call the function due to time loss.
+    RowVectorXd vecInputFFT, rowData;
+    RowVectorXcd vecTmpFreq;
+
+    MatrixXcd matTapSpectrum(tapers.first.rows(), iNFreqs);
+
+    FFT<double> fft;
+    fft.SetFlag(fft.HalfSpectrum);
+
+    for (int i = 0; i < iNRows; ++i) {
+        // Substract mean
+        rowData.array() = inputData.matData.row(i).array() - inputData.matData.row(i).mean();
+
+        for(int j = 0; j < tapers.first.rows(); j++) {
+            // Zero padd if necessary. The zero padding in Eigen's FFT is only working for column vectors.
+            if (rowData.cols() < iNfft) {
+                vecInputFFT.setZero(iNfft);
+                vecInputFFT.block(0,0,1,rowData.cols()) = rowData.cwiseProduct(tapers.first.row(j));
+            } else {
+                vecInputFFT = rowData.cwiseProduct(tapers.first.row(j));
+            }
+
+            // FFT for freq domain returning the half spectrum and multiply taper weights
+            fft.fwd(vecTmpFreq, vecInputFFT, iNfft);
+            matTapSpectrum.row(j) = vecTmpFreq * tapers.second(j);
+        }
+
+        inputData.vecTapSpectra.append(matTapSpectrum);
+    }
+}
+
+//=============================================================================================================
+
+void AbstractMetric::computeCsd(ConnectivitySettings::IntermediateTrialData& inputData,
+                                int iNRows,
+                                int iNFreqs,
+                                int iNfft,
+                                const QPair<MatrixXd, VectorXd>& tapers)
+{
+    int iNTapers = tapers.first.rows();
+    int iNPairs = ConnectivitySettings::getNumberOfPairs(iNRows);
+
+    // Gather the spectra so that the tapers of one frequency bin form a contiguous block of columns
+    MatrixXcd matSpectra(iNRows, iNTapers * m_iNumberBinAmount);
+
+    for (int i = 0; i < iNRows; ++i) {
+        const MatrixXcd& matTapSpectrum = inputData.vecTapSpectra.at(i);
+
+        for (int k = 0; k < m_iNumberBinAmount; ++k) {
+            matSpectra.row(i).segment(k * iNTapers, iNTapers) = matTapSpectrum.col(m_iNumberBinStart + k).transpose();
+        }
+    }
+
+    double denomCSD = sqrt(tapers.second.cwiseAbs2().sum()) * sqrt(tapers.second.cwiseAbs2().sum()) / 2.0;
+    bool bNfftEven = false;
+    if (iNfft % 2 == 0){
+        bNfftEven = true;
+    }
+
+    inputData.matCsd.resize(iNPairs, m_iNumberBinAmount);
+    MatrixXcd matCrossSpectrum(iNRows, iNRows);
+    int p;
+
+    for (int k = 0; k < m_iNumberBinAmount; ++k) {
+        // Hermitian rank update S * S^H over the tapers (average over tapers if necessary). The lower triangle
+        // holds the conjugated CSD of the pairs (i,j) with i <= j column-wise, which matches the packed order.
+        matCrossSpectrum.setZero();
+        matCrossSpectrum.selfadjointView<Lower>().rankUpdate(matSpectra.middleCols(k * iNTapers, iNTapers));
+
+        p = 0;
+        for (int i = 0; i < iNRows; ++i) {
+            inputData.matCsd.col(k).segment(p, iNRows - i) = matCrossSpectrum.col(i).conjugate().tail(iNRows - i);
+            p += iNRows - i;
+        }
+    }
+
+    inputData.matCsd /= denomCSD;
+
+    // Divide first and last element by 2 due to half spectrum
+    if(m_iNumberBinStart == 0) {
+        inputData.matCsd.col(0) /= 2.0;
+    }
+
+    if(bNfftEven && m_iNumberBinStart + m_iNumberBinAmount >= iNFreqs) {
+        inputData.matCsd.rightCols(1) /= 2.0;
+    }
+}
+
+//=============================================================================================================
+
+void AbstractMetric::computeSpectraAndCsd(ConnectivitySettings::IntermediateTrialData& inputData,
+                                          MatrixXcd& matCsdSum,
+                                          QMutex& mutex,
+                                          int iNRows,
+                                          int iNFreqs,
+                                          int iNfft,
+                                          const QPair<MatrixXd, VectorXd>& tapers)
+{
+    if(inputData.matCsd.rows() == ConnectivitySettings::getNumberOfPairs(iNRows)) {
+        return;
+    }
+
+    computeTaperedSpectra(inputData, iNRows, iNFreqs, iNfft, tapers);
+    computeCsd(inputData, iNRows, iNFreqs, iNfft, tapers);
+
+    mutex.lock();
+
+    if(matCsdSum.size() == 0) {
+        matCsdSum = inputData.matCsd;
+    } else {
+        matCsdSum += inputData.matCsd;
+    }
+
+    mutex.unlock();
+}
+
+//=============================================================================================================
+
+bool AbstractMetric::keepIntermediateData(const ConnectivitySettings& connectivitySettings)
+{
+    return m_bStorageModeIsActive || connectivitySettings.isStorageModeActive() || connectivitySettings.isSpectralCacheActive();
+}
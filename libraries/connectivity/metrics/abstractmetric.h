@@ -40,6 +40,7 @@
 //=============================================================================================================
 
 #include "../connectivity_global.h"
+#include "../connectivitysettings.h"
 
 //=============================================================================================================
 // QT INCLUDES
@@ -47,6 +48,7 @@
 
 #include <QSharedPointer>
 #include <QVector>
+#include <QMutex>
 
 //=============================================================================================================
 // EIGEN INCLUDES
@@ -87,6 +89,74 @@ public:
      */
     explicit AbstractMetric();
 
+    //=========================================================================================================
+    /**
+     * Computes the mean free, tapered half spectra of all rows of a trial if they are not available already.
+     *
+     * @param[in] inputData              The input data.
+     * @param[in] iNRows                 The number of rows.
+     * @param[in] iNFreqs                The number of frequenciy bins.
+     * @param[in] iNfft                  The FFT length.
+     * @param[in] tapers                 The taper information.
+     */
+    static void computeTaperedSpectra(ConnectivitySettings::IntermediateTrialData& inputData,
+                                      int iNRows,
+                                      int iNFreqs,
+                                      int iNfft,
+                                      const QPair<Eigen::MatrixXd, Eigen::VectorXd>& tapers);
+
+    //=========================================================================================================
+    /**
+     * Computes the packed CSD of a trial from its tapered spectra. For each frequency bin the Hermitian cross
+     * spectral matrix is computed as a single rank update over the tapers and its upper triangle is stored in the
+     * corresponding column of inputData.matCsd.
+     *
+     * @param[in] inputData              The input data. The tapered spectra must be available.
+     * @param[in] iNRows                 The number of rows.
+     * @param[in] iNFreqs                The number of frequenciy bins.
+     * @param[in] iNfft                  The FFT length.
+     * @param[in] tapers                 The taper information.
+     */
+    static void computeCsd(ConnectivitySettings::IntermediateTrialData& inputData,
+                           int iNRows,
+                           int iNFreqs,
+                           int iNfft,
+                           const QPair<Eigen::MatrixXd, Eigen::VectorXd>& tapers);
+
+    //=========================================================================================================
+    /**
+     * Computes the tapered spectra and the packed CSD of a trial if they are not available already and adds the
+     * CSD to matCsdSum, so that metrics running afterwards find and reuse the data. This function gets called
+     * in parallel.
+     *
+     * @param[in] inputData              The input data.
+     * @param[out]matCsdSum              The sum of all CSD matrices for each trial.
+     * @param[in] mutex                  The mutex used to safely access matCsdSum.
+     * @param[in] iNRows                 The number of rows.
+     * @param[in] iNFreqs                The number of frequenciy bins.
+     * @param[in] iNfft                  The FFT length.
+     * @param[in] tapers                 The taper information.
+     */
+    static void computeSpectraAndCsd(ConnectivitySettings::IntermediateTrialData& inputData,
+                                     Eigen::MatrixXcd& matCsdSum,
+                                     QMutex& mutex,
+                                     int iNRows,
+                                     int iNFreqs,
+                                     int iNfft,
+                                     const QPair<Eigen::MatrixXd, Eigen::VectorXd>& tapers);
+
+    //=========================================================================================================
+    /**
+     * Returns whether the metrics have to keep the intermediate data of the trials of a request. This is the case if
+     * the storage mode is active, globally or for this request, or if the tapered spectra and CSDs are shared between
+     * the metrics of the request.
+     *
+     * @param[in] connectivitySettings   The request.
+     *
+     * @return Whether the intermediate data is kept.
+     */
+    static bool keepIntermediateData(const ConnectivitySettings& connectivitySettings);
+
     static bool     m_bStorageModeIsActive;
     static int      m_iNumberBinStart;
     static int      m_iNumberBinAmount;
@@ -111,15 +111,18 @@ void Coherency::calculateAbs(Network& finalNetwork,
     // Compute PSD/CSD for each trial
     QMutex mutex;
 
+    const bool bKeepIntermediateData = keepIntermediateData(connectivitySettings);
+
     std::function<void(ConnectivitySettings::IntermediateTrialData&)> computeLambda = [&](ConnectivitySettings::IntermediateTrialData& inputData) {
         compute(inputData,
                 connectivitySettings.getIntermediateSumData().matPsdSum,
-                connectivitySettings.getIntermediateSumData().vecPairCsdSum,
+                connectivitySettings.getIntermediateSumData().matCsdSum,
                 mutex,
                 iNRows,
                 iNFreqs,
                 iNfft,
-                tapers);
+                tapers,
+                bKeepIntermediateData);
     };
 
 //    iTime = timer.elapsed();
@@ -134,18 +137,28 @@ void Coherency::calculateAbs(Network& finalNetwork,
 //    qWarning() << "ComputeSpectraPSDCSD" << iTime;
 //    timer.restart();
 
-    // Compute CSD/sqrt(PSD_X * PSD_Y)
-    std::function<void(QPair<int,MatrixXcd>&)> computePSDCSDLambda = [&](QPair<int,MatrixXcd>& pairInput) {
-        computePSDCSDAbs(mutex,
-                         finalNetwork,
-                         pairInput,
+    // Compute CSD/sqrt(PSD_X * PSD_Y) for each seed row
+    QVector<int> vecRows;
+    for(int i = 0; i < iNRows; ++i) {
+        vecRows.append(i);
+    }
+
+    MatrixXd matWeights(ConnectivitySettings::getNumberOfPairs(iNRows),
+                        connectivitySettings.getIntermediateSumData().matCsdSum.cols());
+
+    std::function<void(int&)> computePSDCSDLambda = [&](int& iRow) {
+        computePSDCSDAbs(matWeights,
+                         iRow,
+                         connectivitySettings.getIntermediateSumData().matCsdSum,
                          connectivitySettings.getIntermediateSumData().matPsdSum);
     };
 
-    QFuture<void> resultCSDPSD = QtConcurrent::map(connectivitySettings.getIntermediateSumData().vecPairCsdSum,
+    QFuture<void> resultCSDPSD = QtConcurrent::map(vecRows,
                                                    computePSDCSDLambda);
     resultCSDPSD.waitForFinished();
 
+    finalNetwork.setPackedWeights(matWeights);
+
 //    iTime = timer.elapsed();
 //    qWarning() << "Compute" << iTime;
 //    timer.restart();
@@ -182,15 +195,18 @@ void Coherency::calculateImag(Network& finalNetwork,
     // Compute PSD/CSD for each trial
     QMutex mutex;
 
+    const bool bKeepIntermediateData = keepIntermediateData(connectivitySettings);
+
     std::function<void(ConnectivitySettings::IntermediateTrialData&)> computeLambda = [&](ConnectivitySettings::IntermediateTrialData& inputData) {
         compute(inputData,
                 connectivitySettings.getIntermediateSumData().matPsdSum,
-                connectivitySettings.getIntermediateSumData().vecPairCsdSum,
+                connectivitySettings.getIntermediateSumData().matCsdSum,
                 mutex,
                 iNRows,
                 iNFreqs,
                 iNfft,
-                tapers);
+                tapers,
+                bKeepIntermediateData);
     };
 
 //    iTime = timer.elapsed();
@@ -205,18 +221,28 @@ void Coherency::calculateImag(Network& finalNetwork,
 //    qWarning() << "ComputeSpectraPSDCSD" << iTime;
 //    timer.restart();
 
-    // Compute CSD/sqrt(PSD_X * PSD_Y)
-    std::function<void(QPair<int,MatrixXcd>&)> computePSDCSDLambda = [&](QPair<int,MatrixXcd>& pairInput) {
-        computePSDCSDImag(mutex,
-                          finalNetwork,
-                          pairInput,
+    // Compute CSD/sqrt(PSD_X * PSD_Y) for each seed row
+    QVector<int> vecRows;
+    for(int i = 0; i < iNRows; ++i) {
+        vecRows.append(i);
+    }
+
+    MatrixXd matWeights(ConnectivitySettings::getNumberOfPairs(iNRows),
+                        connectivitySettings.getIntermediateSumData().matCsdSum.cols());
+
+    std::function<void(int&)> computePSDCSDLambda = [&](int& iRow) {
+        computePSDCSDImag(matWeights,
+                          iRow,
+                          connectivitySettings.getIntermediateSumData().matCsdSum,
                           connectivitySettings.getIntermediateSumData().matPsdSum);
     };
 
-    QFuture<void> resultCSDPSD = QtConcurrent::map(connectivitySettings.getIntermediateSumData().vecPairCsdSum,
+    QFuture<void> resultCSDPSD = QtConcurrent::map(vecRows,
                                                    computePSDCSDLambda);
     resultCSDPSD.waitForFinished();
 
+    finalNetwork.setPackedWeights(matWeights);
+
 //    iTime = timer.elapsed();
 //    qWarning() << "Compute" << iTime;
 //    timer.restart();
@@ -226,130 +252,81 @@ void Coherency::calculateImag(Network& finalNetwork,
 
 void Coherency::compute(ConnectivitySettings::IntermediateTrialData& inputData,
                         MatrixXd& matPsdSum,
-                        QVector<QPair<int,MatrixXcd> >& vecPairCsdSum,
+                        MatrixXcd& matCsdSum,
                         QMutex& mutex,
                         int iNRows,
                         int iNFreqs,
                         int iNfft,
-                        const QPair<MatrixXd, VectorXd>& tapers)
+                        const QPair<MatrixXd, VectorXd>& tapers,
+                        bool bKeepIntermediateData)
 {
 //    QElapsedTimer timer;
 //    qint64 iTime = 0;
 //    timer.start();
 
-    if(inputData.vecPairCsd.size() == iNRows) {
-        //qDebug() << "Coherency::compute - vecPairCsd were already computed for this trial.";
-        return;
-    }
-
-    //qDebug() << "Coherency::compute - vecPairCsdSum and matPsdSum are computed for this trial.";
+    int iNPairs = ConnectivitySettings::getNumberOfPairs(iNRows);
 
-    // Substract mean, compute tapered spectra and PSD
-    // This code was copied and changed modified Utils/Spectra since we do not want to call the function due to time loss.
-    bool bNfftEven = false;
-    if (iNfft % 2 == 0){
-        bNfftEven = true;
+    if(inputData.matCsd.rows() == iNPairs &&
+       inputData.matPsd.rows() == iNRows &&
+       inputData.matPsd.cols() == m_iNumberBinAmount) {
+        //qDebug() << "Coherency::compute - matCsd and matPsd were already computed for this trial.";
+        return;
     }
 
-    FFT<double> fft;
-    fft.SetFlag(fft.HalfSpectrum);
+    //qDebug() << "Coherency::compute - matCsdSum and matPsdSum are computed for this trial.";
 
-    double denomPSD = tapers.second.cwiseAbs2().sum() / 2.0;
+    // Compute tapered spectra if not available already
+    computeTaperedSpectra(inputData, iNRows, iNFreqs, iNfft, tapers);
 
-    RowVectorXd vecInputFFT, rowData;
-    RowVectorXcd vecTmpFreq;
-
-    MatrixXcd matTapSpectrum(tapers.first.rows(), iNFreqs);
-
-    int i,j;
+    // Compute PSD (average over tapers if necessary)
+    if(inputData.matPsd.rows() != iNRows || inputData.matPsd.cols() != m_iNumberBinAmount) {
+        bool bNfftEven = false;
+        if (iNfft % 2 == 0){
+            bNfftEven = true;
+        }
 
-    inputData.matPsd = MatrixXd(iNRows, m_iNumberBinAmount);
+        double denomPSD = tapers.second.cwiseAbs2().sum() / 2.0;
 
-    for (i = 0; i < iNRows; ++i) {
-        // Substract mean
-        rowData.array() = inputData.matData.row(i).array() - inputData.matData.row(i).mean();
+        inputData.matPsd = MatrixXd(iNRows, m_iNumberBinAmount);
 
-        // Calculate tapered spectra if not available already
-        if(inputData.vecTapSpectra.size() != iNRows) {
-            for(j = 0; j < tapers.first.rows(); j++) {
-                // Zero padd if necessary. The zero padding in Eigen's FFT is only working for column vectors.
-                if (rowData.cols() < iNfft) {
-                    vecInputFFT.setZero(iNfft);
-                    vecInputFFT.block(0,0,1,rowData.cols()) = rowData.cwiseProduct(tapers.first.row(j));;
-                } else {
-                    vecInputFFT = rowData.cwiseProduct(tapers.first.row(j));
-                }
+        for (int i = 0; i < iNRows; ++i) {
+            inputData.matPsd.row(i) = inputData.vecTapSpectra.at(i).block(0,m_iNumberBinStart,inputData.vecTapSpectra.at(i).rows(),m_iNumberBinAmount).cwiseAbs2().colwise().sum() / denomPSD;
 
-                // FFT for freq domain returning the half spectrum and multiply taper weights
-                fft.fwd(vecTmpFreq, vecInputFFT, iNfft);
-                matTapSpectrum.row(j) = vecTmpFreq * tapers.second(j);
+            // Divide first and last element by 2 due to half spectrum
+            if(m_iNumberBinStart == 0) {
+                inputData.matPsd.row(i)(0) /= 2.0;
             }
 
-            inputData.vecTapSpectra.append(matTapSpectrum);
+            if(bNfftEven && m_iNumberBinStart + m_iNumberBinAmount >= iNFreqs) {
+                inputData.matPsd.row(i).tail(1) /= 2.0;
+            }
         }
 
-        // Compute PSD (average over tapers if necessary).
-        inputData.matPsd.row(i) = inputData.vecTapSpectra.at(i).block(0,m_iNumberBinStart,inputData.vecTapSpectra.at(i).rows(),m_iNumberBinAmount).cwiseAbs2().colwise().sum() / denomPSD;
-
-        // Divide first and last element by 2 due to half spectrum
-        if(m_iNumberBinStart == 0) {
-            inputData.matPsd.row(i)(0) /= 2.0;
-        }
+        mutex.lock();
 
-        if(bNfftEven && m_iNumberBinStart + m_iNumberBinAmount >= iNFreqs) {
-            inputData.matPsd.row(i).tail(1) /= 2.0;
+        if(matPsdSum.rows() == 0 || matPsdSum.cols() == 0) {
+            matPsdSum = inputData.matPsd;
+        } else {
+            matPsdSum += inputData.matPsd;
         }
-    }
-
-    mutex.lock();
 
-    if(matPsdSum.rows() == 0 || matPsdSum.cols() == 0) {
-        matPsdSum = inputData.matPsd;
-    } else {
-        matPsdSum += inputData.matPsd;
+        mutex.unlock();
     }
 
-    mutex.unlock();
-
 //    iTime = timer.elapsed();
 //    qWarning() << QThread::currentThreadId() << "Coherency::compute timer - compute - Tapered spectra and PSD (summing):" << iTime;
 //    timer.restart();
 
     // Compute CSD
-    if(inputData.vecPairCsd.size() != iNRows) {
-        inputData.vecPairCsd.clear();
-
-        //MatrixXcd matCsd = MatrixXcd(iNRows, iNFreqs);
-        MatrixXcd matCsd = MatrixXcd(iNRows, m_iNumberBinAmount);
-
-        double denomCSD = sqrt(tapers.second.cwiseAbs2().sum()) * sqrt(tapers.second.cwiseAbs2().sum()) / 2.0;
-
-        for (i = 0; i < iNRows; ++i) {
-            for (j = i; j < iNRows; ++j) {
-                // Compute CSD (average over tapers if necessary)
-                matCsd.row(j) = inputData.vecTapSpectra.at(i).block(0,m_iNumberBinStart,inputData.vecTapSpectra.at(i).rows(),m_iNumberBinAmount).cwiseProduct(inputData.vecTapSpectra.at(j).block(0,m_iNumberBinStart,inputData.vecTapSpectra.at(j).rows(),m_iNumberBinAmount).conjugate()).colwise().sum() / denomCSD;
-
-                // Divide first and last element by 2 due to half spectrum
-                if(m_iNumberBinStart == 0) {
-                    matCsd.row(j)(0) /= 2.0;
-                }
-
-                if(bNfftEven && m_iNumberBinStart + m_iNumberBinAmount >= iNFreqs) {
-                    matCsd.row(j).tail(1) /= 2.0;
-                }
-            }
-
-            inputData.vecPairCsd.append(QPair<int,MatrixXcd>(i,matCsd));
-        }
+    if(inputData.matCsd.rows() != iNPairs) {
+        computeCsd(inputData, iNRows, iNFreqs, iNfft, tapers);
 
         mutex.lock();
 
-        if(vecPairCsdSum.isEmpty()) {
-            vecPairCsdSum = inputData.vecPairCsd;
+        if(matCsdSum.size() == 0) {
+            matCsdSum = inputData.matCsd;
         } else {
-            for (j = 0; j < vecPairCsdSum.size(); ++j) {
-                vecPairCsdSum[j].second += inputData.vecPairCsd.at(j).second;
-            }
+            matCsdSum += inputData.matCsd;
         }
 
         mutex.unlock();
@@ -360,79 +337,45 @@ void Coherency::compute(ConnectivitySettings::IntermediateTrialData& inputData,
 //    timer.restart();
 
     //Do not store data to save memory
-    if(!m_bStorageModeIsActive) {
-        inputData.vecPairCsd.clear();
+    if(!bKeepIntermediateData) {
+        inputData.matCsd.resize(0,0);
         inputData.vecTapSpectra.clear();
     }
-
-//    iTime = timer.elapsed();
-//    qWarning() << QThread::currentThreadId() << "Coherency::compute timer - compute - Deleting data:" << iTime;
-//    timer.restart();
 }
 
 //=============================================================================================================
 
-void Coherency::computePSDCSDAbs(QMutex& mutex,
-                                 Network& finalNetwork,
-                                 const QPair<int,MatrixXcd>& pairInput,
+void Coherency::computePSDCSDAbs(MatrixXd& matWeights,
+                                 int iRow,
+                                 const MatrixXcd& matCsdSum,
                                  const MatrixXd& matPsdSum)
 {
-    MatrixXd matPSDtmp(matPsdSum.rows(), matPsdSum.cols());
-    RowVectorXd rowPsdSum = matPsdSum.row(pairInput.first);
-
-    for(int j = 0; j < matPSDtmp.rows(); ++j) {
-        matPSDtmp.row(j) = rowPsdSum.cwiseProduct(matPsdSum.row(j));
-    }
+    int iNRows = matPsdSum.rows();
+    int p = ConnectivitySettings::getPairIndex(iRow, iRow, iNRows);
+    RowVectorXd rowPsdSum = matPsdSum.row(iRow);
+    RowVectorXcd rowCohy;
 
     // Average. Note that the number of trials cancel each other out.
-    MatrixXcd matCohy = pairInput.second.cwiseQuotient(matPSDtmp.cwiseSqrt());
-
-    QSharedPointer<NetworkEdge> pEdge;
-    MatrixXd matWeight;
-    int j;
-    int i = pairInput.first;
-
-    for(j = i; j < matCohy.rows(); ++j) {
-        matWeight = matCohy.row(j).cwiseAbs().transpose();
-        pEdge = QSharedPointer<NetworkEdge>(new NetworkEdge(i, j, matWeight));
-
-        mutex.lock();
-        finalNetwork.getNodeAt(i)->append(pEdge);
-        finalNetwork.getNodeAt(j)->append(pEdge);
-        finalNetwork.append(pEdge);
-        mutex.unlock();
+    for(int j = iRow; j < iNRows; ++j, ++p) {
+        rowCohy = matCsdSum.row(p).cwiseQuotient(rowPsdSum.cwiseProduct(matPsdSum.row(j)).cwiseSqrt());
+        matWeights.row(p) = rowCohy.cwiseAbs();
     }
 }
 
 //=============================================================================================================
 
-void Coherency::computePSDCSDImag(QMutex& mutex,
-                                  Network& finalNetwork,
-                                  const QPair<int,MatrixXcd>& pairInput,
+void Coherency::computePSDCSDImag(MatrixXd& matWeights,
+                                  int iRow,
+                                  const MatrixXcd& matCsdSum,
                                   const MatrixXd& matPsdSum)
 {
-    MatrixXd matPSDtmp(matPsdSum.rows(), matPsdSum.cols());
-    RowVectorXd rowPsdSum = matPsdSum.row(pairInput.first);
-
-    for(int j = 0; j < matPSDtmp.rows(); ++j) {
-        matPSDtmp.row(j) = rowPsdSum.cwiseProduct(matPsdSum.row(j));
-    }
-
-    MatrixXcd matCohy = pairInput.second.cwiseQuotient(matPSDtmp.cwiseSqrt());
-
-    QSharedPointer<NetworkEdge> pEdge;
-    MatrixXd matWeight;
-    int j;
-    int i = pairInput.first;
-
-    for(j = i; j < matCohy.rows(); ++j) {
-        matWeight = matCohy.row(j).imag().transpose();
-        pEdge = QSharedPointer<NetworkEdge>(new NetworkEdge(i, j, matWeight));
-
-        mutex.lock();
-        finalNetwork.getNodeAt(i)->append(pEdge);
-        finalNetwork.getNodeAt(j)->append(pEdge);
-        finalNetwork.append(pEdge);
-        mutex.unlock();
+    int iNRows = matPsdSum.rows();
+    int p = ConnectivitySettings::getPairIndex(iRow, iRow, iNRows);
+    RowVectorXd rowPsdSum = matPsdSum.row(iRow);
+    RowVectorXcd rowCohy;
+
+    for(int j = iRow; j < iNRows; ++j, ++p) {
+        rowCohy = matCsdSum.row(p).cwiseQuotient(rowPsdSum.cwiseProduct(matPsdSum.row(j)).cwiseSqrt());
+        matWeights.row(p) = rowCohy.imag();
     }
 }
@@ -123,33 +123,41 @@ private:
      *
      * @param[in]    inputData           The input data.
      * @param[out]   matPsdSum           The sum of all PSD matrices for each trial.
-     * @param[out]   vecPairCsdSum       The sum of all CSD matrices for each trial.
-     * @param[in]    mutex               The mutex used to safely access matPsdSum and vecPairCsdSum.
+     * @param[out]   matCsdSum           The sum of the packed CSD matrices of all trials.
+     * @param[in]    mutex               The mutex used to safely access matPsdSum and matCsdSum.
      * @param[in]    iNRows              The number of rows.
      * @param[in]    iNFreqs             The number of frequenciy bins.
      * @param[in]    iNfft               The FFT length.
      * @param[in]    tapers              The taper information.
+     * @param[in]    bKeepIntermediateData Whether to keep the intermediate data of the trial, see AbstractMetric::keepIntermediateData.
      */
     static void compute(ConnectivitySettings::IntermediateTrialData& inputData,
                         Eigen::MatrixXd& matPsdSum,
-                        QVector<QPair<int,Eigen::MatrixXcd> >& vecPairCsdSum,
+                        Eigen::MatrixXcd& matCsdSum,
                         QMutex& mutex,
                         int iNRows,
                         int iNFreqs,
                         int iNfft,
-                        const QPair<Eigen::MatrixXd, Eigen::VectorXd>& tapers);
+                        const QPair<Eigen::MatrixXd, Eigen::VectorXd>& tapers,
+                        bool bKeepIntermediateData);
 
     //=========================================================================================================
     /**
-     * Computes the PSD and CSD. This function gets called in parallel.
+     * Computes the coherency of one seed row with all following rows from the summed PSD and packed CSD.
+     * This function gets called in parallel.
+     *
+     * @param[out]   matWeights          The packed coherency weights. Each seed row writes its own pairs only.
+     * @param[in]    iRow                The seed row.
+     * @param[in]    matCsdSum           The sum of the packed CSD matrices of all trials.
+     * @param[in]    matPsdSum           The sum of all PSD matrices for each trial.
      */
-    static void computePSDCSDAbs(QMutex& mutex,
-                                 Network& finalNetwork,
-                                 const QPair<int,Eigen::MatrixXcd>& pairInput,
+    static void computePSDCSDAbs(Eigen::MatrixXd& matWeights,
+                                 int iRow,
+                                 const Eigen::MatrixXcd& matCsdSum,
                                  const Eigen::MatrixXd& matPsdSum);
-    static void computePSDCSDImag(QMutex& mutex,
-                                  Network& finalNetwork,
-                                  const QPair<int,Eigen::MatrixXcd>& pairInput,
+    static void computePSDCSDImag(Eigen::MatrixXd& matWeights,
+                                  int iRow,
+                                  const Eigen::MatrixXcd& matCsdSum,
                                   const Eigen::MatrixXd& matPsdSum);
 };
 
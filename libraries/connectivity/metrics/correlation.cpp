@@ -89,6 +89,10 @@ Network Correlation::calculate(ConnectivitySettings& connectivitySettings)
         return finalNetwork;
     }   
 
+    if(!AbstractMetric::keepIntermediateData(connectivitySettings)) {
+        connectivitySettings.clearIntermediateData();
+    }
+
     finalNetwork.setSamplingFrequency(connectivitySettings.getSamplingFrequency());
 
     //Create nodes
@@ -115,41 +119,27 @@ Network Correlation::calculate(ConnectivitySettings& connectivitySettings)
 //    double dScalingStep = 1.0/matDataList.size();
 //    dataTemp.matInputData = dScalingStep * (i+1) * matDataList.at(i);
 
-    QFuture<MatrixXd> resultMat = QtConcurrent::mappedReduced(connectivitySettings.getTrialData(),
-                                                              compute,
-                                                              reduce);
-    resultMat.waitForFinished();
+    QMutex mutex;
 
-    MatrixXd matDist = resultMat.result();
+    const bool bKeepIntermediateData = keepIntermediateData(connectivitySettings);
 
-//    MatrixXd matDist;
+    std::function<void(ConnectivitySettings::IntermediateTrialData&)> computeLambda = [&](ConnectivitySettings::IntermediateTrialData& inputData) {
+        compute(inputData,
+                connectivitySettings.getIntermediateSumData().matCorrSum,
+                mutex,
+                bKeepIntermediateData);
+    };
 
-//    for(int i = 0; i < connectivitySettings.getTrialData().size(); ++i) {
-//        reduce(matDist, compute(connectivitySettings.getTrialData().at(i)));
-//    }
-
-//    matDist /= connectivitySettings.size();
+    QFuture<void> resultMat = QtConcurrent::map(connectivitySettings.getTrialData(),
+                                                computeLambda);
+    resultMat.waitForFinished();
 
 //    iTime = timer.elapsed();
 //    qWarning() << "ComputeSpectraPSDCSD" << iTime;
 //    timer.restart();
 
     //Add edges to network
-    MatrixXd matWeight(1,1);
-    QSharedPointer<NetworkEdge> pEdge;
-    int j;
-
-    for(int i = 0; i < matDist.rows(); ++i) {
-        for(j = i; j < matDist.cols(); ++j) {
-            matWeight << matDist(i,j);
-
-            pEdge = QSharedPointer<NetworkEdge>(new NetworkEdge(i, j, matWeight));
-
-            finalNetwork.getNodeAt(i)->append(pEdge);
-            finalNetwork.getNodeAt(j)->append(pEdge);
-            finalNetwork.append(pEdge);
-        }
-    }
+    finalNetwork.setPackedWeights(connectivitySettings.getIntermediateSumData().matCorrSum);
 
 //    iTime = timer.elapsed();
 //    qWarning() << "Compute" << iTime;
@@ -160,34 +150,40 @@ Network Correlation::calculate(ConnectivitySettings& connectivitySettings)
 
 //=============================================================================================================
 
-MatrixXd Correlation::compute(const ConnectivitySettings::IntermediateTrialData& inputData)
+void Correlation::compute(ConnectivitySettings::IntermediateTrialData& inputData,
+                          MatrixXd& matCorrSum,
+                          QMutex& mutex,
+                          bool bKeepIntermediateData)
 {
-    MatrixXd matDist = MatrixXd::Zero(inputData.matData.rows(), inputData.matData.rows());
-    RowVectorXd vecRow;
-    int j;
+    int iNRows = inputData.matData.rows();
+    int iNPairs = ConnectivitySettings::getNumberOfPairs(iNRows);
 
-    matDist = inputData.matData * inputData.matData.transpose();
+    if(inputData.matCorr.rows() == iNPairs) {
+        return;
+    }
 
-//    for(int i = 0; i < inputData.matData.rows(); ++i) {
-//        vecRow = inputData.matData.row(i);
+    MatrixXd matDist = inputData.matData * inputData.matData.transpose();
 
-//        for(j = i; j < inputData.matData.rows(); ++j) {
-//            matDist(i,j) += (vecRow.dot(inputData.matData.row(j))/vecRow.cols());
-//        }
-//    }
+    inputData.matCorr.resize(iNPairs, 1);
 
-    return matDist;
-}
+    for(int i = 0, p = 0; i < iNRows; ++i) {
+        for(int j = i; j < iNRows; ++j, ++p) {
+            inputData.matCorr(p, 0) = matDist(i,j);
+        }
+    }
 
-//=============================================================================================================
+    // Sum up weights
+    mutex.lock();
 
-void Correlation::reduce(MatrixXd &resultData,
-                         const MatrixXd &data)
-{
-    if(resultData.rows() != data.rows() || resultData.cols() != data.cols()) {
-        resultData.resize(data.rows(), data.cols());
-        resultData.setZero();
+    if(matCorrSum.rows() != iNPairs || matCorrSum.cols() != 1) {
+        matCorrSum = MatrixXd::Zero(iNPairs, 1);
     }
 
-    resultData += data;
+    matCorrSum += inputData.matCorr;
+
+    mutex.unlock();
+
+    if(!bKeepIntermediateData) {
+        inputData.matCorr.resize(0,0);
+    }
 }
@@ -49,6 +49,7 @@
 //=============================================================================================================
 
 #include <QSharedPointer>
+#include <QMutex>
 
 //=============================================================================================================
 // EIGEN INCLUDES
@@ -104,23 +105,18 @@ public:
 protected:
     //=========================================================================================================
     /**
-     * Calculates the connectivity matrix for a given input data matrix based on the correlation coefficient.
+     * Calculates the packed connectivity matrix for a given trial based on the correlation coefficient and adds it to
+     * the summed up correlation. Trials which already hold their correlation, e.g. in storage mode, are skipped.
      *
-     * @param[in] inputData      The input data.
-     *
-     * @return                   The connectivity matrix.
-     */
-    static Eigen::MatrixXd compute(const ConnectivitySettings::IntermediateTrialData& inputData);
-
-    //=========================================================================================================
-    /**
-     * Sums up (reduces) the in parallel processed connectivity matrix.
-     *
-     * @param[out] resultData    The result data.
-     * @param[in]  data          The incoming, temporary result data.
+     * @param[in]       inputData       The input data.
+     * @param[in,out]   matCorrSum      The sum of the packed correlation matrices of all trials.
+     * @param[in]       mutex           The mutex used to safely access matCorrSum.
+     * @param[in]       bKeepIntermediateData Whether to keep the intermediate data of the trial, see AbstractMetric::keepIntermediateData.
      */
-    static void reduce(Eigen::MatrixXd &resultData,
-                       const Eigen::MatrixXd &data);
+    static void compute(ConnectivitySettings::IntermediateTrialData& inputData,
+                        Eigen::MatrixXd& matCorrSum,
+                        QMutex& mutex,
+                        bool bKeepIntermediateData);
 };
 
 //=============================================================================================================
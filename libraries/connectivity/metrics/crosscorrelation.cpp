@@ -95,7 +95,7 @@ Network CrossCorrelation::calculate(ConnectivitySettings& connectivitySettings)
         return finalNetwork;
     }
 
-    if(AbstractMetric::m_bStorageModeIsActive == false) {
+    if(!AbstractMetric::keepIntermediateData(connectivitySettings)) {
         connectivitySettings.clearIntermediateData();
     }
 
@@ -125,14 +125,16 @@ Network CrossCorrelation::calculate(ConnectivitySettings& connectivitySettings)
 
     // Compute the cross correlation in parallel
     QMutex mutex;
-    MatrixXd matDist;
+
+    const bool bKeepIntermediateData = keepIntermediateData(connectivitySettings);
 
     std::function<void(ConnectivitySettings::IntermediateTrialData&)> computeLambda = [&](ConnectivitySettings::IntermediateTrialData& inputData) {
         compute(inputData,
-                matDist,
+                connectivitySettings.getIntermediateSumData().matXCorrSum,
                 mutex,
                 iNfft,
-                tapers);
+                tapers,
+                bKeepIntermediateData);
     };
 
 //    iTime = timer.elapsed();
@@ -144,28 +146,12 @@ Network CrossCorrelation::calculate(ConnectivitySettings& connectivitySettings)
                                                 computeLambda);
     resultMat.waitForFinished();
 
-    matDist /= connectivitySettings.size();
-
 //    iTime = timer.elapsed();
 //    qWarning() << "ComputeSpectraPSDCSD" << iTime;
 //    timer.restart();
 
     //Add edges to network
-    MatrixXd matWeight(1,1);
-    QSharedPointer<NetworkEdge> pEdge;
-    int j;
-
-    for(int i = 0; i < matDist.rows(); ++i) {
-        for(j = i; j < matDist.cols(); ++j) {
-            matWeight << matDist(i,j);
-
-            pEdge = QSharedPointer<NetworkEdge>(new NetworkEdge(i, j, matWeight));
-
-            finalNetwork.getNodeAt(i)->append(pEdge);
-            finalNetwork.getNodeAt(j)->append(pEdge);
-            finalNetwork.append(pEdge);
-        }
-    }
+    finalNetwork.setPackedWeights(connectivitySettings.getIntermediateSumData().matXCorrSum / connectivitySettings.size());
 
 //    iTime = timer.elapsed();
 //    qWarning() << "Compute" << iTime;
@@ -177,10 +163,11 @@ Network CrossCorrelation::calculate(ConnectivitySettings& connectivitySettings)
 //=============================================================================================================
 
 void CrossCorrelation::compute(ConnectivitySettings::IntermediateTrialData& inputData,
-                               MatrixXd& matDist,
+                               MatrixXd& matXCorrSum,
                                QMutex& mutex,
                                int iNfft,
-                               const QPair<MatrixXd, VectorXd>& tapers)
+                               const QPair<MatrixXd, VectorXd>& tapers,
+                               bool bKeepIntermediateData)
 {
 //    QElapsedTimer timer;
 //    qint64 iTime = 0;
@@ -195,47 +182,28 @@ void CrossCorrelation::compute(ConnectivitySettings::IntermediateTrialData& inpu
 
     int i, j;
     int iNRows = inputData.matData.rows();
+    int iNPairs = ConnectivitySettings::getNumberOfPairs(iNRows);
 
-    // Calculate tapered spectra if not available already
-    // This code was copied and changed modified Utils/Spectra since we do not want to call the function due to time loss.
-    if(inputData.vecTapSpectra.isEmpty()) {
-        int iNFreqs = int(floor(iNfft / 2.0)) + 1;
-        MatrixXcd matTapSpectrum(tapers.first.rows(), iNFreqs);
-
-        for (i = 0; i < iNRows; ++i) {
-            // Substract mean
-            rowData.array() = inputData.matData.row(i).array() - inputData.matData.row(i).mean();
-
-            // Calculate tapered spectra
-            for(j = 0; j < tapers.first.rows(); j++) {
-                // Zero padd if necessary. The zero padding in Eigen's FFT is only working for column vectors.
-                if (rowData.cols() < iNfft) {
-                    vecInputFFT.setZero(iNfft);
-                    vecInputFFT.block(0,0,1,rowData.cols()) = rowData.cwiseProduct(tapers.first.row(j));;
-                } else {
-                    vecInputFFT = rowData.cwiseProduct(tapers.first.row(j));
-                }
-
-                // FFT for freq domain returning the half spectrum and multiply taper weights
-                fft.fwd(vecResultFreq, vecInputFFT, iNfft);
-                matTapSpectrum.row(j) = vecResultFreq * tapers.second(j);
-            }
-
-            inputData.vecTapSpectra.append(matTapSpectrum);
-        }
+    if(inputData.matXCorr.rows() == iNPairs) {
+        return;
     }
 
+    // Calculate tapered spectra if not available already
+    computeTaperedSpectra(inputData, iNRows, int(floor(iNfft / 2.0)) + 1, iNfft, tapers);
+
 //    iTime = timer.elapsed();
 //    qDebug() << QThread::currentThreadId() << "CrossCorrelation::compute timer - Tapered spectra:" << iTime;
 //    timer.restart();
 
     // Perform multiplication and transform back to time domain to find max XCOR coefficient
     // Note that the result in time domain is mirrored around the center of the data (compared to Matlab)
-    MatrixXd matDistTrial = MatrixXd::Zero(iNRows, iNRows);
     RowVectorXcd vecResultXCor;
     int idx = 0;
+    int p = 0;
     double denom = tapers.second.sum();
 
+    inputData.matXCorr.resize(iNPairs, 1);
+
     for(i = 0; i < inputData.vecTapSpectra.size(); ++i) {
         vecResultFreq = inputData.vecTapSpectra.at(i).colwise().sum() / denom;
 
@@ -246,7 +214,7 @@ void CrossCorrelation::compute(ConnectivitySettings::IntermediateTrialData& inpu
 
             vecInputFFT.maxCoeff(&idx);
 
-            matDistTrial(i,j) = vecInputFFT(idx);
+            inputData.matXCorr(p++, 0) = vecInputFFT(idx);
         }
     }
 
@@ -257,12 +225,11 @@ void CrossCorrelation::compute(ConnectivitySettings::IntermediateTrialData& inpu
     // Sum up weights
     mutex.lock();
 
-    if(matDist.rows() != matDistTrial.rows() || matDist.cols() != matDistTrial.cols()) {
-        matDist.resize(matDistTrial.rows(), matDistTrial.cols());
-        matDist.setZero();
+    if(matXCorrSum.rows() != iNPairs || matXCorrSum.cols() != 1) {
+        matXCorrSum = MatrixXd::Zero(iNPairs, 1);
     }
 
-    matDist += matDistTrial;
+    matXCorrSum += inputData.matXCorr;
 
     mutex.unlock();
 
@@ -270,7 +237,8 @@ void CrossCorrelation::compute(ConnectivitySettings::IntermediateTrialData& inpu
 //    qDebug() << QThread::currentThreadId() << "CrossCorrelation::compute timer - Summing up matDist:" << iTime;
 //    timer.restart();
 
-    if(!m_bStorageModeIsActive) {
+    if(!bKeepIntermediateData) {
         inputData.vecTapSpectra.clear();
+        inputData.matXCorr.resize(0,0);
     }
 }
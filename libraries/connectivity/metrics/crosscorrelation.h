@@ -105,19 +105,23 @@ public:
 protected:
     //=========================================================================================================
     /**
-     * Calculates the connectivity matrix for a given input data matrix based on the cross correlation coefficient.
+     * Calculates the packed connectivity matrix for a given input data matrix based on the cross correlation
+     * coefficient and adds it to the summed up cross correlation. Trials which already hold their cross correlation,
+     * e.g. in storage mode, are skipped.
      *
      * @param[in]    inputData           The input data.
-     * @param[out]   matDist             The sum of all edge weights.
-     * @param[in]    mutex               The mutex used to safely access matDist.
+     * @param[out]   matXCorrSum         The sum of the packed cross correlations of all trials.
+     * @param[in]    mutex               The mutex used to safely access matXCorrSum.
      * @param[in]    iNfft               The FFT length.
      * @param[in]    tapers              The taper information.
+     * @param[in]    bKeepIntermediateData Whether to keep the intermediate data of the trial, see AbstractMetric::keepIntermediateData.
      */
     static void compute(ConnectivitySettings::IntermediateTrialData& inputData,
-                        Eigen::MatrixXd& matDist,
+                        Eigen::MatrixXd& matXCorrSum,
                         QMutex& mutex,
                         int iNfft,
-                        const QPair<Eigen::MatrixXd, Eigen::VectorXd>& tapers);
+                        const QPair<Eigen::MatrixXd, Eigen::VectorXd>& tapers,
+                        bool bKeepIntermediateData);
 };
 
 //=============================================================================================================
@@ -95,7 +95,7 @@ Network DebiasedSquaredWeightedPhaseLagIndex::calculate(ConnectivitySettings& co
         return finalNetwork;
     }
 
-    if(AbstractMetric::m_bStorageModeIsActive == false) {
+    if(!AbstractMetric::keepIntermediateData(connectivitySettings)) {
         connectivitySettings.clearIntermediateData();
     }
 
@@ -149,16 +149,19 @@ Network DebiasedSquaredWeightedPhaseLagIndex::calculate(ConnectivitySettings& co
 
     QMutex mutex;
 
+    const bool bKeepIntermediateData = keepIntermediateData(connectivitySettings);
+
     std::function<void(ConnectivitySettings::IntermediateTrialData&)> computeLambda = [&](ConnectivitySettings::IntermediateTrialData& inputData) {
         return compute(inputData,
-                       connectivitySettings.getIntermediateSumData().vecPairCsdSum,
-                       connectivitySettings.getIntermediateSumData().vecPairCsdImagAbsSum,
-                       connectivitySettings.getIntermediateSumData().vecPairCsdImagSqrdSum,
+                       connectivitySettings.getIntermediateSumData().matCsdSum,
+                       connectivitySettings.getIntermediateSumData().matCsdImagAbsSum,
+                       connectivitySettings.getIntermediateSumData().matCsdImagSqrdSum,
                        mutex,
                        iNRows,
                        iNFreqs,
                        iNfft,
-                       tapers);
+                       tapers,
+                       bKeepIntermediateData);
     };
 
 //    iTime = timer.elapsed();
@@ -188,147 +191,76 @@ Network DebiasedSquaredWeightedPhaseLagIndex::calculate(ConnectivitySettings& co
 //=============================================================================================================
 
 void DebiasedSquaredWeightedPhaseLagIndex::compute(ConnectivitySettings::IntermediateTrialData& inputData,
-                                                   QVector<QPair<int,MatrixXcd> >& vecPairCsdSum,
-                                                   QVector<QPair<int,MatrixXd> >& vecPairCsdImagAbsSum,
-                                                   QVector<QPair<int,MatrixXd> >& vecPairCsdImagSqrdSum,
+                                                   MatrixXcd& matCsdSum,
+                                                   MatrixXd& matCsdImagAbsSum,
+                                                   MatrixXd& matCsdImagSqrdSum,
                                                    QMutex& mutex,
                                                    int iNRows,
                                                    int iNFreqs,
                                                    int iNfft,
-                                                   const QPair<MatrixXd, VectorXd>& tapers)
+                                                   const QPair<MatrixXd, VectorXd>& tapers,
+                                                   bool bKeepIntermediateData)
 {
-    if(inputData.vecPairCsd.size() == iNRows &&
-       inputData.vecPairCsdImagSqrd.size() == iNRows &&
-       inputData.vecPairCsdImagAbs.size() == iNRows) {
-        //qDebug() << "DebiasedSquaredWeightedPhaseLagIndex::compute - vecPairCsd, vecPairCsdImagSqrd and vecPairCsdImagAbs were already computed for this trial.";
+    int iNPairs = ConnectivitySettings::getNumberOfPairs(iNRows);
+
+    if(inputData.matCsd.rows() == iNPairs &&
+       inputData.matCsdImagSqrd.rows() == iNPairs &&
+       inputData.matCsdImagAbs.rows() == iNPairs) {
+        //qDebug() << "DebiasedSquaredWeightedPhaseLagIndex::compute - matCsdImagSqrd and matCsdImagAbs were already computed for this trial.";
         return;
     }
 
-    int i,j;
-
-    // Calculate tapered spectra if not available already
-    // This code was copied and changed modified Utils/Spectra since we do not want to call the function due to time loss.
-    if(inputData.vecTapSpectra.isEmpty()) {
-        RowVectorXd vecInputFFT, rowData;
-        RowVectorXcd vecTmpFreq;
-
-        MatrixXcd matTapSpectrum(tapers.first.rows(), iNFreqs);
-
-        FFT<double> fft;
-        fft.SetFlag(fft.HalfSpectrum);
+    // Compute tapered spectra and CSD if not available already
+    if(inputData.matCsd.rows() != iNPairs) {
+        computeTaperedSpectra(inputData, iNRows, iNFreqs, iNfft, tapers);
+        computeCsd(inputData, iNRows, iNFreqs, iNfft, tapers);
 
-        for (i = 0; i < iNRows; ++i) {
-            // Substract mean
-            rowData.array() = inputData.matData.row(i).array() - inputData.matData.row(i).mean();
-
-            // Calculate tapered spectra if not available already
-            for(j = 0; j < tapers.first.rows(); j++) {
-                // Zero padd if necessary. The zero padding in Eigen's FFT is only working for column vectors.
-                if (rowData.cols() < iNfft) {
-                    vecInputFFT.setZero(iNfft);
-                    vecInputFFT.block(0,0,1,rowData.cols()) = rowData.cwiseProduct(tapers.first.row(j));;
-                } else {
-                    vecInputFFT = rowData.cwiseProduct(tapers.first.row(j));
-                }
-
-                // FFT for freq domain returning the half spectrum and multiply taper weights
-                fft.fwd(vecTmpFreq, vecInputFFT, iNfft);
-                matTapSpectrum.row(j) = vecTmpFreq * tapers.second(j);
-            }
-
-            inputData.vecTapSpectra.append(matTapSpectrum);
-        }
-    }
-
-    // Compute CSD
-    if(inputData.vecPairCsd.isEmpty()) {
-        MatrixXcd matCsd(iNRows, m_iNumberBinAmount);
+        mutex.lock();
 
-        bool bNfftEven = false;
-        if (iNfft % 2 == 0){
-            bNfftEven = true;
+        if(matCsdSum.size() == 0) {
+            matCsdSum = inputData.matCsd;
+        } else {
+            matCsdSum += inputData.matCsd;
         }
 
-        double denomCSD = sqrt(tapers.second.cwiseAbs2().sum()) * sqrt(tapers.second.cwiseAbs2().sum()) / 2.0;
-
-        for (i = 0; i < iNRows; ++i) {
-            for (j = i; j < iNRows; ++j) {
-                // Compute CSD (average over tapers if necessary)
-                matCsd.row(j) = inputData.vecTapSpectra.at(i).block(0,m_iNumberBinStart,inputData.vecTapSpectra.at(i).rows(),m_iNumberBinAmount).cwiseProduct(inputData.vecTapSpectra.at(j).block(0,m_iNumberBinStart,inputData.vecTapSpectra.at(j).rows(),m_iNumberBinAmount).conjugate()).colwise().sum() / denomCSD;
-
-                // Divide first and last element by 2 due to half spectrum
-                if(m_iNumberBinStart == 0) {
-                    matCsd.row(j)(0) /= 2.0;
-                }
-
-                if(bNfftEven && m_iNumberBinStart + m_iNumberBinAmount >= iNFreqs) {
-                    matCsd.row(j).tail(1) /= 2.0;
-                }
-            }
+        mutex.unlock();
+    }
 
-            inputData.vecPairCsd.append(QPair<int,MatrixXcd>(i,matCsd));
-            inputData.vecPairCsdImagSqrd.append(QPair<int,MatrixXd>(i,matCsd.imag().array().square()));
-            inputData.vecPairCsdImagAbs.append(QPair<int,MatrixXd>(i,matCsd.imag().cwiseAbs()));
-        }
+    // Compute the squared imaginary part of the CSD
+    if(inputData.matCsdImagSqrd.rows() != iNPairs) {
+        inputData.matCsdImagSqrd = inputData.matCsd.imag().array().square();
 
         mutex.lock();
 
-        if(vecPairCsdSum.isEmpty()) {
-            vecPairCsdSum = inputData.vecPairCsd;
-            vecPairCsdImagSqrdSum = inputData.vecPairCsdImagSqrd;
-            vecPairCsdImagAbsSum = inputData.vecPairCsdImagAbs;
+        if(matCsdImagSqrdSum.size() == 0) {
+            matCsdImagSqrdSum = inputData.matCsdImagSqrd;
         } else {
-            for (int j = 0; j < vecPairCsdSum.size(); ++j) {
-                vecPairCsdSum[j].second += inputData.vecPairCsd.at(j).second;
-                vecPairCsdImagSqrdSum[j].second += inputData.vecPairCsdImagSqrd.at(j).second;
-                vecPairCsdImagAbsSum[j].second += inputData.vecPairCsdImagAbs.at(j).second;
-            }
+            matCsdImagSqrdSum += inputData.matCsdImagSqrd;
         }
 
         mutex.unlock();
-    } else {
-        if(inputData.vecPairCsdImagSqrd.isEmpty()) {
-            for (i = 0; i < inputData.vecPairCsd.size(); ++i) {
-                inputData.vecPairCsdImagSqrd.append(QPair<int,MatrixXd>(i,inputData.vecPairCsd.at(i).second.imag().array().square()));
-            }
-
-            mutex.lock();
-
-            if(vecPairCsdImagSqrdSum.isEmpty()) {
-                vecPairCsdImagSqrdSum = inputData.vecPairCsdImagSqrd;
-            } else {
-                for (int j = 0; j < vecPairCsdSum.size(); ++j) {
-                    vecPairCsdImagSqrdSum[j].second += inputData.vecPairCsdImagSqrd.at(j).second;
-                }
-            }
-
-            mutex.unlock();
-        }
-
-        if(inputData.vecPairCsdImagAbs.isEmpty()) {
-            for (i = 0; i < inputData.vecPairCsd.size(); ++i) {
-                inputData.vecPairCsdImagAbs.append(QPair<int,MatrixXd>(i,inputData.vecPairCsd.at(i).second.imag().cwiseAbs()));
-            }
+    }
 
-            mutex.lock();
+    // Compute the absolute value of the imaginary part of the CSD
+    if(inputData.matCsdImagAbs.rows() != iNPairs) {
+        inputData.matCsdImagAbs = inputData.matCsd.imag().cwiseAbs();
 
-            if(vecPairCsdImagAbsSum.isEmpty()) {
-                vecPairCsdImagAbsSum = inputData.vecPairCsdImagAbs;
-            } else {
-                for (int j = 0; j < vecPairCsdSum.size(); ++j) {
-                    vecPairCsdImagAbsSum[j].second += inputData.vecPairCsdImagAbs.at(j).second;
-                }
-            }
+        mutex.lock();
 
-            mutex.unlock();
+        if(matCsdImagAbsSum.size() == 0) {
+            matCsdImagAbsSum = inputData.matCsdImagAbs;
+        } else {
+            matCsdImagAbsSum += inputData.matCsdImagAbs;
         }
+
+        mutex.unlock();
     }
 
-    if(!m_bStorageModeIsActive) {
-        inputData.vecPairCsd.clear();
+    if(!bKeepIntermediateData) {
+        inputData.matCsd.resize(0,0);
         inputData.vecTapSpectra.clear();
-        inputData.vecPairCsdImagAbs.clear();
-        inputData.vecPairCsdImagSqrd.clear();
+        inputData.matCsdImagAbs.resize(0,0);
+        inputData.matCsdImagSqrd.resize(0,0);
     }
 }
 
@@ -338,32 +270,23 @@ void DebiasedSquaredWeightedPhaseLagIndex::computeDSWPLI(ConnectivitySettings &c
                                                          Network& finalNetwork)
 {
     // Compute final DSWPLI and create Network
-    MatrixXd matNom, matDenom;
-    MatrixXd matWeight;
-    QSharedPointer<NetworkEdge> pEdge;
-    int j;
-
-    for (int i = 0; i < connectivitySettings.at(0).matData.rows(); ++i) {
-
-        matNom = connectivitySettings.getIntermediateSumData().vecPairCsdSum.at(i).second.imag().array().square();
-        matNom -= connectivitySettings.getIntermediateSumData().vecPairCsdImagSqrdSum.at(i).second;
-
-        matDenom = connectivitySettings.getIntermediateSumData().vecPairCsdImagAbsSum.at(i).second.array().square();
-        matDenom -= connectivitySettings.getIntermediateSumData().vecPairCsdImagSqrdSum.at(i).second;
-
-        matDenom = (matDenom.array() == 0.).select(INFINITY, matDenom);
-        matDenom = matNom.cwiseQuotient(matDenom);
+    int iNRows = connectivitySettings.at(0).matData.rows();
+    MatrixXd matNom;
+    MatrixXd matDenom;
 
-        for(j = i; j < connectivitySettings.at(0).matData.rows(); ++j) {
-            matWeight = matDenom.row(j).transpose();
+    matNom = connectivitySettings.getIntermediateSumData().matCsdSum.imag().array().square();
+    matNom -= connectivitySettings.getIntermediateSumData().matCsdImagSqrdSum;
 
-            pEdge = QSharedPointer<NetworkEdge>(new NetworkEdge(i, j, matWeight));
+    matDenom = connectivitySettings.getIntermediateSumData().matCsdImagAbsSum.array().square();
+    matDenom -= connectivitySettings.getIntermediateSumData().matCsdImagSqrdSum;
 
-            finalNetwork.getNodeAt(i)->append(pEdge);
-            finalNetwork.getNodeAt(j)->append(pEdge);
-            finalNetwork.append(pEdge);
-        }
+    matDenom = (matDenom.array() == 0.).select(INFINITY, matDenom);
+    matNom = matNom.cwiseQuotient(matDenom);
 
+    if(matNom.rows() != ConnectivitySettings::getNumberOfPairs(iNRows)) {
+        return;
     }
+
+    finalNetwork.setPackedWeights(matNom);
 }
 
@@ -88,7 +88,7 @@ Network ImagCoherence::calculate(ConnectivitySettings& connectivitySettings)
         return finalNetwork;
     }
 
-    if(AbstractMetric::m_bStorageModeIsActive == false) {
+    if(!AbstractMetric::keepIntermediateData(connectivitySettings)) {
         connectivitySettings.clearIntermediateData();
     }
 
@@ -112,22 +112,24 @@ protected:
      * Computes the PLV values. This function gets called in parallel.
      *
      * @param[in] inputData                  The input data.
-     * @param[out]vecPairCsdSum              The sum of all CSD matrices for each trial.
-     * @param[out]vecPairCsdNormalizedSum    The sum of all normalized CSD matrices for each trial.
-     * @param[in] mutex                      The mutex used to safely access vecPairCsdSum.
+     * @param[out]matCsdSum                  The sum of the packed CSD matrices of all trials.
+     * @param[out]matCsdNormalizedSum        The sum of all normalized CSD matrices for each trial.
+     * @param[in] mutex                      The mutex used to safely access matCsdSum.
      * @param[in] iNRows                     The number of rows.
      * @param[in] iNFreqs                    The number of frequenciy bins.
      * @param[in] iNfft                      The FFT length.
      * @param[in] tapers                     The taper information.
+     * @param[in] bKeepIntermediateData      Whether to keep the intermediate data of the trial, see AbstractMetric::keepIntermediateData.
      */
     static void compute(ConnectivitySettings::IntermediateTrialData& inputData,
-                        QVector<QPair<int,Eigen::MatrixXcd> >& vecPairCsdSum,
-                        QVector<QPair<int,Eigen::MatrixXcd> >& vecPairCsdNormalizedSum,
+                        Eigen::MatrixXcd& matCsdSum,
+                        Eigen::MatrixXcd& matCsdNormalizedSum,
                         QMutex& mutex,
                         int iNRows,
                         int iNFreqs,
                         int iNfft,
-                        const QPair<Eigen::MatrixXd, Eigen::VectorXd>& tapers);
+                        const QPair<Eigen::MatrixXd, Eigen::VectorXd>& tapers,
+                        bool bKeepIntermediateData);
 
     //=========================================================================================================
     /**
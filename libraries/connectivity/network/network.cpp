@@ -44,6 +44,8 @@
 
 #include <utils/spectral.h>
 
+#include <algorithm>
+#include <cmath>
 #include <limits>
 
 //=============================================================================================================
@@ -68,6 +70,32 @@ using namespace UTILSLIB;
 // DEFINE GLOBAL METHODS
 //=============================================================================================================
 
+namespace {
+
+// Edges are sorted by their absolute weight. NaN weights never pass a threshold and are sorted to the front.
+inline double getSortKey(double dWeight)
+{
+    return std::isnan(dWeight) ? -std::numeric_limits<double>::max() : std::fabs(dWeight);
+}
+
+QPair<int,int> getMinMaxDegrees(const VectorXi& vecDegrees)
+{
+    int maxDegree = 0;
+    int minDegree = 1000000;
+
+    for(int i = 0; i < vecDegrees.size(); ++i) {
+        if(vecDegrees(i) > maxDegree){
+            maxDegree = vecDegrees(i);
+        } else if (vecDegrees(i) < minDegree){
+            minDegree = vecDegrees(i);
+        }
+    }
+
+    return QPair<int,int>(minDegree,maxDegree);
+}
+
+} // namespace
+
 //=============================================================================================================
 // DEFINE MEMBER METHODS
 //=============================================================================================================
@@ -81,6 +109,11 @@ Network::Network(const QString& sConnectivityMethod,
 , m_fSFreq(0.0f)
 , m_iFFTSize(128)
 , m_iNumberFreqBins(0)
+, m_minMaxFreqBins(QPair<int,int>(-1,-1))
+, m_iThresholdPos(0)
+, m_bFullEdgesAreDirty(false)
+, m_bThresholdedEdgesAreDirty(false)
+, m_bAdjacencyIsDirty(true)
 {
     qRegisterMetaType<CONNECTIVITYLIB::Network>("CONNECTIVITYLIB::Network");
     qRegisterMetaType<CONNECTIVITYLIB::Network::SPtr>("CONNECTIVITYLIB::Network::SPtr");
@@ -95,6 +128,23 @@ MatrixXd Network::getFullConnectivityMatrix(bool bGetMirroredVersion) const
     MatrixXd matDist(m_lNodes.size(), m_lNodes.size());
     matDist.setZero();
 
+    if(hasPackedWeights()) {
+        for(int p = 0; p < m_vecWeights.size(); ++p) {
+            int row = m_vecPairStartNodes(p);
+            int col = m_vecPairEndNodes(p);
+
+            if(row != col && row < matDist.rows() && col < matDist.cols()) {
+                matDist(row,col) = m_vecWeights(p);
+
+                if(bGetMirroredVersion) {
+                    matDist(col,row) = m_vecWeights(p);
+                }
+            }
+        }
+
+        return matDist;
+    }
+
     for(int i = 0; i < m_lFullEdges.size(); ++i) {
         int row = m_lFullEdges.at(i)->getStartNodeID();
         int col = m_lFullEdges.at(i)->getEndNodeID();
@@ -119,6 +169,24 @@ MatrixXd Network::getThresholdedConnectivityMatrix(bool bGetMirroredVersion) con
     MatrixXd matDist(m_lNodes.size(), m_lNodes.size());
     matDist.setZero();
 
+    if(hasPackedWeights()) {
+        for(int e = m_iThresholdPos; e < m_vecSortedEdges.size(); ++e) {
+            int p = m_vecSortedEdges(e);
+            int row = m_vecPairStartNodes(p);
+            int col = m_vecPairEndNodes(p);
+
+            if(row < matDist.rows() && col < matDist.cols()) {
+                matDist(row,col) = m_vecWeights(p);
+
+                if(bGetMirroredVersion) {
+                    matDist(col,row) = m_vecWeights(p);
+                }
+            }
+        }
+
+        return matDist;
+    }
+
     for(int i = 0; i < m_lThresholdedEdges.size(); ++i) {
         int row = m_lThresholdedEdges.at(i)->getStartNodeID();
         int col = m_lThresholdedEdges.at(i)->getEndNodeID();
@@ -138,8 +206,80 @@ MatrixXd Network::getThresholdedConnectivityMatrix(bool bGetMirroredVersion) con
 
 //=============================================================================================================
 
+const SparseMatrix<double, RowMajor>& Network::getThresholdedAdjacency() const
+{
+    if(!m_bAdjacencyIsDirty) {
+        return m_matThresholdedAdjacency;
+    }
+
+    int iNNodes = m_lNodes.size();
+    std::vector<Eigen::Triplet<double> > tripletList;
+
+    if(hasPackedWeights()) {
+        tripletList.reserve(2 * (m_vecSortedEdges.size() - m_iThresholdPos));
+
+        for(int e = m_iThresholdPos; e < m_vecSortedEdges.size(); ++e) {
+            int p = m_vecSortedEdges(e);
+            tripletList.push_back(Eigen::Triplet<double>(m_vecPairStartNodes(p), m_vecPairEndNodes(p), m_vecWeights(p)));
+            tripletList.push_back(Eigen::Triplet<double>(m_vecPairEndNodes(p), m_vecPairStartNodes(p), m_vecWeights(p)));
+        }
+    } else {
+        tripletList.reserve(2 * m_lThresholdedEdges.size());
+
+        for(int i = 0; i < m_lThresholdedEdges.size(); ++i) {
+            int row = m_lThresholdedEdges.at(i)->getStartNodeID();
+            int col = m_lThresholdedEdges.at(i)->getEndNodeID();
+
+            if(row < iNNodes && col < iNNodes) {
+                tripletList.push_back(Eigen::Triplet<double>(row, col, m_lThresholdedEdges.at(i)->getWeight()));
+                tripletList.push_back(Eigen::Triplet<double>(col, row, m_lThresholdedEdges.at(i)->getWeight()));
+            }
+        }
+    }
+
+    m_matThresholdedAdjacency.resize(iNNodes, iNNodes);
+    m_matThresholdedAdjacency.setFromTriplets(tripletList.begin(), tripletList.end());
+    m_bAdjacencyIsDirty = false;
+
+    return m_matThresholdedAdjacency;
+}
+
+//=============================================================================================================
+
 const QList<NetworkEdge::SPtr>& Network::getFullEdges() const
 {
+    if(hasPackedWeights() && m_bFullEdgesAreDirty) {
+        // Attach the edges to the nodes, unless a copy of this network did so already
+        QVector<bool> vecAttachToNode(m_lNodes.size());
+        for(int i = 0; i < m_lNodes.size(); ++i) {
+            vecAttachToNode[i] = m_lNodes.at(i)->getFullEdges().isEmpty();
+        }
+
+        m_lFullEdges.clear();
+        m_lFullEdges.reserve(m_vecSortedEdges.size());
+
+        for(int p = 0; p < m_vecWeights.size(); ++p) {
+            int iStart = m_vecPairStartNodes(p);
+            int iEnd = m_vecPairEndNodes(p);
+
+            if(iStart == iEnd) {
+                continue;
+            }
+
+            NetworkEdge::SPtr pEdge = getPackedEdge(p);
+            m_lFullEdges.append(pEdge);
+
+            if(iStart < m_lNodes.size() && vecAttachToNode.at(iStart)) {
+                m_lNodes.at(iStart)->append(pEdge);
+            }
+            if(iEnd < m_lNodes.size() && vecAttachToNode.at(iEnd)) {
+                m_lNodes.at(iEnd)->append(pEdge);
+            }
+        }
+
+        m_bFullEdgesAreDirty = false;
+    }
+
     return m_lFullEdges;
 }
 
@@ -147,6 +287,22 @@ const QList<NetworkEdge::SPtr>& Network::getFullEdges() const
 
 const QList<NetworkEdge::SPtr>& Network::getThresholdedEdges() const
 {
+    if(hasPackedWeights() && m_bThresholdedEdgesAreDirty) {
+        // Keep the pair order of the full network
+        std::vector<int> vecPairs(m_vecSortedEdges.data() + m_iThresholdPos,
+                                  m_vecSortedEdges.data() + m_vecSortedEdges.size());
+        std::sort(vecPairs.begin(), vecPairs.end());
+
+        m_lThresholdedEdges.clear();
+        m_lThresholdedEdges.reserve(int(vecPairs.size()));
+
+        for(size_t i = 0; i < vecPairs.size(); ++i) {
+            m_lThresholdedEdges.append(getPackedEdge(vecPairs[i]));
+        }
+
+        m_bThresholdedEdgesAreDirty = false;
+    }
+
     return m_lThresholdedEdges;
 }
 
@@ -168,6 +324,10 @@ NetworkNode::SPtr Network::getNodeAt(int i)
 
 qint16 Network::getFullDistribution() const
 {
+    if(hasPackedWeights()) {
+        return qint16(2 * m_vecSortedEdges.size());
+    }
+
     qint16 distribution = 0;
 
     for(int i = 0; i < m_lNodes.size(); ++i) {
@@ -181,6 +341,10 @@ qint16 Network::getFullDistribution() const
 
 qint16 Network::getThresholdedDistribution() const
 {
+    if(hasPackedWeights()) {
+        return qint16(2 * (m_vecSortedEdges.size() - m_iThresholdPos));
+    }
+
     qint16 distribution = 0;
 
     for(int i = 0; i < m_lNodes.size(); ++i) {
@@ -192,6 +356,23 @@ qint16 Network::getThresholdedDistribution() const
 
 //=============================================================================================================
 
+VectorXi Network::getThresholdedDegrees() const
+{
+    if(hasPackedWeights()) {
+        return m_vecThresholdedIndegrees + m_vecThresholdedOutdegrees;
+    }
+
+    VectorXi vecDegrees(m_lNodes.size());
+
+    for(int i = 0; i < m_lNodes.size(); ++i) {
+        vecDegrees(i) = m_lNodes.at(i)->getThresholdedDegree();
+    }
+
+    return vecDegrees;
+}
+
+//=============================================================================================================
+
 void Network::setConnectivityMethod(const QString& sConnectivityMethod)
 {
     m_sConnectivityMethod = sConnectivityMethod;
@@ -222,6 +403,10 @@ QPair<double, double> Network::getMinMaxThresholdedWeights() const
 
 QPair<int,int> Network::getMinMaxFullDegrees() const
 {
+    if(hasPackedWeights()) {
+        return getMinMaxDegrees(VectorXi::Constant(m_vecThresholdedIndegrees.size(), m_vecThresholdedIndegrees.size() - 1));
+    }
+
     int maxDegree = 0;
     int minDegree = 1000000;
 
@@ -240,6 +425,10 @@ QPair<int,int> Network::getMinMaxFullDegrees() const
 
 QPair<int,int> Network::getMinMaxThresholdedDegrees() const
 {
+    if(hasPackedWeights()) {
+        return getMinMaxDegrees(m_vecThresholdedIndegrees + m_vecThresholdedOutdegrees);
+    }
+
     int maxDegree = 0;
     int minDegree = 1000000;
 
@@ -258,6 +447,10 @@ QPair<int,int> Network::getMinMaxThresholdedDegrees() const
 
 QPair<int,int> Network::getMinMaxFullIndegrees() const
 {
+    if(hasPackedWeights()) {
+        return getMinMaxDegrees(VectorXi::LinSpaced(m_vecThresholdedIndegrees.size(), 0, m_vecThresholdedIndegrees.size() - 1));
+    }
+
     int maxDegree = 0;
     int minDegree = 1000000;
 
@@ -276,6 +469,10 @@ QPair<int,int> Network::getMinMaxFullIndegrees() const
 
 QPair<int,int> Network::getMinMaxThresholdedIndegrees() const
 {
+    if(hasPackedWeights()) {
+        return getMinMaxDegrees(m_vecThresholdedIndegrees);
+    }
+
     int maxDegree = 0;
     int minDegree = 1000000;
 
@@ -294,6 +491,10 @@ QPair<int,int> Network::getMinMaxThresholdedIndegrees() const
 
 QPair<int,int> Network::getMinMaxFullOutdegrees() const
 {
+    if(hasPackedWeights()) {
+        return getMinMaxDegrees(VectorXi::LinSpaced(m_vecThresholdedIndegrees.size(), m_vecThresholdedIndegrees.size() - 1, 0));
+    }
+
     int maxDegree = 0;
     int minDegree = 1000000;
 
@@ -312,6 +513,10 @@ QPair<int,int> Network::getMinMaxFullOutdegrees() const
 
 QPair<int,int> Network::getMinMaxThresholdedOutdegrees() const
 {
+    if(hasPackedWeights()) {
+        return getMinMaxDegrees(m_vecThresholdedOutdegrees);
+    }
+
     int maxDegree = 0;
     int minDegree = 1000000;
 
@@ -331,15 +536,22 @@ QPair<int,int> Network::getMinMaxThresholdedOutdegrees() const
 void Network::setThreshold(double dThreshold)
 {
     m_dThreshold = dThreshold;
-    m_lThresholdedEdges.clear();
 
-    for(int i = 0; i < m_lFullEdges.size(); ++i) {
-        if(fabs(m_lFullEdges.at(i)->getWeight()) >= m_dThreshold) {
-            m_lFullEdges.at(i)->setActive(true);
-            m_lThresholdedEdges.append(m_lFullEdges.at(i));
-        } else {
-            m_lFullEdges.at(i)->setActive(false);
+    if(hasPackedWeights()) {
+        updateThresholdPosition();
+    } else {
+        m_lThresholdedEdges.clear();
+
+        for(int i = 0; i < m_lFullEdges.size(); ++i) {
+            if(fabs(m_lFullEdges.at(i)->getWeight()) >= m_dThreshold) {
+                m_lFullEdges.at(i)->setActive(true);
+                m_lThresholdedEdges.append(m_lFullEdges.at(i));
+            } else {
+                m_lFullEdges.at(i)->setActive(false);
+            }
         }
+
+        invalidateThresholdedViews();
     }
 
     m_minMaxThresholdedWeights.first = m_dThreshold;
@@ -385,6 +597,42 @@ void Network::setFrequencyRange(float fLowerFreq, float fUpperFreq)
     int iLowerBin = fLowerFreq * dScaleFactor;
     int iUpperBin = fUpperFreq * dScaleFactor;
 
+    if(hasPackedWeights()) {
+        int iNFreqs = m_matPackedWeights.cols();
+
+        if(iLowerBin >= iNFreqs) {
+            return;
+        }
+
+        iLowerBin = std::max(iLowerBin, 0);
+        iUpperBin = std::min(iUpperBin, iNFreqs - 1);
+
+        // Only add/subtract the bins which enter/leave the range, unless summing up the new range is cheaper
+        int iOldLowerBin = m_minMaxFreqBins.first;
+        int iOldUpperBin = m_minMaxFreqBins.second;
+
+        if(std::abs(iLowerBin - iOldLowerBin) + std::abs(iUpperBin - iOldUpperBin) >= iUpperBin - iLowerBin + 1) {
+            m_vecWeightSums = m_matPackedWeights.middleCols(iLowerBin, iUpperBin - iLowerBin + 1).rowwise().sum();
+        } else {
+            if(iLowerBin < iOldLowerBin) {
+                m_vecWeightSums += m_matPackedWeights.middleCols(iLowerBin, iOldLowerBin - iLowerBin).rowwise().sum();
+            } else if(iLowerBin > iOldLowerBin) {
+                m_vecWeightSums -= m_matPackedWeights.middleCols(iOldLowerBin, iLowerBin - iOldLowerBin).rowwise().sum();
+            }
+
+            if(iUpperBin > iOldUpperBin) {
+                m_vecWeightSums += m_matPackedWeights.middleCols(iOldUpperBin + 1, iUpperBin - iOldUpperBin).rowwise().sum();
+            } else if(iUpperBin < iOldUpperBin) {
+                m_vecWeightSums -= m_matPackedWeights.middleCols(iUpperBin + 1, iOldUpperBin - iUpperBin).rowwise().sum();
+            }
+        }
+
+        m_minMaxFreqBins = QPair<int,int>(iLowerBin, iUpperBin);
+        updatePackedWeights();
+
+        return;
+    }
+
     // Update the min max values
     m_minMaxFullWeights = QPair<double,double>(std::numeric_limits<double>::max(),0.0);
 
@@ -397,6 +645,8 @@ void Network::setFrequencyRange(float fLowerFreq, float fUpperFreq)
             m_minMaxFullWeights.second = fabs(m_lFullEdges.at(i)->getWeight());
         }
     }
+
+    invalidateThresholdedViews();
 }
 
 //=============================================================================================================
@@ -410,6 +660,11 @@ const QPair<float,float>& Network::getFrequencyRange() const
 
 void Network::append(NetworkEdge::SPtr newEdge)
 {
+    if(hasPackedWeights()) {
+        qWarning() << "Network::append - Edges cannot be appended to a network which holds packed weights. Returning.";
+        return;
+    }
+
     if(newEdge->getEndNodeID() != newEdge->getStartNodeID()) {
         double dEdgeWeight = newEdge->getWeight();
         if(dEdgeWeight < m_minMaxFullWeights.first) {
@@ -422,6 +677,7 @@ void Network::append(NetworkEdge::SPtr newEdge)
 
         if(fabs(newEdge->getWeight()) >= m_dThreshold) {
             m_lThresholdedEdges << newEdge;
+            m_bAdjacencyIsDirty = true;
         }
     }
 }
@@ -435,8 +691,69 @@ void Network::append(NetworkNode::SPtr newNode)
 
 //=============================================================================================================
 
+void Network::setPackedWeights(const MatrixXd& matPackedWeights)
+{
+    int iNNodes = m_lNodes.size();
+    int iNPairs = iNNodes * (iNNodes + 1) / 2;
+
+    if(matPackedWeights.rows() != iNPairs || matPackedWeights.cols() == 0) {
+        qWarning() << "Network::setPackedWeights - Number of rows does not match the number of node pairs. Returning.";
+        return;
+    }
+
+    if(!hasPackedWeights() && !m_lFullEdges.isEmpty()) {
+        qWarning() << "Network::setPackedWeights - Network already holds appended edges. Returning.";
+        return;
+    }
+
+    m_matPackedWeights = matPackedWeights;
+
+    m_vecPairStartNodes.resize(iNPairs);
+    m_vecPairEndNodes.resize(iNPairs);
+
+    for(int i = 0, p = 0; i < iNNodes; ++i) {
+        for(int j = i; j < iNNodes; ++j, ++p) {
+            m_vecPairStartNodes(p) = i;
+            m_vecPairEndNodes(p) = j;
+        }
+    }
+
+    // Average over all frequency bins until a frequency range is set
+    m_minMaxFreqBins = QPair<int,int>(0, m_matPackedWeights.cols() - 1);
+    m_vecWeightSums = m_matPackedWeights.rowwise().sum();
+
+    // Edge objects are created on demand only
+    m_vecPackedEdges.clear();
+    m_vecPackedEdges.resize(iNPairs);
+    m_lFullEdges.clear();
+    m_lThresholdedEdges.clear();
+    m_bFullEdgesAreDirty = true;
+
+    updatePackedWeights();
+}
+
+//=============================================================================================================
+
+const MatrixXd& Network::getPackedWeights() const
+{
+    return m_matPackedWeights;
+}
+
+//=============================================================================================================
+
+bool Network::hasPackedWeights() const
+{
+    return m_matPackedWeights.size() != 0;
+}
+
+//=============================================================================================================
+
 bool Network::isEmpty() const
 {
+    if(hasPackedWeights()) {
+        return m_vecSortedEdges.size() == 0 || m_lNodes.isEmpty();
+    }
+
     if(m_lFullEdges.isEmpty() || m_lNodes.isEmpty()) {
         return true;
     }
@@ -454,10 +771,22 @@ void Network::normalize()
         return;
     }
 
-    for(int i = 0; i < m_lFullEdges.size(); ++i) {
-        m_lFullEdges.at(i)->setWeight(m_lFullEdges.at(i)->getWeight()/m_minMaxFullWeights.second);
+    if(hasPackedWeights()) {
+        m_vecWeights /= m_minMaxFullWeights.second;
+
+        for(int p = 0; p < m_vecPackedEdges.size(); ++p) {
+            if(m_vecPackedEdges.at(p)) {
+                m_vecPackedEdges.at(p)->setWeight(m_vecWeights(p));
+            }
+        }
+    } else {
+        for(int i = 0; i < m_lFullEdges.size(); ++i) {
+            m_lFullEdges.at(i)->setWeight(m_lFullEdges.at(i)->getWeight()/m_minMaxFullWeights.second);
+        }
     }
 
+    invalidateThresholdedViews();
+
     m_minMaxFullWeights.first = m_minMaxFullWeights.first/m_minMaxFullWeights.second;
     m_minMaxFullWeights.second = 1.0;
 
@@ -521,3 +850,120 @@ int Network::getFFTSize()
     return m_iFFTSize;
 }
 
+//=============================================================================================================
+
+void Network::updatePackedWeights()
+{
+    int iNNodes = m_lNodes.size();
+
+    m_vecWeights = m_vecWeightSums / double(m_minMaxFreqBins.second - m_minMaxFreqBins.first + 1);
+
+    // Sort the edges, i.e. all pairs of two different nodes, by their absolute weight
+    m_vecSortedEdges.resize(iNNodes * (iNNodes - 1) / 2);
+
+    for(int p = 0, e = 0; p < m_vecWeights.size(); ++p) {
+        if(m_vecPairStartNodes(p) != m_vecPairEndNodes(p)) {
+            m_vecSortedEdges(e++) = p;
+        }
+    }
+
+    std::sort(m_vecSortedEdges.data(),
+              m_vecSortedEdges.data() + m_vecSortedEdges.size(),
+              [this](int iPairA, int iPairB) {
+                  return getSortKey(m_vecWeights(iPairA)) < getSortKey(m_vecWeights(iPairB));
+              });
+
+    m_minMaxFullWeights = QPair<double,double>(std::numeric_limits<double>::max(),0.0);
+
+    if(m_vecSortedEdges.size() > 0) {
+        m_minMaxFullWeights.first = fabs(m_vecWeights(m_vecSortedEdges(0)));
+        m_minMaxFullWeights.second = fabs(m_vecWeights(m_vecSortedEdges(m_vecSortedEdges.size() - 1)));
+    }
+
+    // Start from an empty thresholded network and let the threshold activate the edges again
+    m_iThresholdPos = m_vecSortedEdges.size();
+    m_vecThresholdedIndegrees = VectorXi::Zero(iNNodes);
+    m_vecThresholdedOutdegrees = VectorXi::Zero(iNNodes);
+
+    for(int p = 0; p < m_vecPackedEdges.size(); ++p) {
+        if(m_vecPackedEdges.at(p)) {
+            m_vecPackedEdges.at(p)->setActive(false);
+            m_vecPackedEdges.at(p)->setFrequencyBins(m_minMaxFreqBins);
+            m_vecPackedEdges.at(p)->setWeight(m_vecWeights(p));
+        }
+    }
+
+    updateThresholdPosition();
+    invalidateThresholdedViews();
+
+    m_minMaxThresholdedWeights.first = m_dThreshold;
+    m_minMaxThresholdedWeights.second = m_minMaxFullWeights.second;
+}
+
+//=============================================================================================================
+
+void Network::updateThresholdPosition()
+{
+    const int* pSortedBegin = m_vecSortedEdges.data();
+    const int* pSortedEnd = pSortedBegin + m_vecSortedEdges.size();
+
+    int iThresholdPos = std::lower_bound(pSortedBegin,
+                                         pSortedEnd,
+                                         m_dThreshold,
+                                         [this](int iPair, double dThreshold) {
+                                             return getSortKey(m_vecWeights(iPair)) < dThreshold;
+                                         }) - pSortedBegin;
+
+    if(iThresholdPos == m_iThresholdPos) {
+        return;
+    }
+
+    // Only the edges between the old and the new position change their state
+    bool bActive = iThresholdPos < m_iThresholdPos;
+    int iStep = bActive ? 1 : -1;
+
+    for(int e = std::min(iThresholdPos, m_iThresholdPos); e < std::max(iThresholdPos, m_iThresholdPos); ++e) {
+        int p = m_vecSortedEdges(e);
+
+        m_vecThresholdedOutdegrees(m_vecPairStartNodes(p)) += iStep;
+        m_vecThresholdedIndegrees(m_vecPairEndNodes(p)) += iStep;
+
+        if(m_vecPackedEdges.at(p)) {
+            m_vecPackedEdges.at(p)->setActive(bActive);
+        }
+    }
+
+    m_iThresholdPos = iThresholdPos;
+
+    invalidateThresholdedViews();
+}
+
+//=============================================================================================================
+
+NetworkEdge::SPtr Network::getPackedEdge(int iPair) const
+{
+    NetworkEdge::SPtr& pEdge = m_vecPackedEdges[iPair];
+
+    if(!pEdge) {
+        bool bActive = m_iThresholdPos < m_vecSortedEdges.size()
+                       && getSortKey(m_vecWeights(iPair)) >= getSortKey(m_vecWeights(m_vecSortedEdges(m_iThresholdPos)));
+
+        pEdge = NetworkEdge::SPtr(new NetworkEdge(m_vecPairStartNodes(iPair),
+                                                  m_vecPairEndNodes(iPair),
+                                                  m_matPackedWeights.row(iPair).transpose(),
+                                                  bActive,
+                                                  m_minMaxFreqBins.first,
+                                                  m_minMaxFreqBins.second));
+        pEdge->setWeight(m_vecWeights(iPair));
+    }
+
+    return pEdge;
+}
+
+//=============================================================================================================
+
+void Network::invalidateThresholdedViews()
+{
+    m_bThresholdedEdgesAreDirty = true;
+    m_bAdjacencyIsDirty = true;
+}
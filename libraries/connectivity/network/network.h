@@ -46,12 +46,14 @@
 //=============================================================================================================
 
 #include <QSharedPointer>
+#include <QVector>
 
 //=============================================================================================================
 // EIGEN INCLUDES
 //=============================================================================================================
 
 #include <Eigen/Core>
+#include <Eigen/SparseCore>
 
 //=============================================================================================================
 // FORWARD DECLARATIONS
@@ -127,7 +129,17 @@ public:
 
     //=========================================================================================================
     /**
-     * Returns the full and non thresholded edges.
+     * Returns the thresholded connectivity matrix as a compressed sparse row adjacency. The adjacency is always
+     * mirrored and is only rebuilt after the threshold, the frequency range or the weights changed.
+     *
+     * @return    The thresholded adjacency in CSR format.
+     */
+    const Eigen::SparseMatrix<double, Eigen::RowMajor>& getThresholdedAdjacency() const;
+
+    //=========================================================================================================
+    /**
+     * Returns the full and non thresholded edges. For networks holding packed weights the edge objects are created
+     * on the first call and attached to their nodes.
      *
      * @return Returns the network edges.
      */
@@ -135,7 +147,8 @@ public:
 
     //=========================================================================================================
     /**
-     * Returns the thresholded edges.
+     * Returns the thresholded edges. For networks holding packed weights only the edge objects of the active edges
+     * are created.
      *
      * @return Returns the network edges.
      */
@@ -143,7 +156,8 @@ public:
 
     //=========================================================================================================
     /**
-     * Returns the nodes.
+     * Returns the nodes. Nodes of networks holding packed weights only know their edges after getFullEdges() was
+     * called. Use the degree queries of the network instead.
      *
      * @return Returns the network nodes.
      */
@@ -185,6 +199,14 @@ public:
      */
     qint16 getThresholdedDistribution() const;
 
+    //=========================================================================================================
+    /**
+     * Returns the thresholded degree of every node.
+     *
+     * @return   The thresholded degrees ordered by node id.
+     */
+    Eigen::VectorXi getThresholdedDegrees() const;
+
     //=========================================================================================================
     /**
      * Sets the connectivity measure method used to create the data of this network structure.
@@ -314,6 +336,33 @@ public:
      */
     void append(QSharedPointer<NetworkNode> newNode);
 
+    //=========================================================================================================
+    /**
+     * Sets the frequency resolved weights of all edges of a non-directional network at once. Row p holds the weights
+     * of the node pair (i,j), j >= i, with p = i*n - i*(i-1)/2 + j - i, which is the layout of the intermediate sums
+     * in ConnectivitySettings. Pairs with i == j are stored but never treated as edges. The nodes need to be
+     * appended beforehand. Edge objects are only created once they are requested.
+     *
+     * @param[in] matPackedWeights    The packed weights (pairs x frequency bins).
+     */
+    void setPackedWeights(const Eigen::MatrixXd& matPackedWeights);
+
+    //=========================================================================================================
+    /**
+     * Returns the packed weights. Empty if the edges were appended one by one.
+     *
+     * @return   The packed weights (pairs x frequency bins).
+     */
+    const Eigen::MatrixXd& getPackedWeights() const;
+
+    //=========================================================================================================
+    /**
+     * Returns whether the edge weights are held in packed form.
+     *
+     * @return   Whether the edge weights are held in packed form.
+     */
+    bool hasPackedWeights() const;
+
     //=========================================================================================================
     /**
      * Returns whether the Network is empty by checking the number of nodes and edges.
@@ -393,8 +442,38 @@ public:
     int getFFTSize();
 
 protected:
-    QList<QSharedPointer<NetworkEdge> >     m_lFullEdges;               /**< List with all edges of the network.*/
-    QList<QSharedPointer<NetworkEdge> >     m_lThresholdedEdges;        /**< List with all the active (thresholded) edges of the network.*/
+    //=========================================================================================================
+    /**
+     * Recomputes the averaged weights of the packed representation from the current weight sums, sorts the edges by
+     * their absolute weight and updates the thresholded degrees.
+     */
+    void updatePackedWeights();
+
+    //=========================================================================================================
+    /**
+     * Moves the threshold position in the sorted edges to the current threshold. Only the thresholded degrees and the
+     * edge activity of the edges passed on the way are updated.
+     */
+    void updateThresholdPosition();
+
+    //=========================================================================================================
+    /**
+     * Returns the edge object of a packed pair and creates it if it does not exist yet.
+     *
+     * @param[in] iPair      The pair index.
+     *
+     * @return   The edge object.
+     */
+    QSharedPointer<NetworkEdge> getPackedEdge(int iPair) const;
+
+    //=========================================================================================================
+    /**
+     * Invalidates the thresholded edge list and adjacency after the thresholded edges or their weights changed.
+     */
+    void invalidateThresholdedViews();
+
+    mutable QList<QSharedPointer<NetworkEdge> >     m_lFullEdges;               /**< List with all edges of the network.*/
+    mutable QList<QSharedPointer<NetworkEdge> >     m_lThresholdedEdges;        /**< List with all the active (thresholded) edges of the network.*/
 
     QList<QSharedPointer<NetworkNode> >     m_lNodes;                   /**< List with all nodes of the network.*/
 
@@ -412,6 +491,23 @@ protected:
     int                                     m_iFFTSize;                 /**< The used FFT size (number of total frequency bins for a half spectrum - only positive frequencies).*/
 
     VisualizationInfo                       m_visualizationInfo;        /**< The current visualization info used to plot the network later on.*/
+
+    Eigen::MatrixXd                         m_matPackedWeights;         /**< The frequency resolved weights of all node pairs (pairs x frequency bins). Empty if edges were appended one by one.*/
+    Eigen::VectorXd                         m_vecWeightSums;            /**< The sums of the packed weights over the current frequency bins.*/
+    Eigen::VectorXd                         m_vecWeights;               /**< The averaged weights of all node pairs.*/
+    Eigen::VectorXi                         m_vecPairStartNodes;        /**< The start node of all node pairs.*/
+    Eigen::VectorXi                         m_vecPairEndNodes;          /**< The end node of all node pairs.*/
+    Eigen::VectorXi                         m_vecSortedEdges;           /**< The pair indices of all edges sorted by ascending absolute weight.*/
+    Eigen::VectorXi                         m_vecThresholdedIndegrees;  /**< The thresholded indegree of all nodes.*/
+    Eigen::VectorXi                         m_vecThresholdedOutdegrees; /**< The thresholded outdegree of all nodes.*/
+    QPair<int,int>                          m_minMaxFreqBins;           /**< The lower/upper frequency bin the weight sums are taken from/to.*/
+    int                                     m_iThresholdPos;            /**< The position of the first sorted edge whose absolute weight passes the threshold.*/
+
+    mutable QVector<QSharedPointer<NetworkEdge> >           m_vecPackedEdges;               /**< The lazily created edge objects of all node pairs.*/
+    mutable Eigen::SparseMatrix<double, Eigen::RowMajor>    m_matThresholdedAdjacency;      /**< The thresholded adjacency in CSR format.*/
+    mutable bool                                            m_bFullEdgesAreDirty;           /**< Whether the full edge list needs to be rebuilt.*/
+    mutable bool                                            m_bThresholdedEdgesAreDirty;    /**< Whether the thresholded edge list needs to be rebuilt.*/
+    mutable bool                                            m_bAdjacencyIsDirty;            /**< Whether the thresholded adjacency needs to be rebuilt.*/
 };
 
 //=============================================================================================================
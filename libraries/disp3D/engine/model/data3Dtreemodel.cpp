@@ -46,6 +46,7 @@
 #include "items/freesurfer/fssurfacetreeitem.h"
 #include "items/sourcespace/sourcespacetreeitem.h"
 #include "items/measurement/measurementtreeitem.h"
+#include "items/sourcedata/mnedatatreeitem.h"
 #include "items/mri/mritreeitem.h"
 #include "items/digitizer/digitizertreeitem.h"
 #include "items/sensordata/sensordatatreeitem.h"
@@ -268,7 +269,8 @@ MneDataTreeItem* Data3DTreeModel::addSourceData(const QString& sSubject,
                                                     tSurfSet,
                                                     tAnnotSet,
                                                     m_pModelEntity,
-                                                    bUseGPU);
+                                                    bUseGPU,
+                                                    m_viewportSize);
         }
     } else {
         MeasurementTreeItem* pMeasurementItem = new MeasurementTreeItem(Data3DTreeModelItemTypes::MeasurementItem, sMeasurementSetName);
@@ -278,7 +280,8 @@ MneDataTreeItem* Data3DTreeModel::addSourceData(const QString& sSubject,
                                                 tSurfSet,
                                                 tAnnotSet,
                                                 m_pModelEntity,
-                                                bUseGPU);
+                                                bUseGPU,
+                                                m_viewportSize);
     }
 
     return pReturnItem;
@@ -532,6 +535,36 @@ QPointer<Qt3DCore::QEntity> Data3DTreeModel::getRootEntity()
 
 //=============================================================================================================
 
+void Data3DTreeModel::setViewportSize(const QSize& viewportSize)
+{
+    if(m_viewportSize == viewportSize) {
+        return;
+    }
+
+    m_viewportSize = viewportSize;
+
+    //Pass the new size on to all source estimate items
+    for(int i = 0; i < m_pRootItem->rowCount(); ++i) {
+        if(SubjectTreeItem* pSubjectItem = dynamic_cast<SubjectTreeItem*>(m_pRootItem->child(i))) {
+            QList<QStandardItem*> lMeasurementItems = pSubjectItem->findChildren(Data3DTreeModelItemTypes::MeasurementItem);
+
+            for(int j = 0; j < lMeasurementItems.size(); ++j) {
+                if(MeasurementTreeItem* pMeasurementItem = dynamic_cast<MeasurementTreeItem*>(lMeasurementItems.at(j))) {
+                    QList<QStandardItem*> lMneItems = pMeasurementItem->findChildren(Data3DTreeModelItemTypes::MNEDataItem);
+
+                    for(int k = 0; k < lMneItems.size(); ++k) {
+                        if(MneDataTreeItem* pMneItem = dynamic_cast<MneDataTreeItem*>(lMneItems.at(k))) {
+                            pMneItem->setViewportSize(m_viewportSize);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+//=============================================================================================================
+
 SubjectTreeItem* Data3DTreeModel::addSubject(const QString& sSubject)
 {
     SubjectTreeItem* pReturnItem= Q_NULLPTR;
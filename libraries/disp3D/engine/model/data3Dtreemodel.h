@@ -56,6 +56,7 @@
 
 #include <QStandardItemModel>
 #include <QPointer>
+#include <QSize>
 
 //=============================================================================================================
 // EIGEN INCLUDES
@@ -362,6 +363,15 @@ public:
      */
     QPointer<Qt3DCore::QEntity> getRootEntity();
 
+    //=========================================================================================================
+    /**
+     * Sets the size of the viewport the model is rendered to. Items which support levels of detail, e.g. the
+     * source estimate items, select their level based on this size.
+     *
+     * @param[in] viewportSize   The size of the viewport in pixels.
+     */
+    void setViewportSize(const QSize& viewportSize);
+
 protected:
     //=========================================================================================================
     /**
@@ -429,6 +439,7 @@ protected:
 
     QStandardItem*                   m_pRootItem;            /**< The root item of the tree model. */
     QPointer<Qt3DCore::QEntity>      m_pModelEntity;         /**< The parent 3D entity for this model. */
+    QSize                            m_viewportSize;         /**< The size of the viewport the model is rendered to. */
 };
 } // NAMESPACE
 
@@ -160,7 +160,8 @@ MneDataTreeItem* MeasurementTreeItem::addData(const MNESourceEstimate& tSourceEs
                                               const SurfaceSet& tSurfSet,
                                               const AnnotationSet& tAnnotSet,
                                               Qt3DCore::QEntity* p3DEntityParent,
-                                              bool bUseGPU)
+                                              bool bUseGPU,
+                                              const QSize& viewportSize)
 {
     if(!tSourceEstimate.isEmpty()) {        
         //CPU for source data
@@ -178,6 +179,7 @@ MneDataTreeItem* MeasurementTreeItem::addData(const MNESourceEstimate& tSourceEs
             list << new QStandardItem(m_pMneDataTreeItem->toolTip());
             this->appendRow(list);
 
+            m_pMneDataTreeItem->setViewportSize(viewportSize);
             m_pMneDataTreeItem->initData(tForwardSolution,
                                              tSurfSet,
                                              tAnnotSet,
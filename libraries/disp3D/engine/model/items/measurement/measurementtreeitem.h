@@ -52,6 +52,7 @@
 //=============================================================================================================
 
 #include <QPointer>
+#include <QSize>
 
 //=============================================================================================================
 // EIGEN INCLUDES
@@ -151,6 +152,7 @@ public:
      * @param[in] tAnnotSet          The annotation set holding the left and right hemisphere annotations.
      * @param[in] p3DEntityParent    Pointer to the QEntity parent.
      * @param[in] bUseGPU            Whether to use GPU support for visualizing real-time data.
+     * @param[in] viewportSize       The size of the viewport, used to select the level of detail of the surfaces.
      *
      * @return                       Returns a pointer to the added tree item. Default is a NULL pointer if no item was added.
      */
@@ -159,7 +161,8 @@ public:
                              const FSLIB::SurfaceSet &tSurfSet,
                              const FSLIB::AnnotationSet &tAnnotSet,
                              Qt3DCore::QEntity *p3DEntityParent,
-                             bool bUseGPU = false);
+                             bool bUseGPU = false,
+                             const QSize& viewportSize = QSize());
 
     //=========================================================================================================
     /**
@@ -254,6 +254,7 @@ void NetworkTreeItem::plotNodes(const Network& tNetworkData)
     }
 
     QList<NetworkNode::SPtr> lNetworkNodes = tNetworkData.getNodes();
+    VectorXi vecDegrees = tNetworkData.getThresholdedDegrees();
     qint16 iMaxDegree = tNetworkData.getMinMaxThresholdedDegrees().second;
 
     VisualizationInfo visualizationInfo = tNetworkData.getVisualizationInfo();
@@ -286,7 +287,7 @@ void NetworkTreeItem::plotNodes(const Network& tNetworkData)
     qint16 iDegree = 0;
 
     for(int i = 0; i < lNetworkNodes.size(); ++i) {
-        iDegree = lNetworkNodes.at(i)->getThresholdedDegree();
+        iDegree = vecDegrees(i);
 
         if(iDegree != 0) {
             tempPos = QVector3D(lNetworkNodes.at(i)->getVert()(0),
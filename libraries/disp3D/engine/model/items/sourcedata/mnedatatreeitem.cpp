@@ -56,6 +56,7 @@
 //=============================================================================================================
 
 #include <QVector3D>
+#include <QHash>
 #include <Qt3DCore/QEntity>
 
 //=============================================================================================================
@@ -84,6 +85,7 @@ MneDataTreeItem::MneDataTreeItem(int iType,
 : AbstractTreeItem(iType, text)
 , m_bIsDataInit(false)
 , m_bUseGPU(bUseGPU)
+, m_iLodLevel(0)
 {
     initItem();
 }
@@ -266,6 +268,33 @@ void MneDataTreeItem::initData(const MNEForwardSolution& tForwardSolution,
     tAnnotSet[0].toLabels(tSurfSet[0], qListLabelsLeft, qListLabelRGBAs);
     tAnnotSet[1].toLabels(tSurfSet[1], qListLabelsRight, qListLabelRGBAs);
 
+    //Precompute the levels of detail of both hemispheres for the CPU based interpolation
+    m_lHemisphereLodData.clear();
+
+    if(!m_bUseGPU) {
+        for(int i = 0; i < 2; ++i) {
+            HemisphereLodData hemiData;
+
+            //The levels of detail can only be mapped to the source space if it was set up on the same surface
+            int iMaxNumLevels = tForwardSolution.src[i].rr.rows() == tSurfSet[i].rr().rows() ? 3 : 1;
+
+            hemiData.meshLod = MeshLod(tSurfSet[i].rr(),
+                                       tSurfSet[i].nn(),
+                                       tSurfSet[i].tris(),
+                                       iMaxNumLevels);
+            hemiData.matSourceVertices = tForwardSolution.src[i].rr;
+            hemiData.vecSourceNeighborVertices = tForwardSolution.src[i].neighbor_vert;
+            hemiData.vecCurvature = tSurfSet[i].curv();
+            hemiData.vecVertNo = i == 0 ? clustVertNoLeft : clustVertNoRight;
+            hemiData.vecLabelIds = i == 0 ? vecLabelIdsLeftHemi : vecLabelIdsRightHemi;
+            hemiData.lLabels = i == 0 ? qListLabelsLeft : qListLabelsRight;
+
+            m_lHemisphereLodData.append(hemiData);
+        }
+
+        m_iLodLevel = m_lHemisphereLodData.first().meshLod.levelForViewport(m_viewportSize);
+    }
+
     //set rt data corresponding to the hemisphere
     if(!m_pRtSourceDataController) {
         m_pRtSourceDataController = new RtSourceDataController();
@@ -333,12 +362,6 @@ void MneDataTreeItem::initData(const MNEForwardSolution& tForwardSolution,
                                                             Data3DTreeModelItemTypes::AbstractMeshItem,
                                                             QStringLiteral("3D Plot - Left"));
 
-            m_pInterpolationItemLeftCPU->setMeshData(tSurfSet[0].rr(),
-                                                     tSurfSet[0].nn(),
-                                                     tSurfSet[0].tris(),
-                                                     FsSurfaceTreeItem::createCurvatureVertColor(tSurfSet[0].curv()),
-                                                     Qt3DRender::QGeometryRenderer::Triangles);
-
             m_pInterpolationItemLeftCPU->setPosition(QVector3D(-tSurfSet[0].offset()(0),
                                                                -tSurfSet[0].offset()(1),
                                                                -tSurfSet[0].offset()(2)));
@@ -360,12 +383,6 @@ void MneDataTreeItem::initData(const MNEForwardSolution& tForwardSolution,
                                                             Data3DTreeModelItemTypes::AbstractMeshItem,
                                                             QStringLiteral("3D Plot - Right"));
 
-            m_pInterpolationItemRightCPU->setMeshData(tSurfSet[1].rr(),
-                                                      tSurfSet[1].nn(),
-                                                      tSurfSet[1].tris(),
-                                                      FsSurfaceTreeItem::createCurvatureVertColor(tSurfSet[1].curv()),
-                                                      Qt3DRender::QGeometryRenderer::Triangles);
-
             m_pInterpolationItemRightCPU->setPosition(QVector3D(-tSurfSet[1].offset()(0),
                                                                 -tSurfSet[1].offset()(1),
                                                                 -tSurfSet[1].offset()(2)));
@@ -386,24 +403,46 @@ void MneDataTreeItem::initData(const MNEForwardSolution& tForwardSolution,
                 this, &MneDataTreeItem::onNewRtSmoothedDataAvailable);
     }
 
-    m_pRtSourceDataController->setInterpolationInfo(tForwardSolution.src[0].rr,
-                                                    tForwardSolution.src[1].rr,
-                                                    tForwardSolution.src[0].neighbor_vert,
-                                                    tForwardSolution.src[1].neighbor_vert,
-                                                    clustVertNoLeft,
-                                                    clustVertNoRight);
+    if(m_bUseGPU) {
+        m_pRtSourceDataController->setInterpolationInfo(tForwardSolution.src[0].rr,
+                                                        tForwardSolution.src[1].rr,
+                                                        tForwardSolution.src[0].neighbor_vert,
+                                                        tForwardSolution.src[1].neighbor_vert,
+                                                        clustVertNoLeft,
+                                                        clustVertNoRight);
+
+        m_pRtSourceDataController->setSurfaceColor(FsSurfaceTreeItem::createCurvatureVertColor(tSurfSet[0].curv()),
+                                                   FsSurfaceTreeItem::createCurvatureVertColor(tSurfSet[1].curv()));
+
+        m_pRtSourceDataController->setAnnotationInfo(vecLabelIdsLeftHemi,
+                                                     vecLabelIdsRightHemi,
+                                                     qListLabelsLeft,
+                                                     qListLabelsRight,
+                                                     clustVertNoLeft,
+                                                     clustVertNoRight);
+    } else {
+        applyLevelOfDetail();
+    }
 
-    m_pRtSourceDataController->setSurfaceColor(FsSurfaceTreeItem::createCurvatureVertColor(tSurfSet[0].curv()),
-                                               FsSurfaceTreeItem::createCurvatureVertColor(tSurfSet[1].curv()));
+    m_bIsDataInit = true;
+}
 
-    m_pRtSourceDataController->setAnnotationInfo(vecLabelIdsLeftHemi,
-                                                 vecLabelIdsRightHemi,
-                                                 qListLabelsLeft,
-                                                 qListLabelsRight,
-                                                 clustVertNoLeft,
-                                                 clustVertNoRight);
+//=============================================================================================================
 
-    m_bIsDataInit = true;
+void MneDataTreeItem::setViewportSize(const QSize& viewportSize)
+{
+    m_viewportSize = viewportSize;
+
+    if(!m_bIsDataInit || m_lHemisphereLodData.isEmpty()) {
+        return;
+    }
+
+    int iLodLevel = m_lHemisphereLodData.first().meshLod.levelForViewport(m_viewportSize);
+
+    if(iLodLevel != m_iLodLevel) {
+        m_iLodLevel = iLodLevel;
+        applyLevelOfDetail();
+    }
 }
 
 //=============================================================================================================
@@ -686,6 +725,97 @@ void MneDataTreeItem::applyTransform(const FiffCoordTrans& transform, bool bAppl
 
 //=============================================================================================================
 
+void MneDataTreeItem::applyLevelOfDetail()
+{
+    if(m_lHemisphereLodData.size() < 2 || !m_pRtSourceDataController) {
+        return;
+    }
+
+    QList<MatrixX3f> lVertices;
+    QList<QVector<QVector<int> > > lNeighborVertices;
+    QList<VectorXi> lVertNo, lLabelIds;
+    QList<QList<FSLIB::Label> > lLabels;
+    QList<MatrixX4f> lSurfaceColors;
+
+    for(int h = 0; h < m_lHemisphereLodData.size(); ++h) {
+        const HemisphereLodData& hemiData = m_lHemisphereLodData.at(h);
+        const int iLevel = qMin(m_iLodLevel, hemiData.meshLod.numLevels() - 1);
+        const MeshLodLevel& lodLevel = hemiData.meshLod.level(iLevel);
+
+        lSurfaceColors << FsSurfaceTreeItem::createCurvatureVertColor(hemiData.meshLod.sampleVertexData(iLevel, hemiData.vecCurvature));
+
+        if(iLevel == 0) {
+            lVertices << hemiData.matSourceVertices;
+            lNeighborVertices << hemiData.vecSourceNeighborVertices;
+            lVertNo << hemiData.vecVertNo;
+            lLabelIds << hemiData.vecLabelIds;
+            lLabels << hemiData.lLabels;
+        } else {
+            lVertices << hemiData.meshLod.sampleVertexData(iLevel, hemiData.matSourceVertices);
+            lNeighborVertices << lodLevel.vecNeighborVertices;
+            lVertNo << hemiData.meshLod.mapVertices(iLevel, hemiData.vecVertNo);
+            lLabelIds << hemiData.meshLod.sampleVertexData(iLevel, hemiData.vecLabelIds);
+
+            //Each vertex of the level belongs to the label of the full resolution vertex it was taken from
+            QHash<qint32, int> hashLabelIdx;
+            for(int i = 0; i < hemiData.lLabels.size(); ++i) {
+                hashLabelIdx.insert(hemiData.lLabels.at(i).label_id, i);
+            }
+
+            QVector<QVector<int> > vecLabelVertices(hemiData.lLabels.size());
+            for(int v = 0; v < lLabelIds.last().rows(); ++v) {
+                QHash<qint32, int>::const_iterator itLabel = hashLabelIdx.constFind(lLabelIds.last()(v));
+                if(itLabel != hashLabelIdx.constEnd()) {
+                    vecLabelVertices[itLabel.value()].append(v);
+                }
+            }
+
+            QList<FSLIB::Label> lLodLabels;
+            for(int i = 0; i < hemiData.lLabels.size(); ++i) {
+                const FSLIB::Label& label = hemiData.lLabels.at(i);
+                VectorXi vecVertices = Map<const VectorXi>(vecLabelVertices[i].constData(), vecLabelVertices[i].size());
+                MatrixX3f matPos(vecVertices.rows(), 3);
+                for(int v = 0; v < vecVertices.rows(); ++v) {
+                    matPos.row(v) = lodLevel.matVertices.row(vecVertices(v));
+                }
+
+                lLodLabels << FSLIB::Label(vecVertices, matPos, VectorXd::Zero(vecVertices.rows()), label.hemi, label.name, label.label_id);
+            }
+
+            lLabels << lLodLabels;
+        }
+
+        QPointer<AbstractMeshTreeItem> pInterpolationItem = h == 0 ? m_pInterpolationItemLeftCPU : m_pInterpolationItemRightCPU;
+
+        if(pInterpolationItem) {
+            pInterpolationItem->setMeshData(lodLevel.matVertices,
+                                            lodLevel.matNormals,
+                                            lodLevel.matTris,
+                                            lSurfaceColors.last(),
+                                            Qt3DRender::QGeometryRenderer::Triangles);
+        }
+    }
+
+    m_pRtSourceDataController->setInterpolationInfo(lVertices.at(0),
+                                                    lVertices.at(1),
+                                                    lNeighborVertices.at(0),
+                                                    lNeighborVertices.at(1),
+                                                    lVertNo.at(0),
+                                                    lVertNo.at(1));
+
+    m_pRtSourceDataController->setSurfaceColor(lSurfaceColors.at(0),
+                                               lSurfaceColors.at(1));
+
+    m_pRtSourceDataController->setAnnotationInfo(lLabelIds.at(0),
+                                                 lLabelIds.at(1),
+                                                 lLabels.at(0),
+                                                 lLabels.at(1),
+                                                 lVertNo.at(0),
+                                                 lVertNo.at(1));
+}
+
+//=============================================================================================================
+
 void MneDataTreeItem::onCheckStateWorkerChanged(const Qt::CheckState& checkState)
 {
     if(m_pRtSourceDataController) {
@@ -702,11 +832,14 @@ void MneDataTreeItem::onCheckStateWorkerChanged(const Qt::CheckState& checkState
 void MneDataTreeItem::onNewRtSmoothedDataAvailable(const Eigen::MatrixX4f &matColorMatrixLeftHemi,
                                                    const Eigen::MatrixX4f &matColorMatrixRightHemi)
 {
-    if(m_pInterpolationItemLeftCPU) {
+    //Colors which were computed for the previous level of detail are dropped
+    if(m_pInterpolationItemLeftCPU
+       && m_pInterpolationItemLeftCPU->data(Data3DTreeModelItemRoles::NumberVertices).toInt() == matColorMatrixLeftHemi.rows()) {
         m_pInterpolationItemLeftCPU->setVertColor(matColorMatrixLeftHemi);
     }
 
-    if(m_pInterpolationItemRightCPU) {
+    if(m_pInterpolationItemRightCPU
+       && m_pInterpolationItemRightCPU->data(Data3DTreeModelItemRoles::NumberVertices).toInt() == matColorMatrixRightHemi.rows()) {
         m_pInterpolationItemRightCPU->setVertColor(matColorMatrixRightHemi);
     }
 }
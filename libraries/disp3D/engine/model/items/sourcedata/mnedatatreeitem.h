@@ -42,14 +42,17 @@
 
 #include "../../../../disp3D_global.h"
 #include "../common/abstracttreeitem.h"
+#include "../../../../helpers/meshlod/meshlod.h"
 
 #include <fiff/fiff_types.h>
+#include <fs/label.h>
 
 //=============================================================================================================
 // QT INCLUDES
 //=============================================================================================================
 
 #include <QPointer>
+#include <QSize>
 #include <Qt3DCore/QTransform>
 
 //=============================================================================================================
@@ -136,6 +139,16 @@ public:
                   const FSLIB::AnnotationSet& tAnnotSet,
                   Qt3DCore::QEntity* p3DEntityParent);
 
+    //=========================================================================================================
+    /**
+     * Sets the size of the viewport the data is rendered to. When the data is visualized with the CPU, the
+     * level of detail of the surfaces, and thereby the size of the interpolation matrices, is selected based on
+     * this size. Call this before initData(...) to avoid computing the full resolution interpolation first.
+     *
+     * @param[in] viewportSize       The size of the viewport in pixels.
+     */
+    void setViewportSize(const QSize& viewportSize);
+
     //=========================================================================================================
     /**
      * Adds actual rt data which is streamed by this item's worker thread item. In order for this function to worker, you must call init(...) beforehand.
@@ -282,6 +295,13 @@ protected:
      */
     void initItem();
 
+    //=========================================================================================================
+    /**
+     * Passes the surfaces, interpolation and annotation info of the current level of detail on to the CPU
+     * interpolation items and the rt data controller.
+     */
+    void applyLevelOfDetail();
+
     //=========================================================================================================
     /**
      * This function gets called whenever the check/actiation state of the rt data worker changed.
@@ -390,9 +410,27 @@ protected:
      */
     virtual void onInterpolationFunctionChanged(const QVariant& sInterpolationFunction);
 
+    //=============================================================================================================
+    /**
+     * The struct specifing the full resolution data of one hemisphere which is mapped to the levels of detail.
+     */
+    struct HemisphereLodData {
+        MeshLod                         meshLod;                        /**< The levels of detail of the surface. */
+        Eigen::MatrixX3f                matSourceVertices;              /**< The vertices of the source space. */
+        QVector<QVector<int> >          vecSourceNeighborVertices;      /**< The neighbor vertex information of the source space. */
+        Eigen::VectorXf                 vecCurvature;                   /**< The curvature values of the surface. */
+        Eigen::VectorXi                 vecVertNo;                      /**< The vertices the sources are located at. */
+        Eigen::VectorXi                 vecLabelIds;                    /**< The label id of each vertex. */
+        QList<FSLIB::Label>             lLabels;                        /**< The labels of the annotation. */
+    };
+
     bool                                m_bIsDataInit;                      /**< The init flag. */
     bool                                m_bUseGPU;                          /**< The use GPU flag. */
 
+    int                                 m_iLodLevel;                        /**< The level of detail the CPU interpolation currently operates on. */
+    QSize                               m_viewportSize;                     /**< The size of the viewport the data is rendered to. */
+    QList<HemisphereLodData>            m_lHemisphereLodData;               /**< The level of detail data for the left and right hemisphere. */
+
     QPointer<RtSourceDataController>    m_pRtSourceDataController;          /**< The source data worker. This worker streams the rt data to this item.*/
 
     QPointer<AbstractMeshTreeItem>      m_pInterpolationItemLeftCPU;        /**< This item manages all 3d rendering and calculations for the left hemisphere. */
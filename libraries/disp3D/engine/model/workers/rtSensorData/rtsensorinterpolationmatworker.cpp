@@ -66,7 +66,8 @@ RtSensorInterpolationMatWorker::RtSensorInterpolationMatWorker()
 {
     m_lInterpolationData.dCancelDistance = 0.05;
     m_lInterpolationData.interpolationFunction = DISP3DLIB::Interpolation::cubic;
-    m_lInterpolationData.matDistanceMatrix = QSharedPointer<MatrixXd>(new MatrixXd());
+    m_lInterpolationData.matDistanceMatrix = QSharedPointer<SparseMatrix<double> >(new SparseMatrix<double>());
+    m_lInterpolationData.matWeights = QSharedPointer<SparseMatrix<float, RowMajor> >(new SparseMatrix<float, RowMajor>());
 }
 
 //=============================================================================================================
@@ -88,6 +89,10 @@ void RtSensorInterpolationMatWorker::setInterpolationFunction(const QString &sIn
 
     if(m_bInterpolationInfoIsInit == true){
         //recalculate Interpolation matrix parameters changed
+        m_lInterpolationData.matWeights = Interpolation::createWeightMat(m_lInterpolationData.matDistanceMatrix,
+                                                                         m_lInterpolationData.interpolationFunction,
+                                                                         m_lInterpolationData.dCancelDistance);
+
         emitMatrix();
     }
 }
@@ -154,12 +159,7 @@ void RtSensorInterpolationMatWorker::setBadChannels(const FiffInfo& info)
 
     m_lInterpolationData.fiffInfo = info;
 
-    //filtering of bad channels out of the distance table
-    GeometryInfo::filterBadChannels(m_lInterpolationData.matDistanceMatrix,
-                                    m_lInterpolationData.fiffInfo,
-                                    m_lInterpolationData.iSensorType);    
-
-    //set vecExcludeIndex
+    //set vecExcludeIndex, the distance table and the weights are kept for all channels
     m_lInterpolationData.vecExcludeIndex.clear();
     int iCounter = 0;
     for(const FiffChInfo &info : m_lInterpolationData.fiffInfo.chs) {
@@ -185,15 +185,15 @@ void RtSensorInterpolationMatWorker::calculateInterpolationOperator()
     }
 
     //SCDC with cancel distance
-    m_lInterpolationData.matDistanceMatrix = GeometryInfo::scdc(m_lInterpolationData.matVertices,
-                                                                m_lInterpolationData.vecNeighborVertices,
-                                                                m_lInterpolationData.vecMappedSubset,
-                                                                m_lInterpolationData.dCancelDistance);
+    m_lInterpolationData.matDistanceMatrix = GeometryInfo::scdcSparse(m_lInterpolationData.matVertices,
+                                                                      m_lInterpolationData.vecNeighborVertices,
+                                                                      m_lInterpolationData.vecMappedSubset,
+                                                                      m_lInterpolationData.dCancelDistance);
 
-    //filtering of bad channels out of the distance table
-    GeometryInfo::filterBadChannels(m_lInterpolationData.matDistanceMatrix,
-                                    m_lInterpolationData.fiffInfo,
-                                    m_lInterpolationData.iSensorType);
+    //unnormalized weights of all channels, the bad channels are excluded during the normalization
+    m_lInterpolationData.matWeights = Interpolation::createWeightMat(m_lInterpolationData.matDistanceMatrix,
+                                                                     m_lInterpolationData.interpolationFunction,
+                                                                     m_lInterpolationData.dCancelDistance);
 
     emitMatrix();
 }
@@ -202,10 +202,8 @@ void RtSensorInterpolationMatWorker::calculateInterpolationOperator()
 
 void RtSensorInterpolationMatWorker::emitMatrix()
 {
-    //create Interpolation matrix
-    emit newInterpolationMatrixCalculated(Interpolation::createInterpolationMat(m_lInterpolationData.vecMappedSubset,
-                                                                                m_lInterpolationData.matDistanceMatrix,
-                                                                                m_lInterpolationData.interpolationFunction,
-                                                                                m_lInterpolationData.dCancelDistance,
-                                                                                m_lInterpolationData.vecExcludeIndex));
+    //create Interpolation matrix by normalizing the weights over the good channels
+    emit newInterpolationMatrixCalculated(Interpolation::normalizeWeightMat(m_lInterpolationData.vecMappedSubset,
+                                                                            m_lInterpolationData.matWeights,
+                                                                            m_lInterpolationData.vecExcludeIndex));
 }
@@ -127,7 +127,8 @@ public:
 
     //=========================================================================================================
     /**
-     * Sets bad channels and recalculate interpolation matrix.
+     * Sets bad channels and recalculate interpolation matrix. Only the stored weights are re-normalized over the good channels,
+     * the distances are not recalculated.
      *
      * @param[in] info                 The fiff info including the new bad channels.
      */
@@ -154,7 +155,8 @@ protected:
         int                                             iSensorType;                    /**< Type of the sensor: FIFFV_EEG_CH or FIFFV_MEG_CH. */
         double                                          dCancelDistance;                /**< Cancel distance for the interpolaion in meters. */
 
-        QSharedPointer<Eigen::MatrixXd>                 matDistanceMatrix;              /**< Distance matrix that holds distances from sensors positions to the near vertices in meters. */
+        QSharedPointer<Eigen::SparseMatrix<double> >    matDistanceMatrix;              /**< Sparse distance matrix that holds distances from sensors positions to the near vertices in meters. */
+        QSharedPointer<Eigen::SparseMatrix<float, Eigen::RowMajor> > matWeights;      /**< Unnormalized interpolation weights of all sensors. Only re-normalized when the bad channels change. */
         Eigen::MatrixX3f                                matVertices;                    /**< Holds all vertex information. */
 
         QVector<int>                                 vecMappedSubset;                /**< Vector index position represents the id of the sensor and the qint in each cell is the vertex it is mapped to. */
@@ -39,7 +39,6 @@
 //=============================================================================================================
 
 #include "rtsourcedataworker.h"
-#include "../../../../helpers/interpolation/interpolation.h"
 #include "../../items/common/abstractmeshtreeitem.h"
 
 //=============================================================================================================
@@ -66,6 +65,13 @@ using namespace Eigen;
 using namespace DISPLIB;
 using namespace FIFFLIB;
 
+//=============================================================================================================
+// DEFINES
+//=============================================================================================================
+
+#define COLORMAP_LUT_SIZE 1024
+#define VERTEX_CHUNK_SIZE 4096
+
 //=============================================================================================================
 // DEFINE MEMBER METHODS
 //=============================================================================================================
@@ -212,11 +218,13 @@ void RtSourceDataWorker::streamData()
                 }
             } else {
                 if(m_vecAverage.rows() != m_lDataQ.front().rows()) {
-                    m_vecAverage = m_lDataQ.takeFirst();
+                    m_vecAverage = m_lDataQ.front();
+                    m_lDataQ.removeFirst();
                     m_iCurrentSample++;
                     iSampleCtr++;
                 } else {
-                    m_vecAverage += m_lDataQ.takeFirst();
+                    m_vecAverage += m_lDataQ.front();
+                    m_lDataQ.removeFirst();
                     m_iCurrentSample++;
                     iSampleCtr++;
                 }
@@ -238,10 +246,33 @@ void RtSourceDataWorker::streamData()
                 m_lHemiVisualizationInfo[0].vecSensorValues = m_vecAverage.segment(0, m_lHemiVisualizationInfo[0].pMatInterpolationMatrix->cols());
                 m_lHemiVisualizationInfo[1].vecSensorValues = m_vecAverage.segment(m_lHemiVisualizationInfo[0].pMatInterpolationMatrix->cols(), m_lHemiVisualizationInfo[1].pMatInterpolationMatrix->cols());
 
-                //Do calculations for both hemispheres in parallel
-                QFuture<void> result = QtConcurrent::map(m_lHemiVisualizationInfo,
-                                                         generateColorsFromSensorValues);
-                result.waitForFinished();
+                //Split the vertices of both hemispheres into chunks and color them in parallel
+                m_lVertexColorChunks.resize(0);
+                QVector<int> lPreparedHemis;
+
+                for(int h = 0; h < m_lHemiVisualizationInfo.size(); ++h) {
+                    if(prepareColorGeneration(m_lHemiVisualizationInfo[h])) {
+                        const int iNumVertices = m_lHemiVisualizationInfo[h].matBackVertColor.rows();
+
+                        for(int v = 0; v < iNumVertices; v += VERTEX_CHUNK_SIZE) {
+                            VertexColorChunk chunk;
+                            chunk.pVisualizationInfo = &m_lHemiVisualizationInfo[h];
+                            chunk.iFirstVertex = v;
+                            chunk.iNumVertices = qMin(VERTEX_CHUNK_SIZE, iNumVertices - v);
+                            m_lVertexColorChunks.append(chunk);
+                        }
+
+                        lPreparedHemis.append(h);
+                    }
+                }
+
+                QtConcurrent::blockingMap(m_lVertexColorChunks,
+                                          generateColorsFromSensorValues);
+
+                //Swap front and back buffers, so the color matrices are not reallocated each frame
+                for(int h : lPreparedHemis) {
+                    m_lHemiVisualizationInfo[h].matFinalVertColor.swap(m_lHemiVisualizationInfo[h].matBackVertColor);
+                }
 
                 emit newRtSmoothedData(m_lHemiVisualizationInfo[0].matFinalVertColor,
                                        m_lHemiVisualizationInfo[1].matFinalVertColor);
@@ -263,84 +294,104 @@ void RtSourceDataWorker::streamData()
 
 //=============================================================================================================
 
-void RtSourceDataWorker::generateColorsFromSensorValues(VisualizationInfo &visualizationInfoHemi)
+bool RtSourceDataWorker::prepareColorGeneration(VisualizationInfo &visualizationInfoHemi)
 {
     if(visualizationInfoHemi.vecSensorValues.rows() != visualizationInfoHemi.pMatInterpolationMatrix->cols()) {
-        qDebug() << "RtSourceDataWorker::generateColorsFromSensorValues - Number of new vertex colors (" << visualizationInfoHemi.vecSensorValues.rows() << ") do not match with previously set number of sensors (" << visualizationInfoHemi.pMatInterpolationMatrix->cols() << "). Returning...";
-        return;
+        qDebug() << "RtSourceDataWorker::prepareColorGeneration - Number of new vertex colors (" << visualizationInfoHemi.vecSensorValues.rows() << ") do not match with previously set number of sensors (" << visualizationInfoHemi.pMatInterpolationMatrix->cols() << "). Returning...";
+        return false;
     }
 
-    // interpolate sensor signals
-    VectorXf vecIntrpltdVals = Interpolation::interpolateSignal(*visualizationInfoHemi.pMatInterpolationMatrix, visualizationInfoHemi.vecSensorValues.cast<float>());
+    if(visualizationInfoHemi.matOriginalVertColor.rows() != visualizationInfoHemi.pMatInterpolationMatrix->rows()) {
+        qDebug() << "RtSourceDataWorker::prepareColorGeneration - Sizes of input data (" << visualizationInfoHemi.pMatInterpolationMatrix->rows() <<") do not match output data ("<< visualizationInfoHemi.matOriginalVertColor.rows() <<"). Returning ...";
+        visualizationInfoHemi.matFinalVertColor = visualizationInfoHemi.matOriginalVertColor;
+        return false;
+    }
 
-    // Reset to original color as default
-    visualizationInfoHemi.matFinalVertColor = visualizationInfoHemi.matOriginalVertColor;
+    // Rows of a row major matrix can be multiplied independently of each other
+    if(visualizationInfoHemi.pMatRowMajorSource != visualizationInfoHemi.pMatInterpolationMatrix) {
+        visualizationInfoHemi.matInterpolationMatrixRowMajor = *visualizationInfoHemi.pMatInterpolationMatrix;
+        visualizationInfoHemi.pMatRowMajorSource = visualizationInfoHemi.pMatInterpolationMatrix;
+    }
 
-    //Generate color data for vertices
-    normalizeAndTransformToColor(vecIntrpltdVals,
-                                 visualizationInfoHemi.matFinalVertColor,
-                                 visualizationInfoHemi.dThresholdX,
-                                 visualizationInfoHemi.dThresholdZ,
-                                 visualizationInfoHemi.functionHandlerColorMap,
-                                 visualizationInfoHemi.sColormapType);
+    // Sample the colormap once instead of calling it for every vertex of every frame
+    if(visualizationInfoHemi.matColorLut.rows() != COLORMAP_LUT_SIZE
+       || visualizationInfoHemi.sColorLutType != visualizationInfoHemi.sColormapType) {
+        visualizationInfoHemi.matColorLut.resize(COLORMAP_LUT_SIZE, 4);
+
+        for(int i = 0; i < COLORMAP_LUT_SIZE; ++i) {
+            QRgb qRgb = visualizationInfoHemi.functionHandlerColorMap((double)i / (COLORMAP_LUT_SIZE - 1),
+                                                                      visualizationInfoHemi.sColormapType);
+            visualizationInfoHemi.matColorLut(i,0) = qRed(qRgb) / 255.0f;
+            visualizationInfoHemi.matColorLut(i,1) = qGreen(qRgb) / 255.0f;
+            visualizationInfoHemi.matColorLut(i,2) = qBlue(qRgb) / 255.0f;
+            visualizationInfoHemi.matColorLut(i,3) = qAlpha(qRgb) / 255.0f;
+        }
+
+        visualizationInfoHemi.sColorLutType = visualizationInfoHemi.sColormapType;
+    }
+
+    // Resizing is a no-op as long as the number of vertices does not change
+    visualizationInfoHemi.vecSensorValuesFloat = visualizationInfoHemi.vecSensorValues.cast<float>();
+    visualizationInfoHemi.vecIntrpltdVals.resize(visualizationInfoHemi.matInterpolationMatrixRowMajor.rows());
+    visualizationInfoHemi.matBackVertColor.resize(visualizationInfoHemi.matInterpolationMatrixRowMajor.rows(), 4);
+
+    return true;
 }
 
 //=============================================================================================================
 
-void RtSourceDataWorker::normalizeAndTransformToColor(const VectorXf& vecData,
-                                                      MatrixX4f& matFinalVertColor,
-                                                      double dThresholdX,
-                                                      double dThresholdZ,
-                                                      QRgb (*functionHandlerColorMap)(double v, const QString& sColorMap),
-                                                      const QString& sColorMap)
+void RtSourceDataWorker::generateColorsFromSensorValues(const VertexColorChunk &vertexColorChunk)
 {
     //Note: This function needs to be implemented extremly efficient.
-    if(vecData.rows() != matFinalVertColor.rows()) {
-        qDebug() << "RtSourceDataWorker::normalizeAndTransformToColor - Sizes of input data (" << vecData.rows() <<") do not match output data ("<< matFinalVertColor.rows() <<"). Returning ...";
-        return;
-    }
-
-    float fSample;
-    QRgb qRgb;
-    const double dTresholdDiff = dThresholdZ - dThresholdX;
-
-    for(int r = 0; r < vecData.rows(); ++r) {
-        //Take the absolute values because the histogram threshold is also calcualted using the absolute values
-        fSample = std::fabs(vecData(r));
+    VisualizationInfo& visualizationInfoHemi = *vertexColorChunk.pVisualizationInfo;
+    const SparseMatrix<float, RowMajor>& matInterpolation = visualizationInfoHemi.matInterpolationMatrixRowMajor;
+    const VectorXf& vecSensorValues = visualizationInfoHemi.vecSensorValuesFloat;
+    const int iFirst = vertexColorChunk.iFirstVertex;
+    const int iLast = vertexColorChunk.iFirstVertex + vertexColorChunk.iNumVertices;
 
-        if(fSample >= dThresholdX) {
-            //Check lower and upper thresholds and normalize to one
-            if(fSample >= dThresholdZ) {
-                fSample = 1.0f;
-            } else {
-                if(fSample != 0.0f && dTresholdDiff != 0.0 ) {
-                    fSample = (fSample - dThresholdX) / (dTresholdDiff);
-                } else {
-                    fSample = 0.0f;
-                }
-            }
+    // interpolate sensor signals
+    for(int r = iFirst; r < iLast; ++r) {
+        float fValue = 0.0f;
 
-            qRgb = functionHandlerColorMap(fSample, sColorMap);
+        for(SparseMatrix<float, RowMajor>::InnerIterator it(matInterpolation, r); it; ++it) {
+            fValue += it.value() * vecSensorValues(it.index());
+        }
 
-            QColor color(qRgb);
-//            QColor color (matFinalVertColor(r,0) * 255 * (1.0-0.60) + (float)qRed(qRgb)*0.60,
-//                          matFinalVertColor(r,1) * 255 * (1.0-0.60) + (float)qGreen(qRgb)*0.60,
-//                          matFinalVertColor(r,2) * 255 * (1.0-0.60) + (float)qBlue(qRgb)*0.60,
-//                          255.0 + 0.75 * (255.0-255.0));
+        visualizationInfoHemi.vecIntrpltdVals(r) = fValue;
+    }
 
-            //qDebug() << "RtSourceDataWorker::normalizeAndTransformToColor color" << color;
+    // Normalize to [0,1], vertices below the lower threshold are marked with -1. Take the absolute values because
+    // the histogram threshold is also calcualted using the absolute values.
+    const float fThresholdX = visualizationInfoHemi.dThresholdX;
+    const float fThresholdZ = visualizationInfoHemi.dThresholdZ;
+    const float fScale = (fThresholdZ != fThresholdX) ? 1.0f / (fThresholdZ - fThresholdX) : 0.0f;
 
-            matFinalVertColor(r,0) = color.redF();
-            matFinalVertColor(r,1) = color.greenF();
-            matFinalVertColor(r,2) = color.blueF();
-            matFinalVertColor(r,3) = color.alphaF();
+    VectorXf::SegmentReturnType vecSamples = visualizationInfoHemi.vecIntrpltdVals.segment(iFirst, vertexColorChunk.iNumVertices);
+    vecSamples = vecSamples.array().abs();
+    vecSamples = (vecSamples.array() < fThresholdX).select(-1.0f,
+                                                            (vecSamples.array() >= fThresholdZ).select(1.0f,
+                                                                                                       (vecSamples.array() - fThresholdX) * fScale));
 
-//            matFinalVertColor(r,0) = (float)qRed(qRgb)/255.0f;
-//            matFinalVertColor(r,1) = (float)qGreen(qRgb)/255.0f;
-//            matFinalVertColor(r,2) = (float)qBlue(qRgb)/255.0f;
-//            matFinalVertColor(r,3) = 1.0f;
+    //Generate color data for vertices
+    const MatrixX4f& matLut = visualizationInfoHemi.matColorLut;
+    MatrixX4f& matColor = visualizationInfoHemi.matBackVertColor;
+    const float fLutMax = matLut.rows() - 1;
+
+    for(int r = iFirst; r < iLast; ++r) {
+        const float fSample = visualizationInfoHemi.vecIntrpltdVals(r);
+
+        if(fSample >= 0.0f) {
+            const int iLut = (int)(fSample * fLutMax + 0.5f);
+            matColor(r,0) = matLut(iLut,0);
+            matColor(r,1) = matLut(iLut,1);
+            matColor(r,2) = matLut(iLut,2);
+            matColor(r,3) = matLut(iLut,3);
         } else {
-            matFinalVertColor(r,3) = 0.0f; //Use this if you want only vertices with activation to be plotted
+            // Keep the original color, but only plot vertices with activation
+            matColor(r,0) = visualizationInfoHemi.matOriginalVertColor(r,0);
+            matColor(r,1) = visualizationInfoHemi.matOriginalVertColor(r,1);
+            matColor(r,2) = visualizationInfoHemi.matOriginalVertColor(r,2);
+            matColor(r,3) = 0.0f;
         }
     }
 }
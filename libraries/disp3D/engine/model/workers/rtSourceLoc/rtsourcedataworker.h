@@ -50,6 +50,7 @@
 #include <QRgb>
 #include <QSharedPointer>
 #include <QLinkedList>
+#include <QVector>
 
 //=============================================================================================================
 // EIGEN INCLUDES
@@ -76,12 +77,27 @@ struct VisualizationInfo {
     Eigen::MatrixX4f            matOriginalVertColor;
     Eigen::MatrixX4f            matFinalVertColor;
 
+    Eigen::MatrixX4f            matBackVertColor;                                   /**< The back buffer the colors of the next frame are written to. Swapped with matFinalVertColor after each frame. */
+
     QSharedPointer<Eigen::SparseMatrix<float> >  pMatInterpolationMatrix;         /**< The interpolation matrix. */
 
     QString sColormapType;
     QRgb (*functionHandlerColorMap)(double v, const QString& sColorMap) = DISPLIB::ColorMap::valueToColor;
+
+    QSharedPointer<Eigen::SparseMatrix<float> >             pMatRowMajorSource;     /**< The interpolation matrix matInterpolationMatrixRowMajor was copied from. */
+    Eigen::SparseMatrix<float, Eigen::RowMajor>             matInterpolationMatrixRowMajor; /**< Row major copy of the interpolation matrix. Lets vertex chunks be interpolated independently. */
+    Eigen::VectorXf                                         vecSensorValuesFloat;   /**< The sensor values of the current frame in single precision. */
+    Eigen::VectorXf                                         vecIntrpltdVals;        /**< The interpolated, later normalized, values of the current frame. */
+    Eigen::MatrixX4f                                        matColorLut;            /**< The colormap sampled at COLORMAP_LUT_SIZE equidistant values in [0,1]. */
+    QString                                                 sColorLutType;          /**< The colormap type matColorLut was generated for. */
 }; /**< The struct specifing visualization info. */
 
+struct VertexColorChunk {
+    VisualizationInfo*          pVisualizationInfo;
+    int                         iFirstVertex;
+    int                         iNumVertices;
+}; /**< The struct specifing a range of vertices which is colored by one thread. */
+
 struct ColorComputationInfo {
     double                      dThresholdX;
     double                      dThresholdZ;
@@ -213,29 +229,21 @@ public:
 protected:
     //=========================================================================================================
     /**
-     * @brief normalizeAndTransformToColor  This method normalizes final values for all vertices of the mesh and converts them to rgb using the specified color converter
+     * @brief prepareColorGeneration     Checks the dimensions of the current frame, refreshes the row major interpolation matrix and the colormap lookup table if needed and sizes the output buffers
      *
-     * @param[in] vecData                       The final values for each vertex of the surface
-     * @param[in,out] matFinalVertColor         The color matrix which the results are to be written to
-     * @param[in] dThresholdX                   Lower threshold for normalizing
-     * @param[in] dThresholdZ                   Upper threshold for normalizing
-     * @param[in] functionHandlerColorMap       The pointer to the function which converts scalar values to rgb
-     * @param[in] sColorMap                     The color map to use
+     * @param[in/out] visualizationInfoHemi      The needed visualization info
+     *
+     * @return Whether the vertex colors of this hemisphere can be generated.
      */
-    static void normalizeAndTransformToColor(const Eigen::VectorXf& vecData,
-                                             Eigen::MatrixX4f &matFinalVertColor,
-                                             double dThresholdX,
-                                             double dThresholdZ,
-                                             QRgb (*functionHandlerColorMap)(double v, const QString& sColorMap),
-                                             const QString& sColorMap);
+    static bool prepareColorGeneration(VisualizationInfo &visualizationInfoHemi);
 
     //=========================================================================================================
     /**
-     * @brief generateColorsFromSensorValues     Produces the final color matrix that is to be emitted
+     * @brief generateColorsFromSensorValues     Interpolates, normalizes and colors one chunk of vertices into the back buffer
      *
-     * @param[in/out] visualizationInfoHemi      The needed visualization info
+     * @param[in] vertexColorChunk               The chunk of vertices to process
      */
-    static void generateColorsFromSensorValues(VisualizationInfo &visualizationInfoHemi);
+    static void generateColorsFromSensorValues(const VertexColorChunk &vertexColorChunk);
 
     QList<Eigen::VectorXd>                              m_lDataQ;                           /**< List that holds the matrix data <n_channels x n_samples>. */
     QList<Eigen::VectorXd>                              m_lDataLoopQ;                       /**< List that holds the matrix data <n_channels x n_samples> for looping. */
@@ -251,6 +259,7 @@ protected:
     double                                              m_dSFreq;                           /**< The current sampling frequency. */
 
     QList<VisualizationInfo>                            m_lHemiVisualizationInfo;           /**< The visualization info for each hemisphere. */
+    QVector<VertexColorChunk>                           m_lVertexColorChunks;               /**< The vertex chunks of both hemispheres which are colored in parallel. */
 
 signals:
     //=========================================================================================================
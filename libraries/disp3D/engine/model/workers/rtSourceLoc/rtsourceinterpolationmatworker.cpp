@@ -73,7 +73,7 @@ RtSourceInterpolationMatWorker::RtSourceInterpolationMatWorker()
 {
     m_lInterpolationData.dCancelDistance = 0.05;
     m_lInterpolationData.interpolationFunction = DISP3DLIB::Interpolation::cubic;
-    m_lInterpolationData.matDistanceMatrix = QSharedPointer<MatrixXd>(new MatrixXd());
+    m_lInterpolationData.matDistanceMatrix = QSharedPointer<SparseMatrix<double> >(new SparseMatrix<double>());
 }
 
 //=============================================================================================================
@@ -175,6 +175,7 @@ void RtSourceInterpolationMatWorker::setAnnotationInfo(const Eigen::VectorXi &ve
 
     m_lInterpolationData.lLabels = lLabels;
     m_lInterpolationData.mapLabelIdSources.clear();
+    m_lInterpolationData.vertNos.clear();
 
     //Generate fast lookup map for each source and corresponding label
     for(qint32 i = 0; i < vecVertNo.rows(); ++i) {
@@ -201,10 +202,10 @@ void RtSourceInterpolationMatWorker::calculateInterpolationOperator()
     }
 
     //SCDC with cancel distance
-    m_lInterpolationData.matDistanceMatrix = GeometryInfo::scdc(m_lInterpolationData.matVertices,
-                                                                m_lInterpolationData.vecNeighborVertices,
-                                                                m_lInterpolationData.vecMappedSubset,
-                                                                m_lInterpolationData.dCancelDistance);
+    m_lInterpolationData.matDistanceMatrix = GeometryInfo::scdcSparse(m_lInterpolationData.matVertices,
+                                                                      m_lInterpolationData.vecNeighborVertices,
+                                                                      m_lInterpolationData.vecMappedSubset,
+                                                                      m_lInterpolationData.dCancelDistance);
 
     //create Interpolation matrix
     m_pMatInterpolationMat = Interpolation::createInterpolationMat(m_lInterpolationData.vecMappedSubset,
@@ -52,6 +52,7 @@
 
 #include <QPropertyAnimation>
 #include <QKeyEvent>
+#include <QResizeEvent>
 #include <QDate>
 #include <QTime>
 #include <QDir>
@@ -205,7 +206,9 @@ void View3D::initLight()
 
 void View3D::setModel(QSharedPointer<Data3DTreeModel> pModel)
 {
+    m_pModel = pModel.data();
     pModel->getRootEntity()->setParent(m_p3DObjectsEntity);
+    pModel->setViewportSize(this->size() * this->devicePixelRatio());
 }
 
 //=============================================================================================================
@@ -307,6 +310,17 @@ void View3D::keyPressEvent(QKeyEvent* e)
 
 //=============================================================================================================
 
+void View3D::resizeEvent(QResizeEvent* e)
+{
+    Qt3DWindow::resizeEvent(e);
+
+    if(m_pModel) {
+        m_pModel->setViewportSize(e->size() * this->devicePixelRatio());
+    }
+}
+
+//=============================================================================================================
+
 void View3D::createCoordSystem(Qt3DCore::QEntity* parent)
 {
     m_pCoordSysEntity = QSharedPointer<Qt3DCore::QEntity>::create(parent);
@@ -207,6 +207,12 @@ protected:
      */
     void keyPressEvent(QKeyEvent* e) override;
 
+    //=========================================================================================================
+    /**
+     * Window function. Passes the new viewport size on to the model, so that it can select the levels of detail.
+     */
+    void resizeEvent(QResizeEvent* e) override;
+
     //=========================================================================================================
     /**
      * Creates a coordiante system (x/Green, y/Red, z/Blue).
@@ -236,6 +242,7 @@ protected:
     QPointer<Qt3DCore::QEntity>                 m_pLightEntity;                 /**< The root/most top level entity buffer. */
     QSharedPointer<Qt3DCore::QEntity>           m_pCoordSysEntity;              /**< The entity representing the x/y/z coord system. */
 
+    QPointer<Data3DTreeModel>                   m_pModel;                       /**< The tree model which holds the 3d models. */
     QPointer<CustomFrameGraph>                  m_pFrameGraph;                  /**< The frameGraph entity. */
     QPointer<Qt3DRender::QCamera>               m_pCamera;                      /**< The camera entity. */
     QPointer<Qt3DRender::QRenderCaptureReply>   m_pScreenCaptureReply;          /**< The capture reply object to save screenshots. */
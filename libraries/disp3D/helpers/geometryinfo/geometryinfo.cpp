@@ -45,9 +45,10 @@
 // INCLUDES
 //=============================================================================================================
 
+#include <algorithm>
 #include <cmath>
 #include <fstream>
-#include <set>
+#include <functional>
 
 //=============================================================================================================
 // QT INCLUDES
@@ -95,6 +96,11 @@ QSharedPointer<MatrixXd> GeometryInfo::scdc(const MatrixX3f &matVertices,
     // convention: first dimension in distance table is "from", second dimension "to"
     QSharedPointer<MatrixXd> returnMat = QSharedPointer<MatrixXd>::create(matVertices.rows(), iCols);
 
+    // flat neighbor information shared by all threads
+    VectorXi vecNeighborOffsets, vecNeighbors;
+    VectorXd vecEdgeLengths;
+    buildAdjacency(matVertices, vecNeighborVertices, vecNeighborOffsets, vecNeighbors, vecEdgeLengths);
+
     // distribute calculation on cores
     int iCores = QThread::idealThreadCount();
     if (iCores <= 0) {
@@ -114,8 +120,9 @@ QSharedPointer<MatrixXd> GeometryInfo::scdc(const MatrixX3f &matVertices,
         {
             vecThreads[i] = QtConcurrent::run(std::bind(iterativeDijkstra,
                                                         returnMat,
-                                                        std::cref(matVertices),
-                                                        std::cref(vecNeighborVertices),
+                                                        std::cref(vecNeighborOffsets),
+                                                        std::cref(vecNeighbors),
+                                                        std::cref(vecEdgeLengths),
                                                         std::cref(vecVertSubset),
                                                         iBegin,
                                                         vecVertSubset.size(),
@@ -126,8 +133,9 @@ QSharedPointer<MatrixXd> GeometryInfo::scdc(const MatrixX3f &matVertices,
         {
             vecThreads[i] = QtConcurrent::run(std::bind(iterativeDijkstra,
                                                         returnMat,
-                                                        std::cref(matVertices),
-                                                        std::cref(vecNeighborVertices),
+                                                        std::cref(vecNeighborOffsets),
+                                                        std::cref(vecNeighbors),
+                                                        std::cref(vecEdgeLengths),
                                                         std::cref(vecVertSubset),
                                                         iBegin,
                                                         iEnd,
@@ -147,6 +155,83 @@ QSharedPointer<MatrixXd> GeometryInfo::scdc(const MatrixX3f &matVertices,
 
 //=============================================================================================================
 
+QSharedPointer<SparseMatrix<double> > GeometryInfo::scdcSparse(const MatrixX3f &matVertices,
+                                                               const QVector<QVector<int> > &vecNeighborVertices,
+                                                               QVector<int> &vecVertSubset,
+                                                               double dCancelDist)
+{
+    if(vecVertSubset.empty()) {
+        // caller passed an empty subset, need to fill in all vertex IDs
+        vecVertSubset.reserve(matVertices.rows());
+        for(qint32 id = 0; id < matVertices.rows(); ++id) {
+            vecVertSubset.push_back(id);
+        }
+    }
+
+    // flat neighbor information shared by all threads
+    VectorXi vecNeighborOffsets, vecNeighbors;
+    VectorXd vecEdgeLengths;
+    buildAdjacency(matVertices, vecNeighborVertices, vecNeighborOffsets, vecNeighbors, vecEdgeLengths);
+
+    // distribute calculation on cores
+    int iCores = QThread::idealThreadCount();
+    if (iCores <= 0) {
+        // assume that we have at least two available cores
+        iCores = 2;
+    }
+
+    // every thread collects the entries of its part of the subset
+    qint32 iSubArraySize = int(double(vecVertSubset.size()) / double(iCores));
+    QVector<QFuture<void> > vecThreads(iCores);
+    std::vector<std::vector<Triplet<double> > > vecTriplets(iCores);
+    qint32 iBegin = 0;
+    qint32 iEnd = iSubArraySize;
+
+    for (int i = 0; i < vecThreads.size(); ++i) {
+        //last round
+        if(i == vecThreads.size()-1) {
+            iEnd = vecVertSubset.size();
+        }
+
+        vecThreads[i] = QtConcurrent::run(std::bind(iterativeDijkstraSparse,
+                                                    std::ref(vecTriplets[i]),
+                                                    std::cref(vecNeighborOffsets),
+                                                    std::cref(vecNeighbors),
+                                                    std::cref(vecEdgeLengths),
+                                                    std::cref(vecVertSubset),
+                                                    iBegin,
+                                                    iEnd,
+                                                    dCancelDist));
+        iBegin += iSubArraySize;
+        iEnd += iSubArraySize;
+    }
+
+    // wait for all other threads to finish
+    for (QFuture<void>& f : vecThreads) {
+        f.waitForFinished();
+    }
+
+    // convention: first dimension in distance table is "from", second dimension "to"
+    QSharedPointer<SparseMatrix<double> > returnMat = QSharedPointer<SparseMatrix<double> >::create(matVertices.rows(), vecVertSubset.size());
+
+    std::vector<Triplet<double> > vecAllTriplets;
+    size_t iNumEntries = 0;
+    for(const std::vector<Triplet<double> >& vecPart : vecTriplets) {
+        iNumEntries += vecPart.size();
+    }
+    vecAllTriplets.reserve(iNumEntries);
+    for(std::vector<Triplet<double> >& vecPart : vecTriplets) {
+        vecAllTriplets.insert(vecAllTriplets.end(), vecPart.begin(), vecPart.end());
+        std::vector<Triplet<double> >().swap(vecPart);
+    }
+
+    returnMat->setFromTriplets(vecAllTriplets.begin(), vecAllTriplets.end());
+
+    return returnMat;
+}
+
+//=============================================================================================================
+
 QVector<int> GeometryInfo::projectSensors(const MatrixX3f &matVertices,
                                           const QVector<Vector3f> &vecSensorPositions)
 {
@@ -245,66 +330,164 @@ int u =0;
 
 //=============================================================================================================
 
+void GeometryInfo::buildAdjacency(const MatrixX3f &matVertices,
+                                  const QVector<QVector<int> > &vecNeighborVertices,
+                                  VectorXi &vecNeighborOffsets,
+                                  VectorXi &vecNeighbors,
+                                  VectorXd &vecEdgeLengths)
+{
+    const qint32 n = vecNeighborVertices.size();
+
+    vecNeighborOffsets.resize(n + 1);
+    vecNeighborOffsets[0] = 0;
+    for(qint32 u = 0; u < n; ++u) {
+        vecNeighborOffsets[u + 1] = vecNeighborOffsets[u] + vecNeighborVertices[u].size();
+    }
+
+    vecNeighbors.resize(vecNeighborOffsets[n]);
+    vecEdgeLengths.resize(vecNeighborOffsets[n]);
+
+    for(qint32 u = 0; u < n; ++u) {
+        const QVector<int>& vecNeighbours = vecNeighborVertices[u];
+
+        for(qint32 ne = 0, k = vecNeighborOffsets[u]; ne < vecNeighbours.size(); ++ne, ++k) {
+            const qint32 v = vecNeighbours[ne];
+            const double dDistX = matVertices(u, 0) - matVertices(v, 0);
+            const double dDistY = matVertices(u, 1) - matVertices(v, 1);
+            const double dDistZ = matVertices(u, 2) - matVertices(v, 2);
+
+            vecNeighbors[k] = v;
+            vecEdgeLengths[k] = sqrt(dDistX * dDistX + dDistY * dDistY + dDistZ * dDistZ);
+        }
+    }
+}
+
+//=============================================================================================================
+
+void GeometryInfo::boundedDijkstra(qint32 iRoot,
+                                   const VectorXi &vecNeighborOffsets,
+                                   const VectorXi &vecNeighbors,
+                                   const VectorXd &vecEdgeLengths,
+                                   double dCancelDistance,
+                                   QVector<double> &vecMinDists,
+                                   QVector<qint32> &vecVisited,
+                                   std::vector<std::pair<double, qint32> > &vecHeap)
+{
+    const double INF = FLOAT_INFINITY;
+    const std::greater<std::pair<double, qint32> > compare;
+
+    // only reset the vertices which were reached from the previous root
+    for (qint32 v : vecVisited) {
+        vecMinDists[v] = INF;
+    }
+    vecVisited.clear();
+    vecHeap.clear();
+
+    vecMinDists[iRoot] = 0.0;
+    vecVisited.push_back(iRoot);
+    vecHeap.push_back(std::make_pair(0.0, iRoot));
+
+    // dijkstra main loop, outdated heap entries are skipped instead of decreasing their key
+    while (!vecHeap.empty()) {
+        std::pop_heap(vecHeap.begin(), vecHeap.end(), compare);
+        const double dDist = vecHeap.back().first;
+        const qint32 u = vecHeap.back().second;
+        vecHeap.pop_back();
+
+        if (dDist > vecMinDists[u]) {
+            continue;
+        }
+
+        // visit each neighbour of u
+        for (qint32 k = vecNeighborOffsets[u]; k < vecNeighborOffsets[u + 1]; ++k) {
+            const qint32 v = vecNeighbors[k];
+
+            // distance from source (i.e. root) to v, using u as its predecessor
+            const double dDistWithU = dDist + vecEdgeLengths[k];
+
+            if (dDistWithU < vecMinDists[v]) {
+                if (vecMinDists[v] == INF) {
+                    vecVisited.push_back(v);
+                }
+                vecMinDists[v] = dDistWithU;
+
+                // vertices beyond the cancel distance keep their distance but are not expanded
+                if (dDistWithU <= dCancelDistance) {
+                    vecHeap.push_back(std::make_pair(dDistWithU, v));
+                    std::push_heap(vecHeap.begin(), vecHeap.end(), compare);
+                }
+            }
+        }
+    }
+}
+
+//=============================================================================================================
+
 void GeometryInfo::iterativeDijkstra(QSharedPointer<MatrixXd> matOutputDistMatrix,
-                                     const MatrixX3f &matVertices,
-                                     const QVector<QVector<int> > &vecNeighborVertices,
+                                     const VectorXi &vecNeighborOffsets,
+                                     const VectorXi &vecNeighbors,
+                                     const VectorXd &vecEdgeLengths,
                                      const QVector<int> &vecVertSubset,
                                      qint32 iBegin,
                                      qint32 iEnd,
                                      double dCancelDistance) {
     // initialization
-    const QVector<QVector<int> > &vecAdjacency = vecNeighborVertices;
-    qint32 n = vecAdjacency.size();
-    QVector<double> vecMinDists(n);
-    std::set< std::pair< double, qint32> > vertexQ;
-    const double INF = FLOAT_INFINITY;
+    qint32 n = vecNeighborOffsets.size() - 1;
+    QVector<double> vecMinDists(n, FLOAT_INFINITY);
+    QVector<qint32> vecVisited;
+    std::vector<std::pair<double, qint32> > vecHeap;
 
     // outer loop, iterated for each vertex of 'vertSubset' between 'begin' and 'end'
     for (qint32 i = iBegin; i < iEnd; ++i) {
-        // init phase of dijkstra: set source node for current iteration and reset data fields
-        if(i ==123)
-            qDebug() << "blabla";
-        qint32 iRoot = vecVertSubset.at(i);
-        vertexQ.clear();
-        vecMinDists.fill(INF);
-        vecMinDists[iRoot] = 0.0;
-        vertexQ.insert(std::make_pair(vecMinDists[iRoot], iRoot));
-
-        // dijkstra main loop
-        while (vertexQ.empty() == false) {
-            // remove next vertex from queue
-            const double dDist = vertexQ.begin()->first;
-            const qint32 u = vertexQ.begin()->second;
-            vertexQ.erase(vertexQ.begin());
-
-            // check if we are still below cancel distance
-            if (dDist <= dCancelDistance) {
-                // visit each neighbour of u
-                const QVector<int>& vecNeighbours = vecAdjacency[u];
-
-                for (qint32 ne = 0; ne < vecNeighbours.length(); ++ne) {
-                    qint32 v = vecNeighbours[ne];
-
-                    // distance from source (i.e. root) to v, using u as its predecessor
-                    // calculate inline since designated function was magnitudes slower (even when declared as inline)
-                    const double dDistX = matVertices(u, 0) - matVertices(v, 0);
-                    const double dDistY = matVertices(u, 1) - matVertices(v, 1);
-                    const double dDistZ = matVertices(u, 2) - matVertices(v, 2);
-                    const double dDistWithU = dDist + sqrt(dDistX * dDistX + dDistY * dDistY + dDistZ * dDistZ);
-
-                    if (dDistWithU < vecMinDists[v]) {
-                        // this is a combination of insert and decreaseKey
-                        vertexQ.erase(std::make_pair(vecMinDists[v], v));
-                        vecMinDists[v] = dDistWithU;
-                        vertexQ.insert(std::make_pair(vecMinDists[v], v));
-                    }
-                }
-            }
-        }
+        boundedDijkstra(vecVertSubset.at(i),
+                        vecNeighborOffsets,
+                        vecNeighbors,
+                        vecEdgeLengths,
+                        dCancelDistance,
+                        vecMinDists,
+                        vecVisited,
+                        vecHeap);
 
         // save results for current root in matrix
-        for (qint32 m = 0; m < vecMinDists.size(); ++m) {
-            matOutputDistMatrix->coeffRef(m , i) = vecMinDists[m];
+        matOutputDistMatrix->col(i).setConstant(FLOAT_INFINITY);
+        for (qint32 v : vecVisited) {
+            matOutputDistMatrix->coeffRef(v, i) = vecMinDists[v];
+        }
+    }
+}
+
+//=============================================================================================================
+
+void GeometryInfo::iterativeDijkstraSparse(std::vector<Triplet<double> > &vecTriplets,
+                                           const VectorXi &vecNeighborOffsets,
+                                           const VectorXi &vecNeighbors,
+                                           const VectorXd &vecEdgeLengths,
+                                           const QVector<int> &vecVertSubset,
+                                           qint32 iBegin,
+                                           qint32 iEnd,
+                                           double dCancelDistance) {
+    // initialization
+    qint32 n = vecNeighborOffsets.size() - 1;
+    QVector<double> vecMinDists(n, FLOAT_INFINITY);
+    QVector<qint32> vecVisited;
+    std::vector<std::pair<double, qint32> > vecHeap;
+
+    // outer loop, iterated for each vertex of 'vertSubset' between 'begin' and 'end'
+    for (qint32 i = iBegin; i < iEnd; ++i) {
+        boundedDijkstra(vecVertSubset.at(i),
+                        vecNeighborOffsets,
+                        vecNeighbors,
+                        vecEdgeLengths,
+                        dCancelDistance,
+                        vecMinDists,
+                        vecVisited,
+                        vecHeap);
+
+        // only store the vertices below the cancel distance
+        for (qint32 v : vecVisited) {
+            if (vecMinDists[v] <= dCancelDistance) {
+                vecTriplets.push_back(Triplet<double>(v, i, vecMinDists[v]));
+            }
         }
     }
 }
@@ -339,3 +522,41 @@ QVector<int> GeometryInfo::filterBadChannels(QSharedPointer<Eigen::MatrixXd> mat
     }
     return vecBadColumns;
 }
+
+//=============================================================================================================
+
+QVector<int> GeometryInfo::filterBadChannels(QSharedPointer<Eigen::SparseMatrix<double> > matDistanceTable,
+                                             const FIFFLIB::FiffInfo& fiffInfo,
+                                             qint32 iSensorType) {
+    QVector<int> vecBadColumns;
+    QVector<const FiffChInfo*> vecSensors;
+    for(const FiffChInfo& s : fiffInfo.chs){
+        //Only take EEG with V as unit or MEG magnetometers with T as unit
+        if(s.kind == iSensorType && (s.unit == FIFF_UNIT_T || s.unit == FIFF_UNIT_V)){
+           vecSensors.push_back(&s);
+        }
+    }
+
+    QVector<bool> vecIsBad(matDistanceTable->cols(), false);
+
+    for(const QString& b : fiffInfo.bads){
+        for(int col = 0; col < vecSensors.size(); ++col){
+            if(vecSensors[col]->ch_name == b){
+                vecBadColumns.push_back(col);
+                if(col < vecIsBad.size()) {
+                    vecIsBad[col] = true;
+                }
+                break;
+            }
+        }
+    }
+
+    // remove all entries of the bad columns, the missing entries are interpreted as infinite distances
+    if(!vecBadColumns.isEmpty()) {
+        matDistanceTable->prune([&vecIsBad](const Index&, const Index& col, const double&) {
+            return !vecIsBad[col];
+        });
+    }
+
+    return vecBadColumns;
+}
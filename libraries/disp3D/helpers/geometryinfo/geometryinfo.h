@@ -47,6 +47,8 @@
 //=============================================================================================================
 
 #include <limits>
+#include <utility>
+#include <vector>
 
 //=============================================================================================================
 // QT INCLUDES
@@ -60,6 +62,7 @@
 //=============================================================================================================
 
 #include <Eigen/Core>
+#include <Eigen/SparseCore>
 
 //=============================================================================================================
 // FORWARD DECLARATIONS
@@ -121,6 +124,26 @@ public:
                                                 QVector<int> &pVecVertSubset,
                                                 double dCancelDist = FLOAT_INFINITY);
 
+    //=========================================================================================================
+    /**
+     * @brief scdcSparse                     Calculates surface constrained distances on a mesh up to the cancel distance.
+     *                                       Each shortest path search stops at the cancel distance, so that the memory and the
+     *                                       computation time scale with the number of vertices within the cancel distance
+     *                                       instead of the number of vertices times the size of the subset.
+     *
+     * @param[in] matVertices                The surface on which distances should be calculated.
+     * @param[in] vecNeighborVertices        The neighbor vertex information.
+     * @param[in/out] pVecVertSubset         The subset of IDs for which the distances should be calculated.
+     * @param[in] dCancelDist                Distances higher than this are not stored.
+     *
+     * @return                               A sparse double matrix. One column represents the distances for one vertex inside
+     *                                       of the passed subset. Vertices without an entry are further away than the cancel distance.
+     */
+    static QSharedPointer<Eigen::SparseMatrix<double> > scdcSparse(const Eigen::MatrixX3f &matVertices,
+                                                                   const QVector<QVector<int> > &vecNeighborVertices,
+                                                                   QVector<int> &pVecVertSubset,
+                                                                   double dCancelDist);
+
     //=========================================================================================================
     /**
      * @brief                            Calculates the nearest neighbor (euclidian distance) vertex to each sensor
@@ -148,6 +171,20 @@ public:
                                           const FIFFLIB::FiffInfo& fiffInfo,
                                           qint32 iSensorType);
 
+    //=========================================================================================================
+    /**
+     * @brief filterBadChannels          Filters bad channels from a sparse distance table
+     *
+     * @param[out] matDistanceTable      Result of the sparse SCDC. All entries of the bad channels are removed.
+     * @param[in] fiffInfo               Container for sensors.
+     * @param[in] iSensorType            Sensor type to be filtered out, use fiff constants.
+     *
+     * @return Vector of bad channel indices.
+     */
+    static QVector<int> filterBadChannels(QSharedPointer<Eigen::SparseMatrix<double> > matDistanceTable,
+                                          const FIFFLIB::FiffInfo& fiffInfo,
+                                          qint32 iSensorType);
+
 protected:
     //=========================================================================================================
     /**
@@ -175,23 +212,87 @@ protected:
 
     //=========================================================================================================
     /**
-     * @brief iterativeDijkstra     Calculates shortest distances on the mesh that is held by the MNEmatVertices for each vertex of the passed vector that lies between the two indices
+     * @brief buildAdjacency            Flattens the neighbor information into a CSR layout and precomputes the edge lengths
      *
-     * @param[out] matOutputDistMatrix  The matrix in which the distances will be stored
      * @param[in] matVertices           The surface on which distances should be calculated
      * @param[in] vecNeighborVertices   The neighbor vertex information.
+     * @param[out] vecNeighborOffsets   The offsets of the neighbors of each vertex, the size is the number of vertices + 1
+     * @param[out] vecNeighbors         The neighbors of all vertices
+     * @param[out] vecEdgeLengths       The euclidian length of each edge in vecNeighbors
+     */
+    static void buildAdjacency(const Eigen::MatrixX3f &matVertices,
+                               const QVector<QVector<int> > &vecNeighborVertices,
+                               Eigen::VectorXi &vecNeighborOffsets,
+                               Eigen::VectorXi &vecNeighbors,
+                               Eigen::VectorXd &vecEdgeLengths);
+
+    //=========================================================================================================
+    /**
+     * @brief boundedDijkstra           Calculates the shortest distances from one root vertex with a binary heap. Only vertices
+     *                                  below the cancel distance are expanded. Only the distances touched by the previous call
+     *                                  are reset, so that the cost does not depend on the size of the mesh.
+     *
+     * @param[in] iRoot                 The root vertex
+     * @param[in] vecNeighborOffsets    The CSR offsets of the neighbors
+     * @param[in] vecNeighbors          The CSR neighbors
+     * @param[in] vecEdgeLengths        The CSR edge lengths
+     * @param[in] dCancelDistance       Vertices with a higher distance to the root vertex are not expanded
+     * @param[in/out] vecMinDists       The distances to the root, must be initialized to infinity before the first call
+     * @param[in/out] vecVisited        The vertices with a finite distance to the root
+     * @param[in/out] vecHeap           The heap storage, reused between calls
+     */
+    static void boundedDijkstra(qint32 iRoot,
+                                const Eigen::VectorXi &vecNeighborOffsets,
+                                const Eigen::VectorXi &vecNeighbors,
+                                const Eigen::VectorXd &vecEdgeLengths,
+                                double dCancelDistance,
+                                QVector<double> &vecMinDists,
+                                QVector<qint32> &vecVisited,
+                                std::vector<std::pair<double, qint32> > &vecHeap);
+
+    //=========================================================================================================
+    /**
+     * @brief iterativeDijkstra     Calculates shortest distances on the mesh for each vertex of the passed vector that lies between the two indices
+     *
+     * @param[out] matOutputDistMatrix  The matrix in which the distances will be stored
+     * @param[in] vecNeighborOffsets    The CSR offsets of the neighbors
+     * @param[in] vecNeighbors          The CSR neighbors
+     * @param[in] vecEdgeLengths        The CSR edge lengths
      * @param[in] vecVertSubset         The subset of vertices
      * @param[in] iBegin                Start index of distance calculation
      * @param[in] iEnd                  End index of distance calculation, exclusive
      * @param[in] dCancelDistance       Distance threshold: all vertices that have a higher distance to the respective root vertex are set to infinity
      */
     static void iterativeDijkstra(QSharedPointer<Eigen::MatrixXd> matOutputDistMatrix,
-                                  const Eigen::MatrixX3f &matVertices,
-                                  const QVector<QVector<int> > &vecNeighborVertices,
+                                  const Eigen::VectorXi &vecNeighborOffsets,
+                                  const Eigen::VectorXi &vecNeighbors,
+                                  const Eigen::VectorXd &vecEdgeLengths,
                                   const QVector<int> &vecVertSubset,
                                   qint32 iBegin,
                                   qint32 iEnd,
                                   double dCancelDistance);
+
+    //=========================================================================================================
+    /**
+     * @brief iterativeDijkstraSparse   Calculates shortest distances up to the cancel distance for each vertex of the passed vector that lies between the two indices
+     *
+     * @param[out] vecTriplets          The (vertex, subset index, distance) entries below the cancel distance
+     * @param[in] vecNeighborOffsets    The CSR offsets of the neighbors
+     * @param[in] vecNeighbors          The CSR neighbors
+     * @param[in] vecEdgeLengths        The CSR edge lengths
+     * @param[in] vecVertSubset         The subset of vertices
+     * @param[in] iBegin                Start index of distance calculation
+     * @param[in] iEnd                  End index of distance calculation, exclusive
+     * @param[in] dCancelDistance       Distance threshold: only vertices up to this distance to the respective root vertex are stored
+     */
+    static void iterativeDijkstraSparse(std::vector<Eigen::Triplet<double> > &vecTriplets,
+                                        const Eigen::VectorXi &vecNeighborOffsets,
+                                        const Eigen::VectorXi &vecNeighbors,
+                                        const Eigen::VectorXd &vecEdgeLengths,
+                                        const QVector<int> &vecVertSubset,
+                                        qint32 iBegin,
+                                        qint32 iEnd,
+                                        double dCancelDistance);
 };
 
 //=============================================================================================================
@@ -38,12 +38,16 @@
 
 #include "interpolation.h"
 
+#include <algorithm>
+#include <vector>
+
 //=============================================================================================================
 // QT INCLUDES
 //=============================================================================================================
 
-#include <QSet>
+#include <QHash>
 #include <QDebug>
+#include <QtConcurrent/QtConcurrent>
 
 //=============================================================================================================
 // EIGEN INCLUDES
@@ -60,6 +64,77 @@ using namespace Eigen;
 // DEFINE GLOBAL METHODS
 //=============================================================================================================
 
+namespace {
+
+//=============================================================================================================
+/**
+ * Builds a row major sparse matrix in parallel. Every thread fills the rows of its block into own buffers, which
+ * are afterwards copied directly into the compressed row storage.
+ *
+ * @param[in] iRows         The number of rows.
+ * @param[in] iCols         The number of columns.
+ * @param[in] computeRow    Appends the sorted column indices and values of one row to the passed buffers.
+ *
+ * @return The row major sparse matrix.
+ */
+template<typename RowFunction>
+QSharedPointer<SparseMatrix<float, RowMajor> > buildRowMajor(qint32 iRows,
+                                                             qint32 iCols,
+                                                             const RowFunction& computeRow)
+{
+    int iCores = QThread::idealThreadCount();
+    if (iCores <= 0) {
+        // assume that we have at least two available cores
+        iCores = 2;
+    }
+
+    const qint32 iBlockSize = std::max(1, (iRows + iCores - 1) / iCores);
+    const qint32 iBlocks = std::max(1, (iRows + iBlockSize - 1) / iBlockSize);
+
+    std::vector<std::vector<int> > vecInner(iBlocks);
+    std::vector<std::vector<float> > vecValues(iBlocks);
+    std::vector<int> vecRowSizes(iRows);
+
+    QVector<QFuture<void> > vecThreads(iBlocks);
+
+    for (qint32 b = 0; b < iBlocks; ++b) {
+        vecThreads[b] = QtConcurrent::run([&, b]() {
+            const qint32 iEnd = std::min(iRows, (b + 1) * iBlockSize);
+
+            for (qint32 r = b * iBlockSize; r < iEnd; ++r) {
+                const size_t iStart = vecInner[b].size();
+                computeRow(r, vecInner[b], vecValues[b]);
+                vecRowSizes[r] = vecInner[b].size() - iStart;
+            }
+        });
+    }
+
+    for (QFuture<void>& f : vecThreads) {
+        f.waitForFinished();
+    }
+
+    // write the buffers directly into the compressed row storage
+    QSharedPointer<SparseMatrix<float, RowMajor> > matResult = QSharedPointer<SparseMatrix<float, RowMajor> >::create(iRows, iCols);
+
+    int* pOuter = matResult->outerIndexPtr();
+    pOuter[0] = 0;
+    for (qint32 r = 0; r < iRows; ++r) {
+        pOuter[r + 1] = pOuter[r] + vecRowSizes[r];
+    }
+
+    matResult->resizeNonZeros(pOuter[iRows]);
+
+    for (qint32 b = 0; b < iBlocks; ++b) {
+        const int iOffset = pOuter[std::min(iRows, b * iBlockSize)];
+        std::copy(vecInner[b].begin(), vecInner[b].end(), matResult->innerIndexPtr() + iOffset);
+        std::copy(vecValues[b].begin(), vecValues[b].end(), matResult->valuePtr() + iOffset);
+    }
+
+    return matResult;
+}
+
+} // namespace
+
 //=============================================================================================================
 // INITIALIZE STATIC MEMBER
 //=============================================================================================================
@@ -74,65 +149,140 @@ QSharedPointer<SparseMatrix<float> > Interpolation::createInterpolationMat(const
                                                                            const double dCancelDist,
                                                                            const QVector<int> &vecExcludeIndex)
 {
+    if(matDistanceTable->rows() == 0 && matDistanceTable->cols() == 0) {
+        qDebug() << "[WARNING] Interpolation::createInterpolationMat - received an empty distance table.";
+        return QSharedPointer<SparseMatrix<float> >::create();
+    }
+
+    return normalizeWeightMat(vecProjectedSensors,
+                              createWeightMat(matDistanceTable,
+                                              interpolationFunction,
+                                              dCancelDist),
+                              vecExcludeIndex);
+}
 
+//=============================================================================================================
+
+QSharedPointer<SparseMatrix<float> > Interpolation::createInterpolationMat(const QVector<int> &vecProjectedSensors,
+                                                                           const QSharedPointer<SparseMatrix<double> > matDistanceTable,
+                                                                           double (*interpolationFunction) (double),
+                                                                           const double dCancelDist,
+                                                                           const QVector<int> &vecExcludeIndex)
+{
     if(matDistanceTable->rows() == 0 && matDistanceTable->cols() == 0) {
         qDebug() << "[WARNING] Interpolation::createInterpolationMat - received an empty distance table.";
         return QSharedPointer<SparseMatrix<float> >::create();
     }
 
-    // initialization
-    QSharedPointer<Eigen::SparseMatrix<float> > matInterpolationMatrix = QSharedPointer<SparseMatrix<float> >::create(matDistanceTable->rows(), vecProjectedSensors.size());
+    return normalizeWeightMat(vecProjectedSensors,
+                              createWeightMat(matDistanceTable,
+                                              interpolationFunction,
+                                              dCancelDist),
+                              vecExcludeIndex);
+}
+
+//=============================================================================================================
 
-    // temporary helper structure for filling sparse matrix
-    QVector<Triplet<float> > vecNonZeroEntries;
-    const qint32 iRows = matInterpolationMatrix->rows();
-    const qint32 iCols = matInterpolationMatrix->cols();
+QSharedPointer<SparseMatrix<float, RowMajor> > Interpolation::createWeightMat(const QSharedPointer<MatrixXd> matDistanceTable,
+                                                                              double (*interpolationFunction) (double),
+                                                                              const double dCancelDist)
+{
+    const MatrixXd& matDist = *matDistanceTable;
 
-    // insert all sensor nodes into set for faster lookup during later computation. Also consider bad channels here.
-    QSet<qint32> sensorLookup;
-    int idx = 0;
+    return buildRowMajor(matDist.rows(),
+                         matDist.cols(),
+                         [&](qint32 r, std::vector<int>& vecInner, std::vector<float>& vecValues) {
+        for (qint32 c = 0; c < matDist.cols(); ++c) {
+            const float dDist = matDist(r, c);
 
-    for(const qint32& s : vecProjectedSensors){
-        if(!vecExcludeIndex.contains(idx)){
-            sensorLookup.insert(s);
+            if (dDist < dCancelDist) {
+                vecInner.push_back(c);
+                vecValues.push_back(std::fabs(1.0 / interpolationFunction(dDist)));
+            }
         }
-        idx++;
-    }
+    });
+}
 
-    // main loop: go through all rows of distance table and calculate weights
-    for (qint32 r = 0; r < iRows; ++r) {
-        if (sensorLookup.contains(r) == false) {
-            // "normal" node, i.e. one which was not assigned a sensor
-            // bLoThreshold: stores the indizes that point to distances which are below the passed distance threshold (dCancelDist)
-            QVector<QPair<qint32, float> > vecBelowThresh;
-            float dWeightsSum = 0.0;
-            const RowVectorXd& rowVec = matDistanceTable->row(r);
-
-            for (qint32 c = 0; c < iCols; ++c) {
-                const float dDist = rowVec[c];
-
-                if (dDist < dCancelDist) {
-                    const float dValueWeight = std::fabs(1.0 / interpolationFunction(dDist));
-                    dWeightsSum += dValueWeight;
-                    vecBelowThresh.push_back(qMakePair<qint32, float> (c, dValueWeight));
-                }
-            }
+//=============================================================================================================
 
-            for (const QPair<qint32, float> &qp : vecBelowThresh) {
-                vecNonZeroEntries.push_back(Eigen::Triplet<float> (r, qp.first, qp.second / dWeightsSum));
+QSharedPointer<SparseMatrix<float, RowMajor> > Interpolation::createWeightMat(const QSharedPointer<SparseMatrix<double> > matDistanceTable,
+                                                                              double (*interpolationFunction) (double),
+                                                                              const double dCancelDist)
+{
+    // the weights are stored per vertex, so walk the distance table row by row
+    const SparseMatrix<double, RowMajor> matDistanceRows = *matDistanceTable;
+
+    return buildRowMajor(matDistanceRows.rows(),
+                         matDistanceRows.cols(),
+                         [&](qint32 r, std::vector<int>& vecInner, std::vector<float>& vecValues) {
+        for (SparseMatrix<double, RowMajor>::InnerIterator it(matDistanceRows, r); it; ++it) {
+            const float dDist = it.value();
+
+            if (dDist < dCancelDist) {
+                vecInner.push_back(it.col());
+                vecValues.push_back(std::fabs(1.0 / interpolationFunction(dDist)));
             }
-        } else {
+        }
+    });
+}
+
+//=============================================================================================================
+
+QSharedPointer<SparseMatrix<float> > Interpolation::normalizeWeightMat(const QVector<int> &vecProjectedSensors,
+                                                                       const QSharedPointer<SparseMatrix<float, RowMajor> > matWeights,
+                                                                       const QVector<int> &vecExcludeIndex)
+{
+    const SparseMatrix<float, RowMajor>& matRawWeights = *matWeights;
+    const qint32 iCols = vecProjectedSensors.size();
+
+    // flag the excluded sensors, e.g. bad channels, for a constant time lookup per weight
+    QVector<bool> vecIsExcluded(iCols, false);
+    for (int idx : vecExcludeIndex) {
+        if (idx >= 0 && idx < iCols) {
+            vecIsExcluded[idx] = true;
+        }
+    }
+
+    // map the sensor vertices to the first sensor which is not excluded
+    QHash<qint32, qint32> hashSensorLookup;
+    hashSensorLookup.reserve(iCols);
+    for (qint32 idx = 0; idx < iCols; ++idx) {
+        if (!vecIsExcluded[idx] && !hashSensorLookup.contains(vecProjectedSensors[idx])) {
+            hashSensorLookup.insert(vecProjectedSensors[idx], idx);
+        }
+    }
+
+    QSharedPointer<SparseMatrix<float, RowMajor> > matNormalized = buildRowMajor(matRawWeights.rows(),
+                                                                                 iCols,
+                                                                                 [&](qint32 r, std::vector<int>& vecInner, std::vector<float>& vecValues) {
+        QHash<qint32, qint32>::const_iterator itSensor = hashSensorLookup.constFind(r);
+
+        if (itSensor != hashSensorLookup.constEnd()) {
             // a sensor has been assigned to this node, we do not need to interpolate anything
             //(final vertex signal is equal to sensor input signal, thus factor 1)
-            const int iIndexInSubset = vecProjectedSensors.indexOf(r);
+            vecInner.push_back(itSensor.value());
+            vecValues.push_back(1.0f);
+            return;
+        }
 
-            vecNonZeroEntries.push_back(Eigen::Triplet<float> (r, iIndexInSubset, 1));
+        // "normal" node, i.e. one which was not assigned a sensor
+        const size_t iRowStart = vecInner.size();
+        float dWeightsSum = 0.0;
+
+        for (SparseMatrix<float, RowMajor>::InnerIterator it(matRawWeights, r); it; ++it) {
+            if (it.col() < iCols && !vecIsExcluded[it.col()]) {
+                dWeightsSum += it.value();
+                vecInner.push_back(it.col());
+                vecValues.push_back(it.value());
+            }
         }
-    }
 
-    matInterpolationMatrix->setFromTriplets(vecNonZeroEntries.begin(), vecNonZeroEntries.end());
+        for (size_t k = iRowStart; k < vecValues.size(); ++k) {
+            vecValues[k] /= dWeightsSum;
+        }
+    });
 
-    return matInterpolationMatrix;
+    return QSharedPointer<SparseMatrix<float> >::create(*matNormalized);
 }
 
 //=============================================================================================================
@@ -111,7 +111,8 @@ public:
      * @param[in] matDistanceTable              Matrix that contains all needed distances
      * @param[in] interpolationFunction         Function that computes interpolation coefficients using the distance values
      * @param[in] dCancelDist                   Distances higher than this are ignored, i.e. the respective coefficients are set to zero
-     * @param[in] vecExcludeIndex               The indices to be excluded from vecProjectedSensors, e.g., bad channels (empty by default)
+     * @param[in] vecExcludeIndex               The indices to be excluded from vecProjectedSensors, e.g., bad channels (empty by default).
+     *                                          Their weights are dropped and the vertices they were mapped to are interpolated.
      *
      * @return                                  The distance matrix created
      */
@@ -121,6 +122,75 @@ public:
                                                                               const double dCancelDist = FLOAT_INFINITY,
                                                                               const QVector<int> &vecExcludeIndex = QVector<int>());
 
+    //=========================================================================================================
+    /**
+     * This method calculates the weight matrix from a sparse distance table as created by <i>GeometryInfo::scdcSparse</i>.
+     * Missing entries of the distance table are treated as infinite distances. See the dense version for the scheme.
+     *
+     * @param[in] vecProjectedSensors           Vector of IDs of sensor vertices
+     * @param[in] matDistanceTable              Sparse matrix that contains all distances below the cancel distance
+     * @param[in] interpolationFunction         Function that computes interpolation coefficients using the distance values
+     * @param[in] dCancelDist                   Distances higher than this are ignored, i.e. the respective coefficients are set to zero
+     * @param[in] vecExcludeIndex               The indices to be excluded from vecProjectedSensors, e.g., bad channels (empty by default).
+     *                                          Their weights are dropped and the vertices they were mapped to are interpolated.
+     *
+     * @return                                  The distance matrix created
+     */
+    static QSharedPointer<Eigen::SparseMatrix<float> > createInterpolationMat(const QVector<int> &vecProjectedSensors,
+                                                                              const QSharedPointer<Eigen::SparseMatrix<double> > matDistanceTable,
+                                                                              double (*interpolationFunction) (double),
+                                                                              const double dCancelDist = FLOAT_INFINITY,
+                                                                              const QVector<int> &vecExcludeIndex = QVector<int>());
+
+    //=========================================================================================================
+    /**
+     * This method calculates the unnormalized interpolation weights |1/f(d)| for all distances below the cancel distance.
+     * The rows are computed in parallel and written directly into the compressed row storage.
+     * Together with <i>normalizeWeightMat</i> this allows to change the excluded sensors, e.g., bad channels, without
+     * evaluating the distances and the interpolation function again.
+     *
+     * @param[in] matDistanceTable              Matrix that contains all needed distances
+     * @param[in] interpolationFunction         Function that computes interpolation coefficients using the distance values
+     * @param[in] dCancelDist                   Distances higher than this are ignored, i.e. the respective coefficients are not stored
+     *
+     * @return                                  The unnormalized weight matrix, one row per vertex
+     */
+    static QSharedPointer<Eigen::SparseMatrix<float, Eigen::RowMajor> > createWeightMat(const QSharedPointer<Eigen::MatrixXd> matDistanceTable,
+                                                                                       double (*interpolationFunction) (double),
+                                                                                       const double dCancelDist = FLOAT_INFINITY);
+
+    //=========================================================================================================
+    /**
+     * This method calculates the unnormalized interpolation weights |1/f(d)| from a sparse distance table as created by
+     * <i>GeometryInfo::scdcSparse</i>.
+     *
+     * @param[in] matDistanceTable              Sparse matrix that contains all distances below the cancel distance
+     * @param[in] interpolationFunction         Function that computes interpolation coefficients using the distance values
+     * @param[in] dCancelDist                   Distances higher than this are ignored, i.e. the respective coefficients are not stored
+     *
+     * @return                                  The unnormalized weight matrix, one row per vertex
+     */
+    static QSharedPointer<Eigen::SparseMatrix<float, Eigen::RowMajor> > createWeightMat(const QSharedPointer<Eigen::SparseMatrix<double> > matDistanceTable,
+                                                                                       double (*interpolationFunction) (double),
+                                                                                       const double dCancelDist = FLOAT_INFINITY);
+
+    //=========================================================================================================
+    /**
+     * This method normalizes the weights of each vertex over the sensors which are not excluded and sets the rows of the
+     * sensor vertices to the respective sensor. The rows are processed in parallel. Call this method again with the same
+     * weights when the excluded sensors change.
+     *
+     * @param[in] vecProjectedSensors           Vector of IDs of sensor vertices
+     * @param[in] matWeights                    The unnormalized weights as created by <i>createWeightMat</i>
+     * @param[in] vecExcludeIndex               The indices to be excluded from vecProjectedSensors, e.g., bad channels (empty by default).
+     *                                          Their weights are dropped and the vertices they were mapped to are interpolated.
+     *
+     * @return                                  The interpolation matrix
+     */
+    static QSharedPointer<Eigen::SparseMatrix<float> > normalizeWeightMat(const QVector<int> &vecProjectedSensors,
+                                                                          const QSharedPointer<Eigen::SparseMatrix<float, Eigen::RowMajor> > matWeights,
+                                                                          const QVector<int> &vecExcludeIndex = QVector<int>());
+
     //=========================================================================================================
     /**
      * The interpolation essentially corresponds to a matrix * vector multiplication. A vector of sensor data (i.e. a vector of double-values)
@@ -0,0 +1,302 @@
+//=============================================================================================================
+/**
+ * @file     meshlod.cpp
+ * @author   MNE-CPP authors
+ * @since    0.1.8
+ * @date     October, 2026
+ *
+ * @section  LICENSE
+ *
+ * Copyright (C) 2026, MNE-CPP authors. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ * the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+ *       following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ *       the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+ *       to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * @brief    MeshLod class definition.
+ *
+ */
+
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "meshlod.h"
+
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <algorithm>
+#include <limits>
+
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QHash>
+#include <QSet>
+#include <QDebug>
+
+//=============================================================================================================
+// EIGEN INCLUDES
+//=============================================================================================================
+
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace DISP3DLIB;
+using namespace Eigen;
+
+//=============================================================================================================
+// DEFINES
+//=============================================================================================================
+
+#define MIN_LOD_VERTICES            1000
+#define MIN_LOD_REDUCTION           0.75
+#define VIEWPORT_PIXELS_PER_VERTEX  64
+#define MAX_LOD_VERTICES            (1 << 20)
+
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+MeshLod::MeshLod()
+{
+}
+
+//=============================================================================================================
+
+MeshLod::MeshLod(const MatrixX3f& matVertices,
+                 const MatrixX3f& matNormals,
+                 const MatrixX3i& matTris,
+                 int iMaxNumLevels)
+{
+    if(matVertices.rows() == 0 || matVertices.rows() != matNormals.rows()) {
+        qDebug() << "MeshLod::MeshLod - Vertices (" << matVertices.rows() << ") and normals (" << matNormals.rows() << ") do not match. Returning ...";
+        return;
+    }
+
+    MeshLodLevel fullLevel;
+    fullLevel.matVertices = matVertices;
+    fullLevel.matNormals = matNormals;
+    fullLevel.matTris = matTris;
+    fullLevel.vecLodToFull = VectorXi::LinSpaced(matVertices.rows(), 0, matVertices.rows() - 1);
+    fullLevel.vecFullToLod = fullLevel.vecLodToFull;
+    computeNeighbors(fullLevel);
+    m_vecLevels.append(fullLevel);
+
+    // The cluster and triangle keys below pack vertex indices and grid cells into 64 bit
+    if(matVertices.rows() >= MAX_LOD_VERTICES || matTris.rows() == 0) {
+        return;
+    }
+
+    // The grid cells of the first decimated level are twice as large as the mean edge length
+    double dEdgeLength = 0.0;
+    for(int t = 0; t < matTris.rows(); ++t) {
+        for(int k = 0; k < 3; ++k) {
+            dEdgeLength += (matVertices.row(matTris(t,k)) - matVertices.row(matTris(t,(k+1)%3))).norm();
+        }
+    }
+    dEdgeLength /= 3.0 * matTris.rows();
+
+    float fCellSize = 2.0f * dEdgeLength;
+
+    while(m_vecLevels.size() < iMaxNumLevels) {
+        MeshLodLevel lodLevel = decimate(fCellSize);
+
+        if(lodLevel.matVertices.rows() < MIN_LOD_VERTICES
+           || lodLevel.matVertices.rows() > MIN_LOD_REDUCTION * m_vecLevels.last().matVertices.rows()) {
+            break;
+        }
+
+        m_vecLevels.append(lodLevel);
+        fCellSize *= 2.0f;
+    }
+}
+
+//=============================================================================================================
+
+int MeshLod::levelForViewport(const QSize& viewportSize) const
+{
+    if(!viewportSize.isValid() || viewportSize.isEmpty()) {
+        return 0;
+    }
+
+    const qint64 iNumTargetVertices = (qint64)viewportSize.width() * viewportSize.height() / VIEWPORT_PIXELS_PER_VERTEX;
+
+    for(int i = m_vecLevels.size() - 1; i > 0; --i) {
+        if(m_vecLevels[i].matVertices.rows() >= iNumTargetVertices) {
+            return i;
+        }
+    }
+
+    return 0;
+}
+
+//=============================================================================================================
+
+VectorXi MeshLod::mapVertices(int iLevel,
+                              const VectorXi& vecFullVertNo) const
+{
+    const VectorXi& vecFullToLod = m_vecLevels[iLevel].vecFullToLod;
+    VectorXi vecLodVertNo(vecFullVertNo.rows());
+
+    for(int i = 0; i < vecFullVertNo.rows(); ++i) {
+        vecLodVertNo(i) = vecFullToLod(vecFullVertNo(i));
+    }
+
+    return vecLodVertNo;
+}
+
+//=============================================================================================================
+
+MeshLodLevel MeshLod::decimate(float fCellSize) const
+{
+    const MeshLodLevel& fullLevel = m_vecLevels.first();
+    const MatrixX3f& matVertices = fullLevel.matVertices;
+    const MatrixX3f& matNormals = fullLevel.matNormals;
+    const int iNumVertices = matVertices.rows();
+    const RowVector3f vecMin = matVertices.colwise().minCoeff();
+
+    MeshLodLevel lodLevel;
+    lodLevel.vecFullToLod.resize(iNumVertices);
+
+    // Assign the vertices to grid cells. Each cell is split into six clusters by the main direction of the normals.
+    QHash<qint64, int> hashClusters;
+    hashClusters.reserve(iNumVertices / 4);
+    QVector<Vector3f> vecCentroids;
+    QVector<int> vecNumMembers;
+
+    for(int v = 0; v < iNumVertices; ++v) {
+        const RowVector3i vecCell = ((matVertices.row(v) - vecMin) / fCellSize).array().floor().cast<int>();
+        int iAxis;
+        matNormals.row(v).cwiseAbs().maxCoeff(&iAxis);
+        const int iDirection = 2 * iAxis + (matNormals(v,iAxis) < 0.0f ? 1 : 0);
+
+        const qint64 iKey = ((qint64)vecCell(0) << 43) | ((qint64)vecCell(1) << 23) | ((qint64)vecCell(2) << 3) | iDirection;
+
+        QHash<qint64, int>::const_iterator itCluster = hashClusters.constFind(iKey);
+        int iCluster;
+
+        if(itCluster == hashClusters.constEnd()) {
+            iCluster = vecCentroids.size();
+            hashClusters.insert(iKey, iCluster);
+            vecCentroids.append(Vector3f::Zero());
+            vecNumMembers.append(0);
+        } else {
+            iCluster = itCluster.value();
+        }
+
+        lodLevel.vecFullToLod(v) = iCluster;
+        vecCentroids[iCluster] += matVertices.row(v).transpose();
+        vecNumMembers[iCluster]++;
+    }
+
+    // Represent each cluster by the member closest to its centroid and average the normals of all members
+    const int iNumClusters = vecCentroids.size();
+    VectorXf vecBestDist = VectorXf::Constant(iNumClusters, std::numeric_limits<float>::max());
+    lodLevel.vecLodToFull.resize(iNumClusters);
+    lodLevel.matNormals = MatrixX3f::Zero(iNumClusters, 3);
+
+    for(int c = 0; c < iNumClusters; ++c) {
+        vecCentroids[c] /= vecNumMembers[c];
+    }
+
+    for(int v = 0; v < iNumVertices; ++v) {
+        const int iCluster = lodLevel.vecFullToLod(v);
+        const float fDist = (matVertices.row(v).transpose() - vecCentroids[iCluster]).squaredNorm();
+
+        if(fDist < vecBestDist(iCluster)) {
+            vecBestDist(iCluster) = fDist;
+            lodLevel.vecLodToFull(iCluster) = v;
+        }
+
+        lodLevel.matNormals.row(iCluster) += matNormals.row(v);
+    }
+
+    lodLevel.matVertices.resize(iNumClusters, 3);
+
+    for(int c = 0; c < iNumClusters; ++c) {
+        lodLevel.matVertices.row(c) = matVertices.row(lodLevel.vecLodToFull(c));
+
+        const float fNorm = lodLevel.matNormals.row(c).norm();
+        if(fNorm > 0.0f) {
+            lodLevel.matNormals.row(c) /= fNorm;
+        } else {
+            lodLevel.matNormals.row(c) = matNormals.row(lodLevel.vecLodToFull(c));
+        }
+    }
+
+    // Keep the triangles whose corners fall into three different clusters, each of them only once
+    const MatrixX3i& matTris = fullLevel.matTris;
+    QSet<qint64> setTris;
+    setTris.reserve(matTris.rows() / 2);
+    QVector<RowVector3i> vecTris;
+
+    for(int t = 0; t < matTris.rows(); ++t) {
+        RowVector3i vecTri(lodLevel.vecFullToLod(matTris(t,0)),
+                           lodLevel.vecFullToLod(matTris(t,1)),
+                           lodLevel.vecFullToLod(matTris(t,2)));
+
+        if(vecTri(0) == vecTri(1) || vecTri(1) == vecTri(2) || vecTri(0) == vecTri(2)) {
+            continue;
+        }
+
+        RowVector3i vecSorted = vecTri;
+        std::sort(vecSorted.data(), vecSorted.data() + 3);
+        const qint64 iKey = ((qint64)vecSorted(0) << 42) | ((qint64)vecSorted(1) << 21) | vecSorted(2);
+
+        if(!setTris.contains(iKey)) {
+            setTris.insert(iKey);
+            vecTris.append(vecTri);
+        }
+    }
+
+    lodLevel.matTris.resize(vecTris.size(), 3);
+    for(int t = 0; t < vecTris.size(); ++t) {
+        lodLevel.matTris.row(t) = vecTris[t];
+    }
+
+    computeNeighbors(lodLevel);
+
+    return lodLevel;
+}
+
+//=============================================================================================================
+
+void MeshLod::computeNeighbors(MeshLodLevel& lodLevel)
+{
+    lodLevel.vecNeighborVertices = QVector<QVector<int> >(lodLevel.matVertices.rows());
+
+    for(int t = 0; t < lodLevel.matTris.rows(); ++t) {
+        for(int k = 0; k < 3; ++k) {
+            const int iFrom = lodLevel.matTris(t,k);
+            const int iTo = lodLevel.matTris(t,(k+1)%3);
+
+            if(!lodLevel.vecNeighborVertices[iFrom].contains(iTo)) {
+                lodLevel.vecNeighborVertices[iFrom].append(iTo);
+            }
+
+            if(!lodLevel.vecNeighborVertices[iTo].contains(iFrom)) {
+                lodLevel.vecNeighborVertices[iTo].append(iFrom);
+            }
+        }
+    }
+}
@@ -0,0 +1,230 @@
+//=============================================================================================================
+/**
+ * @file     meshlod.h
+ * @author   MNE-CPP authors
+ * @since    0.1.8
+ * @date     October, 2026
+ *
+ * @section  LICENSE
+ *
+ * Copyright (C) 2026, MNE-CPP authors. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ * the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+ *       following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ *       the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+ *       to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * @brief     MeshLod class declaration.
+ *
+ */
+
+#ifndef DISP3DLIB_MESHLOD_H
+#define DISP3DLIB_MESHLOD_H
+
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "../../disp3D_global.h"
+
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QSharedPointer>
+#include <QVector>
+#include <QSize>
+
+//=============================================================================================================
+// EIGEN INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+//=============================================================================================================
+// FORWARD DECLARATIONS
+//=============================================================================================================
+
+//=============================================================================================================
+// DEFINE NAMESPACE DISP3DLIB
+//=============================================================================================================
+
+namespace DISP3DLIB {
+
+//=============================================================================================================
+// DISP3DLIB FORWARD DECLARATIONS
+//=============================================================================================================
+
+struct MeshLodLevel {
+    Eigen::MatrixX3f            matVertices;            /**< The vertex positions. */
+    Eigen::MatrixX3f            matNormals;             /**< The vertex normals. */
+    Eigen::MatrixX3i            matTris;                /**< The triangles. */
+    QVector<QVector<int> >      vecNeighborVertices;    /**< The neighbor vertex information. */
+    Eigen::VectorXi             vecLodToFull;           /**< The full resolution vertex each vertex of this level was taken from. */
+    Eigen::VectorXi             vecFullToLod;           /**< The vertex of this level which represents each full resolution vertex. */
+}; /**< The struct specifing one level of detail of a mesh. */
+
+//=============================================================================================================
+/**
+ * This class precomputes decimated versions of a triangulated surface. Level 0 is the full resolution mesh, every
+ * further level doubles the edge length by clustering the vertices of the full resolution mesh on a grid. The
+ * vertices of each cluster are replaced by the member closest to the cluster centroid, so that every vertex of
+ * a level is also a vertex of the full resolution mesh. Vertices whose normals point to different directions are
+ * not merged, which keeps the opposite banks of a sulcus apart.
+ *
+ * @brief Decimated levels of detail of a triangulated surface with vertex correspondence maps
+ */
+class DISP3DSHARED_EXPORT MeshLod
+{
+
+public:
+    typedef QSharedPointer<MeshLod> SPtr;            /**< Shared pointer type for MeshLod. */
+    typedef QSharedPointer<const MeshLod> ConstSPtr; /**< Const shared pointer type for MeshLod. */
+
+    //=========================================================================================================
+    /**
+     * Default constructor, creates an empty mesh without levels.
+     */
+    MeshLod();
+
+    //=========================================================================================================
+    /**
+     * Constructs the levels of detail of a surface.
+     *
+     * @param[in] matVertices        The vertex positions of the full resolution mesh.
+     * @param[in] matNormals         The vertex normals of the full resolution mesh.
+     * @param[in] matTris            The triangles of the full resolution mesh.
+     * @param[in] iMaxNumLevels      The maximum number of levels including the full resolution mesh. Decimation stops
+     *                               earlier if a level would have less than MIN_LOD_VERTICES vertices or would not
+     *                               reduce the number of vertices notably.
+     */
+    MeshLod(const Eigen::MatrixX3f& matVertices,
+            const Eigen::MatrixX3f& matNormals,
+            const Eigen::MatrixX3i& matTris,
+            int iMaxNumLevels = 3);
+
+    //=========================================================================================================
+    /**
+     * Returns the number of levels.
+     *
+     * @return The number of levels including the full resolution mesh.
+     */
+    inline int numLevels() const;
+
+    //=========================================================================================================
+    /**
+     * Returns a level of detail.
+     *
+     * @param[in] iLevel     The level, 0 being the full resolution mesh.
+     *
+     * @return The level of detail.
+     */
+    inline const MeshLodLevel& level(int iLevel) const;
+
+    //=========================================================================================================
+    /**
+     * Selects the coarsest level which still has about one vertex per VIEWPORT_PIXELS_PER_VERTEX pixels of the
+     * viewport. Falls back to the full resolution mesh if the viewport size is unknown.
+     *
+     * @param[in] viewportSize   The size of the viewport in pixels.
+     *
+     * @return The selected level.
+     */
+    int levelForViewport(const QSize& viewportSize) const;
+
+    //=========================================================================================================
+    /**
+     * Maps full resolution vertex indices, e.g. the vertices of a source space, to the vertices of a level.
+     *
+     * @param[in] iLevel             The level to map to.
+     * @param[in] vecFullVertNo      The full resolution vertex indices.
+     *
+     * @return The vertex indices of the level.
+     */
+    Eigen::VectorXi mapVertices(int iLevel,
+                                const Eigen::VectorXi& vecFullVertNo) const;
+
+    //=========================================================================================================
+    /**
+     * Picks the rows of per vertex data, e.g. curvature values, colors or label ids, for the vertices of a level.
+     *
+     * @param[in] iLevel             The level to sample.
+     * @param[in] matFullData        The per vertex data of the full resolution mesh.
+     *
+     * @return The per vertex data of the level.
+     */
+    template<typename T>
+    T sampleVertexData(int iLevel,
+                       const T& matFullData) const;
+
+private:
+    //=========================================================================================================
+    /**
+     * Clusters the vertices of the full resolution mesh on a grid.
+     *
+     * @param[in] fCellSize      The edge length of the grid cells.
+     *
+     * @return The level of detail.
+     */
+    MeshLodLevel decimate(float fCellSize) const;
+
+    //=========================================================================================================
+    /**
+     * Fills in the neighbor vertex information based on the triangles.
+     *
+     * @param[in, out] lodLevel  The level of detail.
+     */
+    static void computeNeighbors(MeshLodLevel& lodLevel);
+
+    QVector<MeshLodLevel>       m_vecLevels;            /**< The levels of detail, starting with the full resolution mesh. */
+};
+
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+inline int MeshLod::numLevels() const
+{
+    return m_vecLevels.size();
+}
+
+//=============================================================================================================
+
+inline const MeshLodLevel& MeshLod::level(int iLevel) const
+{
+    return m_vecLevels[iLevel];
+}
+
+//=============================================================================================================
+
+template<typename T>
+T MeshLod::sampleVertexData(int iLevel,
+                            const T& matFullData) const
+{
+    const Eigen::VectorXi& vecLodToFull = m_vecLevels[iLevel].vecLodToFull;
+    T matData(vecLodToFull.rows(), matFullData.cols());
+
+    for(int i = 0; i < vecLodToFull.rows(); ++i) {
+        matData.row(i) = matFullData.row(vecLodToFull(i));
+    }
+
+    return matData;
+}
+
+} // NAMESPACE DISP3DLIB
+
+#endif // DISP3DLIB_MESHLOD_H
@@ -394,6 +394,9 @@ namespace FIFFLIB
 #define FIFF_MNE_INVERSE_SOURCE_ORIENTATIONS 3545    /**<  orientation of one source per row*/
                                // The source orientations must be expressed in the coordinate system
                                // given by FIFF_MNE_COORD_FRAME
+#define FIFF_MNE_INVERSE_LAMBDA2            3547     /**< Regularization factor of a prepared imaging kernel (mne-cpp)*/
+#define FIFF_MNE_INVERSE_NOISE_NORM         3548     /**< Noise-normalization factors of a prepared imaging kernel (mne-cpp)*/
+#define FIFF_MNE_INVERSE_NOISE_NORM_METHOD  3549     /**< Noise-normalization method of a prepared imaging kernel: 0 = MNE, 1 = dSPM, 2 = sLORETA (mne-cpp)*/
 
 /*
  * 3550... Saved environment info
@@ -42,6 +42,8 @@
 #include "label.h"
 #include "surface.h"
 
+#include <utils/ioutils.h>
+
 #include <iostream>
 
 //=============================================================================================================
@@ -58,6 +60,7 @@
 //=============================================================================================================
 
 using namespace FSLIB;
+using namespace UTILSLIB;
 using namespace Eigen;
 
 //=============================================================================================================
@@ -166,14 +169,16 @@ bool Annotation::read(const QString& p_sFileName, Annotation &p_Annotation)
     qint32 numEl;
     t_Stream >> numEl;
 
+    //Vertex and label id pairs
+    QByteArray t_Buffer;
+    if(!IOUtils::fread_block(t_Stream, t_Buffer, qint64(numEl)*2*sizeof(qint32)))
+        return false;
+
     p_Annotation.m_Vertices = VectorXi(numEl);
     p_Annotation.m_LabelIds = VectorXi(numEl);
 
-    for(qint32 i = 0; i < numEl; ++i)
-    {
-        t_Stream >> p_Annotation.m_Vertices[i];
-        t_Stream >> p_Annotation.m_LabelIds[i];
-    }
+    IOUtils::swap_int_many(t_Buffer.constData(), p_Annotation.m_Vertices.data(), numEl, 2);
+    IOUtils::swap_int_many(t_Buffer.constData() + sizeof(qint32), p_Annotation.m_LabelIds.data(), numEl, 2);
 
     qint32 hasColortable;
     t_Stream >> hasColortable;
@@ -276,6 +281,12 @@ bool Annotation::read(const QString& p_sFileName, Annotation &p_Annotation)
         printf("\tError! No colortable stored\n");
     }
 
+    if(t_Stream.status() != QDataStream::Ok)
+    {
+        printf("\tError: Unexpected end of the annotation file\n");
+        return false;
+    }
+
     // hemi info
     if(t_File.fileName().contains("lh."))
         p_Annotation.m_iHemi = 0;
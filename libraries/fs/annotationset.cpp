@@ -43,6 +43,7 @@
 
 #include <QFile>
 #include <QDebug>
+#include <QtConcurrent>
 
 //=============================================================================================================
 // USED NAMESPACES
@@ -71,10 +72,15 @@ AnnotationSet::AnnotationSet(const QString &subject_id, qint32 hemi, const QStri
     }
     else if(hemi == 2)
     {
+        // The hemispheres are independent files, read the right one in parallel
+        Annotation t_AnnotationRH;
+        QFuture<bool> t_futureRH = QtConcurrent::run([&]() {
+            return Annotation::read(subject_id, 1, atlas, subjects_dir, t_AnnotationRH);
+        });
         if(Annotation::read(subject_id, 0, atlas, subjects_dir, t_Annotation))
             insert(t_Annotation);
-        if(Annotation::read(subject_id, 1, atlas, subjects_dir, t_Annotation))
-            insert(t_Annotation);
+        if(t_futureRH.result())
+            insert(t_AnnotationRH);
     }
 }
 
@@ -90,10 +96,15 @@ AnnotationSet::AnnotationSet(const QString &path, qint32 hemi, const QString &at
     }
     else if(hemi == 2)
     {
+        // The hemispheres are independent files, read the right one in parallel
+        Annotation t_AnnotationRH;
+        QFuture<bool> t_futureRH = QtConcurrent::run([&]() {
+            return Annotation::read(path, 1, atlas, t_AnnotationRH);
+        });
         if(Annotation::read(path, 0, atlas, t_Annotation))
             insert(t_Annotation);
-        if(Annotation::read(path, 1, atlas, t_Annotation))
-            insert(t_Annotation);
+        if(t_futureRH.result())
+            insert(t_AnnotationRH);
     }
 }
 
@@ -150,15 +161,25 @@ bool AnnotationSet::read(const QString& p_sLHFileName, const QString& p_sRHFileN
     QStringList t_qListFileName;
     t_qListFileName << p_sLHFileName << p_sRHFileName;
 
+    // The files are independent, read the second one in parallel
+    Annotation t_AnnotationLH, t_AnnotationRH;
+    QFuture<bool> t_futureRH = QtConcurrent::run([&]() {
+        return Annotation::read(t_qListFileName.at(1), t_AnnotationRH);
+    });
+    QList<bool> t_qListRead;
+    t_qListRead << Annotation::read(t_qListFileName.at(0), t_AnnotationLH);
+    t_qListRead << t_futureRH.result();
+    QList<Annotation> t_qListAnnotations;
+    t_qListAnnotations << t_AnnotationLH << t_AnnotationRH;
+
     for(qint32 i = 0; i < t_qListFileName.size(); ++i)
     {
-        Annotation t_Annotation;
-        if(Annotation::read(t_qListFileName[i], t_Annotation))
+        if(t_qListRead[i])
         {
             if(t_qListFileName[i].contains("lh."))
-                p_AnnotationSet.m_qMapAnnots.insert(0, t_Annotation);
+                p_AnnotationSet.m_qMapAnnots.insert(0, t_qListAnnotations[i]);
             else if(t_qListFileName[i].contains("rh."))
-                p_AnnotationSet.m_qMapAnnots.insert(1, t_Annotation);
+                p_AnnotationSet.m_qMapAnnots.insert(1, t_qListAnnotations[i]);
             else
                 return false;
         }
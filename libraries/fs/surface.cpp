@@ -50,6 +50,7 @@
 #include <QFile>
 #include <QDataStream>
 #include <QTextStream>
+#include <QtConcurrent>
 
 //=============================================================================================================
 // USED NAMESPACES
@@ -231,6 +232,17 @@ bool Surface::read(const QString &p_sFile, Surface &p_Surface, bool p_bLoadCurva
     p_Surface.m_sFilePath = p_sFile.mid(0,t_NameIdx);
     p_Surface.m_sFileName = p_sFile.mid(t_NameIdx,p_sFile.size()-t_NameIdx);
 
+    // hemi info
+    qint32 t_iHemi = t_File.fileName().contains("lh.") ? 0 : 1;
+
+    //Load curvature in parallel to the geometry
+    QFuture<VectorXf> t_futureCurv;
+    if(p_bLoadCurvature)
+    {
+        QString t_sCurvatureFile = QString("%1%2.curv").arg(p_Surface.m_sFilePath).arg(t_iHemi == 0 ? "lh" : "rh");
+        t_futureCurv = QtConcurrent::run(&Surface::read_curv, t_sCurvatureFile);
+    }
+
     QDataStream t_DataStream(&t_File);
     t_DataStream.setByteOrder(QDataStream::BigEndian);
 
@@ -249,8 +261,9 @@ bool Surface::read(const QString &p_sFile, Surface &p_Surface, bool p_bLoadCurva
     qint32 nvert = 0;
     qint32 nquad = 0;
     qint32 nface = 0;
-    MatrixXf verts;
-    MatrixXi faces;
+    MatrixX3f verts;
+    MatrixX3i faces;
+    QByteArray t_Buffer;
 
     if(magic == QUAD_FILE_MAGIC_NUMBER || magic == NEW_QUAD_FILE_MAGIC_NUMBER)
     {
@@ -261,48 +274,35 @@ bool Surface::read(const QString &p_sFile, Surface &p_Surface, bool p_bLoadCurva
         else
             printf("\t%s is a new quad file (nvert = %d nquad = %d)\n", p_sFile.toUtf8().constData(),nvert,nquad);
 
-        //vertices
+        //vertices, stored as x,y,z per vertex
         verts.resize(nvert, 3);
         if(magic == QUAD_FILE_MAGIC_NUMBER)
         {
-            qint16 iVal;
-            for(qint32 i = 0; i < nvert; ++i)
-            {
-                for(qint32 j = 0; j < 3; ++j)
-                {
-                    t_DataStream >> iVal;
-                    IOUtils::swap_short(iVal);
-                    verts(i,j) = ((float)iVal) / 100;
-                }
-            }
+            if(!IOUtils::fread_block(t_DataStream, t_Buffer, nvert*3*sizeof(qint16)))
+                return false;
+            Matrix<qint16, Dynamic, 3> iVerts(nvert, 3);
+            for(qint32 j = 0; j < 3; ++j)
+                IOUtils::swap_short_many(t_Buffer.constData() + j*sizeof(qint16), iVerts.col(j).data(), nvert, 3);
+            verts = iVerts.cast<float>() / 100.0f;
         }
         else
         {
-            t_DataStream.readRawData((char *)verts.data(), nvert*3*sizeof(float));
-            for(qint32 i = 0; i < nvert; ++i)
-                for(qint32 j = 0; j < 3; ++j)
-                    IOUtils::swap_floatp(&verts(i,j));
+            if(!IOUtils::fread_block(t_DataStream, t_Buffer, nvert*3*sizeof(float)))
+                return false;
+            for(qint32 j = 0; j < 3; ++j)
+                IOUtils::swap_float_many(t_Buffer.constData() + j*sizeof(float), verts.col(j).data(), nvert, 3);
         }
 
-        MatrixXi quads = IOUtils::fread3_many(t_DataStream, nquad*4);
-        MatrixXi quads_new(4, nquad);
-        qint32 count = 0;
-        for(qint32 j = 0; j < quads.cols(); ++j)
-        {
-            for(qint32 i = 0; i < quads.rows(); ++i)
-            {
-                quads_new(i,j) = quads(count, 0);
-                ++count;
-            }
-        }
-        quads = quads_new.transpose();
+        if(!IOUtils::fread_block(t_DataStream, t_Buffer, qint64(nquad)*4*3))
+            return false;
+        VectorXi quads = IOUtils::fread3_many(t_Buffer.constData(), nquad*4);
         //
         //  Face splitting follows
         //
-        faces = MatrixXi::Zero(2*nquad,3);
+        faces.resize(2*nquad,3);
         for(qint32 k = 0; k < nquad; ++k)
         {
-            RowVectorXi quad = quads.row(k);
+            const int* quad = quads.data() + 4*k;
             if ((quad[0] % 2) == 0)
             {
                 faces(nface,0) = quad[0];
@@ -317,14 +317,14 @@ bool Surface::read(const QString &p_sFile, Surface &p_Surface, bool p_bLoadCurva
             }
             else
             {
-                faces(nface,0) = quad(0);
-                faces(nface,1) = quad(1);
-                faces(nface,2) = quad(2);
+                faces(nface,0) = quad[0];
+                faces(nface,1) = quad[1];
+                faces(nface,2) = quad[2];
                 ++nface;
 
-                faces(nface,0) = quad(0);
-                faces(nface,1) = quad(2);
-                faces(nface,2) = quad(3);
+                faces(nface,0) = quad[0];
+                faces(nface,1) = quad[2];
+                faces(nface,2) = quad[3];
                 ++nface;
             }
         }
@@ -336,31 +336,23 @@ bool Surface::read(const QString &p_sFile, Surface &p_Surface, bool p_bLoadCurva
 
         t_DataStream >> nvert;
         t_DataStream >> nface;
-        IOUtils::swap_int(nvert);
-        IOUtils::swap_int(nface);
 
         printf("\t%s is a triangle file (nvert = %d ntri = %d)\n", p_sFile.toUtf8().constData(), nvert, nface);
         printf("\t%s", s.toUtf8().constData());
 
-        //vertices
-        verts.resize(3, nvert);
-        t_DataStream.readRawData((char *)verts.data(), nvert*3*sizeof(float));
-        for(qint32 i = 0; i < 3; ++i)
-            for(qint32 j = 0; j < nvert; ++j)
-                IOUtils::swap_floatp(&verts(i,j));
+        //vertices, stored as x,y,z per vertex
+        if(!IOUtils::fread_block(t_DataStream, t_Buffer, nvert*3*sizeof(float)))
+            return false;
+        verts.resize(nvert, 3);
+        for(qint32 j = 0; j < 3; ++j)
+            IOUtils::swap_float_many(t_Buffer.constData() + j*sizeof(float), verts.col(j).data(), nvert, 3);
 
         //faces
+        if(!IOUtils::fread_block(t_DataStream, t_Buffer, nface*3*sizeof(qint32)))
+            return false;
         faces.resize(nface, 3);
-        qint32 iVal;
-        for(qint32 i = 0; i < nface; ++i)
-        {
-            for(qint32 j = 0; j < 3; ++j)
-            {
-                t_DataStream >> iVal;
-                IOUtils::swap_int(iVal);
-                faces(i,j) = iVal;
-            }
-        }
+        for(qint32 j = 0; j < 3; ++j)
+            IOUtils::swap_int_many(t_Buffer.constData() + j*sizeof(qint32), faces.col(j).data(), nface, 3);
     }
     else
     {
@@ -368,36 +360,21 @@ bool Surface::read(const QString &p_sFile, Surface &p_Surface, bool p_bLoadCurva
         return false;
     }
 
-    verts.transposeInPlace();
     verts.array() *= 0.001f;
 
-    p_Surface.m_matRR = verts.block(0,0,verts.rows(),3);
-    p_Surface.m_matTris = faces.block(0,0,faces.rows(),3);
+    p_Surface.m_matRR = verts;
+    p_Surface.m_matTris = faces;
 
     //-> not needed since qglbuilder is doing that for us
     p_Surface.m_matNN = compute_normals(p_Surface.m_matRR, p_Surface.m_matTris);
 
-    // hemi info
-    if(t_File.fileName().contains("lh."))
-        p_Surface.m_iHemi = 0;
-    else if(t_File.fileName().contains("rh."))
-        p_Surface.m_iHemi = 1;
-    else
-    {
-        p_Surface.m_iHemi = -1;
-        return false;
-    }
+    p_Surface.m_iHemi = t_iHemi;
 
     //Loaded surface
     p_Surface.m_sSurf = t_File.fileName().mid((t_NameIdx+3),t_File.fileName().size() - (t_NameIdx+3));
 
-    //Load curvature
     if(p_bLoadCurvature)
-    {
-        QString t_sCurvatureFile = QString("%1%2.curv").arg(p_Surface.m_sFilePath).arg(p_Surface.m_iHemi == 0 ? "lh" : "rh");
-        printf("\t");
-        p_Surface.m_vecCurv = Surface::read_curv(t_sCurvatureFile);
-    }
+        p_Surface.m_vecCurv = t_futureCurv.result();
 
     t_File.close();
     printf("\tRead a surface with %d vertices from %s\n[done]\n",nvert,p_sFile.toUtf8().constData());
@@ -425,6 +402,7 @@ VectorXf Surface::read_curv(const QString &p_sFileName)
 
     qint32 vnum = IOUtils::fread3(t_DataStream);
     qint32 NEW_VERSION_MAGIC_NUMBER = 16777215;
+    QByteArray t_Buffer;
 
     if(vnum == NEW_VERSION_MAGIC_NUMBER)
     {
@@ -434,23 +412,20 @@ VectorXf Surface::read_curv(const QString &p_sFileName)
         t_DataStream >> fnum;
         t_DataStream >> vals_per_vertex;
 
+        if(!IOUtils::fread_block(t_DataStream, t_Buffer, vnum*sizeof(float)))
+            return curv;
         curv.resize(vnum, 1);
-        t_DataStream.readRawData((char *)curv.data(), vnum*sizeof(float));
-        for(qint32 i = 0; i < vnum; ++i)
-           IOUtils::swap_floatp(&curv(i));
+        IOUtils::swap_float_many(t_Buffer.constData(), curv.data(), vnum);
     }
     else
     {
         qint32 fnum = IOUtils::fread3(t_DataStream);
         Q_UNUSED(fnum)
-        qint16 iVal;
-        curv.resize(vnum, 1);
-        for(qint32 i = 0; i < vnum; ++i)
-        {
-            t_DataStream >> iVal;
-            IOUtils::swap_short(iVal);
-            curv(i) = ((float)iVal) / 100;
-        }
+        if(!IOUtils::fread_block(t_DataStream, t_Buffer, vnum*sizeof(qint16)))
+            return curv;
+        Matrix<qint16, Dynamic, 1> iCurv(vnum);
+        IOUtils::swap_short_many(t_Buffer.constData(), iCurv.data(), vnum);
+        curv = iCurv.cast<float>() / 100.0f;
     }
     t_File.close();
 
@@ -45,6 +45,7 @@
 //=============================================================================================================
 
 #include <QStringList>
+#include <QtConcurrent>
 
 //=============================================================================================================
 // USED NAMESPACES
@@ -73,10 +74,15 @@ SurfaceSet::SurfaceSet(const QString &subject_id, qint32 hemi, const QString &su
     }
     else if(hemi == 2)
     {
+        // The hemispheres are independent files, read the right one in parallel
+        Surface t_SurfaceRH;
+        QFuture<bool> t_futureRH = QtConcurrent::run([&]() {
+            return Surface::read(subject_id, 1, surf, subjects_dir, t_SurfaceRH);
+        });
         if(Surface::read(subject_id, 0, surf, subjects_dir, t_Surface))
             insert(t_Surface);
-        if(Surface::read(subject_id, 1, surf, subjects_dir, t_Surface))
-            insert(t_Surface);
+        if(t_futureRH.result())
+            insert(t_SurfaceRH);
     }
 
     calcOffset();
@@ -94,10 +100,15 @@ SurfaceSet::SurfaceSet(const QString &path, qint32 hemi, const QString &surf)
     }
     else if(hemi == 2)
     {
+        // The hemispheres are independent files, read the right one in parallel
+        Surface t_SurfaceRH;
+        QFuture<bool> t_futureRH = QtConcurrent::run([&]() {
+            return Surface::read(path, 1, surf, t_SurfaceRH);
+        });
         if(Surface::read(path, 0, surf, t_Surface))
             insert(t_Surface);
-        if(Surface::read(path, 1, surf, t_Surface))
-            insert(t_Surface);
+        if(t_futureRH.result())
+            insert(t_SurfaceRH);
     }
 
     calcOffset();
@@ -164,15 +175,25 @@ bool SurfaceSet::read(const QString& p_sLHFileName, const QString& p_sRHFileName
     QStringList t_qListFileName;
     t_qListFileName << p_sLHFileName << p_sRHFileName;
 
+    // The files are independent, read the second one in parallel
+    Surface t_SurfaceLH, t_SurfaceRH;
+    QFuture<bool> t_futureRH = QtConcurrent::run([&]() {
+        return Surface::read(t_qListFileName.at(1), t_SurfaceRH);
+    });
+    QList<bool> t_qListRead;
+    t_qListRead << Surface::read(t_qListFileName.at(0), t_SurfaceLH);
+    t_qListRead << t_futureRH.result();
+    QList<Surface> t_qListSurfaces;
+    t_qListSurfaces << t_SurfaceLH << t_SurfaceRH;
+
     for(qint32 i = 0; i < t_qListFileName.size(); ++i)
     {
-        Surface t_Surface;
-        if(Surface::read(t_qListFileName[i], t_Surface))
+        if(t_qListRead[i])
         {
             if(t_qListFileName[i].contains("lh."))
-                p_SurfaceSet.m_qMapSurfs.insert(0, t_Surface);
+                p_SurfaceSet.m_qMapSurfs.insert(0, t_qListSurfaces[i]);
             else if(t_qListFileName[i].contains("rh."))
-                p_SurfaceSet.m_qMapSurfs.insert(1, t_Surface);
+                p_SurfaceSet.m_qMapSurfs.insert(1, t_qListSurfaces[i]);
             else
                 return false;
         }
@@ -1964,6 +1964,9 @@ void ComputeFwd::initFwd()
     if (m_pSettings->nlabel > 0) {
         printf("Source space will be restricted to sources in %d labels\n",m_pSettings->nlabel);
     }
+    if (m_pSettings->use_geometry_cache) {
+        printf("Surface geometry information is cached next to the surface files.\n");
+    }
 
     // Read the source locations
 
@@ -2199,13 +2202,13 @@ void ComputeFwd::initFwd()
 
         printf("\nSetting up the BEM model using %s...\n",m_pSettings->bemname.toUtf8().constData());
         printf("\nLoading surfaces...\n");
-        m_bemModel = FwdBemModel::fwd_bem_load_three_layer_surfaces(m_pSettings->bemname);
+        m_bemModel = FwdBemModel::fwd_bem_load_three_layer_surfaces(m_pSettings->bemname,m_pSettings->use_geometry_cache);
 
         if (m_bemModel) {
             printf("Three-layer model surfaces loaded.\n");
         }
         else {
-            m_bemModel = FwdBemModel::fwd_bem_load_homog_surface(m_pSettings->bemname);
+            m_bemModel = FwdBemModel::fwd_bem_load_homog_surface(m_pSettings->bemname,m_pSettings->use_geometry_cache);
             if (!m_bemModel) {
                 return;
             }
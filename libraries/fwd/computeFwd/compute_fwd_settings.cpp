@@ -100,6 +100,7 @@ void ComputeFwdSettings::initMembers()
     scale_eeg_pos = false;    
     use_equiv_eeg = true;     
     use_threads = true;
+    use_geometry_cache = false;
 
     pFiffInfo = Q_NULLPTR;
     meg_head_t = Q_NULLPTR;
@@ -131,6 +132,7 @@ void ComputeFwdSettings::usage(char *name)
     fprintf(stderr,"\t--mindist dist/mm minimum allowable distance of the sources from the inner skull surface.\n");
     fprintf(stderr,"\t--mindistout name Output the omitted source space points here.\n");
     fprintf(stderr,"\t--includeall      Omit all source space checks\n");
+    fprintf(stderr,"\t--geomcache       store the surface geometry information next to the surface files and reuse it\n");
     fprintf(stderr,"\t--all             calculate forward solution in all nodes instead the selected ones only.\n");
     fprintf(stderr,"\t--fwd  name       save the solution here\n");
     fprintf(stderr,"\t--help            print this info.\n");
@@ -332,6 +334,10 @@ bool ComputeFwdSettings::check_args (int *argc,char **argv)
             found = 1;
             filter_spaces = false;
         }
+        else if (strcmp(argv[k],"--geomcache") == 0) {
+            found = 1;
+            use_geometry_cache = true;
+        }
         else if (strcmp(argv[k],"--mindistout") == 0) {
             found = 2;
             if (k == *argc - 1) {
@@ -138,6 +138,7 @@ public:
     bool scale_eeg_pos;     	/**< Scale the electrode locations to scalp in the sphere model */
     bool use_equiv_eeg;      	/**< Use the equivalent source approach for the EEG sphere model */
     bool use_threads;        	/**< Parallelize? */
+    bool use_geometry_cache;    /**< Store the surface geometry information next to the surface files and reuse it */
 
     QSharedPointer<FIFFLIB::FiffInfo> pFiffInfo;    /**< The FiffInfo file from the measurement.*/
     FIFFLIB::FiffCoordTransOld* meg_head_t;         /**< Pointer to meg <-> head transformation.*/
@@ -80,6 +80,7 @@ SOURCES += \
     fwd_bem_solution.cpp \
     fwd_coil.cpp \
     fwd_coil_set.cpp \
+    fwd_coil_set_soa.cpp \
     fwd_comp_data.cpp \
     fwd_eeg_sphere_layer.cpp \
     fwd_eeg_sphere_model.cpp \
@@ -94,6 +95,7 @@ HEADERS +=\
     fwd_bem_solution.h \
     fwd_coil.h \
     fwd_coil_set.h \
+    fwd_coil_set_soa.h \
     fwd_comp_data.h \
     fwd_eeg_sphere_layer.h \
     fwd_eeg_sphere_model.h \
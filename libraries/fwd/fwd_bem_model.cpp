@@ -46,6 +46,7 @@
 #include <mne/c/mne_source_space_old.h>
 
 #include "fwd_comp_data.h"
+#include "fwd_coil_set_soa.h"
 #include "fwd_bem_model.h"
 
 #include "fwd_thread_arg.h"
@@ -542,7 +543,7 @@ MneSurfaceOld *FwdBemModel::fwd_bem_find_surface(int kind)
 
 //=============================================================================================================
 
-FwdBemModel *FwdBemModel::fwd_bem_load_surfaces(const QString &name, int *kinds, int nkind)
+FwdBemModel *FwdBemModel::fwd_bem_load_surfaces(const QString &name, int *kinds, int nkind, bool use_geometry_cache)
 /*
  * Load a set of surfaces
  */
@@ -564,10 +565,10 @@ FwdBemModel *FwdBemModel::fwd_bem_load_surfaces(const QString &name, int *kinds,
 //        surfs[k] = NULL;
 
     for (k = 0; k < nkind; k++) {
-        surfs.append(MneSurfaceOld::read_bem_surface(name,kinds[k],TRUE,sigma+k));
+        surfs.append(MneSurfaceOld::read_bem_surface(name,kinds[k],TRUE,sigma+k,true,use_geometry_cache));
         if (surfs[k] == NULL)
             goto bad;
-        if ((surfs[k] = MneSurfaceOld::read_bem_surface(name,kinds[k],TRUE,sigma+k)) == NULL)
+        if ((surfs[k] = MneSurfaceOld::read_bem_surface(name,kinds[k],TRUE,sigma+k,true,use_geometry_cache)) == NULL)
             goto bad;
         if (sigma[k] < 0.0) {
             qCritical("No conductivity available for surface %s",fwd_bem_explain_surface(kinds[k]).toUtf8().constData());
@@ -624,7 +625,7 @@ bad : {
 
 //=============================================================================================================
 
-FwdBemModel *FwdBemModel::fwd_bem_load_homog_surface(const QString &name)
+FwdBemModel *FwdBemModel::fwd_bem_load_homog_surface(const QString &name, bool use_geometry_cache)
 /*
  * Load surfaces for the homogeneous model
  */
@@ -632,12 +633,12 @@ FwdBemModel *FwdBemModel::fwd_bem_load_homog_surface(const QString &name)
     int kinds[] = { FIFFV_BEM_SURF_ID_BRAIN };
     int nkind   = 1;
 
-    return fwd_bem_load_surfaces(name,kinds,nkind);
+    return fwd_bem_load_surfaces(name,kinds,nkind,use_geometry_cache);
 }
 
 //=============================================================================================================
 
-FwdBemModel *FwdBemModel::fwd_bem_load_three_layer_surfaces(const QString &name)
+FwdBemModel *FwdBemModel::fwd_bem_load_three_layer_surfaces(const QString &name, bool use_geometry_cache)
 /*
  * Load surfaces for three-layer model
  */
@@ -645,7 +646,7 @@ FwdBemModel *FwdBemModel::fwd_bem_load_three_layer_surfaces(const QString &name)
     int kinds[] = { FIFFV_BEM_SURF_ID_HEAD, FIFFV_BEM_SURF_ID_SKULL, FIFFV_BEM_SURF_ID_BRAIN };
     int nkind   = 3;
 
-    return fwd_bem_load_surfaces(name,kinds,nkind);
+    return fwd_bem_load_surfaces(name,kinds,nkind,use_geometry_cache);
 }
 
 //=============================================================================================================
@@ -2859,6 +2860,78 @@ int FwdBemModel::fwd_bem_field(float *rd, float *Q, FwdCoilSet *coils, float *B,
 
 //=============================================================================================================
 
+int FwdBemModel::fwd_bem_field_batch(const MatrixX3f& rd,
+                                     const MatrixX3f& Q,
+                                     FwdCoilSet *coils,
+                                     const FwdCoilSetSoA& soa,
+                                     MatrixXf& B,
+                                     void *client)
+{
+    FwdBemModel* m = (FwdBemModel*)client;
+    FwdBemSolution* sol = (FwdBemSolution*)coils->user_data;
+    int   s,k,d,p,n;
+    float mult;
+    float my_rd[3],my_Q[3],diff[3],diff2;
+    float *rr;
+    const int ndip = rd.rows();
+
+    if (!m) {
+        printf("No BEM model specified to fwd_bem_field_batch");
+        return FAIL;
+    }
+    if (!sol || !sol->solution || sol->ncoil != coils->ncoil || soa.ncoil() != coils->ncoil) {
+        printf("No appropriate coil-specific data available in fwd_bem_field_batch");
+        return FAIL;
+    }
+    if (m->bem_method != FWD_BEM_CONSTANT_COLL && m->bem_method != FWD_BEM_LINEAR_COLL) {
+        printf("Unknown BEM method : %d",m->bem_method);
+        return FAIL;
+    }
+    /*
+     * Infinite-medium potentials at the vertices (linear collocation)
+     * or at the triangle centers (constant collocation), one column per dipole
+     */
+    MatrixXf matV0(m->nsol,ndip);
+    for (d = 0; d < ndip; d++) {
+        for (k = 0; k < 3; k++) {
+            my_rd[k] = rd(d,k);
+            my_Q[k]  = Q(d,k);
+        }
+        if (m->head_mri_t) {
+            FiffCoordTransOld::fiff_coord_trans(my_rd,m->head_mri_t,FIFFV_MOVE);
+            FiffCoordTransOld::fiff_coord_trans(my_Q,m->head_mri_t,FIFFV_NO_MOVE);
+        }
+        float *v0 = matV0.col(d).data();
+        for (s = 0, p = 0; s < m->nsurf; s++) {
+            mult = m->source_mult[s]/(4.0*M_PI);
+            n    = (m->bem_method == FWD_BEM_LINEAR_COLL) ? m->surfs[s]->np : m->surfs[s]->ntri;
+            for (k = 0; k < n; k++) {
+                rr = (m->bem_method == FWD_BEM_LINEAR_COLL) ? m->surfs[s]->rr[k] : m->surfs[s]->tris[k].cent;
+                VEC_DIFF_40(my_rd,rr,diff);
+                diff2 = VEC_DOT_40(diff,diff);
+                v0[p++] = mult*VEC_DOT_40(my_Q,diff)/(diff2*sqrt(diff2));
+            }
+        }
+    }
+    /*
+     * Primary current contribution
+     * (can be calculated in the coil/dipole coordinates)
+     */
+    soa.bem_inf_field(rd,Q,B);
+    /*
+     * Volume current contribution, the solution matrix is stored row by row in one block
+     */
+    Map<const Matrix<float,Dynamic,Dynamic,RowMajor> > matSol(sol->solution[0],coils->ncoil,m->nsol);
+    B.noalias() += matSol*matV0;
+    /*
+     * Scale correctly
+     */
+    B *= MAG_FACTOR;
+    return OK;
+}
+
+//=============================================================================================================
+
 int FwdBemModel::fwd_bem_field_grad(float *rd,
                                     float Q[],
                                     FwdCoilSet *coils,
@@ -3095,6 +3168,68 @@ bad : {
     }
 }
 
+//=============================================================================================================
+/*
+ * Without compensation and gradients the MEG fields are computed for blocks
+ * of sources at a time with the batched kernels of FwdCoilSetSoA
+ */
+
+#define MEG_BATCH_SIZE 256      /* Source locations per batched field computation */
+
+typedef struct {
+    FwdCoilSet*             coils;      /* The coil definitions */
+    const FwdCoilSetSoA*    soa;        /* The same as structure of arrays */
+    FwdBemModel*            bem_model;  /* The BEM model or... */
+    const float             *r0;        /* ...the sphere model origin */
+    bool                    fixed_ori;  /* Use fixed-orientation dipoles */
+    float                   **rr;       /* Source locations of this block */
+    float                   **nn;       /* Source normals of this block */
+    float                   **res;      /* First result row of this block */
+    int                     nsrc;       /* Number of sources in this block */
+    int                     stat;       /* Did it work? */
+} *megBatch,megBatchRec;
+
+static void meg_fwd_batch(megBatchRec& b)
+{
+    int       ncomp = b.fixed_ori ? 1 : 3;
+    int       ndip  = ncomp*b.nsrc;
+    MatrixXf  B     = MatrixXf::Zero(b.soa->ncoil(),ndip);   /* The kernels do not write the rows of EEG electrodes */
+    int       j,c,p;
+
+    if (!b.bem_model && !b.fixed_ori) {
+        /*
+         * All source components of the sphere model in one go
+         */
+        MatrixX3f rd(b.nsrc,3);
+        for (j = 0; j < b.nsrc; j++)
+            rd.row(j) = Map<const RowVector3f>(b.rr[j]);
+        b.soa->sphere_field_vec(rd,b.r0,B);
+    }
+    else {
+        MatrixX3f rd(ndip,3),Q(ndip,3);
+        for (j = 0, p = 0; j < b.nsrc; j++) {
+            for (c = 0; c < ncomp; c++, p++) {
+                rd.row(p) = Map<const RowVector3f>(b.rr[j]);
+                if (b.fixed_ori)
+                    Q.row(p) = Map<const RowVector3f>(b.nn[j]);
+                else
+                    Q.row(p) = RowVector3f::Unit(c);
+            }
+        }
+        if (b.bem_model) {
+            if (FwdBemModel::fwd_bem_field_batch(rd,Q,b.coils,*b.soa,B,b.bem_model) != OK) {
+                b.stat = FAIL;
+                return;
+            }
+        }
+        else
+            b.soa->sphere_field(rd,Q,b.r0,B);
+    }
+    for (p = 0; p < ndip; p++)
+        Map<VectorXf>(b.res[p],B.rows()) = B.col(p);
+    b.stat = OK;
+}
+
 //=============================================================================================================
 
 int FwdBemModel::compute_forward_meg(MneSourceSpaceOld **spaces,
@@ -3132,6 +3267,7 @@ int FwdBemModel::compute_forward_meg(MneSourceSpaceOld **spaces,
     FwdThreadArg*       one_arg = NULL;
     int                 nproc = QThread::idealThreadCount();
     QStringList         emptyList;
+    bool                batch;              /* Use the batched kernels? */
 
     if (bem_model) {
         /*
@@ -3205,6 +3341,10 @@ int FwdBemModel::compute_forward_meg(MneSourceSpaceOld **spaces,
         field_grad  = FwdCompData::fwd_comp_field_grad;
         client      = comp;
     }
+    /*
+     * The batched kernels apply if no compensation is in effect
+     */
+    batch = !bDoGrad && (!comp->comp_coils || comp->comp_coils->ncoil <= 0 || !comp->set || !comp->set->current);
     /*
        * Count the sources
        */
@@ -3241,7 +3381,46 @@ int FwdBemModel::compute_forward_meg(MneSourceSpaceOld **spaces,
     if (nproc < 2)
         use_threads = false;
 
-    if (use_threads) {
+    if (batch) {
+        FwdCoilSetSoA       soa(*coils);
+        QVector<float*>     rr,nn;
+        QList<megBatchRec>  blocks;
+        int                 j;
+        /*
+         * Collect the sources in the order of the solution rows and split them into blocks
+         */
+        for (k = 0; k < nspace; k++)
+            for (j = 0; j < spaces[k]->np; j++)
+                if (spaces[k]->inuse[j]) {
+                    rr.append(spaces[k]->rr[j]);
+                    nn.append(spaces[k]->nn[j]);
+                }
+        for (k = 0; k < nsource; k += MEG_BATCH_SIZE) {
+            megBatchRec b;
+            b.coils     = coils;
+            b.soa       = &soa;
+            b.bem_model = bem_model;
+            b.r0        = r0 ? r0->data() : NULL;
+            b.fixed_ori = fixed_ori;
+            b.rr        = rr.data() + k;
+            b.nn        = nn.data() + k;
+            b.res       = fixed_ori ? res + k : res + 3*k;
+            b.nsrc      = (k + MEG_BATCH_SIZE > nsource) ? nsource - k : MEG_BATCH_SIZE;
+            b.stat      = FAIL;
+            blocks.append(b);
+        }
+        fprintf(stderr,"Computing MEG at %d source locations (%s orientations, %d blocks%s)...",
+                nsource,fixed_ori ? "fixed" : "free",blocks.size(),use_threads ? "" : ", no threads");
+        if (use_threads)
+            QtConcurrent::blockingMap(blocks, meg_fwd_batch);
+        else
+            for (k = 0; k < blocks.size(); k++)
+                meg_fwd_batch(blocks[k]);
+        for (k = 0; k < blocks.size(); k++)
+            if (blocks[k].stat != OK)
+                goto bad;
+    }
+    else if (use_threads) {
         int            nthread  = (fixed_ori || vec_field || nproc < 6) ? nspace : 3*nspace;
         QList <FwdThreadArg*> args; //fwdThreadArg   *args    = MALLOC_40(nthread,fwdThreadArg);
         int            stat;
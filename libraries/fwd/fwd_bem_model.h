@@ -100,6 +100,7 @@ namespace FWDLIB
 //=============================================================================================================
 
 class FwdEegSphereModel;
+class FwdCoilSetSoA;
 
 //=============================================================================================================
 /**
@@ -170,11 +171,12 @@ public:
 
     static FwdBemModel* fwd_bem_load_surfaces(const QString& name,
                                       int  *kinds,
-                                      int  nkind);
+                                      int  nkind,
+                                      bool use_geometry_cache = false);   /* Store the geometry information next to the file and reuse it */
 
-    static FwdBemModel* fwd_bem_load_homog_surface(const QString& name);
+    static FwdBemModel* fwd_bem_load_homog_surface(const QString& name, bool use_geometry_cache = false);
 
-    static FwdBemModel* fwd_bem_load_three_layer_surfaces(const QString& name);
+    static FwdBemModel* fwd_bem_load_three_layer_surfaces(const QString& name, bool use_geometry_cache = false);
 
     static int fwd_bem_load_solution(const QString& name, int bem_method, FwdBemModel* m);
 
@@ -430,6 +432,28 @@ public:
                    float        zgrad[],
                    void         *client);
 
+    //=========================================================================================================
+    /**
+     * Batched version of fwd_bem_field. The infinite-medium potentials of all dipoles are collected into one
+     * matrix so that the volume current contribution becomes a single matrix product with the coil-specific
+     * solution. Call fwd_bem_specify_coils first to establish the coil-specific solution matrix.
+     *
+     * @param[in] rd         The dipole locations (ndip x 3).
+     * @param[in] Q          The dipole moments (ndip x 3).
+     * @param[in] coils      The coil definitions.
+     * @param[in] soa        Structure-of-arrays copy of the coil definitions.
+     * @param[out] B         The fields (ncoil x ndip).
+     * @param[in] client     The model.
+     *
+     * @return   OK on success, FAIL otherwise.
+     */
+    static int fwd_bem_field_batch(const Eigen::MatrixX3f& rd,
+                                   const Eigen::MatrixX3f& Q,
+                                   FwdCoilSet* coils,
+                                   const FwdCoilSetSoA& soa,
+                                   Eigen::MatrixXf& B,
+                                   void *client);
+
     //============================= compute_forward.c =============================
 
     static void *meg_eeg_fwd_one_source_space(void *arg);
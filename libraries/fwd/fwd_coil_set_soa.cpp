@@ -0,0 +1,535 @@
+//=============================================================================================================
+/**
+ * @file     fwd_coil_set_soa.cpp
+ * @author   MNE-CPP authors
+ * @since    0.1.8
+ * @date     October, 2026
+ *
+ * @section  LICENSE
+ *
+ * Copyright (C) 2026, MNE-CPP authors. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ * the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+ *       following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ *       the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+ *       to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * @brief    Definition of the FwdCoilSetSoA Class.
+ *
+ */
+
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "fwd_coil_set_soa.h"
+#include "fwd_coil_set.h"
+#include "fwd_coil.h"
+
+#include <cmath>
+
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace Eigen;
+using namespace FWDLIB;
+
+#define MAG_FACTOR_SOA  1e-7f   /* \mu_0/4\pi */
+#define EPS_SOA         1e-5f   /* Points closer to origin than this many meters are considered to be at the origin */
+#define CEPS_SOA        1e-5f
+
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+FwdCoilSetSoA::FwdCoilSetSoA()
+{
+    m_vecFirst = VectorXi::Zero(1);
+}
+
+//=============================================================================================================
+
+FwdCoilSetSoA::FwdCoilSetSoA(const FwdCoilSet& coils)
+{
+    set_coils(coils);
+}
+
+//=============================================================================================================
+
+void FwdCoilSetSoA::set_coils(const FwdCoilSet& coils)
+{
+    int k,j,p;
+    int np = 0;
+
+    for (k = 0; k < coils.ncoil; k++)
+        if (FWD_IS_MEG_COIL(coils.coils[k]->coil_class))
+            np += coils.coils[k]->np;
+
+    m_vecRx.resize(np); m_vecRy.resize(np); m_vecRz.resize(np);
+    m_vecCx.resize(np); m_vecCy.resize(np); m_vecCz.resize(np);
+    m_vecW.resize(np);
+    m_vecFirst.resize(coils.ncoil+1);
+    m_vecIsMeg.resize(coils.ncoil);
+
+    for (k = 0, p = 0; k < coils.ncoil; k++) {
+        const FwdCoil* coil = coils.coils[k];
+        m_vecFirst[k] = p;
+        m_vecIsMeg[k] = FWD_IS_MEG_COIL(coil->coil_class) ? 1 : 0;
+        if (!m_vecIsMeg[k])             /* The electrodes do not take part in the magnetic field computations */
+            continue;
+        for (j = 0; j < coil->np; j++, p++) {
+            m_vecRx[p] = coil->rmag[j][0];
+            m_vecRy[p] = coil->rmag[j][1];
+            m_vecRz[p] = coil->rmag[j][2];
+            m_vecCx[p] = coil->cosmag[j][0];
+            m_vecCy[p] = coil->cosmag[j][1];
+            m_vecCz[p] = coil->cosmag[j][2];
+            m_vecW[p]  = coil->w[j];
+        }
+    }
+    m_vecFirst[coils.ncoil] = p;
+}
+
+//=============================================================================================================
+
+void FwdCoilSetSoA::sum_coils(const VectorXf& contrib,
+                              float scale,
+                              float *col) const
+{
+    const float *c = contrib.data();
+
+    for (int k = 0; k < ncoil(); k++) {
+        if (m_vecIsMeg[k]) {
+            float sum = 0.0f;
+            for (int j = m_vecFirst[k]; j < m_vecFirst[k+1]; j++)
+                sum += c[j];
+            col[k] = scale*sum;
+        }
+    }
+}
+
+//=============================================================================================================
+
+void FwdCoilSetSoA::zero_coils(float *col) const
+{
+    for (int k = 0; k < ncoil(); k++)
+        if (m_vecIsMeg[k])
+            col[k] = 0.0f;
+}
+
+//=============================================================================================================
+
+void FwdCoilSetSoA::sphere_field(const MatrixX3f& rd,
+                                 const MatrixX3f& Q,
+                                 const float *r0,
+                                 MatrixXf& B) const
+{
+    /*
+     * Jukka Sarvas' field computation, see FwdBemModel::fwd_sphere_field for the references.
+     * The per-point branches of the original are replaced by selects so that the point loop vectorizes.
+     */
+    const int ndip = static_cast<int>(rd.rows());
+    const int np   = npoint();
+    const float *rx = m_vecRx.data(), *ry = m_vecRy.data(), *rz = m_vecRz.data();
+    const float *cx = m_vecCx.data(), *cy = m_vecCy.data(), *cz = m_vecCz.data();
+    const float *w  = m_vecW.data();
+
+    VectorXf contrib(np);
+    float *c = contrib.data();
+
+    B.resize(ncoil(),ndip);
+
+    for (int d = 0; d < ndip; d++) {
+        const float dx = rd(d,0) - r0[0];
+        const float dy = rd(d,1) - r0[1];
+        const float dz = rd(d,2) - r0[2];
+
+        if (std::sqrt(dx*dx + dy*dy + dz*dz) <= EPS_SOA) {
+            zero_coils(B.col(d).data());
+            continue;
+        }
+        /*
+         * v = Q x rd
+         */
+        const float vx = Q(d,1)*dz - Q(d,2)*dy;
+        const float vy = Q(d,2)*dx - Q(d,0)*dz;
+        const float vz = Q(d,0)*dy - Q(d,1)*dx;
+
+#pragma omp simd
+        for (int j = 0; j < np; j++) {
+            const float px = rx[j] - r0[0];
+            const float py = ry[j] - r0[1];
+            const float pz = rz[j] - r0[2];
+            const float ax = px - dx;
+            const float ay = py - dy;
+            const float az = pz - dz;
+
+            const float a2  = ax*ax + ay*ay + az*az;
+            const float a   = std::sqrt(a2);
+            const float r2  = px*px + py*py + pz*pz;
+            const float r   = std::sqrt(r2);
+            const float rr0 = px*dx + py*dy + pz*dz;
+            const float ar  = r2 - rr0;
+
+            const bool  ok   = (a > 0.0f) && (r > 0.0f);
+            const float sa   = ok ? a : 1.0f;
+            const float sr   = ok ? r : 1.0f;
+            const bool  use  = ok && (std::fabs(ar/(sa*sr) + 1.0f) > CEPS_SOA);
+
+            const float ar0 = ar/sa;
+            const float ve  = vx*cx[j] + vy*cy[j] + vz*cz[j];
+            const float vr  = vx*px + vy*py + vz*pz;
+            const float re  = px*cx[j] + py*cy[j] + pz*cz[j];
+            const float r0e = dx*cx[j] + dy*cy[j] + dz*cz[j];
+
+            const float F   = sa*(sr*sa + ar);
+            const float gr  = a2/sr + ar0 + 2.0f*(sa + sr);
+            const float g0  = sa + 2.0f*sr + ar0;
+            const float sF  = use ? F : 1.0f;
+
+            c[j] = use ? w[j]*(ve*sF + vr*(g0*r0e - gr*re))/(sF*sF) : 0.0f;
+        }
+        sum_coils(contrib,MAG_FACTOR_SOA,B.col(d).data());
+    }
+}
+
+//=============================================================================================================
+
+void FwdCoilSetSoA::sphere_field_vec(const MatrixX3f& rd,
+                                     const float *r0,
+                                     MatrixXf& B) const
+{
+    const int ndip = static_cast<int>(rd.rows());
+    const int np   = npoint();
+    const float *rx = m_vecRx.data(), *ry = m_vecRy.data(), *rz = m_vecRz.data();
+    const float *cx = m_vecCx.data(), *cy = m_vecCy.data(), *cz = m_vecCz.data();
+    const float *w  = m_vecW.data();
+
+    VectorXf contribX(np), contribY(np), contribZ(np);
+    float *cX = contribX.data(), *cY = contribY.data(), *cZ = contribZ.data();
+
+    B.resize(ncoil(),3*ndip);
+
+    for (int d = 0; d < ndip; d++) {
+        const float dx = rd(d,0) - r0[0];
+        const float dy = rd(d,1) - r0[1];
+        const float dz = rd(d,2) - r0[2];
+
+        if (std::sqrt(dx*dx + dy*dy + dz*dz) < EPS_SOA) {
+            zero_coils(B.col(3*d).data());
+            zero_coils(B.col(3*d+1).data());
+            zero_coils(B.col(3*d+2).data());
+            continue;
+        }
+
+#pragma omp simd
+        for (int j = 0; j < np; j++) {
+            const float px = rx[j] - r0[0];
+            const float py = ry[j] - r0[1];
+            const float pz = rz[j] - r0[2];
+            const float ax = px - dx;
+            const float ay = py - dy;
+            const float az = pz - dz;
+
+            const float a2  = ax*ax + ay*ay + az*az;
+            const float a   = std::sqrt(a2);
+            const float r2  = px*px + py*py + pz*pz;
+            const float r   = std::sqrt(r2);
+            const float rr0 = px*dx + py*dy + pz*dz;
+            const float ar  = r2 - rr0;
+
+            const bool  ok   = (a > 0.0f) && (r > 0.0f);
+            const float sa   = ok ? a : 1.0f;
+            const float sr   = ok ? r : 1.0f;
+            const bool  use  = ok && (std::fabs(ar/(sa*sr) + 1.0f) > CEPS_SOA);
+
+            const float ar0 = ar/sa;
+            const float F   = sa*(sr*sa + ar);
+            const float gr  = a2/sr + ar0 + 2.0f*(sa + sr);
+            const float g0  = sa + 2.0f*sr + ar0;
+            const float sF  = use ? F : 1.0f;
+
+            const float re  = px*cx[j] + py*cy[j] + pz*cz[j];
+            const float r0e = dx*cx[j] + dy*cy[j] + dz*cz[j];
+            /*
+             * v1 = rd x dir, v2 = rd x pos
+             */
+            const float v1x = dy*cz[j] - dz*cy[j];
+            const float v1y = dz*cx[j] - dx*cz[j];
+            const float v1z = dx*cy[j] - dy*cx[j];
+            const float v2x = dy*pz - dz*py;
+            const float v2y = dz*px - dx*pz;
+            const float v2z = dx*py - dy*px;
+
+            const float g   = (g0*r0e - gr*re)/(sF*sF);
+            const float ww  = use ? w[j] : 0.0f;
+
+            cX[j] = ww*(v1x/sF + v2x*g);
+            cY[j] = ww*(v1y/sF + v2y*g);
+            cZ[j] = ww*(v1z/sF + v2z*g);
+        }
+        sum_coils(contribX,MAG_FACTOR_SOA,B.col(3*d).data());
+        sum_coils(contribY,MAG_FACTOR_SOA,B.col(3*d+1).data());
+        sum_coils(contribZ,MAG_FACTOR_SOA,B.col(3*d+2).data());
+    }
+}
+
+//=============================================================================================================
+
+void FwdCoilSetSoA::sphere_field_grad(const MatrixX3f& rd,
+                                      const MatrixX3f& Q,
+                                      const float *r0,
+                                      MatrixXf& B,
+                                      MatrixXf& xgrad,
+                                      MatrixXf& ygrad,
+                                      MatrixXf& zgrad) const
+{
+    const int ndip = static_cast<int>(rd.rows());
+    const int np   = npoint();
+    const float *rx = m_vecRx.data(), *ry = m_vecRy.data(), *rz = m_vecRz.data();
+    const float *cx = m_vecCx.data(), *cy = m_vecCy.data(), *cz = m_vecCz.data();
+    const float *w  = m_vecW.data();
+
+    VectorXf contrib(np), contribX(np), contribY(np), contribZ(np);
+    float *c = contrib.data(), *cX = contribX.data(), *cY = contribY.data(), *cZ = contribZ.data();
+
+    B.resize(ncoil(),ndip);
+    xgrad.resize(ncoil(),ndip);
+    ygrad.resize(ncoil(),ndip);
+    zgrad.resize(ncoil(),ndip);
+
+    for (int d = 0; d < ndip; d++) {
+        const float dx = rd(d,0) - r0[0];
+        const float dy = rd(d,1) - r0[1];
+        const float dz = rd(d,2) - r0[2];
+        const float Qx = Q(d,0), Qy = Q(d,1), Qz = Q(d,2);
+
+        if (std::sqrt(dx*dx + dy*dy + dz*dz) <= EPS_SOA) {
+            zero_coils(B.col(d).data());
+            zero_coils(xgrad.col(d).data());
+            zero_coils(ygrad.col(d).data());
+            zero_coils(zgrad.col(d).data());
+            continue;
+        }
+
+        const float vx = Qy*dz - Qz*dy;
+        const float vy = -Qx*dz + Qz*dx;
+        const float vz = Qx*dy - Qy*dx;
+
+#pragma omp simd
+        for (int j = 0; j < np; j++) {
+            const float px = rx[j] - r0[0];
+            const float py = ry[j] - r0[1];
+            const float pz = rz[j] - r0[2];
+            const float ex = cx[j], ey = cy[j], ez = cz[j];
+
+            const float ax = px - dx;
+            const float ay = py - dy;
+            const float az = pz - dz;
+
+            const float a2  = ax*ax + ay*ay + az*az;
+            const float a   = std::sqrt(a2);
+            const float r2  = px*px + py*py + pz*pz;
+            const float r   = std::sqrt(r2);
+            const float rr0 = px*dx + py*dy + pz*dz;
+            const float ar  = (r2 - rr0)/a;
+
+            const float ve  = vx*ex + vy*ey + vz*ez;
+            const float vr  = vx*px + vy*py + vz*pz;
+            const float re  = px*ex + py*ey + pz*ez;
+            const float r0e = dx*ex + dy*ey + dz*ez;
+            /*
+             * eQ = dir x Q, rQ = pos x Q
+             */
+            const float eQx = ey*Qz - ez*Qy;
+            const float eQy = -ex*Qz + ez*Qx;
+            const float eQz = ex*Qy - ey*Qx;
+            const float rQx = py*Qz - pz*Qy;
+            const float rQy = -px*Qz + pz*Qx;
+            const float rQz = px*Qy - py*Qx;
+
+            const float F   = a*(r*a + r2 - rr0);
+            const float F2  = F*F;
+            const float gr  = a2/r + ar + 2.0f*(a + r);
+            const float g0  = a + 2.0f*r + ar;
+            const float G   = g0*r0e - gr*re;
+
+            const float result = (ve*F + vr*G)/F2;
+            const float huu    = 2.0f + 2.0f*a/r;
+
+            const float gax = -ax/a, gay = -ay/a, gaz = -az/a;
+            const float garx = -(gax*ar + px)/a;
+            const float gary = -(gay*ar + py)/a;
+            const float garz = -(gaz*ar + pz)/a;
+            const float gFFx = gax/a - (r*ax + a*px)/F;
+            const float gFFy = gay/a - (r*ay + a*py)/F;
+            const float gFFz = gaz/a - (r*az + a*pz)/F;
+
+            const float gresx = -2.0f*result*gFFx + (eQx + gFFx*ve)/F +
+                    (rQx*G + vr*((gax + garx)*r0e + g0*ex - (huu*gax + garx)*re))/F2;
+            const float gresy = -2.0f*result*gFFy + (eQy + gFFy*ve)/F +
+                    (rQy*G + vr*((gay + gary)*r0e + g0*ey - (huu*gay + gary)*re))/F2;
+            const float gresz = -2.0f*result*gFFz + (eQz + gFFz*ve)/F +
+                    (rQz*G + vr*((gaz + garz)*r0e + g0*ez - (huu*gaz + garz)*re))/F2;
+
+            c[j]  = w[j]*result;
+            cX[j] = w[j]*gresx;
+            cY[j] = w[j]*gresy;
+            cZ[j] = w[j]*gresz;
+        }
+        sum_coils(contrib,MAG_FACTOR_SOA,B.col(d).data());
+        sum_coils(contribX,MAG_FACTOR_SOA,xgrad.col(d).data());
+        sum_coils(contribY,MAG_FACTOR_SOA,ygrad.col(d).data());
+        sum_coils(contribZ,MAG_FACTOR_SOA,zgrad.col(d).data());
+    }
+}
+
+//=============================================================================================================
+
+void FwdCoilSetSoA::mag_dipole_field(const MatrixX3f& rm,
+                                     const MatrixX3f& M,
+                                     MatrixXf& B) const
+{
+    const int ndip = static_cast<int>(rm.rows());
+    const int np   = npoint();
+    const float *rx = m_vecRx.data(), *ry = m_vecRy.data(), *rz = m_vecRz.data();
+    const float *cx = m_vecCx.data(), *cy = m_vecCy.data(), *cz = m_vecCz.data();
+    const float *w  = m_vecW.data();
+
+    VectorXf contrib(np);
+    float *c = contrib.data();
+
+    B.resize(ncoil(),ndip);
+
+    for (int d = 0; d < ndip; d++) {
+        const float mx = rm(d,0), my = rm(d,1), mz = rm(d,2);
+        const float Mx = M(d,0), My = M(d,1), Mz = M(d,2);
+
+#pragma omp simd
+        for (int j = 0; j < np; j++) {
+            const float diffx = rx[j] - mx;
+            const float diffy = ry[j] - my;
+            const float diffz = rz[j] - mz;
+            const float dist2 = diffx*diffx + diffy*diffy + diffz*diffz;
+            const float dist  = std::sqrt(dist2);
+            const bool  use   = dist > EPS_SOA;
+            const float sd    = use ? dist : 1.0f;
+            const float dist5 = sd*sd*sd*sd*sd;
+
+            const float Mdiff = Mx*diffx + My*diffy + Mz*diffz;
+            const float diffe = diffx*cx[j] + diffy*cy[j] + diffz*cz[j];
+            const float Me    = Mx*cx[j] + My*cy[j] + Mz*cz[j];
+
+            c[j] = use ? w[j]*(3.0f*Mdiff*diffe - dist2*Me)/dist5 : 0.0f;
+        }
+        sum_coils(contrib,MAG_FACTOR_SOA,B.col(d).data());
+    }
+}
+
+//=============================================================================================================
+
+void FwdCoilSetSoA::mag_dipole_field_vec(const MatrixX3f& rm,
+                                         MatrixXf& B) const
+{
+    const int ndip = static_cast<int>(rm.rows());
+    const int np   = npoint();
+    const float *rx = m_vecRx.data(), *ry = m_vecRy.data(), *rz = m_vecRz.data();
+    const float *cx = m_vecCx.data(), *cy = m_vecCy.data(), *cz = m_vecCz.data();
+    const float *w  = m_vecW.data();
+
+    VectorXf contribX(np), contribY(np), contribZ(np);
+    float *cX = contribX.data(), *cY = contribY.data(), *cZ = contribZ.data();
+
+    B.resize(ncoil(),3*ndip);
+
+    for (int d = 0; d < ndip; d++) {
+        const float mx = rm(d,0), my = rm(d,1), mz = rm(d,2);
+
+#pragma omp simd
+        for (int j = 0; j < np; j++) {
+            const float diffx = rx[j] - mx;
+            const float diffy = ry[j] - my;
+            const float diffz = rz[j] - mz;
+            const float dist2 = diffx*diffx + diffy*diffy + diffz*diffz;
+            const float dist  = std::sqrt(dist2);
+            const bool  use   = dist > EPS_SOA;
+            const float sd    = use ? dist : 1.0f;
+            const float dist5 = sd*sd*sd*sd*sd;
+            const float diffe = diffx*cx[j] + diffy*cy[j] + diffz*cz[j];
+            const float ww    = use ? w[j]/dist5 : 0.0f;
+
+            cX[j] = ww*(3.0f*diffx*diffe - dist2*cx[j]);
+            cY[j] = ww*(3.0f*diffy*diffe - dist2*cy[j]);
+            cZ[j] = ww*(3.0f*diffz*diffe - dist2*cz[j]);
+        }
+        sum_coils(contribX,MAG_FACTOR_SOA,B.col(3*d).data());
+        sum_coils(contribY,MAG_FACTOR_SOA,B.col(3*d+1).data());
+        sum_coils(contribZ,MAG_FACTOR_SOA,B.col(3*d+2).data());
+    }
+}
+
+//=============================================================================================================
+
+void FwdCoilSetSoA::bem_inf_field(const MatrixX3f& rd,
+                                  const MatrixX3f& Q,
+                                  MatrixXf& B) const
+{
+    const int ndip = static_cast<int>(rd.rows());
+    const int np   = npoint();
+    const float *rx = m_vecRx.data(), *ry = m_vecRy.data(), *rz = m_vecRz.data();
+    const float *cx = m_vecCx.data(), *cy = m_vecCy.data(), *cz = m_vecCz.data();
+    const float *w  = m_vecW.data();
+
+    VectorXf contrib(np);
+    float *c = contrib.data();
+
+    B.resize(ncoil(),ndip);
+
+    for (int d = 0; d < ndip; d++) {
+        const float dx = rd(d,0), dy = rd(d,1), dz = rd(d,2);
+        const float Qx = Q(d,0), Qy = Q(d,1), Qz = Q(d,2);
+
+#pragma omp simd
+        for (int j = 0; j < np; j++) {
+            const float diffx = rx[j] - dx;
+            const float diffy = ry[j] - dy;
+            const float diffz = rz[j] - dz;
+            const float diff2 = diffx*diffx + diffy*diffy + diffz*diffz;
+            /*
+             * (Q x diff) . dir
+             */
+            const float crossx = Qy*diffz - Qz*diffy;
+            const float crossy = -Qx*diffz + Qz*diffx;
+            const float crossz = Qx*diffy - Qy*diffx;
+
+            c[j] = w[j]*(crossx*cx[j] + crossy*cy[j] + crossz*cz[j])/(diff2*std::sqrt(diff2));
+        }
+        /*
+         * Unlike the other kernels, all rows are written here because the caller adds the volume currents.
+         * The electrodes have no integration points, so their rows are zero.
+         */
+        const float *cc = contrib.data();
+        float *col = B.col(d).data();
+        for (int k = 0; k < ncoil(); k++) {
+            float sum = 0.0f;
+            for (int j = m_vecFirst[k]; j < m_vecFirst[k+1]; j++)
+                sum += cc[j];
+            col[k] = sum;
+        }
+    }
+}
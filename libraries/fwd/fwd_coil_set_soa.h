@@ -0,0 +1,257 @@
+//=============================================================================================================
+/**
+ * @file     fwd_coil_set_soa.h
+ * @author   MNE-CPP authors
+ * @since    0.1.8
+ * @date     October, 2026
+ *
+ * @section  LICENSE
+ *
+ * Copyright (C) 2026, MNE-CPP authors. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ * the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+ *       following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ *       the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+ *       to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * @brief    FwdCoilSetSoA class declaration.
+ *
+ */
+
+#ifndef FWDCOILSETSOA_H
+#define FWDCOILSETSOA_H
+
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "fwd_global.h"
+
+//=============================================================================================================
+// EIGEN INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QSharedPointer>
+
+//=============================================================================================================
+// DEFINE NAMESPACE FWDLIB
+//=============================================================================================================
+
+namespace FWDLIB
+{
+
+//=============================================================================================================
+// FWDLIB FORWARD DECLARATIONS
+//=============================================================================================================
+
+class FwdCoilSet;
+
+//=============================================================================================================
+/**
+ * Flat structure-of-arrays copy of the integration points of a FwdCoilSet. The batched field kernels evaluate
+ * a whole set of dipoles against all integration points in one contiguous loop per dipole, which the compiler
+ * can vectorize, instead of walking the float** arrays of every FwdCoil.
+ *
+ * All results are stored column-wise, i.e. one column per dipole (or per dipole component for the _vec
+ * variants), which is the layout of the gain matrices in MNE. The kernels do not hold any mutable state and
+ * can be called concurrently on the same object.
+ *
+ * Only the MEG coils are copied. EEG electrodes keep their row in the results, but the magnetic field kernels
+ * leave these rows untouched, like FwdBemModel::fwd_sphere_field does. The result matrices are only resized
+ * if their dimensions do not match.
+ *
+ * @brief Structure-of-arrays coil set with batched dipole field kernels.
+ */
+class FWDSHARED_EXPORT FwdCoilSetSoA
+{
+public:
+    typedef QSharedPointer<FwdCoilSetSoA> SPtr;              /**< Shared pointer type for FwdCoilSetSoA. */
+    typedef QSharedPointer<const FwdCoilSetSoA> ConstSPtr;   /**< Const shared pointer type for FwdCoilSetSoA. */
+
+    //=========================================================================================================
+    /**
+     * Constructs an empty coil set.
+     */
+    FwdCoilSetSoA();
+
+    //=========================================================================================================
+    /**
+     * Constructs the flat representation of a coil set.
+     *
+     * @param[in] coils      The coil set to copy the integration points from.
+     */
+    explicit FwdCoilSetSoA(const FwdCoilSet& coils);
+
+    //=========================================================================================================
+    /**
+     * (Re)initializes the flat representation from a coil set.
+     *
+     * @param[in] coils      The coil set to copy the integration points from.
+     */
+    void set_coils(const FwdCoilSet& coils);
+
+    //=========================================================================================================
+    /**
+     * @return The number of coils.
+     */
+    inline int ncoil() const;
+
+    //=========================================================================================================
+    /**
+     * @return The total number of integration points of the MEG coils.
+     */
+    inline int npoint() const;
+
+    //=========================================================================================================
+    /**
+     * Batched version of FwdBemModel::fwd_sphere_field.
+     *
+     * @param[in] rd         The dipole locations (ndip x 3).
+     * @param[in] Q          The dipole moments (ndip x 3).
+     * @param[in] r0         The sphere model origin.
+     * @param[out] B         The fields (ncoil x ndip).
+     */
+    void sphere_field(const Eigen::MatrixX3f& rd,
+                      const Eigen::MatrixX3f& Q,
+                      const float *r0,
+                      Eigen::MatrixXf& B) const;
+
+    //=========================================================================================================
+    /**
+     * Batched version of FwdBemModel::fwd_sphere_field_vec.
+     *
+     * @param[in] rd         The dipole locations (ndip x 3).
+     * @param[in] r0         The sphere model origin.
+     * @param[out] B         The fields of the x, y and z directed dipoles (ncoil x 3*ndip).
+     */
+    void sphere_field_vec(const Eigen::MatrixX3f& rd,
+                          const float *r0,
+                          Eigen::MatrixXf& B) const;
+
+    //=========================================================================================================
+    /**
+     * Batched version of FwdBemModel::fwd_sphere_field_grad.
+     *
+     * @param[in] rd         The dipole locations (ndip x 3).
+     * @param[in] Q          The dipole moments (ndip x 3).
+     * @param[in] r0         The sphere model origin.
+     * @param[out] B         The fields (ncoil x ndip).
+     * @param[out] xgrad     The derivatives of the fields with respect to the x coordinate (ncoil x ndip).
+     * @param[out] ygrad     The derivatives of the fields with respect to the y coordinate (ncoil x ndip).
+     * @param[out] zgrad     The derivatives of the fields with respect to the z coordinate (ncoil x ndip).
+     */
+    void sphere_field_grad(const Eigen::MatrixX3f& rd,
+                           const Eigen::MatrixX3f& Q,
+                           const float *r0,
+                           Eigen::MatrixXf& B,
+                           Eigen::MatrixXf& xgrad,
+                           Eigen::MatrixXf& ygrad,
+                           Eigen::MatrixXf& zgrad) const;
+
+    //=========================================================================================================
+    /**
+     * Batched version of FwdBemModel::fwd_mag_dipole_field.
+     *
+     * @param[in] rm         The magnetic dipole locations (ndip x 3).
+     * @param[in] M          The magnetic dipole moments (ndip x 3).
+     * @param[out] B         The fields (ncoil x ndip).
+     */
+    void mag_dipole_field(const Eigen::MatrixX3f& rm,
+                          const Eigen::MatrixX3f& M,
+                          Eigen::MatrixXf& B) const;
+
+    //=========================================================================================================
+    /**
+     * Batched version of FwdBemModel::fwd_mag_dipole_field_vec.
+     *
+     * @param[in] rm         The magnetic dipole locations (ndip x 3).
+     * @param[out] B         The fields of the x, y and z directed dipoles (ncoil x 3*ndip).
+     */
+    void mag_dipole_field_vec(const Eigen::MatrixX3f& rm,
+                              Eigen::MatrixXf& B) const;
+
+    //=========================================================================================================
+    /**
+     * Infinite-medium (primary current) magnetic field integrated over the coils, i.e., the batched sum of
+     * FwdBemModel::fwd_bem_inf_field. The result does not include the factor \mu_0/4\pi. Unlike the other
+     * kernels, the rows of the EEG electrodes are set to zero.
+     *
+     * @param[in] rd         The dipole locations (ndip x 3).
+     * @param[in] Q          The dipole moments (ndip x 3).
+     * @param[out] B         The fields (ncoil x ndip).
+     */
+    void bem_inf_field(const Eigen::MatrixX3f& rd,
+                       const Eigen::MatrixX3f& Q,
+                       Eigen::MatrixXf& B) const;
+
+private:
+    //=========================================================================================================
+    /**
+     * Sums the per-point contributions of each MEG coil into one column of the result. The entries of the EEG
+     * electrodes are not changed.
+     *
+     * @param[in] contrib    The weighted per-point contributions.
+     * @param[in] scale      Scaling applied to the sums.
+     * @param[out] col       Pointer to the result column (ncoil values).
+     */
+    void sum_coils(const Eigen::VectorXf& contrib,
+                   float scale,
+                   float *col) const;
+
+    //=========================================================================================================
+    /**
+     * Sets the entries of the MEG coils in one column of the result to zero.
+     *
+     * @param[out] col       Pointer to the result column (ncoil values).
+     */
+    void zero_coils(float *col) const;
+
+    Eigen::VectorXf m_vecRx;        /**< x coordinates of the integration points. */
+    Eigen::VectorXf m_vecRy;        /**< y coordinates of the integration points. */
+    Eigen::VectorXf m_vecRz;        /**< z coordinates of the integration points. */
+    Eigen::VectorXf m_vecCx;        /**< x components of the direction cosines. */
+    Eigen::VectorXf m_vecCy;        /**< y components of the direction cosines. */
+    Eigen::VectorXf m_vecCz;        /**< z components of the direction cosines. */
+    Eigen::VectorXf m_vecW;         /**< The weighting coefficients. */
+    Eigen::VectorXi m_vecFirst;     /**< Index of the first integration point of each coil, ncoil+1 entries. */
+    Eigen::VectorXi m_vecIsMeg;     /**< Whether a coil is a MEG coil (1) or an EEG electrode (0). */
+};
+
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+inline int FwdCoilSetSoA::ncoil() const
+{
+    return static_cast<int>(m_vecIsMeg.size());
+}
+
+//=============================================================================================================
+
+inline int FwdCoilSetSoA::npoint() const
+{
+    return static_cast<int>(m_vecW.size());
+}
+} // NAMESPACE FWDLIB
+
+#endif // FWDCOILSETSOA_H
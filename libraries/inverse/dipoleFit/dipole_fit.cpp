@@ -6,6 +6,8 @@
 
 #include <string.h>
 #include <QScopedPointer>
+#include <QThread>
+#include <QtConcurrent>
 
 using namespace INVERSELIB;
 using namespace MNELIB;
@@ -48,6 +50,8 @@ using namespace FWDLIB;
 
 #define EPS_VALUES 0.05
 
+#define FIT_BATCH 1000          /* How many time points are collected for one parallel pass */
+
 //=============================================================================================================
 // STATIC DEFINITIONS ToDo make members
 //=============================================================================================================
@@ -546,6 +550,76 @@ int mne_get_values_from_data_ch (float time,      /* Interesting time point */
     return (0);
 }
 
+//=============================================================================================================
+// Parallel fitting of the time points
+//=============================================================================================================
+
+typedef struct {
+    DipoleFitData* fit;         /* The original fitting data, duplicated for each chunk */
+    GuessData*     guess;       /* The initial guesses (read only) */
+    float          *times;      /* Times of the points in this chunk */
+    float          **B;         /* The data vectors of the points */
+    int            *ok;         /* Was the fit successful? */
+    ECD            *dips;       /* The results */
+    int            n;           /* Number of points in this chunk */
+} *fitChunk,fitChunkRec;
+
+static void fit_chunk(fitChunkRec& chunk)
+{
+    DipoleFitData* fit = DipoleFitData::create_multi_thread_duplicate(chunk.fit);
+
+    for (int k = 0; k < chunk.n; k++)
+        chunk.ok[k] = DipoleFitData::fit_one(fit,chunk.guess,chunk.times[k],chunk.B[k],FALSE,chunk.dips[k]);
+    DipoleFitData::free_multi_thread_duplicate(fit);
+}
+
+static void fit_batch(DipoleFitData* fit, GuessData* guess, float *times, float **B, int ntime, int *ok, ECD *dips)
+/*
+ * Fit a batch of time points. The points are split into contiguous chunks which are
+ * fitted concurrently; the results end up in the same order as the input.
+ */
+{
+    int nchunk = 4*QThread::idealThreadCount();
+    int nper;
+
+    if (nchunk > ntime)
+        nchunk = ntime;
+    if (nchunk < 1)
+        return;
+    nper = ntime/nchunk + (ntime % nchunk ? 1 : 0);
+
+    QList<fitChunkRec> chunks;
+    for (int start = 0; start < ntime; start += nper) {
+        fitChunkRec chunk;
+        chunk.fit   = fit;
+        chunk.guess = guess;
+        chunk.times = times + start;
+        chunk.B     = B + start;
+        chunk.ok    = ok + start;
+        chunk.dips  = dips + start;
+        chunk.n     = (start + nper > ntime) ? ntime - start : nper;
+        chunks.append(chunk);
+    }
+    QtConcurrent::blockingMap(chunks, fit_chunk);
+}
+
+static void report_batch(float *times, int *ok, ECD *dips, int ntime, int verbose, int report_interval, ECDSet& set)
+{
+    for (int k = 0; k < ntime; k++) {
+        if (!ok[k])
+            printf("t = %7.1f ms : %s\n",1000*times[k],"error (tbd: catch)");
+        else {
+            set.addEcd(dips[k]);
+            if (verbose)
+                dips[k].print(stdout);
+            else {
+                if (set.size() % report_interval == 0)
+                    fprintf(stderr,"%d..",set.size());
+            }
+        }
+    }
+}
+
 //=============================================================================================================
 // DEFINE MEMBER METHODS
 //=============================================================================================================
@@ -590,10 +664,12 @@ ECDSet DipoleFit::calculateFit() const
                                                             settings->diagnoise,
                                                             settings->projnames,
                                                             settings->include_meg,
-                                                            settings->include_eeg)) == NULL)
+                                                            settings->include_eeg,
+                                                            settings->use_geometry_cache)) == NULL)
         goto out;
 
     fit_data->fit_mag_dipoles = settings->fit_mag_dipoles;
+    fit_data->fit_lm          = settings->fit_lm;
     if (settings->is_raw) {
         int c;
         float t1,t2;
@@ -662,7 +738,8 @@ ECDSet DipoleFit::calculateFit() const
     printf("\n---- Computing the forward solution for the guesses...\n\n");
     guess.reset(new GuessData( settings->guessname,
                                settings->guess_surfname,
-                               settings->guess_mindist, settings->guess_exclude, settings->guess_grid, fit_data));
+                               settings->guess_mindist, settings->guess_exclude, settings->guess_grid, fit_data,
+                               settings->guess_cachename));
     if (guess.isNull())
         goto out;
 
@@ -670,11 +747,11 @@ ECDSet DipoleFit::calculateFit() const
              1000*settings->tmin,1000*settings->tmax,1000*settings->tstep,1000*settings->integ);
 
     if (raw) {
-        if (fit_dipoles_raw(settings->measname,raw,sel,fit_data,guess.take(),settings->tmin,settings->tmax,settings->tstep,settings->integ,settings->verbose) == FAIL)
+        if (fit_dipoles_raw(settings->measname,raw,sel,fit_data,guess.take(),settings->tmin,settings->tmax,settings->tstep,settings->integ,settings->verbose,settings->use_threads) == FAIL)
             goto out;
     }
     else {
-        if (fit_dipoles(settings->measname,data,fit_data,guess.take(),settings->tmin,settings->tmax,settings->tstep,settings->integ,settings->verbose,set) == FAIL)
+        if (fit_dipoles(settings->measname,data,fit_data,guess.take(),settings->tmin,settings->tmax,settings->tstep,settings->integ,settings->verbose,set,settings->use_threads) == FAIL)
             goto out;
     }
     printf("%d dipoles fitted\n",set.size());
@@ -686,7 +763,7 @@ out : {
 
 //=============================================================================================================
 
-int DipoleFit::fit_dipoles( const QString& dataname, MneMeasData* data, DipoleFitData* fit, GuessData* guess, float tmin, float tmax, float tstep, float integ, int verbose, ECDSet& p_set)
+int DipoleFit::fit_dipoles( const QString& dataname, MneMeasData* data, DipoleFitData* fit, GuessData* guess, float tmin, float tmax, float tstep, float integ, int verbose, ECDSet& p_set, bool use_threads)
 {
     float *one = MALLOC(data->nchan,float);
     float time;
@@ -694,19 +771,43 @@ int DipoleFit::fit_dipoles( const QString& dataname, MneMeasData* data, DipoleFi
     ECD   dip;
     int   s;
     int   report_interval = 10;
+    float **batch   = NULL;
+    float *times    = NULL;
+    int   *ok       = NULL;
+    ECD   *dips     = NULL;
+    int   nbatch    = 0;
 
     set.dataname = dataname;
 
+    if (use_threads) {
+        batch = ALLOC_CMATRIX(FIT_BATCH,data->nchan);
+        times = MALLOC(FIT_BATCH,float);
+        ok    = MALLOC(FIT_BATCH,int);
+        dips  = new ECD[FIT_BATCH];
+    }
+
     fprintf(stderr,"Fitting...%c",verbose ? '\n' : '\0');
     for (s = 0, time = tmin; time < tmax; s++, time = tmin  + s*tstep) {
         /*
      * Pick the data point
      */
         if (mne_get_values_from_data(time,integ,data->current->data,data->current->np,data->nchan,data->current->tmin,
-                                     1.0/data->current->tstep,FALSE,one) == FAIL) {
+                                     1.0/data->current->tstep,FALSE,use_threads ? batch[nbatch] : one) == FAIL) {
             fprintf(stderr,"Cannot pick time: %7.1f ms\n",1000*time);
             continue;
         }
+        if (use_threads) {
+            /*
+       * Collect the points and fit them all at once
+       */
+            times[nbatch++] = time;
+            if (nbatch == FIT_BATCH) {
+                fit_batch(fit,guess,times,batch,nbatch,ok,dips);
+                report_batch(times,ok,dips,nbatch,verbose,report_interval,set);
+                nbatch = 0;
+            }
+            continue;
+        }
 
         if (!DipoleFitData::fit_one(fit,guess,time,one,verbose,dip))
             printf("t = %7.1f ms : %s\n",1000*time,"error (tbd: catch)");
@@ -720,8 +821,16 @@ int DipoleFit::fit_dipoles( const QString& dataname, MneMeasData* data, DipoleFi
             }
         }
     }
+    if (nbatch > 0) {
+        fit_batch(fit,guess,times,batch,nbatch,ok,dips);
+        report_batch(times,ok,dips,nbatch,verbose,report_interval,set);
+    }
     if (!verbose)
         fprintf(stderr,"[done]\n");
+    FREE_CMATRIX(batch);
+    FREE(times);
+    FREE(ok);
+    delete [] dips;
     FREE(one);
     p_set = set;
     return OK;
@@ -729,7 +838,7 @@ int DipoleFit::fit_dipoles( const QString& dataname, MneMeasData* data, DipoleFi
 
 //=============================================================================================================
 
-int DipoleFit::fit_dipoles_raw(const QString& dataname, MneRawData* raw, mneChSelection sel, DipoleFitData* fit, GuessData* guess, float tmin, float tmax, float tstep, float integ, int verbose, ECDSet& p_set)
+int DipoleFit::fit_dipoles_raw(const QString& dataname, MneRawData* raw, mneChSelection sel, DipoleFitData* fit, GuessData* guess, float tmin, float tmax, float tstep, float integ, int verbose, ECDSet& p_set, bool use_threads)
 {
     float *one    = MALLOC(sel->nchan,float);
     float sfreq   = raw->info->sfreq;
@@ -745,9 +854,21 @@ int DipoleFit::fit_dipoles_raw(const QString& dataname, MneRawData* raw, mneChSe
     ECD    dip;
     ECDSet set;
     int    report_interval = 10;
+    float  **batch  = NULL;
+    float  *times   = NULL;
+    int    *ok      = NULL;
+    ECD    *dips    = NULL;
+    int    nbatch   = 0;
 
     set.dataname = dataname;
 
+    if (use_threads) {
+        batch = ALLOC_CMATRIX(FIT_BATCH,sel->nchan);
+        times = MALLOC(FIT_BATCH,float);
+        ok    = MALLOC(FIT_BATCH,int);
+        dips  = new ECD[FIT_BATCH];
+    }
+
     /*
    * Load the initial data segment
    */
@@ -767,10 +888,22 @@ int DipoleFit::fit_dipoles_raw(const QString& dataname, MneRawData* raw, mneChSe
         /*
      * Get the values
      */
-        if (mne_get_values_from_data_ch (time,integ,data,length,sel->nchan,stime,sfreq,FALSE,one) == FAIL) {
+        if (mne_get_values_from_data_ch (time,integ,data,length,sel->nchan,stime,sfreq,FALSE,use_threads ? batch[nbatch] : one) == FAIL) {
             fprintf(stderr,"Cannot pick time: %8.3f s\n",time);
             continue;
         }
+        if (use_threads) {
+            /*
+       * The values are copied out of the segment so that the fits can run after the segment has moved on
+       */
+            times[nbatch++] = time;
+            if (nbatch == FIT_BATCH) {
+                fit_batch(fit,guess,times,batch,nbatch,ok,dips);
+                report_batch(times,ok,dips,nbatch,verbose,report_interval,set);
+                nbatch = 0;
+            }
+            continue;
+        }
         /*
      * Fit
      */
@@ -786,15 +919,27 @@ int DipoleFit::fit_dipoles_raw(const QString& dataname, MneRawData* raw, mneChSe
             }
         }
     }
+    if (nbatch > 0) {
+        fit_batch(fit,guess,times,batch,nbatch,ok,dips);
+        report_batch(times,ok,dips,nbatch,verbose,report_interval,set);
+    }
     if (!verbose)
         fprintf(stderr,"[done]\n");
     FREE_CMATRIX(data);
+    FREE_CMATRIX(batch);
+    FREE(times);
+    FREE(ok);
+    delete [] dips;
     FREE(one);
     p_set = set;
     return OK;
 
 bad : {
         FREE_CMATRIX(data);
+        FREE_CMATRIX(batch);
+        FREE(times);
+        FREE(ok);
+        delete [] dips;
         FREE(one);
         return FAIL;
     }
@@ -802,8 +947,8 @@ bad : {
 
 //=============================================================================================================
 
-int DipoleFit::fit_dipoles_raw(const QString& dataname, MneRawData* raw, mneChSelection sel, DipoleFitData* fit, GuessData* guess, float tmin, float tmax, float tstep, float integ, int verbose)
+int DipoleFit::fit_dipoles_raw(const QString& dataname, MneRawData* raw, mneChSelection sel, DipoleFitData* fit, GuessData* guess, float tmin, float tmax, float tstep, float integ, int verbose, bool use_threads)
 {
     ECDSet set;
-    return fit_dipoles_raw(dataname, raw, sel, fit, guess, tmin, tmax, tstep, integ, verbose, set);
+    return fit_dipoles_raw(dataname, raw, sel, fit, guess, tmin, tmax, tstep, integ, verbose, set, use_threads);
 }
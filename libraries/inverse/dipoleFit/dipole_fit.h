@@ -112,10 +112,11 @@ public:
      * @param[in] integ      Integration time
      * @param[in] verbose    Verbose output?
      * @param[out] p_set     the fitted ECD Set
+     * @param[in] use_threads    Fit the time points concurrently (the results are identical to the serial fit)
      *
      * @return true when successful
      */
-    static int fit_dipoles( const QString& dataname, MneMeasData* data, DipoleFitData* fit, GuessData* guess, float tmin, float tmax, float tstep, float integ, int verbose, ECDSet& p_set);
+    static int fit_dipoles( const QString& dataname, MneMeasData* data, DipoleFitData* fit, GuessData* guess, float tmin, float tmax, float tstep, float integ, int verbose, ECDSet& p_set, bool use_threads = false);
 
     //=========================================================================================================
     /**
@@ -134,10 +135,11 @@ public:
      * @param[in] integ      Integration time
      * @param[in] verbose    Verbose output?
      * @param[out] p_set     Return all results here. Warning: for large data files this may take a lot of memory
+     * @param[in] use_threads    Fit the time points concurrently (the results are identical to the serial fit)
      *
      * @return true when successful
      */
-    static int fit_dipoles_raw(const QString& dataname, MNELIB::MneRawData* raw, MNELIB::mneChSelection sel, DipoleFitData* fit, GuessData* guess, float tmin, float tmax, float tstep, float integ, int verbose, ECDSet& p_set);
+    static int fit_dipoles_raw(const QString& dataname, MNELIB::MneRawData* raw, MNELIB::mneChSelection sel, DipoleFitData* fit, GuessData* guess, float tmin, float tmax, float tstep, float integ, int verbose, ECDSet& p_set, bool use_threads = false);
 
     //=========================================================================================================
     /**
@@ -155,10 +157,11 @@ public:
      * @param[in] tstep      Time step to use
      * @param[in] integ      Integration time
      * @param[in] verbose    Verbose output?
+     * @param[in] use_threads    Fit the time points concurrently (the results are identical to the serial fit)
      *
      * @return true when successful
      */
-    static int fit_dipoles_raw(const QString& dataname, MNELIB::MneRawData* raw, MNELIB::mneChSelection sel, DipoleFitData* fit, GuessData* guess, float tmin, float tmax, float tstep, float integ, int verbose);
+    static int fit_dipoles_raw(const QString& dataname, MNELIB::MneRawData* raw, MNELIB::mneChSelection sel, DipoleFitData* fit, GuessData* guess, float tmin, float tmax, float tstep, float integ, int verbose, bool use_threads = false);
 
 private:
     DipoleFitSettings* settings;
@@ -14,6 +14,7 @@
 #include <mne/c/mne_surface_old.h>
 
 #include <fwd/fwd_comp_data.h>
+#include <mne/c/mne_ctf_comp_data_set.h>
 
 #include <Eigen/Dense>
 
@@ -1324,6 +1325,8 @@ static dipoleFitFuncs new_dipole_fit_funcs()
     f->meg_client_free = NULL;
     f->eeg_client      = NULL;
     f->eeg_client_free = NULL;
+    f->meg_field_grad  = NULL;
+    f->eeg_pot_grad    = NULL;
 
     return f;
 }
@@ -3340,6 +3343,7 @@ DipoleFitData::DipoleFitData()
 , neeg (0)
 , ch_names (NULL)
 , pick (NULL)
+, use_geometry_cache (false)
 , bem_model (NULL)
 , eeg_model (NULL)
 , fixed_noise (FALSE)
@@ -3355,6 +3359,7 @@ DipoleFitData::DipoleFitData()
 , funcs (NULL)
 , column_norm (COLUMN_NORM_NONE)
 , fit_mag_dipoles (FALSE)
+, fit_lm (FALSE)
 {
     r0[0] = 0.0f;
     r0[1] = 0.0f;
@@ -3419,12 +3424,12 @@ int DipoleFitData::setup_forward_model(DipoleFitData *d, MneCTFCompDataSet* comp
 
         printf("\nSetting up the BEM model using %s...\n",d->bemname.toUtf8().constData());
         printf("\nLoading surfaces...\n");
-        d->bem_model = FwdBemModel::fwd_bem_load_three_layer_surfaces(d->bemname);
+        d->bem_model = FwdBemModel::fwd_bem_load_three_layer_surfaces(d->bemname,d->use_geometry_cache);
         if (d->bem_model) {
             printf("Three-layer model surfaces loaded.\n");
         }
         else {
-            d->bem_model = FwdBemModel::fwd_bem_load_homog_surface(d->bemname);
+            d->bem_model = FwdBemModel::fwd_bem_load_homog_surface(d->bemname,d->use_geometry_cache);
             if (!d->bem_model)
                 goto out;
             printf("Homogeneous model surface loaded.\n");
@@ -3465,7 +3470,7 @@ int DipoleFitData::setup_forward_model(DipoleFitData *d, MneCTFCompDataSet* comp
            * It works the same way independent of whether or not the compensation is in effect
            */
             comp = FwdCompData::fwd_make_comp_data(comp_data,d->meg_coils,comp_coils,
-                                      FwdBemModel::fwd_bem_field,NULL,NULL,d->bem_model,NULL);
+                                      FwdBemModel::fwd_bem_field,NULL,FwdBemModel::fwd_bem_field_grad,d->bem_model,NULL);
             if (!comp)
                 goto out;
             printf("Compensation setup done.\n");
@@ -3479,6 +3484,7 @@ int DipoleFitData::setup_forward_model(DipoleFitData *d, MneCTFCompDataSet* comp
 
             f->meg_field       = FwdCompData::fwd_comp_field;
             f->meg_vec_field   = NULL;
+            f->meg_field_grad  = FwdCompData::fwd_comp_field_grad;
             f->meg_client      = comp;
             f->meg_client_free = FwdCompData::fwd_free_comp_data;
         }
@@ -3487,9 +3493,10 @@ int DipoleFitData::setup_forward_model(DipoleFitData *d, MneCTFCompDataSet* comp
             if (FwdBemModel::fwd_bem_specify_els(d->bem_model,d->eeg_els) == FAIL)
                 goto out;
             printf("[done]\n");
-            f->eeg_pot     = FwdBemModel::fwd_bem_pot_els;
-            f->eeg_vec_pot = NULL;
-            f->eeg_client  = d->bem_model;
+            f->eeg_pot      = FwdBemModel::fwd_bem_pot_els;
+            f->eeg_vec_pot  = NULL;
+            f->eeg_pot_grad = FwdBemModel::fwd_bem_pot_grad_els;
+            f->eeg_client   = d->bem_model;
         }
     }
     if (d->neeg > 0 && !d->eeg_model) {
@@ -3499,9 +3506,10 @@ int DipoleFitData::setup_forward_model(DipoleFitData *d, MneCTFCompDataSet* comp
     d->sphere_funcs = f = new_dipole_fit_funcs();
     if (d->neeg > 0) {
         VEC_COPY_3(d->eeg_model->r0,d->r0);
-        f->eeg_pot     = FwdEegSphereModel::fwd_eeg_spherepot_coil;
-        f->eeg_vec_pot = FwdEegSphereModel::fwd_eeg_spherepot_coil_vec;
-        f->eeg_client  = d->eeg_model;
+        f->eeg_pot      = FwdEegSphereModel::fwd_eeg_spherepot_coil;
+        f->eeg_vec_pot  = FwdEegSphereModel::fwd_eeg_spherepot_coil_vec;
+        f->eeg_pot_grad = FwdEegSphereModel::fwd_eeg_spherepot_grad_coil;
+        f->eeg_client   = d->eeg_model;
     }
     if (d->nmeg > 0) {
         /*
@@ -3511,12 +3519,13 @@ int DipoleFitData::setup_forward_model(DipoleFitData *d, MneCTFCompDataSet* comp
         comp = FwdCompData::fwd_make_comp_data(comp_data,d->meg_coils,comp_coils,
                                   FwdBemModel::fwd_sphere_field,
                                   FwdBemModel::fwd_sphere_field_vec,
-                                  NULL,
+                                  FwdBemModel::fwd_sphere_field_grad,
                                   d->r0,NULL);
         if (!comp)
             goto out;
         f->meg_field       = FwdCompData::fwd_comp_field;
         f->meg_vec_field   = FwdCompData::fwd_comp_field_vec;
+        f->meg_field_grad  = FwdCompData::fwd_comp_field_grad;
         f->meg_client      = comp;
         f->meg_client_free = FwdCompData::fwd_free_comp_data;
     }
@@ -3873,7 +3882,8 @@ DipoleFitData *DipoleFitData::setup_dipole_fit_data(const QString &mriname,
                                                     int diagnoise,
                                                     const QList<QString> &projnames,
                                                     int include_meg,
-                                                    int include_eeg)              /**< Include EEG in the fitting? */
+                                                    int include_eeg,              /**< Include EEG in the fitting? */
+                                                    bool use_geometry_cache)
 /*
           * Background work for modelling
           */
@@ -4006,6 +4016,7 @@ DipoleFitData *DipoleFitData::setup_dipole_fit_data(const QString &mriname,
        * Forward model setup
        */
     res->bemname   = bemname;
+    res->use_geometry_cache = use_geometry_cache;
     if (r0) {
         res->r0[0]     = (*r0)[0];
         res->r0[1]     = (*r0)[1];
@@ -4493,6 +4504,136 @@ static int fit_Q(DipoleFitData* fit,	     /* The fit data */
     return OK;
 }
 
+/*
+ * Levenberg-Marquardt fitting of the dipole position
+ */
+
+#define LM_LAMBDA_INIT  1e-3
+#define LM_LAMBDA_MAX   1e10
+#define LM_MAX_STEP     1e-2        /* Longest allowed step (m), same as the size of the initial simplex */
+
+static int lm_minimize(DipoleFitData* fit,          /* The fit data, fit->user has been set up for fit_eval */
+                       float         *rd,           /* Initial dipole position on input, the result on output */
+                       float         ftol,          /* Relative convergence tolerance of the residual */
+                       float         stol,          /* If the dipole moves less than this, we have converged */
+                       int           max_eval,      /* Limit for forward evaluations (including gradients) */
+                       int           *neval,        /* Number of forward evaluations */
+                       float         *final_val,    /* The residual sum of squares at the result */
+                       int           report)        /* Report the iterations? */
+/*
+ * Minimize the residual sum of squares computed by fit_eval with the Levenberg-Marquardt method.
+ * The dipole moment is eliminated (variable projection) and the Jacobian is formed from the
+ * analytic derivatives of the field of the best-fitting dipole at the present location
+ * (Kaufman's approximation).
+ *
+ * The iteration stops when an accepted step is shorter than stol or reduces the residual
+ * by a relative amount less than ftol.
+ */
+{
+    fitDipUser     user   = (fitDipUser)fit->user;
+    int            nch    = fit->nmeg+fit->neeg;
+    float          *field = MALLOC_3(nch,float);
+    float          *resid = MALLOC_3(nch,float);
+    float          **grad = ALLOC_CMATRIX_3(3,nch);
+    float          Q[3],coeff[3],rd_try[3];
+    float          val,val_try,step,one;
+    double         lambda = LM_LAMBDA_INIT;
+    DipoleForward* fwd;
+    Eigen::Matrix3d JTJ,A;
+    Eigen::Vector3d JTr,delta;
+    int            ncomp,c,p,k,loop;
+    int            result = FAIL;
+
+    val = fit_eval(rd,3,fit);
+    *neval = 1;
+    for (loop = 1; ; loop++) {
+        if (*neval >= max_eval) {
+            printf("Maximum number of evaluations exceeded.");
+            break;
+        }
+        /*
+         * The best-fitting dipole moment at the present location.
+         * fit_eval has left the SVD of the forward solution here
+         */
+        fwd   = user->fwd;
+        ncomp = fwd->sing[2]/fwd->sing[0] > user->limit ? 3 : 2;
+        Q[0] = Q[1] = Q[2] = 0.0;
+        for (c = 0; c < ncomp; c++) {
+            coeff[c] = mne_dot_vectors_3(fwd->uu[c],user->B,nch);
+            mne_add_scaled_vector_to_3(fwd->vv[c],coeff[c]/fwd->sing[c],Q,3);
+        }
+        for (c = 0; c < 3; c++)
+            Q[c] = fwd->scales[c]*Q[c];
+        /*
+         * Residual and the derivatives of the model projected onto the orthogonal complement of the
+         * forward solution. The Jacobian of the residual is the negative of the latter.
+         */
+        for (k = 0; k < nch; k++)
+            resid[k] = user->B[k];
+        for (c = 0; c < ncomp; c++)
+            mne_add_scaled_vector_to_3(fwd->uu[c],-coeff[c],resid,nch);
+        if (DipoleFitData::compute_dipole_field_grad(fit,rd,Q,TRUE,field,grad) == FAIL)
+            goto out;
+        (*neval)++;
+        for (p = 0; p < 3; p++)
+            for (c = 0; c < ncomp; c++) {
+                one = mne_dot_vectors_3(fwd->uu[c],grad[p],nch);
+                mne_add_scaled_vector_to_3(fwd->uu[c],-one,grad[p],nch);
+            }
+        for (p = 0; p < 3; p++) {
+            JTr[p] = -mne_dot_vectors_3(grad[p],resid,nch);
+            for (k = 0; k <= p; k++)
+                JTJ(p,k) = JTJ(k,p) = mne_dot_vectors_3(grad[p],grad[k],nch);
+        }
+        /*
+         * Increase the damping until the residual decreases
+         */
+        for (;;) {
+            A = JTJ;
+            for (p = 0; p < 3; p++)
+                A(p,p) = (1.0 + lambda)*A(p,p);
+            delta = A.ldlt().solve(-JTr);
+            if (delta.norm() > LM_MAX_STEP)
+                delta *= LM_MAX_STEP/delta.norm();
+            for (p = 0; p < 3; p++)
+                rd_try[p] = rd[p] + delta[p];
+            val_try = fit_eval(rd_try,3,fit);
+            (*neval)++;
+            if (val_try < val)
+                break;
+            lambda = 10*lambda;
+            if (lambda > LM_LAMBDA_MAX || *neval >= max_eval)
+                break;
+        }
+        if (val_try >= val) {
+            /*
+             * No further improvement is possible
+             */
+            result = OK;
+            break;
+        }
+        step = delta.norm();
+        one  = 2.0*(val-val_try)/(val+val_try);
+        VEC_COPY_3(rd,rd_try);
+        val    = val_try;
+        lambda = lambda/10.0;
+        if (report)
+            report_func(loop,rd,3,val,val,step);
+        if (step < stol || one < ftol) {
+            result = OK;
+            break;
+        }
+    }
+
+out : {
+        *final_val = val;
+        FREE_3(field);
+        FREE_3(resid);
+        FREE_CMATRIX_3(grad);
+        return result;
+    }
+}
+
 static float rtol(float *vals,int nval)
 
 {
@@ -4671,6 +4812,7 @@ bool DipoleFitData::fit_one(DipoleFitData* fit,	            /* Precomputed fitti
     float  limit           = 0.2;	               /* (pseudo) radial component omission limit */
     float  size            = 1e-2;	       /* Size of the initial simplex */
     float  ftol[]          = { 1e-2, 1e-2 };     /* Tolerances on the the two passes */
+    float  lm_ftol[]       = { 1e-4, 1e-4 };     /* Relative residual tolerances for the Levenberg-Marquardt passes */
     float  atol[]          = { 0.2e-3, 0.2e-3 }; /* If dipole movement between two iterations is less than this,
                                                   we consider to have converged */
     int    ntol            = 2;
@@ -4718,6 +4860,22 @@ bool DipoleFitData::fit_one(DipoleFitData* fit,	            /* Precomputed fitti
         else
             fit->funcs = !fit->bemname.isEmpty() ? fit->bem_funcs : fit->sphere_funcs;
 
+        if (fit->fit_lm && have_field_grad(fit)) {
+            VEC_COPY_3(rd_final,rd_guess);
+            if (lm_minimize(fit,rd_final,lm_ftol[k],atol[k],max_eval,&neval,&final_val,verbose) != OK) {
+                if (k == 0)
+                    goto bad;
+                else {
+                    printf("\nWarning (t = %8.1f ms) : g = %6.1f %% final val = %7.3f\n",
+                           1000*time,100*(1 - final_val/user.B2),final_val);
+                    fit_fail = TRUE;
+                }
+            }
+            VEC_COPY_3(rd_guess,rd_final);
+            neval_tot += neval;
+            continue;
+        }
+
         simplex = make_initial_dipole_simplex(rd_guess,size);
         for (p = 0; p < 4; p++)
             vals[p] = fit_eval(simplex[p],3,fit);
@@ -4786,6 +4944,143 @@ bad : {
 
 //=============================================================================================================
 
+static FwdBemModel* dup_bem_model(FwdBemModel* orig)
+/*
+ * Only the infinite-medium potential workspace is private to the duplicate
+ */
+{
+    if (!orig)
+        return NULL;
+    FwdBemModel* res = new FwdBemModel;
+    *res = *orig;
+    res->v0 = NULL;
+    return res;
+}
+
+static void free_dup_bem_model(FwdBemModel* bem)
+{
+    if (!bem)
+        return;
+    bem->surfs.clear();
+    bem->nsurf       = 0;
+    bem->ntri        = NULL;
+    bem->np          = NULL;
+    bem->sigma       = NULL;
+    bem->gamma       = NULL;
+    bem->source_mult = NULL;
+    bem->field_mult  = NULL;
+    bem->head_mri_t  = NULL;
+    bem->solution    = NULL;
+    delete bem;
+}
+
+static dipoleFitFuncs dup_dipole_fit_funcs(dipoleFitFuncs f, FwdBemModel* orig_bem, FwdBemModel* bem)
+/*
+ * The compensation data and the BEM model hold work areas and must be private to each thread
+ */
+{
+    dipoleFitFuncs res;
+
+    if (!f)
+        return NULL;
+
+    res  = new_dipole_fit_funcs();
+    *res = *f;
+    res->meg_client_free = NULL;
+    res->eeg_client_free = NULL;
+
+    if (f->meg_client && f->meg_field == FwdCompData::fwd_comp_field) {
+        FwdCompData* orig = (FwdCompData*)f->meg_client;
+        FwdCompData* comp = new FwdCompData;
+
+        *comp = *orig;
+        comp->work        = NULL;
+        comp->vec_work    = NULL;
+        comp->client_free = NULL;
+        comp->set         = orig->set ? new MneCTFCompDataSet(*(orig->set)) : NULL;
+        if (orig_bem && comp->client == orig_bem)
+            comp->client = bem;
+        res->meg_client = comp;
+    }
+    if (orig_bem && f->eeg_client == orig_bem)
+        res->eeg_client = bem;
+    return res;
+}
+
+static void free_dup_dipole_fit_funcs(dipoleFitFuncs f)
+{
+    if (!f)
+        return;
+    if (f->meg_client && f->meg_field == FwdCompData::fwd_comp_field) {
+        FwdCompData* comp = (FwdCompData*)f->meg_client;
+        /*
+         * The coils and the client are shared with the original
+         */
+        comp->comp_coils = NULL;
+        comp->client     = NULL;
+        delete comp;
+    }
+    FREE_3(f);
+}
+
+//=============================================================================================================
+
+DipoleFitData* DipoleFitData::create_multi_thread_duplicate(DipoleFitData* one)
+{
+    DipoleFitData* res = new DipoleFitData;
+    FwdBemModel*   bem = dup_bem_model(one->bem_model);
+
+    *res = *one;
+    res->bem_model        = bem;
+    res->sphere_funcs     = dup_dipole_fit_funcs(one->sphere_funcs,one->bem_model,bem);
+    res->bem_funcs        = dup_dipole_fit_funcs(one->bem_funcs,one->bem_model,bem);
+    res->mag_dipole_funcs = dup_dipole_fit_funcs(one->mag_dipole_funcs,one->bem_model,bem);
+    if (one->funcs == one->bem_funcs)
+        res->funcs = res->bem_funcs;
+    else if (one->funcs == one->mag_dipole_funcs)
+        res->funcs = res->mag_dipole_funcs;
+    else
+        res->funcs = res->sphere_funcs;
+    res->user      = NULL;
+    res->user_free = NULL;
+    return res;
+}
+
+//=============================================================================================================
+
+void DipoleFitData::free_multi_thread_duplicate(DipoleFitData* one)
+{
+    if (!one)
+        return;
+
+    free_dup_dipole_fit_funcs(one->sphere_funcs);
+    free_dup_dipole_fit_funcs(one->bem_funcs);
+    free_dup_dipole_fit_funcs(one->mag_dipole_funcs);
+    free_dup_bem_model(one->bem_model);
+    /*
+     * Everything else is owned by the original
+     */
+    one->mri_head_t       = NULL;
+    one->meg_head_t       = NULL;
+    one->meg_coils        = NULL;
+    one->eeg_els          = NULL;
+    one->pick             = NULL;
+    one->eeg_model        = NULL;
+    one->bem_model        = NULL;
+    one->noise            = NULL;
+    one->noise_orig       = NULL;
+    one->proj             = NULL;
+    one->user             = NULL;
+    one->user_free        = NULL;
+    one->sphere_funcs     = NULL;
+    one->bem_funcs        = NULL;
+    one->mag_dipole_funcs = NULL;
+    one->funcs            = NULL;
+    delete one;
+}
+
+//=============================================================================================================
+
 int DipoleFitData::compute_dipole_field(DipoleFitData* d, float *rd, int whiten, float **fwd)
 /*
  * Compute the field and take whitening and projection into account
@@ -4873,3 +5168,61 @@ int DipoleFitData::compute_dipole_field(DipoleFitData* d, float *rd, int whiten,
 bad :
     return FAIL;
 }
+
+//=============================================================================================================
+
+bool DipoleFitData::have_field_grad(DipoleFitData* d)
+{
+    if (!d->funcs)
+        return false;
+    if (d->nmeg > 0 && !d->funcs->meg_field_grad)
+        return false;
+    if (d->neeg > 0 && !d->funcs->eeg_pot_grad)
+        return false;
+    return true;
+}
+
+//=============================================================================================================
+
+int DipoleFitData::compute_dipole_field_grad(DipoleFitData* d, float *rd, float *Q, int whiten, float *B, float **grad)
+/*
+ * Compute the field of one dipole and its derivatives with respect to the dipole position.
+ * Projection and whitening are applied as in compute_dipole_field
+ */
+{
+    float *vals[4];
+    int   nch = d->nmeg+d->neeg;
+    int   k;
+
+    if (!have_field_grad(d)) {
+        printf("Field gradients are not available with this forward model.");
+        return FAIL;
+    }
+    if (d->nmeg > 0) {
+        if (d->funcs->meg_field_grad(rd,Q,d->meg_coils,B,grad[0],grad[1],grad[2],d->funcs->meg_client) != OK)
+            return FAIL;
+    }
+    if (d->neeg > 0) {
+        if (d->funcs->eeg_pot_grad(rd,Q,d->eeg_els,B+d->nmeg,
+                                   grad[0]+d->nmeg,grad[1]+d->nmeg,grad[2]+d->nmeg,d->funcs->eeg_client) != OK)
+            return FAIL;
+    }
+    vals[0] = B;
+    vals[1] = grad[0];
+    vals[2] = grad[1];
+    vals[3] = grad[2];
+    /*
+     * Apply projection
+     */
+    for (k = 0; k < 4; k++)
+        if (MneProjOp::mne_proj_op_proj_vector(d->proj,vals[k],nch,TRUE) == FAIL)
+            return FAIL;
+    /*
+     * Whiten
+     */
+    if (d->noise && whiten) {
+        if (mne_whiten_data(vals,vals,4,nch,d->noise) == FAIL)
+            return FAIL;
+    }
+    return OK;
+}
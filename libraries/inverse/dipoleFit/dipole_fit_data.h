@@ -91,6 +91,9 @@ typedef struct {
   fwdVecFieldFunc eeg_vec_pot;
   void            *eeg_client;	    /* Client data for EEG field computations */
   mneUserFreeFunc eeg_client_free;
+
+  fwdFieldGradFunc meg_field_grad;  /* Field and its derivatives with respect to the dipole position (optional) */
+  fwdFieldGradFunc eeg_pot_grad;    /* Potential and its derivatives with respect to the dipole position (optional) */
 } *dipoleFitFuncs,dipoleFitFuncsRec;
 
 //=============================================================================================================
@@ -164,7 +167,8 @@ public:
                                             int   diagnoise,                /**< Use only the diagonal elements of the noise-covariance matrix */
                                             const QList<QString>& projnames,/**< SSP file names */
                                             int   include_meg,              /**< Include MEG in the fitting? */
-                                            int   include_eeg);
+                                            int   include_eeg,              /**< Include EEG in the fitting? */
+                                            bool  use_geometry_cache = false);  /**< Store the BEM surface geometry next to the surface file and reuse it */
 
     //=========================================================================================================
     /**
@@ -180,10 +184,57 @@ public:
      */
     static bool fit_one(DipoleFitData* fit, GuessData* guess, float time, float *B, int verbose, ECD& res);
 
+    //=========================================================================================================
+    /**
+     * Create a duplicate to make the fitting data thread safe.
+     * Read-only parts (coils, noise covariance, projection, BEM solution, ...) are shared with the original,
+     * the forward calculation clients which hold work areas are duplicated.
+     * The duplicate has to be released with free_multi_thread_duplicate and must not outlive the original.
+     *
+     * @param[in] one        The fitting data to duplicate.
+     *
+     * @return   The duplicate.
+     */
+    static DipoleFitData* create_multi_thread_duplicate(DipoleFitData* one);
+
+    //=========================================================================================================
+    /**
+     * Release a duplicate created with create_multi_thread_duplicate.
+     *
+     * @param[in] one        The duplicate to release.
+     */
+    static void free_multi_thread_duplicate(DipoleFitData* one);
+
 //============================= dipole_forward.c
 
     static int compute_dipole_field(DipoleFitData* d, float *rd, int whiten, float **fwd);
 
+    //=========================================================================================================
+    /**
+     * Compute the field of a dipole with a given moment and its derivatives with respect to the dipole position.
+     * The projection and whitening are applied as in compute_dipole_field.
+     *
+     * @param[in] d          The fitting data.
+     * @param[in] rd         The dipole location.
+     * @param[in] Q          The dipole moment.
+     * @param[in] whiten     Apply whitening?
+     * @param[out] B         The field (nmeg + neeg).
+     * @param[out] grad      The x, y, and z derivatives of the field (3 x (nmeg + neeg)).
+     *
+     * @return OK when successful, FAIL if the forward model does not provide the gradients.
+     */
+    static int compute_dipole_field_grad(DipoleFitData* d, float *rd, float *Q, int whiten, float *B, float **grad);
+
+    //=========================================================================================================
+    /**
+     * Are analytic field gradients available with the presently selected forward functions?
+     *
+     * @param[in] d          The fitting data.
+     *
+     * @return true if compute_dipole_field_grad can be used.
+     */
+    static bool have_field_grad(DipoleFitData* d);
+
     //============================= dipole_forward.c
 
     static DipoleForward* dipole_forward_one(DipoleFitData* d,
@@ -203,6 +254,7 @@ public:
       FWDLIB::FwdCoilSet*        eeg_els;           /**< EEG electrode definitions */
       float             r0[3];              /**< Sphere model origin */
       QString           bemname;           /**< Using a BEM? */
+      bool              use_geometry_cache; /**< Store the BEM surface geometry next to the surface file and reuse it */
 
       FWDLIB::FwdEegSphereModel *eeg_model;         /**< EEG sphere model definition */
       FWDLIB::FwdBemModel       *bem_model;         /**< BEM model definition */
@@ -219,6 +271,7 @@ public:
       MNELIB::MneProjOp*        proj;               /**< The projection operator to use */
       int               column_norm;        /**< What kind of column normalization to apply to the forward solution */
       int               fit_mag_dipoles;    /**< Fit magnetic dipoles? */
+      int               fit_lm;             /**< Use the Levenberg-Marquardt optimizer with analytic gradients instead of the simplex? */
       void              *user;              /**< User data for anything we need */
       fitUserFreeFunc   user_free;          /**< Function to free the above */
 
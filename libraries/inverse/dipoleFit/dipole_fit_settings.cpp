@@ -103,6 +103,8 @@ void DipoleFitSettings::initMembers()
     do_baseline  = false;         
     setno        = 1;             
     verbose      = false;
+    use_threads  = false;
+    use_geometry_cache = false;
     omit_data_proj = false;
 
          
@@ -110,6 +112,7 @@ void DipoleFitSettings::initMembers()
     scale_eeg_pos  = false;     
     mag_reg      = 0.1f;         
     fit_mag_dipoles = false;
+    fit_lm       = false;
 
     grad_reg     = 0.1f;         
     eeg_reg      = 0.1f;                  
@@ -167,6 +170,8 @@ void DipoleFitSettings::checkIntegrity()
         if (guess_exclude > 0)
             printf("Guess exclude    : %6.1f mm\n",1000*guess_exclude);
     }
+    if (!guess_cachename.isEmpty())
+        printf("Guess field cache: %s\n",guess_cachename.toUtf8().data());
     printf("Data             : %s\n",measname.toUtf8().data());
     if (projnames.size() > 0) {
         printf("SSP sources      :\n");
@@ -258,15 +263,19 @@ void DipoleFitSettings::usage(char *name)
     printf("\t--guess name      The source space of initial guesses.\n");
     printf("\t                  If not present, the values below are used to generate the guess grid.\n");
     printf("\t--guesssurf name  Read the inner skull surface from this fif file to generate the guesses.\n");
+    printf("\t--guesscache name Store the forward solutions of the guesses here and reuse them if the setup has not changed.\n");
     printf("\t--guessrad value  Radius of a spherical guess volume if neither of the above is present (default : %.1f mm)\n",1000*guess_rad);
     printf("\t--exclude dist/mm Exclude points which are closer than this distance from the CM of the inner skull surface (default =  %6.1f mm).\n",1000*guess_exclude);
     printf("\t--mindist dist/mm Exclude points which are closer than this distance from the inner skull surface  (default = %6.1f mm).\n",1000*guess_mindist);
     printf("\t--grid    dist/mm Source space grid size (default = %6.1f mm).\n",1000*guess_grid);
     printf("\t--magdip          Fit magnetic dipoles instead of current dipoles.\n");
+    printf("\t--lm              Use the Levenberg-Marquardt optimizer with analytic field gradients instead of the simplex.\n");
     printf("\nOutput:\n\n");
     printf("\t--dip     name    xfit dip format output file name\n");
     printf("\t--bdip    name    xfit bdip format output file name\n");
     printf("\nGeneral:\n\n");
+    printf("\t--threads         Fit the time points in parallel.\n");
+    printf("\t--geomcache       Store the surface geometry information next to the surface files and reuse it.\n");
     printf("\t--gui             Enables the gui.\n");
     printf("\t--help            print this info.\n");
     printf("\t--version         print version info.\n\n");
@@ -335,6 +344,14 @@ bool DipoleFitSettings::check_args (int *argc,char **argv)
             }
             guess_surfname = strdup(argv[k+1]);
         }
+        else if (strcmp(argv[k],"--guesscache") == 0) {
+            found = 2;
+            if (k == *argc - 1) {
+                qCritical ("--guesscache: argument required.");
+                return false;
+            }
+            guess_cachename = QString(argv[k+1]);
+        }
         else if (strcmp(argv[k],"--guessrad") == 0) {
             found = 2;
             if (k == *argc - 1) {
@@ -807,6 +824,10 @@ bool DipoleFitSettings::check_args (int *argc,char **argv)
             found = 1;
             fit_mag_dipoles = true;
         }
+        else if (strcmp(argv[k],"--lm") == 0) {
+            found = 1;
+            fit_lm = true;
+        }
         else if (strcmp(argv[k],"--dip") == 0) {
             found = 2;
             if (k == *argc - 1) {
@@ -827,6 +848,14 @@ bool DipoleFitSettings::check_args (int *argc,char **argv)
             found = 1;
             verbose = true;
         }
+        else if (strcmp(argv[k],"--threads") == 0) {
+            found = 1;
+            use_threads = true;
+        }
+        else if (strcmp(argv[k],"--geomcache") == 0) {
+            found = 1;
+            use_geometry_cache = true;
+        }
         if (found) {
             for (int p = k; p < *argc-found; p++)
                 argv[p] = argv[p+found];
@@ -119,6 +119,7 @@ public:
 
     QString guessname;                  /**< Initial guess grid (if not present, the values below will be employed to generate the grid) */
     QString guess_surfname;             /**< Load the inner skull surface from this BEM file */
+    QString guess_cachename;            /**< Cache file for the forward solutions of the guesses */
 float guess_rad;       			/**< Radius of spherical guess surface */
     float guess_mindist;       		/**< Minimum allowed distance to the surface */
     float guess_exclude;       		/**< Exclude points closer than this to the origin */
@@ -144,6 +145,8 @@ float guess_rad;       			/**< Radius of spherical guess surface */
     bool  do_baseline;         		/**< Are both baseline limits set? */
     int   setno;             		/**< Which data set */
     bool  verbose;
+    bool  use_threads;                  /**< Fit the time points in parallel? */
+    bool  use_geometry_cache;           /**< Store the surface geometry information next to the surface files and reuse it */
     MNELIB::mneFilterDefRec filter;
     QStringList projnames;              /**< Projection file names */
     bool omit_data_proj;
@@ -154,6 +157,7 @@ float guess_rad;       			/**< Radius of spherical guess surface */
     bool    scale_eeg_pos;     		/**< Scale the electrode locations to scalp in the sphere model */
     float  mag_reg;         		/**< Noise-covariance matrix regularization for MEG (magnetometers and axial gradiometers)  */
     bool   fit_mag_dipoles;
+    bool   fit_lm;                      /**< Use the Levenberg-Marquardt optimizer instead of the simplex */
 
     float  grad_reg;         		/**< Noise-covariance matrix regularization for EEG (planar gradiometers) */
     float  eeg_reg;         		/**< Noise-covariance matrix regularization for EEG  */
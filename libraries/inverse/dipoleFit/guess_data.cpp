@@ -43,11 +43,21 @@
 #include "dipole_forward.h"
 #include <mne/c/mne_surface_old.h>
 #include <mne/c/mne_source_space_old.h>
+#include <mne/c/mne_cov_matrix.h>
+#include <mne/c/mne_proj_op.h>
+#include <mne/c/mne_ctf_comp_data_set.h>
+#include <mne/c/mne_ctf_comp_data.h>
+#include <fwd/fwd_comp_data.h>
+#include <fwd/fwd_eeg_sphere_model.h>
 
 #include <fiff/fiff_stream.h>
 #include <fiff/fiff_tag.h>
 
 #include <QFile>
+#include <QDataStream>
+#include <QCryptographicHash>
+#include <QThread>
+#include <QtConcurrent>
 
 //=============================================================================================================
 // USED NAMESPACES
@@ -162,6 +172,143 @@ void fromIntEigenMatrix_16(const Eigen::MatrixXi& from_mat, int **&to_mat)
     fromIntEigenMatrix_16(from_mat, to_mat, from_mat.rows(), from_mat.cols());
 }
 
+//=============================================================================================================
+// Parallel computation of the guess fields
+//=============================================================================================================
+
+typedef struct {
+    DipoleFitData*  f;          /* The fitting data, duplicated for each chunk */
+    float           **rr;       /* The guess locations */
+    DipoleForward*  *fwd;       /* The forward solutions */
+    int             nguess;     /* How many in this chunk */
+    bool            ok;         /* Did all computations succeed? */
+} *guessChunk,guessChunkRec;
+
+static void compute_guess_chunk(guessChunkRec& chunk)
+{
+    DipoleFitData* f = DipoleFitData::create_multi_thread_duplicate(chunk.f);
+
+    /*
+     * Use the sphere model for speed
+     */
+    if (f->fit_mag_dipoles)
+        f->funcs = f->mag_dipole_funcs;
+    else
+        f->funcs = f->sphere_funcs;
+    chunk.ok = true;
+    for (int k = 0; k < chunk.nguess; k++) {
+        if ((chunk.fwd[k] = DipoleFitData::dipole_forward_one(f,chunk.rr[k],chunk.fwd[k])) == NULL) {
+            chunk.ok = false;
+            break;
+        }
+    }
+    DipoleFitData::free_multi_thread_duplicate(f);
+}
+
+//=============================================================================================================
+// Identification of the setup the guess fields were computed for
+//=============================================================================================================
+
+#define GUESS_CACHE_MAGIC   0x4d4e4547  /* 'MNEG' */
+#define GUESS_CACHE_VERSION 1
+
+static void hash_ints(QCryptographicHash& hash, const int *data, int n)
+{
+    if (data && n > 0)
+        hash.addData((const char *)data,n*sizeof(int));
+}
+
+static void hash_int(QCryptographicHash& hash, int val)
+{
+    hash_ints(hash,&val,1);
+}
+
+static void hash_floats(QCryptographicHash& hash, const float *data, int n)
+{
+    if (data && n > 0)
+        hash.addData((const char *)data,n*sizeof(float));
+}
+
+static void hash_doubles(QCryptographicHash& hash, const double *data, int n)
+{
+    if (data && n > 0)
+        hash.addData((const char *)data,n*sizeof(double));
+}
+
+static void hash_coils(QCryptographicHash& hash, FwdCoilSet* coils)
+{
+    if (!coils) {
+        hash_int(hash,0);
+        return;
+    }
+    hash_int(hash,coils->ncoil);
+    for (int k = 0; k < coils->ncoil; k++) {
+        FwdCoil* coil = coils->coils[k];
+        hash_int(hash,coil->type);
+        hash_int(hash,coil->coil_class);
+        hash_int(hash,coil->coord_frame);
+        hash_int(hash,coil->np);
+        for (int p = 0; p < coil->np; p++) {
+            hash_floats(hash,coil->rmag[p],3);
+            hash_floats(hash,coil->cosmag[p],3);
+        }
+        hash_floats(hash,coil->w,coil->np);
+    }
+}
+
+static QByteArray guess_fields_key(DipoleFitData* f, float **rr, int nguess)
+/*
+ * Everything which affects the whitened guess fields computed with the sphere model
+ */
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+
+    hash_int(hash,nguess);
+    if (nguess > 0)
+        hash_floats(hash,rr[0],3*nguess);
+    hash_int(hash,f->coord_frame);
+    hash_int(hash,f->nmeg);
+    hash_int(hash,f->neeg);
+    hash.addData(f->ch_names.join(":").toUtf8());
+    hash_coils(hash,f->meg_coils);
+    hash_coils(hash,f->eeg_els);
+    hash_floats(hash,f->r0,3);
+    hash_int(hash,f->fit_mag_dipoles);
+    hash_int(hash,f->column_norm);
+    if (f->eeg_model) {
+        FwdEegSphereModel* m = f->eeg_model;
+        hash_int(hash,m->nlayer());
+        for (int k = 0; k < m->nlayer(); k++) {
+            hash_floats(hash,&m->layers[k].rad,1);
+            hash_floats(hash,&m->layers[k].sigma,1);
+        }
+        hash_floats(hash,m->r0.data(),3);
+        hash_int(hash,m->nfit);
+        hash_floats(hash,m->mu.data(),m->mu.size());
+        hash_floats(hash,m->lambda.data(),m->lambda.size());
+        hash_int(hash,m->scale_pos);
+    }
+    if (f->sphere_funcs && f->sphere_funcs->meg_field == FwdCompData::fwd_comp_field) {
+        FwdCompData* comp = (FwdCompData*)f->sphere_funcs->meg_client;
+        hash_int(hash,comp && comp->set && comp->set->current ? comp->set->current->kind : 0);
+    }
+    if (f->noise) {
+        MneCovMatrix* c = f->noise;
+        hash_int(hash,c->ncov);
+        hash_int(hash,c->nzero);
+        hash_doubles(hash,c->inv_lambda,c->ncov);
+        if (!c->cov_diag && c->eigen)
+            hash_floats(hash,c->eigen[0],c->ncov*c->ncov);
+    }
+    if (f->proj) {
+        hash_int(hash,f->proj->nch);
+        hash_int(hash,f->proj->nvec);
+        if (f->proj->nvec > 0 && f->proj->proj_data)
+            hash_floats(hash,f->proj->proj_data[0],f->proj->nvec*f->proj->nch);
+    }
+    return hash.result();
+}
+
 //=============================================================================================================
 // DEFINE MEMBER METHODS
 //=============================================================================================================
@@ -181,7 +328,10 @@ GuessData::GuessData()
 
 //=============================================================================================================
 
-GuessData::GuessData(const QString &guessname, const QString &guess_surfname, float mindist, float exclude, float grid, DipoleFitData *f)
+GuessData::GuessData(const QString &guessname, const QString &guess_surfname, float mindist, float exclude, float grid, DipoleFitData *f, const QString &guess_cachename)
+: rr(NULL)
+, guess_fwd(NULL)
+, nguess(0)
 {
     MneSourceSpaceOld* *sp = NULL;
     int            nsp = 0;
@@ -189,7 +339,6 @@ GuessData::GuessData(const QString &guessname, const QString &guess_surfname, fl
     int            k,p;
     float          guessrad = 0.080;
     MneSourceSpaceOld* guesses = NULL;
-    dipoleFitFuncs orig;
 
     if (!guessname.isEmpty()) {
         /*
@@ -221,7 +370,7 @@ GuessData::GuessData(const QString &guessname, const QString &guess_surfname, fl
         }
         else if (!guess_surfname.isEmpty()) {
             fprintf(stderr,"Reading inner skull surface from %s...\n",guess_surfname.toUtf8().data());
-            if ((inner_skull = MneSurfaceOrVolume::read_bem_surface(guess_surfname,FIFFV_BEM_SURF_ID_BRAIN,TRUE,NULL)) == NULL)
+            if ((inner_skull = MneSurfaceOrVolume::read_bem_surface(guess_surfname,FIFFV_BEM_SURF_ID_BRAIN,TRUE,NULL,true,f->use_geometry_cache)) == NULL)
                 goto bad;
             free_inner_skull = TRUE;
         }
@@ -242,30 +391,21 @@ GuessData::GuessData(const QString &guessname, const QString &guess_surfname, fl
         }
     delete guesses; guesses = NULL;
 
-    fprintf(stderr,"Go through all guess source locations...");
     this->guess_fwd = MALLOC_16(this->nguess,DipoleForward*);
     for (k = 0; k < this->nguess; k++)
         this->guess_fwd[k] = NULL;
+    /*
+        * Reuse the guess fields from an earlier run if possible
+        */
+    if (!guess_cachename.isEmpty() && this->read_guess_fields(guess_cachename,f))
+        return;
     /*
         * Compute the guesses using the sphere model for speed
         */
-    orig = f->funcs;
-    if (f->fit_mag_dipoles)
-        f->funcs = f->mag_dipole_funcs;
-    else
-        f->funcs = f->sphere_funcs;
-
-    for (k = 0; k < this->nguess; k++) {
-        if ((this->guess_fwd[k] = DipoleFitData::dipole_forward_one(f,this->rr[k],NULL)) == NULL)
-            goto bad;
-#ifdef DEBUG
-        sing = this->guess_fwd[k]->sing;
-        printf("%f %f %f\n",sing[0],sing[1],sing[2]);
-#endif
-    }
-    f->funcs = orig;
-
-    fprintf(stderr,"[done %d sources]\n",p);
+    if (!this->compute_guess_fields(f))
+        goto bad;
+    if (!guess_cachename.isEmpty())
+        this->write_guess_fields(guess_cachename,f);
 
     return;
 //    return res;
@@ -320,7 +460,7 @@ GuessData::GuessData(const QString &guessname, const QString &guess_surfname, fl
         }
         else if (!guess_surfname.isEmpty()) {
             printf("Reading inner skull surface from %s...\n",guess_surfname.toUtf8().data());
-            if ((inner_skull = MneSurfaceOrVolume::read_bem_surface(guess_surfname,FIFFV_BEM_SURF_ID_BRAIN,TRUE,NULL)) == NULL)
+            if ((inner_skull = MneSurfaceOrVolume::read_bem_surface(guess_surfname,FIFFV_BEM_SURF_ID_BRAIN,TRUE,NULL,true,f->use_geometry_cache)) == NULL)
                 goto bad;
             free_inner_skull = TRUE;
         }
@@ -399,8 +539,6 @@ GuessData::~GuessData()
 
 bool GuessData::compute_guess_fields(DipoleFitData* f)
 {
-    dipoleFitFuncs orig = NULL;
-
     if (!f) {
         qCritical("Data missing in compute_guess_fields");
         return false;
@@ -410,24 +548,154 @@ bool GuessData::compute_guess_fields(DipoleFitData* f)
         return false;
     }
     printf("Go through all guess source locations...");
-    orig = f->funcs;
-    if (f->fit_mag_dipoles)
-        f->funcs = f->mag_dipole_funcs;
-    else
-        f->funcs = f->sphere_funcs;
-    for (int k = 0; k < this->nguess; k++) {
-        if ((this->guess_fwd[k] = DipoleFitData::dipole_forward_one(f,this->rr[k],this->guess_fwd[k])) == NULL){
-            if (orig)
-                f->funcs = orig;
+    /*
+     * The guesses are split into contiguous chunks which are computed concurrently,
+     * each with its own duplicate of the fitting data
+     */
+    int nchunk = 4*QThread::idealThreadCount();
+    if (nchunk > this->nguess)
+        nchunk = this->nguess;
+    if (nchunk < 1)
+        nchunk = 1;
+    int nper = this->nguess/nchunk + (this->nguess % nchunk ? 1 : 0);
+
+    QList<guessChunkRec> chunks;
+    for (int start = 0; start < this->nguess; start += nper) {
+        guessChunkRec chunk;
+        chunk.f      = f;
+        chunk.rr     = this->rr + start;
+        chunk.fwd    = this->guess_fwd + start;
+        chunk.nguess = (start + nper > this->nguess) ? this->nguess - start : nper;
+        chunk.ok     = false;
+        chunks.append(chunk);
+    }
+    QtConcurrent::blockingMap(chunks, compute_guess_chunk);
+
+    for (int k = 0; k < chunks.size(); k++) {
+        if (!chunks[k].ok) {
+            printf("\n");
+            qCritical("Could not compute the forward solution for the guesses");
             return false;
         }
-#ifdef DEBUG
-        sing = this->guess_fwd[k]->sing;
-        printf("%f %f %f\n",sing[0],sing[1],sing[2]);
-#endif
     }
-    f->funcs = orig;
     printf("[done %d sources]\n",this->nguess);
 
     return true;
 }
+
+//=============================================================================================================
+
+bool GuessData::read_guess_fields(const QString& name, DipoleFitData* f)
+{
+    QFile file(name);
+
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream stream(&file);
+    stream.setByteOrder(QDataStream::BigEndian);
+    stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+    stream.setVersion(QDataStream::Qt_5_0);
+
+    quint32    magic,version;
+    QByteArray key;
+    qint32     nguess_file,nch_file;
+    int        nch = f->nmeg+f->neeg;
+
+    stream >> magic >> version;
+    if (magic != GUESS_CACHE_MAGIC || version != GUESS_CACHE_VERSION) {
+        printf("%s is not a guess field cache file. The guess fields will be recomputed.\n",name.toUtf8().constData());
+        return false;
+    }
+    stream >> key >> nguess_file >> nch_file;
+    if (nguess_file != this->nguess || nch_file != nch || key != guess_fields_key(f,this->rr,this->nguess)) {
+        printf("The guess field cache %s does not match the present setup. The guess fields will be recomputed.\n",name.toUtf8().constData());
+        return false;
+    }
+    /*
+     * Read into new structures so that a truncated file does not leave us with a partial set
+     */
+    DipoleForward* *fwds = MALLOC_16(this->nguess,DipoleForward*);
+    int k;
+    for (k = 0; k < this->nguess; k++)
+        fwds[k] = NULL;
+    for (k = 0; k < this->nguess && stream.status() == QDataStream::Ok; k++) {
+        DipoleForward* fwd = fwds[k] = new DipoleForward;
+        fwd->ndip   = 1;
+        fwd->nch    = nch;
+        fwd->rd     = ALLOC_CMATRIX_16(1,3);
+        fwd->fwd    = ALLOC_CMATRIX_16(3,nch);
+        fwd->uu     = ALLOC_CMATRIX_16(3,nch);
+        fwd->vv     = ALLOC_CMATRIX_16(3,3);
+        fwd->sing   = MALLOC_16(3,float);
+        fwd->scales = MALLOC_16(3,float);
+        VEC_COPY_16(fwd->rd[0],this->rr[k]);
+        for (int p = 0; p < 3*nch; p++)
+            stream >> fwd->fwd[0][p];
+        for (int p = 0; p < 3*nch; p++)
+            stream >> fwd->uu[0][p];
+        for (int p = 0; p < 9; p++)
+            stream >> fwd->vv[0][p];
+        for (int p = 0; p < 3; p++)
+            stream >> fwd->sing[p];
+        for (int p = 0; p < 3; p++)
+            stream >> fwd->scales[p];
+    }
+    if (stream.status() != QDataStream::Ok) {
+        printf("Could not read the guess field cache %s. The guess fields will be recomputed.\n",name.toUtf8().constData());
+        for (k = 0; k < this->nguess; k++)
+            delete fwds[k];
+        FREE_16(fwds);
+        return false;
+    }
+    for (k = 0; k < this->nguess; k++) {
+        delete this->guess_fwd[k];
+        this->guess_fwd[k] = fwds[k];
+    }
+    FREE_16(fwds);
+    printf("Read the forward solutions of %d guesses from %s\n",this->nguess,name.toUtf8().constData());
+
+    return true;
+}
+
+//=============================================================================================================
+
+bool GuessData::write_guess_fields(const QString& name, DipoleFitData* f) const
+{
+    QFile file(name);
+
+    if (!file.open(QIODevice::WriteOnly)) {
+        printf("Could not write the guess field cache %s\n",name.toUtf8().constData());
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setByteOrder(QDataStream::BigEndian);
+    stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+    stream.setVersion(QDataStream::Qt_5_0);
+
+    int nch = f->nmeg+f->neeg;
+
+    stream << (quint32)GUESS_CACHE_MAGIC << (quint32)GUESS_CACHE_VERSION;
+    stream << guess_fields_key(f,this->rr,this->nguess) << (qint32)this->nguess << (qint32)nch;
+    for (int k = 0; k < this->nguess; k++) {
+        DipoleForward* fwd = this->guess_fwd[k];
+        for (int p = 0; p < 3*nch; p++)
+            stream << fwd->fwd[0][p];
+        for (int p = 0; p < 3*nch; p++)
+            stream << fwd->uu[0][p];
+        for (int p = 0; p < 9; p++)
+            stream << fwd->vv[0][p];
+        for (int p = 0; p < 3; p++)
+            stream << fwd->sing[p];
+        for (int p = 0; p < 3; p++)
+            stream << fwd->scales[p];
+    }
+    if (stream.status() != QDataStream::Ok) {
+        printf("Could not write the guess field cache %s\n",name.toUtf8().constData());
+        return false;
+    }
+    printf("Wrote the forward solutions of the guesses to %s\n",name.toUtf8().constData());
+
+    return true;
+}
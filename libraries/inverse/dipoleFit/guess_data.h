@@ -102,9 +102,16 @@ public:
      * Refactored: make_guess_data (setup.c)
      *
      * @param[in] guessname
+     * @param[in] guess_surfname
+     * @param[in] mindist
+     * @param[in] exclude
+     * @param[in] grid
+     * @param[in] f
+     * @param[in] guess_cachename    If not empty, the guess fields are read from this file if it matches the
+     *                               current setup. Otherwise they are computed and stored here.
      *
      */
-    GuessData( const QString& guessname, const QString& guess_surfname, float mindist, float exclude, float grid, DipoleFitData* f);
+    GuessData( const QString& guessname, const QString& guess_surfname, float mindist, float exclude, float grid, DipoleFitData* f, const QString& guess_cachename = QString());
 
     //=========================================================================================================
     /**
@@ -134,6 +141,30 @@ public:
      */
     bool compute_guess_fields(DipoleFitData* f);
 
+    //=========================================================================================================
+    /**
+     * Read the guess fields computed earlier with write_guess_fields.
+     * The fields are accepted only if the guess locations, the sensors, the forward model, the noise covariance
+     * and the projection are the same as in f.
+     *
+     * @param[in] name   The cache file name.
+     * @param[in] f      Dipole Fit Data the guess fields have to match.
+     *
+     * @return true if the guess fields were read
+     */
+    bool read_guess_fields(const QString& name, DipoleFitData* f);
+
+    //=========================================================================================================
+    /**
+     * Store the whitened guess fields and their SVD for reuse by read_guess_fields.
+     *
+     * @param[in] name   The cache file name.
+     * @param[in] f      Dipole Fit Data used to compute the guess fields.
+     *
+     * @return true when successful
+     */
+    bool write_guess_fields(const QString& name, DipoleFitData* f) const;
+
 public:
     float          **rr;            /**< These are the guess dipole locations */
     DipoleForward** guess_fwd;      /**< Forward solutions for the guesses */
@@ -63,6 +63,7 @@
 
 #include <QFuture>
 #include <QtConcurrent/QtConcurrent>
+#include <QElapsedTimer>
 
 //=============================================================================================================
 // USED NAMESPACES
@@ -84,6 +85,8 @@ using namespace FWDLIB;
 HPIFit::HPIFit(FiffInfo::SPtr pFiffInfo,
                bool bDoFastFit)
     : m_bDoFastFit(bDoFastFit)
+    , m_bUseLevenbergMarquardt(false)
+    , m_fLastFitDuration(0.0f)
 {
     // init member variables
     m_lChannels = QList<FIFFLIB::FiffChInfo>();
@@ -116,6 +119,10 @@ void HPIFit::fitHPI(const MatrixXd& t_mat,
                     int iMaxIterations,
                     float fAbortError)
 {
+    QElapsedTimer timer;
+    timer.start();
+    m_vecLastNumIterations.clear();
+
     //Check if data was passed
     if(t_mat.rows() == 0 || t_mat.cols() == 0 ) {
         std::cout<<std::endl<< "HPIFit::fitHPI - No data passed. Returning.";
@@ -147,21 +154,196 @@ void HPIFit::fitHPI(const MatrixXd& t_mat,
         updateModel(pFiffInfo->sfreq, t_mat.cols(), pFiffInfo->linefreq, vecFreqs);
         m_vecFreqs = vecFreqs;
         bUpdateModel = false;
+
+        // The coil order or the channels changed, the last fit is not a valid warm start anymore
+        m_matLastCoilPos.resize(0,0);
+    }
+
+    //Get number of HPI coils from digitizers
+    int iNumCoils = 0;
+
+    for(int i = 0; i < pFiffInfo->dig.size(); ++i) {
+        if(pFiffInfo->dig[i].kind == FIFFV_POINT_HPI) {
+            iNumCoils++;
+        }
+    }
+
+    if(vecFreqs.size() < iNumCoils) {
+        std::cout<<std::endl<< "HPIFit::fitHPI - Not enough coil frequencies specified. Returning.";
+        return;
     }
 
+    // Get the data from inner layer channels
+    MatrixXd matInnerdata(m_vecInnerind.size(), t_mat.cols());
+
+    for(int j = 0; j < m_vecInnerind.size(); ++j) {
+        matInnerdata.row(j) << t_mat.row(m_vecInnerind[j]);
+    }
+
+    // Calculate topo
+    MatrixXd matTopo;
+    MatrixXd matAmp(m_vecInnerind.size(), iNumCoils);
+    MatrixXd matAmpC(m_vecInnerind.size(), iNumCoils);
+
+    matTopo = m_matModel * matInnerdata.transpose(); // topo: # of good inner channel x 8
+
+    if(m_bDoFastFit) {
+        // Select sine or cosine component depending on the relative size
+        matTopo.transposeInPlace();
+        matAmp = matTopo.leftCols(iNumCoils);
+        matAmpC = matTopo.rightCols(iNumCoils);
+        for(int j = 0; j < iNumCoils; ++j) {
+           float fNS = 0.0;
+           float fNC = 0.0;
+           fNS = matAmp.col(j).array().square().sum();
+           fNC = matAmpC.col(j).array().square().sum();
+           if(fNC > fNS) {
+               matAmp.col(j) = matAmpC.col(j);
+           }
+        }
+    } else {
+        // estimate the sinusoid phase
+        for(int i = 0; i < iNumCoils; ++i) {
+            int from = 2*i;
+            MatrixXd m = matTopo.block(from,0,2,matTopo.cols());
+            JacobiSVD<MatrixXd> svd(m, ComputeThinU | ComputeThinV);
+            matAmp.col(i) = svd.singularValues()(0) * svd.matrixV().col(0);
+        }
+    }
+
+    // Perform actual localization
+    fitCoils(matAmp,
+             t_matProjectors,
+             transDevHead,
+             vecFreqs,
+             vecError,
+             vecGoF,
+             fittedPointSet,
+             pFiffInfo,
+             bDoDebug,
+             sHPIResourceDir,
+             iMaxIterations,
+             fAbortError,
+             timer);
+}
+
+//=============================================================================================================
+
+void HPIFit::fitHPIFromAmplitudes(const MatrixXd& matAmplitudes,
+                                  const MatrixXd& t_matProjectors,
+                                  FiffCoordTrans& transDevHead,
+                                  const QVector<int>& vecFreqs,
+                                  QVector<double>& vecError,
+                                  VectorXd& vecGoF,
+                                  FiffDigPointSet& fittedPointSet,
+                                  FiffInfo::SPtr pFiffInfo,
+                                  bool bDoDebug,
+                                  const QString& sHPIResourceDir,
+                                  int iMaxIterations,
+                                  float fAbortError)
+{
+    QElapsedTimer timer;
+    timer.start();
+    m_vecLastNumIterations.clear();
+
+    //Check if amplitudes were passed
+    if(matAmplitudes.rows() != pFiffInfo->chs.size() || matAmplitudes.cols() == 0) {
+        std::cout<<std::endl<< "HPIFit::fitHPIFromAmplitudes - Amplitudes do not match the channels. Returning.";
+        return;
+    }
+    //Check if projector was passed
+    if(t_matProjectors.rows() == 0 || t_matProjectors.cols() == 0 ) {
+        std::cout<<std::endl<< "HPIFit::fitHPIFromAmplitudes - No projector passed. Returning.";
+        return;
+    }
+
+    // check if bads have changed and update coils/channellist if so
+    if(!(m_lBads == pFiffInfo->bads) || m_lChannels.isEmpty()) {
+        m_lBads = pFiffInfo->bads;
+        updateChannels(pFiffInfo);
+        updateSensor();
+        m_matModel.resize(0,0);
+        m_matLastCoilPos.resize(0,0);
+    }
+
+    if(m_lChannels.isEmpty()) {
+        qWarning() << "HPIFit::fitHPIFromAmplitudes - Channel list is empty. Returning.";
+        return;
+    }
+
+    // The model is not needed here, but it has to be rebuilt by the next call to fitHPI
+    if(m_vecFreqs != vecFreqs) {
+        m_vecFreqs = vecFreqs;
+        m_matModel.resize(0,0);
+        m_matLastCoilPos.resize(0,0);
+    }
+
+    //Get number of HPI coils from digitizers
+    int iNumCoils = 0;
+
+    for(int i = 0; i < pFiffInfo->dig.size(); ++i) {
+        if(pFiffInfo->dig[i].kind == FIFFV_POINT_HPI) {
+            iNumCoils++;
+        }
+    }
+
+    if(vecFreqs.size() < iNumCoils || matAmplitudes.cols() < iNumCoils) {
+        std::cout<<std::endl<< "HPIFit::fitHPIFromAmplitudes - Not enough coil frequencies specified. Returning.";
+        return;
+    }
+
+    // Get the amplitudes of the inner layer channels
+    MatrixXd matAmp(m_vecInnerind.size(), iNumCoils);
+
+    for(int j = 0; j < m_vecInnerind.size(); ++j) {
+        matAmp.row(j) = matAmplitudes.row(m_vecInnerind[j]).leftCols(iNumCoils);
+    }
+
+    // Perform actual localization
+    fitCoils(matAmp,
+             t_matProjectors,
+             transDevHead,
+             vecFreqs,
+             vecError,
+             vecGoF,
+             fittedPointSet,
+             pFiffInfo,
+             bDoDebug,
+             sHPIResourceDir,
+             iMaxIterations,
+             fAbortError,
+             timer);
+}
+
+//=============================================================================================================
+
+void HPIFit::fitCoils(const MatrixXd& matAmp,
+                      const MatrixXd& t_matProjectors,
+                      FiffCoordTrans& transDevHead,
+                      const QVector<int>& vecFreqs,
+                      QVector<double>& vecError,
+                      VectorXd& vecGoF,
+                      FiffDigPointSet& fittedPointSet,
+                      FiffInfo::SPtr pFiffInfo,
+                      bool bDoDebug,
+                      const QString& sHPIResourceDir,
+                      int iMaxIterations,
+                      float fAbortError,
+                      const QElapsedTimer& timer)
+{
+    int iNumCoils = matAmp.cols();
+
     // Make sure the fitted digitzers are empty
     fittedPointSet.clear();
 
     // init coil parameters
     struct CoilParam coil;
 
-    //Get HPI coils from digitizers and set number of coils
-    int iNumCoils = 0;
+    //Get HPI coils from digitizers
     QList<FiffDigPoint> lHPIPoints;
 
     for(int i = 0; i < pFiffInfo->dig.size(); ++i) {
         if(pFiffInfo->dig[i].kind == FIFFV_POINT_HPI) {
-            iNumCoils++;
             lHPIPoints.append(pFiffInfo->dig[i]);
         }
     }
@@ -169,14 +351,8 @@ void HPIFit::fitHPI(const MatrixXd& t_mat,
     //Set coil frequencies
     VectorXd vecCoilfreq(iNumCoils);
 
-    if(vecFreqs.size() >= iNumCoils) {
-        for(int i = 0; i < iNumCoils; ++i) {
-            vecCoilfreq[i] = vecFreqs.at(i);
-            //std::cout<<std::endl << vecCoilfreq[i] << "Hz";
-        }
-    } else {
-        std::cout<<std::endl<< "HPIFit::fitHPI - Not enough coil frequencies specified. Returning.";
-        return;
+    for(int i = 0; i < iNumCoils; ++i) {
+        vecCoilfreq[i] = vecFreqs.at(i);
     }
 
     // Initialize HPI coils location and moment
@@ -211,44 +387,6 @@ void HPIFit::fitHPI(const MatrixXd& t_mat,
         matProjectorsInnerind.col(i) = matProjectorsRows.col(m_vecInnerind.at(i));
     }
 
-    // Get the data from inner layer channels
-    MatrixXd matInnerdata(m_vecInnerind.size(), t_mat.cols());
-
-    for(int j = 0; j < m_vecInnerind.size(); ++j) {
-        matInnerdata.row(j) << t_mat.row(m_vecInnerind[j]);
-    }
-
-    // Calculate topo
-    MatrixXd matTopo;
-    MatrixXd matAmp(m_vecInnerind.size(), iNumCoils);
-    MatrixXd matAmpC(m_vecInnerind.size(), iNumCoils);
-
-    matTopo = m_matModel * matInnerdata.transpose(); // topo: # of good inner channel x 8
-
-    if(m_bDoFastFit) {
-        // Select sine or cosine component depending on the relative size
-        matTopo.transposeInPlace();
-        matAmp = matTopo.leftCols(iNumCoils);
-        matAmpC = matTopo.rightCols(iNumCoils);
-        for(int j = 0; j < iNumCoils; ++j) {
-           float fNS = 0.0;
-           float fNC = 0.0;
-           fNS = matAmp.col(j).array().square().sum();
-           fNC = matAmpC.col(j).array().square().sum();
-           if(fNC > fNS) {
-               matAmp.col(j) = matAmpC.col(j);
-           }
-        }
-    } else {
-        // estimate the sinusoid phase
-        for(int i = 0; i < iNumCoils; ++i) {
-            int from = 2*i;
-            MatrixXd m = matTopo.block(from,0,2,matTopo.cols());
-            JacobiSVD<MatrixXd> svd(m, ComputeThinU | ComputeThinV);
-            matAmp.col(i) = svd.singularValues()(0) * svd.matrixV().col(0);
-        }
-    }
-
     //Find good seed point/starting point for the coil position in 3D space
     //Find biggest amplitude per pickup coil (sensor) and store corresponding sensor channel index
     VectorXi vecChIdcs(iNumCoils);
@@ -267,8 +405,11 @@ void HPIFit::fitHPI(const MatrixXd& t_mat,
     double dError = std::accumulate(vecError.begin(), vecError.end(), .0) / vecError.size();
     MatrixXd matCoilPos = MatrixXd::Zero(iNumCoils,3);
 
-    // Generate seed point by projection the found channel position 3cm inwards if previous transDevHead is identity or bad fit
-    if(transDevHead.trans == MatrixXd::Identity(4,4).cast<float>() || dError > 0.010) {
+    // Warm start from the coil positions of the last good fit if the Levenberg-Marquardt solver is used.
+    // Otherwise generate seed point by projection the found channel position 3cm inwards if previous transDevHead is identity or bad fit
+    if(m_bUseLevenbergMarquardt && m_matLastCoilPos.rows() == iNumCoils) {
+        matCoilPos = m_matLastCoilPos;
+    } else if(transDevHead.trans == MatrixXd::Identity(4,4).cast<float>() || dError > 0.010) {
         for (int j = 0; j < vecChIdcs.rows(); ++j) {
             if(vecChIdcs(j) < pFiffInfo->chs.size()) {
                 Vector3f r0 = pFiffInfo->chs.at(vecChIdcs(j)).chpos.r0;
@@ -288,7 +429,8 @@ void HPIFit::fitHPI(const MatrixXd& t_mat,
                   iNumCoils,
                   matProjectorsInnerind,
                   iMaxIterations,
-                  fAbortError);
+                  fAbortError,
+                  m_bUseLevenbergMarquardt);
 
     Matrix4d matTrans = computeTransformation(matHeadHPI, coil.pos);
     //Eigen::Matrix4d matTrans = computeTransformation(coil.pos, matHeadHPI);
@@ -316,6 +458,13 @@ void HPIFit::fitHPI(const MatrixXd& t_mat,
         vecError[i] = matDiffPos.col(i).norm();
     }
 
+    // Keep the coil positions as warm start for the next fit if the fit was good
+    if(std::accumulate(vecError.begin(), vecError.end(), .0) / vecError.size() < 0.010) {
+        m_matLastCoilPos = coil.pos;
+    } else {
+        m_matLastCoilPos.resize(0,0);
+    }
+
     // store Goodness of Fit
     vecGoF = coil.dpfiterror;
     for(int i = 0; i < vecGoF.size(); ++i) {
@@ -334,6 +483,13 @@ void HPIFit::fitHPI(const MatrixXd& t_mat,
         fittedPointSet << digPoint;
     }
 
+    // Store the iteration and latency counters
+    m_vecLastNumIterations.resize(iNumCoils);
+    for(int i = 0; i < iNumCoils; ++i) {
+        m_vecLastNumIterations[i] = coil.dpfitnumitr(i);
+    }
+    m_fLastFitDuration = timer.nsecsElapsed() / 1000000.0f;
+
     if(bDoDebug) {
         // DEBUG HPI fitting and write debug results
         std::cout << std::endl << std::endl << "HPIFit::fitHPI - dpfiterror" << coil.dpfiterror << std::endl << std::endl;
@@ -449,7 +605,8 @@ CoilParam HPIFit::dipfit(struct CoilParam coil,
                          int iNumCoils,
                          const MatrixXd& t_matProjectors,
                          int iMaxIterations,
-                         float fAbortError)
+                         float fAbortError,
+                         bool bUseLevenbergMarquardt)
 {
     //Do this in conncurrent mode
     //Generate QList structure which can be handled by the QConcurrent framework
@@ -463,6 +620,7 @@ CoilParam HPIFit::dipfit(struct CoilParam coil,
         coilData.m_matProjector = t_matProjectors;
         coilData.m_iMaxIterations = iMaxIterations;
         coilData.m_fAbortError = fAbortError;
+        coilData.m_bUseLevenbergMarquardt = bUseLevenbergMarquardt;
 
         lCoilData.append(coilData);
     }
@@ -602,6 +760,30 @@ void HPIFit::createSensorSet(SensorSet& sensors,
 
 //=============================================================================================================
 
+void HPIFit::setUseLevenbergMarquardt(bool bUseLevenbergMarquardt)
+{
+    if(m_bUseLevenbergMarquardt != bUseLevenbergMarquardt) {
+        m_bUseLevenbergMarquardt = bUseLevenbergMarquardt;
+        m_matLastCoilPos.resize(0,0);
+    }
+}
+
+//=============================================================================================================
+
+QVector<int> HPIFit::getLastNumIterations() const
+{
+    return m_vecLastNumIterations;
+}
+
+//=============================================================================================================
+
+float HPIFit::getLastFitDuration() const
+{
+    return m_fLastFitDuration;
+}
+
+//=============================================================================================================
+
 void HPIFit::storeHeadPosition(float fTime,
                                const Eigen::MatrixXf& transDevHead,
                                Eigen::MatrixXd& matPosition,
@@ -64,6 +64,8 @@
 // FORWARD DECLARATIONS
 //=============================================================================================================
 
+class QElapsedTimer;
+
 namespace FWDLIB{
     class FwdCoil;
     class FwdCoilSet;
@@ -108,6 +110,8 @@ struct HpiFitResult {
     bool                        bIsLargeHeadMovement;
     float                       fHeadMovementDistance;
     float                       fHeadMovementAngle;
+    QVector<int>                vecNumIterations;
+    float                       fFitDuration = 0.0f;
 };
 
 /**
@@ -180,6 +184,37 @@ public:
                 int iMaxIterations = 500,
                 float fAbortError = 1e-9);
 
+    //=========================================================================================================
+    /**
+     * Perform one single HPI fit based on already estimated coil amplitudes, e.g. from the streaming
+     * HPILockIn estimator. This skips the projection of the data onto the sinusoid model.
+     *
+     * @param[in]    matAmplitudes              The coil amplitude topographies (channels x coils) for all channels in pFiffInfo.
+     * @param[in]    t_matProjectors            The projectors to apply. Bad channels are still included.
+     * @param[out]   transDevHead               The final dev head transformation matrix
+     * @param[in]    vecFreqs                   The frequencies for each coil.
+     * @param[out]   vecError                   The HPI estimation Error in mm for each fitted HPI coil.
+     * @param[out]   vecGoF                     The goodness of fit for each fitted HPI coil
+     * @param[out]   fittedPointSet             The final fitted positions in form of a digitizer set.
+     * @param[in]    pFiffInfo                  Associated Fiff Information.
+     * @param[in]    bDoDebug                   Print debug info to cmd line and write debug info to file.
+     * @param[in]    sHPIResourceDir            The path to the debug file which is to be written.
+     * @param[in]    iMaxIterations             The maximum allowed number of iterations used to fit the dipoles. Default is 500.
+     * @param[in]    fAbortError                The error which will lead to aborting the dipole fitting process. Default is 1e-9.
+     */
+    void fitHPIFromAmplitudes(const Eigen::MatrixXd& matAmplitudes,
+                              const Eigen::MatrixXd& t_matProjectors,
+                              FIFFLIB::FiffCoordTrans &transDevHead,
+                              const QVector<int>& vecFreqs,
+                              QVector<double>& vecError,
+                              Eigen::VectorXd& vecGoF,
+                              FIFFLIB::FiffDigPointSet& fittedPointSet,
+                              QSharedPointer<FIFFLIB::FiffInfo> pFiffInfo,
+                              bool bDoDebug = false,
+                              const QString& sHPIResourceDir = QString("./HPIFittingDebug"),
+                              int iMaxIterations = 500,
+                              float fAbortError = 1e-9);
+
     //=========================================================================================================
     /**
      * assign frequencies to correct position
@@ -203,6 +238,32 @@ public:
                    FIFFLIB::FiffDigPointSet& fittedPointSet,
                    QSharedPointer<FIFFLIB::FiffInfo> pFiffInfo);
 
+    //=========================================================================================================
+    /**
+     * Sets whether the coils are fitted with the Levenberg-Marquardt solver instead of the simplex search.
+     * If enabled, each fit is warm-started from the coil positions of the last good fit, which is
+     * considerably faster and less jittery for continuous HPI.
+     *
+     * @param[in] bUseLevenbergMarquardt    Whether to use the Levenberg-Marquardt solver.
+     */
+    void setUseLevenbergMarquardt(bool bUseLevenbergMarquardt);
+
+    //=========================================================================================================
+    /**
+     * Returns the number of iterations needed for each coil during the last fit.
+     *
+     * @return The number of iterations per coil.
+     */
+    QVector<int> getLastNumIterations() const;
+
+    //=========================================================================================================
+    /**
+     * Returns the duration of the last fit.
+     *
+     * @return The duration of the last call to fitHPI in ms.
+     */
+    float getLastFitDuration() const;
+
     //=========================================================================================================
     /**
      * Store results from dev_Head_t as quaternions in position matrix. The format is the same as you
@@ -223,6 +284,39 @@ public:
                                   const Eigen::VectorXd& vecGoF,
                                   const QVector<double>& vecError);
 protected:
+    //=========================================================================================================
+    /**
+     * Localizes the coils from the amplitudes of the inner layer channels and computes the dev head
+     * transformation, the errors and the goodness of fit.
+     *
+     * @param[in]    matAmp                     The coil amplitudes of the inner layer channels (channels x coils).
+     * @param[in]    t_matProjectors            The projectors to apply. Bad channels are still included.
+     * @param[out]   transDevHead               The final dev head transformation matrix
+     * @param[in]    vecFreqs                   The frequencies for each coil.
+     * @param[out]   vecError                   The HPI estimation Error in mm for each fitted HPI coil.
+     * @param[out]   vecGoF                     The goodness of fit for each fitted HPI coil
+     * @param[out]   fittedPointSet             The final fitted positions in form of a digitizer set.
+     * @param[in]    pFiffInfo                  Associated Fiff Information.
+     * @param[in]    bDoDebug                   Print debug info to cmd line and write debug info to file.
+     * @param[in]    sHPIResourceDir            The path to the debug file which is to be written.
+     * @param[in]    iMaxIterations             The maximum allowed number of iterations used to fit the dipoles.
+     * @param[in]    fAbortError                The error which will lead to aborting the dipole fitting process.
+     * @param[in]    timer                      The timer started at the beginning of the fit.
+     */
+    void fitCoils(const Eigen::MatrixXd& matAmp,
+                  const Eigen::MatrixXd& t_matProjectors,
+                  FIFFLIB::FiffCoordTrans &transDevHead,
+                  const QVector<int>& vecFreqs,
+                  QVector<double>& vecError,
+                  Eigen::VectorXd& vecGoF,
+                  FIFFLIB::FiffDigPointSet& fittedPointSet,
+                  QSharedPointer<FIFFLIB::FiffInfo> pFiffInfo,
+                  bool bDoDebug,
+                  const QString& sHPIResourceDir,
+                  int iMaxIterations,
+                  float fAbortError,
+                  const QElapsedTimer& timer);
+
     //=========================================================================================================
     /**
      * Fits dipoles for the given coils and a given data set.
@@ -234,6 +328,7 @@ protected:
      * @param[in] t_matProjectors   The projectors to apply. Bad channels are still included.
      * @param[in] iMaxIterations    The maximum allowed number of iterations used to fit the dipoles. Default is 500.
      * @param[in] fAbortError       The error which will lead to aborting the dipole fitting process. Default is 1e-9.
+     * @param[in] bUseLevenbergMarquardt    Whether to use the Levenberg-Marquardt solver instead of the simplex search.
      *
      * @return Returns the coil parameters.
      */
@@ -243,7 +338,8 @@ protected:
                      int iNumCoils,
                      const Eigen::MatrixXd &t_matProjectors,
                      int iMaxIterations,
-                     float fAbortError);
+                     float fAbortError,
+                     bool bUseLevenbergMarquardt = false);
 
     //=========================================================================================================
     /**
@@ -314,6 +410,11 @@ private:
 
     QVector<int>        m_vecFreqs;         /**< The frequencies for each coil in unknown order. */
 
+    bool                m_bUseLevenbergMarquardt;   /**< Whether to fit the coils with the Levenberg-Marquardt solver. */
+    Eigen::MatrixXd     m_matLastCoilPos;           /**< The coil positions in device coordinates of the last good fit, used as warm start. */
+    QVector<int>        m_vecLastNumIterations;     /**< The number of iterations per coil of the last fit. */
+    float               m_fLastFitDuration;         /**< The duration of the last fit in ms. */
+
 };
 
 //=============================================================================================================
@@ -49,6 +49,8 @@
 // EIGEN INCLUDES
 //=============================================================================================================
 
+#include <Eigen/Dense>
+
 //=============================================================================================================
 // QT INCLUDES
 //=============================================================================================================
@@ -70,6 +72,7 @@ using namespace INVERSELIB;
 //=============================================================================================================
 
 HPIFitData::HPIFitData()
+: m_bUseLevenbergMarquardt(false)
 {
 }
 
@@ -86,6 +89,25 @@ void HPIFitData::doDipfitConcurrent()
     int iMaxiter = m_iMaxIterations;
     int iSimplexNumitr = 0;
 
+    if(m_bUseLevenbergMarquardt) {
+        int iNumItr = 0;
+
+        this->m_coilPos = levenbergMarquardt(vecCurrentCoil,
+                                             iMaxiter,
+                                             vecCurrentData,
+                                             this->m_matProjector,
+                                             currentSensors,
+                                             iNumItr);
+
+        this->m_errorInfo = dipfitError(this->m_coilPos,
+                                        vecCurrentData,
+                                        currentSensors,
+                                        this->m_matProjector);
+
+        this->m_errorInfo.numIterations = iNumItr;
+        return;
+    }
+
     this->m_coilPos = fminsearch(vecCurrentCoil,
                                iMaxiter,
                                2 * iMaxiter * vecCurrentCoil.cols(),
@@ -160,6 +182,43 @@ Eigen::MatrixXd HPIFitData::magnetic_dipole(Eigen::MatrixXd matPos,
 
 //=============================================================================================================
 
+Eigen::MatrixXd HPIFitData::magnetic_dipole_grad(const Eigen::MatrixXd& matPos,
+                                                 const Eigen::MatrixXd& matPnt,
+                                                 const Eigen::MatrixXd& matOri)
+{
+    double u0 = 1e-7;
+    double dScale = u0/(4 * M_PI);
+    int iNchan = matPnt.rows();
+    Eigen::MatrixXd matGrad(iNchan,9);
+
+    for(int i = 0; i < iNchan; i++) {
+        // Shift the magnetometers so that the dipole is in the origin
+        Eigen::Vector3d d = matPnt.row(i).transpose() - matPos.row(0).transpose();
+        Eigen::Vector3d o = matOri.row(i).transpose();
+
+        double r2 = d.squaredNorm();
+        double r5 = r2 * r2 * std::sqrt(r2);
+        double r7 = r5 * r2;
+        double dot = d.dot(o);
+
+        // lf_j = (3 d_j (d*o) - o_j r^2) / r^5, the dipole position enters with a negative sign through d
+        for(int j = 0; j < 3; j++) {
+            double dNum = 3 * d(j) * dot - o(j) * r2;
+            for(int k = 0; k < 3; k++) {
+                double dDer = 3 * d(j) * o(k) - 2 * o(j) * d(k);
+                if(j == k) {
+                    dDer += 3 * dot;
+                }
+                matGrad(i,3*k+j) = -dScale * (dDer/r5 - 5 * dNum * d(k)/r7);
+            }
+        }
+    }
+
+    return matGrad;
+}
+
+//=============================================================================================================
+
 Eigen::MatrixXd HPIFitData::compute_leadfield(const Eigen::MatrixXd& matPos, const SensorSet& sensors)
 {
 
@@ -458,3 +517,102 @@ Eigen::MatrixXd HPIFitData::fminsearch(const Eigen::MatrixXd& matPos,
     return x;
 }
 
+//=============================================================================================================
+
+Eigen::MatrixXd HPIFitData::levenbergMarquardt(const Eigen::MatrixXd& matPos,
+                                               int iMaxiter,
+                                               const Eigen::MatrixXd& matData,
+                                               const Eigen::MatrixXd& matProjectors,
+                                               const struct SensorSet& sensors,
+                                               int &iNumItr)
+{
+    const double dStepTol = 1e-5;       // Stop if the position changes less than 10 um
+    const double dMaxStep = 0.01;       // Restrict a single step to 1 cm to stay in the basin of far off starts
+    const double dLambdaMax = 1e10;
+    double dLambda = 1e-3;
+
+    int iNp = sensors.np;
+    int iNchan = matData.rows();
+
+    Eigen::MatrixXd matCurPos = matPos;
+    Eigen::MatrixXd matNewPos;
+    Eigen::MatrixXd matLfSensor, matLfGradSensor, matA, matQ;
+    Eigen::MatrixXd matLf(iNchan,3);
+    Eigen::MatrixXd matLfGrad(iNchan,9);
+    Eigen::MatrixXd matJ(iNchan,3);
+    Eigen::VectorXd vecRes;
+    Eigen::Matrix3d matJTJ, matH;
+    Eigen::Vector3d vecJTr, vecStep;
+
+    DipFitError curErr = dipfitError(matCurPos, matData, sensors, matProjectors);
+    DipFitError newErr;
+
+    iNumItr = 0;
+
+    while(iNumItr < iMaxiter) {
+        iNumItr++;
+
+        // Leadfield and its derivatives, averaged per coil
+        matLfSensor = compute_leadfield(matCurPos, sensors);
+        matLfGradSensor = magnetic_dipole_grad(matCurPos, sensors.rmag, sensors.cosmag);
+
+        for(int i = 0; i < sensors.ncoils; i++) {
+            matLf.row(i) = sensors.w.segment(i*iNp,iNp) * matLfSensor.block(i*iNp,0,iNp,3);
+            matLfGrad.row(i) = sensors.w.segment(i*iNp,iNp) * matLfGradSensor.block(i*iNp,0,iNp,9);
+        }
+
+        // Residual and its Jacobian for the current moment. The Jacobian is projected onto the orthogonal
+        // complement of the leadfield, which accounts for the moment being refitted at each position.
+        matA = matProjectors * matLf;
+        vecRes = matData - matA * curErr.moment;
+
+        for(int k = 0; k < 3; k++) {
+            matJ.col(k) = -matProjectors * (matLfGrad.block(0,3*k,iNchan,3) * curErr.moment);
+        }
+
+        Eigen::HouseholderQR<Eigen::MatrixXd> qr(matA);
+        matQ = qr.householderQ() * Eigen::MatrixXd::Identity(iNchan,3);
+        matJ -= matQ * (matQ.transpose() * matJ);
+
+        matJTJ = matJ.transpose() * matJ;
+        vecJTr = matJ.transpose() * vecRes;
+
+        bool bImproved = false;
+        bool bConverged = false;
+
+        while(dLambda < dLambdaMax) {
+            matH = matJTJ;
+            matH.diagonal() *= 1.0 + dLambda;
+            vecStep = -matH.ldlt().solve(vecJTr);
+
+            if(vecStep.norm() > dMaxStep) {
+                vecStep *= dMaxStep/vecStep.norm();
+            }
+
+            matNewPos = matCurPos + vecStep.transpose();
+            newErr = dipfitError(matNewPos, matData, sensors, matProjectors);
+
+            if(newErr.error < curErr.error) {
+                bConverged = vecStep.norm() < dStepTol || curErr.error - newErr.error < m_fAbortError * curErr.error;
+                matCurPos = matNewPos;
+                curErr = newErr;
+                dLambda = std::max(dLambda/10.0, 1e-7);
+                bImproved = true;
+                break;
+            }
+
+            // No improvement possible at the resolution we are interested in
+            if(vecStep.norm() < dStepTol) {
+                break;
+            }
+
+            dLambda *= 10.0;
+        }
+
+        if(!bImproved || bConverged) {
+            break;
+        }
+    }
+
+    return matCurPos;
+}
@@ -131,6 +131,7 @@ public:
 
     int                     m_iMaxIterations;
     float                   m_fAbortError;
+    bool                    m_bUseLevenbergMarquardt;
 
 protected:
     //=========================================================================================================
@@ -142,6 +143,16 @@ protected:
                                     Eigen::MatrixXd matPnt,
                                     Eigen::MatrixXd matOri);
 
+    //=========================================================================================================
+    /**
+     * magnetic_dipole_grad computes the derivatives of the magnetic_dipole leadfield with respect to the
+     * dipole position. The columns 3*k ... 3*k+2 hold the derivative of the leadfield columns x,y,z with
+     * respect to the k-th coordinate of the dipole position.
+     */
+    Eigen::MatrixXd magnetic_dipole_grad(const Eigen::MatrixXd& matPos,
+                                         const Eigen::MatrixXd& matPnt,
+                                         const Eigen::MatrixXd& matOri);
+
     //=========================================================================================================
     /**
      * compute_leadfield computes a forward solution for a dipole in a a volume
@@ -186,6 +197,30 @@ protected:
                                const Eigen::MatrixXd& matProjectors,
                                const struct SensorSet& sensors,
                                int &iSimplexNumitr);
+
+    //=========================================================================================================
+    /**
+     * Levenberg-Marquardt minimization of the dipfitError using the analytic derivatives of the
+     * magnetic_dipole leadfield. The moment is eliminated from the problem (variable projection),
+     * so only the three position parameters are iterated. The iteration stops early as soon as the
+     * position changes less than 10 um, which is reached after one or two iterations if the start is
+     * the previous position of a coil which has not moved.
+     *
+     * @param[in] matPos            The start position (1x3).
+     * @param[in] iMaxiter          The maximum number of iterations.
+     * @param[in] matData           The measured data.
+     * @param[in] matProjectors     The projectors to apply.
+     * @param[in] sensors           The sensor information.
+     * @param[out] iNumItr          The number of iterations used.
+     *
+     * @return The fitted position (1x3).
+     */
+    Eigen::MatrixXd levenbergMarquardt(const Eigen::MatrixXd& matPos,
+                                       int iMaxiter,
+                                       const Eigen::MatrixXd& matData,
+                                       const Eigen::MatrixXd& matProjectors,
+                                       const struct SensorSet& sensors,
+                                       int &iNumItr);
 };
 
 //=============================================================================================================
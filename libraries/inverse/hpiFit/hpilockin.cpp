@@ -0,0 +1,194 @@
+//=============================================================================================================
+/**
+ * @file     hpilockin.cpp
+ * @author   MNE-CPP authors
+ * @since    0.1.8
+ * @date     October, 2026
+ *
+ * @section  LICENSE
+ *
+ * Copyright (C) 2026, MNE-CPP authors. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ * the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+ *       following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ *       the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+ *       to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * @brief    HPILockIn class definition.
+ *
+ */
+
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "hpilockin.h"
+
+//=============================================================================================================
+// EIGEN INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Dense>
+
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <qmath.h>
+
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace INVERSELIB;
+using namespace Eigen;
+
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+HPILockIn::HPILockIn(double dSFreq,
+                     const QVector<int>& vecFreqs,
+                     int iLineFreq,
+                     double dWindow)
+: m_dSFreq(dSFreq)
+, m_vecFreqs(vecFreqs)
+, m_dLambda(1.0)
+, m_iNumSamples(0)
+, m_iWindowSamples(qMax(qint64(1), qint64(dWindow * dSFreq)))
+{
+    // Reference sinusoids: coil frequencies followed by the line frequency harmonics below Nyquist
+    QVector<double> vecRefFreqs;
+    for(int i = 0; i < vecFreqs.size(); ++i) {
+        vecRefFreqs.append(vecFreqs.at(i));
+    }
+    if(iLineFreq > 0) {
+        for(int i = 1; i <= 3 && i * iLineFreq < dSFreq / 2.0; ++i) {
+            vecRefFreqs.append(i * iLineFreq);
+        }
+    }
+
+    m_vecOmega.resize(vecRefFreqs.size());
+    for(int i = 0; i < vecRefFreqs.size(); ++i) {
+        m_vecOmega(i) = 2 * M_PI * vecRefFreqs.at(i) / dSFreq;
+    }
+
+    m_dLambda = 1.0 - 1.0 / m_iWindowSamples;
+
+    reset();
+}
+
+//=============================================================================================================
+
+void HPILockIn::reset()
+{
+    int iNumRef = 2 * m_vecOmega.size() + 1;
+
+    m_vecPhase = VectorXd::Zero(m_vecOmega.size());
+    m_matGram = MatrixXd::Zero(iNumRef, iNumRef);
+    m_matAcc.resize(iNumRef, 0);
+    m_iNumSamples = 0;
+}
+
+//=============================================================================================================
+
+void HPILockIn::append(const MatrixXd& matData)
+{
+    int iNumSamples = matData.cols();
+    int iNumSin = m_vecOmega.size();
+    int iNumRef = 2 * iNumSin + 1;
+
+    if(iNumSamples == 0) {
+        return;
+    }
+
+    if(m_matAcc.cols() != matData.rows()) {
+        reset();
+        m_matAcc = MatrixXd::Zero(iNumRef, matData.rows());
+    }
+
+    // The weights only depend on the block length
+    if(m_vecWeights.size() != iNumSamples) {
+        m_vecWeights.resize(iNumSamples);
+        double dWeight = 1.0;
+        for(int n = iNumSamples - 1; n >= 0; --n) {
+            m_vecWeights(n) = dWeight;
+            dWeight *= m_dLambda;
+        }
+    }
+
+    // Sine and cosine references of this block, continuing the phase of the previous block, and the DC term
+    MatrixXd matRef(iNumRef, iNumSamples);
+
+    for(int j = 0; j < iNumSin; ++j) {
+        for(int n = 0; n < iNumSamples; ++n) {
+            double dPhase = m_vecPhase(j) + n * m_vecOmega(j);
+            matRef(2*j, n) = std::sin(dPhase);
+            matRef(2*j+1, n) = std::cos(dPhase);
+        }
+        m_vecPhase(j) = std::fmod(m_vecPhase(j) + iNumSamples * m_vecOmega(j), 2 * M_PI);
+    }
+    matRef.row(iNumRef-1).setOnes();
+
+    MatrixXd matRefWeighted = matRef * m_vecWeights.asDiagonal();
+    double dDecay = std::pow(m_dLambda, iNumSamples);
+
+    m_matAcc = dDecay * m_matAcc + matRefWeighted * matData.transpose();
+    m_matGram = dDecay * m_matGram + matRefWeighted * matRef.transpose();
+
+    m_iNumSamples += iNumSamples;
+}
+
+//=============================================================================================================
+
+bool HPILockIn::isReady() const
+{
+    return m_iNumSamples >= m_iWindowSamples;
+}
+
+//=============================================================================================================
+
+MatrixXd HPILockIn::getAmplitudes() const
+{
+    int iNumCoils = m_vecFreqs.size();
+    MatrixXd matAmp = MatrixXd::Zero(m_matAcc.cols(), iNumCoils);
+
+    if(m_iNumSamples == 0) {
+        return matAmp;
+    }
+
+    // Least squares coefficients of all references (references x channels)
+    MatrixXd matCoeff = m_matGram.ldlt().solve(m_matAcc);
+
+    // Combine sine and cosine along the principal direction, i.e. the largest singular value times the
+    // right singular vector of the 2 x channels coefficient block
+    for(int i = 0; i < iNumCoils; ++i) {
+        MatrixXd matSinCos = matCoeff.middleRows(2*i, 2);
+        SelfAdjointEigenSolver<Matrix2d> eig(matSinCos * matSinCos.transpose());
+        Vector2d vecDir = eig.eigenvectors().col(1);
+        matAmp.col(i) = matSinCos.transpose() * vecDir;
+    }
+
+    return matAmp;
+}
+
+//=============================================================================================================
+
+QVector<int> HPILockIn::getFrequencies() const
+{
+    return m_vecFreqs;
+}
@@ -0,0 +1,154 @@
+//=============================================================================================================
+/**
+ * @file     hpilockin.h
+ * @author   MNE-CPP authors
+ * @since    0.1.8
+ * @date     October, 2026
+ *
+ * @section  LICENSE
+ *
+ * Copyright (C) 2026, MNE-CPP authors. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ * the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+ *       following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ *       the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+ *       to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * @brief    HPILockIn class declaration.
+ *
+ */
+
+#ifndef HPILOCKIN_H
+#define HPILOCKIN_H
+
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "../inverse_global.h"
+
+//=============================================================================================================
+// EIGEN INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QSharedPointer>
+#include <QVector>
+
+//=============================================================================================================
+// DEFINE NAMESPACE INVERSELIB
+//=============================================================================================================
+
+namespace INVERSELIB
+{
+
+//=============================================================================================================
+/**
+ * Streaming HPI amplitude estimation. The data are fed block by block and correlated with sine and cosine
+ * references at the coil frequencies (lock-in). Together with the Gram matrix of the references, which is
+ * accumulated the same way, this yields an exponentially weighted least squares estimate of the coil
+ * amplitudes. Crosstalk between the coil frequencies, the line frequency harmonics and the DC offset are
+ * accounted for by solving the small system of the references only, so the amplitudes can be read out at
+ * any cadence without building a design matrix for the window and computing its pseudo inverse.
+ *
+ * @brief Streaming lock-in estimation of the HPI coil amplitudes.
+ */
+class INVERSESHARED_EXPORT HPILockIn
+{
+
+public:
+    typedef QSharedPointer<HPILockIn> SPtr;             /**< Shared pointer type for HPILockIn. */
+    typedef QSharedPointer<const HPILockIn> ConstSPtr;  /**< Const shared pointer type for HPILockIn. */
+
+    //=========================================================================================================
+    /**
+     * Constructs the streaming estimator.
+     *
+     * @param[in] dSFreq        The sampling frequency in Hz.
+     * @param[in] vecFreqs      The coil frequencies in Hz.
+     * @param[in] iLineFreq     The line frequency in Hz. Its first three harmonics are estimated alongside if larger than 0.
+     * @param[in] dWindow       The effective length of the exponential window in seconds. Default is 0.2 s.
+     */
+    explicit HPILockIn(double dSFreq,
+                       const QVector<int>& vecFreqs,
+                       int iLineFreq = 0,
+                       double dWindow = 0.2);
+
+    //=========================================================================================================
+    /**
+     * Clears the accumulated inner products.
+     */
+    void reset();
+
+    //=========================================================================================================
+    /**
+     * Adds a block of data. The number of channels has to stay the same between calls, otherwise the
+     * estimator is reset.
+     *
+     * @param[in] matData       The data block (channels x samples).
+     */
+    void append(const Eigen::MatrixXd& matData);
+
+    //=========================================================================================================
+    /**
+     * Returns whether one window of data has been accumulated since the last reset.
+     *
+     * @return Whether the amplitudes are ready.
+     */
+    bool isReady() const;
+
+    //=========================================================================================================
+    /**
+     * Returns the amplitude topographies of the coils. The sine and cosine components of each coil are
+     * combined along their principal direction, which equals the phase estimation done in HPIFit::fitHPI.
+     *
+     * @return The amplitudes (channels x coils).
+     */
+    Eigen::MatrixXd getAmplitudes() const;
+
+    //=========================================================================================================
+    /**
+     * Returns the coil frequencies.
+     *
+     * @return The coil frequencies in Hz.
+     */
+    QVector<int> getFrequencies() const;
+
+private:
+    double              m_dSFreq;           /**< The sampling frequency in Hz. */
+    QVector<int>        m_vecFreqs;         /**< The coil frequencies in Hz. */
+    Eigen::VectorXd     m_vecOmega;         /**< The phase increment per sample of each reference sinusoid. */
+    Eigen::VectorXd     m_vecPhase;         /**< The phase of each reference sinusoid at the next sample. */
+    Eigen::VectorXd     m_vecWeights;       /**< The exponential weights for the last block length. */
+    Eigen::MatrixXd     m_matAcc;           /**< The weighted inner products of the references and the data (references x channels). */
+    Eigen::MatrixXd     m_matGram;          /**< The weighted Gram matrix of the references. */
+    double              m_dLambda;          /**< The forgetting factor per sample. */
+    qint64              m_iNumSamples;      /**< The number of samples since the last reset. */
+    qint64              m_iWindowSamples;   /**< The effective window length in samples. */
+};
+
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+} //NAMESPACE
+
+#endif // HPILOCKIN_H
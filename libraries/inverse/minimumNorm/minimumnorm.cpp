@@ -44,6 +44,8 @@
 #include <fiff/fiff_evoked.h>
 
 #include <iostream>
+#include <algorithm>
+#include <cmath>
 
 //=============================================================================================================
 // EIGEN INCLUDES
@@ -68,6 +70,9 @@ using namespace FIFFLIB;
 MinimumNorm::MinimumNorm(const MNEInverseOperator &p_inverseOperator, float lambda, const QString method)
 : m_inverseOperator(p_inverseOperator)
 , inverseSetup(false)
+, m_bInvPrepared(false)
+, m_iNave(1)
+, m_bCombineXyz(false)
 {
     this->setRegularization(lambda);
     this->setMethod(method);
@@ -78,6 +83,9 @@ MinimumNorm::MinimumNorm(const MNEInverseOperator &p_inverseOperator, float lamb
 MinimumNorm::MinimumNorm(const MNEInverseOperator &p_inverseOperator, float lambda, bool dSPM, bool sLORETA)
 : m_inverseOperator(p_inverseOperator)
 , inverseSetup(false)
+, m_bInvPrepared(false)
+, m_iNave(1)
+, m_bCombineXyz(false)
 {
     this->setRegularization(lambda);
     this->setMethod(dSPM, sLORETA);
@@ -235,23 +243,115 @@ MNESourceEstimate MinimumNorm::calculateInverse(const MatrixXd &data, float tmin
 
 //=============================================================================================================
 
+bool MinimumNorm::applyInverse(const MatrixXf &matData, MatrixXf &matSol, int iBlockSize) const
+{
+    if(!inverseSetup) {
+        qWarning("MinimumNorm::applyInverse - Inverse not setup -> call doInverseSetup first!");
+        return false;
+    }
+
+    if(m_matKernelNorm.cols() != matData.rows()) {
+        qWarning() << "MinimumNorm::applyInverse - Dimension mismatch between kernel cols and data rows -" << m_matKernelNorm.cols() << "and" << matData.rows();
+        return false;
+    }
+
+    const int iNumSources = m_bCombineXyz ? m_matKernelNorm.rows() / 3 : m_matKernelNorm.rows();
+    const int iNumSamples = matData.cols();
+
+    if(matSol.rows() != iNumSources || matSol.cols() != iNumSamples) {
+        matSol.resize(iNumSources, iNumSamples);
+    }
+
+    if(!m_bCombineXyz) {
+        matSol.noalias() = m_matKernelNorm * matData;
+        return true;
+    }
+
+    iBlockSize = std::max(1, std::min(iBlockSize, iNumSamples));
+
+    MatrixXf matBlock(m_matKernelNorm.rows(), iBlockSize);
+
+    for(int iStart = 0; iStart < iNumSamples; iStart += iBlockSize) {
+        const int iCols = std::min(iBlockSize, iNumSamples - iStart);
+
+        matBlock.leftCols(iCols).noalias() = m_matKernelNorm * matData.middleCols(iStart, iCols);
+
+        //sqrt(x^2 + y^2 + z^2) of the three consecutive component rows of each source
+        for(int t = 0; t < iCols; ++t) {
+            const float* pComp = matBlock.col(t).data();
+            float* pSol = matSol.col(iStart + t).data();
+
+            for(int i = 0; i < iNumSources; ++i) {
+                pSol[i] = std::sqrt(pComp[3*i]*pComp[3*i] + pComp[3*i+1]*pComp[3*i+1] + pComp[3*i+2]*pComp[3*i+2]);
+            }
+        }
+    }
+
+    return true;
+}
+
+//=============================================================================================================
+
 void MinimumNorm::doInverseSetup(qint32 nave, bool pick_normal)
 {
     //
-    //   Set up the inverse according to the parameters
+    //   Set up the inverse according to the parameters. The kernel is taken from the kernel cache of the
+    //   inverse operator if it was already assembled for these parameters.
     //
-    inv = m_inverseOperator.prepare_inverse_operator(nave, m_fLambda, m_bdSPM, m_bsLORETA);
-
     printf("Computing inverse...\n");
-    inv.assemble_kernel(label, m_sMethod, pick_normal, K, noise_norm, vertno);
+    if(!m_inverseOperator.prepare_kernel(nave, m_fLambda, m_bdSPM, m_bsLORETA, pick_normal, K, noise_norm, vertno)) {
+        qWarning("MinimumNorm::doInverseSetup - Could not assemble the inverse kernel.");
+        inverseSetup = false;
+        return;
+    }
+
+    //
+    //   Only the members needed to apply the kernel are set here, the fully prepared operator is created on demand
+    //   by getPreparedInverseOperator.
+    //
+    inv = m_inverseOperator;
+    inv.nave = nave;
+    inv.noisenorm = noise_norm;
+    m_iNave = nave;
+    m_bInvPrepared = false;
 
     std::cout << "K " << K.rows() << " x " << K.cols() << std::endl;
 
+    //Single precision kernel for applyInverse. The noise normalization is a positive diagonal matrix applied after
+    //combining the orientations, so it can be folded into the rows of the kernel beforehand.
+    m_bCombineXyz = (inv.source_ori == FIFFV_MNE_FREE_ORI && pick_normal == false);
+    m_matKernelNorm = K.cast<float>();
+
+    if((m_bdSPM || m_bsLORETA) && inv.noisenorm.rows() > 0) {
+        const int iNumComp = m_bCombineXyz ? 3 : 1;
+        VectorXd vecNoiseNorm = inv.noisenorm.diagonal();
+
+        if(vecNoiseNorm.size() * iNumComp == m_matKernelNorm.rows()) {
+            for(int i = 0; i < m_matKernelNorm.rows(); ++i) {
+                m_matKernelNorm.row(i) *= static_cast<float>(vecNoiseNorm(i / iNumComp));
+            }
+        } else {
+            qWarning() << "MinimumNorm::doInverseSetup - Noise normalization does not fit the kernel -" << vecNoiseNorm.size() << "and" << m_matKernelNorm.rows();
+        }
+    }
+
     inverseSetup = true;
 }
 
 //=============================================================================================================
 
+MNEInverseOperator& MinimumNorm::getPreparedInverseOperator()
+{
+    if(inverseSetup && !m_bInvPrepared) {
+        inv = m_inverseOperator.prepare_inverse_operator(m_iNave, m_fLambda, m_bdSPM, m_bsLORETA);
+        m_bInvPrepared = true;
+    }
+
+    return inv;
+}
+
+//=============================================================================================================
+
 const char* MinimumNorm::getName() const
 {
     return "Minimum Norm Estimate";
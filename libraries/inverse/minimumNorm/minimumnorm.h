@@ -114,6 +114,22 @@ public:
 
     virtual MNELIB::MNESourceEstimate calculateInverse(const Eigen::MatrixXd &data, float tmin, float tstep, bool pick_normal = false) const;
 
+    //=========================================================================================================
+    /**
+     * Applies the inverse in single precision. The noise normalization of dSPM and sLORETA is already folded
+     * into the single precision kernel by doInverseSetup. For free orientations the components are combined
+     * right after the kernel product of each block of time samples, so the full component solution is never
+     * stored. The orientation handling is the one selected by pick_normal in doInverseSetup.
+     *
+     * @param[in] matData        The data (channels x samples).
+     * @param[in, out] matSol    The source solution (sources x samples). It is only resized if its size does
+     *                           not fit, so the same buffer can be reused for every data block.
+     * @param[in] iBlockSize     Number of time samples which are processed at once.
+     *
+     * @return true if the inverse was applied, false otherwise.
+     */
+    bool applyInverse(const Eigen::MatrixXf &matData, Eigen::MatrixXf &matSol, int iBlockSize = 64) const;
+
     //=========================================================================================================
     /**
      * Perform the inverse setup: Prepares this inverse operator and assembles the kernel.
@@ -142,11 +158,12 @@ public:
 
     //=========================================================================================================
     /**
-     * Get the prepared inverse operator.
+     * Get the prepared inverse operator. Since the kernel can be taken from the kernel cache of the inverse
+     * operator, the operator is only prepared when it is requested here for the first time after doInverseSetup.
      *
      * @return the prepared inverse operator
      */
-    inline MNELIB::MNEInverseOperator& getPreparedInverseOperator();
+    MNELIB::MNEInverseOperator& getPreparedInverseOperator();
 
     //=========================================================================================================
     /**
@@ -189,11 +206,15 @@ private:
     bool m_bdSPM;                                   /**< Do dSPM method */
 
     bool inverseSetup;                              /**< Inverse Setup Calcluated */
+    bool m_bInvPrepared;                            /**< Whether inv holds the fully prepared inverse operator */
+    qint32 m_iNave;                                 /**< Number of averages of the last inverse setup */
     MNELIB::MNEInverseOperator inv;                 /**< The setup inverse operator */
     Eigen::SparseMatrix<double> noise_norm;         /**< The noise normalization */
     QList<Eigen::VectorXi> vertno;                  /**< The vertices numbers */
     FSLIB::Label label;                             /**< The corresponding labels */
     Eigen::MatrixXd K;                              /**< Imaging kernel */
+    Eigen::MatrixXf m_matKernelNorm;                /**< Single precision imaging kernel with the noise normalization folded in */
+    bool m_bCombineXyz;                             /**< Whether applyInverse combines the three orientation components */
 };
 
 //=============================================================================================================
@@ -205,12 +226,6 @@ inline Eigen::MatrixXd& MinimumNorm::getKernel()
     return K;
 }
 
-//=============================================================================================================
-
-inline MNELIB::MNEInverseOperator& MinimumNorm::getPreparedInverseOperator()
-{
-    return inv;
-}
 } //NAMESPACE
 
 #endif // MINIMUMNORM_H
@@ -220,18 +220,19 @@ MNESourceEstimate PwlRapMusic::calculateInverse(const MatrixXd& p_matMeasurement
             #pragma omp parallel num_threads(m_iMaxNumThreads)
             #endif
             {
+                //One gain pair buffer per thread
+                MatrixX6T t_matProj_G(t_matProj_LeadField.rows(),6);
+                int idx1 = 0;
+                int idx2 = 0;
+
             #ifdef _OPENMP
             #pragma omp for
             #endif
                 for(int i = 0; i < t_iNumVecElements; i++)
                 {
                     int k = t_pVecIdxElements(i);
-                    //new Version: calculate matrix multiplication before
-                    //Create Lead Field combinations -> It would be better to use a pointer construction, to increase performance
-                    MatrixX6T t_matProj_G(t_matProj_LeadField.rows(),6);
 
-                    int idx1 = m_ppPairIdxCombinations[k]->x1;
-                    int idx2 = m_ppPairIdxCombinations[k]->x2;
+                    RapMusic::getPointPair(m_iNumGridPoints, k, idx1, idx2);
 
                     RapMusic::getGainMatrixPair(t_matProj_LeadField, t_matProj_G, idx1, idx2);
 
@@ -270,8 +271,7 @@ MNESourceEstimate PwlRapMusic::calculateInverse(const MatrixXd& p_matMeasurement
             {
                 t_iMaxIdx_old = t_iMaxIdx;
                 //get positions in sparsed leadfield from index combinations;
-                t_iIdx1 = m_ppPairIdxCombinations[t_iMaxIdx]->x1;
-                t_iIdx2 = m_ppPairIdxCombinations[t_iMaxIdx]->x2;
+                RapMusic::getPointPair(m_iNumGridPoints, (int)t_iMaxIdx, t_iIdx1, t_iIdx2);
             }
 
             //set new index
@@ -41,6 +41,9 @@
 
 #include <utils/mnemath.h>
 
+#include <algorithm>
+#include <vector>
+
 #ifdef _OPENMP
 #include <omp.h>
 #endif
@@ -64,11 +67,13 @@ RapMusic::RapMusic()
 , m_iNumGridPoints(0)
 , m_iNumChannels(0)
 , m_iNumLeadFieldCombinations(0)
-, m_ppPairIdxCombinations(NULL)
 , m_iMaxNumThreads(1)
 , m_bIsInit(false)
 , m_iSamplesStcWindow(-1)
 , m_fStcOverlap(-1)
+, m_bPrunedSearch(false)
+, m_iNumCandidates(200)
+, m_iNumTopPairs(50)
 {
 }
 
@@ -80,11 +85,13 @@ RapMusic::RapMusic(MNEForwardSolution& p_pFwd, bool p_bSparsed, int p_iN, double
 , m_iNumGridPoints(0)
 , m_iNumChannels(0)
 , m_iNumLeadFieldCombinations(0)
-, m_ppPairIdxCombinations(NULL)
 , m_iMaxNumThreads(1)
 , m_bIsInit(false)
 , m_iSamplesStcWindow(-1)
 , m_fStcOverlap(-1)
+, m_bPrunedSearch(false)
+, m_iNumCandidates(200)
+, m_iNumTopPairs(50)
 {
     //Init
     init(p_pFwd, p_bSparsed, p_iN, p_dThr);
@@ -94,8 +101,6 @@ RapMusic::RapMusic(MNEForwardSolution& p_pFwd, bool p_bSparsed, int p_iN, double
 
 RapMusic::~RapMusic()
 {
-    if(m_ppPairIdxCombinations != NULL)
-        free(m_ppPairIdxCombinations);
 }
 
 //=============================================================================================================
@@ -148,20 +153,9 @@ bool RapMusic::init(MNEForwardSolution& p_pFwd, bool p_bSparsed, int p_iN, doubl
 
     m_ForwardSolution = p_pFwd;
 
-    //##### Calc lead field combination #####
-
-    std::cout << "Calculate gain matrix combinations. \n";
-
+    //Pair indices are computed on the fly from the combination index (see getPointPair)
     m_iNumLeadFieldCombinations = MNEMath::nchoose2(m_iNumGridPoints+1);
 
-    m_ppPairIdxCombinations = (Pair **)malloc(m_iNumLeadFieldCombinations * sizeof(Pair *));
-
-    calcPairCombinations(m_iNumGridPoints, m_iNumLeadFieldCombinations, m_ppPairIdxCombinations);
-
-    std::cout << "Gain matrix combinations calculated. \n\n";
-
-    //##### Calc lead field combination end #####
-
     std::cout << "Number of grid points: " << m_iNumGridPoints << "\n\n";
 
     std::cout << "Number of combinated points: " << m_iNumLeadFieldCombinations << "\n\n";
@@ -459,36 +453,56 @@ MNESourceEstimate RapMusic::calculateInverse(const MatrixXd& p_matMeasurement, Q
         MatrixXT t_matU_B;
         useFullRank(t_svdProj_Phi_S.matrixU(), t_svdProj_Phi_S.singularValues().asDiagonal(), t_matU_B);
 
-        //Inits
-        VectorXT t_vecRoh(m_iNumLeadFieldCombinations,1);
-        t_vecRoh.setZero();
-
         //subcorr benchmark
         //Stop the time
         clock_t start_subcorr, end_subcorr;
         start_subcorr = clock();
 
-        //Multithreading correlation calculation
-        #ifdef _OPENMP
-        #pragma omp parallel num_threads(m_iMaxNumThreads)
-        #endif
+        //Find the maximum of correlation
+        double t_val_roh_k;
+        int t_iIdx1 = 0;
+        int t_iIdx2 = 0;
+
+        if(m_bPrunedSearch)
+        {
+            t_val_roh_k = calcPrunedPairSearch(t_matProj_LeadField, t_matU_B, t_iIdx1, t_iIdx2);
+        }
+        else
         {
-        #ifdef _OPENMP
-        #pragma omp for
-        #endif
-            for(int i = 0; i < m_iNumLeadFieldCombinations; i++)
+            //Inits
+            VectorXT t_vecRoh(m_iNumLeadFieldCombinations,1);
+            t_vecRoh.setZero();
+
+            //Multithreading correlation calculation
+            #ifdef _OPENMP
+            #pragma omp parallel num_threads(m_iMaxNumThreads)
+            #endif
             {
-                //new Version: calculate matrix multiplication before
-                //Create Lead Field combinations -> It would be better to use a pointer construction, to increase performance
+                //One gain pair buffer per thread
                 MatrixX6T t_matProj_G(t_matProj_LeadField.rows(),6);
+                int idx1 = 0;
+                int idx2 = 0;
 
-                int idx1 = m_ppPairIdxCombinations[i]->x1;
-                int idx2 = m_ppPairIdxCombinations[i]->x2;
+            #ifdef _OPENMP
+            #pragma omp for
+            #endif
+                for(int i = 0; i < m_iNumLeadFieldCombinations; i++)
+                {
+                    RapMusic::getPointPair(m_iNumGridPoints, i, idx1, idx2);
 
-                RapMusic::getGainMatrixPair(t_matProj_LeadField, t_matProj_G, idx1, idx2);
+                    RapMusic::getGainMatrixPair(t_matProj_LeadField, t_matProj_G, idx1, idx2);
 
-                t_vecRoh(i) = RapMusic::subcorr(t_matProj_G, t_matU_B);//t_vecRoh holds the correlations roh_k
+                    t_vecRoh(i) = RapMusic::subcorr(t_matProj_G, t_matU_B);//t_vecRoh holds the correlations roh_k
+                }
             }
+
+            //Can't put this in the for loop because it's running in different threads.
+            VectorXT::Index t_iMaxIdx;
+
+            t_val_roh_k = t_vecRoh.maxCoeff(&t_iMaxIdx);//p_vecCor = ^roh_k
+
+            //get positions in sparsed leadfield from index combinations;
+            RapMusic::getPointPair(m_iNumGridPoints, (int)t_iMaxIdx, t_iIdx1, t_iIdx2);
         }
 
 //         if(r==0)
@@ -513,17 +527,6 @@ MNESourceEstimate RapMusic::calculateInverse(const MatrixXd& p_matMeasurement, Q
         float t_fSubcorrElapsedTime = ( (float)(end_subcorr-start_subcorr) / (float)CLOCKS_PER_SEC ) * 1000.0f;
         std::cout << "Time Elapsed: " << t_fSubcorrElapsedTime << " ms" << std::endl;
 
-        //Find the maximum of correlation - can't put this in the for loop because it's running in different threads.
-        double t_val_roh_k;
-
-        VectorXT::Index t_iMaxIdx;
-
-        t_val_roh_k = t_vecRoh.maxCoeff(&t_iMaxIdx);//p_vecCor = ^roh_k
-
-        //get positions in sparsed leadfield from index combinations;
-        int t_iIdx1 = m_ppPairIdxCombinations[t_iMaxIdx]->x1;
-        int t_iIdx2 = m_ppPairIdxCombinations[t_iMaxIdx]->x2;
-
         // (Idx+1) because of MATLAB positions -> starting with 1 not with 0
         std::cout << "Iteration: " << r+1 << " of " << t_iMaxSearch
             << "; Correlation: " << t_val_roh_k<< "; Position (Idx+1): " << t_iIdx1+1 << " - " << t_iIdx2+1 <<"\n\n";
@@ -790,32 +793,162 @@ void RapMusic::calcOrthProj(const MatrixXT& p_matA_k_1, MatrixXT& p_matOrthProj)
 
 //=============================================================================================================
 
-void RapMusic::calcPairCombinations(    const int p_iNumPoints,
-                                        const int p_iNumCombinations,
-                                        Pair** p_ppPairIdxCombinations) const
+double RapMusic::calcPrunedPairSearch(const MatrixXT& p_matProj_LeadField,
+                                      const MatrixXT& p_matU_B,
+                                      int &p_iIdx1,
+                                      int &p_iIdx2) const
 {
-    int idx1 = 0;
-    int idx2 = 0;
+    //Orthonormal bases of all projected point gains and their correlation with the signal subspace
+    MatrixXT t_matQ;
+    calcPointSubspaces(p_matProj_LeadField, t_matQ);
+
+    MatrixXT t_matC = t_matQ.transpose() * p_matU_B;
+
+    //Stage 1: score the single points and keep the best ones as candidates
+    VectorXT t_vecPointCor(m_iNumGridPoints);
+
+    #ifdef _OPENMP
+    #pragma omp parallel for num_threads(m_iMaxNumThreads)
+    #endif
+    for(int i = 0; i < m_iNumGridPoints; ++i)
+    {
+        Eigen::JacobiSVD<MatrixXT> t_svdCor(t_matC.block(i*3, 0, 3, t_matC.cols()));
+        t_vecPointCor(i) = t_svdCor.singularValues()(0);
+    }
+
+    int t_iNumCandidates = std::min(std::max(m_iNumCandidates, 1), m_iNumGridPoints);
+
+    std::vector<int> t_vecCandidates(m_iNumGridPoints);
+    for(int i = 0; i < m_iNumGridPoints; ++i)
+        t_vecCandidates[i] = i;
+
+    std::partial_sort(t_vecCandidates.begin(), t_vecCandidates.begin() + t_iNumCandidates, t_vecCandidates.end(),
+                      [&t_vecPointCor](int a, int b) { return t_vecPointCor(a) > t_vecPointCor(b); });
+    t_vecCandidates.resize(t_iNumCandidates);
+    std::sort(t_vecCandidates.begin(), t_vecCandidates.end());
+
+    //Score all candidate pairs with the precomputed bases
+    int t_iNumCandidatePairs = MNEMath::nchoose2(t_iNumCandidates+1);
+    VectorXT t_vecPairCor(t_iNumCandidatePairs);
 
-    //Process Code in {m_max_num_threads} threads -> When compile with Intel Compiler -> probably obsolete
     #ifdef _OPENMP
-    #pragma omp parallel num_threads(m_iMaxNumThreads) private(idx1, idx2)
+    #pragma omp parallel num_threads(m_iMaxNumThreads)
     #endif
     {
+        int idx1 = 0;
+        int idx2 = 0;
+
     #ifdef _OPENMP
     #pragma omp for
     #endif
-        for (int i = 0; i < p_iNumCombinations; ++i)
+        for(int i = 0; i < t_iNumCandidatePairs; ++i)
         {
-            RapMusic::getPointPair(p_iNumPoints, i, idx1, idx2);
+            RapMusic::getPointPair(t_iNumCandidates, i, idx1, idx2);
+            t_vecPairCor(i) = RapMusic::subcorrPair(t_matQ, t_matC, t_vecCandidates[idx1], t_vecCandidates[idx2]);
+        }
+    }
+
+    //Stage 2: compute the exact correlation of the best candidate pairs only
+    int t_iNumTopPairs = std::min(std::max(m_iNumTopPairs, 1), t_iNumCandidatePairs);
+
+    std::vector<int> t_vecTopPairs(t_iNumCandidatePairs);
+    for(int i = 0; i < t_iNumCandidatePairs; ++i)
+        t_vecTopPairs[i] = i;
+
+    std::partial_sort(t_vecTopPairs.begin(), t_vecTopPairs.begin() + t_iNumTopPairs, t_vecTopPairs.end(),
+                      [&t_vecPairCor](int a, int b) { return t_vecPairCor(a) > t_vecPairCor(b); });
 
-            Pair* t_pairCombination = new Pair();
-            t_pairCombination->x1 = idx1;
-            t_pairCombination->x2 = idx2;
+    VectorXT t_vecRoh(t_iNumTopPairs);
 
-            p_ppPairIdxCombinations[i] = t_pairCombination;
+    #ifdef _OPENMP
+    #pragma omp parallel num_threads(m_iMaxNumThreads)
+    #endif
+    {
+        MatrixX6T t_matProj_G(p_matProj_LeadField.rows(),6);
+        int idx1 = 0;
+        int idx2 = 0;
+
+    #ifdef _OPENMP
+    #pragma omp for
+    #endif
+        for(int i = 0; i < t_iNumTopPairs; ++i)
+        {
+            RapMusic::getPointPair(t_iNumCandidates, t_vecTopPairs[i], idx1, idx2);
+            RapMusic::getGainMatrixPair(p_matProj_LeadField, t_matProj_G, t_vecCandidates[idx1], t_vecCandidates[idx2]);
+            t_vecRoh(i) = RapMusic::subcorr(t_matProj_G, p_matU_B);
         }
     }
+
+    VectorXT::Index t_iMaxIdx;
+    double t_dMaxCor = t_vecRoh.maxCoeff(&t_iMaxIdx);
+
+    int idx1 = 0;
+    int idx2 = 0;
+    RapMusic::getPointPair(t_iNumCandidates, t_vecTopPairs[t_iMaxIdx], idx1, idx2);
+    p_iIdx1 = t_vecCandidates[idx1];
+    p_iIdx2 = t_vecCandidates[idx2];
+
+    return t_dMaxCor;
+}
+
+//=============================================================================================================
+
+void RapMusic::calcPointSubspaces(const MatrixXT& p_matProj_LeadField, MatrixXT& p_matQ) const
+{
+    p_matQ = MatrixXT::Zero(p_matProj_LeadField.rows(), p_matProj_LeadField.cols());
+
+    #ifdef _OPENMP
+    #pragma omp parallel for num_threads(m_iMaxNumThreads)
+    #endif
+    for(int i = 0; i < m_iNumGridPoints; ++i)
+    {
+        const MatrixXT t_matG = p_matProj_LeadField.block(0, i*3, p_matProj_LeadField.rows(), 3);
+
+        //G = U S V^T -> U = G V S^-1, where V and S^2 are the eigen decomposition of the 3 x 3 Gram matrix
+        Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d> t_eigGram(t_matG.transpose() * t_matG);
+        const Eigen::Vector3d& t_vecEigVal = t_eigGram.eigenvalues();
+
+        //Eigenvalues are sorted ascending
+        double t_dThr = 1e-12 * t_vecEigVal(2);
+
+        for(int j = 0; j < 3; ++j)
+        {
+            if(t_vecEigVal(j) > t_dThr && t_vecEigVal(j) > 0)
+                p_matQ.col(i*3+j) = t_matG * t_eigGram.eigenvectors().col(j) / sqrt(t_vecEigVal(j));
+        }
+    }
+}
+
+//=============================================================================================================
+
+double RapMusic::subcorrPair(const MatrixXT& p_matQ, const MatrixXT& p_matC, int p_iIdx1, int p_iIdx2)
+{
+    const int t_iRank = p_matC.cols();
+
+    Eigen::Matrix3d t_matM = p_matQ.block(0, p_iIdx1*3, p_matQ.rows(), 3).transpose() * p_matQ.block(0, p_iIdx2*3, p_matQ.rows(), 3);
+
+    //Gram matrix of the part of the second basis which is orthogonal to the first one
+    Eigen::Matrix3d t_matN = p_matQ.block(0, p_iIdx2*3, p_matQ.rows(), 3).colwise().squaredNorm().asDiagonal();
+    t_matN -= t_matM.transpose() * t_matM;
+
+    Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d> t_eigN(t_matN);
+
+    MatrixXT t_matS = MatrixXT::Zero(6, t_iRank);
+    t_matS.topRows(3) = p_matC.block(p_iIdx1*3, 0, 3, t_iRank);
+
+    MatrixXT t_matC2 = p_matC.block(p_iIdx2*3, 0, 3, t_iRank) - t_matM.transpose() * p_matC.block(p_iIdx1*3, 0, 3, t_iRank);
+
+    for(int j = 0; j < 3; ++j)
+    {
+        if(t_eigN.eigenvalues()(j) > 1e-8)
+            t_matS.row(3+j) = t_eigN.eigenvectors().col(j).transpose() * t_matC2 / sqrt(t_eigN.eigenvalues()(j));
+    }
+
+    //The largest singular value of S is the maximal subspace correlation
+    Matrix6T t_matSS = t_matS * t_matS.transpose();
+    Eigen::SelfAdjointEigenSolver<Matrix6T> t_eigS(t_matSS, Eigen::EigenvaluesOnly);
+
+    return sqrt(std::max(t_eigS.eigenvalues()(5), 0.0));
 }
 
 //=============================================================================================================
@@ -881,3 +1014,12 @@ void RapMusic::setStcAttr(int p_iSampStcWin, float p_fStcOverlap)
     m_iSamplesStcWindow = p_iSampStcWin;
     m_fStcOverlap = p_fStcOverlap;
 }
+
+//=============================================================================================================
+
+void RapMusic::setPairSearch(bool p_bPruned, int p_iNumCandidates, int p_iNumTopPairs)
+{
+    m_bPrunedSearch = p_bPruned;
+    m_iNumCandidates = p_iNumCandidates;
+    m_iNumTopPairs = p_iNumTopPairs;
+}
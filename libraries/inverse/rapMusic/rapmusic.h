@@ -73,16 +73,6 @@ namespace INVERSELIB
 #define NOT_TRANSPOSED   0  /**< Defines NOT_TRANSPOSED */
 #define IS_TRANSPOSED   1   /**< Defines IS_TRANSPOSED */
 
-//=============================================================================================================
-/**
- * Declares a pair structure for index combinations used in RAP MUSIC algorithm.
- */
-typedef struct Pair
-{
-    int x1; /**< Index one of the pair. */
-    int x2; /**< Index two of the pair. */
-} Pair;
-
 //=============================================================================================================
 /**
  * @brief    The RapMusic class provides the RAP MUSIC Algorithm CPU implementation. ToDo: Paper references.
@@ -165,6 +155,20 @@ public:
      */
     void setStcAttr(int p_iSampStcWin, float p_fStcOverlap);
 
+    //=========================================================================================================
+    /**
+     * Sets the search strategy for the best correlated dipole pair. The exhaustive search computes the subspace
+     * correlation of every grid point pair. The pruned search first scores all single grid points against the
+     * signal subspace and keeps the p_iNumCandidates best ones. The pairs of candidates are then scored with
+     * the precomputed orthonormal bases of the projected point gains, and the exact subspace correlation is
+     * only computed for the p_iNumTopPairs best of them.
+     *
+     * @param[in] p_bPruned          Whether to use the pruned search (default false = exhaustive search).
+     * @param[in] p_iNumCandidates   The number of single grid points which are kept as candidates.
+     * @param[in] p_iNumTopPairs     The number of candidate pairs for which the exact correlation is computed.
+     */
+    void setPairSearch(bool p_bPruned, int p_iNumCandidates = 200, int p_iNumTopPairs = 50);
+
 protected:
     //=========================================================================================================
     /**
@@ -236,18 +240,42 @@ protected:
 
     //=========================================================================================================
     /**
-     * Pre-Calculates the gain matrix index combinations to search for a two dipole independent topography
-     * (IT = source).
+     * Searches the best correlated dipole pair with the pruned two-stage search (see setPairSearch).
+     *
+     * @param[in] p_matProj_LeadField    The projected Lead Field.
+     * @param[in] p_matU_B               The matrix U is the subspace projection of the orthogonal projected Phi_s
+     * @param[out] p_iIdx1               The first grid index of the best correlated pair.
+     * @param[out] p_iIdx2               The second grid index of the best correlated pair.
+     * @return   The subspace correlation of the best correlated pair.
+     */
+    double calcPrunedPairSearch(const MatrixXT& p_matProj_LeadField,
+                                const MatrixXT& p_matU_B,
+                                int &p_iIdx1,
+                                int &p_iIdx2) const;
+
+    //=========================================================================================================
+    /**
+     * Computes an orthonormal basis of the projected gain of every grid point. Columns which belong to
+     * vanishing singular values of a point are set to zero.
+     *
+     * @param[in] p_matProj_LeadField    The projected Lead Field (m x 3*points).
+     * @param[out] p_matQ                The orthonormal bases (m x 3*points).
+     */
+    void calcPointSubspaces(const MatrixXT& p_matProj_LeadField, MatrixXT& p_matQ) const;
+
+    //=========================================================================================================
+    /**
+     * Computes the subspace correlation of a dipole pair from the orthonormal bases of the two points. The
+     * basis of the second point is orthogonalized against the first one, so only 3 x 3 and 6 x 6 problems
+     * have to be solved instead of an SVD of the m x 6 gain pair.
      *
-     * @param[in] p_iNumPoints   The number of Lead Field points -> for dimension check
-     * @param[in] p_iNumCombinations The number of pair index combinations.
-     * @param[out] p_ppPairIdxCombinations   The destination which contains pointer to pointer of index
-     *                                       combinations of Lead Field indices -> Number of pointers =
-     *                                       Combination (number of grid points over 2 = Num + 1 C 2)
+     * @param[in] p_matQ     The orthonormal bases of all points (m x 3*points).
+     * @param[in] p_matC     The correlations of the bases with U_B, p_matQ^T * U_B (3*points x r).
+     * @param[in] p_iIdx1    first Lead Field index point
+     * @param[in] p_iIdx2    second Lead Field index point
+     * @return   The maximal correlation c_1 of the subspace correlation.
      */
-    void calcPairCombinations(  const int p_iNumPoints,
-                                const int p_iNumCombinations,
-                                Pair** p_ppPairIdxCombinations) const;
+    static double subcorrPair(const MatrixXT& p_matQ, const MatrixXT& p_matC, int p_iIdx1, int p_iIdx2);
 
     //=========================================================================================================
     /**
@@ -306,7 +334,9 @@ protected:
     int m_iNumChannels;                 /**< Number of channels */
     int m_iNumLeadFieldCombinations;    /**< Number of Lead Filed combinations (grid points + 1 over 2)*/
 
-    Pair** m_ppPairIdxCombinations; /**< Index combination vector with grid pair indices. */
+    bool m_bPrunedSearch;   /**< Whether the pruned pair search is used instead of the exhaustive one. */
+    int m_iNumCandidates;   /**< Number of single grid points kept as candidates by the pruned search. */
+    int m_iNumTopPairs;     /**< Number of candidate pairs for which the pruned search computes the exact correlation. */
 
     int m_iMaxNumThreads;   /**< Number of available CPU threads. */
 
@@ -65,6 +65,7 @@ FilterThreadArg::FilterThreadArg()
 ,surf       (NULL)
 ,limit      (-1)
 ,filtered   (NULL)
+,use_threads(false)
 ,stat       (FAIL)
 {
 }
@@ -99,6 +99,7 @@ public:
     MneSurfaceOld*   surf;          /* The inner skull surface */
     float          limit;           /* Distance limit */
     FILE           *filtered;       /* Log omitted point locations here */
+    bool           use_threads;     /* Test the points in parallel? */
     int            stat;            /* How was it? */
 
 // ### OLD STRUCT ###
@@ -108,6 +109,7 @@ public:
 //    MneSurfaceOld*   surf;          /* The inner skull surface */
 //    float          limit;           /* Distance limit */
 //    FILE           *filtered;       /* Log omitted point locations here */
+//    bool           use_threads;     /* Test the points in parallel? */
 //    int            stat;            /* How was it? */
 //} *filterThreadArg,filterThreadArgRec;
 };
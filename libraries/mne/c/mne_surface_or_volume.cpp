@@ -51,6 +51,7 @@
 #include "mne_vol_geom.h"
 #include "mne_mgh_tag_group.h"
 #include "mne_mgh_tag.h"
+#include "../mne_triangle_bvh.h"
 
 #include <fiff/fiff_stream.h>
 #include <fiff/c/fiff_digitizer_data.h>
@@ -60,8 +61,11 @@
 #include <utils/ioutils.h>
 
 #include <QFile>
+#include <QSaveFile>
 #include <QCoreApplication>
+#include <QCryptographicHash>
 #include <QtConcurrent>
+#include <QMutex>
 
 #define _USE_MATH_DEFINES
 #include <math.h>
@@ -329,6 +333,7 @@ void mne_sort_nearest_by_nearest(MneNearest* points, int npoint)
 //=============================================================================================================
 
 MneSurfaceOrVolume::MneSurfaceOrVolume()
+: triangle_bvh(NULL)
 {
 }
 
@@ -352,6 +357,7 @@ MneSurfaceOrVolume::~MneSurfaceOrVolume()
         FREE_17(this->neighbor_tri);
     }
     FREE_17(this->nneighbor_tri);
+    delete this->triangle_bvh.loadAcquire();
     FREE_17(this->curv);
 
     if (this->neighbor_vert) {
@@ -429,6 +435,197 @@ double MneSurfaceOrVolume::sum_solids(float *from, MneSurfaceOld* surf)
     return tot_angle;
 }
 
+//============================= filter_source_space.c =============================
+/*
+ * The inside test sums the solid angles of all triangles of the bounding
+ * surface as seen from each source point. The triangle corners and the
+ * vertices are kept in separate coordinate arrays and processed in blocks
+ * so that the arithmetic is vectorized by Eigen. The result of each
+ * triangle is computed as in solid_angle and the angles are added in the
+ * original order.
+ */
+
+#define FILTER_BLOCK        64      /* Triangles per vectorized block */
+#define FILTER_CHUNK        64      /* Source points per parallel work item */
+
+#define FILTER_KEEP         0
+#define FILTER_OUTSIDE      1
+#define FILTER_TOO_CLOSE    2
+
+typedef Eigen::Array<double,FILTER_BLOCK,1> filterBlock;
+
+typedef struct {
+    int             ntri;               /* Number of triangles, padded to a multiple of FILTER_BLOCK */
+    Eigen::ArrayXf  r1[3],r2[3],r3[3];  /* Triangle corners by coordinate */
+    Eigen::ArrayXf  rr[3];              /* Vertex locations by coordinate */
+    float           min[3],max[3];      /* Bounding box of the vertices */
+} *filterSurface,filterSurfaceRec;
+
+typedef struct {
+    const filterSurfaceRec *surf;       /* The bounding surface */
+    float           limit;              /* Distance limit */
+    float           **rr;               /* The points to test */
+    int             *status;            /* The outcome for each point */
+    int             np;                 /* How many points in this chunk */
+} *filterChunk,filterChunkRec;
+
+static void setup_filter_surface(MneSurfaceOld* surf, filterSurfaceRec& fs)
+{
+    int k,c;
+    /*
+     * The padding triangles collapse to the first vertex. Their solid angle is zero from any point.
+     */
+    fs.ntri = ((surf->ntri + FILTER_BLOCK - 1)/FILTER_BLOCK)*FILTER_BLOCK;
+    for (c = 0; c < 3; c++) {
+        fs.r1[c] = Eigen::ArrayXf::Constant(fs.ntri,surf->rr[0][c]);
+        fs.r2[c] = Eigen::ArrayXf::Constant(fs.ntri,surf->rr[0][c]);
+        fs.r3[c] = Eigen::ArrayXf::Constant(fs.ntri,surf->rr[0][c]);
+        for (k = 0; k < surf->ntri; k++) {
+            fs.r1[c][k] = surf->tris[k].r1[c];
+            fs.r2[c][k] = surf->tris[k].r2[c];
+            fs.r3[c][k] = surf->tris[k].r3[c];
+        }
+        fs.rr[c].resize(surf->np);
+        for (k = 0; k < surf->np; k++)
+            fs.rr[c][k] = surf->rr[k][c];
+        fs.min[c] = fs.rr[c].minCoeff();
+        fs.max[c] = fs.rr[c].maxCoeff();
+    }
+}
+
+static double filter_sum_solids(const filterSurfaceRec& fs, const float *from)
+{
+    filterBlock v1[3],v2[3],v3[3];
+    filterBlock l1,l2,l3,triple,s;
+    double      tot_angle = 0.0;
+    int         k,p,c;
+
+    for (k = 0; k < fs.ntri; k += FILTER_BLOCK) {
+        for (c = 0; c < 3; c++) {
+            v1[c] = (fs.r1[c].segment<FILTER_BLOCK>(k) - from[c]).cast<double>();
+            v2[c] = (fs.r2[c].segment<FILTER_BLOCK>(k) - from[c]).cast<double>();
+            v3[c] = (fs.r3[c].segment<FILTER_BLOCK>(k) - from[c]).cast<double>();
+        }
+        triple = (v1[Y_17]*v2[Z_17] - v1[Z_17]*v2[Y_17])*v3[X_17] +
+                 (v1[Z_17]*v2[X_17] - v1[X_17]*v2[Z_17])*v3[Y_17] +
+                 (v1[X_17]*v2[Y_17] - v1[Y_17]*v2[X_17])*v3[Z_17];
+        l1 = (v1[X_17]*v1[X_17] + v1[Y_17]*v1[Y_17] + v1[Z_17]*v1[Z_17]).sqrt();
+        l2 = (v2[X_17]*v2[X_17] + v2[Y_17]*v2[Y_17] + v2[Z_17]*v2[Z_17]).sqrt();
+        l3 = (v3[X_17]*v3[X_17] + v3[Y_17]*v3[Y_17] + v3[Z_17]*v3[Z_17]).sqrt();
+        s = l1*l2*l3 +
+            (v1[X_17]*v2[X_17] + v1[Y_17]*v2[Y_17] + v1[Z_17]*v2[Z_17])*l3 +
+            (v1[X_17]*v3[X_17] + v1[Y_17]*v3[Y_17] + v1[Z_17]*v3[Z_17])*l2 +
+            (v2[X_17]*v3[X_17] + v2[Y_17]*v3[Y_17] + v2[Z_17]*v3[Z_17])*l1;
+        for (p = 0; p < FILTER_BLOCK; p++)
+            tot_angle += 2.0*atan2(triple[p],s[p]);
+    }
+    return tot_angle;
+}
+
+static int filter_classify_point(const filterSurfaceRec& fs, const float *r, float limit)
+{
+    float mindist;
+    int   c;
+    /*
+     * Points outside the bounding box cannot be inside the surface
+     */
+    for (c = 0; c < 3; c++)
+        if (r[c] < fs.min[c] || r[c] > fs.max[c])
+            return FILTER_OUTSIDE;
+    /*
+     * Check that the source is inside the inner skull surface
+     */
+    if (std::fabs(filter_sum_solids(fs,r)/(4*M_PI)-1.0) > 1e-5)
+        return FILTER_OUTSIDE;
+    /*
+     * Check the distance limit
+     */
+    if (limit > 0.0) {
+        mindist = std::sqrt(((fs.rr[X_17] - r[X_17]).square() +
+                             (fs.rr[Y_17] - r[Y_17]).square() +
+                             (fs.rr[Z_17] - r[Z_17]).square()).minCoeff());
+        if (mindist < limit)
+            return FILTER_TOO_CLOSE;
+    }
+    return FILTER_KEEP;
+}
+
+static void filter_chunk(filterChunkRec& chunk)
+{
+    for (int k = 0; k < chunk.np; k++)
+        chunk.status[k] = filter_classify_point(*chunk.surf,chunk.rr[k],chunk.limit);
+}
+
+static void filter_source_space_points(MneSourceSpaceOld* s,
+                                       FiffCoordTransOld* mri_head_t,
+                                       const filterSurfaceRec& fs,
+                                       float limit,
+                                       FILE *filtered,
+                                       bool use_threads,
+                                       int *omitp,
+                                       int *omit_outsidep)
+{
+    float **rr;
+    int   *status,*vert;
+    int   nsel,p,k;
+
+    for (p = 0, nsel = 0; p < s->np; p++)
+        if (s->inuse[p])
+            nsel++;
+    if (nsel == 0)
+        return;
+    /*
+     * Transform the points in use to MRI coordinates
+     */
+    rr     = ALLOC_CMATRIX_17(nsel,3);
+    vert   = MALLOC_17(nsel,int);
+    status = MALLOC_17(nsel,int);
+    for (p = 0, nsel = 0; p < s->np; p++)
+        if (s->inuse[p]) {
+            VEC_COPY_17(rr[nsel],s->rr[p]);
+            if (s->coord_frame == FIFFV_COORD_HEAD)
+                FiffCoordTransOld::fiff_coord_trans_inv(rr[nsel],mri_head_t,FIFFV_MOVE);
+            vert[nsel++] = p;
+        }
+    /*
+     * Test the points in contiguous chunks
+     */
+    QList<filterChunkRec> chunks;
+    for (k = 0; k < nsel; k += FILTER_CHUNK) {
+        filterChunkRec chunk;
+        chunk.surf   = &fs;
+        chunk.limit  = limit;
+        chunk.rr     = rr + k;
+        chunk.status = status + k;
+        chunk.np     = (k + FILTER_CHUNK > nsel) ? nsel - k : FILTER_CHUNK;
+        chunks.append(chunk);
+    }
+    if (use_threads && chunks.size() > 1)
+        QtConcurrent::blockingMap(chunks, filter_chunk);
+    else
+        for (k = 0; k < chunks.size(); k++)
+            filter_chunk(chunks[k]);
+    /*
+     * Omit the points in the original order
+     */
+    for (k = 0; k < nsel; k++) {
+        if (status[k] == FILTER_KEEP)
+            continue;
+        if (status[k] == FILTER_OUTSIDE)
+            (*omit_outsidep)++;
+        else
+            (*omitp)++;
+        s->inuse[vert[k]] = FALSE;
+        s->nuse--;
+        if (filtered)
+            fprintf(filtered,"%10.3f %10.3f %10.3f\n",
+                    1000*rr[k][X_17],1000*rr[k][Y_17],1000*rr[k][Z_17]);
+    }
+    FREE_CMATRIX_17(rr);
+    FREE_17(vert);
+    FREE_17(status);
+}
+
 //=============================================================================================================
 
 int MneSurfaceOrVolume::mne_filter_source_spaces(MneSurfaceOld* surf, float limit, FiffCoordTransOld* mri_head_t, MneSourceSpaceOld* *spaces, int nspace, FILE *filtered)   /* Provide a list of filtered points here */
@@ -436,13 +633,9 @@ int MneSurfaceOrVolume::mne_filter_source_spaces(MneSurfaceOld* surf, float limi
      * Remove all source space points closer to the surface than a given limit
      */
 {
-    MneSourceSpaceOld* s;
-    int k,p1,p2;
-    float r1[3];
-    float mindist,dist,diff[3];
-    int   minnode;
+    filterSurfaceRec fs;
+    int   k;
     int   omit,omit_outside;
-    double tot_angle;
 
     if (surf == NULL)
         return OK;
@@ -466,50 +659,9 @@ int MneSurfaceOrVolume::mne_filter_source_spaces(MneSurfaceOld* surf, float limi
     printf(" (will take a few...)\n");
     omit         = 0;
     omit_outside = 0;
-    for (k = 0; k < nspace; k++) {
-        s = spaces[k];
-        for (p1 = 0; p1 < s->np; p1++)
-            if (s->inuse[p1]) {
-                VEC_COPY_17(r1,s->rr[p1]);	/* Transform the point to MRI coordinates */
-                if (s->coord_frame == FIFFV_COORD_HEAD)
-                    FiffCoordTransOld::fiff_coord_trans_inv(r1,mri_head_t,FIFFV_MOVE);
-                /*
-                * Check that the source is inside the inner skull surface
-                */
-                tot_angle = sum_solids(r1,surf)/(4*M_PI);
-                if (std::fabs(tot_angle-1.0) > 1e-5) {
-                    omit_outside++;
-                    s->inuse[p1] = FALSE;
-                    s->nuse--;
-                    if (filtered)
-                        fprintf(filtered,"%10.3f %10.3f %10.3f\n",
-                                1000*r1[X_17],1000*r1[Y_17],1000*r1[Z_17]);
-                }
-                else if (limit > 0.0) {
-                    /*
-                        * Check the distance limit
-                        */
-                    mindist = 1.0;
-                    minnode = 0;
-                    for (p2 = 0; p2 < surf->np; p2++) {
-                        VEC_DIFF_17(r1,surf->rr[p2],diff);
-                        dist = VEC_LEN_17(diff);
-                        if (dist < mindist) {
-                            mindist = dist;
-                            minnode = p2;
-                        }
-                    }
-                    if (mindist < limit) {
-                        omit++;
-                        s->inuse[p1] = FALSE;
-                        s->nuse--;
-                        if (filtered)
-                            fprintf(filtered,"%10.3f %10.3f %10.3f\n",
-                                    1000*r1[X_17],1000*r1[Y_17],1000*r1[Z_17]);
-                    }
-                }
-            }
-    }
+    setup_filter_surface(surf,fs);
+    for (k = 0; k < nspace; k++)
+        filter_source_space_points(spaces[k],mri_head_t,fs,limit,filtered,true,&omit,&omit_outside);
     if (omit_outside > 0)
         printf("%d source space points omitted because they are outside the inner skull surface.\n",
                omit_outside);
@@ -642,58 +794,14 @@ void MneSurfaceOrVolume::rearrange_source_space(MneSourceSpaceOld* s)
 void *MneSurfaceOrVolume::filter_source_space(void *arg)
 {
     FilterThreadArg* a = (FilterThreadArg*)arg;
-    int    p1,p2;
-    double tot_angle;
+    filterSurfaceRec fs;
     int    omit,omit_outside;
-    float  r1[3];
-    float  mindist,dist,diff[3];
-    int    minnode;
 
     omit         = 0;
     omit_outside = 0;
 
-    for (p1 = 0; p1 < a->s->np; p1++) {
-        if (a->s->inuse[p1]) {
-            VEC_COPY_17(r1,a->s->rr[p1]);	/* Transform the point to MRI coordinates */
-            if (a->s->coord_frame == FIFFV_COORD_HEAD)
-                FiffCoordTransOld::fiff_coord_trans_inv(r1,a->mri_head_t,FIFFV_MOVE);
-            /*
-           * Check that the source is inside the inner skull surface
-           */
-            tot_angle = sum_solids(r1,a->surf)/(4*M_PI);
-            if (std::fabs(tot_angle-1.0) > 1e-5) {
-                omit_outside++;
-                a->s->inuse[p1] = FALSE;
-                a->s->nuse--;
-                if (a->filtered)
-                    fprintf(a->filtered,"%10.3f %10.3f %10.3f\n",
-                            1000*r1[X_17],1000*r1[Y_17],1000*r1[Z_17]);
-            }
-            else if (a->limit > 0.0) {
-                /*
-         * Check the distance limit
-         */
-                mindist = 1.0;
-                minnode = 0;
-                for (p2 = 0; p2 < a->surf->np; p2++) {
-                    VEC_DIFF_17(r1,a->surf->rr[p2],diff);
-                    dist = VEC_LEN_17(diff);
-                    if (dist < mindist) {
-                        mindist = dist;
-                        minnode = p2;
-                    }
-                }
-                if (mindist < a->limit) {
-                    omit++;
-                    a->s->inuse[p1] = FALSE;
-                    a->s->nuse--;
-                    if (a->filtered)
-                        fprintf(a->filtered,"%10.3f %10.3f %10.3f\n",
-                                1000*r1[X_17],1000*r1[Y_17],1000*r1[Z_17]);
-                }
-            }
-        }
-    }
+    setup_filter_surface(a->surf,fs);
+    filter_source_space_points(a->s,a->mri_head_t,fs,a->limit,a->filtered,a->use_threads,&omit,&omit_outside);
     if (omit_outside > 0)
         fprintf(stderr,"%d source space points omitted because they are outside the inner skull surface.\n",
                 omit_outside);
@@ -737,59 +845,379 @@ int MneSurfaceOrVolume::filter_source_spaces(float limit, char *bemfile, FiffCoo
     if (limit > 0.0)
         fprintf(stderr,"and at least %6.1f mm away",1000*limit);
     fprintf(stderr," (will take a few...)\n");
-    if (nproc < 2 || nspace == 1 || !use_threads) {
-        /*
-        * This is the conventional calculation
-        */
-        for (k = 0; k < nspace; k++) {
-            a = new FilterThreadArg();
-            a->s = spaces[k];
-            a->mri_head_t = mri_head_t;
-            a->surf = surf;
-            a->limit = limit;
-            a->filtered = filtered;
-            filter_source_space(a);
-            if(a)
-                delete a;
-            rearrange_source_space(spaces[k]);
+    /*
+     * The points of each source space are tested in parallel
+     */
+    for (k = 0; k < nspace; k++) {
+        a = new FilterThreadArg();
+        a->s = spaces[k];
+        a->mri_head_t = mri_head_t;
+        a->surf = surf;
+        a->limit = limit;
+        a->filtered = filtered;
+        a->use_threads = use_threads && nproc > 1;
+        filter_source_space(a);
+        delete a;
+        rearrange_source_space(spaces[k]);
+    }
+    if(surf)
+        delete surf;
+    printf("Thank you for waiting.\n\n");
+
+    return OK;
+}
+
+//============================= make_volume_source_space.c =============================
+/*
+ * The grid is set up one plane at a time in parallel. The points are then
+ * classified row by row along x: the crossings of each grid row with the
+ * surface triangles give the parts of the row inside the surface and a
+ * spatial hash of the surface vertices gives the points which are too close
+ * to it. Rows which graze an edge or a vertex of the surface and points next
+ * to a crossing are decided with the solid angle test of filter_source_space.
+ */
+
+#define GRID_KEY(ix,iy,iz) ((((qint64)(ix) + (1 << 20)) << 42) | (((qint64)(iy) + (1 << 20)) << 21) | ((qint64)(iz) + (1 << 20)))
+
+typedef struct {
+    MneSourceSpaceOld* sp;          /* The grid source space */
+    int     minn[3],maxn[3];        /* Grid extent in steps */
+    float   grid;                   /* Grid spacing */
+    int     z;                      /* The plane to process */
+} *volumeGridPlane,volumeGridPlaneRec;
+
+typedef struct {
+    MneSourceSpaceOld*  sp;                 /* The grid source space */
+    MneSurfaceOld*      surf;               /* The bounding surface */
+    filterSurfaceRec    fs;                 /* The same for the solid angle test */
+    int                 minn[3],maxn[3];    /* Grid extent in steps */
+    float               grid;               /* Grid spacing */
+    float               limit;              /* Distance limit */
+    double              tol;                /* Tolerance of the edge functions */
+    double              margin;             /* Points closer than this to a crossing are tested with the solid angles */
+    QVector<QVector<int> > row_tris;        /* Triangles which may cross each grid row */
+    float               cell;               /* Cell size of the vertex hash */
+    QHash<qint64,QPair<int,int> > cells;    /* Range of each cell in verts */
+    QVector<int>        verts;              /* Vertices sorted by cell */
+    int                 *status;            /* The outcome for each grid point */
+} volumeFilterRec;
+
+typedef struct {
+    const volumeFilterRec *f;
+    int   z;                                /* The plane to process */
+} *volumeFilterPlane,volumeFilterPlaneRec;
+
+static void make_volume_grid_plane(volumeGridPlaneRec& plane)
+{
+    MneSourceSpaceOld* sp = plane.sp;
+    const int *minn = plane.minn;
+    const int *maxn = plane.maxn;
+    float grid  = plane.grid;
+    int   z     = plane.z;
+    int   nrow   = (maxn[X_17]-minn[X_17]+1);
+    int   nplane = nrow*(maxn[Y_17]-minn[Y_17]+1);
+    int   *neigh;
+    int   k,c,x,y;
+
+    for (k = (z-minn[Z_17])*nplane, y = minn[Y_17]; y <= maxn[Y_17]; y++) {
+        for (x = minn[X_17]; x <= maxn[X_17]; x++, k++) {
+            sp->inuse[k]  = TRUE;
+            sp->vertno[k] = k;
+            sp->nn[k][X_17] = sp->nn[k][Y_17] = 0.0; /* Source orientation is immaterial */
+            sp->nn[k][Z_17] = 1.0;
+            sp->neighbor_vert[k]  = neigh = MALLOC_17(NNEIGHBORS,int);
+            sp->nneighbor_vert[k] = NNEIGHBORS;
+            for (c = 0; c < NNEIGHBORS; c++)
+                neigh[c] = -1;
+            sp->rr[k][X_17] = x*grid;
+            sp->rr[k][Y_17] = y*grid;
+            sp->rr[k][Z_17] = z*grid;
+            /*
+         * Figure out the neighborhood:
+         * 6-neighborhood first
+         */
+            neigh = sp->neighbor_vert[k];
+            if (z > minn[Z_17])
+                neigh[0]  = k - nplane;
+            if (x < maxn[X_17])
+                neigh[1] = k + 1;
+            if (y < maxn[Y_17])
+                neigh[2] = k + nrow;
+            if (x > minn[X_17])
+                neigh[3] = k - 1;
+            if (y > minn[Y_17])
+                neigh[4] = k - nrow;
+            if (z < maxn[Z_17])
+                neigh[5] = k + nplane;
+            /*
+         * Then the rest to complete the 26-neighborhood
+         * First the plane below
+         */
+            if (z > minn[Z_17]) {
+                if (x < maxn[X_17]) {
+                    neigh[6] = k + 1 - nplane;
+                    if (y < maxn[Y_17])
+                        neigh[7] = k + 1 + nrow - nplane;
+                }
+                if (y < maxn[Y_17])
+                    neigh[8] = k + nrow - nplane;
+                if (x > minn[X_17]) {
+                    if (y < maxn[Y_17])
+                        neigh[9] = k - 1 + nrow - nplane;
+                    neigh[10] = k - 1 - nplane;
+                    if (y > minn[Y_17])
+                        neigh[11] = k - 1 - nrow - nplane;
+                }
+                if (y > minn[Y_17]) {
+                    neigh[12] = k - nrow - nplane;
+                    if (x < maxn[X_17])
+                        neigh[13] = k + 1 - nrow - nplane;
+                }
+            }
+            /*
+         * Then the same plane
+         */
+            if (x < maxn[X_17] && y < maxn[Y_17])
+                neigh[14] = k + 1 + nrow;
+            if (x > minn[X_17]) {
+                if (y < maxn[Y_17])
+                    neigh[15] = k - 1 + nrow;
+                if (y > minn[Y_17])
+                    neigh[16] = k - 1 - nrow;
+            }
+            if (y > minn[Y_17] && x < maxn[X_17])
+                neigh[17] = k + 1 - nrow - nplane;
+            /*
+         * Finally one plane above
+         */
+            if (z < maxn[Z_17]) {
+                if (x < maxn[X_17]) {
+                    neigh[18] = k + 1 + nplane;
+                    if (y < maxn[Y_17])
+                        neigh[19] = k + 1 + nrow + nplane;
+                }
+                if (y < maxn[Y_17])
+                    neigh[20] = k + nrow + nplane;
+                if (x > minn[X_17]) {
+                    if (y < maxn[Y_17])
+                        neigh[21] = k - 1 + nrow + nplane;
+                    neigh[22] = k - 1 + nplane;
+                    if (y > minn[Y_17])
+                        neigh[23] = k - 1 - nrow + nplane;
+                }
+                if (y > minn[Y_17]) {
+                    neigh[24] = k - nrow + nplane;
+                    if (x < maxn[X_17])
+                        neigh[25] = k + 1 - nrow + nplane;
+                }
+            }
         }
     }
-    else {
+}
+
+static double edge_function(const float *p, const float *q, double y, double z)
+{
+    return ((double)q[Y_17]-(double)p[Y_17])*(z-(double)p[Z_17]) - ((double)q[Z_17]-(double)p[Z_17])*(y-(double)p[Y_17]);
+}
+
+static bool grid_point_too_close(const volumeFilterRec& f, const float *r)
+{
+    float diff[3],dist;
+    int   ix = (int)floor(r[X_17]/f.cell);
+    int   iy = (int)floor(r[Y_17]/f.cell);
+    int   iz = (int)floor(r[Z_17]/f.cell);
+
+    for (int dx = -1; dx <= 1; dx++)
+        for (int dy = -1; dy <= 1; dy++)
+            for (int dz = -1; dz <= 1; dz++) {
+                QHash<qint64,QPair<int,int> >::const_iterator cell = f.cells.constFind(GRID_KEY(ix+dx,iy+dy,iz+dz));
+                if (cell == f.cells.constEnd())
+                    continue;
+                for (int p = cell.value().first; p < cell.value().first + cell.value().second; p++) {
+                    VEC_DIFF_17(r,f.surf->rr[f.verts[p]],diff);
+                    dist = VEC_LEN_17(diff);
+                    if (dist < f.limit)
+                        return true;
+                }
+            }
+    return false;
+}
+
+static void filter_volume_grid_plane(volumeFilterPlaneRec& plane)
+{
+    const volumeFilterRec& f = *plane.f;
+    MneSourceSpaceOld* sp = f.sp;
+    int    nrow   = (f.maxn[X_17]-f.minn[X_17]+1);
+    int    nplane = nrow*(f.maxn[Y_17]-f.minn[Y_17]+1);
+    int    y,k,t,nbelow;
+    double Y,Z,X,e0,e1,e2,gap;
+    bool   degenerate;
+    std::vector<double> xs;
+
+    for (y = f.minn[Y_17]; y <= f.maxn[Y_17]; y++) {
+        k = (plane.z-f.minn[Z_17])*nplane + (y-f.minn[Y_17])*nrow;
+        Y = sp->rr[k][Y_17];
+        Z = sp->rr[k][Z_17];
         /*
-        * Calculate all (both) source spaces simultaneously
-        */
-        QList<FilterThreadArg*> args;//filterThreadArg *args = MALLOC_17(nspace,filterThreadArg);
-
-        for (k = 0; k < nspace; k++) {
-            a = new FilterThreadArg();
-            a->s = spaces[k];
-            a->mri_head_t = mri_head_t;
-            a->surf = surf;
-            a->limit = limit;
-            a->filtered = filtered;
-            args.append(a);
+         * Where does this row cross the surface?
+         */
+        const QVector<int>& tris = f.row_tris[(plane.z-f.minn[Z_17])*(f.maxn[Y_17]-f.minn[Y_17]+1) + (y-f.minn[Y_17])];
+        xs.clear();
+        degenerate = false;
+        for (t = 0; t < tris.size() && !degenerate; t++) {
+            MneTriangle* tri = f.surf->tris + tris[t];
+            e0 = edge_function(tri->r2,tri->r3,Y,Z);
+            e1 = edge_function(tri->r3,tri->r1,Y,Z);
+            e2 = edge_function(tri->r1,tri->r2,Y,Z);
+            if ((e0 > f.tol && e1 > f.tol && e2 > f.tol) || (e0 < -f.tol && e1 < -f.tol && e2 < -f.tol))
+                xs.push_back((e0*tri->r1[X_17] + e1*tri->r2[X_17] + e2*tri->r3[X_17])/(e0 + e1 + e2));
+            else if (!((e0 > f.tol || e1 > f.tol || e2 > f.tol) && (e0 < -f.tol || e1 < -f.tol || e2 < -f.tol)))
+                degenerate = true;      /* Through or next to an edge or a vertex */
         }
+        if (xs.size() % 2 != 0)
+            degenerate = true;
+        std::sort(xs.begin(),xs.end());
         /*
-        * Ready to start the threads & Wait for them to complete
-        */
-        QtConcurrent::blockingMap(args, filter_source_space);
-
-        for (k = 0; k < nspace; k++) {
-            rearrange_source_space(spaces[k]);
-            if(args[k])
-                delete args[k];
+         * Classify the points of the row
+         */
+        for (nbelow = 0; k < (plane.z-f.minn[Z_17])*nplane + (y-f.minn[Y_17]+1)*nrow; k++) {
+            f.status[k] = FILTER_KEEP;
+            if (!sp->inuse[k])
+                continue;
+            if (degenerate) {
+                f.status[k] = filter_classify_point(f.fs,sp->rr[k],f.limit);
+                continue;
+            }
+            X = sp->rr[k][X_17];
+            while (nbelow < (int)xs.size() && xs[nbelow] < X)
+                nbelow++;
+            gap = HUGE_VAL;
+            if (nbelow > 0)
+                gap = X - xs[nbelow-1];
+            if (nbelow < (int)xs.size() && xs[nbelow] - X < gap)
+                gap = xs[nbelow] - X;
+            if (gap < f.margin)
+                f.status[k] = filter_classify_point(f.fs,sp->rr[k],f.limit);
+            else if (nbelow % 2 == 0)
+                f.status[k] = FILTER_OUTSIDE;
+            else if (f.limit > 0.0 && grid_point_too_close(f,sp->rr[k]))
+                f.status[k] = FILTER_TOO_CLOSE;
         }
     }
-    if(surf)
-        delete surf;
-    printf("Thank you for waiting.\n\n");
+}
+
+static int filter_volume_grid(MneSurfaceOld* surf, MneSourceSpaceOld* sp, const int *minn, const int *maxn, float grid, float limit)
+{
+    volumeFilterRec f;
+    double volume,size;
+    int    ny,nz;
+    int    k,c,y,z;
+    int    omit,omit_outside;
+    /*
+     * The scanline test assumes a closed surface with outward normals,
+     * i.e., a positive enclosed volume
+     */
+    for (k = 0, volume = 0.0; k < surf->ntri; k++) {
+        float *r1 = surf->tris[k].r1;
+        float *r2 = surf->tris[k].r2;
+        float *r3 = surf->tris[k].r3;
+        volume += r1[X_17]*((double)r2[Y_17]*r3[Z_17] - (double)r2[Z_17]*r3[Y_17]) +
+                  r1[Y_17]*((double)r2[Z_17]*r3[X_17] - (double)r2[X_17]*r3[Z_17]) +
+                  r1[Z_17]*((double)r2[X_17]*r3[Y_17] - (double)r2[Y_17]*r3[X_17]);
+    }
+    if (volume <= 0.0 || limit >= 1.0 || surf->np == 0)
+        return MneSurfaceOrVolume::mne_filter_source_spaces(surf,limit,NULL,&sp,1,NULL);
 
+    printf("Checking that the sources are inside the bounding surface ");
+    if (limit > 0.0)
+        printf("and at least %6.1f mm away",1000*limit);
+    printf("...\n");
+
+    f.sp    = sp;
+    f.surf  = surf;
+    f.grid  = grid;
+    f.limit = limit;
+    for (c = 0; c < 3; c++) {
+        f.minn[c] = minn[c];
+        f.maxn[c] = maxn[c];
+    }
+    setup_filter_surface(surf,f.fs);
+    for (c = 0, size = 0.0; c < 3; c++)
+        size = std::max(size,(double)(f.fs.max[c]-f.fs.min[c]));
+    f.tol    = 1e-10*size*size;
+    f.margin = 1e-3*grid;
+    /*
+     * Bin the triangles into the grid rows they may cross
+     */
+    ny = maxn[Y_17]-minn[Y_17]+1;
+    nz = maxn[Z_17]-minn[Z_17]+1;
+    f.row_tris.resize(ny*nz);
+    for (k = 0; k < surf->ntri; k++) {
+        MneTriangle* tri = surf->tris + k;
+        int ymin = std::max(minn[Y_17],(int)floor(std::min(std::min(tri->r1[Y_17],tri->r2[Y_17]),tri->r3[Y_17])/grid));
+        int ymax = std::min(maxn[Y_17],(int)ceil(std::max(std::max(tri->r1[Y_17],tri->r2[Y_17]),tri->r3[Y_17])/grid));
+        int zmin = std::max(minn[Z_17],(int)floor(std::min(std::min(tri->r1[Z_17],tri->r2[Z_17]),tri->r3[Z_17])/grid));
+        int zmax = std::min(maxn[Z_17],(int)ceil(std::max(std::max(tri->r1[Z_17],tri->r2[Z_17]),tri->r3[Z_17])/grid));
+        for (z = zmin; z <= zmax; z++)
+            for (y = ymin; y <= ymax; y++)
+                f.row_tris[(z-minn[Z_17])*ny + (y-minn[Y_17])].append(k);
+    }
+    /*
+     * Hash the vertices into cells as large as the distance limit
+     */
+    if (limit > 0.0) {
+        QVector<QPair<qint64,int> > keys(surf->np);
+        f.cell = limit;
+        for (k = 0; k < surf->np; k++)
+            keys[k] = qMakePair(GRID_KEY((int)floor(surf->rr[k][X_17]/f.cell),
+                                         (int)floor(surf->rr[k][Y_17]/f.cell),
+                                         (int)floor(surf->rr[k][Z_17]/f.cell)),k);
+        std::sort(keys.begin(),keys.end());
+        f.verts.resize(surf->np);
+        for (k = 0; k < surf->np; k++) {
+            f.verts[k] = keys[k].second;
+            if (k == 0 || keys[k].first != keys[k-1].first)
+                f.cells.insert(keys[k].first,qMakePair(k,0));
+            f.cells[keys[k].first].second++;
+        }
+    }
+    /*
+     * Classify the points plane by plane
+     */
+    f.status = MALLOC_17(sp->np,int);
+    QList<volumeFilterPlaneRec> planes;
+    for (z = minn[Z_17]; z <= maxn[Z_17]; z++) {
+        volumeFilterPlaneRec plane;
+        plane.f = &f;
+        plane.z = z;
+        planes.append(plane);
+    }
+    QtConcurrent::blockingMap(planes, filter_volume_grid_plane);
+
+    for (k = 0, omit = omit_outside = 0; k < sp->np; k++) {
+        if (f.status[k] == FILTER_KEEP)
+            continue;
+        if (f.status[k] == FILTER_OUTSIDE)
+            omit_outside++;
+        else
+            omit++;
+        sp->inuse[k] = FALSE;
+        sp->nuse--;
+    }
+    FREE_17(f.status);
+    if (omit_outside > 0)
+        printf("%d source space points omitted because they are outside the inner skull surface.\n",
+               omit_outside);
+    if (omit > 0)
+        printf("%d source space points omitted because of the %6.1f-mm distance limit.\n",
+               omit,1000*limit);
+    printf("Thank you for waiting.\n");
     return OK;
 }
 
 //=============================================================================================================
 
-MneSourceSpaceOld* MneSurfaceOrVolume::make_volume_source_space(MneSurfaceOld* surf, float grid, float exclude, float mindist)
+MneSourceSpaceOld* MneSurfaceOrVolume::make_volume_source_space(MneSurfaceOld* surf, float grid, float exclude, float mindist, bool scanline)
 /*
      * Make a source space which covers the volume bounded by surf
      */
@@ -799,9 +1227,9 @@ MneSourceSpaceOld* MneSurfaceOrVolume::make_volume_source_space(MneSurfaceOld* s
     float *node,maxdist,dist,diff[3];
     int   k,c;
     MneSourceSpaceOld* sp = NULL;
-    int np,nplane,nrow;
+    int np;
     int *neigh,nneigh;
-    int x,y,z;
+    int z;
     /*
         * Figure out the grid size
         */
@@ -865,110 +1293,28 @@ MneSourceSpaceOld* MneSurfaceOrVolume::make_volume_source_space(MneSurfaceOld* s
     np = 1;
     for (c = 0; c < 3; c++)
         np = np*(maxn[c]-minn[c]+1);
-    nplane = (maxn[X_17]-minn[X_17]+1)*(maxn[Y_17]-minn[Y_17]+1);
-    nrow   = (maxn[X_17]-minn[X_17]+1);
     sp = MneSurfaceOrVolume::mne_new_source_space(np);
     sp->type = MNE_SOURCE_SPACE_VOLUME;
     sp->nneighbor_vert = MALLOC_17(sp->np,int);
     sp->neighbor_vert = MALLOC_17(sp->np,int *);
-    for (k = 0; k < sp->np; k++) {
-        sp->inuse[k]  = TRUE;
-        sp->vertno[k] = k;
-        sp->nn[k][X_17] = sp->nn[k][Y_17] = 0.0; /* Source orientation is immaterial */
-        sp->nn[k][Z_17] = 1.0;
-        sp->neighbor_vert[k]  = neigh  = MALLOC_17(NNEIGHBORS,int);
-        sp->nneighbor_vert[k] = nneigh = NNEIGHBORS;
-        for (c = 0; c < nneigh; c++)
-            neigh[c] = -1;
-        sp->nuse++;
-    }
-    for (k = 0, z = minn[Z_17]; z <= maxn[Z_17]; z++) {
-        for (y = minn[Y_17]; y <= maxn[Y_17]; y++) {
-            for (x = minn[X_17]; x <= maxn[X_17]; x++, k++) {
-                sp->rr[k][X_17] = x*grid;
-                sp->rr[k][Y_17] = y*grid;
-                sp->rr[k][Z_17] = z*grid;
-                /*
-             * Figure out the neighborhood:
-             * 6-neighborhood first
-             */
-                neigh = sp->neighbor_vert[k];
-                if (z > minn[Z_17])
-                    neigh[0]  = k - nplane;
-                if (x < maxn[X_17])
-                    neigh[1] = k + 1;
-                if (y < maxn[Y_17])
-                    neigh[2] = k + nrow;
-                if (x > minn[X_17])
-                    neigh[3] = k - 1;
-                if (y > minn[Y_17])
-                    neigh[4] = k - nrow;
-                if (z < maxn[Z_17])
-                    neigh[5] = k + nplane;
-                /*
-             * Then the rest to complete the 26-neighborhood
-             * First the plane below
-             */
-                if (z > minn[Z_17]) {
-                    if (x < maxn[X_17]) {
-                        neigh[6] = k + 1 - nplane;
-                        if (y < maxn[Y_17])
-                            neigh[7] = k + 1 + nrow - nplane;
-                    }
-                    if (y < maxn[Y_17])
-                        neigh[8] = k + nrow - nplane;
-                    if (x > minn[X_17]) {
-                        if (y < maxn[Y_17])
-                            neigh[9] = k - 1 + nrow - nplane;
-                        neigh[10] = k - 1 - nplane;
-                        if (y > minn[Y_17])
-                            neigh[11] = k - 1 - nrow - nplane;
-                    }
-                    if (y > minn[Y_17]) {
-                        neigh[12] = k - nrow - nplane;
-                        if (x < maxn[X_17])
-                            neigh[13] = k + 1 - nrow - nplane;
-                    }
-                }
-                /*
-             * Then the same plane
-             */
-                if (x < maxn[X_17] && y < maxn[Y_17])
-                    neigh[14] = k + 1 + nrow;
-                if (x > minn[X_17]) {
-                    if (y < maxn[Y_17])
-                        neigh[15] = k - 1 + nrow;
-                    if (y > minn[Y_17])
-                        neigh[16] = k - 1 - nrow;
-                }
-                if (y > minn[Y_17] && x < maxn[X_17])
-                    neigh[17] = k + 1 - nrow - nplane;
-                /*
-             * Finally one plane above
-             */
-                if (z < maxn[Z_17]) {
-                    if (x < maxn[X_17]) {
-                        neigh[18] = k + 1 + nplane;
-                        if (y < maxn[Y_17])
-                            neigh[19] = k + 1 + nrow + nplane;
-                    }
-                    if (y < maxn[Y_17])
-                        neigh[20] = k + nrow + nplane;
-                    if (x > minn[X_17]) {
-                        if (y < maxn[Y_17])
-                            neigh[21] = k - 1 + nrow + nplane;
-                        neigh[22] = k - 1 + nplane;
-                        if (y > minn[Y_17])
-                            neigh[23] = k - 1 - nrow + nplane;
-                    }
-                    if (y > minn[Y_17]) {
-                        neigh[24] = k - nrow + nplane;
-                        if (x < maxn[X_17])
-                            neigh[25] = k + 1 - nrow + nplane;
-                    }
-                }
+    sp->nuse = sp->np;
+    {
+        /*
+         * Set up the planes of the grid in parallel
+         */
+        QList<volumeGridPlaneRec> planes;
+        for (z = minn[Z_17]; z <= maxn[Z_17]; z++) {
+            volumeGridPlaneRec plane;
+            plane.sp   = sp;
+            plane.grid = grid;
+            plane.z    = z;
+            for (c = 0; c < 3; c++) {
+                plane.minn[c] = minn[c];
+                plane.maxn[c] = maxn[c];
             }
+            planes.append(plane);
         }
+        QtConcurrent::blockingMap(planes, make_volume_grid_plane);
     }
     printf("%d sources before omitting any.\n",sp->nuse);
     /*
@@ -983,7 +1329,11 @@ MneSourceSpaceOld* MneSurfaceOrVolume::make_volume_source_space(MneSurfaceOld* s
         }
     }
     printf("%d sources after omitting infeasible sources.\n",sp->nuse);
-    if (mne_filter_source_spaces(surf,mindist,NULL,&sp,1,NULL) != OK)
+    if (scanline) {
+        if (filter_volume_grid(surf,sp,minn,maxn,grid,mindist) != OK)
+            goto bad;
+    }
+    else if (mne_filter_source_spaces(surf,mindist,NULL,&sp,1,NULL) != OK)
         goto bad;
     printf("%d sources remaining after excluding the sources outside the surface and less than %6.1f mm inside.\n",sp->nuse,1000*mindist);
     /*
@@ -1123,19 +1473,19 @@ MneSourceSpaceOld* MneSurfaceOrVolume::mne_new_source_space(int np)
 
 MneSurfaceOld* MneSurfaceOrVolume::read_bem_surface(const QString &name, int which, int add_geometry, float *sigmap)          /* Conductivity? */
 {
-    return read_bem_surface(name,which,add_geometry,sigmap,true);
+    return read_bem_surface(name,which,add_geometry,sigmap,true,false);
 }
 
 //=============================================================================================================
 
 MneSurfaceOld* MneSurfaceOrVolume::mne_read_bem_surface2(char *name, int  which, int  add_geometry, float *sigmap)
 {
-  return read_bem_surface(name,which,add_geometry,sigmap,FALSE);
+  return read_bem_surface(name,which,add_geometry,sigmap,FALSE,false);
 }
 
 //=============================================================================================================
 
-MneSurfaceOld* MneSurfaceOrVolume::read_bem_surface(const QString &name, int which, int add_geometry, float *sigmap, bool check_too_many_neighbors)
+MneSurfaceOld* MneSurfaceOrVolume::read_bem_surface(const QString &name, int which, int add_geometry, float *sigmap, bool check_too_many_neighbors, bool use_geometry_cache)
 /*
      * Read a Neuromag-style BEM surface description
      */
@@ -1256,14 +1606,9 @@ MneSurfaceOld* MneSurfaceOrVolume::read_bem_surface(const QString &name, int whi
     s->val         = NULL;
 
     if (add_geometry) {
-        if (check_too_many_neighbors) {
-            if (mne_source_space_add_geometry_info((MneSourceSpaceOld*)s,!s->nn) != OK)
-                goto bad;
-        }
-        else {
-            if (mne_source_space_add_geometry_info2((MneSourceSpaceOld*)s,!s->nn) != OK)
-                goto bad;
-        }
+        if (mne_source_space_add_cached_geometry_info((MneSourceSpaceOld*)s,!s->nn,check_too_many_neighbors,
+                                                      use_geometry_cache ? mne_geometry_cache_name(name,which) : QString()) != OK)
+            goto bad;
     }
     else if (s->nn == NULL) {       /* Normals only */
         if (mne_add_vertex_normals((MneSourceSpaceOld*)s) != OK)
@@ -1478,6 +1823,23 @@ int MneSurfaceOrVolume::mne_project_to_surface(MneSurfaceOld* s, void *proj_data
 
     p0 = q0 = 0.0;
     dist0 = 0.0;
+    if (!proj_data && s->ntri > 0) {
+        /*
+         * Without a search restriction the hierarchy gives the same answer as going through all triangles
+         */
+        auto evaluate = [s,r](int tri, float &distTri) {
+            float pTri,qTri;
+            return nearest_triangle_point(r,s,NULL,tri,&pTri,&qTri,&distTri) == TRUE;
+        };
+        best = mne_surface_triangle_bvh(s)->findClosest(Eigen::Vector3f(r[0],r[1],r[2]),evaluate,dist0);
+        if (best >= 0 && project_it) {
+            nearest_triangle_point(r,s,NULL,best,&p0,&q0,&dist);
+            project_to_triangle(s,best,p0,q0,r);
+        }
+        if (distp)
+            *distp = dist0;
+        return best;
+    }
     for (best = -1, k = 0; k < s->ntri; k++) {
         if (nearest_triangle_point(r,s,proj_data,k,&p,&q,&dist)) {
             if (best < 0 || std::fabs(dist) < std::fabs(dist0)) {
@@ -1497,6 +1859,45 @@ int MneSurfaceOrVolume::mne_project_to_surface(MneSurfaceOld* s, void *proj_data
 
 //=============================================================================================================
 
+MNETriangleBVH* MneSurfaceOrVolume::mne_surface_triangle_bvh(MneSurfaceOld* s)
+{
+    /*
+     * Only the first call builds the hierarchy, the queries after it do not need the lock
+     */
+    MNETriangleBVH* bvh = s->triangle_bvh.loadAcquire();
+    if (bvh)
+        return bvh;
+
+    static QMutex mutex;
+    QMutexLocker locker(&mutex);
+
+    bvh = s->triangle_bvh.loadAcquire();
+    if (!bvh) {
+        Eigen::MatrixX3f matR1(s->ntri,3), matR2(s->ntri,3), matR3(s->ntri,3);
+        Eigen::VectorXf vecScale(s->ntri);
+        MneTriangle* this_tri;
+        int k;
+
+        for (k = 0, this_tri = s->tris; k < s->ntri; k++, this_tri++) {
+            /*
+             * Use the corners as they enter the distance calculation
+             */
+            matR1.row(k) << this_tri->r1[0], this_tri->r1[1], this_tri->r1[2];
+            matR2.row(k) << this_tri->r1[0] + this_tri->r12[0], this_tri->r1[1] + this_tri->r12[1], this_tri->r1[2] + this_tri->r12[2];
+            matR3.row(k) << this_tri->r1[0] + this_tri->r13[0], this_tri->r1[1] + this_tri->r13[1], this_tri->r1[2] + this_tri->r13[2];
+            /*
+             * The distances to the sides underestimate the in-plane part by at most a factor of 1/sqrt(2)
+             */
+            vecScale[k] = 0.7f*std::min(1.0f,(float)VEC_LEN_17(this_tri->nn));
+        }
+        bvh = new MNETriangleBVH(matR1,matR2,matR3,vecScale);
+        s->triangle_bvh.storeRelease(bvh);
+    }
+    return bvh;
+}
+
+//=============================================================================================================
+
 void MneSurfaceOrVolume::mne_project_to_triangle(MneSurfaceOld* s,
                                                  int        best,
                                                  float      *r,
@@ -1522,19 +1923,34 @@ void MneSurfaceOrVolume::mne_find_closest_on_surface_approx(MneSurfaceOld* s, fl
       */
 {
     MneProjData* p = new MneProjData(s);
-    int k,was;
+    QVector<int> full_search;
+    QVector<int> restricted;
+    int j,k;
     float mydist;
 
     fprintf(stderr,"%s for %d points %d steps...",nearest[0] < 0 ? "Closest" : "Approx closest",np,nstep);
-
+    /*
+     * Points without an approximation are searched on the complete surface, independently of each other
+     */
     for (k = 0; k < np; k++) {
-        was = nearest[k];
+        if (nearest[k] < 0)
+            full_search.append(k);
+        else
+            restricted.append(k);
+    }
+    if (!full_search.isEmpty())
+        mne_surface_triangle_bvh(s);
+    QtConcurrent::blockingMap(full_search, [s,r,nearest,dist](const int k) {
+        float thisdist;
+        nearest[k] =  mne_project_to_surface(s,NULL,r[k],0,dist ? dist+k : &thisdist);
+    });
+
+    for (j = 0; j < restricted.size(); j++) {
+        k = restricted[j];
         decide_search_restriction(s,p,nearest[k],nstep,r[k]);
         nearest[k] =  mne_project_to_surface(s,p,r[k],0,dist ? dist+k : &mydist);
-        if (nearest[k] < 0) {
-            decide_search_restriction(s,p,-1,nstep,r[k]);
-            nearest[k] =  mne_project_to_surface(s,p,r[k],0,dist ? dist+k : &mydist);
-        }
+        if (nearest[k] < 0)
+            nearest[k] =  mne_project_to_surface(s,NULL,r[k],0,dist ? dist+k : &mydist);
     }
 
     fprintf(stderr,"[done]\n");
@@ -2037,6 +2453,7 @@ int MneSurfaceOrVolume::mne_transform_source_space(MneSourceSpaceOld* ss, FiffCo
         for (k = 0; k < ss->ntri; k++)
             FiffCoordTransOld::fiff_coord_trans(ss->tris[k].nn,t,FIFFV_NO_MOVE);
     }
+    delete ss->triangle_bvh.fetchAndStoreOrdered(NULL);
     ss->coord_frame = t->to;
     return OK;
 }
@@ -2389,6 +2806,7 @@ void MneSurfaceOrVolume::mne_add_triangle_data(MneSourceSpaceOld* s)
 
     FREE_17(s->tris);     s->tris = NULL;
     FREE_17(s->use_tris); s->use_tris = NULL;
+    delete s->triangle_bvh.fetchAndStoreOrdered(NULL);
     /*
         * Add information for the complete triangulation
         */
@@ -2772,6 +3190,292 @@ int MneSurfaceOrVolume::add_geometry_info(MneSourceSpaceOld* s, int do_normals,
     return OK;
 }
 
+//============================= geometry cache =============================
+/*
+ * The derived geometry of a surface can be stored next to the surface file.
+ * The header is followed by 32-bit arrays in the byte order of the writing
+ * machine so that the file can be mapped and copied directly:
+ *
+ *      nn              np x 3      (only if the normals were computed)
+ *      nneighbor_tri   np
+ *      neighbor_tri    sum(nneighbor_tri)
+ *      nneighbor_vert  np
+ *      neighbor_vert   sum(nneighbor_vert)
+ *      vert_dist       sum(nneighbor_vert)
+ */
+
+#define GEOM_CACHE_MAGIC      0x4d4e4753  /* 'MNGS' */
+#define GEOM_CACHE_VERSION    1
+#define GEOM_CACHE_BYTE_ORDER 0x01020304
+#define GEOM_CACHE_KEY_LEN    20          /* SHA-1 */
+
+typedef struct {
+    quint32 magic;
+    quint32 version;
+    quint32 byte_order;
+    qint32  np;
+    qint32  ntri;
+    qint32  do_normals;
+    qint32  check_too_many_neighbors;
+    qint32  nneighbor_tri_total;
+    qint32  nneighbor_vert_total;
+    float   cm[3];
+    char    key[GEOM_CACHE_KEY_LEN];        /* Identifies the surface the geometry was computed for */
+    char    checksum[GEOM_CACHE_KEY_LEN];   /* Covers the arrays following the header */
+} geomCacheHeaderRec;
+
+static void hash_ints(QCryptographicHash& hash, const int *data, int n)
+{
+    if (data && n > 0)
+        hash.addData((const char *)data,n*sizeof(int));
+}
+
+static void hash_int(QCryptographicHash& hash, int val)
+{
+    hash_ints(hash,&val,1);
+}
+
+static void hash_floats(QCryptographicHash& hash, const float *data, int n)
+{
+    if (data && n > 0)
+        hash.addData((const char *)data,n*sizeof(float));
+}
+
+static QByteArray geometry_cache_key(MneSourceSpaceOld* s, int do_normals, int check_too_many_neighbors)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    int k;
+
+    hash_int(hash,s->np);
+    hash_int(hash,s->ntri);
+    hash_int(hash,do_normals ? 1 : 0);
+    hash_int(hash,check_too_many_neighbors ? 1 : 0);
+    for (k = 0; k < s->np; k++)
+        hash_floats(hash,s->rr[k],3);
+    for (k = 0; k < s->ntri; k++)
+        hash_ints(hash,s->itris[k],3);
+    return hash.result();
+}
+
+static qint64 geometry_cache_payload_size(const geomCacheHeaderRec& head)
+{
+    qint64 nitem = 2*(qint64)head.np + head.nneighbor_tri_total + 2*(qint64)head.nneighbor_vert_total;
+    if (head.do_normals)
+        nitem += 3*(qint64)head.np;
+    return 4*nitem;
+}
+
+static bool read_geometry_cache(const QString& name, MneSourceSpaceOld* s, int do_normals, int check_too_many_neighbors)
+{
+    QFile file(name);
+    geomCacheHeaderRec head;
+    const uchar *data;
+    const char  *payload;
+    int         *nneighbor_tri,**neighbor_tri;
+    int         *nneighbor_vert,**neighbor_vert;
+    float       **vert_dist;
+    qint64      ntri_total,nvert_total;
+    int         k;
+
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+    if (file.size() < (qint64)sizeof(head) || (data = file.map(0,file.size())) == NULL) {
+        printf("Could not read the geometry cache %s. The geometry information will be recomputed.\n",name.toUtf8().constData());
+        return false;
+    }
+    memcpy(&head,data,sizeof(head));
+    if (head.magic != GEOM_CACHE_MAGIC || head.version != GEOM_CACHE_VERSION || head.byte_order != GEOM_CACHE_BYTE_ORDER) {
+        printf("%s is not a geometry cache file for this machine. The geometry information will be recomputed.\n",name.toUtf8().constData());
+        return false;
+    }
+    if (head.np != s->np || head.ntri != s->ntri ||
+            head.do_normals != (do_normals ? 1 : 0) ||
+            head.check_too_many_neighbors != (check_too_many_neighbors ? 1 : 0) ||
+            geometry_cache_key(s,do_normals,check_too_many_neighbors) != QByteArray(head.key,GEOM_CACHE_KEY_LEN)) {
+        printf("The geometry cache %s does not match the surface. The geometry information will be recomputed.\n",name.toUtf8().constData());
+        return false;
+    }
+    payload = (const char *)data + sizeof(head);
+    if (head.nneighbor_tri_total < 0 || head.nneighbor_vert_total < 0 ||
+            file.size() != (qint64)sizeof(head) + geometry_cache_payload_size(head) ||
+            QCryptographicHash::hash(QByteArray::fromRawData(payload,geometry_cache_payload_size(head)),
+                                     QCryptographicHash::Sha1) != QByteArray(head.checksum,GEOM_CACHE_KEY_LEN)) {
+        printf("The geometry cache %s is corrupted. The geometry information will be recomputed.\n",name.toUtf8().constData());
+        return false;
+    }
+    /*
+     * Check the neighbor counts before anything is allocated
+     */
+    nneighbor_tri  = MALLOC_17(s->np,int);
+    nneighbor_vert = MALLOC_17(s->np,int);
+    if (do_normals)
+        payload += 3*s->np*sizeof(float);
+    memcpy(nneighbor_tri,payload,s->np*sizeof(int));
+    payload += s->np*sizeof(int) + head.nneighbor_tri_total*sizeof(int);
+    memcpy(nneighbor_vert,payload,s->np*sizeof(int));
+    for (k = 0, ntri_total = nvert_total = 0; k < s->np; k++) {
+        if (nneighbor_tri[k] < 0 || nneighbor_vert[k] < 0)
+            break;
+        ntri_total  += nneighbor_tri[k];
+        nvert_total += nneighbor_vert[k];
+    }
+    if (k < s->np || ntri_total != head.nneighbor_tri_total || nvert_total != head.nneighbor_vert_total) {
+        printf("The geometry cache %s is corrupted. The geometry information will be recomputed.\n",name.toUtf8().constData());
+        FREE_17(nneighbor_tri);
+        FREE_17(nneighbor_vert);
+        return false;
+    }
+    /*
+     * Copy the arrays
+     */
+    payload = (const char *)data + sizeof(head);
+    if (do_normals) {
+        FREE_CMATRIX_17(s->nn);
+        s->nn = ALLOC_CMATRIX_17(s->np,3);
+        for (k = 0; k < s->np; k++, payload += 3*sizeof(float))
+            memcpy(s->nn[k],payload,3*sizeof(float));
+    }
+    payload += s->np*sizeof(int);
+    neighbor_tri = MALLOC_17(s->np,int *);
+    for (k = 0; k < s->np; k++) {
+        neighbor_tri[k] = NULL;
+        if (nneighbor_tri[k] > 0) {
+            neighbor_tri[k] = MALLOC_17(nneighbor_tri[k],int);
+            memcpy(neighbor_tri[k],payload,nneighbor_tri[k]*sizeof(int));
+            payload += nneighbor_tri[k]*sizeof(int);
+        }
+    }
+    payload += s->np*sizeof(int);
+    neighbor_vert = MALLOC_17(s->np,int *);
+    for (k = 0; k < s->np; k++) {
+        neighbor_vert[k] = NULL;
+        if (nneighbor_vert[k] > 0) {
+            neighbor_vert[k] = MALLOC_17(nneighbor_vert[k],int);
+            memcpy(neighbor_vert[k],payload,nneighbor_vert[k]*sizeof(int));
+            payload += nneighbor_vert[k]*sizeof(int);
+        }
+    }
+    vert_dist = MALLOC_17(s->np,float *);
+    for (k = 0; k < s->np; k++) {
+        vert_dist[k] = MALLOC_17(nneighbor_vert[k],float);
+        memcpy(vert_dist[k],payload,nneighbor_vert[k]*sizeof(float));
+        payload += nneighbor_vert[k]*sizeof(float);
+    }
+    /*
+     * Replace the old information
+     */
+    if (s->neighbor_tri) {
+        for (k = 0; k < s->np; k++)
+            FREE_17(s->neighbor_tri[k]);
+        FREE_17(s->neighbor_tri);
+    }
+    FREE_17(s->nneighbor_tri);
+    if (s->neighbor_vert) {
+        for (k = 0; k < s->np; k++)
+            FREE_17(s->neighbor_vert[k]);
+        FREE_17(s->neighbor_vert);
+    }
+    FREE_17(s->nneighbor_vert);
+    if (s->vert_dist) {
+        for (k = 0; k < s->np; k++)
+            FREE_17(s->vert_dist[k]);
+        FREE_17(s->vert_dist);
+    }
+    s->neighbor_tri   = neighbor_tri;
+    s->nneighbor_tri  = nneighbor_tri;
+    s->neighbor_vert  = neighbor_vert;
+    s->nneighbor_vert = nneighbor_vert;
+    s->vert_dist      = vert_dist;
+    VEC_COPY_17(s->cm,head.cm);
+    printf("\tRead the geometry information from %s\n",name.toUtf8().constData());
+
+    return true;
+}
+
+static bool write_geometry_cache(const QString& name, MneSourceSpaceOld* s, int do_normals, int check_too_many_neighbors)
+{
+    geomCacheHeaderRec head;
+    QByteArray         payload;
+    QByteArray         key,checksum;
+    int                k;
+
+    memset(&head,0,sizeof(head));
+    head.magic      = GEOM_CACHE_MAGIC;
+    head.version    = GEOM_CACHE_VERSION;
+    head.byte_order = GEOM_CACHE_BYTE_ORDER;
+    head.np         = s->np;
+    head.ntri       = s->ntri;
+    head.do_normals = do_normals ? 1 : 0;
+    head.check_too_many_neighbors = check_too_many_neighbors ? 1 : 0;
+    for (k = 0; k < s->np; k++) {
+        head.nneighbor_tri_total  += s->nneighbor_tri[k];
+        head.nneighbor_vert_total += s->nneighbor_vert[k];
+    }
+    VEC_COPY_17(head.cm,s->cm);
+    key = geometry_cache_key(s,do_normals,check_too_many_neighbors);
+    memcpy(head.key,key.constData(),GEOM_CACHE_KEY_LEN);
+
+    payload.reserve(geometry_cache_payload_size(head));
+    if (do_normals)
+        for (k = 0; k < s->np; k++)
+            payload.append((const char *)s->nn[k],3*sizeof(float));
+    payload.append((const char *)s->nneighbor_tri,s->np*sizeof(int));
+    for (k = 0; k < s->np; k++)
+        if (s->nneighbor_tri[k] > 0)
+            payload.append((const char *)s->neighbor_tri[k],s->nneighbor_tri[k]*sizeof(int));
+    payload.append((const char *)s->nneighbor_vert,s->np*sizeof(int));
+    for (k = 0; k < s->np; k++)
+        if (s->nneighbor_vert[k] > 0)
+            payload.append((const char *)s->neighbor_vert[k],s->nneighbor_vert[k]*sizeof(int));
+    for (k = 0; k < s->np; k++)
+        if (s->nneighbor_vert[k] > 0)
+            payload.append((const char *)s->vert_dist[k],s->nneighbor_vert[k]*sizeof(float));
+    checksum = QCryptographicHash::hash(payload,QCryptographicHash::Sha1);
+    memcpy(head.checksum,checksum.constData(),GEOM_CACHE_KEY_LEN);
+    /*
+     * Write to a temporary file first so that a reader never sees a partial cache
+     */
+    QSaveFile file(name);
+    if (!file.open(QIODevice::WriteOnly) ||
+            file.write((const char *)&head,sizeof(head)) != (qint64)sizeof(head) ||
+            file.write(payload) != payload.size() ||
+            !file.commit()) {
+        printf("Could not write the geometry cache %s\n",name.toUtf8().constData());
+        return false;
+    }
+    printf("\tWrote the geometry information to %s\n",name.toUtf8().constData());
+
+    return true;
+}
+
+//=============================================================================================================
+
+QString MneSurfaceOrVolume::mne_geometry_cache_name(const QString& name, int id)
+{
+    if (id >= 0)
+        return QString("%1-%2.geom").arg(name).arg(id);
+    return QString("%1.geom").arg(name);
+}
+
+//=============================================================================================================
+
+int MneSurfaceOrVolume::mne_source_space_add_cached_geometry_info(MneSourceSpaceOld* s, int do_normals, int check_too_many_neighbors, const QString& cachename)
+{
+    if (cachename.isEmpty() || !s || s->type != MNE_SOURCE_SPACE_SURFACE)
+        return add_geometry_info(s,do_normals,NULL,check_too_many_neighbors);
+    if (read_geometry_cache(cachename,s,do_normals,check_too_many_neighbors)) {
+        /*
+         * The triangle data are cheap to compute and are not stored
+         */
+        mne_add_triangle_data(s);
+        return OK;
+    }
+    if (add_geometry_info(s,do_normals,NULL,check_too_many_neighbors) != OK)
+        return FAIL;
+    write_geometry_cache(cachename,s,do_normals,check_too_many_neighbors);
+    return OK;
+}
+
 //=============================================================================================================
 
 int MneSurfaceOrVolume::mne_source_space_add_geometry_info(MneSourceSpaceOld* s, int do_normals)
@@ -3302,7 +4006,7 @@ char * MneSurfaceOrVolume::mne_compose_surf_name(const char *subj,
 MneSourceSpaceOld* MneSurfaceOrVolume::mne_load_surface(char *surf_file,
                                                         char *curv_file)
 {
-    return mne_load_surface_geom(surf_file,curv_file,TRUE,TRUE);
+    return mne_load_surface_geom(surf_file,curv_file,TRUE,TRUE,false);
 }
 
 //=============================================================================================================
@@ -3310,7 +4014,8 @@ MneSourceSpaceOld* MneSurfaceOrVolume::mne_load_surface(char *surf_file,
 MneSourceSpaceOld* MneSurfaceOrVolume::mne_load_surface_geom(char *surf_file,
                                                              char *curv_file,
                                                              int  add_geometry,
-                                                             int  check_too_many_neighbors)
+                                                             int  check_too_many_neighbors,
+                                                             bool use_geometry_cache)
     /*
      * Load the surface and add the geometry information
      */
@@ -3350,14 +4055,9 @@ MneSourceSpaceOld* MneSurfaceOrVolume::mne_load_surface_geom(char *surf_file,
     s->curv = curvs; curvs = Q_NULLPTR;
     s->val  = MALLOC_17(s->np,float);
     if (add_geometry) {
-        if (check_too_many_neighbors) {
-            if (mne_source_space_add_geometry_info(s,TRUE) != OK)
-                goto bad;
-        }
-        else {
-            if (mne_source_space_add_geometry_info2(s,TRUE) != OK)
-                goto bad;
-        }
+        if (mne_source_space_add_cached_geometry_info(s,TRUE,check_too_many_neighbors,
+                                                      use_geometry_cache ? mne_geometry_cache_name(surf_file,-1) : QString()) != OK)
+            goto bad;
     }
     else if (s->nn == Q_NULLPTR) {			/* Normals only */
         if (mne_add_vertex_normals(s) != OK)
@@ -54,6 +54,7 @@
 // QT INCLUDES
 //=============================================================================================================
 
+#include <QAtomicPointer>
 #include <QSharedPointer>
 #include <QStringList>
 #include <QDebug>
@@ -103,6 +104,7 @@ class MneSurfaceOld;
 class MneMshDisplaySurface;
 class MneProjData;
 class MneMghTagGroup;
+class MNETriangleBVH;
 
 //=============================================================================================================
 /**
@@ -174,7 +176,8 @@ public:
     static MneSourceSpaceOld* make_volume_source_space(MneSurfaceOld* surf,
                                                                          float grid,
                                                                          float exclude,
-                                                                         float mindist);
+                                                                         float mindist,
+                                                                         bool  scanline = true);  /* Classify the grid rows by scanline instead of testing each point */
 
     //============================= mne_source_space.c =============================
 
@@ -198,7 +201,8 @@ public:
                                           int  which,             /* Which surface are we looking for (-1 loads the first one)*/
                                           int  add_geometry,      /* Add the geometry information */
                                           float *sigmap,          /* Conductivity? */
-                                          bool   check_too_many_neighbors);
+                                          bool   check_too_many_neighbors,
+                                          bool   use_geometry_cache);    /* Store the geometry information next to the file and reuse it */
 
     //============================= mne_project_to_surface.c =============================
 
@@ -232,6 +236,8 @@ public:
 
     static int mne_project_to_surface(MneSurfaceOld* s, void *proj_data, float *r, int project_it, float *distp);
 
+    static MNETriangleBVH* mne_surface_triangle_bvh(MneSurfaceOld* s);  /* The bounding volume hierarchy of the triangles, built when first needed */
+
     static void mne_project_to_triangle(MneSurfaceOld* s,
                                             int        best,
                                             float      *r,
@@ -320,6 +326,16 @@ public:
 
     static int mne_source_space_add_geometry_info2(MneSourceSpaceOld* s, int do_normals);
 
+    //============================= geometry cache =============================
+
+    static QString mne_geometry_cache_name(const QString& name,    /* The surface file */
+                                           int id);                /* Surface id within the file or -1 */
+
+    static int mne_source_space_add_cached_geometry_info(MneSourceSpaceOld* s,
+                                                         int do_normals,
+                                                         int check_too_many_neighbors,
+                                                         const QString& cachename);    /* Read from here if valid, otherwise compute and write. Empty disables the cache */
+
     //============================= digitizer.c =============================
 
     static int align_fiducials(FIFFLIB::FiffDigitizerData* head_dig,
@@ -371,7 +387,8 @@ public:
     static MneSourceSpaceOld* mne_load_surface_geom(char *surf_file,
                          char *curv_file,
                          int  add_geometry,
-                         int  check_too_many_neighbors);
+                         int  check_too_many_neighbors,
+                         bool use_geometry_cache);     /* Store the geometry information next to the file and reuse it */
 
     static int mne_read_triangle_file(char  *fname,
                    int   *nvertp,
@@ -460,6 +477,8 @@ public:
     int              **neighbor_tri;    /* Neighboring triangles for each vertex Note: number of entries varies for vertex to vertex */
     int              *nneighbor_tri;    /* Number of neighboring triangles for each vertex */
 
+    QAtomicPointer<MNETriangleBVH> triangle_bvh;   /* Bounding volume hierarchy for closest triangle searches, built when first needed */
+
     MneNearest*      nearest;   /* Nearest inuse vertex info (number of these is the same as the number vertices) */
     MnePatchInfo*    *patches;  /* Patch information (number of these is the same as the number of points in use) */
     int              npatch;    /* How many (should be same as nuse) */
@@ -62,6 +62,7 @@
 #include <utils/kmeans.h>
 
 #include <iostream>
+#include <algorithm>
 #include <QtConcurrent>
 #include <QFuture>
 
@@ -346,9 +347,20 @@ MNEForwardSolution MNEForwardSolution::cluster_forward_solution(const Annotation
         // Calculate clusters
         //
         printf("Clustering... ");
-        QFuture< RegionDataOut > res;
-        res = QtConcurrent::mapped(m_qListRegionDataIn, &RegionData::cluster);
-        res.waitForFinished();
+        // Schedule the regions on the global thread pool, the most expensive ones first. The replicates of a
+        // region are run on the same pool.
+        QVector<int> vecRegionOrder(m_qListRegionDataIn.size());
+        for(int i = 0; i < vecRegionOrder.size(); ++i)
+            vecRegionOrder[i] = i;
+        std::stable_sort(vecRegionOrder.begin(), vecRegionOrder.end(), [&m_qListRegionDataIn](int a, int b) {
+            return (double)m_qListRegionDataIn[a].matRoiG.size() * m_qListRegionDataIn[a].nClusters
+                    > (double)m_qListRegionDataIn[b].matRoiG.size() * m_qListRegionDataIn[b].nClusters;
+        });
+
+        QVector<RegionDataOut> res(m_qListRegionDataIn.size());
+        QtConcurrent::blockingMap(vecRegionOrder, [&m_qListRegionDataIn, &res](const int iRegion) {
+            res[iRegion] = m_qListRegionDataIn.at(iRegion).cluster();
+        });
 
         //
         // Assign results
@@ -359,7 +371,7 @@ MNEForwardSolution MNEForwardSolution::cluster_forward_solution(const Annotation
         qint32 nSens;
         QList<RegionData>::const_iterator itIn;
         itIn = m_qListRegionDataIn.begin();
-        QFuture<RegionDataOut>::const_iterator itOut;
+        QVector<RegionDataOut>::const_iterator itOut;
         for (itOut = res.constBegin(); itOut != res.constEnd(); ++itOut)
         {
             nClusters = itOut->ctrs.rows();
@@ -123,7 +123,10 @@ struct RegionData
         // Kmeans Reduction
         RegionDataOut p_RegionDataOut;
 
-        UTILSLIB::KMeans t_kMeans(t_sDistMeasure, QString("sample"), 5);
+        // k-means++ seeding with a fixed seed per label makes the clustering reproducible
+        UTILSLIB::KMeans t_kMeans(t_sDistMeasure, QString("plus"), 5);
+        t_kMeans.setSeed(this->iLabelIdxIn);
+        t_kMeans.setParallelReplicates(true);
 
         if(bUseWhitened)
         {
@@ -43,6 +43,7 @@
 #include <fs/label.h>
 
 #include <iostream>
+#include <algorithm>
 
 //=============================================================================================================
 // QT INCLUDES
@@ -50,12 +51,17 @@
 
 #include <QFuture>
 #include <QtConcurrent>
+#include <QFile>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QCryptographicHash>
 
 //=============================================================================================================
 // EIGEN INCLUDES
 //=============================================================================================================
 
 #include <Eigen/SVD>
+#include <Eigen/Eigenvalues>
 
 //=============================================================================================================
 // USED NAMESPACES
@@ -67,10 +73,177 @@ using namespace FIFFLIB;
 using namespace FSLIB;
 using namespace Eigen;
 
+//=============================================================================================================
+// DEFINE NAMESPACE MNELIB
+//=============================================================================================================
+
+namespace MNELIB
+{
+
+//=============================================================================================================
+/**
+ * Imaging kernel assembled by MNEInverseOperator::prepare_kernel for one set of parameters.
+ */
+struct MNEInverseKernel
+{
+    qint32 nave;                                /**< Number of averages */
+    float lambda2;                              /**< Regularization factor */
+    bool dSPM;                                  /**< dSPM noise normalization */
+    bool sLORETA;                               /**< sLORETA noise normalization */
+    bool pick_normal;                           /**< Only the normal components were kept */
+    Eigen::MatrixXd K;                          /**< Imaging kernel */
+    Eigen::SparseMatrix<double> noise_norm;     /**< Noise normalization */
+    QList<Eigen::VectorXi> vertno;              /**< Vertices of the hemispheres */
+};
+
+//=============================================================================================================
+/**
+ * Kernel cache of MNEInverseOperator. Every operator owns its cache, a copy only takes over the settings.
+ */
+struct MNEInverseKernelCache
+{
+    MNEInverseKernelCache()
+    : iMaxSize(8)
+    , iHits(0)
+    , iMisses(0)
+    , iSourceOri(-1)
+    , bFileRead(false)
+    , bDirty(false)
+    {}
+
+    MNEInverseKernelCache(const MNEInverseKernelCache& other)
+    : iMaxSize(8)
+    , iHits(0)
+    , iMisses(0)
+    , iSourceOri(-1)
+    , bFileRead(false)
+    , bDirty(false)
+    {
+        QMutexLocker locker(&other.mutex);
+        sFileName = other.sFileName;
+        iMaxSize = other.iMaxSize;
+    }
+
+    ~MNEInverseKernelCache()
+    {
+        write();
+    }
+
+    //=========================================================================================================
+    /**
+     * Writes all cached kernels to the sidecar file if kernels were added since the last write. The mutex has
+     * to be locked.
+     *
+     * @return true when successful or if there was nothing to write, false otherwise.
+     */
+    bool write();
+
+    mutable QMutex mutex;               /**< Guards the cache */
+    QList<MNEInverseKernel> lKernels;   /**< Cached kernels, the most recently used one is last */
+    QString sFileName;                  /**< The sidecar file, empty if not used */
+    QString sKey;                       /**< The operator key stored in the sidecar file */
+    int iMaxSize;                       /**< Maximal number of cached kernels */
+    int iHits;                          /**< Number of cache hits */
+    int iMisses;                        /**< Number of cache misses */
+    qint32 iSourceOri;                  /**< Source orientation of the operator the key belongs to */
+    bool bFileRead;                     /**< Whether the kernels of the sidecar file were read for the current key */
+    bool bDirty;                        /**< Whether kernels were added since the sidecar file was written */
+};
+
+//=============================================================================================================
+
+bool MNEInverseKernelCache::write()
+{
+    if(!bDirty || sFileName.isEmpty()) {
+        return true;
+    }
+
+    QFile t_file(sFileName);
+    FiffStream::SPtr t_pStream = FiffStream::start_file(t_file);
+
+    if(!t_pStream) {
+        return false;
+    }
+
+    t_pStream->start_block(FIFFB_MNE);
+    t_pStream->write_string(FIFF_DESCRIPTION, sKey);
+
+    for(int i = 0; i < lKernels.size(); ++i) {
+        const MNEInverseKernel& kernel = lKernels[i];
+
+        t_pStream->start_block(FIFFB_MNE_INVERSE_SOLUTION);
+
+        qint32 iMethod = kernel.dSPM ? 1 : (kernel.sLORETA ? 2 : 0);
+        qint32 iOri = (kernel.pick_normal || iSourceOri == FIFFV_MNE_FIXED_ORI) ? FIFFV_MNE_FIXED_ORI : FIFFV_MNE_FREE_ORI;
+        qint32 iRows = kernel.K.rows();
+        qint32 iCols = kernel.K.cols();
+
+        t_pStream->write_int(FIFF_NAVE, &kernel.nave);
+        t_pStream->write_float(FIFF_MNE_INVERSE_LAMBDA2, &kernel.lambda2);
+        t_pStream->write_int(FIFF_MNE_INVERSE_NOISE_NORM_METHOD, &iMethod);
+        t_pStream->write_int(FIFF_MNE_SOURCE_ORIENTATION, &iOri);
+        t_pStream->write_int(FIFF_MNE_NROW, &iRows);
+        t_pStream->write_int(FIFF_MNE_NCOL, &iCols);
+
+        // Storage order: row-major
+        Matrix<double, Dynamic, Dynamic, RowMajor> matK = kernel.K;
+        t_pStream->write_double(FIFF_MNE_INVERSE_FULL, matK.data(), matK.size());
+
+        if(kernel.noise_norm.rows() > 0) {
+            VectorXd vecNoiseNorm = kernel.noise_norm.diagonal();
+            t_pStream->write_double(FIFF_MNE_INVERSE_NOISE_NORM, vecNoiseNorm.data(), vecNoiseNorm.size());
+        }
+
+        t_pStream->end_block(FIFFB_MNE_INVERSE_SOLUTION);
+    }
+
+    t_pStream->end_block(FIFFB_MNE);
+    t_pStream->end_file();
+
+    bDirty = false;
+
+    return true;
+}
+
+} // NAMESPACE
+
 //=============================================================================================================
 // DEFINE MEMBER METHODS
 //=============================================================================================================
 
+MNEInverseOperator::KernelCacheHolder::KernelCacheHolder()
+: m_pCache(new MNEInverseKernelCache)
+{
+}
+
+//=============================================================================================================
+
+MNEInverseOperator::KernelCacheHolder::KernelCacheHolder(const KernelCacheHolder &p_KernelCacheHolder)
+: m_pCache(new MNEInverseKernelCache(*p_KernelCacheHolder.m_pCache))
+{
+}
+
+//=============================================================================================================
+
+MNEInverseOperator::KernelCacheHolder& MNEInverseOperator::KernelCacheHolder::operator=(const KernelCacheHolder &p_KernelCacheHolder)
+{
+    // The kernels of this operator do not belong to the assigned one
+    if(this != &p_KernelCacheHolder) {
+        m_pCache = QSharedPointer<MNEInverseKernelCache>(new MNEInverseKernelCache(*p_KernelCacheHolder.m_pCache));
+    }
+
+    return *this;
+}
+
+//=============================================================================================================
+
+MNEInverseKernelCache* MNEInverseOperator::KernelCacheHolder::operator->() const
+{
+    return m_pCache.data();
+}
+
+//=============================================================================================================
+
 MNEInverseOperator::MNEInverseOperator()
 : methods(-1)
 , source_ori(-1)
@@ -117,35 +290,11 @@ MNEInverseOperator::MNEInverseOperator(const FiffInfo &info,
 
 //=============================================================================================================
 
-MNEInverseOperator::MNEInverseOperator(const MNEInverseOperator &p_MNEInverseOperator)
-: info(p_MNEInverseOperator.info)
-, methods(p_MNEInverseOperator.methods)
-, source_ori(p_MNEInverseOperator.source_ori)
-, nsource(p_MNEInverseOperator.nsource)
-, nchan(p_MNEInverseOperator.nchan)
-, coord_frame(p_MNEInverseOperator.coord_frame)
-, source_nn(p_MNEInverseOperator.source_nn)
-, sing(p_MNEInverseOperator.sing)
-, eigen_leads_weighted(p_MNEInverseOperator.eigen_leads_weighted)
-, eigen_leads(p_MNEInverseOperator.eigen_leads)
-, eigen_fields(p_MNEInverseOperator.eigen_fields)
-, noise_cov(p_MNEInverseOperator.noise_cov)
-, source_cov(p_MNEInverseOperator.source_cov)
-, orient_prior(p_MNEInverseOperator.orient_prior)
-, depth_prior(p_MNEInverseOperator.depth_prior)
-, fmri_prior(p_MNEInverseOperator.fmri_prior)
-, src(p_MNEInverseOperator.src)
-, mri_head_t(p_MNEInverseOperator.mri_head_t)
-, nave(p_MNEInverseOperator.nave)
-, projs(p_MNEInverseOperator.projs)
-, proj(p_MNEInverseOperator.proj)
-, whitener(p_MNEInverseOperator.whitener)
-, reginv(p_MNEInverseOperator.reginv)
-, noisenorm(p_MNEInverseOperator.noisenorm)
-{
-    qRegisterMetaType<QSharedPointer<MNELIB::MNEInverseOperator> >("QSharedPointer<MNELIB::MNEInverseOperator>");
-    qRegisterMetaType<MNELIB::MNEInverseOperator>("MNELIB::MNEInverseOperator");
-}
+MNEInverseOperator::MNEInverseOperator(const MNEInverseOperator &p_MNEInverseOperator) = default;
+
+//=============================================================================================================
+
+MNEInverseOperator& MNEInverseOperator::operator=(const MNEInverseOperator &p_MNEInverseOperator) = default;
 
 //=============================================================================================================
 
@@ -304,6 +453,286 @@ bool MNEInverseOperator::assemble_kernel(const Label &label,
 
 //=============================================================================================================
 
+bool MNEInverseOperator::prepare_kernel(qint32 nave,
+                                        float lambda2,
+                                        bool dSPM,
+                                        bool sLORETA,
+                                        bool pick_normal,
+                                        MatrixXd &K,
+                                        SparseMatrix<double> &noise_norm,
+                                        QList<VectorXi> &vertno)
+{
+    {
+        QMutexLocker locker(&m_pKernelCache->mutex);
+
+        // Copies and cleared caches read the sidecar file when a kernel is first needed, with the current key
+        if(!m_pKernelCache->sFileName.isEmpty() && !m_pKernelCache->bFileRead) {
+            readKernelCacheFile();
+        }
+
+        for(int i = 0; i < m_pKernelCache->lKernels.size(); ++i) {
+            const MNEInverseKernel& kernel = m_pKernelCache->lKernels[i];
+
+            if(kernel.nave == nave && kernel.lambda2 == lambda2 && kernel.dSPM == dSPM && kernel.sLORETA == sLORETA && kernel.pick_normal == pick_normal) {
+                K = kernel.K;
+                noise_norm = kernel.noise_norm;
+                vertno = kernel.vertno;
+                m_K = K;
+
+                m_pKernelCache->lKernels.move(i, m_pKernelCache->lKernels.size() - 1);
+                ++m_pKernelCache->iHits;
+
+                printf("Using cached inverse kernel (nave = %d, lambda2 = %f)\n", nave, lambda2);
+                return true;
+            }
+        }
+
+        ++m_pKernelCache->iMisses;
+    }
+
+    MNEInverseOperator inv = this->prepare_inverse_operator(nave, lambda2, dSPM, sLORETA);
+    if(inv.nave != nave) {
+        return false;
+    }
+
+    QString method = dSPM ? QString("dSPM") : (sLORETA ? QString("sLORETA") : QString("MNE"));
+    FSLIB::Label label;
+    if(!inv.assemble_kernel(label, method, pick_normal, K, noise_norm, vertno)) {
+        return false;
+    }
+    m_K = K;
+
+    MNEInverseKernel kernel;
+    kernel.nave = nave;
+    kernel.lambda2 = lambda2;
+    kernel.dSPM = dSPM;
+    kernel.sLORETA = sLORETA;
+    kernel.pick_normal = pick_normal;
+    kernel.K = K;
+    kernel.noise_norm = noise_norm;
+    kernel.vertno = vertno;
+
+    QMutexLocker locker(&m_pKernelCache->mutex);
+
+    m_pKernelCache->lKernels.append(kernel);
+    while(m_pKernelCache->lKernels.size() > m_pKernelCache->iMaxSize) {
+        m_pKernelCache->lKernels.removeFirst();
+    }
+
+    // The sidecar file is written once, see writeKernelCacheFile
+    m_pKernelCache->bDirty = !m_pKernelCache->sFileName.isEmpty();
+
+    return true;
+}
+
+//=============================================================================================================
+
+int MNEInverseOperator::setKernelCacheFile(const QString &sFileName)
+{
+    QMutexLocker locker(&m_pKernelCache->mutex);
+
+    m_pKernelCache->write();
+
+    m_pKernelCache->sFileName = sFileName;
+    m_pKernelCache->sKey.clear();
+    m_pKernelCache->bFileRead = false;
+
+    if(sFileName.isEmpty()) {
+        return 0;
+    }
+
+    return readKernelCacheFile();
+}
+
+//=============================================================================================================
+
+int MNEInverseOperator::readKernelCacheFile()
+{
+    const QString& sFileName = m_pKernelCache->sFileName;
+    QString sKey = kernelCacheKey();
+
+    m_pKernelCache->sKey = sKey;
+    m_pKernelCache->iSourceOri = this->source_ori;
+    m_pKernelCache->bFileRead = true;
+
+    if(!QFile::exists(sFileName)) {
+        return 0;
+    }
+
+    QFile t_file(sFileName);
+    FiffStream::SPtr t_pStream(new FiffStream(&t_file));
+
+    if(!t_pStream->open()) {
+        return 0;
+    }
+
+    QList<FiffDirNode::SPtr> lMne = t_pStream->dirtree()->dir_tree_find(FIFFB_MNE);
+    FiffTag::SPtr t_pTag;
+
+    if(lMne.isEmpty() || !lMne[0]->find_tag(t_pStream, FIFF_DESCRIPTION, t_pTag) || t_pTag->toString() != sKey) {
+        printf("Kernel cache %s belongs to a different inverse operator. It will be overwritten.\n", sFileName.toUtf8().constData());
+        return 0;
+    }
+
+    int iNumRead = 0;
+    QList<FiffDirNode::SPtr> lKernelNodes = lMne[0]->dir_tree_find(FIFFB_MNE_INVERSE_SOLUTION);
+
+    for(int i = 0; i < lKernelNodes.size(); ++i) {
+        const FiffDirNode::SPtr& node = lKernelNodes[i];
+        MNEInverseKernel kernel;
+
+        if(!node->find_tag(t_pStream, FIFF_NAVE, t_pTag)) {
+            continue;
+        }
+        kernel.nave = *t_pTag->toInt();
+
+        if(!node->find_tag(t_pStream, FIFF_MNE_INVERSE_LAMBDA2, t_pTag)) {
+            continue;
+        }
+        kernel.lambda2 = *t_pTag->toFloat();
+
+        if(!node->find_tag(t_pStream, FIFF_MNE_INVERSE_NOISE_NORM_METHOD, t_pTag)) {
+            continue;
+        }
+        kernel.dSPM = *t_pTag->toInt() == 1;
+        kernel.sLORETA = *t_pTag->toInt() == 2;
+
+        if(!node->find_tag(t_pStream, FIFF_MNE_SOURCE_ORIENTATION, t_pTag)) {
+            continue;
+        }
+        kernel.pick_normal = (*t_pTag->toInt() == FIFFV_MNE_FIXED_ORI && this->source_ori == FIFFV_MNE_FREE_ORI);
+
+        if(!node->find_tag(t_pStream, FIFF_MNE_NROW, t_pTag)) {
+            continue;
+        }
+        int iRows = *t_pTag->toInt();
+
+        if(!node->find_tag(t_pStream, FIFF_MNE_NCOL, t_pTag)) {
+            continue;
+        }
+        int iCols = *t_pTag->toInt();
+
+        if(!node->find_tag(t_pStream, FIFF_MNE_INVERSE_FULL, t_pTag) || t_pTag->size() != (int)sizeof(double) * iRows * iCols) {
+            continue;
+        }
+        kernel.K = Map<const Matrix<double, Dynamic, Dynamic, RowMajor> >(t_pTag->toDouble(), iRows, iCols);
+
+        if(node->find_tag(t_pStream, FIFF_MNE_INVERSE_NOISE_NORM, t_pTag)) {
+            int iNumNorm = t_pTag->size() / sizeof(double);
+            const double* pNorm = t_pTag->toDouble();
+
+            std::vector<Eigen::Triplet<double> > tripletList;
+            tripletList.reserve(iNumNorm);
+            for(int j = 0; j < iNumNorm; ++j) {
+                tripletList.push_back(Eigen::Triplet<double>(j, j, pNorm[j]));
+            }
+            kernel.noise_norm = SparseMatrix<double>(iNumNorm, iNumNorm);
+            kernel.noise_norm.setFromTriplets(tripletList.begin(), tripletList.end());
+        }
+
+        // The stored kernels cover the whole source space, like the ones assembled by prepare_kernel
+        kernel.vertno = this->src.get_vertno();
+
+        m_pKernelCache->lKernels.append(kernel);
+        ++iNumRead;
+    }
+
+    while(m_pKernelCache->lKernels.size() > m_pKernelCache->iMaxSize) {
+        m_pKernelCache->lKernels.removeFirst();
+    }
+
+    printf("Read %d inverse kernels from %s\n", iNumRead, sFileName.toUtf8().constData());
+
+    return iNumRead;
+}
+
+//=============================================================================================================
+
+void MNEInverseOperator::setKernelCacheSize(int iSize)
+{
+    QMutexLocker locker(&m_pKernelCache->mutex);
+
+    m_pKernelCache->iMaxSize = std::max(iSize, 1);
+    while(m_pKernelCache->lKernels.size() > m_pKernelCache->iMaxSize) {
+        m_pKernelCache->lKernels.removeFirst();
+    }
+}
+
+//=============================================================================================================
+
+bool MNEInverseOperator::writeKernelCacheFile()
+{
+    QMutexLocker locker(&m_pKernelCache->mutex);
+
+    return m_pKernelCache->write();
+}
+
+//=============================================================================================================
+
+void MNEInverseOperator::clearKernelCache()
+{
+    QMutexLocker locker(&m_pKernelCache->mutex);
+
+    m_pKernelCache->write();
+
+    m_pKernelCache->lKernels.clear();
+    m_pKernelCache->iHits = 0;
+    m_pKernelCache->iMisses = 0;
+    m_pKernelCache->bFileRead = false;
+}
+
+//=============================================================================================================
+
+int MNEInverseOperator::getKernelCacheHits() const
+{
+    return m_pKernelCache->iHits;
+}
+
+//=============================================================================================================
+
+int MNEInverseOperator::getKernelCacheMisses() const
+{
+    return m_pKernelCache->iMisses;
+}
+
+//=============================================================================================================
+
+QString MNEInverseOperator::kernelCacheKey() const
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+
+    // Hash the dimensions along with the data, so that an operator which is only partially populated gets a key too
+    const MatrixXd matEmpty;
+    auto addMatrix = [&hash](const MatrixXd& mat) {
+        qint64 vecDims[2] = {mat.rows(), mat.cols()};
+        hash.addData(reinterpret_cast<const char*>(vecDims), sizeof(vecDims));
+        if(mat.size() > 0) {
+            hash.addData(reinterpret_cast<const char*>(mat.data()), mat.size() * sizeof(double));
+        }
+    };
+
+    qint32 vecInts[6] = {methods, source_ori, nsource, nchan, nave, eigen_leads_weighted ? 1 : 0};
+    hash.addData(reinterpret_cast<const char*>(vecInts), sizeof(vecInts));
+
+    addMatrix(sing);
+    addMatrix(eigen_leads ? eigen_leads->data : matEmpty);
+    addMatrix(eigen_fields ? eigen_fields->data : matEmpty);
+    addMatrix(noise_cov ? noise_cov->data : matEmpty);
+    addMatrix(source_cov ? source_cov->data : matEmpty);
+    if(noise_cov) {
+        hash.addData(noise_cov->names.join(";").toUtf8());
+    }
+
+    for(int i = 0; i < projs.size(); ++i) {
+        addMatrix(projs[i].data ? projs[i].data->data : matEmpty);
+        hash.addData(QByteArray(projs[i].active ? "1" : "0"));
+    }
+
+    return QString(hash.result().toHex());
+}
+
+//=============================================================================================================
+
 bool MNEInverseOperator::check_ch_names(const FiffInfo &info) const
 {
     QStringList inv_ch_names = this->eigen_fields->col_names;
@@ -499,9 +928,20 @@ MatrixXd MNEInverseOperator::cluster_kernel(const AnnotationSet &p_AnnotationSet
         // Calculate clusters
         //
         printf("Clustering... ");
-        QFuture< RegionMTOut > res;
-        res = QtConcurrent::mapped(m_qListRegionMTIn, &RegionMT::cluster);
-        res.waitForFinished();
+        // Schedule the regions on the global thread pool, the most expensive ones first. The replicates of a
+        // region are run on the same pool.
+        QVector<int> vecRegionOrder(m_qListRegionMTIn.size());
+        for(int i = 0; i < vecRegionOrder.size(); ++i)
+            vecRegionOrder[i] = i;
+        std::stable_sort(vecRegionOrder.begin(), vecRegionOrder.end(), [&m_qListRegionMTIn](int a, int b) {
+            return (double)m_qListRegionMTIn[a].matRoiMT.size() * m_qListRegionMTIn[a].nClusters
+                    > (double)m_qListRegionMTIn[b].matRoiMT.size() * m_qListRegionMTIn[b].nClusters;
+        });
+
+        QVector<RegionMTOut> res(m_qListRegionMTIn.size());
+        QtConcurrent::blockingMap(vecRegionOrder, [&m_qListRegionMTIn, &res](const int iRegion) {
+            res[iRegion] = m_qListRegionMTIn.at(iRegion).cluster();
+        });
 
         //
         // Assign results
@@ -512,7 +952,7 @@ MatrixXd MNEInverseOperator::cluster_kernel(const AnnotationSet &p_AnnotationSet
         qint32 nSens;
         QList<RegionMT>::const_iterator itIn;
         itIn = m_qListRegionMTIn.begin();
-        QFuture<RegionMTOut>::const_iterator itOut;
+        QVector<RegionMTOut>::const_iterator itOut;
         for (itOut = res.constBegin(); itOut != res.constEnd(); ++itOut)
         {
             nClusters = itOut->ctrs.rows();
@@ -921,6 +1361,109 @@ MNEInverseOperator MNEInverseOperator::make_inverse_operator(const FiffInfo &inf
 
 //=============================================================================================================
 
+MNEInverseOperator MNEInverseOperator::update_noise_cov(const FiffInfo &p_info,
+                                                        const MNEForwardSolution &forward,
+                                                        const FiffCov &p_noise_cov) const
+{
+    if(!this->eigen_fields || !this->eigen_leads || !this->source_cov) {
+        qWarning("MNEInverseOperator::update_noise_cov - The inverse operator is empty.");
+        return MNEInverseOperator();
+    }
+
+    //
+    // 1.-4. Pick the channels and compose the whitener of the new noise covariance
+    //
+    FiffInfo gain_info;
+    MatrixXd gain;
+    MatrixXd whitener;
+    qint32 n_nzero;
+    FiffCov p_outNoiseCov;
+    forward.prepare_forward(p_info, p_noise_cov, false, gain_info, gain, p_outNoiseCov, whitener, n_nzero);
+
+    if(gain_info.ch_names != this->eigen_fields->col_names || gain.cols() != this->eigen_leads->data.rows()) {
+        qWarning("MNEInverseOperator::update_noise_cov - The channels or sources differ from the ones of the inverse operator.");
+        return MNEInverseOperator();
+    }
+
+    //
+    // 5.-6. The unscaled source covariance only depends on the forward solution, recompose it from the priors
+    //
+    VectorXd vecSourceCov = VectorXd::Ones(gain.cols());
+    if(this->depth_prior && this->depth_prior->data.rows() == gain.cols()) {
+        vecSourceCov = this->depth_prior->data.col(0);
+    }
+    if(this->orient_prior && this->orient_prior->data.rows() == gain.cols()) {
+        vecSourceCov.array() *= this->orient_prior->data.col(0).array();
+    }
+
+    //
+    // 8.-11. Whiten and weight the forward solution, adjust the trace of G*R*G' to the number of sensors
+    //
+    gain = whitener * gain;
+    gain = gain * vecSourceCov.cwiseSqrt().asDiagonal();
+
+    MatrixXd matGram = gain * gain.transpose();
+    double scaling_source_cov = (double)n_nzero / matGram.trace();
+
+    vecSourceCov *= scaling_source_cov;
+    gain *= sqrt(scaling_source_cov);
+    matGram *= scaling_source_cov;
+
+    //
+    // 12. Decompose the combined matrix. The left singular vectors and the squared singular values are the
+    // eigenvectors and eigenvalues of G*G', the right singular vectors follow from V = G'*U*S^-1.
+    //
+    SelfAdjointEigenSolver<MatrixXd> eig(matGram);
+    const qint32 nchan = matGram.rows();
+
+    VectorXd p_sing(nchan);
+    MatrixXd t_U(nchan, nchan);
+    for(qint32 i = 0; i < nchan; ++i) {
+        p_sing(i) = sqrt(std::max(eig.eigenvalues()(nchan - 1 - i), 0.0));
+        t_U.col(i) = eig.eigenvectors().col(nchan - 1 - i);
+    }
+
+    // Singular values of the projected out components are only known up to sqrt(eps), treat them as zero
+    MatrixXd t_V = gain.transpose() * t_U;
+    const double dSingTol = nchan > 0 ? 1e-6 * p_sing(0) : 0.0;
+    for(qint32 i = 0; i < nchan; ++i) {
+        if(p_sing(i) > dSingTol) {
+            t_V.col(i) /= p_sing(i);
+        } else {
+            p_sing(i) = 0.0;
+            t_V.col(i).setZero();
+        }
+    }
+
+    //
+    // Put it all together
+    //
+    MNEInverseOperator p_MNEInverseOperator(*this);
+    p_MNEInverseOperator.m_pKernelCache = QSharedPointer<MNEInverseKernelCache>(new MNEInverseKernelCache);
+
+    p_MNEInverseOperator.eigen_fields = FiffNamedMatrix::SDPtr(new FiffNamedMatrix(nchan,
+                                                                                   nchan,
+                                                                                   defaultQStringList,
+                                                                                   gain_info.ch_names,
+                                                                                   t_U.transpose()));
+    p_MNEInverseOperator.eigen_leads = FiffNamedMatrix::SDPtr(new FiffNamedMatrix(t_V.rows(),
+                                                                                  t_V.cols(),
+                                                                                  defaultQStringList,
+                                                                                  defaultQStringList,
+                                                                                  t_V));
+    p_MNEInverseOperator.sing = p_sing;
+    p_MNEInverseOperator.nave = 1;
+    p_MNEInverseOperator.source_cov->data = vecSourceCov;
+    p_MNEInverseOperator.noise_cov = FiffCov::SDPtr(new FiffCov(p_outNoiseCov));
+    p_MNEInverseOperator.projs = p_info.projs;
+    p_MNEInverseOperator.eigen_leads_weighted = false;
+    p_MNEInverseOperator.info.bads = p_info.bads;
+
+    return p_MNEInverseOperator;
+}
+
+//=============================================================================================================
+
 MNEInverseOperator MNEInverseOperator::prepare_inverse_operator(qint32 nave ,float lambda2, bool dSPM, bool sLORETA) const
 {
     if(nave <= 0)
@@ -931,6 +1474,10 @@ MNEInverseOperator MNEInverseOperator::prepare_inverse_operator(qint32 nave ,flo
     printf("Preparing the inverse operator for use...\n");
     MNEInverseOperator inv(*this);
     //
+    //   The prepared operator gets its own kernel cache
+    //
+    inv.m_pKernelCache = QSharedPointer<MNEInverseKernelCache>(new MNEInverseKernelCache);
+    //
     //   Scale some of the stuff
     //
     float scale     = ((float)inv.nave)/((float)nave);
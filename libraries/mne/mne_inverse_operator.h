@@ -82,6 +82,12 @@ namespace FSLIB
 namespace MNELIB
 {
 
+//=============================================================================================================
+// MNELIB FORWARD DECLARATIONS
+//=============================================================================================================
+
+struct MNEInverseKernelCache;
+
 //=========================================================================================================
 /**
  * Gain matrix output data for one region, used for clustering
@@ -122,7 +128,10 @@ struct RegionMT
         // Kmeans Reduction
         RegionMTOut p_RegionMTOut;
 
-        UTILSLIB::KMeans t_kMeans(t_sDistMeasure, QString("sample"), 5);
+        // k-means++ seeding with a fixed seed per label makes the clustering reproducible
+        UTILSLIB::KMeans t_kMeans(t_sDistMeasure, QString("plus"), 5);
+        t_kMeans.setSeed(this->iLabelIdxIn);
+        t_kMeans.setParallelReplicates(true);
 
         t_kMeans.calculate(this->matRoiMT, this->nClusters, p_RegionMTOut.roiIdx, p_RegionMTOut.ctrs, p_RegionMTOut.sumd, p_RegionMTOut.D);
 
@@ -186,6 +195,16 @@ public:
      */
     MNEInverseOperator(const MNEInverseOperator &p_MNEInverseOperator);
 
+    //=========================================================================================================
+    /**
+     * Assignment operator.
+     *
+     * @param[in] p_MNEInverseOperator   The inverse operator to assign.
+     *
+     * @return this inverse operator.
+     */
+    MNEInverseOperator& operator=(const MNEInverseOperator &p_MNEInverseOperator);
+
     //=========================================================================================================
     /**
      * Destroys the MNEInverseOperator.
@@ -216,6 +235,90 @@ public:
                          Eigen::SparseMatrix<double> &noise_norm,
                          QList<Eigen::VectorXi> &vertno);
 
+    //=========================================================================================================
+    /**
+     * Prepares the inverse operator (see prepare_inverse_operator) and assembles the imaging kernel of the whole
+     * source space (see assemble_kernel). The kernels are cached per (nave, lambda2, dSPM, sLORETA, pick_normal),
+     * so repeated calls with the same parameters are lookups. Copies of this operator start with an empty cache,
+     * they only take over the cache size and the sidecar file. The cache has to be cleared with clearKernelCache
+     * if the members of this operator are changed after a kernel was prepared. Newly assembled kernels are
+     * written to the sidecar file by writeKernelCacheFile, which is called when the operator is destroyed.
+     *
+     * @param[in] nave           Number of averages (scales the noise covariance).
+     * @param[in] lambda2        The regularization factor.
+     * @param[in] dSPM           Compute the noise-normalization factors for dSPM?
+     * @param[in] sLORETA        Compute the noise-normalization factors for sLORETA?
+     * @param[in] pick_normal    Pick normals.
+     * @param[out] K             Kernel.
+     * @param[out] noise_norm    Noise normals.
+     * @param[out] vertno        Vertices of the hemispheres.
+     *
+     * @return true when successful, false otherwise.
+     */
+    bool prepare_kernel(qint32 nave,
+                        float lambda2,
+                        bool dSPM,
+                        bool sLORETA,
+                        bool pick_normal,
+                        Eigen::MatrixXd &K,
+                        Eigen::SparseMatrix<double> &noise_norm,
+                        QList<Eigen::VectorXi> &vertno);
+
+    //=========================================================================================================
+    /**
+     * Sets a FIFF sidecar file for the kernel cache. Kernels which were stored in the file for this operator are
+     * loaded into the cache, and newly assembled kernels are added to the file by writeKernelCacheFile. Kernels
+     * which were stored for a different operator are discarded. An empty file name disables the sidecar. Kernels
+     * which were not written to a previously set sidecar file yet are written before the file is changed.
+     *
+     * @param[in] sFileName  The sidecar file name.
+     *
+     * @return the number of kernels loaded from the sidecar file.
+     */
+    int setKernelCacheFile(const QString &sFileName);
+
+    //=========================================================================================================
+    /**
+     * Sets the maximal number of kernels kept in the kernel cache. The least recently used kernels are removed
+     * first. Default is 8.
+     *
+     * @param[in] iSize  The maximal number of cached kernels.
+     */
+    void setKernelCacheSize(int iSize);
+
+    //=========================================================================================================
+    /**
+     * Writes the cached kernels to the sidecar file if kernels were assembled since the last write. This is done
+     * once when the operator is destroyed. Call it to share the kernels with other operators earlier.
+     *
+     * @return true when successful or if there was nothing to write, false otherwise.
+     */
+    bool writeKernelCacheFile();
+
+    //=========================================================================================================
+    /**
+     * Removes all kernels from the in-memory kernel cache and resets the hit statistics. Kernels which were not
+     * written yet are added to the sidecar file first. The kernels of the sidecar file are read again by the next
+     * prepare_kernel call, if they still belong to this operator.
+     */
+    void clearKernelCache();
+
+    //=========================================================================================================
+    /**
+     * Returns the number of prepare_kernel calls which were answered by the kernel cache.
+     *
+     * @return the number of cache hits.
+     */
+    int getKernelCacheHits() const;
+
+    //=========================================================================================================
+    /**
+     * Returns the number of prepare_kernel calls which had to assemble the kernel.
+     *
+     * @return the number of cache misses.
+     */
+    int getKernelCacheMisses() const;
+
     //=========================================================================================================
     /**
      * Check that channels in inverse operator are measurements.
@@ -288,6 +391,25 @@ public:
                                                     bool fixed = false,
                                                     bool limit_depth_chs = true);
 
+    //=========================================================================================================
+    /**
+     * Updates the inverse operator for a new noise covariance matrix. The depth and orientation priors only
+     * depend on the forward solution and are reused, only the whitening and the decomposition are recomputed.
+     * The decomposition is obtained from the eigenvalue decomposition of the (nchan x nchan) Gram matrix of the
+     * whitened and weighted gain, which avoids the SVD of the wide gain matrix. The result equals the one of
+     * make_inverse_operator with the same parameters up to numerical precision.
+     *
+     * @param[in] p_info         The measurement info to specify the channels to include. Bad channels in info['bads'] are not used.
+     * @param[in] forward        Forward operator which was used to assemble this inverse operator.
+     * @param[in] p_noise_cov    The new noise covariance matrix.
+     *
+     * @return the updated inverse operator, or an empty operator (nsource = -1) if the selected channels or
+     * sources differ from the ones of this operator. Then make_inverse_operator has to be used.
+     */
+    MNEInverseOperator update_noise_cov(const FIFFLIB::FiffInfo &p_info,
+                                        const MNEForwardSolution &forward,
+                                        const FIFFLIB::FiffCov& p_noise_cov) const;
+
     //=========================================================================================================
     /**
      * mne_prepare_inverse_operator
@@ -379,7 +501,44 @@ public:
     Eigen::SparseMatrix<double> noisenorm;          /**< These are the noise-normalization factors */
 
 private:
+    //=========================================================================================================
+    /**
+     * Computes a hash over the data which defines the kernels of this operator. It identifies the operator in
+     * the kernel cache sidecar file.
+     *
+     * @return the hex encoded hash.
+     */
+    QString kernelCacheKey() const;
+
+    //=========================================================================================================
+    /**
+     * Adds the kernels of the sidecar file which were stored for this operator to the kernel cache. The cache
+     * mutex has to be locked.
+     *
+     * @return the number of kernels read.
+     */
+    int readKernelCacheFile();
+
+    //=========================================================================================================
+    /**
+     * Holds the kernel cache of the operator. A copy gets its own, empty cache which only takes over the cache size
+     * and the sidecar file, so that copies of the operator never share kernels.
+     */
+    class KernelCacheHolder
+    {
+    public:
+        KernelCacheHolder();
+        KernelCacheHolder(const KernelCacheHolder &p_KernelCacheHolder);
+        KernelCacheHolder& operator=(const KernelCacheHolder &p_KernelCacheHolder);
+
+        MNEInverseKernelCache* operator->() const;
+
+    private:
+        QSharedPointer<MNEInverseKernelCache> m_pCache;     /**< The cache, never shared with another holder */
+    };
+
     Eigen::MatrixXd m_K;                            /**< Everytime a new kernel is assamebled a copy is stored here */
+    KernelCacheHolder m_pKernelCache;               /**< Cache of prepared kernels, owned by this operator */
 };
 
 //=============================================================================================================
@@ -50,6 +50,8 @@
 // QT INCLUDES
 //=============================================================================================================
 
+#include <QtConcurrent>
+
 //=============================================================================================================
 // EIGEN INCLUDES
 //=============================================================================================================
@@ -117,6 +119,8 @@ MNEProjectToSurface::MNEProjectToSurface(const MNEBemSurface &p_MNEBemSurf)
         }
     }
     det = (a.array()*b.array() - c.array()*c.array()).matrix();
+
+    build_bvh();
 }
 
 //=============================================================================================================
@@ -143,12 +147,55 @@ MNEProjectToSurface::MNEProjectToSurface(const MNESurface &p_MNESurf)
     }
 
     det = (a.array()*b.array() - c.array()*c.array()).matrix();
+
+    build_bvh();
 }
 
 //=============================================================================================================
 
 bool MNEProjectToSurface::mne_find_closest_on_surface(const MatrixXf &r, const int np, MatrixXf &rTri,
-                                                      VectorXi &nearest, VectorXf &dist)
+                                                      VectorXi &nearest, VectorXf &dist) const
+{
+    // resize output
+    nearest.resize(np);
+    dist.resize(np);
+    rTri.resize(np,3);
+
+    if (this->r1.isZero(0))
+    {
+        qDebug() << "No surface loaded to make the projection./n";
+        return false;
+    }
+
+    QVector<int> vecPoints(np);
+    for (int k = 0; k < np; ++k)
+    {
+        vecPoints[k] = k;
+    }
+
+    QAtomicInt iFailed(0);
+    QtConcurrent::blockingMap(vecPoints, [&](const int k) {
+        int bestTri = -1;
+        float bestDist = -1;
+        Vector3f rTriK;
+        if (!this->mne_project_to_surface(r.row(k).transpose(), rTriK, bestTri, bestDist))
+        {
+            qDebug() << "The projection of point number " << k << " didn't work./n";
+            iFailed.fetchAndAddOrdered(1);
+            return;
+        }
+        rTri.row(k) = rTriK.transpose();
+        nearest[k] = bestTri;
+        dist[k] = bestDist;
+    });
+
+    return iFailed.loadAcquire() == 0;
+}
+
+//=============================================================================================================
+
+bool MNEProjectToSurface::mne_find_closest_on_surface_exhaustive(const MatrixXf &r, const int np, MatrixXf &rTri,
+                                                                 VectorXi &nearest, VectorXf &dist) const
 {
     // resize output
     nearest.resize(np);
@@ -165,11 +212,7 @@ bool MNEProjectToSurface::mne_find_closest_on_surface(const MatrixXf &r, const i
     Vector3f rTriK;
     for (int k = 0; k < np; ++k)
     {
-        /*
-         * To do: decide_search_restriction for the use in an iterative closest point to plane algorithm
-         * For now it's OK to go through all triangles.
-         */
-        if (!this->mne_project_to_surface(r.row(k).transpose(), rTriK, bestTri, bestDist))
+        if (!this->mne_project_to_surface_exhaustive(r.row(k).transpose(), rTriK, bestTri, bestDist))
         {
             qDebug() << "The projection of point number " << k << " didn't work./n";
             return false;
@@ -183,7 +226,40 @@ bool MNEProjectToSurface::mne_find_closest_on_surface(const MatrixXf &r, const i
 
 //=============================================================================================================
 
-bool MNEProjectToSurface::mne_project_to_surface(const Vector3f &r, Vector3f &rTri, int &bestTri, float &bestDist)
+bool MNEProjectToSurface::mne_project_to_surface(const Vector3f &r, Vector3f &rTri, int &bestTri, float &bestDist) const
+{
+    if (!this->bvh)
+    {
+        return this->mne_project_to_surface_exhaustive(r, rTri, bestTri, bestDist);
+    }
+
+    float p = 0, q = 0;
+    auto evaluate = [this, &r, &p, &q](int tri, float &dist) {
+        return this->nearest_triangle_point(r, tri, p, q, dist);
+    };
+
+    bestTri = this->bvh->findClosest(r, evaluate, bestDist);
+
+    if (bestTri >= 0)
+    {
+        // Recompute the triangle coordinates of the winner, the last evaluation may belong to another triangle
+        float dist0 = 0;
+        this->nearest_triangle_point(r, bestTri, p, q, dist0);
+        if (!this->project_to_triangle(rTri, p, q, bestTri))
+        {
+            qDebug() << "The coordinate transform to cartesian system didn't work./n";
+            return false;
+        }
+        return true;
+    }
+
+    qDebug() << "No best Triangle found./n";
+    return false;
+}
+
+//=============================================================================================================
+
+bool MNEProjectToSurface::mne_project_to_surface_exhaustive(const Vector3f &r, Vector3f &rTri, int &bestTri, float &bestDist) const
 {
     float p = 0, q = 0, p0 = 0, q0 = 0, dist0 = 0;
     bestDist = 0.0f;
@@ -221,7 +297,7 @@ bool MNEProjectToSurface::mne_project_to_surface(const Vector3f &r, Vector3f &rT
 
 //=============================================================================================================
 
-bool MNEProjectToSurface::nearest_triangle_point(const Vector3f &r, const int tri, float &p, float &q, float &dist)
+bool MNEProjectToSurface::nearest_triangle_point(const Vector3f &r, const int tri, float &p, float &q, float &dist) const
 {
     //Calculate some helpers
     Vector3f rr = r - this->r1.row(tri).transpose(); //Vector from triangle corner #1 to r
@@ -329,8 +405,29 @@ bool MNEProjectToSurface::nearest_triangle_point(const Vector3f &r, const int tr
 
 //=============================================================================================================
 
-bool MNEProjectToSurface::project_to_triangle(Vector3f &rTri, const float p, const float q, const int tri)
+bool MNEProjectToSurface::project_to_triangle(Vector3f &rTri, const float p, const float q, const int tri) const
 {
     rTri = this->r1.row(tri) + p*this->r12.row(tri) + q*this->r13.row(tri);
     return true;
 }
+
+//=============================================================================================================
+
+void MNEProjectToSurface::build_bvh()
+{
+    // The distances are scaled with the normal length. With unnormalized normals, e.g. those of a MNESurface,
+    // hardly any node can be skipped and the exhaustive search is faster.
+    VectorXf nnLength = nn.rowwise().norm();
+    if ((nnLength.array() >= 0.5f).count() < nnLength.size() / 2)
+    {
+        return;
+    }
+
+    MatrixX3f r2 = r1 + r12;
+    MatrixX3f r3 = r1 + r13;
+
+    // Inside the triangle the distance is scaled with the normal length, on the sides at most with min(1, length)
+    VectorXf vecScale = nnLength.cwiseMin(1.0f);
+
+    this->bvh = MNETriangleBVH::SPtr(new MNETriangleBVH(r1, r2, r3, vecScale));
+}
@@ -41,6 +41,7 @@
 //=============================================================================================================
 
 #include "mne_global.h"
+#include "mne_triangle_bvh.h"
 
 //=============================================================================================================
 // QT INCLUDES
@@ -111,7 +112,9 @@ public:
 
     //=========================================================================================================
     /**
-     * Projects a set of points r on the Surface
+     * Projects a set of points r on the Surface. The closest triangles are looked up in a bounding volume
+     * hierarchy and the points are processed in parallel. The results are identical to
+     * mne_find_closest_on_surface_exhaustive.
      *
      * @brief mne_find_closest_on_surface
      *
@@ -124,14 +127,31 @@ public:
      * @return true if succeeded, false otherwise
      */
     bool mne_find_closest_on_surface(const Eigen::MatrixXf &r, const int np, Eigen::MatrixXf &rTri,
-                                     Eigen::VectorXi &nearest, Eigen::VectorXf &dist);
+                                     Eigen::VectorXi &nearest, Eigen::VectorXf &dist) const;
+
+    //=========================================================================================================
+    /**
+     * Projects a set of points r on the Surface by going through all triangles for each point.
+     *
+     * @brief mne_find_closest_on_surface_exhaustive
+     *
+     * @param[in] r         Set of pionts, which are to be projectied.
+     * @param[in] np        number of points
+     * @param[out] rTri     set of points on the surface
+     * @param[out] nearest  Triangle of the new point
+     * @param[out] dist     Distance between r and rTri
+     *
+     * @return true if succeeded, false otherwise
+     */
+    bool mne_find_closest_on_surface_exhaustive(const Eigen::MatrixXf &r, const int np, Eigen::MatrixXf &rTri,
+                                                Eigen::VectorXi &nearest, Eigen::VectorXf &dist) const;
 
 protected:
 
 private:
     //=========================================================================================================
     /**
-     * Projects a point r on the Surface
+     * Projects a point r on the Surface using the bounding volume hierarchy
      *
      * @brief mne_project_to_surface
      *
@@ -142,7 +162,30 @@ private:
      *
      * @return true if succeeded, false otherwise
      */
-    bool mne_project_to_surface(const Eigen::Vector3f &r, Eigen::Vector3f &rTri, int &bestTri, float &bestDist);
+    bool mne_project_to_surface(const Eigen::Vector3f &r, Eigen::Vector3f &rTri, int &bestTri, float &bestDist) const;
+
+    //=========================================================================================================
+    /**
+     * Projects a point r on the Surface by going through all triangles
+     *
+     * @brief mne_project_to_surface_exhaustive
+     *
+     * @param[in] r         Piont, which is to be projectied.
+     * @param[out] rTri     Point on the surface
+     * @param[out] bestTri  Triangle of the new point
+     * @param[out] bestDist Distance between r and rTri.
+     *
+     * @return true if succeeded, false otherwise
+     */
+    bool mne_project_to_surface_exhaustive(const Eigen::Vector3f &r, Eigen::Vector3f &rTri, int &bestTri, float &bestDist) const;
+
+    //=========================================================================================================
+    /**
+     * Builds the bounding volume hierarchy over the triangles, unless the normals are unnormalized.
+     *
+     * @brief build_bvh
+     */
+    void build_bvh();
 
     //=========================================================================================================
     /**
@@ -158,7 +201,7 @@ private:
      *
      * @return true if succeeded, false otherwise
      */
-    bool nearest_triangle_point(const Eigen::Vector3f &r, const int tri, float &p, float &q, float &dist);
+    bool nearest_triangle_point(const Eigen::Vector3f &r, const int tri, float &p, float &q, float &dist) const;
 
     //=========================================================================================================
     /**
@@ -173,7 +216,7 @@ private:
      *
      * @return true if succeeded, false otherwise
      */
-    bool project_to_triangle(Eigen::Vector3f &rTri, const float p, const float q, const int tri);
+    bool project_to_triangle(Eigen::Vector3f &rTri, const float p, const float q, const int tri) const;
 
     Eigen::MatrixX3f r1;         /**< Cartesian Vector to the first triangel corner */
     Eigen::MatrixX3f r12;        /**< Cartesian Vector from the first to the second triangel corner */
@@ -183,6 +226,7 @@ private:
     Eigen::VectorXf b;           /**< r13*r13 */
     Eigen::VectorXf c;           /**< r12*r13 */
     Eigen::VectorXf det;         /**< Determinant of the Matrix [a c, c b] */
+    MNETriangleBVH::SPtr bvh;    /**< Bounding volume hierarchy over the triangles */
 };
 
 //=============================================================================================================
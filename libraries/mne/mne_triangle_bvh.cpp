@@ -0,0 +1,146 @@
+//=============================================================================================================
+/**
+ * @file     mne_triangle_bvh.cpp
+ * @author   MNE-CPP authors
+ * @since    0.1.8
+ * @date     October, 2026
+ *
+ * @section  LICENSE
+ *
+ * Copyright (C) 2026, MNE-CPP authors. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ * the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+ *       following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ *       the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+ *       to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * @brief     MNETriangleBVH class definition.
+ *
+ */
+
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "mne_triangle_bvh.h"
+
+//=============================================================================================================
+// STD INCLUDES
+//=============================================================================================================
+
+#include <algorithm>
+
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace MNELIB;
+using namespace Eigen;
+
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+MNETriangleBVH::MNETriangleBVH(const MatrixX3f& matR1,
+                               const MatrixX3f& matR2,
+                               const MatrixX3f& matR3,
+                               const VectorXf& vecScale)
+{
+    int ntri = matR1.rows();
+    if(ntri == 0) {
+        return;
+    }
+
+    MatrixX3f matMin = matR1.cwiseMin(matR2).cwiseMin(matR3);
+    MatrixX3f matMax = matR1.cwiseMax(matR2).cwiseMax(matR3);
+    MatrixX3f matCentroids = (matR1 + matR2 + matR3) / 3.0f;
+
+    m_vecTriIndex.resize(ntri);
+    for(int i = 0; i < ntri; ++i) {
+        m_vecTriIndex[i] = i;
+    }
+
+    m_vecNodes.reserve(2 * (ntri / m_iLeafSize + 1));
+    buildNode(0, ntri, matCentroids, matMin, matMax, vecScale);
+}
+
+//=============================================================================================================
+
+int MNETriangleBVH::buildNode(int iFirst,
+                              int iLast,
+                              const MatrixX3f& matCentroids,
+                              const MatrixX3f& matMin,
+                              const MatrixX3f& matMax,
+                              const VectorXf& vecScale)
+{
+    int iNode = m_vecNodes.size();
+    m_vecNodes.append(Node());
+
+    Vector3f vecMin = matMin.row(m_vecTriIndex[iFirst]).transpose();
+    Vector3f vecMax = matMax.row(m_vecTriIndex[iFirst]).transpose();
+    Vector3f vecCMin = matCentroids.row(m_vecTriIndex[iFirst]).transpose();
+    Vector3f vecCMax = vecCMin;
+    float scale = std::fabs(vecScale[m_vecTriIndex[iFirst]]);
+    float maxScale = 1.0f;
+
+    for(int i = iFirst; i < iLast; ++i) {
+        int tri = m_vecTriIndex[i];
+        vecMin = vecMin.cwiseMin(matMin.row(tri).transpose());
+        vecMax = vecMax.cwiseMax(matMax.row(tri).transpose());
+        vecCMin = vecCMin.cwiseMin(matCentroids.row(tri).transpose());
+        vecCMax = vecCMax.cwiseMax(matCentroids.row(tri).transpose());
+        scale = std::min(scale, std::fabs(vecScale[tri]));
+        maxScale = std::max(maxScale, std::fabs(vecScale[tri]));
+    }
+
+    Node node;
+    for(int k = 0; k < 3; ++k) {
+        node.min[k] = vecMin[k];
+        node.max[k] = vecMax[k];
+    }
+    node.scale = scale;
+    // The distances are evaluated in single precision, allow for their round off error
+    node.slack = 1e-4f * maxScale;
+    node.right = -1;
+    node.first = iFirst;
+    node.count = iLast - iFirst;
+
+    if(iLast - iFirst > m_iLeafSize) {
+        // Split at the median centroid along the longest axis
+        int iAxis;
+        (vecCMax - vecCMin).maxCoeff(&iAxis);
+        int iMid = (iFirst + iLast) / 2;
+
+        std::nth_element(m_vecTriIndex.begin() + iFirst,
+                         m_vecTriIndex.begin() + iMid,
+                         m_vecTriIndex.begin() + iLast,
+                         [&matCentroids, iAxis](int i, int j) {
+                             float ci = matCentroids(i, iAxis);
+                             float cj = matCentroids(j, iAxis);
+                             return ci < cj || (ci == cj && i < j);
+                         });
+
+        buildNode(iFirst, iMid, matCentroids, matMin, matMax, vecScale);
+        node.right = buildNode(iMid, iLast, matCentroids, matMin, matMax, vecScale);
+        node.first = -1;
+        node.count = 0;
+    }
+
+    m_vecNodes[iNode] = node;
+
+    return iNode;
+}
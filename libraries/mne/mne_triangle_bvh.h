@@ -0,0 +1,275 @@
+//=============================================================================================================
+/**
+ * @file     mne_triangle_bvh.h
+ * @author   MNE-CPP authors
+ * @since    0.1.8
+ * @date     October, 2026
+ *
+ * @section  LICENSE
+ *
+ * Copyright (C) 2026, MNE-CPP authors. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ * the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+ *       following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ *       the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+ *       to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * @brief     MNETriangleBVH class declaration.
+ *
+ */
+
+#ifndef MNELIB_MNETRIANGLEBVH_H
+#define MNELIB_MNETRIANGLEBVH_H
+
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "mne_global.h"
+
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QSharedPointer>
+#include <QVector>
+
+//=============================================================================================================
+// EIGEN INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+//=============================================================================================================
+// STD INCLUDES
+//=============================================================================================================
+
+#include <algorithm>
+#include <cmath>
+
+//=============================================================================================================
+// DEFINE NAMESPACE MNELIB
+//=============================================================================================================
+
+namespace MNELIB {
+
+//=============================================================================================================
+/**
+ * Bounding volume hierarchy over the triangles of a surface. The hierarchy is built once per surface and used to
+ * answer closest triangle queries without visiting every triangle. The distance itself is evaluated by the caller,
+ * which keeps the results identical to an exhaustive search: a node is only skipped if none of its triangles can
+ * beat the best distance found so far and ties are resolved towards the lower triangle index.
+ *
+ * @brief Bounding volume hierarchy for closest triangle queries.
+ */
+class MNESHARED_EXPORT MNETriangleBVH
+{
+
+public:
+    typedef QSharedPointer<MNETriangleBVH> SPtr;            /**< Shared pointer type for MNETriangleBVH. */
+    typedef QSharedPointer<const MNETriangleBVH> ConstSPtr; /**< Const shared pointer type for MNETriangleBVH. */
+
+    //=========================================================================================================
+    /**
+     * Builds the hierarchy.
+     *
+     * @param[in] matR1             The first corner of each triangle.
+     * @param[in] matR2             The second corner of each triangle.
+     * @param[in] matR3             The third corner of each triangle.
+     * @param[in] vecScale          For each triangle, a lower bound of the ratio between the evaluated distance and
+     *                              the Euclidean distance to the triangle.
+     */
+    MNETriangleBVH(const Eigen::MatrixX3f& matR1,
+                   const Eigen::MatrixX3f& matR2,
+                   const Eigen::MatrixX3f& matR3,
+                   const Eigen::VectorXf& vecScale);
+
+    //=========================================================================================================
+    /**
+     * Returns the number of triangles in the hierarchy.
+     *
+     * @return The number of triangles.
+     */
+    inline int ntri() const;
+
+    //=========================================================================================================
+    /**
+     * Finds the triangle closest to r. The distance of a triangle is computed by evaluate(tri, dist), which returns
+     * false on failure. The distance may be signed, triangles are compared by its absolute value. The distance
+     * must not be smaller than the Euclidean distance to the triangle scaled with the factor given at construction.
+     *
+     * @param[in] r             The point in space.
+     * @param[in] evaluate      The distance evaluation.
+     * @param[out] bestDist     The distance to the closest triangle.
+     *
+     * @return The index of the closest triangle, -1 if the hierarchy is empty or an evaluation failed.
+     */
+    template<typename T>
+    int findClosest(const Eigen::Vector3f& r,
+                    T& evaluate,
+                    float& bestDist) const;
+
+private:
+    //=========================================================================================================
+    /**
+     * Recursively builds the node covering the triangles m_vecTriIndex[iFirst] ... m_vecTriIndex[iLast-1].
+     *
+     * @param[in] iFirst            The first triangle of the node.
+     * @param[in] iLast             One past the last triangle of the node.
+     * @param[in] matCentroids      The triangle centroids.
+     * @param[in] matMin            The lower triangle bounds.
+     * @param[in] matMax            The upper triangle bounds.
+     * @param[in] vecScale          The distance scale of each triangle.
+     *
+     * @return The node index.
+     */
+    int buildNode(int iFirst,
+                  int iLast,
+                  const Eigen::MatrixX3f& matCentroids,
+                  const Eigen::MatrixX3f& matMin,
+                  const Eigen::MatrixX3f& matMax,
+                  const Eigen::VectorXf& vecScale);
+
+    //=========================================================================================================
+    /**
+     * Lower bound of the distance of any triangle in a node to r.
+     *
+     * @param[in] iNode     The node index.
+     * @param[in] r         The point in space.
+     *
+     * @return The lower bound.
+     */
+    inline float lowerBound(int iNode,
+                            const Eigen::Vector3f& r) const;
+
+    struct Node {
+        float   min[3];         /**< Lower corner of the bounding box. */
+        float   max[3];         /**< Upper corner of the bounding box. */
+        float   scale;          /**< Smallest distance scale of the triangles in the node. */
+        float   slack;          /**< Relative allowance for round off in the distance evaluation. */
+        int     right;          /**< Index of the second child, the first child follows the node. -1 for leaves. */
+        int     first;          /**< First entry in m_vecTriIndex for leaves. */
+        int     count;          /**< Number of triangles for leaves. */
+    };
+
+    QVector<Node>   m_vecNodes;         /**< The nodes, the root is at index 0. */
+    QVector<int>    m_vecTriIndex;      /**< The triangle indices ordered by leaf. */
+
+    static const int m_iLeafSize = 4;   /**< Maximum number of triangles per leaf. */
+    static const int m_iMaxDepth = 64;  /**< Size of the traversal stack. */
+};
+
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+inline int MNETriangleBVH::ntri() const
+{
+    return m_vecTriIndex.size();
+}
+
+//=============================================================================================================
+
+inline float MNETriangleBVH::lowerBound(int iNode,
+                                        const Eigen::Vector3f& r) const
+{
+    const Node& node = m_vecNodes[iNode];
+
+    float dSq = 0.0f;
+    float diagSq = 0.0f;
+    for(int k = 0; k < 3; ++k) {
+        float d = 0.0f;
+        if(r[k] < node.min[k]) {
+            d = node.min[k] - r[k];
+        } else if(r[k] > node.max[k]) {
+            d = r[k] - node.max[k];
+        }
+        dSq += d*d;
+        diagSq += (node.max[k] - node.min[k])*(node.max[k] - node.min[k]);
+    }
+
+    float boxDist = std::sqrt(dSq);
+    return node.scale*boxDist - node.slack*(boxDist + std::sqrt(diagSq));
+}
+
+//=============================================================================================================
+
+template<typename T>
+int MNETriangleBVH::findClosest(const Eigen::Vector3f& r,
+                                T& evaluate,
+                                float& bestDist) const
+{
+    bestDist = 0.0f;
+    if(m_vecTriIndex.isEmpty()) {
+        return -1;
+    }
+
+    // Like the exhaustive search, start with the first triangle and only accept strictly smaller distances
+    int bestTri = 0;
+    if(!evaluate(0, bestDist)) {
+        return -1;
+    }
+    float bestAbs = std::fabs(bestDist);
+    if(bestAbs != bestAbs) {
+        return bestTri;
+    }
+
+    int stack[m_iMaxDepth];
+    int iTop = 0;
+    stack[iTop++] = 0;
+
+    float dist;
+    while(iTop > 0) {
+        int iNode = stack[--iTop];
+        if(lowerBound(iNode, r) > bestAbs) {
+            continue;
+        }
+
+        const Node& node = m_vecNodes[iNode];
+        if(node.right < 0) {
+            for(int i = node.first; i < node.first + node.count; ++i) {
+                int tri = m_vecTriIndex[i];
+                if(tri == 0) {
+                    continue;
+                }
+                if(!evaluate(tri, dist)) {
+                    return -1;
+                }
+                float distAbs = std::fabs(dist);
+                if(distAbs < bestAbs || (distAbs == bestAbs && tri < bestTri)) {
+                    bestAbs = distAbs;
+                    bestDist = dist;
+                    bestTri = tri;
+                }
+            }
+        } else {
+            // Visit the closer child first
+            int iLeft = iNode + 1;
+            int iRight = node.right;
+            if(lowerBound(iLeft, r) > lowerBound(iRight, r)) {
+                std::swap(iLeft, iRight);
+            }
+            stack[iTop++] = iRight;
+            stack[iTop++] = iLeft;
+        }
+    }
+
+    return bestTri;
+}
+} // namespace MNELIB
+
+#endif // MNELIB_MNETRIANGLEBVH_H
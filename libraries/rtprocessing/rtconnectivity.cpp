@@ -59,6 +59,7 @@
 
 using namespace RTPROCESSINGLIB;
 using namespace CONNECTIVITYLIB;
+using namespace Eigen;
 
 //=============================================================================================================
 // DEFINE MEMBER METHODS RtConnectivityWorker
@@ -98,6 +99,79 @@ void RtConnectivityWorker::doWork(const ConnectivitySettings &connectivitySettin
     emit resultReady(finalNetworks, connectivitySettingsTemp);
 }
 
+//=============================================================================================================
+
+void RtConnectivityWorker::doIncrementalWork(const ConnectivitySettings& connectivitySettings,
+                                             int iWindowSize)
+{
+    if(this->thread()->isInterruptionRequested()) {
+        return;
+    }
+
+    if(connectivitySettings.getConnectivityMethods().isEmpty()) {
+        qDebug()<<"RtConnectivityWorker::doIncrementalWork() - Network methods are empty";
+        return;
+    }
+
+    if(!m_pConnectivitySettingsWindow || !isWindowCompatible(connectivitySettings)) {
+        m_pConnectivitySettingsWindow = QSharedPointer<ConnectivitySettings>(new ConnectivitySettings(connectivitySettings));
+        m_pConnectivitySettingsWindow->clearAllData();
+
+        // The per trial data is needed to subtract the trials once they leave the window
+        m_pConnectivitySettingsWindow->setStorageModeActive(true);
+    } else if(m_pConnectivitySettingsWindow->getConnectivityMethods() != connectivitySettings.getConnectivityMethods() ||
+              m_pConnectivitySettingsWindow->getWindowType() != connectivitySettings.getWindowType()) {
+        // The trials can be kept but their spectra need to be recomputed once
+        m_pConnectivitySettingsWindow->clearIntermediateData();
+        m_pConnectivitySettingsWindow->setConnectivityMethods(connectivitySettings.getConnectivityMethods());
+        m_pConnectivitySettingsWindow->setWindowType(connectivitySettings.getWindowType());
+    }
+
+    m_pConnectivitySettingsWindow->setNodePositions(connectivitySettings.getNodePositions());
+
+    // Only take over the raw data, so that every new trial is added to the running sums
+    for(int i = 0; i < connectivitySettings.size(); ++i) {
+        m_pConnectivitySettingsWindow->append(connectivitySettings.at(i).matData);
+    }
+
+    if(m_pConnectivitySettingsWindow->size() > iWindowSize) {
+        m_pConnectivitySettingsWindow->removeFirst(m_pConnectivitySettingsWindow->size() - iWindowSize);
+    }
+
+    if(m_pConnectivitySettingsWindow->isEmpty()) {
+        return;
+    }
+
+    QList<Network> finalNetworks = Connectivity::calculate(*m_pConnectivitySettingsWindow);
+
+    // Do not hand out the trials. Otherwise the window would be detached and copied on the next update.
+    ConnectivitySettings connectivitySettingsResult = *m_pConnectivitySettingsWindow;
+    connectivitySettingsResult.clearAllData();
+
+    emit resultReady(finalNetworks, connectivitySettingsResult);
+}
+
+//=============================================================================================================
+
+bool RtConnectivityWorker::isWindowCompatible(const ConnectivitySettings& connectivitySettings) const
+{
+    if(m_pConnectivitySettingsWindow->getSamplingFrequency() != connectivitySettings.getSamplingFrequency() ||
+       m_pConnectivitySettingsWindow->getFFTSize() != connectivitySettings.getFFTSize()) {
+        return false;
+    }
+
+    if(!m_pConnectivitySettingsWindow->isEmpty() && !connectivitySettings.isEmpty()) {
+        const MatrixXd& matWindowData = m_pConnectivitySettingsWindow->at(0).matData;
+        const MatrixXd& matNewData = connectivitySettings.at(0).matData;
+
+        if(matWindowData.rows() != matNewData.rows() || matWindowData.cols() != matNewData.cols()) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
 //=============================================================================================================
 // DEFINE MEMBER METHODS RtConnectivity
 //=============================================================================================================
@@ -114,6 +188,9 @@ RtConnectivity::RtConnectivity(QObject *parent)
     connect(this, &RtConnectivity::operate,
             worker, &RtConnectivityWorker::doWork);
 
+    connect(this, &RtConnectivity::operateIncremental,
+            worker, &RtConnectivityWorker::doIncrementalWork);
+
     connect(worker, &RtConnectivityWorker::resultReady,
             this, &RtConnectivity::newConnectivityResultAvailable);
 
@@ -136,6 +213,14 @@ void RtConnectivity::append(const ConnectivitySettings& connectivitySettings)
 
 //=============================================================================================================
 
+void RtConnectivity::appendIncremental(const ConnectivitySettings& connectivitySettings,
+                                       int iWindowSize)
+{
+    emit operateIncremental(connectivitySettings, iWindowSize);
+}
+
+//=============================================================================================================
+
 void RtConnectivity::restart()
 {
     stop();
@@ -149,6 +234,9 @@ void RtConnectivity::restart()
     connect(this, &RtConnectivity::operate,
             worker, &RtConnectivityWorker::doWork);
 
+    connect(this, &RtConnectivity::operateIncremental,
+            worker, &RtConnectivityWorker::doIncrementalWork);
+
     connect(worker, &RtConnectivityWorker::resultReady,
             this, &RtConnectivity::newConnectivityResultAvailable);
 
@@ -51,6 +51,7 @@
 
 #include <QObject>
 #include <QThread>
+#include <QSharedPointer>
 
 //=============================================================================================================
 // FORWARD DECLARATIONS
@@ -95,6 +96,32 @@ public:
      */
     void doWork(const CONNECTIVITYLIB::ConnectivitySettings& connectivitySettings);
 
+    //=========================================================================================================
+    /**
+     * Perform incremental connectivity estimation over a sliding window of trials. The worker keeps the window and
+     * the running sums of the spectral data. Only the newly arrived trials are transformed and added to the sums,
+     * the trials leaving the window are subtracted again. The cost per update does not depend on the window length.
+     * The window is restarted whenever the sampling frequency, the FFT size or the trial dimensions change.
+     *
+     * @param[in] connectivitySettings           The connectivity settings holding the newly arrived trials only.
+     * @param[in] iWindowSize                    The number of most recent trials to estimate the connectivity from.
+     */
+    void doIncrementalWork(const CONNECTIVITYLIB::ConnectivitySettings& connectivitySettings,
+                           int iWindowSize);
+
+protected:
+    //=========================================================================================================
+    /**
+     * Checks whether the trials of the current window can be kept for the new connectivity settings.
+     *
+     * @param[in] connectivitySettings           The new connectivity settings.
+     *
+     * @return Whether the trials of the current window can be kept.
+     */
+    bool isWindowCompatible(const CONNECTIVITYLIB::ConnectivitySettings& connectivitySettings) const;
+
+    QSharedPointer<CONNECTIVITYLIB::ConnectivitySettings>  m_pConnectivitySettingsWindow;     /**< The sliding window of trials including their running sums. */
+
 signals:
     void resultReady(const  QList<CONNECTIVITYLIB::Network>& connectivityResults, const CONNECTIVITYLIB::ConnectivitySettings& connectivitySettings);
 };
@@ -135,6 +162,16 @@ public:
      */
     void append(const CONNECTIVITYLIB::ConnectivitySettings& connectivitySettings);
 
+    //=========================================================================================================
+    /**
+     * Slot to receive newly arrived trials for the incremental estimation over a sliding window.
+     *
+     * @param[in] connectivitySettings   The connectivity settings holding the newly arrived trials only.
+     * @param[in] iWindowSize            The number of most recent trials to estimate the connectivity from.
+     */
+    void appendIncremental(const CONNECTIVITYLIB::ConnectivitySettings& connectivitySettings,
+                           int iWindowSize);
+
     //=========================================================================================================
     /**
      * Restarts the thread by interrupting its computation queue, quitting, waiting and then starting it again.
@@ -154,6 +191,8 @@ signals:
     void newConnectivityResultAvailable(const QList<CONNECTIVITYLIB::Network>& connectivityResults, const CONNECTIVITYLIB::ConnectivitySettings& connectivitySettings);
 
     void operate(const CONNECTIVITYLIB::ConnectivitySettings& connectivitySettings);
+    void operateIncremental(const CONNECTIVITYLIB::ConnectivitySettings& connectivitySettings,
+                            int iWindowSize);
 };
 
 //=============================================================================================================
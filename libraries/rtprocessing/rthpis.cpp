@@ -67,6 +67,7 @@ using namespace INVERSELIB;
 RtHpiWorker::RtHpiWorker(QSharedPointer<FIFFLIB::FiffInfo> pFiffInfo)
 {
     m_pHpiFit = QSharedPointer<INVERSELIB::HPIFit>(new HPIFit(pFiffInfo));
+    m_pHpiFit->setUseLevenbergMarquardt(true);
 }
 
 void RtHpiWorker::doWork(const Eigen::MatrixXd& matData,
@@ -92,6 +93,9 @@ void RtHpiWorker::doWork(const Eigen::MatrixXd& matData,
                       fitResult.fittedCoils,
                       pFiffInfo);
 
+    fitResult.vecNumIterations = m_pHpiFit->getLastNumIterations();
+    fitResult.fFitDuration = m_pHpiFit->getLastFitDuration();
+
     emit resultReady(fitResult);
 }
 
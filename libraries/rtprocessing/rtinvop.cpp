@@ -44,6 +44,12 @@
 #include <mne/mne_forwardsolution.h>
 #include <mne/mne_inverse_operator.h>
 
+//=============================================================================================================
+// STL INCLUDES
+//=============================================================================================================
+
+#include <limits>
+
 //=============================================================================================================
 // QT INCLUDES
 //=============================================================================================================
@@ -75,18 +81,63 @@ void RtInvOpWorker::doWork(const RtInvOpInput &inputData)
         return;
     }
 
-    // Restrict forward solution as necessary for MEG
-    MNEForwardSolution forwardMeg = inputData.pFwd->pick_types(true, false);
+    // Restrict forward solution as necessary for MEG. This only has to be done once per forward solution.
+    if(!m_pFwdMeg || m_pFwd != inputData.pFwd) {
+        m_pFwd = inputData.pFwd;
+        m_pFwdMeg = MNEForwardSolution::SPtr(new MNEForwardSolution(inputData.pFwd->pick_types(true, false)));
+        m_pInvOp.clear();
+    }
+
+    // Skip covariance estimations which barely differ from the one of the last inverse operator
+    if(m_pInvOp && inputData.dMinCovChange > 0.0 && relativeCovChange(inputData.noiseCov) < inputData.dMinCovChange) {
+        return;
+    }
+
+    // Only the noise covariance changed: reuse the priors of the last inverse operator
+    if(m_pInvOp) {
+        MNEInverseOperator invOpMeg = m_pInvOp->update_noise_cov(*inputData.pFiffInfo.data(),
+                                                                 *m_pFwdMeg,
+                                                                 inputData.noiseCov);
+
+        if(invOpMeg.nsource > 0) {
+            *m_pInvOp = invOpMeg;
+            m_lastNoiseCov = inputData.noiseCov;
+            emit resultReady(invOpMeg);
+            return;
+        }
+    }
 
     MNEInverseOperator invOpMeg(*inputData.pFiffInfo.data(),
-                                forwardMeg,
+                                *m_pFwdMeg,
                                 inputData.noiseCov,
                                 0.2f,
                                 0.8f);
 
+    m_pInvOp = MNEInverseOperator::SPtr(new MNEInverseOperator(invOpMeg));
+    m_lastNoiseCov = inputData.noiseCov;
+
     emit resultReady(invOpMeg);
 }
 
+//=============================================================================================================
+
+double RtInvOpWorker::relativeCovChange(const FiffCov &noiseCov) const
+{
+    if(m_lastNoiseCov.names != noiseCov.names
+       || m_lastNoiseCov.data.rows() != noiseCov.data.rows()
+       || m_lastNoiseCov.data.cols() != noiseCov.data.cols()) {
+        return std::numeric_limits<double>::infinity();
+    }
+
+    double dNorm = m_lastNoiseCov.data.norm();
+
+    if(dNorm <= 0.0) {
+        return std::numeric_limits<double>::infinity();
+    }
+
+    return (noiseCov.data - m_lastNoiseCov.data).norm() / dNorm;
+}
+
 //=============================================================================================================
 // DEFINE MEMBER METHODS RtInvOp
 //=============================================================================================================
@@ -97,6 +148,7 @@ RtInvOp::RtInvOp(FiffInfo::SPtr &p_pFiffInfo,
 : QObject(parent)
 , m_pFiffInfo(p_pFiffInfo)
 , m_pFwd(p_pFwd)
+, m_dMinCovChange(0.0)
 {
     RtInvOpWorker *worker = new RtInvOpWorker;
     worker->moveToThread(&m_workerThread);
@@ -130,6 +182,7 @@ void RtInvOp::append(const FIFFLIB::FiffCov &noiseCov)
     inputData.noiseCov = noiseCov;
     inputData.pFiffInfo = m_pFiffInfo;
     inputData.pFwd = m_pFwd;
+    inputData.dMinCovChange = m_dMinCovChange;
 
     emit operate(inputData);
 }
@@ -143,6 +196,13 @@ void RtInvOp::setFwdSolution(QSharedPointer<MNELIB::MNEForwardSolution> pFwd)
 
 //=============================================================================================================
 
+void RtInvOp::setMinCovChange(double dMinCovChange)
+{
+    m_dMinCovChange = dMinCovChange;
+}
+
+//=============================================================================================================
+
 void RtInvOp::handleResults(const MNELIB::MNEInverseOperator& invOp)
 {
     emit invOperatorCalculated(invOp);
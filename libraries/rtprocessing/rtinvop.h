@@ -79,6 +79,7 @@ struct RtInvOpInput {
     QSharedPointer<FIFFLIB::FiffInfo>           pFiffInfo;
     QSharedPointer<MNELIB::MNEForwardSolution>  pFwd;
     FIFFLIB::FiffCov                            noiseCov;
+    double                                      dMinCovChange = 0.0;
 };
 
 //=============================================================================================================
@@ -100,6 +101,22 @@ public:
      */
     void doWork(const RtInvOpInput &inputData);
 
+protected:
+    //=========================================================================================================
+    /**
+     * Returns the relative change (Frobenius norm) between the given and the last used noise covariance.
+     *
+     * @param[in] noiseCov   The new noise covariance.
+     *
+     * @return the relative change, or infinity if there is no comparable last noise covariance.
+     */
+    double relativeCovChange(const FIFFLIB::FiffCov &noiseCov) const;
+
+    QSharedPointer<MNELIB::MNEForwardSolution>  m_pFwd;             /**< The forward solution the cached data was computed for. */
+    QSharedPointer<MNELIB::MNEForwardSolution>  m_pFwdMeg;          /**< The cached MEG restricted forward solution. */
+    QSharedPointer<MNELIB::MNEInverseOperator>  m_pInvOp;           /**< The last inverse operator estimation. */
+    FIFFLIB::FiffCov                            m_lastNoiseCov;     /**< The noise covariance of the last inverse operator estimation. */
+
 signals:
     //=========================================================================================================
     /**
@@ -158,6 +175,15 @@ public:
      */
     void setFwdSolution(QSharedPointer<MNELIB::MNEForwardSolution> pFwd);
 
+    //=========================================================================================================
+    /**
+     * Sets the minimal relative change (Frobenius norm) of the noise covariance which triggers a new inverse
+     * operator estimation. Smaller changes are ignored. Default is 0, i.e. every covariance is used.
+     *
+     * @param[in] dMinCovChange     The minimal relative change of the noise covariance.
+     */
+    void setMinCovChange(double dMinCovChange);
+
     //=========================================================================================================
     /**
      * Restarts the thread by interrupting its computation queue, quitting, waiting and then starting it again.
@@ -180,6 +206,8 @@ protected:
     QSharedPointer<FIFFLIB::FiffInfo>           m_pFiffInfo;        /**< The fiff measurement information. */
     QSharedPointer<MNELIB::MNEForwardSolution>  m_pFwd;             /**< The forward solution. */
 
+    double                                      m_dMinCovChange;    /**< The minimal relative change of the noise covariance which triggers a new estimation. */
+
     QThread                                     m_workerThread;     /**< The worker thread. */
 
 signals:
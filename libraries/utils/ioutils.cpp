@@ -44,6 +44,7 @@
 //=============================================================================================================
 
 #include <QDataStream>
+#include <QtEndian>
 
 //=============================================================================================================
 // EIGEN INCLUDES
@@ -51,6 +52,13 @@
 
 #include <Eigen/Core>
 
+//=============================================================================================================
+// STD INCLUDES
+//=============================================================================================================
+
+#include <cstring>
+#include <limits>
+
 //=============================================================================================================
 // USED NAMESPACES
 //=============================================================================================================
@@ -83,6 +91,37 @@ VectorXi IOUtils::fread3_many(QDataStream &p_qStream, qint32 count)
     return res;
 }
 
+//=============================================================================================================
+
+VectorXi IOUtils::fread3_many(const char *p_pData, qint32 count)
+{
+    VectorXi res(count);
+    const unsigned char *bytes = (const unsigned char *)p_pData;
+
+    for(qint32 i = 0; i < count; ++i, bytes += 3)
+        res[i] = (bytes[0] << 16) + (bytes[1] << 8) + bytes[2];
+
+    return res;
+}
+
+//=============================================================================================================
+
+bool IOUtils::fread_block(QDataStream &p_qStream, QByteArray &p_Buffer, qint64 size)
+{
+    if(size < 0 || size > std::numeric_limits<int>::max()) {
+        qWarning() << "[IOUtils::fread_block] Invalid block size" << size;
+        return false;
+    }
+
+    p_Buffer.resize(size);
+    if(p_qStream.readRawData(p_Buffer.data(), size) != size) {
+        qWarning() << "[IOUtils::fread_block] Unexpected end of stream";
+        return false;
+    }
+
+    return true;
+}
+
 //=============================================================================================================
 //fiff_combat
 qint16 IOUtils::swap_short(qint16 source)
@@ -98,6 +137,14 @@ qint16 IOUtils::swap_short(qint16 source)
 
 //=============================================================================================================
 
+void IOUtils::swap_short_many(const char *source, qint16 *dest, qint64 count, qint64 stride)
+{
+    for(qint64 i = 0; i < count; ++i)
+        dest[i] = qFromBigEndian<qint16>(source + 2*i*stride);
+}
+
+//=============================================================================================================
+
 qint32 IOUtils::swap_int(qint32 source)
 {
     unsigned char *csource =  (unsigned char *)(&source);
@@ -132,6 +179,14 @@ void IOUtils::swap_intp(qint32 *source)
 
 //=============================================================================================================
 
+void IOUtils::swap_int_many(const char *source, qint32 *dest, qint64 count, qint64 stride)
+{
+    for(qint64 i = 0; i < count; ++i)
+        dest[i] = qFromBigEndian<qint32>(source + 4*i*stride);
+}
+
+//=============================================================================================================
+
 qint64 IOUtils::swap_long(qint64 source)
 {
     unsigned char *csource =  (unsigned char *)(&source);
@@ -210,6 +265,17 @@ void IOUtils::swap_floatp(float *source)
 
 //=============================================================================================================
 
+void IOUtils::swap_float_many(const char *source, float *dest, qint64 count, qint64 stride)
+{
+    quint32 value;
+    for(qint64 i = 0; i < count; ++i) {
+        value = qFromBigEndian<quint32>(source + 4*i*stride);
+        std::memcpy(dest + i, &value, sizeof(float));
+    }
+}
+
+//=============================================================================================================
+
 void IOUtils::swap_doublep(double *source)
 
 {
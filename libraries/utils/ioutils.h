@@ -112,6 +112,31 @@ public:
      */
     static Eigen::VectorXi fread3_many(QDataStream &p_qStream, qint32 count);
 
+    //=========================================================================================================
+    /**
+     * fread3_many(buffer,count)
+     *
+     * Decodes big endian 3-byte integers from a buffer which was read in one piece
+     *
+     * @param[in] p_pData    Buffer to decode, has to hold at least 3*count bytes
+     * @param[in] count      Number of elements to decode
+     *
+     * @return the decoded 3-byte integers
+     */
+    static Eigen::VectorXi fread3_many(const char *p_pData, qint32 count);
+
+    //=========================================================================================================
+    /**
+     * Reads a block of raw data out of a stream in one piece
+     *
+     * @param[in] p_qStream  Stream to read from
+     * @param[out] p_Buffer  Buffer holding the read data
+     * @param[in] size       Number of bytes to read
+     *
+     * @return true if all bytes were read, false otherwise
+     */
+    static bool fread_block(QDataStream &p_qStream, QByteArray &p_Buffer, qint64 size);
+
     //=========================================================================================================
     /**
      * swap short
@@ -122,6 +147,17 @@ public:
      */
     static qint16 swap_short (qint16 source);
 
+    //=========================================================================================================
+    /**
+     * Decodes big endian shorts from a buffer which was read in one piece
+     *
+     * @param[in] source     Buffer to decode
+     * @param[out] dest      Decoded values, count elements are written
+     * @param[in] count      Number of elements to decode
+     * @param[in] stride     Distance between two consecutive elements in source, in elements
+     */
+    static void swap_short_many(const char *source, qint16 *dest, qint64 count, qint64 stride = 1);
+
     //=========================================================================================================
     /**
      * swap integer
@@ -140,6 +176,17 @@ public:
      */
     static void swap_intp (qint32 *source);
 
+    //=========================================================================================================
+    /**
+     * Decodes big endian integers from a buffer which was read in one piece
+     *
+     * @param[in] source     Buffer to decode
+     * @param[out] dest      Decoded values, count elements are written
+     * @param[in] count      Number of elements to decode
+     * @param[in] stride     Distance between two consecutive elements in source, in elements
+     */
+    static void swap_int_many(const char *source, qint32 *dest, qint64 count, qint64 stride = 1);
+
     //=========================================================================================================
     /**
      * swap long
@@ -176,6 +223,17 @@ public:
      */
     static void swap_floatp (float *source);
 
+    //=========================================================================================================
+    /**
+     * Decodes big endian floats from a buffer which was read in one piece
+     *
+     * @param[in] source     Buffer to decode
+     * @param[out] dest      Decoded values, count elements are written
+     * @param[in] count      Number of elements to decode
+     * @param[in] stride     Distance between two consecutive elements in source, in elements
+     */
+    static void swap_float_many(const char *source, float *dest, qint64 count, qint64 stride = 1);
+
     //=========================================================================================================
     /**
      * swap double
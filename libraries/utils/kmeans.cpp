@@ -43,13 +43,15 @@
 #include <iostream>
 #include <algorithm>
 #include <vector>
-#include <time.h>
+#include <limits>
 
 //=============================================================================================================
 // QT INCLUDES
 //=============================================================================================================
 
 #include <QDebug>
+#include <QVector>
+#include <QtConcurrent>
 
 //=============================================================================================================
 // USED NAMESPACES
@@ -58,6 +60,29 @@
 using namespace UTILSLIB;
 using namespace Eigen;
 
+//=============================================================================================================
+// DEFINE GLOBAL METHODS
+//=============================================================================================================
+
+namespace {
+
+/**
+ * Result of one k-means replicate
+ */
+struct KMeansReplicate
+{
+    quint32 iSeed = 0;          /**< Seed of the random generator */
+    bool bValid = false;        /**< If the replicate finished without an empty cluster error */
+    Eigen::VectorXi idx;        /**< The cluster indeces of the points */
+    Eigen::MatrixXd C;          /**< Cluster centroids */
+    Eigen::VectorXd sumD;       /**< Sums of the distances to the centroid within one cluster */
+    Eigen::MatrixXd D;          /**< Cluster distances to the centroid */
+    double totsumD = std::numeric_limits<double>::max();  /**< Total sum of the centroid distances */
+    qint32 iter = 0;            /**< Number of iterations */
+};
+
+}
+
 //=============================================================================================================
 // DEFINE MEMBER METHODS
 //=============================================================================================================
@@ -74,6 +99,10 @@ KMeans::KMeans(QString distance,
 , m_sEmptyact(emptyact)
 , m_iMaxit(maxit)
 , m_bOnline(online)
+, m_bSeeded(false)
+, m_iSeed(0)
+, m_bParallelReps(false)
+, m_bBoundedUpdate(true)
 , emptyErrCnt(0)
 , iter(0)
 , k(0)
@@ -99,9 +128,6 @@ bool KMeans::calculate(MatrixXd X,
     if (kClusters < 1)
         return false;
 
-    //Init random generator
-    srand ( time(NULL) );
-
 // n points in p dimensional space
     k = kClusters;
     n = X.rows();
@@ -152,181 +178,278 @@ bool KMeans::calculate(MatrixXd X,
     //
     // Done with input argument processing, begin clustering
     //
+    // Every replicate runs on its own copy of this object with its own random generator, which makes the
+    // result independent of whether the replicates run concurrently
+    quint32 iSeed = m_bSeeded ? m_iSeed : std::random_device()();
+
+    QVector<KMeansReplicate> vecReplicates(m_iReps);
+    for(qint32 rep = 0; rep < m_iReps; ++rep)
+        vecReplicates[rep].iSeed = iSeed + rep;
+
+    auto runReplicate = [&](KMeansReplicate& replicateData) {
+        KMeans t_kMeans(*this);
+        replicateData.bValid = t_kMeans.replicate(X,
+                                                  replicateData.iSeed,
+                                                  Xmins,
+                                                  Xmaxs,
+                                                  replicateData.idx,
+                                                  replicateData.C,
+                                                  replicateData.sumD,
+                                                  replicateData.D,
+                                                  replicateData.totsumD);
+        replicateData.iter = t_kMeans.iter;
+    };
+
+    if(m_bParallelReps && m_iReps > 1)
+        QtConcurrent::blockingMap(vecReplicates, runReplicate);
+    else
+        for(qint32 rep = 0; rep < m_iReps; ++rep)
+            runReplicate(vecReplicates[rep]);
+
+    // Return the best solution, ties are resolved in favor of the first replicate
+    qint32 iBest = -1;
+    emptyErrCnt = 0;
+    for(qint32 rep = 0; rep < m_iReps; ++rep)
+    {
+        if(!vecReplicates[rep].bValid)
+        {
+            // If an empty cluster error occurred in one of multiple replicates, move on to the next replicate.
+            // Error only when all replicates fail.
+            ++emptyErrCnt;
+//            printf("Replicate %d terminated: empty cluster created at iteration %d.\n", rep, vecReplicates[rep].iter);
+            continue;
+        }
+
+        if(iBest < 0 || vecReplicates[rep].totsumD < vecReplicates[iBest].totsumD)
+            iBest = rep;
+    }
+
+    if(iBest < 0)
+        return false;
+
+    idx = vecReplicates[iBest].idx;
+    C = vecReplicates[iBest].C;
+    sumD = vecReplicates[iBest].sumD;
+    D = vecReplicates[iBest].D;
+    totsumD = vecReplicates[iBest].totsumD;
+    iter = vecReplicates[iBest].iter;
+
+//if hadNaNs
+//    idx = statinsertnan(wasnan, idx);
+//end
+    return true;
+}
+
+//=============================================================================================================
+
+void KMeans::setSeed(quint32 iSeed)
+{
+    m_iSeed = iSeed;
+    m_bSeeded = true;
+}
+
+//=============================================================================================================
+
+void KMeans::setParallelReplicates(bool bParallel)
+{
+    m_bParallelReps = bParallel;
+}
+
+//=============================================================================================================
+
+void KMeans::setBoundedUpdate(bool bBounded)
+{
+    m_bBoundedUpdate = bBounded;
+}
+
+//=============================================================================================================
+
+bool KMeans::replicate(const MatrixXd& X,
+                       quint32 iSeed,
+                       const RowVectorXd& Xmins,
+                       const RowVectorXd& Xmaxs,
+                       VectorXi& idx,
+                       MatrixXd& C,
+                       VectorXd& sumD,
+                       MatrixXd& D,
+                       double& dTotSumD)
+{
+    m_generator.seed(iSeed);
+
     if (m_bOnline)
     {
         Del = MatrixXd(n,k);
         Del.fill(std::numeric_limits<double>::quiet_NaN());// reassignment criterion
     }
 
-    double totsumDBest = std::numeric_limits<double>::max();
-    emptyErrCnt = 0;
-
-    VectorXi idxBest;
-    MatrixXd Cbest;
-    VectorXd sumDBest;
-    MatrixXd Dbest;
-
-    for(qint32 rep = 0; rep < m_iReps; ++rep)
+    if (m_sStart.compare("uniform") == 0)
+    {
+        C = MatrixXd::Zero(k,p);
+        for(qint32 i = 0; i < k; ++i)
+            for(qint32 j = 0; j < p; ++j)
+                C(i,j) = unifrnd(Xmins[j], Xmaxs[j]);
+        // For 'cosine' and 'correlation', these are uniform inside a subset
+        // of the unit hypersphere.  Still need to center them for
+        // 'correlation'.  (Re)normalization for 'cosine'/'correlation' is
+        // done at each iteration.
+        if (m_sDistance.compare("correlation") == 0)
+            C.array() -= (C.array().rowwise().sum()/p).replicate(1, p).array();
+    }
+    else if (m_sStart.compare("sample") == 0)
     {
-        if (m_sStart.compare("uniform") == 0)
-        {
-            C = MatrixXd::Zero(k,p);
-            for(qint32 i = 0; i < k; ++i)
-                for(qint32 j = 0; j < p; ++j)
-                    C(i,j) = unifrnd(Xmins[j], Xmaxs[j]);
-            // For 'cosine' and 'correlation', these are uniform inside a subset
-            // of the unit hypersphere.  Still need to center them for
-            // 'correlation'.  (Re)normalization for 'cosine'/'correlation' is
-            // done at each iteration.
-            if (m_sDistance.compare("correlation") == 0)
-                C.array() -= (C.array().rowwise().sum()/p).replicate(1, p).array();
-        }
-        else if (m_sStart.compare("sample") == 0)
-        {
-            C = MatrixXd::Zero(k,p);
-            for(qint32 i = 0; i < k; ++i)
-                C.block(i,0,1,p) = X.block(rand() % n, 0, 1, p);
-            // DEBUG
-//            C.block(0,0,1,p) = X.block(2, 0, 1, p);
-//            C.block(1,0,1,p) = X.block(7, 0, 1, p);
-//            C.block(2,0,1,p) = X.block(17, 0, 1, p);
-        }
-    //    else if (start.compare("cluster") == 0)
-    //    {
-    //        Xsubset = X(randsample(n,floor(.1*n)),:);
-    //        [dum, C] = kmeans(Xsubset, k, varargin{:}, 'start','sample', 'replicates',1);
-    //    }
-    //    else if (start.compare("numeric") == 0)
-    //    {
-    //        C = CC(:,:,rep);
-    //    }
-
-        // Compute the distance from every point to each cluster centroid and the
-        // initial assignment of points to clusters
-        D = distfun(X, C);//, 0);
-        idx = VectorXi::Zero(D.rows());
-        d = VectorXd::Zero(D.rows());
+        std::uniform_int_distribution<qint32> unifIdx(0, n-1);
+        C = MatrixXd::Zero(k,p);
+        for(qint32 i = 0; i < k; ++i)
+            C.block(i,0,1,p) = X.block(unifIdx(m_generator), 0, 1, p);
+    }
+    else if (m_sStart.compare("plus") == 0)
+    {
+        C = plusplusStart(X);
+    }
+//    else if (start.compare("cluster") == 0)
+//    {
+//        Xsubset = X(randsample(n,floor(.1*n)),:);
+//        [dum, C] = kmeans(Xsubset, k, varargin{:}, 'start','sample', 'replicates',1);
+//    }
+//    else if (start.compare("numeric") == 0)
+//    {
+//        C = CC(:,:,rep);
+//    }
 
-        for(qint32 i = 0; i < D.rows(); ++i)
-            d[i] = D.row(i).minCoeff(&idx[i]);
+    // Compute the distance from every point to each cluster centroid and the
+    // initial assignment of points to clusters
+    D = distfun(X, C);//, 0);
+    idx = VectorXi::Zero(D.rows());
+    d = VectorXd::Zero(D.rows());
 
-        m = VectorXi::Zero(k);
-        for(qint32 i = 0; i < k; ++i)
-            for (qint32 j = 0; j < idx.rows(); ++j)
-                if(idx[j] == i)
-                    ++ m[i];
+    for(qint32 i = 0; i < D.rows(); ++i)
+        d[i] = D.row(i).minCoeff(&idx[i]);
 
-        try // catch empty cluster errors and move on to next rep
-        {
-            // Begin phase one:  batch reassignments
-            bool converged = batchUpdate(X, C, idx);
+    m = VectorXi::Zero(k);
+    for (qint32 j = 0; j < idx.rows(); ++j)
+        ++ m[idx[j]];
 
-            // Begin phase two:  single reassignments
-            if (m_bOnline)
-                converged = onlineUpdate(X, C, idx);
+    try // catch empty cluster errors and move on to next rep
+    {
+        // Begin phase one:  batch reassignments
+        bool converged = batchUpdate(X, C, idx);
 
-            if (!converged)
-                printf("Failed To Converge during replicate %d\n", rep);
+        // Begin phase two:  single reassignments
+        if (m_bOnline)
+            converged = onlineUpdate(X, C, idx);
 
-            // Calculate cluster-wise sums of distances
-            VectorXi nonempties = VectorXi::Zero(m.rows());
-            quint32 count = 0;
-            for(qint32 i = 0; i < m.rows(); ++i)
+        if (!converged)
+            printf("Failed To Converge during replicate with seed %u\n", iSeed);
+
+        // Calculate cluster-wise sums of distances
+        VectorXi nonempties = VectorXi::Zero(m.rows());
+        quint32 count = 0;
+        for(qint32 i = 0; i < m.rows(); ++i)
+        {
+            if(m[i] > 0)
             {
-                if(m[i] > 0)
-                {
-                    nonempties[i] = 1;
-                    ++count;
-                }
+                nonempties[i] = 1;
+                ++count;
             }
-            MatrixXd C_tmp(count,C.cols());
-            count = 0;
-            for(qint32 i = 0; i < nonempties.rows(); ++i)
+        }
+        MatrixXd C_tmp(count,C.cols());
+        count = 0;
+        for(qint32 i = 0; i < nonempties.rows(); ++i)
+        {
+            if(nonempties[i])
             {
-                if(nonempties[i])
-                {
-                    C_tmp.row(count) = C.row(i);
-                    ++count;
-                }
+                C_tmp.row(count) = C.row(i);
+                ++count;
             }
+        }
 
-            MatrixXd D_tmp = distfun(X, C_tmp);//, iter);
-            count = 0;
-            for(qint32 i = 0; i < nonempties.rows(); ++i)
+        MatrixXd D_tmp = distfun(X, C_tmp);//, iter);
+        count = 0;
+        for(qint32 i = 0; i < nonempties.rows(); ++i)
+        {
+            if(nonempties[i])
             {
-                if(nonempties[i])
-                {
-                    D.col(i) = D_tmp.col(count);
-                    C.row(i) = C_tmp.row(count);
-                    ++count;
-                }
+                D.col(i) = D_tmp.col(count);
+                C.row(i) = C_tmp.row(count);
+                ++count;
             }
+        }
 
-            d = VectorXd::Zero(n);
-            for(qint32 i = 0; i < n; ++i)
-                d[i] += D.array()(idx[i]*n+i);//Colum Major
+        d = VectorXd::Zero(n);
+        for(qint32 i = 0; i < n; ++i)
+            d[i] += D.array()(idx[i]*n+i);//Colum Major
 
-            sumD = VectorXd::Zero(k);
-            for(qint32 i = 0; i < k; ++i)
-                for (qint32 j = 0; j < idx.rows(); ++j)
-                    if(idx[j] == i)
-                        sumD[i] += d[j];
+        sumD = VectorXd::Zero(k);
+        for (qint32 j = 0; j < idx.rows(); ++j)
+            sumD[idx[j]] += d[j];
 
-            totsumD = sumD.array().sum();
+        totsumD = sumD.array().sum();
+        dTotSumD = totsumD;
 
-//            printf("%d iterations, total sum of distances = %f\n", iter, totsumD);
+//        printf("%d iterations, total sum of distances = %f\n", iter, totsumD);
+    }
+    catch (int e)
+    {
+        if(e == 0)
+            return false;
+    } // catch
 
-            // Save the best solution so far
-            if (totsumD < totsumDBest)
-            {
-                totsumDBest = totsumD;
-                idxBest = idx;
-                Cbest = C;
-                sumDBest = sumD;
-                Dbest = D;
-            }
-        }
-        catch (int e)
+    return true;
+}
+
+//=============================================================================================================
+
+MatrixXd KMeans::plusplusStart(const MatrixXd& X)
+{
+    std::uniform_int_distribution<qint32> unifIdx(0, n-1);
+
+    MatrixXd C = MatrixXd::Zero(k,p);
+    MatrixXd C_i = X.row(unifIdx(m_generator));
+    C.row(0) = C_i;
+
+    // Distance of every point to its nearest centroid chosen so far
+    VectorXd minD = distfun(X, C_i).col(0);
+
+    for(qint32 i = 1; i < k; ++i)
+    {
+        double sum = minD.sum();
+
+        qint32 iSample = n-1;
+        if(sum > 0)
         {
-            if(e == 0)
+            double r = std::uniform_real_distribution<double>(0.0, sum)(m_generator);
+            double cumSum = 0;
+            for(qint32 j = 0; j < n; ++j)
             {
-                // If an empty cluster error occurred in one of multiple replicates, catch
-                // it, warn, and move on to next replicate.  Error only when all replicates
-                // fail.  Rethrow an other kind of error.
-                if (m_iReps == 1)
-                    return false;
-                else
+                cumSum += minD[j];
+                if(r < cumSum)
                 {
-                    emptyErrCnt = emptyErrCnt + 1;
-//                    printf("Replicate %d terminated: empty cluster created at iteration %d.\n", rep, iter);
-                    if (emptyErrCnt == m_iReps)
-                    {
-//                        error(message('EmptyClusterAllReps'));
-                        return false;
-                    }
-
+                    iSample = j;
+                    break;
                 }
             }
-        } // catch
-
-    } // replicates
+        }
+        else
+        {
+            // All points coincide with a centroid
+            iSample = unifIdx(m_generator);
+        }
 
-    // Return the best solution
-    idx = idxBest;
-    C = Cbest;
-    sumD = sumDBest;
-    D = Dbest;
+        C_i = X.row(iSample);
+        C.row(i) = C_i;
+        minD = minD.cwiseMin(distfun(X, C_i).col(0));
+    }
 
-//if hadNaNs
-//    idx = statinsertnan(wasnan, idx);
-//end
-    return true;
+    return C;
 }
 
 //=============================================================================================================
 
 bool KMeans::batchUpdate(const MatrixXd& X, MatrixXd& C, VectorXi& idx)
 {
+    if (m_bBoundedUpdate && (m_sDistance.compare("sqeuclidean") == 0 || m_sDistance.compare("cityblock") == 0))
+        return boundedBatchUpdate(X, C, idx);
+
     // Every point moved, every cluster will need an update
     qint32 i = 0;
     VectorXi moved(n);
@@ -369,7 +492,7 @@ bool KMeans::batchUpdate(const MatrixXd& X, MatrixXd& C, VectorXi& idx)
         // Deal with clusters that have just lost all their members
         VectorXi empties = VectorXi::Zero(changed.rows());
         for(qint32 i = 0; i < changed.rows(); ++i)
-            if(m(i) == 0)
+            if(m[changed[i]] == 0)
                 empties[i] = 1;
 
         if (empties.sum() > 0)
@@ -429,8 +552,11 @@ bool KMeans::batchUpdate(const MatrixXd& X, MatrixXd& C, VectorXi& idx)
             MatrixXd C_new;
             VectorXi m_new;
             gcentroids(X, idx, changed, C_new, m_new);
-            C.block(0,0,k,C.cols()) = C_new;
-            m.block(0,0,k,1) = m_new;
+            for(qint32 i = 0; i < changed.rows(); ++i)
+            {
+                C.row(changed[i]) = C_new.row(i);
+                m[changed[i]] = m_new[i];
+            }
             --iter;
             break;
         }
@@ -510,6 +636,178 @@ bool KMeans::batchUpdate(const MatrixXd& X, MatrixXd& C, VectorXi& idx)
 
 //=============================================================================================================
 
+bool KMeans::boundedBatchUpdate(const MatrixXd& X, MatrixXd& C, VectorXi& idx)
+{
+    qint32 i = 0;
+
+    // Every point moved, every cluster will need an update
+    VectorXi changed(k);
+    for(i = 0; i < k; ++i)
+        changed[i] = i;
+
+    previdx = VectorXi::Zero(n);
+
+    prevtotsumD = std::numeric_limits<double>::max();//max double
+
+    // Points and centroids are stored as columns for contiguous access
+    MatrixXd XT = X.transpose();
+    MatrixXd CT = C.transpose();
+
+    // Distance of every point to its centroid and lower bounds of the metric distances to all centroids
+    VectorXd dist = VectorXd::Zero(n);
+    MatrixXd lower = MatrixXd::Zero(k, n);
+    VectorXd shift = VectorXd::Zero(k);
+    VectorXd halfMinCC(k);
+    std::vector<bool> isChanged(k);
+
+    //
+    // Begin phase one:  batch reassignments
+    //
+    iter = 0;
+    bool converged = false;
+    while(true)
+    {
+        ++iter;
+
+        // Calculate the new cluster centroids and counts and the distance the centroids moved
+        MatrixXd C_new;
+        VectorXi m_new;
+        gcentroids(X, idx, changed, C_new, m_new);
+        MatrixXd CT_new = C_new.transpose();
+
+        shift.setZero();
+        std::fill(isChanged.begin(), isChanged.end(), false);
+        for(i = 0; i < changed.rows(); ++i)
+        {
+            shift[changed[i]] = metric(pointDistance(CT_new.col(i).data(), CT.col(changed[i]).data()));
+            isChanged[changed[i]] = true;
+            C.row(changed[i]) = C_new.row(i);
+            CT.col(changed[i]) = CT_new.col(i);
+            m[changed[i]] = m_new[i];
+        }
+
+        // Deal with clusters that have just lost all their members
+        for(i = 0; i < changed.rows(); ++i)
+            if(m[changed[i]] == 0 && m_sEmptyact.compare("error") == 0)
+                return converged;
+
+        // Update the distances to the own centroids and the bounds to the other centroids
+        totsumD = 0;
+        for(i = 0; i < n; ++i)
+        {
+            if(isChanged[idx[i]])
+                dist[i] = pointDistance(XT.col(i).data(), CT.col(idx[i]).data());
+            lower.col(i) -= shift;
+            totsumD += dist[i];
+        }
+
+        // Test for a cycle: if objective is not decreased, back out
+        // the last step and move on to the single update phase
+        if(prevtotsumD <= totsumD)
+        {
+            idx = previdx;
+            gcentroids(X, idx, changed, C_new, m_new);
+            for(i = 0; i < changed.rows(); ++i)
+            {
+                C.row(changed[i]) = C_new.row(i);
+                m[changed[i]] = m_new[i];
+            }
+            --iter;
+            break;
+        }
+
+        if (iter >= m_iMaxit)
+            break;
+
+        // Half of the distance of every centroid to its closest other centroid. A point which is not farther
+        // from its centroid cannot be closer to any other centroid.
+        halfMinCC.fill(std::numeric_limits<double>::infinity());
+        for(i = 0; i < k; ++i)
+        {
+            for(qint32 j = i + 1; j < k; ++j)
+            {
+                double dist_cc = 0.5 * metric(pointDistance(CT.col(i).data(), CT.col(j).data()));
+                halfMinCC[i] = std::min(halfMinCC[i], dist_cc);
+                halfMinCC[j] = std::min(halfMinCC[j], dist_cc);
+            }
+        }
+
+        // Determine closest cluster for each point and reassign points to clusters. Only the distances to
+        // centroids whose lower bound is below the distance to the closest centroid found so far are needed.
+        previdx = idx;
+        prevtotsumD = totsumD;
+
+        std::vector<int> tmp;
+        for(i = 0; i < n; ++i)
+        {
+            double upper = metric(dist[i]);
+            lower(idx[i], i) = upper;
+
+            if(upper <= halfMinCC[idx[i]])
+                continue;
+
+            // Resolve ties in favor of not moving and in favor of the lower cluster index
+            qint32 nidx = idx[i];
+            double d_i = dist[i];
+            for(qint32 j = 0; j < k; ++j)
+            {
+                if(j == idx[i] || lower(j, i) >= upper)
+                    continue;
+
+                double dist_ij = pointDistance(XT.col(i).data(), CT.col(j).data());
+                lower(j, i) = metric(dist_ij);
+
+                if(dist_ij < d_i)
+                {
+                    nidx = j;
+                    d_i = dist_ij;
+                    upper = lower(j, i);
+                }
+            }
+
+            if(nidx != idx[i])
+            {
+                tmp.push_back(idx[i]);
+                tmp.push_back(nidx);
+                idx[i] = nidx;
+                dist[i] = d_i;
+            }
+        }
+
+        if (tmp.empty())
+        {
+            converged = true;
+            break;
+        }
+
+        // Find clusters that gained or lost members
+        std::sort(tmp.begin(),tmp.end());
+        tmp.erase(std::unique(tmp.begin(),tmp.end()), tmp.end());
+
+        changed.conservativeResize(tmp.size());
+        for(quint32 j = 0; j < tmp.size(); ++j)
+            changed[j] = tmp[j];
+    } // phase one
+    return converged;
+}
+
+//=============================================================================================================
+
+double KMeans::pointDistance(const double* x, const double* c) const
+{
+    Map<const VectorXd> x_j(x, p);
+    Map<const VectorXd> c_j(c, p);
+
+    if (m_sDistance.compare("sqeuclidean") == 0)
+        return (x_j - c_j).squaredNorm();
+    else if (m_sDistance.compare("cityblock") == 0)
+        return (x_j - c_j).cwiseAbs().sum();
+
+    return 0;
+}
+
+//=============================================================================================================
+
 bool KMeans::onlineUpdate(const MatrixXd& X, MatrixXd& C, VectorXi& idx)
 {
     // Initialize some cluster information prior to phase two
@@ -619,7 +917,7 @@ bool KMeans::onlineUpdate(const MatrixXd& X, MatrixXd& C, VectorXi& idx)
 
                 Del.col(i) = ((double)m[i] / ((double)m[i] + sgn.cast<double>().array()));
 
-                Del.col(i).array() *= (X - C.row(i).replicate(n,1)).array().pow(2).rowwise().sum().array();
+                Del.col(i).array() *= (X.rowwise() - C.row(i)).rowwise().squaredNorm().array();
             }
         }
         else if (m_sDistance.compare("cityblock") == 0)
@@ -876,10 +1174,10 @@ MatrixXd KMeans::distfun(const MatrixXd& X, MatrixXd& C)//, qint32 iter)
     {
         for(qint32 i = 0; i < nclusts; ++i)
         {
-            D.col(i) = (X.col(0).array() - C(i,0)).pow(2);
+            D.col(i) = (X.col(0).array() - C(i,0)).square();
 
             for(qint32 j = 1; j < p; ++j)
-                D.col(i) = D.col(i).array() + (X.col(j).array() - C(i,j)).pow(2);
+                D.col(i).array() += (X.col(j).array() - C(i,j)).square();
         }
     }
     else if (m_sDistance.compare("cityblock") == 0)
@@ -931,33 +1229,31 @@ void KMeans::gcentroids(const MatrixXd& X, const VectorXi& index, const VectorXi
     centroids.fill(std::numeric_limits<double>::quiet_NaN());
     counts = VectorXi::Zero(num);
 
-    VectorXi members;
+    // Collect the members of all requested clusters in a single pass over the points
+    QVector<qint32> clustPos(k, -1);
+    for(qint32 i = 0; i < num; ++i)
+        clustPos[clusts[i]] = i;
+
+    QVector<QVector<qint32> > clustMembers(num);
+    for(qint32 j = 0; j < index.rows(); ++j)
+        if(clustPos[index[j]] >= 0)
+            clustMembers[clustPos[index[j]]].append(j);
 
     qint32 c;
 
     for(qint32 i = 0; i < num; ++i)
     {
-        c = 0;
-        members = VectorXi::Zero(index.rows());
-        for(qint32 j = 0; j < index.rows(); ++j)
-        {
-            if(index[j] == clusts[i])
-            {
-                members[c] = j;
-                ++c;
-            }
-        }
-        members.conservativeResize(c);
+        const QVector<qint32>& members = clustMembers[i];
+        c = members.size();
         if (c > 0)
         {
             counts[i] = c;
             if(m_sDistance.compare("sqeuclidean") == 0)
             {
                 //Initialize
-                if(members.rows() > 0)
-                    centroids.row(i) = RowVectorXd::Zero(centroids.cols());
+                centroids.row(i) = RowVectorXd::Zero(centroids.cols());
 
-                for(qint32 j = 0; j < members.rows(); ++j)
+                for(qint32 j = 0; j < members.size(); ++j)
                     centroids.row(i).array() += X.row(members[j]).array() / counts[i];
             }
             else if(m_sDistance.compare("cityblock") == 0)
@@ -965,16 +1261,9 @@ void KMeans::gcentroids(const MatrixXd& X, const VectorXi& index, const VectorXi
                 // Separate out sorted coords for points in i'th cluster,
                 // and use to compute a fast median, component-wise
                 MatrixXd Xsorted(counts[i],p);
-                c = 0;
 
-                for(qint32 j = 0; j < index.rows(); ++j)
-                {
-                    if(index[j] == clusts[i])
-                    {
-                        Xsorted.row(c) = X.row(j);
-                        ++c;
-                    }
-                }
+                for(qint32 j = 0; j < members.size(); ++j)
+                    Xsorted.row(j) = X.row(members[j]);
 
                 for(qint32 j = 0; j < Xsorted.cols(); ++j)
                     std::sort(Xsorted.col(j).data(),Xsorted.col(j).data()+Xsorted.rows());
@@ -987,7 +1276,8 @@ void KMeans::gcentroids(const MatrixXd& X, const VectorXi& index, const VectorXi
             }
             else if(m_sDistance.compare("cosine") == 0 || m_sDistance.compare("correlation") == 0)
             {
-                for(qint32 j = 0; j < members.rows(); ++j)
+                centroids.row(i) = RowVectorXd::Zero(centroids.cols());
+                for(qint32 j = 0; j < members.size(); ++j)
                     centroids.row(i).array() += X.row(members[j]).array() / counts[i]; // unnormalized
             }
 //            else if(m_sDistance.compare("hamming") == 0)
@@ -1011,7 +1301,7 @@ double KMeans::unifrnd(double a, double b)
     double mu = a2+b2;
     double sig = b2-a2;
 
-    double r = mu + sig * (2.0* (rand() % 1000)/1000 -1.0);
+    double r = mu + sig * (2.0* std::uniform_int_distribution<qint32>(0, 999)(m_generator)/1000 -1.0);
 
     return r;
 }
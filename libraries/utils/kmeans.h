@@ -55,6 +55,13 @@
 
 #include <Eigen/Core>
 
+//=============================================================================================================
+// STL INCLUDES
+//=============================================================================================================
+
+#include <random>
+#include <cmath>
+
 //=============================================================================================================
 // DEFINE NAMESPACE MNELIB
 //=============================================================================================================
@@ -75,7 +82,7 @@ public:
     typedef QSharedPointer<const KMeans> ConstSPtr; /**< Const shared pointer type for KMeans. */
 
     //distance {'sqeuclidean','cityblock','cosine','correlation','hamming'};
-    //startNames = {'uniform','sample','cluster'};
+    //startNames = {'uniform','sample','plus','cluster'};
     //emptyactNames = {'error','drop','singleton'};
 
     //=========================================================================================================
@@ -83,7 +90,7 @@ public:
      * Constructs a KMeans algorithm object.
      *
      * @param[in] distance   (optional) K-Means distance measure: "sqeuclidean" (default), "cityblock" , "cosine", "correlation", "hamming"
-     * @param[in] start      (optional) Cluster initialization: "sample" (default), "uniform", "cluster"
+     * @param[in] start      (optional) Cluster initialization: "sample" (default), "uniform", "plus" (k-means++), "cluster"
      * @param[in] replicates (optional) Number of K-Means replicates, which are generated. Best is returned.
      * @param[in] emptyact   (optional) What happens if a cluster wents empty: "error" (default), "drop", "singleton"
      * @param[in] online     (optional) If centroids should be updated during iterations: true (default), false
@@ -96,6 +103,32 @@ public:
                     bool online = true,
                     qint32 maxit = 100);
 
+    //=========================================================================================================
+    /**
+     * Seeds the random generator, which makes the results reproducible. Replicate r uses the seed iSeed + r,
+     * independent of the order in which the replicates are run. By default a random seed is drawn per call.
+     *
+     * @param[in] iSeed  The seed.
+     */
+    void setSeed(quint32 iSeed);
+
+    //=========================================================================================================
+    /**
+     * Sets whether the replicates are run concurrently. Default is false.
+     *
+     * @param[in] bParallel  Whether to run the replicates concurrently.
+     */
+    void setParallelReplicates(bool bParallel);
+
+    //=========================================================================================================
+    /**
+     * Sets whether the batch update of the "sqeuclidean" and "cityblock" distances skips the distance
+     * computations which the triangle inequality rules out. Default is true. The result is the same either way.
+     *
+     * @param[in] bBounded  Whether to use the bounded batch update.
+     */
+    void setBoundedUpdate(bool bBounded);
+
     //=========================================================================================================
     /**
      * Clusters input data X
@@ -115,6 +148,43 @@ public:
                     Eigen::MatrixXd& D);
 
 private:
+    //=========================================================================================================
+    /**
+     * Runs one replicate: initialization, batch and online update.
+     *
+     * @param[in] X          Input data (rows = points; cols = p dimensional space)
+     * @param[in] iSeed      Seed of the random generator of this replicate
+     * @param[in] Xmins      Minimum of the input data per dimension (uniform start only)
+     * @param[in] Xmaxs      Maximum of the input data per dimension (uniform start only)
+     * @param[out] idx       The cluster indeces to which cluster the input points belong to
+     * @param[out] C         Cluster centroids k x p
+     * @param[out] sumD      Summation of the distances to the centroid within one cluster
+     * @param[out] D         Cluster distances to the centroid
+     * @param[out] dTotSumD  Total sum of the centroid distances
+     *
+     * @return false if the replicate failed due to an empty cluster, true otherwise
+     */
+    bool replicate(const Eigen::MatrixXd& X,
+                   quint32 iSeed,
+                   const Eigen::RowVectorXd& Xmins,
+                   const Eigen::RowVectorXd& Xmaxs,
+                   Eigen::VectorXi& idx,
+                   Eigen::MatrixXd& C,
+                   Eigen::VectorXd& sumD,
+                   Eigen::MatrixXd& D,
+                   double& dTotSumD);
+
+    //=========================================================================================================
+    /**
+     * k-means++ initialization: Every further centroid is drawn from the points with a probability proportional
+     * to the distance to the nearest centroid chosen so far.
+     *
+     * @param[in] X      Input data
+     *
+     * @return The initial cluster centroids
+     */
+    Eigen::MatrixXd plusplusStart(const Eigen::MatrixXd& X);
+
     //=========================================================================================================
     /**
      * Calculate point to cluster centroid distances.
@@ -141,6 +211,45 @@ private:
                      Eigen::MatrixXd& C,
                      Eigen::VectorXi& idx);
 
+    //=========================================================================================================
+    /**
+     * Batch update for metric distances ("sqeuclidean", "cityblock"). Same result as batchUpdate, but a lower
+     * bound of the distance to the second closest centroid is kept per point (Hamerly). The bounds are
+     * decreased by the centroid shifts, points whose assigned centroid is closer than the bound keep their
+     * cluster without computing the distances to the other centroids.
+     *
+     * @param[in] X          Input data
+     * @param[in, out] C     Cluster centroids
+     * @param[in, out] idx   The cluster indeces to which cluster the input points belong to
+     *
+     * @return true if converged, false otherwise
+     */
+    bool boundedBatchUpdate(const Eigen::MatrixXd& X,
+                            Eigen::MatrixXd& C,
+                            Eigen::VectorXi& idx);
+
+    //=========================================================================================================
+    /**
+     * Calculate the distance of one point to one cluster centroid.
+     *
+     * @param[in] x  The p coordinates of the point
+     * @param[in] c  The p coordinates of the centroid
+     *
+     * @return The distance, in the same units as distfun
+     */
+    double pointDistance(const double* x,
+                         const double* c) const;
+
+    //=========================================================================================================
+    /**
+     * Converts a distance as returned by distfun to a metric, for which the triangle inequality holds.
+     *
+     * @param[in] dist   The distance
+     *
+     * @return The metric distance
+     */
+    inline double metric(double dist) const;
+
     //=========================================================================================================
     /**
      * Centroids and counts stratified by group.
@@ -188,6 +297,12 @@ private:
     QString m_sEmptyact;    /**< What should be done if a cluster wents empty: "error" (default), "drop", "singleton" */
     qint32 m_iMaxit;        /**< Maximal number of iterations per replicate */
     bool m_bOnline;         /**< If online update should be performed */
+    bool m_bSeeded;         /**< If the random generator was seeded by setSeed */
+    quint32 m_iSeed;        /**< Seed of the random generator */
+    bool m_bParallelReps;   /**< If the replicates are run concurrently */
+    bool m_bBoundedUpdate;  /**< If the batch update of sqeuclidean and cityblock uses the distance bounds */
+
+    std::mt19937 m_generator;   /**< Random generator of the current replicate */
 
     qint32 emptyErrCnt;     /**< Counts the occurence of empty errors */
 
@@ -206,6 +321,15 @@ private:
 
     Eigen::VectorXi previdx;/**< Previous point cluster indeces */
 };
+
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+inline double KMeans::metric(double dist) const
+{
+    return m_sDistance.compare("sqeuclidean") == 0 ? std::sqrt(dist) : dist;
+}
 } // NAMESPACE
 
 #endif // KMEANS_H
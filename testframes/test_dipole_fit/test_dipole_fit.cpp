@@ -39,6 +39,9 @@
 
 #include <inverse/dipoleFit/dipole_fit_settings.h>
 #include <inverse/dipoleFit/dipole_fit.h>
+#include <inverse/dipoleFit/dipole_fit_data.h>
+#include <inverse/dipoleFit/dipole_forward.h>
+#include <inverse/dipoleFit/guess_data.h>
 
 //=============================================================================================================
 // QT INCLUDES
@@ -70,10 +73,13 @@ private slots:
     void initTestCase();
     void dipoleFitSimple();
     void dipoleFitAdvanced();
+    void dipoleFitThreads();
+    void guessFieldCache();
     void cleanupTestCase();
 
 private:
     void compareFit();
+    void compareGuesses(const GuessData& guess, const GuessData& ref);
 
     double epsilon;
 
@@ -258,6 +264,191 @@ void TestDipoleFit::dipoleFitAdvanced()
 
 //=============================================================================================================
 
+void TestDipoleFit::dipoleFitThreads()
+{
+    QFile testFile;
+
+    //*********************************************************************************************************
+    // Dipole Fit Settings
+    //*********************************************************************************************************
+
+    printf(">>>>>>>>>>>>>>>>>>>>>>>>> Dipole Fit Settings >>>>>>>>>>>>>>>>>>>>>>>>>
+");
+
+    //Following is equivalent to: --meas ./mne-cpp-test-data/MEG/sample/sample_audvis-ave.fif --set 1
+    //--noise ./mne-cpp-test-data/MEG/sample/sample_audvis-cov.fif --bem ./mne-cpp-test-data/subjects/sample/bem/sample-5120-bem.fif
+    //--mri ./mne-cpp-test-data/MEG/sample/all-trans.fif --meg --tmin 150 --tmax 250 --tstep 10
+    //--mindist 0 --guessrad 100, once without and once with --threads
+    DipoleFitSettings settings;
+
+    testFile.setFileName(QCoreApplication::applicationDirPath() + "/mne-cpp-test-data/MEG/sample/sample_audvis-ave.fif"); QVERIFY( testFile.exists() );
+    settings.measname = testFile.fileName();
+
+    settings.is_raw = false;
+    settings.setno = 1;
+    settings.include_meg = true;
+    settings.include_eeg = false;
+    settings.tmin = 0.15f;
+    settings.tmax = 0.25f;
+    settings.tstep = 0.01f;
+
+    testFile.setFileName(QCoreApplication::applicationDirPath() + "/mne-cpp-test-data/subjects/sample/bem/sample-5120-bem.fif"); QVERIFY( testFile.exists() );
+    settings.bemname = testFile.fileName();
+
+    settings.bmin = 1000000.0f;
+    settings.bmax = 1000000.0f;
+
+    settings.guess_mindist = 0.0f;
+    settings.guess_rad = 0.1f;
+
+    testFile.setFileName(QCoreApplication::applicationDirPath() + "/mne-cpp-test-data/MEG/sample/all-trans.fif"); QVERIFY( testFile.exists() );
+    settings.mriname = testFile.fileName();
+
+    testFile.setFileName(QCoreApplication::applicationDirPath() + "/mne-cpp-test-data/MEG/sample/sample_audvis-cov.fif"); QVERIFY( testFile.exists() );
+    settings.noisename = testFile.fileName();
+
+    testFile.setFileName(QCoreApplication::applicationDirPath() + "/mne-cpp-test-data/MEG/sample/sample_audvis-ave.fif"); QVERIFY( testFile.exists() );
+    settings.projnames.append(testFile.fileName());
+
+    settings.checkIntegrity();
+
+    printf("<<<<<<<<<<<<<<<<<<<<<<<<< Dipole Fit Settings Finished <<<<<<<<<<<<<<<<<<<<<<<<<
+");
+
+    //*********************************************************************************************************
+    // Compute Serial and Parallel Dipole Fit
+    //*********************************************************************************************************
+
+    printf(">>>>>>>>>>>>>>>>>>>>>>>>> Compute Serial and Parallel Dipole Fit >>>>>>>>>>>>>>>>>>>>>>>>>
+");
+
+    settings.use_threads = false;
+    DipoleFit dipFitSerial(&settings);
+    m_refECDSet = dipFitSerial.calculateFit();
+
+    settings.use_threads = true;
+    DipoleFit dipFitParallel(&settings);
+    m_ECDSet = dipFitParallel.calculateFit();
+
+    printf("<<<<<<<<<<<<<<<<<<<<<<<<< Compute Serial and Parallel Dipole Fit Finished <<<<<<<<<<<<<<<<<<<<<<<<<
+");
+
+    //*********************************************************************************************************
+    // Compare Fit
+    //*********************************************************************************************************
+
+    // The time points are fitted independently, so the parallel fit has to reproduce the serial one exactly
+    QVERIFY( m_refECDSet.size() > 0 );
+    compareFit();
+}
+
+//=============================================================================================================
+
+void TestDipoleFit::guessFieldCache()
+{
+    QString cacheName = QDir::tempPath() + "/test_dipole_fit-guess.cache";
+    QFile::remove(cacheName);
+
+    // The sphere model setup of the fit with a noise covariance, as the guess fields are whitened
+    DipoleFitSettings settings;
+    settings.measname = QCoreApplication::applicationDirPath() + "/mne-cpp-test-data/MEG/sample/sample_audvis-ave.fif";
+    settings.mriname = QCoreApplication::applicationDirPath() + "/mne-cpp-test-data/MEG/sample/all-trans.fif";
+    settings.noisename = QCoreApplication::applicationDirPath() + "/mne-cpp-test-data/MEG/sample/sample_audvis-cov.fif";
+    settings.include_meg = true;
+    settings.include_eeg = false;
+    settings.guess_mindist = 0.0f;
+    settings.guess_grid = 0.02f;
+
+    DipoleFitData* fitData = DipoleFitData::setup_dipole_fit_data(settings.mriname,
+                                                                  settings.measname,
+                                                                  QString(),
+                                                                  &settings.r0,
+                                                                  NULL,
+                                                                  settings.accurate,
+                                                                  settings.badname,
+                                                                  settings.noisename,
+                                                                  settings.grad_std,
+                                                                  settings.mag_std,
+                                                                  settings.eeg_std,
+                                                                  settings.mag_reg,
+                                                                  settings.grad_reg,
+                                                                  settings.eeg_reg,
+                                                                  settings.diagnoise,
+                                                                  settings.projnames,
+                                                                  settings.include_meg,
+                                                                  settings.include_eeg);
+    QVERIFY(fitData != NULL);
+
+    // The first setup computes the guess fields and writes the cache
+    GuessData guessWrite(settings.guessname,settings.guess_surfname,settings.guess_mindist,settings.guess_exclude,
+                         settings.guess_grid,fitData,cacheName);
+    QVERIFY(guessWrite.nguess > 0);
+    QVERIFY(QFile::exists(cacheName));
+
+    // Reading the cache replaces freshly computed fields by the stored ones
+    GuessData guessRead(settings.guessname,settings.guess_surfname,settings.guess_mindist,settings.guess_exclude,
+                        settings.guess_grid,fitData);
+    QVERIFY(guessRead.read_guess_fields(cacheName,fitData));
+    compareGuesses(guessRead,guessWrite);
+
+    // Each of the inputs to the key has to invalidate the cache
+    float fOrig = guessRead.rr[0][0];
+    guessRead.rr[0][0] += 0.001f;
+    QVERIFY(!guessRead.read_guess_fields(cacheName,fitData));
+    guessRead.rr[0][0] = fOrig;
+
+    fOrig = fitData->r0[2];
+    fitData->r0[2] += 0.001f;
+    QVERIFY(!guessRead.read_guess_fields(cacheName,fitData));
+    fitData->r0[2] = fOrig;
+
+    fitData->fit_mag_dipoles = !fitData->fit_mag_dipoles;
+    QVERIFY(!guessRead.read_guess_fields(cacheName,fitData));
+    fitData->fit_mag_dipoles = !fitData->fit_mag_dipoles;
+
+    QString chName = fitData->ch_names[0];
+    fitData->ch_names[0] = chName + "X";
+    QVERIFY(!guessRead.read_guess_fields(cacheName,fitData));
+    fitData->ch_names[0] = chName;
+
+    // With the original inputs the cache is valid again
+    QVERIFY(guessRead.read_guess_fields(cacheName,fitData));
+
+    // A truncated cache is rejected
+    QFile cacheFile(cacheName);
+    QVERIFY(cacheFile.resize(cacheFile.size()/2));
+    QVERIFY(!guessRead.read_guess_fields(cacheName,fitData));
+    compareGuesses(guessRead,guessWrite);
+
+    delete fitData;
+    QFile::remove(cacheName);
+}
+
+//=============================================================================================================
+
+void TestDipoleFit::compareGuesses(const GuessData& guess, const GuessData& ref)
+{
+    QCOMPARE(guess.nguess, ref.nguess);
+    for (int k = 0; k < ref.nguess; ++k) {
+        DipoleForward* fwd = guess.guess_fwd[k];
+        DipoleForward* fwdRef = ref.guess_fwd[k];
+        QCOMPARE(fwd->nch, fwdRef->nch);
+        for (int p = 0; p < 3*fwdRef->nch; ++p) {
+            QCOMPARE(fwd->fwd[0][p], fwdRef->fwd[0][p]);
+            QCOMPARE(fwd->uu[0][p], fwdRef->uu[0][p]);
+        }
+        for (int p = 0; p < 9; ++p) {
+            QCOMPARE(fwd->vv[0][p], fwdRef->vv[0][p]);
+        }
+        for (int p = 0; p < 3; ++p) {
+            QCOMPARE(fwd->sing[p], fwdRef->sing[p]);
+            QCOMPARE(fwd->scales[p], fwdRef->scales[p]);
+        }
+    }
+}
+
+//=============================================================================================================
+
 void TestDipoleFit::compareFit()
 {
     //*********************************************************************************************************
@@ -0,0 +1,507 @@
+//=============================================================================================================
+/**
+ * @file     test_fs_io.cpp
+ * @author   MNE-CPP authors
+ * @since    0.1.8
+ * @date     October, 2026
+ *
+ * @section  LICENSE
+ *
+ * Copyright (C) 2026, MNE-CPP authors. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ * the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+ *       following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ *       the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+ *       to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * @brief    The FreeSurfer file reader test implementation
+ *
+ */
+
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <utils/generics/applicationlogger.h>
+#include <utils/ioutils.h>
+
+#include <fs/surface.h>
+#include <fs/annotation.h>
+
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+#include <QTemporaryDir>
+
+//=============================================================================================================
+// EIGEN INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace FSLIB;
+using namespace UTILSLIB;
+using namespace Eigen;
+
+//=============================================================================================================
+/**
+ * DECLARE CLASS TestFsIo
+ *
+ * @brief The TestFsIo class tests the block reading surface, curvature and annotation readers against reading
+ *        the files value by value
+ *
+ */
+class TestFsIo : public QObject
+{
+    Q_OBJECT
+
+public:
+    TestFsIo();
+
+private slots:
+    void initTestCase();
+    void compareSwapMany();
+    void compareFread3Many();
+    void checkFreadBlock();
+    void compareTriangleSurface();
+    void compareQuadSurface_data();
+    void compareQuadSurface();
+    void compareAnnotation();
+    void checkTruncatedFiles();
+    void cleanupTestCase();
+
+private:
+    bool readSurfaceReference(const QString& sFile, MatrixX3f& matRR, MatrixX3i& matTris);
+    VectorXf readCurvReference(const QString& sFile);
+    bool readAnnotationReference(const QString& sFile, VectorXi& vecVertices, VectorXi& vecLabelIds);
+    void writeTruncated(const QString& sFrom, const QString& sTo, qint64 size);
+    void write3(QDataStream& stream, qint32 value);
+
+    QString         m_sSubjectDir;
+    QTemporaryDir   m_tmpDir;
+};
+
+//=============================================================================================================
+
+TestFsIo::TestFsIo()
+{
+}
+
+//=============================================================================================================
+
+void TestFsIo::initTestCase()
+{
+    qInstallMessageHandler(UTILSLIB::ApplicationLogger::customLogWriter);
+
+    m_sSubjectDir = QCoreApplication::applicationDirPath() + "/mne-cpp-test-data/subjects/sample";
+    QVERIFY(QFile::exists(m_sSubjectDir + "/surf/lh.white"));
+    QVERIFY(QFile::exists(m_sSubjectDir + "/surf/lh.curv"));
+    QVERIFY(QFile::exists(m_sSubjectDir + "/label/lh.aparc.annot"));
+    QVERIFY(m_tmpDir.isValid());
+}
+
+//=============================================================================================================
+
+bool TestFsIo::readSurfaceReference(const QString& sFile, MatrixX3f& matRR, MatrixX3i& matTris)
+{
+    // Reads the surface one value at a time
+    QFile file(sFile);
+    if(!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream stream(&file);
+    stream.setByteOrder(QDataStream::BigEndian);
+    stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+    qint32 magic = IOUtils::fread3(stream);
+    qint32 nvert, nface = 0;
+
+    if(magic == 16777215 || magic == 16777213) {
+        nvert = IOUtils::fread3(stream);
+        qint32 nquad = IOUtils::fread3(stream);
+
+        matRR.resize(nvert,3);
+        for(qint32 i = 0; i < nvert; ++i) {
+            for(qint32 j = 0; j < 3; ++j) {
+                if(magic == 16777215) {
+                    qint16 iVal;
+                    stream >> iVal;
+                    matRR(i,j) = ((float)iVal) / 100;
+                } else {
+                    stream >> matRR(i,j);
+                }
+            }
+        }
+
+        matTris.resize(2*nquad,3);
+        for(qint32 k = 0; k < nquad; ++k) {
+            qint32 quad[4];
+            for(qint32 j = 0; j < 4; ++j)
+                quad[j] = IOUtils::fread3(stream);
+
+            if((quad[0] % 2) == 0) {
+                matTris.row(nface++) << quad[0], quad[1], quad[3];
+                matTris.row(nface++) << quad[2], quad[3], quad[1];
+            } else {
+                matTris.row(nface++) << quad[0], quad[1], quad[2];
+                matTris.row(nface++) << quad[0], quad[2], quad[3];
+            }
+        }
+    } else if(magic == 16777214) {
+        file.readLine();
+        file.readLine();
+
+        stream >> nvert;
+        stream >> nface;
+
+        matRR.resize(nvert,3);
+        for(qint32 i = 0; i < nvert; ++i)
+            for(qint32 j = 0; j < 3; ++j)
+                stream >> matRR(i,j);
+
+        matTris.resize(nface,3);
+        for(qint32 i = 0; i < nface; ++i)
+            for(qint32 j = 0; j < 3; ++j)
+                stream >> matTris(i,j);
+    } else {
+        return false;
+    }
+
+    matRR.array() *= 0.001f;
+
+    return stream.status() == QDataStream::Ok;
+}
+
+//=============================================================================================================
+
+VectorXf TestFsIo::readCurvReference(const QString& sFile)
+{
+    VectorXf vecCurv;
+
+    QFile file(sFile);
+    if(!file.open(QIODevice::ReadOnly))
+        return vecCurv;
+
+    QDataStream stream(&file);
+    stream.setByteOrder(QDataStream::BigEndian);
+    stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+    qint32 vnum = IOUtils::fread3(stream);
+    if(vnum == 16777215) {
+        qint32 fnum, vals_per_vertex;
+        stream >> vnum >> fnum >> vals_per_vertex;
+
+        vecCurv.resize(vnum);
+        for(qint32 i = 0; i < vnum; ++i)
+            stream >> vecCurv(i);
+    } else {
+        IOUtils::fread3(stream);
+
+        vecCurv.resize(vnum);
+        for(qint32 i = 0; i < vnum; ++i) {
+            qint16 iVal;
+            stream >> iVal;
+            vecCurv(i) = ((float)iVal) / 100;
+        }
+    }
+
+    return vecCurv;
+}
+
+//=============================================================================================================
+
+bool TestFsIo::readAnnotationReference(const QString& sFile, VectorXi& vecVertices, VectorXi& vecLabelIds)
+{
+    QFile file(sFile);
+    if(!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream stream(&file);
+    stream.setByteOrder(QDataStream::BigEndian);
+
+    qint32 numEl;
+    stream >> numEl;
+
+    vecVertices.resize(numEl);
+    vecLabelIds.resize(numEl);
+    for(qint32 i = 0; i < numEl; ++i) {
+        stream >> vecVertices[i];
+        stream >> vecLabelIds[i];
+    }
+
+    return stream.status() == QDataStream::Ok;
+}
+
+//=============================================================================================================
+
+void TestFsIo::writeTruncated(const QString& sFrom, const QString& sTo, qint64 size)
+{
+    QFile from(sFrom);
+    QVERIFY(from.open(QIODevice::ReadOnly));
+    QByteArray data = from.read(size);
+    QCOMPARE(qint64(data.size()), size);
+
+    QFile to(sTo);
+    QVERIFY(to.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    QCOMPARE(to.write(data), size);
+}
+
+//=============================================================================================================
+
+void TestFsIo::write3(QDataStream& stream, qint32 value)
+{
+    stream << quint8((value >> 16) & 0xff) << quint8((value >> 8) & 0xff) << quint8(value & 0xff);
+}
+
+//=============================================================================================================
+
+void TestFsIo::compareSwapMany()
+{
+    // Interleaved big endian triplets, decoded column by column with a stride
+    const qint64 count = 1001;
+    QByteArray shorts, ints, floats;
+    {
+        QDataStream s(&shorts, QIODevice::WriteOnly);
+        QDataStream i(&ints, QIODevice::WriteOnly);
+        QDataStream f(&floats, QIODevice::WriteOnly);
+        s.setByteOrder(QDataStream::BigEndian);
+        i.setByteOrder(QDataStream::BigEndian);
+        f.setByteOrder(QDataStream::BigEndian);
+        f.setFloatingPointPrecision(QDataStream::SinglePrecision);
+        for(qint64 k = 0; k < 3*count; ++k) {
+            s << qint16((k * 7919) % 65536 - 32768);
+            i << qint32(k * 2654435761u);
+            f << float((k - 1500) * 0.37f);
+        }
+    }
+
+    for(qint32 j = 0; j < 3; ++j) {
+        Matrix<qint16, Dynamic, 1> vecShorts(count);
+        VectorXi vecInts(count);
+        VectorXf vecFloats(count);
+        IOUtils::swap_short_many(shorts.constData() + j*sizeof(qint16), vecShorts.data(), count, 3);
+        IOUtils::swap_int_many(ints.constData() + j*sizeof(qint32), vecInts.data(), count, 3);
+        IOUtils::swap_float_many(floats.constData() + j*sizeof(float), vecFloats.data(), count, 3);
+
+        for(qint64 k = 0; k < count; ++k) {
+            qint64 idx = 3*k + j;
+            QCOMPARE(vecShorts[k], qint16((idx * 7919) % 65536 - 32768));
+            QCOMPARE(vecInts[k], qint32(idx * 2654435761u));
+            QCOMPARE(vecFloats[k], float((idx - 1500) * 0.37f));
+        }
+    }
+
+    // Contiguous decoding
+    VectorXi vecInts(3*count);
+    IOUtils::swap_int_many(ints.constData(), vecInts.data(), 3*count);
+    for(qint64 k = 0; k < 3*count; ++k) {
+        QCOMPARE(vecInts[k], qint32(k * 2654435761u));
+    }
+}
+
+//=============================================================================================================
+
+void TestFsIo::compareFread3Many()
+{
+    const qint32 count = 4096;
+    QByteArray data;
+    {
+        QDataStream stream(&data, QIODevice::WriteOnly);
+        for(qint32 k = 0; k < count; ++k)
+            write3(stream, (k * 40503) & 0xffffff);
+    }
+
+    QDataStream stream(data);
+    VectorXi vecStream = IOUtils::fread3_many(stream, count);
+    VectorXi vecBuffer = IOUtils::fread3_many(data.constData(), count);
+
+    QVERIFY(vecStream == vecBuffer);
+    for(qint32 k = 0; k < count; ++k) {
+        QCOMPARE(vecBuffer[k], (k * 40503) & 0xffffff);
+    }
+}
+
+//=============================================================================================================
+
+void TestFsIo::checkFreadBlock()
+{
+    QByteArray data(100, 'x');
+    QByteArray buffer;
+
+    QDataStream stream(data);
+    QVERIFY(IOUtils::fread_block(stream, buffer, 60));
+    QCOMPARE(buffer.size(), 60);
+    QVERIFY(!IOUtils::fread_block(stream, buffer, -1));
+    QVERIFY(!IOUtils::fread_block(stream, buffer, 41));
+}
+
+//=============================================================================================================
+
+void TestFsIo::compareTriangleSurface()
+{
+    QString sFile = m_sSubjectDir + "/surf/lh.white";
+
+    Surface surf;
+    QVERIFY(Surface::read(sFile, surf, true));
+
+    MatrixX3f matRR;
+    MatrixX3i matTris;
+    QVERIFY(readSurfaceReference(sFile, matRR, matTris));
+    VectorXf vecCurv = readCurvReference(m_sSubjectDir + "/surf/lh.curv");
+
+    QVERIFY(matRR.rows() > 0);
+    QVERIFY(surf.rr() == matRR);
+    QVERIFY(surf.tris() == matTris);
+    QCOMPARE(surf.curv().size(), matRR.rows());
+    QVERIFY(surf.curv() == vecCurv);
+    QCOMPARE(surf.hemi(), 0);
+}
+
+//=============================================================================================================
+
+void TestFsIo::compareQuadSurface_data()
+{
+    QTest::addColumn<qint32>("magic");
+
+    QTest::newRow("quad") << 16777215;
+    QTest::newRow("new quad") << 16777213;
+}
+
+//=============================================================================================================
+
+void TestFsIo::compareQuadSurface()
+{
+    QFETCH(qint32, magic);
+
+    // A small quad grid, the sample subject only comes with triangle files
+    const qint32 nx = 13, ny = 9;
+    qint32 nvert = nx*ny;
+    qint32 nquad = (nx-1)*(ny-1);
+
+    QString sFile = m_tmpDir.path() + QString("/lh.quad%1").arg(magic);
+    {
+        QFile file(sFile);
+        QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+        QDataStream stream(&file);
+        stream.setByteOrder(QDataStream::BigEndian);
+        stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+        write3(stream, magic);
+        write3(stream, nvert);
+        write3(stream, nquad);
+        for(qint32 k = 0; k < nvert; ++k) {
+            float pos[3] = { 1.25f * (k % nx) - 7.0f, 0.75f * (k / nx) - 3.0f, 0.01f * k };
+            for(qint32 j = 0; j < 3; ++j) {
+                if(magic == 16777215)
+                    stream << qint16(qRound(pos[j] * 100));
+                else
+                    stream << pos[j];
+            }
+        }
+        for(qint32 y = 0; y < ny-1; ++y) {
+            for(qint32 x = 0; x < nx-1; ++x) {
+                write3(stream, y*nx + x);
+                write3(stream, y*nx + x + 1);
+                write3(stream, (y+1)*nx + x + 1);
+                write3(stream, (y+1)*nx + x);
+            }
+        }
+    }
+
+    Surface surf;
+    QVERIFY(Surface::read(sFile, surf, false));
+
+    MatrixX3f matRR;
+    MatrixX3i matTris;
+    QVERIFY(readSurfaceReference(sFile, matRR, matTris));
+
+    QCOMPARE(int(surf.rr().rows()), nvert);
+    QCOMPARE(int(surf.tris().rows()), 2*nquad);
+    QVERIFY(surf.rr() == matRR);
+    QVERIFY(surf.tris() == matTris);
+}
+
+//=============================================================================================================
+
+void TestFsIo::compareAnnotation()
+{
+    QString sFile = m_sSubjectDir + "/label/lh.aparc.annot";
+
+    Annotation annot;
+    QVERIFY(Annotation::read(sFile, annot));
+
+    VectorXi vecVertices, vecLabelIds;
+    QVERIFY(readAnnotationReference(sFile, vecVertices, vecLabelIds));
+
+    QVERIFY(vecVertices.size() > 0);
+    QVERIFY(annot.getVertices() == vecVertices);
+    QVERIFY(annot.getLabelIds() == vecLabelIds);
+    QVERIFY(annot.getColortable().numEntries > 0);
+    QCOMPARE(int(annot.getColortable().table.rows()), annot.getColortable().numEntries);
+}
+
+//=============================================================================================================
+
+void TestFsIo::checkTruncatedFiles()
+{
+    // Surface cut within the vertices and within the faces
+    QString sSurf = m_sSubjectDir + "/surf/lh.white";
+    qint64 surfSize = QFileInfo(sSurf).size();
+    QString sTruncSurf = m_tmpDir.path() + "/lh.truncated";
+    Surface surf;
+
+    writeTruncated(sSurf, sTruncSurf, surfSize / 4);
+    QVERIFY(!Surface::read(sTruncSurf, surf, false));
+    writeTruncated(sSurf, sTruncSurf, surfSize - 1);
+    QVERIFY(!Surface::read(sTruncSurf, surf, false));
+
+    // Curvature cut within the values
+    QString sCurv = m_sSubjectDir + "/surf/lh.curv";
+    QString sTruncCurv = m_tmpDir.path() + "/lh.curv";
+    writeTruncated(sCurv, sTruncCurv, QFileInfo(sCurv).size() / 2);
+    QVERIFY(Surface::read_curv(sTruncCurv).size() == 0);
+
+    // Annotation cut within the vertex label pairs and within the colortable
+    QString sAnnot = m_sSubjectDir + "/label/lh.aparc.annot";
+    qint64 annotSize = QFileInfo(sAnnot).size();
+    QString sTruncAnnot = m_tmpDir.path() + "/lh.truncated.annot";
+    Annotation annot;
+
+    writeTruncated(sAnnot, sTruncAnnot, annotSize / 2);
+    QVERIFY(!Annotation::read(sTruncAnnot, annot));
+    writeTruncated(sAnnot, sTruncAnnot, annotSize - 1);
+    QVERIFY(!Annotation::read(sTruncAnnot, annot));
+}
+
+//=============================================================================================================
+
+void TestFsIo::cleanupTestCase()
+{
+}
+
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_GUILESS_MAIN(TestFsIo)
+#include "test_fs_io.moc"
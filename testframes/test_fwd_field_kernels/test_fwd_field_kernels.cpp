@@ -0,0 +1,418 @@
+//=============================================================================================================
+/**
+ * @file     test_fwd_field_kernels.cpp
+ * @author   MNE-CPP authors
+ * @since    0.1.8
+ * @date     October, 2026
+ *
+ * @section  LICENSE
+ *
+ * Copyright (C) 2026, MNE-CPP authors. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ * the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+ *       following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ *       the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+ *       to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * @brief    Test for the batched structure-of-arrays forward field kernels.
+ *
+ */
+
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <fwd/fwd_coil.h>
+#include <fwd/fwd_coil_set.h>
+#include <fwd/fwd_coil_set_soa.h>
+#include <fwd/fwd_bem_model.h>
+
+#include <fiff/fiff_constants.h>
+
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+
+//=============================================================================================================
+// EIGEN INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace FWDLIB;
+using namespace Eigen;
+
+//=============================================================================================================
+/**
+ * DECLARE CLASS TestFwdFieldKernels
+ *
+ * @brief The TestFwdFieldKernels class compares the batched kernels of FwdCoilSetSoA with the per-dipole kernels
+ *
+ */
+class TestFwdFieldKernels: public QObject
+{
+    Q_OBJECT
+
+public:
+    TestFwdFieldKernels();
+
+private slots:
+    void initTestCase();
+    void compareSphereField();
+    void compareSphereFieldVec();
+    void compareSphereFieldGrad();
+    void compareMagDipoleField();
+    void compareMixedCoilSet();
+    void compareBemInfField();
+    void compareBemField();
+    void cleanupTestCase();
+
+private:
+    double relDiff(const MatrixXf& matTest, const MatrixXf& matRef) const;
+
+    double          m_dEpsilon;
+    FwdCoilSet*     m_pCoils;
+    FwdCoilSetSoA   m_coilsSoA;
+    MatrixX3f       m_matRd;
+    MatrixX3f       m_matQ;
+    float           m_r0[3];
+};
+
+//=============================================================================================================
+
+TestFwdFieldKernels::TestFwdFieldKernels()
+: m_dEpsilon(1e-4)
+, m_pCoils(Q_NULLPTR)
+{
+}
+
+//=============================================================================================================
+
+void TestFwdFieldKernels::initTestCase()
+{
+    // Planar gradiometer-like coils with four integration points on a helmet-like sphere
+    const int iNCoil = 102;
+    const float fRad = 0.12f;
+    const float fOff = 0.008f;
+
+    m_pCoils = new FwdCoilSet();
+    m_pCoils->coils = (FwdCoil**)malloc(iNCoil*sizeof(FwdCoil*));
+    m_pCoils->ncoil = iNCoil;
+
+    for(int k = 0; k < iNCoil; ++k) {
+        float theta = 0.1f + 1.4f*(k/12)/8.0f;
+        float phi = 2.0f*float(M_PI)*(k%12)/12.0f + 0.1f*k;
+        Vector3f vecEz(std::sin(theta)*std::cos(phi), std::sin(theta)*std::sin(phi), std::cos(theta));
+        Vector3f vecEx = vecEz.unitOrthogonal();
+        Vector3f vecEy = vecEz.cross(vecEx);
+
+        FwdCoil* pCoil = new FwdCoil(4);
+        pCoil->coil_class = FWD_COILC_PLANAR_GRAD;
+        pCoil->type = FIFFV_COIL_VV_PLANAR_T1;
+        for(int p = 0; p < 4; ++p) {
+            Vector3f vecR = fRad*vecEz + fOff*((p%2 == 0 ? 1.0f : -1.0f)*vecEx + (p < 2 ? 0.5f : -0.5f)*vecEy);
+            for(int c = 0; c < 3; ++c) {
+                pCoil->rmag[p][c] = vecR[c];
+                pCoil->cosmag[p][c] = vecEz[c];
+            }
+            pCoil->w[p] = (p%2 == 0 ? 1.0f : -1.0f)/(2.0f*fOff);
+        }
+        m_pCoils->coils[k] = pCoil;
+    }
+    m_coilsSoA.set_coils(*m_pCoils);
+
+    m_r0[0] = 0.0f;
+    m_r0[1] = 0.0f;
+    m_r0[2] = 0.04f;
+
+    // Dipoles inside the sphere, including one at the origin of the sphere model
+    const int iNDip = 50;
+    m_matRd.resize(iNDip,3);
+    m_matQ.resize(iNDip,3);
+    for(int d = 0; d < iNDip; ++d) {
+        m_matRd(d,0) = 0.06f*std::sin(0.7f*d);
+        m_matRd(d,1) = 0.06f*std::cos(1.3f*d);
+        m_matRd(d,2) = 0.04f + 0.03f*std::sin(0.3f*d);
+        m_matQ(d,0) = 1e-8f*std::cos(0.5f*d);
+        m_matQ(d,1) = 1e-8f*std::sin(0.9f*d);
+        m_matQ(d,2) = 1e-8f*std::cos(1.7f*d);
+    }
+    m_matRd.row(0) << m_r0[0], m_r0[1], m_r0[2];
+
+    QCOMPARE(m_coilsSoA.ncoil(), iNCoil);
+    QCOMPARE(m_coilsSoA.npoint(), 4*iNCoil);
+}
+
+//=============================================================================================================
+
+void TestFwdFieldKernels::compareSphereField()
+{
+    MatrixXf matRef(m_pCoils->ncoil,m_matRd.rows());
+    for(int d = 0; d < m_matRd.rows(); ++d) {
+        Vector3f rd = m_matRd.row(d).transpose();
+        Vector3f Q = m_matQ.row(d).transpose();
+        FwdBemModel::fwd_sphere_field(rd.data(),Q.data(),m_pCoils,matRef.col(d).data(),m_r0);
+    }
+
+    MatrixXf matTest;
+    m_coilsSoA.sphere_field(m_matRd,m_matQ,m_r0,matTest);
+
+    QVERIFY(relDiff(matTest,matRef) < m_dEpsilon);
+}
+
+//=============================================================================================================
+
+void TestFwdFieldKernels::compareSphereFieldVec()
+{
+    MatrixXf matRef(m_pCoils->ncoil,3*m_matRd.rows());
+    float* Bval[3];
+    for(int d = 0; d < m_matRd.rows(); ++d) {
+        Vector3f rd = m_matRd.row(d).transpose();
+        Matrix<float,Dynamic,Dynamic,RowMajor> matOne(3,m_pCoils->ncoil);
+        for(int p = 0; p < 3; ++p) {
+            Bval[p] = matOne.row(p).data();
+        }
+        FwdBemModel::fwd_sphere_field_vec(rd.data(),m_pCoils,Bval,m_r0);
+        matRef.middleCols(3*d,3) = matOne.transpose();
+    }
+
+    MatrixXf matTest;
+    m_coilsSoA.sphere_field_vec(m_matRd,m_r0,matTest);
+
+    QVERIFY(relDiff(matTest,matRef) < m_dEpsilon);
+}
+
+//=============================================================================================================
+
+void TestFwdFieldKernels::compareSphereFieldGrad()
+{
+    const int iNDip = m_matRd.rows();
+    MatrixXf matRef(m_pCoils->ncoil,iNDip), matRefX(m_pCoils->ncoil,iNDip);
+    MatrixXf matRefY(m_pCoils->ncoil,iNDip), matRefZ(m_pCoils->ncoil,iNDip);
+    for(int d = 0; d < iNDip; ++d) {
+        Vector3f rd = m_matRd.row(d).transpose();
+        Vector3f Q = m_matQ.row(d).transpose();
+        FwdBemModel::fwd_sphere_field_grad(rd.data(),Q.data(),m_pCoils,
+                                           matRef.col(d).data(),
+                                           matRefX.col(d).data(),
+                                           matRefY.col(d).data(),
+                                           matRefZ.col(d).data(),
+                                           m_r0);
+    }
+
+    MatrixXf matTest, matTestX, matTestY, matTestZ;
+    m_coilsSoA.sphere_field_grad(m_matRd,m_matQ,m_r0,matTest,matTestX,matTestY,matTestZ);
+
+    QVERIFY(relDiff(matTest,matRef) < m_dEpsilon);
+    QVERIFY(relDiff(matTestX,matRefX) < m_dEpsilon);
+    QVERIFY(relDiff(matTestY,matRefY) < m_dEpsilon);
+    QVERIFY(relDiff(matTestZ,matRefZ) < m_dEpsilon);
+}
+
+//=============================================================================================================
+
+void TestFwdFieldKernels::compareMagDipoleField()
+{
+    const int iNDip = m_matRd.rows();
+    MatrixXf matRef(m_pCoils->ncoil,iNDip);
+    MatrixXf matRefVec(m_pCoils->ncoil,3*iNDip);
+    float* Bval[3];
+    for(int d = 0; d < iNDip; ++d) {
+        Vector3f rm = m_matRd.row(d).transpose();
+        Vector3f M = m_matQ.row(d).transpose();
+        FwdBemModel::fwd_mag_dipole_field(rm.data(),M.data(),m_pCoils,matRef.col(d).data(),Q_NULLPTR);
+
+        Matrix<float,Dynamic,Dynamic,RowMajor> matOne(3,m_pCoils->ncoil);
+        for(int p = 0; p < 3; ++p) {
+            Bval[p] = matOne.row(p).data();
+        }
+        FwdBemModel::fwd_mag_dipole_field_vec(rm.data(),m_pCoils,Bval,Q_NULLPTR);
+        matRefVec.middleCols(3*d,3) = matOne.transpose();
+    }
+
+    MatrixXf matTest, matTestVec;
+    m_coilsSoA.mag_dipole_field(m_matRd,m_matQ,matTest);
+    m_coilsSoA.mag_dipole_field_vec(m_matRd,matTestVec);
+
+    QVERIFY(relDiff(matTest,matRef) < m_dEpsilon);
+    QVERIFY(relDiff(matTestVec,matRefVec) < m_dEpsilon);
+}
+
+//=============================================================================================================
+
+void TestFwdFieldKernels::compareMixedCoilSet()
+{
+    // Every third entry is an EEG electrode, the others are copies of the MEG coils
+    const int iNCoil = m_pCoils->ncoil + m_pCoils->ncoil/2;
+    FwdCoilSet mixedCoils;
+    mixedCoils.coils = (FwdCoil**)malloc(iNCoil*sizeof(FwdCoil*));
+    mixedCoils.ncoil = iNCoil;
+
+    QVector<int> vecMegRows;
+    for(int k = 0, m = 0; k < iNCoil; ++k) {
+        if(k%3 == 2) {
+            FwdCoil* pEl = new FwdCoil(1);
+            pEl->coil_class = FWD_COILC_EEG;
+            pEl->type = FIFFV_COIL_EEG;
+            for(int c = 0; c < 3; ++c) {
+                pEl->rmag[0][c] = pEl->cosmag[0][c] = m_pCoils->coils[k%m_pCoils->ncoil]->cosmag[0][c];
+            }
+            pEl->w[0] = 1.0f;
+            mixedCoils.coils[k] = pEl;
+        } else {
+            mixedCoils.coils[k] = new FwdCoil(*m_pCoils->coils[m++]);
+            vecMegRows.append(k);
+        }
+    }
+    QCOMPARE(vecMegRows.size(), m_pCoils->ncoil);
+
+    FwdCoilSetSoA mixedSoA(mixedCoils);
+    QCOMPARE(mixedSoA.ncoil(), iNCoil);
+    QCOMPARE(mixedSoA.npoint(), m_coilsSoA.npoint());
+
+    // The MEG rows match the MEG only coil set, the EEG rows keep their previous values
+    const int iNDip = m_matRd.rows();
+    const float fUntouched = 7.0f;
+    auto compareRows = [&](const MatrixXf& matMixed, const MatrixXf& matMeg) {
+        MatrixXf matMegRows(vecMegRows.size(),matMixed.cols());
+        for(int i = 0; i < vecMegRows.size(); ++i) {
+            matMegRows.row(i) = matMixed.row(vecMegRows[i]);
+        }
+        int iNumUntouched = 0;
+        for(int k = 0; k < iNCoil; ++k) {
+            if(k%3 == 2) {
+                iNumUntouched += (matMixed.row(k).array() == fUntouched).count();
+            }
+        }
+        return matMegRows == matMeg && iNumUntouched == (iNCoil - vecMegRows.size())*matMixed.cols();
+    };
+
+    MatrixXf matMeg, matMegX, matMegY, matMegZ;
+    MatrixXf matMixed = MatrixXf::Constant(iNCoil,iNDip,fUntouched);
+    MatrixXf matMixedX = matMixed, matMixedY = matMixed, matMixedZ = matMixed;
+    MatrixXf matMixedVec = MatrixXf::Constant(iNCoil,3*iNDip,fUntouched);
+
+    m_coilsSoA.sphere_field(m_matRd,m_matQ,m_r0,matMeg);
+    mixedSoA.sphere_field(m_matRd,m_matQ,m_r0,matMixed);
+    QVERIFY(compareRows(matMixed,matMeg));
+
+    m_coilsSoA.sphere_field_vec(m_matRd,m_r0,matMeg);
+    mixedSoA.sphere_field_vec(m_matRd,m_r0,matMixedVec);
+    QVERIFY(compareRows(matMixedVec,matMeg));
+
+    matMixed.setConstant(fUntouched);
+    m_coilsSoA.sphere_field_grad(m_matRd,m_matQ,m_r0,matMeg,matMegX,matMegY,matMegZ);
+    mixedSoA.sphere_field_grad(m_matRd,m_matQ,m_r0,matMixed,matMixedX,matMixedY,matMixedZ);
+    QVERIFY(compareRows(matMixed,matMeg));
+    QVERIFY(compareRows(matMixedX,matMegX));
+    QVERIFY(compareRows(matMixedY,matMegY));
+    QVERIFY(compareRows(matMixedZ,matMegZ));
+
+    matMixed.setConstant(fUntouched);
+    m_coilsSoA.mag_dipole_field(m_matRd,m_matQ,matMeg);
+    mixedSoA.mag_dipole_field(m_matRd,m_matQ,matMixed);
+    QVERIFY(compareRows(matMixed,matMeg));
+
+    matMixedVec.setConstant(fUntouched);
+    m_coilsSoA.mag_dipole_field_vec(m_matRd,matMeg);
+    mixedSoA.mag_dipole_field_vec(m_matRd,matMixedVec);
+    QVERIFY(compareRows(matMixedVec,matMeg));
+}
+
+//=============================================================================================================
+
+void TestFwdFieldKernels::compareBemInfField()
+{
+    const int iNDip = m_matRd.rows();
+    MatrixXf matRef(m_pCoils->ncoil,iNDip);
+    for(int d = 0; d < iNDip; ++d) {
+        Vector3f rd = m_matRd.row(d).transpose();
+        Vector3f Q = m_matQ.row(d).transpose();
+        for(int k = 0; k < m_pCoils->ncoil; ++k) {
+            FwdCoil* pCoil = m_pCoils->coils[k];
+            matRef(k,d) = 0.0f;
+            for(int p = 0; p < pCoil->np; ++p) {
+                matRef(k,d) += pCoil->w[p]*FwdBemModel::fwd_bem_inf_field(rd.data(),Q.data(),pCoil->rmag[p],pCoil->cosmag[p]);
+            }
+        }
+    }
+
+    MatrixXf matTest;
+    m_coilsSoA.bem_inf_field(m_matRd,m_matQ,matTest);
+
+    QVERIFY(relDiff(matTest,matRef) < m_dEpsilon);
+}
+
+//=============================================================================================================
+
+void TestFwdFieldKernels::compareBemField()
+{
+    // Homogeneous model of the sample inner skull with its linear collocation solution
+    QString bemName(QCoreApplication::applicationDirPath() + "/mne-cpp-test-data/subjects/sample/bem/sample-5120-bem-sol.fif");
+    FwdBemModel* pBemModel = FwdBemModel::fwd_bem_load_homog_surface(bemName);
+    QVERIFY(pBemModel != Q_NULLPTR);
+    QVERIFY(FwdBemModel::fwd_bem_load_recompute_solution(bemName,FWD_BEM_UNKNOWN,false,pBemModel) == 0);
+    QVERIFY(FwdBemModel::fwd_bem_specify_coils(pBemModel,m_pCoils) == 0);
+
+    const int iNDip = m_matRd.rows();
+    MatrixXf matRef(m_pCoils->ncoil,iNDip);
+    for(int d = 0; d < iNDip; ++d) {
+        Vector3f rd = m_matRd.row(d).transpose();
+        Vector3f Q = m_matQ.row(d).transpose();
+        QVERIFY(FwdBemModel::fwd_bem_field(rd.data(),Q.data(),m_pCoils,matRef.col(d).data(),pBemModel) == 0);
+    }
+
+    MatrixXf matTest;
+    QVERIFY(FwdBemModel::fwd_bem_field_batch(m_matRd,m_matQ,m_pCoils,m_coilsSoA,matTest,pBemModel) == 0);
+
+    QVERIFY(relDiff(matTest,matRef) < m_dEpsilon);
+
+    delete pBemModel;
+}
+
+//=============================================================================================================
+
+void TestFwdFieldKernels::cleanupTestCase()
+{
+    delete m_pCoils;
+}
+
+//=============================================================================================================
+
+double TestFwdFieldKernels::relDiff(const MatrixXf& matTest, const MatrixXf& matRef) const
+{
+    if(matTest.rows() != matRef.rows() || matTest.cols() != matRef.cols()) {
+        return 1.0;
+    }
+    double dNorm = matRef.cast<double>().norm();
+    double dDiff = (matTest.cast<double>() - matRef.cast<double>()).norm();
+    qDebug() << "Relative difference:" << (dNorm > 0.0 ? dDiff/dNorm : dDiff);
+    return dNorm > 0.0 ? dDiff/dNorm : dDiff;
+}
+
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_GUILESS_MAIN(TestFwdFieldKernels)
+#include "test_fwd_field_kernels.moc"
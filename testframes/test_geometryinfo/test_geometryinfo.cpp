@@ -86,6 +86,7 @@ private slots:
     void testEmptyInputsForProjecting();
     void testEmptyInputsForSCDC();
     void testDimensionsForSCDC();
+    void testSparseSCDC();
     void cleanupTestCase();
 
 private:
@@ -204,6 +205,32 @@ void TestGeometryInfo::testDimensionsForSCDC() {
 
 //=============================================================================================================
 
+void TestGeometryInfo::testSparseSCDC() {
+    const double dCancelDist = 0.03;
+
+    QVector<int> vDenseSubset = vSmallSubset;
+    QVector<int> vSparseSubset = vSmallSubset;
+    QSharedPointer<MatrixXd> pDistTable = GeometryInfo::scdc(smallSurface.rr, smallSurface.neighbor_vert, vDenseSubset, dCancelDist);
+    QSharedPointer<SparseMatrix<double> > pSparseDistTable = GeometryInfo::scdcSparse(smallSurface.rr, smallSurface.neighbor_vert, vSparseSubset, dCancelDist);
+
+    QVERIFY(pSparseDistTable->rows() == pDistTable->rows());
+    QVERIFY(pSparseDistTable->cols() == pDistTable->cols());
+
+    // the sparse table holds exactly the distances up to the cancel distance
+    qint64 iBelowCancelCount = 0;
+    for (qint32 col = 0; col < pDistTable->cols(); ++col) {
+        for (qint32 row = 0; row < pDistTable->rows(); ++row) {
+            if (pDistTable->coeff(row, col) <= dCancelDist) {
+                QVERIFY(pSparseDistTable->coeff(row, col) == pDistTable->coeff(row, col));
+                iBelowCancelCount++;
+            }
+        }
+    }
+    QVERIFY(pSparseDistTable->nonZeros() == iBelowCancelCount);
+}
+
+//=============================================================================================================
+
 void TestGeometryInfo::cleanupTestCase() {
 }
 
@@ -48,6 +48,7 @@
 
 #include <inverse/hpiFit/hpifit.h>
 #include <inverse/hpiFit/hpifitdata.h>
+#include <inverse/hpiFit/hpilockin.h>
 
 #include <utils/ioutils.h>
 #include <utils/mnemath.h>
@@ -98,6 +99,8 @@ private slots:
     void compareMove();
     void compareDetect();
     void compareTime();
+    void compareLevenbergMarquardt();
+    void compareLockIn();
     void cleanupTestCase();
 
 private:
@@ -108,6 +111,9 @@ private:
     double dErrorDetect = 0;
     MatrixXd mRefPos;
     MatrixXd mHpiPos;
+    MatrixXd mHpiPosLM;
+    MatrixXd mHpiPosLockIn;
+    QVector<int> vNumIterationsLM;
     MatrixXd mRefResult;
     MatrixXd mHpiResult;
     QVector<int> vFreqs;
@@ -195,6 +201,23 @@ void TestHpiFit::initTestCase()
                   pFiffInfo);
     qInfo() << "[done]";
 
+    // Second fit with the warm-started Levenberg-Marquardt solver
+    HPIFit HPILM = HPIFit(pFiffInfo, true);
+    HPILM.setUseLevenbergMarquardt(true);
+    FiffCoordTrans transDevHeadLM = pFiffInfo->dev_head_t;
+    QVector<double> vErrorLM;
+    VectorXd vGoFLM;
+    FiffDigPointSet fittedPointSetLM;
+
+    // Third fit with the amplitudes from the streaming lock-in estimator
+    HPIFit HPILockInFit = HPIFit(pFiffInfo);
+    HPILockInFit.setUseLevenbergMarquardt(true);
+    FiffCoordTrans transDevHeadLockIn = pFiffInfo->dev_head_t;
+    QVector<double> vErrorLockIn;
+    VectorXd vGoFLockIn;
+    FiffDigPointSet fittedPointSetLockIn;
+    HPILockIn lockIn(pFiffInfo->sfreq, vFreqs, pFiffInfo->linefreq, quantum_sec);
+
     for(int i = 0; i < mRefPos.rows(); i++) {
         from = first + mRefPos(i,0)*pFiffInfo->sfreq;
         to = from + quantum;
@@ -226,6 +249,44 @@ void TestHpiFit::initTestCase()
         }
 
         HPIFit::storeHeadPosition(mRefPos(i,0), pFiffInfo->dev_head_t.trans, mHpiPos, vGoF, vError);
+
+        qInfo()  << "HPI-Fit Levenberg-Marquardt...";
+        HPILM.fitHPI(mData,
+                     mProjectors,
+                     transDevHeadLM,
+                     vFreqs,
+                     vErrorLM,
+                     vGoFLM,
+                     fittedPointSetLM,
+                     pFiffInfo,
+                     false,
+                     sHPIResourceDir,
+                     200,
+                     1e-5);
+        qInfo() << "[done] took" << HPILM.getLastFitDuration() << "ms";
+
+        HPIFit::storeHeadPosition(mRefPos(i,0), transDevHeadLM.trans, mHpiPosLM, vGoFLM, vErrorLM);
+        vNumIterationsLM += HPILM.getLastNumIterations();
+
+        // The segments are not contiguous, start a new estimate for each of them
+        qInfo()  << "HPI-Fit lock-in...";
+        lockIn.reset();
+        lockIn.append(mData);
+        HPILockInFit.fitHPIFromAmplitudes(lockIn.getAmplitudes(),
+                                          mProjectors,
+                                          transDevHeadLockIn,
+                                          vFreqs,
+                                          vErrorLockIn,
+                                          vGoFLockIn,
+                                          fittedPointSetLockIn,
+                                          pFiffInfo,
+                                          false,
+                                          sHPIResourceDir,
+                                          200,
+                                          1e-5);
+        qInfo() << "[done]";
+
+        HPIFit::storeHeadPosition(mRefPos(i,0), transDevHeadLockIn.trans, mHpiPosLockIn, vGoFLockIn, vErrorLockIn);
         mHpiResult(i,0) = devHeadT.translationTo(pFiffInfo->dev_head_t.trans);
         mHpiResult(i,1) = devHeadT.angleTo(pFiffInfo->dev_head_t.trans);
 
@@ -321,6 +382,43 @@ void TestHpiFit::compareTime()
 
 //=============================================================================================================
 
+void TestHpiFit::compareLevenbergMarquardt()
+{
+    RowVector3d vDiffTrans;
+    vDiffTrans(0) = (mRefPos.col(4)-mHpiPosLM.col(4)).mean();
+    vDiffTrans(1) = (mRefPos.col(5)-mHpiPosLM.col(5)).mean();
+    vDiffTrans(2) = (mRefPos.col(6)-mHpiPosLM.col(6)).mean();
+    qDebug() << "ErrorTrans LM x: " << std::abs(vDiffTrans(0));
+    qDebug() << "ErrorTrans LM y: " << std::abs(vDiffTrans(1));
+    qDebug() << "ErrorTrans LM z: " << std::abs(vDiffTrans(2));
+    QVERIFY(std::abs(vDiffTrans(0)) < dErrorTrans);
+    QVERIFY(std::abs(vDiffTrans(1)) < dErrorTrans);
+    QVERIFY(std::abs(vDiffTrans(2)) < dErrorTrans);
+
+    QVERIFY(!vNumIterationsLM.isEmpty());
+    for(int i = 0; i < vNumIterationsLM.size(); ++i) {
+        QVERIFY(vNumIterationsLM[i] > 0 && vNumIterationsLM[i] <= 200);
+    }
+}
+
+//=============================================================================================================
+
+void TestHpiFit::compareLockIn()
+{
+    RowVector3d vDiffTrans;
+    vDiffTrans(0) = (mRefPos.col(4)-mHpiPosLockIn.col(4)).mean();
+    vDiffTrans(1) = (mRefPos.col(5)-mHpiPosLockIn.col(5)).mean();
+    vDiffTrans(2) = (mRefPos.col(6)-mHpiPosLockIn.col(6)).mean();
+    qDebug() << "ErrorTrans lock-in x: " << std::abs(vDiffTrans(0));
+    qDebug() << "ErrorTrans lock-in y: " << std::abs(vDiffTrans(1));
+    qDebug() << "ErrorTrans lock-in z: " << std::abs(vDiffTrans(2));
+    QVERIFY(std::abs(vDiffTrans(0)) < dErrorTrans);
+    QVERIFY(std::abs(vDiffTrans(1)) < dErrorTrans);
+    QVERIFY(std::abs(vDiffTrans(2)) < dErrorTrans);
+}
+
+//=============================================================================================================
+
 void TestHpiFit::cleanupTestCase()
 {
 }
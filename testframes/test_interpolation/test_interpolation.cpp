@@ -85,6 +85,9 @@ private slots:
     void testDimensionsForInterpolation();
     void testSumOfRow();
     void testEmptyInputsForWeightMatrix();
+    void testSparseDistanceTable();
+    void testRenormalizeExcludedSensors();
+    void testExcludedSensorWeights();
     void cleanupTestCase();
 
 private:
@@ -248,6 +251,134 @@ void TestInterpolation::testEmptyInputsForWeightMatrix()
 
 //=============================================================================================================
 
+void TestInterpolation::testSparseDistanceTable()
+{
+    // projecting with MEG:
+    QVector<int> vMappedSubSet = GeometryInfo::projectSensors(realSurface.rr,
+                                                                vMegSensors);
+
+    // dense and bounded sparse SCDC with cancel distance 0.05 m:
+    QSharedPointer<MatrixXd> pDistanceMatrix = GeometryInfo::scdc(realSurface.rr,
+                                                 realSurface.neighbor_vert,
+                                                 vMappedSubSet,
+                                                 0.05);
+    QSharedPointer<SparseMatrix<double> > pSparseDistanceMatrix = GeometryInfo::scdcSparse(realSurface.rr,
+                                                                                          realSurface.neighbor_vert,
+                                                                                          vMappedSubSet,
+                                                                                          0.05);
+
+    // filtering of bad channel
+    QVector<int> vBads = GeometryInfo::filterBadChannels(pDistanceMatrix,
+                                                         evoked.info,
+                                                         FIFFV_MEG_CH);
+    QVERIFY(GeometryInfo::filterBadChannels(pSparseDistanceMatrix,
+                                            evoked.info,
+                                            FIFFV_MEG_CH) == vBads);
+
+    // weight matrix creation
+    QSharedPointer<SparseMatrix<float> > pW = Interpolation::createInterpolationMat(vMappedSubSet,
+                                                                                    pDistanceMatrix,
+                                                                                    Interpolation::cubic,
+                                                                                    0.05,
+                                                                                    vBads);
+    QSharedPointer<SparseMatrix<float> > pWSparse = Interpolation::createInterpolationMat(vMappedSubSet,
+                                                                                          pSparseDistanceMatrix,
+                                                                                          Interpolation::cubic,
+                                                                                          0.05,
+                                                                                          vBads);
+
+    QVERIFY(pW->nonZeros() == pWSparse->nonZeros());
+    QVERIFY((MatrixXf(*pW) - MatrixXf(*pWSparse)).cwiseAbs().maxCoeff() < 1e-6f);
+}
+
+//=============================================================================================================
+
+void TestInterpolation::testRenormalizeExcludedSensors()
+{
+    // projecting with MEG:
+    QVector<int> vMappedSubSet = GeometryInfo::projectSensors(realSurface.rr,
+                                                                vMegSensors);
+
+    // SCDC with cancel distance 0.05 m, the distances are kept for all channels
+    QSharedPointer<SparseMatrix<double> > pDistanceMatrix = GeometryInfo::scdcSparse(realSurface.rr,
+                                                                                    realSurface.neighbor_vert,
+                                                                                    vMappedSubSet,
+                                                                                    0.05);
+
+    QSharedPointer<SparseMatrix<float, RowMajor> > pWeights = Interpolation::createWeightMat(pDistanceMatrix,
+                                                                                             Interpolation::cubic,
+                                                                                             0.05);
+
+    // exclude a few channels and compare against a full rebuild
+    QVector<int> vExclude;
+    vExclude << 0 << 7 << vMappedSubSet.size() / 2;
+
+    QSharedPointer<SparseMatrix<float> > pW = Interpolation::normalizeWeightMat(vMappedSubSet,
+                                                                                pWeights,
+                                                                                vExclude);
+    QSharedPointer<SparseMatrix<float> > pWFull = Interpolation::createInterpolationMat(vMappedSubSet,
+                                                                                       pDistanceMatrix,
+                                                                                       Interpolation::cubic,
+                                                                                       0.05,
+                                                                                       vExclude);
+
+    QVERIFY(pW->nonZeros() == pWFull->nonZeros());
+    QVERIFY((MatrixXf(*pW) - MatrixXf(*pWFull)).cwiseAbs().maxCoeff() < 1e-6f);
+
+    // the excluded channels do not contribute anymore
+    for (int iExclude : vExclude) {
+        QVERIFY(pW->col(iExclude).nonZeros() == 0);
+    }
+
+    // including the channels again restores the original matrix
+    QSharedPointer<SparseMatrix<float> > pWAll = Interpolation::normalizeWeightMat(vMappedSubSet,
+                                                                                   pWeights);
+    QSharedPointer<SparseMatrix<float> > pWAllFull = Interpolation::createInterpolationMat(vMappedSubSet,
+                                                                                          pDistanceMatrix,
+                                                                                          Interpolation::cubic,
+                                                                                          0.05);
+    QVERIFY((MatrixXf(*pWAll) - MatrixXf(*pWAllFull)).cwiseAbs().maxCoeff() < 1e-6f);
+}
+
+//=============================================================================================================
+
+void TestInterpolation::testExcludedSensorWeights()
+{
+    // five vertices, the sensors 1 and 2 share vertex 1 and sensor 3 sits on vertex 3
+    QVector<int> vSensors;
+    vSensors << 0 << 1 << 1 << 3;
+
+    QSharedPointer<MatrixXd> pDistTable = QSharedPointer<MatrixXd>::create(5, 4);
+    *pDistTable << 0.0, 1.0, 1.0, 2.0,
+                   1.0, 0.0, 0.0, 1.0,
+                   2.0, 1.0, 1.0, 0.5,
+                   2.0, 1.0, 1.0, 0.0,
+                   4.0, 2.0, 2.0, 1.0;
+
+    QVector<int> vExclude;
+    vExclude << 1 << 3;
+
+    MatrixXf matW = MatrixXf(*Interpolation::createInterpolationMat(vSensors,
+                                                                    pDistTable,
+                                                                    Interpolation::linear,
+                                                                    3.0,
+                                                                    vExclude));
+
+    // the weights of excluded sensors are dropped and the rows are normalized over the remaining sensors
+    MatrixXf matExpected = MatrixXf::Zero(5, 4);
+    matExpected(0, 0) = 1.0f;               // sensor 0
+    matExpected(1, 2) = 1.0f;               // first sensor on vertex 1 which is not excluded
+    matExpected(2, 0) = 1.0f / 3.0f;
+    matExpected(2, 2) = 2.0f / 3.0f;
+    matExpected(3, 0) = 1.0f / 3.0f;        // the vertex of the excluded sensor 3 is interpolated
+    matExpected(3, 2) = 2.0f / 3.0f;
+    matExpected(4, 2) = 1.0f;               // sensor 0 is beyond the cancel distance
+
+    QVERIFY((matW - matExpected).cwiseAbs().maxCoeff() < 1e-6f);
+}
+
+//=============================================================================================================
+
 void TestInterpolation::cleanupTestCase()
 {
 }
@@ -0,0 +1,274 @@
+//=============================================================================================================
+/**
+ * @file     test_kmeans.cpp
+ * @author   MNE-CPP authors
+ * @since    0.1.8
+ * @date     October, 2026
+ *
+ * @section  LICENSE
+ *
+ * Copyright (C) 2026, MNE-CPP authors. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ * the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+ *       following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ *       the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+ *       to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ *
+ * @brief    Test for the k-means clustering.
+ *
+ */
+
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <utils/kmeans.h>
+
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+
+//=============================================================================================================
+// EIGEN INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+//=============================================================================================================
+// STL INCLUDES
+//=============================================================================================================
+
+#include <random>
+
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace UTILSLIB;
+using namespace Eigen;
+
+//=============================================================================================================
+/**
+ * DECLARE CLASS TestKMeans
+ *
+ * @brief The TestKMeans class tests the k-means clustering on well separated point clouds
+ *
+ */
+class TestKMeans: public QObject
+{
+    Q_OBJECT
+
+public:
+    TestKMeans();
+
+private slots:
+    void initTestCase();
+    void clusterBlobs_data();
+    void clusterBlobs();
+    void compareReplicates_data();
+    void compareReplicates();
+    void compareBoundedDense_data();
+    void compareBoundedDense();
+    void cleanupTestCase();
+
+private:
+    qint32      m_iNumBlobs;
+    qint32      m_iNumPoints;
+    MatrixXd    m_matX;
+};
+
+//=============================================================================================================
+
+TestKMeans::TestKMeans()
+: m_iNumBlobs(4)
+, m_iNumPoints(50)
+{
+}
+
+//=============================================================================================================
+
+void TestKMeans::initTestCase()
+{
+    // Point clouds of unit variance around centers which are 20 apart
+    std::mt19937 generator(42);
+    std::normal_distribution<double> normal(0.0, 1.0);
+
+    qint32 iDim = 6;
+    m_matX.resize(m_iNumBlobs * m_iNumPoints, iDim);
+    for(qint32 i = 0; i < m_iNumBlobs; ++i) {
+        for(qint32 j = 0; j < m_iNumPoints; ++j) {
+            for(qint32 d = 0; d < iDim; ++d) {
+                m_matX(i * m_iNumPoints + j, d) = normal(generator) + (d == i ? 20.0 : 0.0);
+            }
+        }
+    }
+}
+
+//=============================================================================================================
+
+void TestKMeans::clusterBlobs_data()
+{
+    QTest::addColumn<QString>("distance");
+    QTest::addColumn<QString>("start");
+
+    QTest::newRow("sqeuclidean plus") << QString("sqeuclidean") << QString("plus");
+    QTest::newRow("cityblock plus") << QString("cityblock") << QString("plus");
+    QTest::newRow("sqeuclidean sample") << QString("sqeuclidean") << QString("sample");
+    QTest::newRow("cityblock sample") << QString("cityblock") << QString("sample");
+}
+
+//=============================================================================================================
+
+void TestKMeans::clusterBlobs()
+{
+    QFETCH(QString, distance);
+    QFETCH(QString, start);
+
+    KMeans kMeans(distance, start, 5);
+    kMeans.setSeed(1);
+
+    VectorXi idx;
+    MatrixXd C;
+    VectorXd sumD;
+    MatrixXd D;
+    QVERIFY(kMeans.calculate(m_matX, m_iNumBlobs, idx, C, sumD, D));
+
+    // Every point cloud has to end up in its own cluster
+    QList<int> lClusters;
+    for(qint32 i = 0; i < m_iNumBlobs; ++i) {
+        qint32 iCluster = idx[i * m_iNumPoints];
+        for(qint32 j = 1; j < m_iNumPoints; ++j) {
+            QCOMPARE(idx[i * m_iNumPoints + j], iCluster);
+        }
+        QVERIFY(!lClusters.contains(iCluster));
+        lClusters.append(iCluster);
+    }
+
+    // The distances are the ones to the returned centroids
+    for(qint32 i = 0; i < m_matX.rows(); ++i) {
+        double dDist = distance == "sqeuclidean" ? (m_matX.row(i) - C.row(idx[i])).squaredNorm()
+                                                 : (m_matX.row(i) - C.row(idx[i])).cwiseAbs().sum();
+        QVERIFY(std::abs(D(i, idx[i]) - dDist) < 1e-9 * (1.0 + dDist));
+    }
+}
+
+//=============================================================================================================
+
+void TestKMeans::compareReplicates_data()
+{
+    QTest::addColumn<QString>("distance");
+
+    QTest::newRow("sqeuclidean") << QString("sqeuclidean");
+    QTest::newRow("cityblock") << QString("cityblock");
+}
+
+//=============================================================================================================
+
+void TestKMeans::compareReplicates()
+{
+    QFETCH(QString, distance);
+
+    // More clusters than point clouds, so the result depends on the seeding
+    qint32 k = 3 * m_iNumBlobs;
+
+    VectorXi idxSerial, idxParallel;
+    MatrixXd CSerial, CParallel, D;
+    VectorXd sumDSerial, sumDParallel;
+
+    KMeans kMeansSerial(distance, QString("plus"), 4);
+    kMeansSerial.setSeed(7);
+    QVERIFY(kMeansSerial.calculate(m_matX, k, idxSerial, CSerial, sumDSerial, D));
+
+    // Running the replicates concurrently must not change the result of a seeded clustering
+    KMeans kMeansParallel(distance, QString("plus"), 4);
+    kMeansParallel.setSeed(7);
+    kMeansParallel.setParallelReplicates(true);
+    QVERIFY(kMeansParallel.calculate(m_matX, k, idxParallel, CParallel, sumDParallel, D));
+
+    QVERIFY(idxSerial == idxParallel);
+    QVERIFY(CSerial == CParallel);
+    QVERIFY(sumDSerial == sumDParallel);
+}
+
+//=============================================================================================================
+
+void TestKMeans::compareBoundedDense_data()
+{
+    QTest::addColumn<QString>("distance");
+    QTest::addColumn<QString>("start");
+    QTest::addColumn<int>("k");
+
+    QTest::newRow("sqeuclidean sample 3") << QString("sqeuclidean") << QString("sample") << 3;
+    QTest::newRow("sqeuclidean plus 6") << QString("sqeuclidean") << QString("plus") << 6;
+    QTest::newRow("cityblock sample 3") << QString("cityblock") << QString("sample") << 3;
+    QTest::newRow("cityblock plus 6") << QString("cityblock") << QString("plus") << 6;
+}
+
+//=============================================================================================================
+
+void TestKMeans::compareBoundedDense()
+{
+    QFETCH(QString, distance);
+    QFETCH(QString, start);
+    QFETCH(int, k);
+
+    // Point clouds whose centers are only 1.5 apart, so that many points change clusters during the iterations
+    std::mt19937 generator(42);
+    std::normal_distribution<double> normal(0.0, 1.0);
+
+    qint32 iNumBlobs = 3;
+    qint32 iDim = 4;
+    MatrixXd matX(iNumBlobs * 100, iDim);
+    for(qint32 i = 0; i < matX.rows(); ++i) {
+        for(qint32 d = 0; d < iDim; ++d) {
+            matX(i, d) = normal(generator) + (d == i / 100 ? 1.5 : 0.0);
+        }
+    }
+
+    VectorXi idxBounded, idxDense;
+    MatrixXd CBounded, CDense, D;
+    VectorXd sumDBounded, sumDDense;
+
+    KMeans kMeansBounded(distance, start, 1);
+    kMeansBounded.setSeed(3);
+    QVERIFY(kMeansBounded.calculate(matX, k, idxBounded, CBounded, sumDBounded, D));
+
+    // Skipping distance computations by the bounds must not change the clustering
+    KMeans kMeansDense(distance, start, 1);
+    kMeansDense.setSeed(3);
+    kMeansDense.setBoundedUpdate(false);
+    QVERIFY(kMeansDense.calculate(matX, k, idxDense, CDense, sumDDense, D));
+
+    QVERIFY(idxBounded == idxDense);
+    QVERIFY(CBounded == CDense);
+}
+
+//=============================================================================================================
+
+void TestKMeans::cleanupTestCase()
+{
+}
+
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_GUILESS_MAIN(TestKMeans)
+#include "test_kmeans.moc"
@@ -0,0 +1,237 @@
+//=============================================================================================================
+/**
+ * @file     test_meshlod.cpp
+ * @author   MNE-CPP authors
+ * @since    0.1.8
+ * @date     October, 2026
+ *
+ * @section  LICENSE
+ *
+ * Copyright (C) 2026, MNE-CPP authors. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ * the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+ *       following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ *       the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+ *       to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * @brief    test_meshlod class definition.
+ *
+ */
+
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <disp3D/helpers/meshlod/meshlod.h>
+#include <fs/surface.h>
+
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace DISP3DLIB;
+using namespace FSLIB;
+using namespace Eigen;
+
+//=============================================================================================================
+/**
+ * DECLARE CLASS TestMeshLod
+ *
+ * @brief The TestMeshLod class provides basic verification tests
+ *
+ */
+class TestMeshLod: public QObject
+{
+    Q_OBJECT
+
+public:
+    TestMeshLod();
+
+private slots:
+    void initTestCase();
+    void testFullResolutionLevel();
+    void testVertexCorrespondence();
+    void testTriangles();
+    void testNeighbors();
+    void testLevelForViewport();
+    void testMapping();
+    void cleanupTestCase();
+
+private:
+    Surface         realSurface;
+    MeshLod         meshLod;
+};
+
+//=============================================================================================================
+
+TestMeshLod::TestMeshLod() {
+}
+
+//=============================================================================================================
+
+void TestMeshLod::initTestCase() {
+    //acquire a full resolution surface, coarse surfaces like the BEM ones are not decimated at all
+    QVERIFY(Surface::read(QCoreApplication::applicationDirPath() + "/mne-cpp-test-data/subjects/sample/surf/lh.white", realSurface, false));
+
+    meshLod = MeshLod(realSurface.rr(),
+                      realSurface.nn(),
+                      realSurface.tris(),
+                      4);
+
+    QVERIFY(meshLod.numLevels() > 1);
+    QVERIFY(meshLod.numLevels() <= 4);
+}
+
+//=============================================================================================================
+
+void TestMeshLod::testFullResolutionLevel() {
+    const MeshLodLevel& fullLevel = meshLod.level(0);
+
+    QVERIFY(fullLevel.matVertices == realSurface.rr());
+    QVERIFY(fullLevel.matTris == realSurface.tris());
+    QVERIFY(fullLevel.vecLodToFull == VectorXi::LinSpaced(realSurface.rr().rows(), 0, realSurface.rr().rows() - 1));
+    QVERIFY(fullLevel.vecFullToLod == fullLevel.vecLodToFull);
+
+    // every further level has less vertices than the previous one
+    for(int i = 1; i < meshLod.numLevels(); ++i) {
+        QVERIFY(meshLod.level(i).matVertices.rows() < meshLod.level(i-1).matVertices.rows());
+    }
+}
+
+//=============================================================================================================
+
+void TestMeshLod::testVertexCorrespondence() {
+    for(int i = 0; i < meshLod.numLevels(); ++i) {
+        const MeshLodLevel& lodLevel = meshLod.level(i);
+
+        QVERIFY(lodLevel.vecLodToFull.rows() == lodLevel.matVertices.rows());
+        QVERIFY(lodLevel.vecFullToLod.rows() == realSurface.rr().rows());
+
+        // every vertex of a level is a full resolution vertex which represents itself
+        for(int v = 0; v < lodLevel.vecLodToFull.rows(); ++v) {
+            int iFull = lodLevel.vecLodToFull(v);
+            QVERIFY(iFull >= 0 && iFull < realSurface.rr().rows());
+            QVERIFY(lodLevel.vecFullToLod(iFull) == v);
+            QVERIFY(lodLevel.matVertices.row(v) == realSurface.rr().row(iFull));
+        }
+
+        QVERIFY(lodLevel.vecFullToLod.minCoeff() >= 0);
+        QVERIFY(lodLevel.vecFullToLod.maxCoeff() < lodLevel.matVertices.rows());
+    }
+}
+
+//=============================================================================================================
+
+void TestMeshLod::testTriangles() {
+    for(int i = 0; i < meshLod.numLevels(); ++i) {
+        const MeshLodLevel& lodLevel = meshLod.level(i);
+
+        QVERIFY(lodLevel.matTris.rows() > 0);
+        QVERIFY(lodLevel.matTris.minCoeff() >= 0);
+        QVERIFY(lodLevel.matTris.maxCoeff() < lodLevel.matVertices.rows());
+        QVERIFY(lodLevel.matNormals.rows() == lodLevel.matVertices.rows());
+
+        // no degenerated triangles
+        for(int t = 0; t < lodLevel.matTris.rows(); ++t) {
+            QVERIFY(lodLevel.matTris(t,0) != lodLevel.matTris(t,1));
+            QVERIFY(lodLevel.matTris(t,1) != lodLevel.matTris(t,2));
+            QVERIFY(lodLevel.matTris(t,0) != lodLevel.matTris(t,2));
+        }
+    }
+}
+
+//=============================================================================================================
+
+void TestMeshLod::testNeighbors() {
+    for(int i = 0; i < meshLod.numLevels(); ++i) {
+        const MeshLodLevel& lodLevel = meshLod.level(i);
+
+        QVERIFY(lodLevel.vecNeighborVertices.size() == lodLevel.matVertices.rows());
+
+        for(int v = 0; v < lodLevel.vecNeighborVertices.size(); ++v) {
+            for(int iNeighbor : lodLevel.vecNeighborVertices.at(v)) {
+                QVERIFY(iNeighbor != v);
+                QVERIFY(lodLevel.vecNeighborVertices.at(iNeighbor).contains(v));
+            }
+        }
+    }
+}
+
+//=============================================================================================================
+
+void TestMeshLod::testLevelForViewport() {
+    // unknown viewports fall back to the full resolution mesh
+    QVERIFY(meshLod.levelForViewport(QSize()) == 0);
+    QVERIFY(meshLod.levelForViewport(QSize(0, 0)) == 0);
+
+    // larger viewports never select coarser levels
+    int iLastLevel = meshLod.numLevels() - 1;
+    for(int iWidth = 16; iWidth <= 8192; iWidth *= 2) {
+        int iLevel = meshLod.levelForViewport(QSize(iWidth, iWidth));
+        QVERIFY(iLevel >= 0 && iLevel < meshLod.numLevels());
+        QVERIFY(iLevel <= iLastLevel);
+        iLastLevel = iLevel;
+    }
+
+    QVERIFY(meshLod.levelForViewport(QSize(8192, 8192)) == 0);
+}
+
+//=============================================================================================================
+
+void TestMeshLod::testMapping() {
+    VectorXi vecFullVertNo(3);
+    vecFullVertNo << 0, static_cast<int>(realSurface.rr().rows()) / 2, static_cast<int>(realSurface.rr().rows()) - 1;
+
+    VectorXf vecData = VectorXf::LinSpaced(realSurface.rr().rows(), 0.0f, 1.0f);
+
+    for(int i = 0; i < meshLod.numLevels(); ++i) {
+        const MeshLodLevel& lodLevel = meshLod.level(i);
+
+        VectorXi vecLodVertNo = meshLod.mapVertices(i, vecFullVertNo);
+        QVERIFY(vecLodVertNo.rows() == vecFullVertNo.rows());
+        for(int v = 0; v < vecLodVertNo.rows(); ++v) {
+            QVERIFY(vecLodVertNo(v) == lodLevel.vecFullToLod(vecFullVertNo(v)));
+        }
+
+        VectorXf vecLodData = meshLod.sampleVertexData(i, vecData);
+        QVERIFY(vecLodData.rows() == lodLevel.matVertices.rows());
+        for(int v = 0; v < vecLodData.rows(); ++v) {
+            QVERIFY(vecLodData(v) == vecData(lodLevel.vecLodToFull(v)));
+        }
+
+        MatrixX3f matLodVertices = meshLod.sampleVertexData(i, realSurface.rr());
+        QVERIFY(matLodVertices == lodLevel.matVertices);
+    }
+}
+
+//=============================================================================================================
+
+void TestMeshLod::cleanupTestCase() {
+}
+
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_GUILESS_MAIN(TestMeshLod)
+#include "test_meshlod.moc"
@@ -0,0 +1,295 @@
+//=============================================================================================================
+/**
+ * @file     test_minimum_norm.cpp
+ * @author   MNE-CPP authors
+ * @since    0.1.8
+ * @date     October, 2026
+ *
+ * @section  LICENSE
+ *
+ * Copyright (C) 2026, MNE-CPP authors. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ * the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+ *       following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ *       the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+ *       to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * @brief    Test for the single precision apply path of the minimum norm estimate.
+ *
+ */
+
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <inverse/minimumNorm/minimumnorm.h>
+
+#include <mne/mne_forwardsolution.h>
+#include <mne/mne_inverse_operator.h>
+#include <mne/mne_sourceestimate.h>
+
+#include <fiff/fiff_evoked.h>
+#include <fiff/fiff_cov.h>
+
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+
+//=============================================================================================================
+// EIGEN INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+#include <Eigen/SparseCore>
+
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace INVERSELIB;
+using namespace MNELIB;
+using namespace FIFFLIB;
+using namespace Eigen;
+
+//=============================================================================================================
+/**
+ * DECLARE CLASS TestMinimumNorm
+ *
+ * @brief The TestMinimumNorm class compares the single precision apply path with the double precision solution
+ *
+ */
+class TestMinimumNorm: public QObject
+{
+    Q_OBJECT
+
+public:
+    TestMinimumNorm();
+
+private slots:
+    void initTestCase();
+    void compareApplyInverse_data();
+    void compareApplyInverse();
+    void compareKernelCache();
+    void compareNoiseCovUpdate();
+    void cleanupTestCase();
+
+private:
+    double relDiff(const MatrixXd& matTest, const MatrixXd& matRef) const;
+
+    double                  m_dEpsilon;
+    FiffEvoked              m_evoked;
+    MNEForwardSolution      m_fwd;
+    FiffCov                 m_noiseCov;
+    MNEInverseOperator      m_invOp;
+};
+
+//=============================================================================================================
+
+TestMinimumNorm::TestMinimumNorm()
+: m_dEpsilon(1e-4)
+{
+}
+
+//=============================================================================================================
+
+void TestMinimumNorm::initTestCase()
+{
+    QFile t_fileFwd(QCoreApplication::applicationDirPath() + "/mne-cpp-test-data/Result/ref-sample_audvis-meg-eeg-oct-6-fwd.fif");
+    QFile t_fileCov(QCoreApplication::applicationDirPath() + "/mne-cpp-test-data/MEG/sample/sample_audvis-cov.fif");
+    QFile t_fileEvoked(QCoreApplication::applicationDirPath() + "/mne-cpp-test-data/MEG/sample/sample_audvis-ave.fif");
+
+    QPair<float, float> baseline(-1.0f, -1.0f);
+    m_evoked = FiffEvoked(t_fileEvoked, 0, baseline);
+    QVERIFY(!m_evoked.isEmpty());
+
+    m_fwd = MNEForwardSolution(t_fileFwd, false, true);
+    QVERIFY(!m_fwd.isEmpty());
+
+    m_noiseCov = FiffCov(t_fileCov);
+    FiffCov noise_cov = m_noiseCov.regularize(m_evoked.info, 0.05, 0.05, 0.1, true);
+
+    m_invOp = MNEInverseOperator(m_evoked.info, m_fwd, noise_cov, 0.2f, 0.8f);
+}
+
+//=============================================================================================================
+
+void TestMinimumNorm::compareApplyInverse_data()
+{
+    QTest::addColumn<QString>("method");
+    QTest::addColumn<bool>("pickNormal");
+
+    QTest::newRow("MNE") << QString("MNE") << false;
+    QTest::newRow("dSPM") << QString("dSPM") << false;
+    QTest::newRow("sLORETA") << QString("sLORETA") << false;
+    QTest::newRow("dSPM normal") << QString("dSPM") << true;
+}
+
+//=============================================================================================================
+
+void TestMinimumNorm::compareApplyInverse()
+{
+    QFETCH(QString, method);
+    QFETCH(bool, pickNormal);
+
+    MinimumNorm minimumNorm(m_invOp, 1.0f / 9.0f, method);
+    minimumNorm.doInverseSetup(m_evoked.nave, pickNormal);
+
+    FiffEvoked t_evoked = m_evoked.pick_channels(minimumNorm.getPreparedInverseOperator().noise_cov->names);
+
+    MNESourceEstimate sourceEstimate = minimumNorm.calculateInverse(t_evoked.data, 0.0f, 1.0f / t_evoked.info.sfreq, pickNormal);
+    QVERIFY(!sourceEstimate.isEmpty());
+
+    // Use a block size which does not divide the number of samples
+    MatrixXf matSol;
+    QVERIFY(minimumNorm.applyInverse(t_evoked.data.cast<float>(), matSol, 37));
+
+    QVERIFY(relDiff(matSol.cast<double>(), sourceEstimate.data) < m_dEpsilon);
+
+    // Reuse the buffer for a single sample
+    QVERIFY(minimumNorm.applyInverse(t_evoked.data.col(10).cast<float>(), matSol));
+    QVERIFY(relDiff(matSol.cast<double>(), sourceEstimate.data.col(10)) < m_dEpsilon);
+}
+
+//=============================================================================================================
+
+void TestMinimumNorm::compareKernelCache()
+{
+    QString sCacheFile = QDir::tempPath() + "/test_minimum_norm-kernel-cache.fif";
+    QFile::remove(sCacheFile);
+
+    MNEInverseOperator invOp = m_invOp;
+    invOp.clearKernelCache();
+    QCOMPARE(invOp.setKernelCacheFile(sCacheFile), 0);
+
+    MatrixXd matK, matKCached;
+    SparseMatrix<double> noiseNorm;
+    QList<VectorXi> vertno;
+
+    QVERIFY(invOp.prepare_kernel(m_evoked.nave, 1.0f / 9.0f, true, false, false, matK, noiseNorm, vertno));
+    QCOMPARE(invOp.getKernelCacheMisses(), 1);
+    QCOMPARE(invOp.getKernelCacheHits(), 0);
+
+    QVERIFY(invOp.prepare_kernel(m_evoked.nave, 1.0f / 9.0f, true, false, false, matKCached, noiseNorm, vertno));
+    QCOMPARE(invOp.getKernelCacheHits(), 1);
+    QVERIFY(matKCached == matK);
+
+    QVERIFY(invOp.prepare_kernel(1, 1.0f / 9.0f, true, false, false, matKCached, noiseNorm, vertno));
+    QCOMPARE(invOp.getKernelCacheMisses(), 2);
+
+    // The sidecar file is written once, copies start with an empty cache and read the kernels of the file
+    QVERIFY(invOp.writeKernelCacheFile());
+    QVERIFY(QFile::exists(sCacheFile));
+
+    MNEInverseOperator invOpCopy = invOp;
+    QCOMPARE(invOpCopy.getKernelCacheHits(), 0);
+    QCOMPARE(invOpCopy.getKernelCacheMisses(), 0);
+
+    QVERIFY(invOpCopy.prepare_kernel(m_evoked.nave, 1.0f / 9.0f, true, false, false, matKCached, noiseNorm, vertno));
+    QCOMPARE(invOpCopy.getKernelCacheHits(), 1);
+    QCOMPARE(invOpCopy.getKernelCacheMisses(), 0);
+    QVERIFY(matKCached == matK);
+
+    MinimumNorm minimumNorm(invOp, 1.0f / 9.0f, QString("dSPM"));
+    minimumNorm.doInverseSetup(m_evoked.nave, false);
+    QVERIFY(minimumNorm.getKernel() == matK);
+    QCOMPARE(invOp.getKernelCacheHits(), 1);
+
+    // Read the kernels back from the sidecar file
+    invOp.clearKernelCache();
+    QCOMPARE(invOp.setKernelCacheFile(sCacheFile), 2);
+
+    MinimumNorm minimumNormRead(invOp, 1.0f / 9.0f, QString("dSPM"));
+    minimumNormRead.doInverseSetup(m_evoked.nave, false);
+    QVERIFY(minimumNormRead.getKernel() == matK);
+
+    FiffEvoked t_evoked = m_evoked.pick_channels(minimumNorm.getPreparedInverseOperator().noise_cov->names);
+    MNESourceEstimate sourceEstimate = minimumNorm.calculateInverse(t_evoked.data, 0.0f, 1.0f / t_evoked.info.sfreq);
+    MNESourceEstimate sourceEstimateRead = minimumNormRead.calculateInverse(t_evoked.data, 0.0f, 1.0f / t_evoked.info.sfreq);
+    QVERIFY(relDiff(sourceEstimateRead.data, sourceEstimate.data) < m_dEpsilon);
+
+    // A changed copy must not pick up the kernels of the original operator
+    MNEInverseOperator invOpChanged = invOp;
+    invOpChanged.sing *= 2.0;
+
+    MatrixXd matKChanged;
+    QVERIFY(invOpChanged.prepare_kernel(m_evoked.nave, 1.0f / 9.0f, true, false, false, matKChanged, noiseNorm, vertno));
+    QCOMPARE(invOpChanged.getKernelCacheHits(), 0);
+    QCOMPARE(invOpChanged.getKernelCacheMisses(), 1);
+    QVERIFY(relDiff(matKChanged, matK) > m_dEpsilon);
+
+    QVERIFY(invOp.prepare_kernel(m_evoked.nave, 1.0f / 9.0f, true, false, false, matKCached, noiseNorm, vertno));
+    QVERIFY(matKCached == matK);
+    QVERIFY(vertno == invOp.src.get_vertno());
+
+    // The kernels of the changed operator replace the sidecar file and are discarded by the original one
+    QVERIFY(invOpChanged.writeKernelCacheFile());
+    QCOMPARE(invOp.setKernelCacheFile(sCacheFile), 0);
+
+    QFile::remove(sCacheFile);
+}
+
+//=============================================================================================================
+
+void TestMinimumNorm::compareNoiseCovUpdate()
+{
+    // A differently regularized noise covariance changes the whitener but not the channel selection
+    FiffCov noise_cov = m_noiseCov.regularize(m_evoked.info, 0.2, 0.2, 0.3, true);
+
+    MNEInverseOperator invOpUpdate = m_invOp.update_noise_cov(m_evoked.info, m_fwd, noise_cov);
+    QVERIFY(invOpUpdate.nsource == m_invOp.nsource);
+
+    MNEInverseOperator invOpRef(m_evoked.info, m_fwd, noise_cov, 0.2f, 0.8f);
+
+    MatrixXd matKUpdate, matKRef;
+    SparseMatrix<double> noiseNormUpdate, noiseNormRef;
+    QList<VectorXi> vertno;
+    QVERIFY(invOpUpdate.prepare_kernel(m_evoked.nave, 1.0f / 9.0f, true, false, false, matKUpdate, noiseNormUpdate, vertno));
+    QVERIFY(invOpRef.prepare_kernel(m_evoked.nave, 1.0f / 9.0f, true, false, false, matKRef, noiseNormRef, vertno));
+
+    QVERIFY(relDiff(matKUpdate, matKRef) < m_dEpsilon);
+    QVERIFY(relDiff(VectorXd(noiseNormUpdate.diagonal()), VectorXd(noiseNormRef.diagonal())) < m_dEpsilon);
+
+    QVERIFY(std::abs(invOpUpdate.sing(0) - invOpRef.sing(0)) < m_dEpsilon * invOpRef.sing(0));
+}
+
+//=============================================================================================================
+
+void TestMinimumNorm::cleanupTestCase()
+{
+}
+
+//=============================================================================================================
+
+double TestMinimumNorm::relDiff(const MatrixXd& matTest, const MatrixXd& matRef) const
+{
+    if(matTest.rows() != matRef.rows() || matTest.cols() != matRef.cols()) {
+        return 1.0;
+    }
+    double dNorm = matRef.norm();
+    double dDiff = (matTest - matRef).norm();
+    qDebug() << "Relative difference:" << (dNorm > 0.0 ? dDiff/dNorm : dDiff);
+    return dNorm > 0.0 ? dDiff/dNorm : dDiff;
+}
+
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_GUILESS_MAIN(TestMinimumNorm)
+#include "test_minimum_norm.moc"
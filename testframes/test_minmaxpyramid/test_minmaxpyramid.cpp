@@ -0,0 +1,308 @@
+//=============================================================================================================
+/**
+ * @file     test_minmaxpyramid.cpp
+ * @author   MNE-CPP authors
+ * @since    0.1.8
+ * @date     October, 2026
+ *
+ * @section  LICENSE
+ *
+ * Copyright (C) 2026, MNE-CPP authors. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ * the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+ *       following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ *       the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+ *       to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * @brief    The min/max pyramid test implementation
+ *
+ */
+
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <utils/generics/applicationlogger.h>
+
+#include <fiff/fiff_raw_data.h>
+#include <fiff/fiff_stream.h>
+
+#include <anShared/Utils/minmaxpyramid.h>
+
+#include <math.h>
+
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+#include <QTemporaryDir>
+#include <QCryptographicHash>
+#include <QStandardPaths>
+
+//=============================================================================================================
+// EIGEN INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace ANSHAREDLIB;
+using namespace FIFFLIB;
+using namespace Eigen;
+
+//=============================================================================================================
+/**
+ * DECLARE CLASS TestMinMaxPyramid
+ *
+ * @brief The TestMinMaxPyramid class tests the min/max pyramid and its disk cache against the minima and
+ *        maxima of the raw samples
+ *
+ */
+class TestMinMaxPyramid : public QObject
+{
+    Q_OBJECT
+
+public:
+    TestMinMaxPyramid();
+
+private slots:
+    void initTestCase();
+    void compareBins();
+    void checkBaseBinSize();
+    void compareCache();
+    void checkCacheLevels();
+    void cleanupTestCase();
+
+private:
+    void comparePyramids(const MinMaxPyramid& pyramid, const MinMaxPyramid& ref);
+    QString cacheFileName() const;
+
+    QTemporaryDir   m_tmpDir;
+    QString         m_sRawFile;
+    int             m_iFirstSample;
+    int             m_iNumSamples;
+};
+
+//=============================================================================================================
+
+TestMinMaxPyramid::TestMinMaxPyramid()
+: m_iFirstSample(1000)
+, m_iNumSamples(100003)
+{
+}
+
+//=============================================================================================================
+
+void TestMinMaxPyramid::initTestCase()
+{
+    qInstallMessageHandler(UTILSLIB::ApplicationLogger::customLogWriter);
+    QStandardPaths::setTestModeEnabled(true);
+    QVERIFY(m_tmpDir.isValid());
+
+    // A few channels of the sample data, long enough for three levels and ending with an incomplete bin
+    QFile t_fileIn(QCoreApplication::applicationDirPath() + "/mne-cpp-test-data/MEG/sample/sample_audvis_trunc_raw.fif");
+    FiffRawData raw(t_fileIn);
+    QVERIFY(!raw.isEmpty());
+
+    MatrixXi vPicks = raw.info.pick_types(true, false, false);
+    QVERIFY(vPicks.cols() >= 3);
+    MatrixXi vSel = vPicks.leftCols(3);
+
+    m_sRawFile = m_tmpDir.path() + "/minmaxpyramid_raw.fif";
+    QFile t_fileOut(m_sRawFile);
+    RowVectorXd vCals;
+    FiffStream::SPtr outfid = FiffStream::start_writing_raw(t_fileOut, raw.info, vCals, vSel);
+    outfid->write_int(FIFF_FIRST_SAMPLE, &m_iFirstSample);
+
+    const int iBufferSize = 10000;
+    for(int iStart = 0; iStart < m_iNumSamples; iStart += iBufferSize) {
+        MatrixXd matData(vSel.cols(), qMin(iBufferSize, m_iNumSamples - iStart));
+        for(int c = 0; c < matData.rows(); ++c) {
+            for(int t = 0; t < matData.cols(); ++t) {
+                int s = iStart + t;
+                matData(c,t) = 1e-12 * sin(0.01 * (c+1) * s);
+                if(s % 997 == 0) {
+                    matData(c,t) += (s % 2 == 0 ? 5e-12 : -5e-12) * (c+1);
+                }
+            }
+        }
+        QVERIFY(outfid->write_raw_buffer(matData, vCals));
+    }
+    outfid->finish_writing_raw();
+}
+
+//=============================================================================================================
+
+void TestMinMaxPyramid::comparePyramids(const MinMaxPyramid& pyramid, const MinMaxPyramid& ref)
+{
+    QCOMPARE(pyramid.numLevels(), ref.numLevels());
+    QCOMPARE(pyramid.firstSample(), ref.firstSample());
+    QCOMPARE(pyramid.lastSample(), ref.lastSample());
+    for(int i = 0; i < ref.numLevels(); ++i) {
+        QVERIFY(pyramid.minima(i) == ref.minima(i));
+        QVERIFY(pyramid.maxima(i) == ref.maxima(i));
+    }
+}
+
+//=============================================================================================================
+
+QString TestMinMaxPyramid::cacheFileName() const
+{
+    QByteArray pathHash = QCryptographicHash::hash(QFileInfo(m_sRawFile).absoluteFilePath().toUtf8(),
+                                                   QCryptographicHash::Sha1);
+
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation)
+            + QStringLiteral("/minmaxpyramid/")
+            + QString::fromLatin1(pathHash.toHex())
+            + QStringLiteral(".mmp");
+}
+
+//=============================================================================================================
+
+void TestMinMaxPyramid::compareBins()
+{
+    MinMaxPyramid pyramid;
+    QVERIFY(pyramid.build(m_sRawFile));
+
+    QCOMPARE(pyramid.firstSample(), m_iFirstSample);
+    QCOMPARE(pyramid.lastSample(), m_iFirstSample + m_iNumSamples - 1);
+
+    // 1563 bins on level 0, 391 on level 1 and 98 on level 2
+    QCOMPARE(pyramid.numLevels(), 3);
+
+    QFile t_file(m_sRawFile);
+    FiffRawData raw(t_file);
+    MatrixXd matData, matTimes;
+    QVERIFY(raw.read_raw_segment(matData, matTimes, raw.first_samp, raw.last_samp));
+    QCOMPARE(static_cast<int>(matData.cols()), m_iNumSamples);
+
+    // Every bin of every level against the samples it covers
+    for(int i = 0; i < pyramid.numLevels(); ++i) {
+        int iBinSize = static_cast<int>(pyramid.binSize(i));
+        int iNumBins = (m_iNumSamples + iBinSize - 1) / iBinSize;
+
+        QCOMPARE(static_cast<int>(pyramid.minima(i).rows()), static_cast<int>(matData.rows()));
+        QCOMPARE(static_cast<int>(pyramid.minima(i).cols()), iNumBins);
+        QCOMPARE(static_cast<int>(pyramid.maxima(i).cols()), iNumBins);
+
+        for(int iBin = 0; iBin < iNumBins; ++iBin) {
+            int iNumCols = qMin(iBinSize, m_iNumSamples - iBin * iBinSize);
+            for(int c = 0; c < matData.rows(); ++c) {
+                QCOMPARE(pyramid.minima(i)(c, iBin), static_cast<float>(matData.row(c).segment(iBin * iBinSize, iNumCols).minCoeff()));
+                QCOMPARE(pyramid.maxima(i)(c, iBin), static_cast<float>(matData.row(c).segment(iBin * iBinSize, iNumCols).maxCoeff()));
+            }
+        }
+    }
+}
+
+//=============================================================================================================
+
+void TestMinMaxPyramid::checkBaseBinSize()
+{
+    // Short recordings keep the finest bins
+    QCOMPARE(MinMaxPyramid::baseBinSize(3, m_iNumSamples), static_cast<qint64>(64));
+
+    // One hour of 306 channels at 1 kHz, level 0 would take 138 MB with 64 samples per bin
+    const int iNumChannels = 306;
+    const qint64 iNumSamples = 3600000;
+    const qint64 iBinSize = MinMaxPyramid::baseBinSize(iNumChannels, iNumSamples);
+    QCOMPARE(iBinSize, static_cast<qint64>(1024));
+
+    const qint64 iNumBytes = 2 * static_cast<qint64>(sizeof(float)) * iNumChannels * ((iNumSamples + iBinSize - 1) / iBinSize);
+    QVERIFY(iNumBytes <= 16 * 1024 * 1024);
+
+    // A finer start would exceed the budget
+    const qint64 iFinerBinSize = iBinSize / 4;
+    QVERIFY(2 * static_cast<qint64>(sizeof(float)) * iNumChannels * ((iNumSamples + iFinerBinSize - 1) / iFinerBinSize) > 16 * 1024 * 1024);
+}
+
+//=============================================================================================================
+
+void TestMinMaxPyramid::compareCache()
+{
+    QFile::remove(cacheFileName());
+
+    MinMaxPyramid pyramid;
+    QVERIFY(pyramid.build(m_sRawFile));
+    QVERIFY(QFile::exists(cacheFileName()));
+
+    // The second build reads the cache
+    MinMaxPyramid cached;
+    QVERIFY(cached.build(m_sRawFile));
+    comparePyramids(cached, pyramid);
+
+    // A cache which does not match its checksum is rebuilt
+    QFile t_cache(cacheFileName());
+    QVERIFY(t_cache.open(QIODevice::ReadWrite));
+    t_cache.seek(t_cache.size() - 1);
+    char c;
+    QVERIFY(t_cache.getChar(&c));
+    t_cache.seek(t_cache.size() - 1);
+    QVERIFY(t_cache.putChar(c ^ 0x55));
+    t_cache.close();
+
+    MinMaxPyramid rebuilt;
+    QVERIFY(rebuilt.build(m_sRawFile));
+    comparePyramids(rebuilt, pyramid);
+}
+
+//=============================================================================================================
+
+void TestMinMaxPyramid::checkCacheLevels()
+{
+    QFile::remove(cacheFileName());
+
+    MinMaxPyramid pyramid;
+    QVERIFY(pyramid.build(m_sRawFile));
+
+    // A level count which does not follow from the samples, the bin size of level 16 does not fit into 32 bits
+    const qint64 iNumLevelsOffset = 6 * sizeof(qint32);
+    QFile t_cache(cacheFileName());
+    QVERIFY(t_cache.open(QIODevice::ReadWrite));
+    QVERIFY(t_cache.seek(iNumLevelsOffset));
+    qint32 iNumLevels = 20;
+    QCOMPARE(t_cache.write(reinterpret_cast<const char*>(&iNumLevels), sizeof(iNumLevels)), static_cast<qint64>(sizeof(iNumLevels)));
+    t_cache.close();
+
+    MinMaxPyramid rebuilt;
+    QVERIFY(rebuilt.build(m_sRawFile));
+    comparePyramids(rebuilt, pyramid);
+
+    // The rejected cache was replaced
+    QVERIFY(t_cache.open(QIODevice::ReadOnly));
+    QVERIFY(t_cache.seek(iNumLevelsOffset));
+    QCOMPARE(t_cache.read(reinterpret_cast<char*>(&iNumLevels), sizeof(iNumLevels)), static_cast<qint64>(sizeof(iNumLevels)));
+    QCOMPARE(iNumLevels, pyramid.numLevels());
+}
+
+//=============================================================================================================
+
+void TestMinMaxPyramid::cleanupTestCase()
+{
+    QFile::remove(cacheFileName());
+}
+
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_GUILESS_MAIN(TestMinMaxPyramid)
+#include "test_minmaxpyramid.moc"
@@ -43,6 +43,8 @@
 #include <fwd/computeFwd/compute_fwd_settings.h>
 #include <fwd/computeFwd/compute_fwd.h>
 #include <mne/mne.h>
+#include <mne/c/mne_surface_or_volume.h>
+#include <mne/c/mne_surface_old.h>
 
 #include <fiff/fiff.h>
 #include <fiff/fiff_info.h>
@@ -79,9 +81,12 @@ private slots:
     void initTestCase();
     void computeForward();
     void compareForward();
+    void compareGeometryCache();
     void cleanupTestCase();
 
 private:
+    void compareGeometry(MneSurfaceOld* surfTest, MneSurfaceOld* surfRef);
+
     double dEpsilon;
 
     QSharedPointer<MNEForwardSolution> m_pFwdMEGEEGRead;
@@ -186,6 +191,105 @@ void TestMneForwardSolution::compareForward()
 
 //=============================================================================================================
 
+void TestMneForwardSolution::compareGeometryCache()
+{
+    // Work on a copy so that the cache is not written next to the test data
+    QString bemName = QDir::tempPath() + "/test_mne_forward_solution-bem.fif";
+    QString cacheName = MneSurfaceOrVolume::mne_geometry_cache_name(bemName,FIFFV_BEM_SURF_ID_BRAIN);
+    QString skullCacheName = MneSurfaceOrVolume::mne_geometry_cache_name(bemName,FIFFV_BEM_SURF_ID_SKULL);
+    QFile::remove(bemName);
+    QFile::remove(cacheName);
+    QFile::remove(skullCacheName);
+    QVERIFY(QFile::copy(QCoreApplication::applicationDirPath() + "/mne-cpp-test-data/subjects/sample/bem/sample-1280-1280-1280-bem.fif",bemName));
+
+    MneSurfaceOld* surfRef = MneSurfaceOrVolume::read_bem_surface(bemName,FIFFV_BEM_SURF_ID_BRAIN,true,NULL);
+    QVERIFY(surfRef != NULL);
+    QVERIFY(!QFile::exists(cacheName));
+
+    // The first read computes and stores the geometry, the second one reads it back
+    MneSurfaceOld* surfWrite = MneSurfaceOrVolume::read_bem_surface(bemName,FIFFV_BEM_SURF_ID_BRAIN,true,NULL,true,true);
+    QVERIFY(surfWrite != NULL);
+    QVERIFY(QFile::exists(cacheName));
+    MneSurfaceOld* surfRead = MneSurfaceOrVolume::read_bem_surface(bemName,FIFFV_BEM_SURF_ID_BRAIN,true,NULL,true,true);
+    QVERIFY(surfRead != NULL);
+    compareGeometry(surfRead,surfRef);
+
+    delete surfWrite;
+    delete surfRead;
+
+    QFile cacheFile(cacheName);
+    QVERIFY(cacheFile.open(QIODevice::ReadOnly));
+    QByteArray cacheData = cacheFile.readAll();
+    cacheFile.close();
+    QVERIFY(cacheData.size() > 0);
+
+    // Truncated, corrupted and stale caches are rejected, the geometry is recomputed and the cache rewritten
+    for (int iCase = 0; iCase < 3; ++iCase) {
+        if (iCase == 0) {
+            QVERIFY(cacheFile.open(QIODevice::WriteOnly | QIODevice::Truncate));
+            cacheFile.write(cacheData.left(cacheData.size() / 2));
+            cacheFile.close();
+        }
+        else if (iCase == 1) {
+            QByteArray corruptData = cacheData;
+            corruptData[corruptData.size() - 1] = corruptData[corruptData.size() - 1] ^ 0xff;
+            QVERIFY(cacheFile.open(QIODevice::WriteOnly | QIODevice::Truncate));
+            cacheFile.write(corruptData);
+            cacheFile.close();
+        }
+        else {
+            // The skull surface has as many vertices and triangles as the inner skull but a different hash
+            MneSurfaceOld* surfSkull = MneSurfaceOrVolume::read_bem_surface(bemName,FIFFV_BEM_SURF_ID_SKULL,true,NULL,true,true);
+            QVERIFY(surfSkull != NULL);
+            QCOMPARE(surfSkull->np, surfRef->np);
+            delete surfSkull;
+            QVERIFY(QFile::remove(cacheName));
+            QVERIFY(QFile::copy(skullCacheName,cacheName));
+        }
+
+        MneSurfaceOld* surfRecomputed = MneSurfaceOrVolume::read_bem_surface(bemName,FIFFV_BEM_SURF_ID_BRAIN,true,NULL,true,true);
+        QVERIFY(surfRecomputed != NULL);
+        compareGeometry(surfRecomputed,surfRef);
+        delete surfRecomputed;
+
+        QVERIFY(cacheFile.open(QIODevice::ReadOnly));
+        QVERIFY(cacheFile.readAll() == cacheData);
+        cacheFile.close();
+    }
+
+    delete surfRef;
+    QFile::remove(bemName);
+    QFile::remove(cacheName);
+    QFile::remove(skullCacheName);
+}
+
+//=============================================================================================================
+
+void TestMneForwardSolution::compareGeometry(MneSurfaceOld* surfTest, MneSurfaceOld* surfRef)
+{
+    QCOMPARE(surfTest->np, surfRef->np);
+    for (int k = 0; k < surfRef->np; ++k) {
+        for (int c = 0; c < 3; ++c) {
+            QCOMPARE(surfTest->nn[k][c], surfRef->nn[k][c]);
+        }
+        QCOMPARE(surfTest->nneighbor_tri[k], surfRef->nneighbor_tri[k]);
+        for (int p = 0; p < surfRef->nneighbor_tri[k]; ++p) {
+            QCOMPARE(surfTest->neighbor_tri[k][p], surfRef->neighbor_tri[k][p]);
+        }
+        QCOMPARE(surfTest->nneighbor_vert[k], surfRef->nneighbor_vert[k]);
+        for (int p = 0; p < surfRef->nneighbor_vert[k]; ++p) {
+            QCOMPARE(surfTest->neighbor_vert[k][p], surfRef->neighbor_vert[k][p]);
+            QCOMPARE(surfTest->vert_dist[k][p], surfRef->vert_dist[k][p]);
+        }
+    }
+    for (int c = 0; c < 3; ++c) {
+        QCOMPARE(surfTest->cm[c], surfRef->cm[c]);
+    }
+    QCOMPARE(surfTest->tot_area, surfRef->tot_area);
+}
+
+//=============================================================================================================
+
 void TestMneForwardSolution::cleanupTestCase()
 {
 }
@@ -80,6 +80,7 @@ public:
 private slots:
     void initTestCase();
     void compareValue();
+    void compareExhaustive();
     void cleanupTestCase();
 
 private:
@@ -87,6 +88,7 @@ private:
     double dEpsilon;
     MatrixXf matResult;
     MatrixXd matRef;
+    MNEBemSurface::SPtr bemSurface;
 
 };
 
@@ -105,7 +107,7 @@ void TestMNEProjectToSurface::initTestCase()
     QString sRef(QCoreApplication::applicationDirPath() + "/mne-cpp-test-data/Result/mne_project_to_surface.txt");
 
     MNEBem bemHead(t_fileBem);
-    MNEBemSurface::SPtr bemSurface = MNEBemSurface::SPtr::create(bemHead[0]);
+    bemSurface = MNEBemSurface::SPtr::create(bemHead[0]);
     MNEProjectToSurface::SPtr mneSurfacePoints = MNEProjectToSurface::SPtr::create(*bemSurface);
 
     VectorXi vecNearest;    // Triangle of the new point
@@ -132,6 +134,31 @@ void TestMNEProjectToSurface::compareValue()
 
 //=============================================================================================================
 
+void TestMNEProjectToSurface::compareExhaustive()
+{
+    // the bounding volume hierarchy has to give exactly the same results as going through all triangles
+    MNEProjectToSurface projectToSurface(*bemSurface);
+
+    MatrixXf matSurface = bemSurface->rr.cast<float>();
+    int iNV = matSurface.rows();
+    MatrixXf matPoints(4 * iNV, 3);
+    matPoints << matSurface * 0.9, matSurface, matSurface * 1.1, matSurface + 0.01 * MatrixXf::Random(iNV, 3);
+    int iNP = matPoints.rows();
+
+    MatrixXf matTri, matTriExhaustive;
+    VectorXi vecNearest, vecNearestExhaustive;
+    VectorXf vecDist, vecDistExhaustive;
+
+    QVERIFY(projectToSurface.mne_find_closest_on_surface(matPoints, iNP, matTri, vecNearest, vecDist));
+    QVERIFY(projectToSurface.mne_find_closest_on_surface_exhaustive(matPoints, iNP, matTriExhaustive, vecNearestExhaustive, vecDistExhaustive));
+
+    QVERIFY(vecNearest == vecNearestExhaustive);
+    QVERIFY(vecDist == vecDistExhaustive);
+    QVERIFY(matTri == matTriExhaustive);
+}
+
+//=============================================================================================================
+
 void TestMNEProjectToSurface::cleanupTestCase()
 {
 }
@@ -0,0 +1,359 @@
+//=============================================================================================================
+/**
+ * @file     test_mne_surface_or_volume.cpp
+ * @author   MNE-CPP authors
+ * @since    0.1.8
+ * @date     October, 2026
+ *
+ * @section  LICENSE
+ *
+ * Copyright (C) 2026, MNE-CPP authors. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ * the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+ *       following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ *       the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+ *       to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * @brief    The surface and volume utility test implementation
+ *
+ */
+
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <utils/generics/applicationlogger.h>
+
+#include <mne/c/mne_surface_or_volume.h>
+#include <mne/c/mne_surface_old.h>
+#include <mne/c/mne_source_space_old.h>
+#include <mne/mne_triangle_bvh.h>
+
+#include <fiff/fiff_file.h>
+
+#include <math.h>
+#include <random>
+
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+#include <QtConcurrent>
+
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace MNELIB;
+
+//=============================================================================================================
+/**
+ * DECLARE CLASS TestMneSurfaceOrVolume
+ *
+ * @brief The TestMneSurfaceOrVolume class tests the source space and surface utilities against their
+ *        straightforward reference implementations
+ *
+ */
+class TestMneSurfaceOrVolume : public QObject
+{
+    Q_OBJECT
+
+public:
+    TestMneSurfaceOrVolume();
+
+private slots:
+    void initTestCase();
+    void compareFilterSourceSpaces();
+    void compareVolumeSourceSpace_data();
+    void compareVolumeSourceSpace();
+    void compareClosestTriangle();
+    void cleanupTestCase();
+
+private:
+    MneSourceSpaceOld* makeGrid(float grid);
+    void filterReference(float limit, MneSourceSpaceOld* s);
+    void compareInUse(MneSourceSpaceOld* s, MneSourceSpaceOld* ref);
+
+    MneSurfaceOld* m_pInnerSkull;
+};
+
+//=============================================================================================================
+
+TestMneSurfaceOrVolume::TestMneSurfaceOrVolume()
+: m_pInnerSkull(NULL)
+{
+}
+
+//=============================================================================================================
+
+void TestMneSurfaceOrVolume::initTestCase()
+{
+    qInstallMessageHandler(UTILSLIB::ApplicationLogger::customLogWriter);
+
+    QString bemName(QCoreApplication::applicationDirPath() + "/mne-cpp-test-data/subjects/sample/bem/sample-5120-bem.fif");
+    m_pInnerSkull = MneSurfaceOrVolume::read_bem_surface(bemName,FIFFV_BEM_SURF_ID_BRAIN,true,NULL);
+    QVERIFY(m_pInnerSkull != NULL);
+}
+
+//=============================================================================================================
+
+MneSourceSpaceOld* TestMneSurfaceOrVolume::makeGrid(float grid)
+{
+    // A regular grid which extends two steps beyond the surface in MRI coordinates
+    float min[3],max[3];
+    int   minn[3],n[3];
+    int   k,c,x,y,z;
+
+    for (c = 0; c < 3; c++)
+        min[c] = max[c] = m_pInnerSkull->rr[0][c];
+    for (k = 0; k < m_pInnerSkull->np; k++) {
+        for (c = 0; c < 3; c++) {
+            min[c] = std::min(min[c],m_pInnerSkull->rr[k][c]);
+            max[c] = std::max(max[c],m_pInnerSkull->rr[k][c]);
+        }
+    }
+    for (c = 0; c < 3; c++) {
+        minn[c] = (int)floor(min[c]/grid)-2;
+        n[c]    = (int)ceil(max[c]/grid)+2-minn[c]+1;
+    }
+    MneSourceSpaceOld* s = MneSurfaceOrVolume::mne_new_source_space(n[0]*n[1]*n[2]);
+    for (z = 0, k = 0; z < n[2]; z++) {
+        for (y = 0; y < n[1]; y++) {
+            for (x = 0; x < n[0]; x++, k++) {
+                s->rr[k][0] = (minn[0]+x)*grid;
+                s->rr[k][1] = (minn[1]+y)*grid;
+                s->rr[k][2] = (minn[2]+z)*grid;
+                s->nn[k][0] = s->nn[k][1] = 0.0;
+                s->nn[k][2] = 1.0;
+                s->inuse[k]  = 1;
+                s->vertno[k] = k;
+            }
+        }
+    }
+    s->nuse = s->np;
+    return s;
+}
+
+//=============================================================================================================
+
+void TestMneSurfaceOrVolume::filterReference(float limit, MneSourceSpaceOld* s)
+{
+    // The point-by-point test with the scalar solid angle sum and the exhaustive vertex distance
+    float diff[3],dist,mindist;
+    int   p,k,c;
+
+    for (p = 0; p < s->np; p++) {
+        if (!s->inuse[p])
+            continue;
+        bool omit = false;
+        if (fabs(MneSurfaceOrVolume::sum_solids(s->rr[p],m_pInnerSkull)/(4*M_PI)-1.0) > 1e-5)
+            omit = true;
+        else if (limit > 0.0) {
+            mindist = 1.0;
+            for (k = 0; k < m_pInnerSkull->np; k++) {
+                for (c = 0; c < 3; c++)
+                    diff[c] = s->rr[p][c] - m_pInnerSkull->rr[k][c];
+                dist = sqrt(diff[0]*diff[0] + diff[1]*diff[1] + diff[2]*diff[2]);
+                if (dist < mindist)
+                    mindist = dist;
+            }
+            omit = mindist < limit;
+        }
+        if (omit) {
+            s->inuse[p] = 0;
+            s->nuse--;
+        }
+    }
+}
+
+//=============================================================================================================
+
+void TestMneSurfaceOrVolume::compareInUse(MneSourceSpaceOld* s, MneSourceSpaceOld* ref)
+{
+    QCOMPARE(s->np, ref->np);
+    QCOMPARE(s->nuse, ref->nuse);
+    for (int k = 0; k < ref->np; ++k) {
+        QCOMPARE(s->inuse[k], ref->inuse[k]);
+    }
+}
+
+//=============================================================================================================
+
+void TestMneSurfaceOrVolume::compareFilterSourceSpaces()
+{
+    float grid = 0.007f;
+    int nuseInside = 0;
+
+    QList<float> limits;
+    limits << 0.0f << 0.005f << 0.015f;
+
+    for (int i = 0; i < limits.size(); ++i) {
+        MneSourceSpaceOld* s = makeGrid(grid);
+        MneSourceSpaceOld* ref = makeGrid(grid);
+
+        QCOMPARE(MneSurfaceOrVolume::mne_filter_source_spaces(m_pInnerSkull,limits[i],NULL,&s,1,NULL), 0);
+        filterReference(limits[i],ref);
+
+        compareInUse(s,ref);
+
+        // Each step must have removed points, the distance limits a growing number of them
+        QVERIFY(ref->nuse > 0);
+        QVERIFY(ref->nuse < ref->np);
+        if (i == 0)
+            nuseInside = ref->nuse;
+        else
+            QVERIFY(ref->nuse < nuseInside);
+
+        delete s;
+        delete ref;
+    }
+}
+
+//=============================================================================================================
+
+void TestMneSurfaceOrVolume::compareVolumeSourceSpace_data()
+{
+    QTest::addColumn<float>("grid");
+    QTest::addColumn<float>("mindist");
+
+    QTest::newRow("7 mm grid") << 0.007f << 0.0f;
+    QTest::newRow("7 mm grid, 5 mm limit") << 0.007f << 0.005f;
+    QTest::newRow("5 mm grid, 5 mm limit") << 0.005f << 0.005f;
+    QTest::newRow("10 mm grid, 12 mm limit") << 0.01f << 0.012f;
+}
+
+//=============================================================================================================
+
+void TestMneSurfaceOrVolume::compareVolumeSourceSpace()
+{
+    QFETCH(float, grid);
+    QFETCH(float, mindist);
+
+    // The scanline classification of the grid rows against testing every point with the solid angles
+    MneSourceSpaceOld* s = MneSurfaceOrVolume::make_volume_source_space(m_pInnerSkull,grid,0.0f,mindist,true);
+    MneSourceSpaceOld* ref = MneSurfaceOrVolume::make_volume_source_space(m_pInnerSkull,grid,0.0f,mindist,false);
+    QVERIFY(s != NULL);
+    QVERIFY(ref != NULL);
+
+    compareInUse(s,ref);
+    QVERIFY(ref->nuse > 0);
+    for (int k = 0; k < ref->np; ++k) {
+        QCOMPARE(s->nneighbor_vert[k], ref->nneighbor_vert[k]);
+        for (int p = 0; p < ref->nneighbor_vert[k]; ++p) {
+            QCOMPARE(s->neighbor_vert[k][p], ref->neighbor_vert[k][p]);
+        }
+    }
+
+    delete s;
+    delete ref;
+}
+
+//=============================================================================================================
+
+void TestMneSurfaceOrVolume::compareClosestTriangle()
+{
+    // Points inside, on and outside of the surface
+    const int np = 2000;
+    float min[3],max[3];
+    int   k,c,t;
+
+    for (c = 0; c < 3; c++)
+        min[c] = max[c] = m_pInnerSkull->rr[0][c];
+    for (k = 0; k < m_pInnerSkull->np; k++) {
+        for (c = 0; c < 3; c++) {
+            min[c] = std::min(min[c],m_pInnerSkull->rr[k][c]);
+            max[c] = std::max(max[c],m_pInnerSkull->rr[k][c]);
+        }
+    }
+    std::mt19937 generator(42);
+    QVector<float> points(3*np);
+    QVector<float*> rr(np);
+    for (k = 0; k < np; k++) {
+        rr[k] = points.data() + 3*k;
+        if (k % 4 == 0) {
+            for (c = 0; c < 3; c++)
+                rr[k][c] = m_pInnerSkull->rr[(k*7) % m_pInnerSkull->np][c];
+        } else {
+            for (c = 0; c < 3; c++) {
+                std::uniform_real_distribution<float> coord(min[c]-0.02f,max[c]+0.02f);
+                rr[k][c] = coord(generator);
+            }
+        }
+    }
+
+    // The hierarchy against going through all triangles
+    QVector<int> nearest(np,-1);
+    QVector<float> dist(np);
+    float p,q,thisdist;
+    for (k = 0; k < np; k++) {
+        float r[3] = { rr[k][0], rr[k][1], rr[k][2] };
+        int best = MneSurfaceOrVolume::mne_project_to_surface(m_pInnerSkull,NULL,r,0,&thisdist);
+
+        int refBest = -1;
+        float refDist = 0.0;
+        for (t = 0; t < m_pInnerSkull->ntri; t++) {
+            float triDist;
+            if (MneSurfaceOrVolume::mne_nearest_triangle_point(r,m_pInnerSkull,t,&p,&q,&triDist)) {
+                if (refBest < 0 || std::fabs(triDist) < std::fabs(refDist)) {
+                    refDist = triDist;
+                    refBest = t;
+                }
+            }
+        }
+        QVERIFY(refBest >= 0);
+        QVERIFY(best >= 0);
+        QCOMPARE(std::fabs(thisdist), std::fabs(refDist));
+
+        // Ties between neighboring triangles may pick either one
+        float bestDist;
+        QVERIFY(MneSurfaceOrVolume::mne_nearest_triangle_point(r,m_pInnerSkull,best,&p,&q,&bestDist));
+        QCOMPARE(bestDist, thisdist);
+        nearest[k] = best;
+        dist[k] = thisdist;
+    }
+
+    // Concurrent queries on a surface without a hierarchy build it once and share it
+    delete m_pInnerSkull->triangle_bvh.fetchAndStoreOrdered(NULL);
+    QVector<int> indices(np);
+    for (k = 0; k < np; k++)
+        indices[k] = k;
+    QVector<int> nearestAll(np,-1);
+    QVector<float> distAll(np);
+    QtConcurrent::blockingMap(indices, [this,&rr,&nearestAll,&distAll](const int k) {
+        float r[3] = { rr[k][0], rr[k][1], rr[k][2] };
+        nearestAll[k] = MneSurfaceOrVolume::mne_project_to_surface(m_pInnerSkull,NULL,r,0,&distAll[k]);
+    });
+    for (k = 0; k < np; k++) {
+        QCOMPARE(nearestAll[k], nearest[k]);
+        QCOMPARE(distAll[k], dist[k]);
+    }
+}
+
+//=============================================================================================================
+
+void TestMneSurfaceOrVolume::cleanupTestCase()
+{
+    delete m_pInnerSkull;
+}
+
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_GUILESS_MAIN(TestMneSurfaceOrVolume)
+#include "test_mne_surface_or_volume.moc"
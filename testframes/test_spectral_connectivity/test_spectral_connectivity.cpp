@@ -41,6 +41,7 @@
 #include <utils/generics/applicationlogger.h>
 
 #include <utils/ioutils.h>
+#include <utils/spectral.h>
 #include <connectivity/metrics/coherency.h>
 #include <connectivity/metrics/coherence.h>
 #include <connectivity/metrics/imagcoherence.h>
@@ -51,7 +52,11 @@
 #include <connectivity/metrics/debiasedsquaredweightedphaselagindex.h>
 #include <connectivity/metrics/crosscorrelation.h>
 #include <connectivity/connectivitysettings.h>
+#include <connectivity/connectivity.h>
+#include <connectivity/metrics/abstractmetric.h>
 #include <connectivity/network/network.h>
+#include <connectivity/network/networkedge.h>
+#include <connectivity/network/networknode.h>
 
 //=============================================================================================================
 // QT INCLUDES
@@ -97,6 +102,10 @@ private slots:
     void spectralConnectivityCoherence();
     void spectralConnectivityImagCoherence();
     void spectralConnectivityXCOR();
+    void spectralConnectivitySharedCache();
+    void spectralConnectivityPackedCsd();
+    void spectralConnectivityPackedNetwork();
+    void spectralConnectivitySlidingWindow();
     void cleanupTestCase();
 
 private:
@@ -348,6 +357,94 @@ void TestSpectralConnectivity::spectralConnectivityXCOR()
 
 //=============================================================================================================
 
+void TestSpectralConnectivity::spectralConnectivitySharedCache()
+{
+    //*********************************************************************************************************
+    // Compute Connectivity With And Without Shared Spectra
+    //*********************************************************************************************************
+
+    QStringList lMethods;
+    lMethods << "WPLI" << "USPLI" << "XCOR" << "PLI" << "COH" << "IMAGCOH" << "PLV" << "DSWPLI";
+
+    ConnectivitySettings settingsCached = m_connectivitySettings;
+    settingsCached.setConnectivityMethods(lMethods);
+    QList<Network> lNetworksCached = Connectivity::calculate(settingsCached);
+
+    ConnectivitySettings settingsUncached = m_connectivitySettings;
+    settingsUncached.setConnectivityMethods(lMethods);
+    settingsUncached.setSpectralCacheSize(0);
+    QList<Network> lNetworksUncached = Connectivity::calculate(settingsUncached);
+
+    //*********************************************************************************************************
+    // Compare Connectivity And Reuse Statistics
+    //*********************************************************************************************************
+
+    QCOMPARE(lNetworksCached.size(), lMethods.size());
+    QCOMPARE(lNetworksUncached.size(), lMethods.size());
+
+    for(int i = 0; i < lNetworksCached.size(); ++i) {
+        MatrixXd matDiff = lNetworksCached.at(i).getFullConnectivityMatrix() - lNetworksUncached.at(i).getFullConnectivityMatrix();
+        QVERIFY(matDiff.cwiseAbs().maxCoeff() < dEpsilon);
+    }
+
+    const ConnectivitySettings::SpectralCacheStatistics& stats = settingsCached.getSpectralCacheStatistics();
+    QVERIFY(stats.bIsActive);
+    QCOMPARE(stats.iNumTrialsComputed, m_connectivitySettings.size());
+    QCOMPARE(stats.mapSpectraHits.value("XCOR"), m_connectivitySettings.size());
+    QCOMPARE(stats.mapCsdHits.value("DSWPLI"), m_connectivitySettings.size());
+
+    QVERIFY(!settingsUncached.getSpectralCacheStatistics().bIsActive);
+}
+
+//=============================================================================================================
+
+void TestSpectralConnectivity::spectralConnectivityPackedCsd()
+{
+    //*********************************************************************************************************
+    // Compute Packed CSD For A Multichannel Trial
+    //*********************************************************************************************************
+
+    int iNRows = 5;
+    int iNfft = m_connectivitySettings.getFFTSize();
+    int iNFreqs = int(floor(iNfft / 2.0)) + 1;
+
+    ConnectivitySettings::IntermediateTrialData trialData;
+    trialData.matData = MatrixXd::Random(iNRows, m_connectivitySettings.at(0).matData.cols());
+
+    QPair<MatrixXd, VectorXd> tapers = Spectral::generateTapers(trialData.matData.cols(), "hanning");
+
+    AbstractMetric::m_iNumberBinStart = 0;
+    AbstractMetric::m_iNumberBinAmount = iNFreqs;
+
+    AbstractMetric::computeTaperedSpectra(trialData, iNRows, iNFreqs, iNfft, tapers);
+    AbstractMetric::computeCsd(trialData, iNRows, iNFreqs, iNfft, tapers);
+
+    QCOMPARE(int(trialData.matCsd.rows()), ConnectivitySettings::getNumberOfPairs(iNRows));
+    QCOMPARE(int(trialData.matCsd.cols()), iNFreqs);
+
+    //*********************************************************************************************************
+    // Compare Against The Pairwise Definition
+    //*********************************************************************************************************
+
+    double denomCSD = tapers.second.cwiseAbs2().sum() / 2.0;
+    RowVectorXcd rowCsd;
+
+    for(int i = 0; i < iNRows; ++i) {
+        for(int j = i; j < iNRows; ++j) {
+            rowCsd = trialData.vecTapSpectra.at(i).cwiseProduct(trialData.vecTapSpectra.at(j).conjugate()).colwise().sum() / denomCSD;
+            rowCsd(0) /= 2.0;
+            if(iNfft % 2 == 0) {
+                rowCsd.tail(1) /= 2.0;
+            }
+
+            int p = ConnectivitySettings::getPairIndex(i, j, iNRows);
+            QVERIFY((trialData.matCsd.row(p) - rowCsd).cwiseAbs().maxCoeff() <= dEpsilon * rowCsd.cwiseAbs().maxCoeff());
+        }
+    }
+}
+
+//=============================================================================================================
+
 QList<MatrixXd> TestSpectralConnectivity::readConnectivityData()
 {
     MatrixXd inputTrials;
@@ -366,6 +463,136 @@ QList<MatrixXd> TestSpectralConnectivity::readConnectivityData()
 
 //=============================================================================================================
 
+void TestSpectralConnectivity::spectralConnectivityPackedNetwork()
+{
+    //*********************************************************************************************************
+    // Create A Packed And An Edge Based Network With The Same Weights
+    //*********************************************************************************************************
+
+    int iNNodes = 12;
+    int iNFreqs = 33;
+    MatrixXd matWeights = MatrixXd::Random(ConnectivitySettings::getNumberOfPairs(iNNodes), iNFreqs);
+
+    Network networkPacked("WPLI");
+    Network networkEdges("WPLI");
+
+    for(int i = 0; i < iNNodes; ++i) {
+        networkPacked.append(NetworkNode::SPtr(new NetworkNode(i, RowVectorXf::Zero(3))));
+        networkEdges.append(NetworkNode::SPtr(new NetworkNode(i, RowVectorXf::Zero(3))));
+    }
+
+    networkPacked.setPackedWeights(matWeights);
+    QVERIFY(networkPacked.hasPackedWeights());
+
+    for(int i = 0, p = 0; i < iNNodes; ++i) {
+        for(int j = i; j < iNNodes; ++j, ++p) {
+            NetworkEdge::SPtr pEdge = NetworkEdge::SPtr(new NetworkEdge(i, j, matWeights.row(p).transpose()));
+            networkEdges.getNodeAt(i)->append(pEdge);
+            networkEdges.getNodeAt(j)->append(pEdge);
+            networkEdges.append(pEdge);
+        }
+    }
+
+    QList<Network*> lNetworks;
+    lNetworks << &networkPacked << &networkEdges;
+
+    for(int i = 0; i < lNetworks.size(); ++i) {
+        lNetworks.at(i)->setSamplingFrequency(64.0f);
+        lNetworks.at(i)->setFFTSize(iNFreqs - 1);
+        lNetworks.at(i)->setUsedFreqBins(iNFreqs);
+    }
+
+    //*********************************************************************************************************
+    // Compare While Changing Thresholds And Frequency Ranges
+    //*********************************************************************************************************
+
+    QList<QPair<float,float> > lFreqRanges;
+    lFreqRanges << QPair<float,float>(4.0f, 12.0f) << QPair<float,float>(6.0f, 14.0f) << QPair<float,float>(2.0f, 10.0f) << QPair<float,float>(20.0f, 30.0f);
+
+    for(int k = 0; k < lFreqRanges.size(); ++k) {
+        networkPacked.setFrequencyRange(lFreqRanges.at(k).first, lFreqRanges.at(k).second);
+        networkEdges.setFrequencyRange(lFreqRanges.at(k).first, lFreqRanges.at(k).second);
+
+        for(double dThreshold = 0.05; dThreshold < 0.5; dThreshold += 0.1) {
+            networkPacked.setThreshold(dThreshold);
+            networkEdges.setThreshold(dThreshold);
+
+            MatrixXd matThresholded = networkEdges.getThresholdedConnectivityMatrix();
+
+            QVERIFY((networkPacked.getFullConnectivityMatrix() - networkEdges.getFullConnectivityMatrix()).cwiseAbs().maxCoeff() < dEpsilon);
+            QVERIFY((networkPacked.getThresholdedConnectivityMatrix() - matThresholded).cwiseAbs().maxCoeff() < dEpsilon);
+            QVERIFY((MatrixXd(networkPacked.getThresholdedAdjacency()) - matThresholded).cwiseAbs().maxCoeff() < dEpsilon);
+            QVERIFY(networkPacked.getThresholdedDegrees() == networkEdges.getThresholdedDegrees());
+            QVERIFY(networkPacked.getMinMaxThresholdedDegrees() == networkEdges.getMinMaxThresholdedDegrees());
+            QCOMPARE(networkPacked.getThresholdedEdges().size(), networkEdges.getThresholdedEdges().size());
+        }
+    }
+
+    //*********************************************************************************************************
+    // Edges Are Only Attached To The Nodes On Request
+    //*********************************************************************************************************
+
+    QVERIFY(networkPacked.getNodeAt(0)->getFullEdges().isEmpty());
+    QCOMPARE(networkPacked.getFullEdges().size(), networkEdges.getFullEdges().size());
+
+    for(int i = 0; i < iNNodes; ++i) {
+        QCOMPARE(networkPacked.getNodeAt(i)->getThresholdedDegree(), networkEdges.getNodeAt(i)->getThresholdedDegree());
+    }
+}
+
+//=============================================================================================================
+
+void TestSpectralConnectivity::spectralConnectivitySlidingWindow()
+{
+    //*********************************************************************************************************
+    // Slide A Window Over The Trials And Compare Against A Full Recomputation
+    //*********************************************************************************************************
+
+    QStringList lMethods;
+    lMethods << "WPLI" << "USPLI" << "COR" << "XCOR" << "PLI" << "COH" << "IMAGCOH" << "PLV" << "DSWPLI";
+
+    int iWindowSize = 4;
+
+    // Only the window keeps the per trial data, the global storage mode stays off
+    ConnectivitySettings settingsWindow = m_connectivitySettings;
+    settingsWindow.clearAllData();
+    settingsWindow.setConnectivityMethods(lMethods);
+    settingsWindow.setStorageModeActive(true);
+
+    for(int t = 0; t < m_connectivitySettings.size(); ++t) {
+        // Only the new trial is transformed, the leaving trial is subtracted from the sums
+        settingsWindow.append(m_connectivitySettings.at(t).matData);
+
+        if(settingsWindow.size() > iWindowSize) {
+            settingsWindow.removeFirst(settingsWindow.size() - iWindowSize);
+        }
+
+        QList<Network> lNetworksWindow = Connectivity::calculate(settingsWindow);
+        QVERIFY(settingsWindow.at(0).matCsd.rows() > 0);
+
+        ConnectivitySettings settingsFull = m_connectivitySettings;
+        settingsFull.clearAllData();
+        settingsFull.setConnectivityMethods(lMethods);
+
+        for(int k = qMax(0, t - iWindowSize + 1); k <= t; ++k) {
+            settingsFull.append(m_connectivitySettings.at(k).matData);
+        }
+
+        QList<Network> lNetworksFull = Connectivity::calculate(settingsFull);
+        QCOMPARE(int(settingsFull.at(0).matCsd.rows()), 0);
+
+        QCOMPARE(lNetworksWindow.size(), lNetworksFull.size());
+
+        for(int i = 0; i < lNetworksWindow.size(); ++i) {
+            MatrixXd matFull = lNetworksFull.at(i).getFullConnectivityMatrix();
+            MatrixXd matDiff = lNetworksWindow.at(i).getFullConnectivityMatrix() - matFull;
+            QVERIFY(matDiff.cwiseAbs().maxCoeff() < dEpsilon * qMax(1.0, matFull.cwiseAbs().maxCoeff()));
+        }
+    }
+}
+
+//=============================================================================================================
+
 void TestSpectralConnectivity::compareConnectivity()
 {
     //*********************************************************************************************************
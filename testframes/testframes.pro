@@ -56,13 +56,20 @@ SUBDIRS += \
     test_mne_forward_solution \
     test_fiff_cov \
     test_fiff_digitizer \
+    test_fwd_field_kernels \
+    test_minimum_norm \
+    test_kmeans \
+    test_fs_io \
+    test_minmaxpyramid \
     test_mne_msh_display_surface_set \
-    test_mne_project_to_surface
+    test_mne_project_to_surface \
+    test_mne_surface_or_volume
 
     qtHaveModule(charts) {
         SUBDIRS += \
             test_interpolation \
             test_geometryinfo \
+            test_meshlod \
             test_spectral_connectivity \
             test_mne_anonymize
     }